@@ -77,7 +77,16 @@ esp_err_t bsp_spi_lcd_deinit(void);
  */
 esp_err_t bsp_lcd_set_backlight(bool en);
 
-#if CONFIG_LCD_LVGL_FULL_REFRESH || CONFIG_LCD_LVGL_DIRECT_MODE
+#if CONFIG_LCD_AVOID_TEAR
+/**
+ * @brief How bsp_lcd_flush hands LVGL output to the panel frame buffers
+ */
+typedef enum {
+    BSP_LCD_FLUSH_PARTIAL = 0,  /*!< Copy each area into the panel frame buffer */
+    BSP_LCD_FLUSH_FULL,         /*!< LVGL renders whole frames into the panel frame buffers */
+    BSP_LCD_FLUSH_DIRECT,       /*!< LVGL renders dirty areas into the panel frame buffers */
+} bsp_lcd_flush_mode_t;
+
 /**
  * @brief Get two frame buffers created by rgb lcd
  *
@@ -85,9 +94,17 @@ esp_err_t bsp_lcd_set_backlight(bool en);
  * @param buf2 frame buffer 2
  */
 void bsp_lcd_get_frame_buffer(void **buf1, void **buf2);
-#endif
 
-#if CONFIG_LCD_LVGL_DIRECT_MODE
+/**
+ * @brief Select the flush behaviour at runtime
+ *
+ * Defaults to the mode chosen in Kconfig. Must only be changed while no
+ * flush is in progress.
+ *
+ * @param mode Flush mode
+ */
+void bsp_lcd_set_flush_mode(bsp_lcd_flush_mode_t mode);
+
 /**
  * @brief Register the function used to copy dirty area in lvgl direct-mode
  *
@@ -37,9 +37,16 @@ static TaskHandle_t lcd_task_handle;
 static void lcd_task(void *args);
 #endif
 
-#if CONFIG_LCD_LVGL_DIRECT_MODE
+#if CONFIG_LCD_AVOID_TEAR
 static bool (*lvgl_flush_is_end)(void) = NULL;
-static bool (*lvgl_direct_mode_buf_copy)(void) = NULL;
+static void (*lvgl_direct_mode_buf_copy)(void) = NULL;
+#if CONFIG_LCD_LVGL_DIRECT_MODE
+static bsp_lcd_flush_mode_t flush_mode = BSP_LCD_FLUSH_DIRECT;
+#elif CONFIG_LCD_LVGL_FULL_REFRESH
+static bsp_lcd_flush_mode_t flush_mode = BSP_LCD_FLUSH_FULL;
+#else
+static bsp_lcd_flush_mode_t flush_mode = BSP_LCD_FLUSH_PARTIAL;
+#endif
 #endif
 
 static void *p_user_data = NULL;
@@ -312,20 +319,27 @@ esp_err_t bsp_lcd_deinit(void)
 
 esp_err_t bsp_lcd_flush(int x1, int y1, int x2, int y2, const void *p_data)
 {
-#if !CONFIG_LCD_LVGL_DIRECT_MODE
-    esp_lcd_panel_draw_bitmap(panel_handle, x1, y1, x2, y2, p_data);
-#endif
-
-#if CONFIG_LCD_LVGL_DIRECT_MODE
-    if (lvgl_flush_is_end()) {
+#if CONFIG_LCD_AVOID_TEAR
+    switch (flush_mode) {
+    case BSP_LCD_FLUSH_DIRECT:
+        if (lvgl_flush_is_end && lvgl_flush_is_end()) {
+            esp_lcd_panel_draw_bitmap(panel_handle, x1, y1, x2, y2, p_data);
+            xSemaphoreTake(flush_ready, portMAX_DELAY);
+            if (lvgl_direct_mode_buf_copy) {
+                lvgl_direct_mode_buf_copy();
+            }
+        }
+        break;
+    case BSP_LCD_FLUSH_FULL:
         esp_lcd_panel_draw_bitmap(panel_handle, x1, y1, x2, y2, p_data);
         xSemaphoreTake(flush_ready, portMAX_DELAY);
-        if (lvgl_direct_mode_buf_copy) {
-            lvgl_direct_mode_buf_copy();
-        }
+        break;
+    default:
+        esp_lcd_panel_draw_bitmap(panel_handle, x1, y1, x2, y2, p_data);
+        break;
     }
-#elif CONFIG_LCD_LVGL_FULL_REFRESH
-    xSemaphoreTake(flush_ready, portMAX_DELAY);
+#else
+    esp_lcd_panel_draw_bitmap(panel_handle, x1, y1, x2, y2, p_data);
 #endif
 
     const board_res_desc_t *brd = bsp_board_get_description();
@@ -358,15 +372,18 @@ esp_err_t bsp_lcd_set_backlight(bool en)
     return gpio_set_level(brd->GPIO_LCD_BL, en ? brd->GPIO_LCD_BL_ON : !brd->GPIO_LCD_BL_ON);
 }
 
-#if CONFIG_LCD_LVGL_FULL_REFRESH || CONFIG_LCD_LVGL_DIRECT_MODE
+#if CONFIG_LCD_AVOID_TEAR
 void bsp_lcd_get_frame_buffer(void **buf1, void **buf2)
 {
     *buf1 = lcd_buf0;
     *buf2 = lcd_buf1;
 }
-#endif
 
-#if CONFIG_LCD_LVGL_DIRECT_MODE
+void bsp_lcd_set_flush_mode(bsp_lcd_flush_mode_t mode)
+{
+    flush_mode = mode;
+}
+
 void bsp_lcd_direct_mode_register(void (*func)(void))
 {
     lvgl_direct_mode_buf_copy = func;
@@ -16,12 +16,18 @@ License: Revised BSD License, see LICENSE.TXT file include in the project
 /* --- DEPENDENCIES --------------------------------------------------------- */
 
 #include <string.h>
+#include <stdatomic.h>
 
 #include <esp_timer.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
 #include "lorahub_aux.h"
 #include "lorahub_hal.h"
 #include "lorahub_hal_rx.h"
+#include "lorahub_hal_scan.h"
 #include "lorahub_hal_tx.h"
 
 #include "radio_context.h"
@@ -73,6 +79,10 @@ static const char* TAG_HAL = "LORAHUB_HAL";
 #define LORA_SYNC_WORD_PRIVATE 0x12  // 0x12 Private Network
 #define LORA_SYNC_WORD_PUBLIC 0x34   // 0x34 Public Network
 
+#define RX_RING_SIZE 8 /* packets buffered between the RX task and lgw_receive(), power of 2 */
+#define RX_TASK_STACK_SIZE 3072
+#define RX_TASK_PRIORITY 10 /* above the packet forwarder threads */
+
 /* -------------------------------------------------------------------------- */
 /* --- PRIVATE TYPES -------------------------------------------------------- */
 
@@ -89,6 +99,28 @@ static struct lgw_conf_rxif_s rxif_conf = {
     .bandwidth = BW_UNDEFINED, .coderate = CR_UNDEFINED, .datarate = DR_UNDEFINED, .modulation = MOD_UNDEFINED
 };
 
+static struct lgw_conf_scan_s scan_conf    = { .enable = false, .nb_chan = 0, .datarate_mask = 0 };
+static bool                   scan_enabled = false; /* scan mode configured, with at least one slot to visit */
+
+/* Channel the radio listens to, used to tag the received packets. Only
+ * accessed with radio_mutex held. */
+static uint32_t rx_freq_hz     = 0;
+static uint32_t rx_datarate    = DR_UNDEFINED;
+static uint8_t  rx_if_chain    = 0;
+static bool     rx_reconfigure = true; /* the radio was used by something else since the last CAD */
+
+/* Packets received by the RX task, drained by lgw_receive(). Single producer
+ * (rx_task) / single consumer: each index is only written by its owner. */
+static struct lgw_pkt_rx_s rx_ring[RX_RING_SIZE];
+static atomic_uint         rx_ring_head    = 0; /* next slot written by rx_task */
+static atomic_uint         rx_ring_tail    = 0; /* next slot read by lgw_receive() */
+static atomic_uint         rx_ring_dropped = 0; /* packets lost because the ring was full */
+static struct lgw_pkt_rx_s rx_pkt_overflow;     /* scratch used to flush the radio when the ring is full */
+static uint32_t            rx_count_us_correction = 0;
+
+static TaskHandle_t      rx_task_handle = NULL;
+static SemaphoreHandle_t rx_ring_sem    = NULL; /* given each time a packet is queued */
+static SemaphoreHandle_t radio_mutex    = NULL; /* serializes radio access between rx_task and lgw_send() */
 
 static radio_context_t radio_context = { 0 };
 #define RADIO_CONTEXT ( ( void* ) &radio_context )
@@ -106,6 +138,10 @@ const ral_t lgw_ral = RAL_LR11XX_INSTANTIATE( RADIO_CONTEXT );
 /* -------------------------------------------------------------------------- */
 /* --- PRIVATE FUNCTIONS DECLARATION ---------------------------------------- */
 
+static void rx_task( void* args );
+static void rx_arm( void );
+static int  radio_send( struct lgw_pkt_tx_s* pkt_data );
+
 /* -------------------------------------------------------------------------- */
 /* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
 
@@ -260,11 +296,212 @@ int lgw_radio_setup( void )
         ral_set_lora_sync_word( &lgw_ral, LORA_SYNC_WORD_PUBLIC ) );  // TODO: make it configurable in menuconfig
 
     /* Install interrupt handler for RX IRQs */
-    lgw_radio_init_rx( &lgw_ral );
+    lgw_radio_init_rx( &lgw_ral, rx_task_handle );
 
     return LGW_HAL_SUCCESS;
 }
 
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static uint32_t radio_tcxo_startup_time_us( void )
+{
+    uint32_t tcxo_startup_time_in_tick = 0;
+#if defined( CONFIG_RADIO_TYPE_SX1261 ) || defined( CONFIG_RADIO_TYPE_SX1262 ) || defined( CONFIG_RADIO_TYPE_SX1268 )
+    ral_sx126x_bsp_get_xosc_cfg( NULL, NULL, NULL, &tcxo_startup_time_in_tick );
+#elif defined( CONFIG_RADIO_TYPE_LLCC68 )
+    ral_llcc68_bsp_get_xosc_cfg( NULL, NULL, NULL, &tcxo_startup_time_in_tick );
+#elif defined( CONFIG_RADIO_TYPE_LR1121 )
+    ral_lr11xx_bsp_get_xosc_cfg( NULL, NULL, NULL, &tcxo_startup_time_in_tick );
+#endif
+    return tcxo_startup_time_in_tick * 15625 / 1000;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void rx_fetch( void )
+{
+    struct lgw_pkt_rx_s* p;
+    uint32_t             count_us;
+    int8_t               rssi, snr;
+    uint8_t              status;
+    uint16_t             size;
+    bool                 irq_received;
+    unsigned int         head = atomic_load_explicit( &rx_ring_head, memory_order_relaxed );
+    unsigned int         tail = atomic_load_explicit( &rx_ring_tail, memory_order_acquire );
+
+    /* The slot at head is owned by this task until head is published */
+    p = ( ( head - tail ) < RX_RING_SIZE ) ? &rx_ring[head % RX_RING_SIZE] : &rx_pkt_overflow;
+
+    if( lgw_radio_get_pkt( &lgw_ral, &irq_received, &count_us, &rssi, &snr, &status, &size, p->payload ) > 0 )
+    {
+        p->count_us   = count_us - rx_count_us_correction; /* radio processing delay */
+        p->freq_hz    = rx_freq_hz;
+        p->if_chain   = rx_if_chain;
+        p->rf_chain   = 0;
+        p->status     = status;
+        p->modulation = rxif_conf.modulation;
+        p->datarate   = rx_datarate;
+        p->bandwidth  = rxif_conf.bandwidth;
+        p->coderate   = rxif_conf.coderate;
+        p->rssic      = ( float ) rssi;
+        p->snr        = ( float ) snr;
+        p->size       = size;
+
+        if( scan_enabled == true )
+        {
+            lgw_scan_count_rx( status );
+        }
+
+        if( p == &rx_pkt_overflow )
+        {
+            atomic_fetch_add_explicit( &rx_ring_dropped, 1, memory_order_relaxed );
+            ESP_LOGW( TAG_HAL, "WARNING: RX ring full, packet dropped" );
+        }
+        else
+        {
+            atomic_store_explicit( &rx_ring_head, head + 1, memory_order_release );
+            xSemaphoreGive( rx_ring_sem );
+        }
+    }
+
+    if( irq_received == true )
+    {
+        /* Reconfigure RX */
+        rx_arm( );
+    }
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void rx_arm( void )
+{
+    const struct lgw_scan_slot_s* slot;
+    uint32_t                      count_us;
+
+    if( scan_enabled == false )
+    {
+        lgw_radio_set_rx( &lgw_ral, rx_freq_hz, rx_datarate, rxif_conf.bandwidth, rxif_conf.coderate );
+        return;
+    }
+
+    /* Scan mode: CAD on the next slot, the radio switches to RX by itself on detection */
+    lgw_get_instcnt( &count_us );
+    slot = lgw_scan_next( count_us );
+    if( slot->datarate != rx_datarate )
+    {
+        rx_datarate            = slot->datarate;
+        rx_count_us_correction = lgw_radio_timestamp_correction( rx_datarate, rxif_conf.bandwidth );
+    }
+    rx_freq_hz  = slot->freq_hz;
+    rx_if_chain = slot->chan;
+
+    lgw_radio_set_cad( &lgw_ral, rx_freq_hz, rx_datarate, rxif_conf.bandwidth, rxif_conf.coderate,
+                       slot->rx_timeout_ms, rx_reconfigure );
+    rx_reconfigure = false;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void rx_task( void* args )
+{
+    bool cad_done;
+    bool cad_detected;
+
+    while( 1 )
+    {
+        /* Woken up by the DIO IRQ handler */
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        xSemaphoreTake( radio_mutex, portMAX_DELAY );
+        /* While suspended, IRQs belong to lgw_send() which polls them itself */
+        if( ( is_started == true ) && ( rx_status == RX_ON ) )
+        {
+            lgw_radio_get_cad( &lgw_ral, &cad_done, &cad_detected );
+            if( cad_done == false )
+            {
+                rx_fetch( );
+            }
+            else if( cad_detected == true )
+            {
+                /* The radio stays in RX until the packet is received or the RX timeout */
+                lgw_scan_count_detect( );
+            }
+            else
+            {
+                rx_arm( );
+            }
+        }
+        xSemaphoreGive( radio_mutex );
+    }
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static int radio_send( struct lgw_pkt_tx_s* pkt_data )
+{
+    /* Update RX status */
+    rx_status = RX_SUSPENDED;
+
+    /* Configure for TX */
+    lgw_radio_configure_tx( &lgw_ral, pkt_data );
+
+    /* Update TX status */
+    tx_status = TX_SCHEDULED;
+
+    /* Get TCXO startup time, if any */
+    uint32_t tcxo_startup_time_us = radio_tcxo_startup_time_us( );
+
+    /* Wait for time to send packet */
+    uint32_t count_us_now;
+    do
+    {
+        lgw_get_instcnt( &count_us_now );
+        WAIT_US( 100 );
+    } while( ( int32_t )( pkt_data->count_us - count_us_now ) > ( int32_t ) tcxo_startup_time_us );
+
+    /* Send packet */
+    ASSERT_RAL_RC( ral_set_tx( &lgw_ral ) );
+
+    /* Update TX status */
+    tx_status = TX_EMITTING;
+
+    /* Wait for TX_DONE */
+    bool      flag_tx_done    = false;
+    bool      flag_tx_timeout = false;
+    ral_irq_t irq_regs;
+    do
+    {
+        ASSERT_RAL_RC( ral_get_and_clear_irq_status( &lgw_ral, &irq_regs ) );
+        if( ( irq_regs & RAL_IRQ_TX_DONE ) == RAL_IRQ_TX_DONE )
+        {
+            lgw_get_instcnt( &count_us_now );
+            printf( "%lu: IRQ_TX_DONE\n", count_us_now );
+            flag_tx_done = true;
+        }
+        if( ( irq_regs & RAL_IRQ_RX_TIMEOUT ) == RAL_IRQ_RX_TIMEOUT )
+        {  // TODO: check if IRQ also valid for TX
+            lgw_get_instcnt( &count_us_now );
+            ESP_LOGW( TAG_HAL, "%lu: TX:IRQ_TIMEOUT\n", count_us_now );
+            flag_tx_timeout = true;
+        }
+
+        /* Yield for 10ms (avoid TWDT watchdog timeout) for long TX */
+        vTaskDelay( pdMS_TO_TICKS( 10 ) );
+    } while( ( flag_tx_done == false ) && ( flag_tx_timeout == false ) );
+
+    /* Update TX status */
+    tx_status = TX_FREE;
+
+    /* Back to RX config */
+    rx_reconfigure = true;
+    rx_arm( );
+
+    /* Update RX status */
+    rx_status = RX_ON;
+
+    return ( flag_tx_timeout == false ) ? LGW_HAL_SUCCESS : LGW_HAL_ERROR;
+}
+
 /* -------------------------------------------------------------------------- */
 /* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
 
@@ -304,9 +541,48 @@ int lgw_rxif_setconf( struct lgw_conf_rxif_s* conf )
 
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
+int lgw_scan_setconf( struct lgw_conf_scan_s* conf )
+{
+    CHECK_NULL( conf );
+
+    /* check if the concentrator is running */
+    if( is_started == true )
+    {
+        ESP_LOGI( TAG_HAL, "ERROR: CONCENTRATOR IS RUNNING, STOP IT BEFORE CHANGING CONFIGURATION\n" );
+        return LGW_HAL_ERROR;
+    }
+
+    /* check input parameters */
+    if( conf->nb_chan > LGW_SCAN_CHAN_NB )
+    {
+        ESP_LOGE( TAG_HAL, "ERROR: TOO MANY SCAN CHANNELS (%u, max %u)\n", conf->nb_chan, LGW_SCAN_CHAN_NB );
+        return LGW_HAL_ERROR;
+    }
+    if( ( conf->datarate_mask & ~( ( 1 << ( DR_LORA_SF12 + 1 ) ) - ( 1 << DR_LORA_SF5 ) ) ) != 0 )
+    {
+        ESP_LOGE( TAG_HAL, "ERROR: NOT A VALID SCAN DATARATE MASK (0x%04X)\n", conf->datarate_mask );
+        return LGW_HAL_ERROR;
+    }
+    for( int i = 0; i < conf->nb_chan; i++ )
+    {
+        if( conf->freq_hz[i] == 0 )
+        {
+            ESP_LOGE( TAG_HAL, "ERROR: SCAN CHANNEL %d FREQUENCY NOT SET\n", i );
+            return LGW_HAL_ERROR;
+        }
+    }
+
+    memcpy( &scan_conf, conf, sizeof( struct lgw_conf_scan_s ) );
+
+    return LGW_HAL_SUCCESS;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
 int lgw_start( void )
 {
-    int err;
+    int      err;
+    uint32_t count_us;
 
     if( is_started == true )
     {
@@ -340,11 +616,51 @@ int lgw_start( void )
         return LGW_HAL_ERROR;
     }
 
+    /* Create the RX task before the IRQ handler that wakes it up */
+    if( rx_task_handle == NULL )
+    {
+        radio_mutex = xSemaphoreCreateMutex( );
+        rx_ring_sem = xSemaphoreCreateBinary( );
+        if( ( radio_mutex == NULL ) || ( rx_ring_sem == NULL ) ||
+            ( xTaskCreate( rx_task, "lgw_rx", RX_TASK_STACK_SIZE, NULL, RX_TASK_PRIORITY, &rx_task_handle ) !=
+              pdPASS ) )
+        {
+            ESP_LOGE( TAG_HAL, "ERROR: FAILED TO CREATE RX TASK\n" );
+            return LGW_HAL_ERROR;
+        }
+    }
+
+    xSemaphoreTake( radio_mutex, portMAX_DELAY );
+    is_started = false;
+    atomic_store( &rx_ring_head, 0 );
+    atomic_store( &rx_ring_tail, 0 );
+    atomic_store( &rx_ring_dropped, 0 );
+    rx_count_us_correction = lgw_radio_timestamp_correction( rxif_conf.datarate, rxif_conf.bandwidth );
+    rx_freq_hz             = rxrf_conf.freq_hz;
+    rx_datarate            = rxif_conf.datarate;
+    rx_if_chain            = 0;
+    rx_reconfigure         = true;
+
+    /* Build the scan slots, none if scan mode is disabled */
+    lgw_get_instcnt( &count_us );
+    scan_enabled = ( lgw_scan_init( &scan_conf, rxif_conf.bandwidth, count_us ) > 0 );
+    if( ( scan_conf.enable == true ) && ( scan_enabled == false ) )
+    {
+        ESP_LOGW( TAG_HAL, "WARNING: nothing to scan, listening to %lu Hz only\n", rxrf_conf.freq_hz );
+    }
+    if( ( scan_enabled == true ) && ( radio_tcxo_startup_time_us( ) > 0 ) )
+    {
+        /* The radio falls back to STDBY_RC after each CAD, which stops the TCXO */
+        ESP_LOGW( TAG_HAL, "WARNING: TCXO restarted before each CAD (%lu us), scan may receive less than one channel\n",
+                  radio_tcxo_startup_time_us( ) );
+    }
+
     /* Configure SPI and GPIOs */
     err = lgw_connect( );
     if( err == LGW_HAL_ERROR )
     {
         ESP_LOGE( TAG_HAL, "ERROR: FAILED TO CONNECT BOARD\n" );
+        xSemaphoreGive( radio_mutex );
         return LGW_HAL_ERROR;
     }
 
@@ -353,6 +669,7 @@ int lgw_start( void )
     if( err == LGW_HAL_ERROR )
     {
         ESP_LOGE( TAG_HAL, "ERROR: FAILED TO SETUP RADIO\n" );
+        xSemaphoreGive( radio_mutex );
         return LGW_HAL_ERROR;
     }
 
@@ -360,7 +677,7 @@ int lgw_start( void )
     rx_status = RX_OFF;
 
     /* Set RX */
-    lgw_radio_set_rx( &lgw_ral, rxrf_conf.freq_hz, rxif_conf.datarate, rxif_conf.bandwidth, rxif_conf.coderate );
+    rx_arm( );
 
     /* Update RX status */
     rx_status = RX_ON;
@@ -377,6 +694,7 @@ int lgw_start( void )
 
     /* set hal state */
     is_started = true;
+    xSemaphoreGive( radio_mutex );
 
     return LGW_HAL_SUCCESS;
 };
@@ -401,15 +719,11 @@ int lgw_stop( void )
 
 int lgw_receive( uint8_t max_pkt, struct lgw_pkt_rx_s* pkt_data )
 {
-    struct lgw_pkt_rx_s* p = &pkt_data[0];
-    uint32_t             count_us;
-    int8_t               rssi, snr;
-    uint8_t              status;
-    uint16_t             size;
-    bool                 irq_received;
-    int                  nb_packet_received = 0;
+    unsigned int tail;
+    unsigned int head;
+    int          nb_packet_received = 0;
 
-    /* max_pkt is ignored, only 1 packet can be received at a time */
+    CHECK_NULL( pkt_data );
 
     /* check if the concentrator is running */
     if( is_started == false )
@@ -418,118 +732,85 @@ int lgw_receive( uint8_t max_pkt, struct lgw_pkt_rx_s* pkt_data )
         return LGW_HAL_ERROR;
     }
 
-    memset( p, 0, sizeof( struct lgw_pkt_rx_s ) );
-    nb_packet_received =
-        lgw_radio_get_pkt( &lgw_ral, &irq_received, &count_us, &rssi, &snr, &status, &size, p->payload );
-    if( nb_packet_received > 0 )
-    {
-        p->count_us   = count_us;
-        p->freq_hz    = rxrf_conf.freq_hz;
-        p->if_chain   = 0;
-        p->rf_chain   = 0;
-        p->status     = status;
-        p->modulation = rxif_conf.modulation;
-        p->datarate   = rxif_conf.datarate;
-        p->bandwidth  = rxif_conf.bandwidth;
-        p->coderate   = rxif_conf.coderate;
-        p->rssic      = ( float ) rssi;
-        p->snr        = ( float ) snr;
-        p->size       = size;
-
-        /* Compensate timestamp with for radio processing delay */
-        uint32_t count_us_correction = lgw_radio_timestamp_correction( rxif_conf.datarate, rxif_conf.bandwidth );
-        ESP_LOGI( TAG_HAL, "count_us correction: %lu us", count_us_correction );
-        p->count_us -= count_us_correction;
-    }
-
-    if( irq_received == true )
+    /* Drain packets queued by the RX task, the radio itself is not accessed */
+    tail = atomic_load_explicit( &rx_ring_tail, memory_order_relaxed );
+    head = atomic_load_explicit( &rx_ring_head, memory_order_acquire );
+    while( ( nb_packet_received < max_pkt ) && ( tail != head ) )
     {
-        /* Reconfigure RX */
-        lgw_radio_set_rx( &lgw_ral, rxrf_conf.freq_hz, rxif_conf.datarate, rxif_conf.bandwidth, rxif_conf.coderate );
+        memcpy( &pkt_data[nb_packet_received], &rx_ring[tail % RX_RING_SIZE], sizeof( struct lgw_pkt_rx_s ) );
+        nb_packet_received += 1;
+        tail += 1;
     }
+    atomic_store_explicit( &rx_ring_tail, tail, memory_order_release );
 
     return nb_packet_received;
 };
 
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
-int lgw_send( struct lgw_pkt_tx_s* pkt_data )
+int lgw_receive_wait( uint32_t timeout_ms )
 {
-    /* check if the concentrator is running */
-    if( is_started == false )
+    if( ( is_started == false ) || ( rx_ring_sem == NULL ) )
     {
-        ESP_LOGE( TAG_HAL, "ERROR: CONCENTRATOR IS NOT RUNNING, START IT BEFORE SENDING\n" );
         return LGW_HAL_ERROR;
     }
 
-    /* Update RX status */
-    rx_status = RX_SUSPENDED;
+    if( atomic_load( &rx_ring_head ) == atomic_load( &rx_ring_tail ) )
+    {
+        xSemaphoreTake( rx_ring_sem, pdMS_TO_TICKS( timeout_ms ) );
+    }
 
-    /* Configure for TX */
-    lgw_radio_configure_tx( &lgw_ral, pkt_data );
+    return ( int ) ( atomic_load( &rx_ring_head ) - atomic_load( &rx_ring_tail ) );
+};
 
-    /* Update TX status */
-    tx_status = TX_SCHEDULED;
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
-    /* Get TCXO startup time, if any */
-    uint32_t tcxo_startup_time_in_tick = 0;
-#if defined( CONFIG_RADIO_TYPE_SX1261 ) || defined( CONFIG_RADIO_TYPE_SX1262 ) || defined( CONFIG_RADIO_TYPE_SX1268 )
-    ral_sx126x_bsp_get_xosc_cfg( NULL, NULL, NULL, &tcxo_startup_time_in_tick );
-#elif defined( CONFIG_RADIO_TYPE_LLCC68 )
-    ral_llcc68_bsp_get_xosc_cfg( NULL, NULL, NULL, &tcxo_startup_time_in_tick );
-#elif defined( CONFIG_RADIO_TYPE_LR1121 )
-    ral_lr11xx_bsp_get_xosc_cfg( NULL, NULL, NULL, &tcxo_startup_time_in_tick );
-#endif
-    uint32_t tcxo_startup_time_us = tcxo_startup_time_in_tick * 15625 / 1000;
+uint32_t lgw_receive_dropped( void )
+{
+    return atomic_load_explicit( &rx_ring_dropped, memory_order_relaxed );
+};
 
-    /* Wait for time to send packet */
-    uint32_t count_us_now;
-    do
-    {
-        lgw_get_instcnt( &count_us_now );
-        WAIT_US( 100 );
-    } while( ( int32_t )( pkt_data->count_us - count_us_now ) > ( int32_t ) tcxo_startup_time_us );
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
-    /* Send packet */
-    ASSERT_RAL_RC( ral_set_tx( &lgw_ral ) );
+int lgw_scan_get_stats( struct lgw_scan_stat_s* stats, uint8_t max_chan )
+{
+    int nb_chan;
 
-    /* Update TX status */
-    tx_status = TX_EMITTING;
+    CHECK_NULL( stats );
 
-    /* Wait for TX_DONE */
-    bool      flag_tx_done    = false;
-    bool      flag_tx_timeout = false;
-    ral_irq_t irq_regs;
-    do
+    /* Nothing counted before the first lgw_start() */
+    if( radio_mutex == NULL )
     {
-        ASSERT_RAL_RC( ral_get_and_clear_irq_status( &lgw_ral, &irq_regs ) );
-        if( ( irq_regs & RAL_IRQ_TX_DONE ) == RAL_IRQ_TX_DONE )
-        {
-            lgw_get_instcnt( &count_us_now );
-            printf( "%lu: IRQ_TX_DONE\n", count_us_now );
-            flag_tx_done = true;
-        }
-        if( ( irq_regs & RAL_IRQ_RX_TIMEOUT ) == RAL_IRQ_RX_TIMEOUT )
-        {  // TODO: check if IRQ also valid for TX
-            lgw_get_instcnt( &count_us_now );
-            ESP_LOGW( TAG_HAL, "%lu: TX:IRQ_TIMEOUT\n", count_us_now );
-            flag_tx_timeout = true;
-        }
+        return 0;
+    }
 
-        /* Yield for 10ms (avoid TWDT watchdog timeout) for long TX */
-        vTaskDelay( pdMS_TO_TICKS( 10 ) );
-    } while( ( flag_tx_done == false ) && ( flag_tx_timeout == false ) );
+    /* The RX task updates the counters with the radio mutex held */
+    xSemaphoreTake( radio_mutex, portMAX_DELAY );
+    nb_chan = lgw_scan_copy_stats( stats, max_chan );
+    xSemaphoreGive( radio_mutex );
 
-    /* Update TX status */
-    tx_status = TX_FREE;
+    return nb_chan;
+};
 
-    /* Back to RX config */
-    lgw_radio_set_rx( &lgw_ral, rxrf_conf.freq_hz, rxif_conf.datarate, rxif_conf.bandwidth, rxif_conf.coderate );
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
-    /* Update RX status */
-    rx_status = RX_ON;
+int lgw_send( struct lgw_pkt_tx_s* pkt_data )
+{
+    int err;
 
-    return ( flag_tx_timeout == false ) ? LGW_HAL_SUCCESS : LGW_HAL_ERROR;
+    /* check if the concentrator is running */
+    if( is_started == false )
+    {
+        ESP_LOGE( TAG_HAL, "ERROR: CONCENTRATOR IS NOT RUNNING, START IT BEFORE SENDING\n" );
+        return LGW_HAL_ERROR;
+    }
+
+    /* Keep the RX task away from the radio until back in RX */
+    xSemaphoreTake( radio_mutex, portMAX_DELAY );
+    err = radio_send( pkt_data );
+    xSemaphoreGive( radio_mutex );
+
+    return err;
 };
 
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -47,6 +47,7 @@ License: Revised BSD License, see LICENSE.TXT file include in the project
 /* concentrator chipset-specific parameters */
 /* to use array parameters, declare a local const and use 'if_chain' as index */
 #define LGW_IF_CHAIN_NB 1 /* number of IF+modem RX chains */
+#define LGW_SCAN_CHAN_NB 8 /* maximum number of channels hopped over in scan mode */
 
 /* values available for the 'modulation' parameters */
 /* NOTE: arbitrary values */
@@ -140,6 +141,31 @@ struct lgw_conf_rxif_s
     uint8_t  coderate;   /*!> RX coding rate (LoRa only) */
 };
 
+/**
+@struct lgw_conf_scan_s
+@brief Scan mode configuration structure, the radio hops over the channels with CAD instead of listening to one
+*/
+struct lgw_conf_scan_s
+{
+    bool     enable;                    /*!> enable or disable scan mode */
+    uint8_t  nb_chan;                   /*!> number of channels in freq_hz[] */
+    uint32_t freq_hz[LGW_SCAN_CHAN_NB]; /*!> center frequency of each channel in Hz */
+    uint16_t datarate_mask;             /*!> SFs scanned on each channel, bit n set for DR_LORA_SFn */
+};
+
+/**
+@struct lgw_scan_stat_s
+@brief Scan mode statistics of one channel, counted since lgw_start()
+*/
+struct lgw_scan_stat_s
+{
+    uint32_t freq_hz;   /*!> center frequency of the channel in Hz */
+    uint32_t nb_cad;    /*!> number of CAD run on the channel */
+    uint32_t nb_detect; /*!> number of preambles detected */
+    uint32_t nb_rx_ok;  /*!> number of packets received with a valid CRC */
+    uint32_t nb_rx_bad; /*!> number of packets received with a bad CRC */
+};
+
 /**
 @struct lgw_pkt_rx_s
 @brief Structure containing the metadata of a packet that was received and a pointer to the payload
@@ -202,6 +228,17 @@ int lgw_rxrf_setconf( struct lgw_conf_rxrf_s* conf );
 */
 int lgw_rxif_setconf( struct lgw_conf_rxif_s* conf );
 
+/**
+@brief Configure the scan mode (must configure before start)
+@param conf structure containing the configuration parameters
+@return LGW_HAL_ERROR id the operation failed, LGW_HAL_SUCCESS else
+
+When enabled, the channels and datarates of the scan configuration replace the rxrf frequency and the rxif datarate
+for RX, bandwidth and coderate are still taken from the rxif configuration. Received packets report the channel
+index in 'if_chain'.
+*/
+int lgw_scan_setconf( struct lgw_conf_scan_s* conf );
+
 /**
 @brief Connect to the LoRa concentrator, reset it and configure it according to previously set parameters
 @return LGW_HAL_ERROR id the operation failed, LGW_HAL_SUCCESS else
@@ -219,9 +256,34 @@ int lgw_stop( void );
 @param max_pkt maximum number of packet that must be retrieved (equal to the size of the array of struct)
 @param pkt_data pointer to an array of struct that will receive the packet metadata and payload pointers
 @return LGW_HAL_ERROR id the operation failed, else the number of packets retrieved
+
+Packets are read from the radio by a HAL task woken up by the DIO interrupt
+and queued in a ring buffer, this function only drains that ring. It does not
+need to be serialized with lgw_send().
 */
 int lgw_receive( uint8_t max_pkt, struct lgw_pkt_rx_s* pkt_data );
 
+/**
+@brief Block until at least one received packet is queued, or timeout
+@param timeout_ms maximum time to wait, in milliseconds
+@return LGW_HAL_ERROR id the concentrator is not started, else the number of packets ready for lgw_receive()
+*/
+int lgw_receive_wait( uint32_t timeout_ms );
+
+/**
+@brief Return the number of received packets dropped because lgw_receive() was not called fast enough
+@return the number of packets dropped since lgw_start()
+*/
+uint32_t lgw_receive_dropped( void );
+
+/**
+@brief Return the scan mode statistics of each channel
+@param stats pointer to an array of max_chan structures to be filled
+@param max_chan size of the stats array
+@return LGW_HAL_ERROR id the operation failed, else the number of channels filled (0 if scan mode is not enabled)
+*/
+int lgw_scan_get_stats( struct lgw_scan_stat_s* stats, uint8_t max_chan );
+
 /**
 @brief Schedule a packet to be send immediately or after a delay depending on tx_mode
 @param pkt_data structure containing the data and metadata for the packet to send
@@ -17,6 +17,9 @@ License: Revised BSD License, see LICENSE.TXT file include in the project
 
 #include <string.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
 #include "lorahub_aux.h"
 #include "lorahub_hal.h"
 #include "lorahub_hal_rx.h"
@@ -38,6 +41,9 @@ static const char* TAG_HAL_RX = "HAL_RX";
 
 #define RX_TIMEOUT_MS 120000 /* 2 minutes */
 
+#define CAD_SYMB_NB RAL_LORA_CAD_02_SYMB /* keep in sync with SCAN_CAD_SYMB */
+#define CAD_DET_MIN 10
+
 /* -------------------------------------------------------------------------- */
 /* --- PRIVATE TYPES --------------------------------------------------------- */
 
@@ -47,9 +53,15 @@ static const char* TAG_HAL_RX = "HAL_RX";
 static volatile bool irq_fired    = false;
 static uint32_t      irq_count_us = 0;
 
+static TaskHandle_t irq_task = NULL; /* task woken up on each DIO IRQ */
+
 static bool flag_rx_done      = false;
 static bool flag_rx_crc_error = false;
 static bool flag_rx_timeout   = false;
+static bool flag_cad_done     = false;
+static bool flag_cad_detected = false;
+
+static uint32_t cad_datarate = DR_UNDEFINED; /* datarate of the CAD parameters set in the radio */
 
 /* -------------------------------------------------------------------------- */
 /* --- PRIVATE FUNCTIONS DECLARATION ---------------------------------------- */
@@ -59,8 +71,16 @@ static bool flag_rx_timeout   = false;
 
 static void IRAM_ATTR radio_on_dio_irq( void* args )
 {
+    BaseType_t task_woken = pdFALSE;
+
     irq_fired = true;
     lgw_get_instcnt( &irq_count_us );
+
+    if( irq_task != NULL )
+    {
+        vTaskNotifyGiveFromISR( irq_task, &task_woken );
+        portYIELD_FROM_ISR( task_woken );
+    }
 }
 
 void radio_irq_process( const ral_t* ral )
@@ -88,6 +108,12 @@ void radio_irq_process( const ral_t* ral )
             ESP_LOGW( TAG_HAL_RX, "%lu: RX:IRQ_TIMEOUT", irq_count_us );
             flag_rx_timeout = true;
         }
+
+        if( ( irq_regs & RAL_IRQ_CAD_DONE ) == RAL_IRQ_CAD_DONE )
+        {
+            flag_cad_done     = true;
+            flag_cad_detected = ( ( irq_regs & RAL_IRQ_CAD_OK ) == RAL_IRQ_CAD_OK );
+        }
     }
 }
 
@@ -111,30 +137,11 @@ static void set_led_tx( const ral_t* ral, bool on )
     }
 }
 
-/* -------------------------------------------------------------------------- */
-/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
-
-int lgw_radio_init_rx( const ral_t* ral )
-{
-    const radio_context_t* radio_context = ( const radio_context_t* ) ( ral->context );
-
-    gpio_install_isr_service( 0 );
-    gpio_isr_handler_add( radio_context->gpio_dio1, radio_on_dio_irq, NULL );
-
-    return LGW_HAL_SUCCESS;
-}
-
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
-int lgw_radio_set_rx( const ral_t* ral, uint32_t freq_hz, uint32_t datarate, uint8_t bandwidth, uint8_t coderate )
+static int radio_get_lora_mod_params( uint32_t datarate, uint8_t bandwidth, uint8_t coderate,
+                                      ral_lora_mod_params_t* lora_mod_params )
 {
-    set_led_rx( ral, false );
-    set_led_tx( ral, false );
-
-    ASSERT_RAL_RC( ral_set_standby( ral, RAL_STANDBY_CFG_RC ) );
-
-    ASSERT_RAL_RC( ral_set_pkt_type( ral, RAL_PKT_TYPE_LORA ) );
-
     ral_lora_sf_t ral_dr;
     switch( datarate )
     {
@@ -202,10 +209,23 @@ int lgw_radio_set_rx( const ral_t* ral, uint32_t freq_hz, uint32_t datarate, uin
         return LGW_HAL_ERROR;
     }
 
-    ral_lora_mod_params_t lora_mod_params = {
-        .sf = ral_dr, .bw = ral_bw, .cr = ral_cr, .ldro = SET_PPM_ON( bandwidth, datarate )
-    };
-    ASSERT_RAL_RC( ral_set_lora_mod_params( ral, &lora_mod_params ) );
+    lora_mod_params->sf   = ral_dr;
+    lora_mod_params->bw   = ral_bw;
+    lora_mod_params->cr   = ral_cr;
+    lora_mod_params->ldro = SET_PPM_ON( bandwidth, datarate );
+
+    return LGW_HAL_SUCCESS;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static int radio_set_lora_modem( const ral_t* ral, const ral_lora_mod_params_t* lora_mod_params )
+{
+    ASSERT_RAL_RC( ral_set_standby( ral, RAL_STANDBY_CFG_RC ) );
+
+    ASSERT_RAL_RC( ral_set_pkt_type( ral, RAL_PKT_TYPE_LORA ) );
+
+    ASSERT_RAL_RC( ral_set_lora_mod_params( ral, lora_mod_params ) );
 
     const ral_lora_pkt_params_t lora_pkt_params = {
         .preamble_len_in_symb = STD_LORA_PREAMBLE,
@@ -217,6 +237,43 @@ int lgw_radio_set_rx( const ral_t* ral, uint32_t freq_hz, uint32_t datarate, uin
 
     ASSERT_RAL_RC( ral_set_lora_pkt_params( ral, &lora_pkt_params ) );
 
+    return LGW_HAL_SUCCESS;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+int lgw_radio_init_rx( const ral_t* ral, TaskHandle_t task )
+{
+    const radio_context_t* radio_context = ( const radio_context_t* ) ( ral->context );
+
+    irq_task = task;
+
+    gpio_install_isr_service( 0 );
+    gpio_isr_handler_add( radio_context->gpio_dio1, radio_on_dio_irq, NULL );
+
+    return LGW_HAL_SUCCESS;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+int lgw_radio_set_rx( const ral_t* ral, uint32_t freq_hz, uint32_t datarate, uint8_t bandwidth, uint8_t coderate )
+{
+    ral_lora_mod_params_t lora_mod_params;
+
+    set_led_rx( ral, false );
+    set_led_tx( ral, false );
+
+    if( radio_get_lora_mod_params( datarate, bandwidth, coderate, &lora_mod_params ) != LGW_HAL_SUCCESS )
+    {
+        return LGW_HAL_ERROR;
+    }
+    if( radio_set_lora_modem( ral, &lora_mod_params ) != LGW_HAL_SUCCESS )
+    {
+        return LGW_HAL_ERROR;
+    }
+    cad_datarate = DR_UNDEFINED;
+
     const ral_irq_t rx_irq_mask = RAL_IRQ_RX_DONE | RAL_IRQ_RX_CRC_ERROR | RAL_IRQ_RX_TIMEOUT;
     ASSERT_RAL_RC( ral_set_dio_irq_params( ral, rx_irq_mask ) );
     ASSERT_RAL_RC( ral_clear_irq_status( ral, RAL_IRQ_ALL ) );
@@ -231,6 +288,79 @@ int lgw_radio_set_rx( const ral_t* ral, uint32_t freq_hz, uint32_t datarate, uin
 
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
+int lgw_radio_set_cad( const ral_t* ral, uint32_t freq_hz, uint32_t datarate, uint8_t bandwidth, uint8_t coderate,
+                       uint32_t rx_timeout_ms, bool reconfigure )
+{
+    ral_lora_mod_params_t lora_mod_params;
+    ral_lora_cad_params_t lora_cad_params;
+
+    set_led_rx( ral, false );
+    set_led_tx( ral, false );
+
+    if( radio_get_lora_mod_params( datarate, bandwidth, coderate, &lora_mod_params ) != LGW_HAL_SUCCESS )
+    {
+        return LGW_HAL_ERROR;
+    }
+
+    /* Each radio command costs a few hundred us on boards where NSS and BUSY go through an IO expander, so a hop
+     * between two channels of the same SF only sets the frequency. After a CAD or a CAD_RX the radio is back in
+     * STDBY_RC with its IRQs just read and cleared by radio_irq_process(). */
+    if( reconfigure == true )
+    {
+        if( radio_set_lora_modem( ral, &lora_mod_params ) != LGW_HAL_SUCCESS )
+        {
+            return LGW_HAL_ERROR;
+        }
+
+        const ral_irq_t cad_irq_mask = RAL_IRQ_CAD_DONE | RAL_IRQ_CAD_OK | RAL_IRQ_RX_DONE | RAL_IRQ_RX_CRC_ERROR |
+                                       RAL_IRQ_RX_TIMEOUT;
+        ASSERT_RAL_RC( ral_set_dio_irq_params( ral, cad_irq_mask ) );
+        ASSERT_RAL_RC( ral_clear_irq_status( ral, RAL_IRQ_ALL ) );
+        ASSERT_RAL_RC( ral_set_lora_symb_nb_timeout( ral, 0 ) );
+    }
+    else if( datarate != cad_datarate )
+    {
+        ASSERT_RAL_RC( ral_set_lora_mod_params( ral, &lora_mod_params ) );
+    }
+
+    if( ( reconfigure == true ) || ( datarate != cad_datarate ) )
+    {
+        /* Stay in RX after a detection, until the packet is received or rx_timeout_ms */
+        lora_cad_params.cad_symb_nb         = CAD_SYMB_NB;
+        lora_cad_params.cad_det_min_in_symb = CAD_DET_MIN;
+        lora_cad_params.cad_exit_mode       = RAL_LORA_CAD_RX;
+        lora_cad_params.cad_timeout_in_ms   = rx_timeout_ms;
+        ASSERT_RAL_RC( ral_get_lora_cad_det_peak( ral, lora_mod_params.sf, lora_mod_params.bw, CAD_SYMB_NB,
+                                                  &lora_cad_params.cad_det_peak_in_symb ) );
+        ASSERT_RAL_RC( ral_set_lora_cad_params( ral, &lora_cad_params ) );
+        cad_datarate = datarate;
+    }
+
+    /* Set CAD */
+    ASSERT_RAL_RC( ral_set_rf_freq( ral, freq_hz ) );
+    ASSERT_RAL_RC( ral_set_lora_cad( ral ) );
+
+    return LGW_HAL_SUCCESS;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+int lgw_radio_get_cad( const ral_t* ral, bool* cad_done, bool* cad_detected )
+{
+    radio_irq_process( ral );
+
+    *cad_done     = flag_cad_done;
+    *cad_detected = flag_cad_detected;
+
+    /* Update status */
+    flag_cad_done     = false;
+    flag_cad_detected = false;
+
+    return LGW_HAL_SUCCESS;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
 int lgw_radio_get_pkt( const ral_t* ral, bool* irq_received, uint32_t* count_us, int8_t* rssi, int8_t* snr,
                        uint8_t* status, uint16_t* size, uint8_t* payload )
 {
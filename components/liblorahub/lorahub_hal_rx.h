@@ -18,6 +18,9 @@ License: Revised BSD License, see LICENSE.TXT file include in the project
 /* -------------------------------------------------------------------------- */
 /* --- DEPENDENCIES --------------------------------------------------------- */
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
 #include "ral.h"
 
 /* -------------------------------------------------------------------------- */
@@ -32,10 +35,36 @@ License: Revised BSD License, see LICENSE.TXT file include in the project
 /* -------------------------------------------------------------------------- */
 /* --- PUBLIC FUNCTIONS PROTOTYPES ------------------------------------------ */
 
-int lgw_radio_init_rx( const ral_t* ral );
+/**
+@brief Install the DIO interrupt handler
+@param ral radio abstraction layer instance
+@param task task notified (xTaskNotifyGive) each time the radio raises an IRQ
+@return LGW_HAL_SUCCESS
+*/
+int lgw_radio_init_rx( const ral_t* ral, TaskHandle_t task );
 
 int lgw_radio_set_rx( const ral_t* ral, uint32_t freq_hz, uint32_t datarate, uint8_t bandwidth, uint8_t coderate );
 
+/**
+@brief Start a CAD that switches to RX when a preamble is detected
+@param ral radio abstraction layer instance
+@param rx_timeout_ms RX timeout after a detection
+@param reconfigure true if the radio was used for something else since the previous CAD, or if the bandwidth or
+       coderate changed, false to only set what differs from the previous CAD (frequency, datarate)
+@return LGW_HAL_ERROR if a modulation parameter is not supported, LGW_HAL_SUCCESS else
+*/
+int lgw_radio_set_cad( const ral_t* ral, uint32_t freq_hz, uint32_t datarate, uint8_t bandwidth, uint8_t coderate,
+                       uint32_t rx_timeout_ms, bool reconfigure );
+
+/**
+@brief Read the CAD IRQs, the RX ones are kept for lgw_radio_get_pkt()
+@param ral radio abstraction layer instance
+@param cad_done [out] the CAD is over
+@param cad_detected [out] the CAD detected a preamble, the radio is now in RX
+@return LGW_HAL_SUCCESS
+*/
+int lgw_radio_get_cad( const ral_t* ral, bool* cad_done, bool* cad_detected );
+
 int lgw_radio_get_pkt( const ral_t* ral, bool* irq_received, uint32_t* count_us, int8_t* rssi, int8_t* snr,
                        uint8_t* status, uint16_t* size, uint8_t* payload );
 
@@ -0,0 +1,173 @@
+/*______                              _
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+(C)2024 Semtech
+
+Description:
+    LoRaHub Hardware Abstraction Layer - CAD scan
+
+    A single radio cannot listen to several channels at once. In scan mode it
+    hops over (channel, SF) slots running a short CAD on each one, and stays in
+    RX only when the CAD detects a preamble. This file only holds the slot
+    scheduling and the statistics, the radio is driven by lorahub_hal.c.
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include <string.h>
+
+#include "lorahub_hal.h"
+#include "lorahub_hal_scan.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define SCAN_CAD_SYMB 2  /* symbols listened to by each CAD, see lgw_radio_set_cad() */
+#define SCAN_LOCK_SYMB 2 /* preamble symbols left after the CAD for the receiver to lock on */
+#define SCAN_HDR_SYMB 13 /* sync word (4.25 symbols) and explicit header (8 symbols), rounded up */
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static struct lgw_scan_slot_s scan_slot[LGW_SCAN_SLOT_NB];
+static uint8_t                scan_slot_nb  = 0;
+static uint8_t                scan_slot_cur = 0;
+
+static struct lgw_scan_stat_s scan_stat[LGW_SCAN_CHAN_NB];
+static uint8_t                scan_chan_nb = 0;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint32_t scan_symbol_us( uint32_t datarate, uint8_t bandwidth )
+{
+    switch( bandwidth )
+    {
+    case BW_125KHZ:
+        return ( 1 << datarate ) * 8;
+    case BW_250KHZ:
+        return ( 1 << datarate ) * 4;
+    case BW_500KHZ:
+        return ( 1 << datarate ) * 2;
+    default:
+        return 0;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+int lgw_scan_init( const struct lgw_conf_scan_s* conf, uint8_t bandwidth, uint32_t count_us )
+{
+    uint32_t datarate;
+    uint32_t symbol_us;
+    uint8_t  i;
+
+    scan_slot_nb  = 0;
+    scan_slot_cur = 0;
+    scan_chan_nb  = ( conf->nb_chan < LGW_SCAN_CHAN_NB ) ? conf->nb_chan : LGW_SCAN_CHAN_NB;
+    if( conf->enable == false )
+    {
+        scan_chan_nb = 0;
+    }
+    memset( scan_stat, 0, sizeof( scan_stat ) );
+
+    /* SF major so that consecutive slots tend to share the modem configuration */
+    for( datarate = DR_LORA_SF5; datarate <= DR_LORA_SF12; datarate++ )
+    {
+        symbol_us = scan_symbol_us( datarate, bandwidth );
+        if( ( ( conf->datarate_mask & ( 1 << datarate ) ) == 0 ) || ( symbol_us == 0 ) )
+        {
+            continue;
+        }
+
+        for( i = 0; i < scan_chan_nb; i++ )
+        {
+            scan_slot[scan_slot_nb].freq_hz       = conf->freq_hz[i];
+            scan_slot[scan_slot_nb].datarate      = datarate;
+            scan_slot[scan_slot_nb].chan          = i;
+            scan_slot[scan_slot_nb].window_us     = ( STD_LORA_PREAMBLE - SCAN_CAD_SYMB - SCAN_LOCK_SYMB ) * symbol_us;
+            scan_slot[scan_slot_nb].rx_timeout_ms = ( STD_LORA_PREAMBLE + SCAN_HDR_SYMB ) * symbol_us / 1000 + 1;
+            scan_slot[scan_slot_nb].visit_us      = count_us;
+            scan_slot_nb += 1;
+        }
+    }
+
+    for( i = 0; i < scan_chan_nb; i++ )
+    {
+        scan_stat[i].freq_hz = conf->freq_hz[i];
+    }
+
+    return scan_slot_nb;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+const struct lgw_scan_slot_s* lgw_scan_next( uint32_t count_us )
+{
+    uint8_t  best     = scan_slot_cur;
+    uint64_t best_age = 0;
+    uint32_t best_win = 1;
+    uint64_t age;
+    uint8_t  i;
+    uint8_t  s;
+
+    /* Highest age / window wins, ties go to the first slot after the current one */
+    for( i = 1; i <= scan_slot_nb; i++ )
+    {
+        s   = ( scan_slot_cur + i ) % scan_slot_nb;
+        age = count_us - scan_slot[s].visit_us;
+        if( ( age * best_win ) > ( best_age * scan_slot[s].window_us ) )
+        {
+            best     = s;
+            best_age = age;
+            best_win = scan_slot[s].window_us;
+        }
+    }
+
+    scan_slot_cur                = best;
+    scan_slot[best].visit_us     = count_us;
+    scan_stat[scan_slot[best].chan].nb_cad += 1;
+
+    return &scan_slot[best];
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void lgw_scan_count_detect( void )
+{
+    scan_stat[scan_slot[scan_slot_cur].chan].nb_detect += 1;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void lgw_scan_count_rx( uint8_t status )
+{
+    if( status == STAT_CRC_OK )
+    {
+        scan_stat[scan_slot[scan_slot_cur].chan].nb_rx_ok += 1;
+    }
+    else
+    {
+        scan_stat[scan_slot[scan_slot_cur].chan].nb_rx_bad += 1;
+    }
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+int lgw_scan_copy_stats( struct lgw_scan_stat_s* stats, uint8_t max_chan )
+{
+    uint8_t nb_chan = ( max_chan < scan_chan_nb ) ? max_chan : scan_chan_nb;
+
+    memcpy( stats, scan_stat, nb_chan * sizeof( struct lgw_scan_stat_s ) );
+
+    return nb_chan;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,92 @@
+/*______                              _
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+(C)2024 Semtech
+
+Description:
+    LoRaHub Hardware Abstraction Layer - CAD scan
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+#ifndef _LORAHUB_HAL_SCAN_H
+#define _LORAHUB_HAL_SCAN_H
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include <stdint.h>  /* C99 types */
+#include <stdbool.h> /* bool type */
+
+#include "lorahub_hal.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC CONSTANTS ----------------------------------------------------- */
+
+#define LGW_SCAN_SLOT_NB ( LGW_SCAN_CHAN_NB * 8 ) /* one slot per (channel, SF5..SF12) */
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC TYPES --------------------------------------------------------- */
+
+/**
+@struct lgw_scan_slot_s
+@brief One (frequency, datarate) pair visited by the CAD scan
+*/
+struct lgw_scan_slot_s
+{
+    uint32_t freq_hz;       /*!> center frequency of the channel in Hz */
+    uint32_t datarate;      /*!> LoRa SF looked for on that channel */
+    uint8_t  chan;          /*!> channel index in lgw_conf_scan_s.freq_hz[] */
+    uint32_t window_us;     /*!> how late into a preamble a CAD can start and still catch the packet */
+    uint32_t rx_timeout_ms; /*!> RX time left after a detection to reach the end of the header */
+    uint32_t visit_us;      /*!> start of the last CAD on this slot */
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS PROTOTYPES ------------------------------------------ */
+
+/**
+@brief Build the slot table from the scan configuration and reset the statistics
+@param conf scan configuration, channels and datarates
+@param bandwidth LoRa bandwidth shared by all channels
+@param count_us current value of the internal counter
+@return the number of slots, 0 if the configuration gives nothing to scan
+*/
+int lgw_scan_init( const struct lgw_conf_scan_s* conf, uint8_t bandwidth, uint32_t count_us );
+
+/**
+@brief Select the slot on which to run the next CAD, and count a CAD on it
+@param count_us current value of the internal counter
+@return the selected slot
+
+The slot selected is the one that went unvisited for the longest time relative to its window, so that over a scan
+cycle every slot has the same chance of catching a preamble regardless of its SF (plain round robin would give SF12
+32 times the chance of SF7 for the same radio time).
+*/
+const struct lgw_scan_slot_s* lgw_scan_next( uint32_t count_us );
+
+/**
+@brief Count a preamble detected by the CAD on the current slot
+*/
+void lgw_scan_count_detect( void );
+
+/**
+@brief Count a packet received on the current slot
+@param status STAT_CRC_OK or STAT_CRC_BAD
+*/
+void lgw_scan_count_rx( uint8_t status );
+
+/**
+@brief Copy the statistics of each scanned channel, the caller serializes with the RX task
+@param stats pointer to an array of max_chan structures to be filled
+@param max_chan size of the stats array
+@return the number of channels filled, 0 if scan mode is not enabled
+*/
+int lgw_scan_copy_stats( struct lgw_scan_stat_s* stats, uint8_t max_chan );
+
+#endif  // _LORAHUB_HAL_SCAN_H
+
+/* --- EOF ------------------------------------------------------------------ */
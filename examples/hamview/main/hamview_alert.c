@@ -2,6 +2,8 @@
 
 #include <ctype.h>
 #include <math.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -11,7 +13,9 @@
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "freertos/semphr.h"
+#include "freertos/task.h"
 
 #include "hamview_screen.h"
 #include "hamview_settings.h"
@@ -28,22 +32,49 @@
 #define ALERT_COOLDOWN_US       (5ULL * 1000000ULL)
 #define ALERT_VOLUME_SCALE      (26000)
 #define ALERT_I2S_PORT          I2S_NUM_1
+#define ALERT_TONE_TABLE_MAX    (1024)
+#define ALERT_QUEUE_DEPTH       (16)
+#define ALERT_TASK_STACK        (4096)
+#define ALERT_TASK_PRIORITY     (3)
+
+typedef struct {
+    uint64_t queued_us;
+} alert_event_t;
 
 static const char *TAG = "hamview_alert";
 
 static SemaphoreHandle_t s_audio_mutex;
+static SemaphoreHandle_t s_rules_mutex;
 static bool s_initialized = false;
 static bool s_audio_ready = false;
 static bool s_audio_failed = false;
 static uint64_t s_last_alert_us = 0;
 static bool s_muted = false;
+static QueueHandle_t s_alert_queue = NULL;
+static TaskHandle_t s_alert_task = NULL;
+/* Bumped by the backend and alert tasks, read by the HTTP server. */
+static struct {
+    atomic_uint queued;
+    atomic_uint coalesced;
+    atomic_uint dropped;
+    atomic_uint tones_played;
+} s_stats;
+
+/* One loop of the alert tone. The table holds a whole number of periods so
+ * playback just walks it with a wrapping index. */
+static int16_t s_tone_table[ALERT_TONE_TABLE_MAX];
+static size_t s_tone_len = 0;
+static uint32_t s_tone_freq = 0;
+
+static bool ensure_alert_task(void);
 
 static bool ensure_initialized(void)
 {
     if (!s_initialized) {
         s_audio_mutex = xSemaphoreCreateMutex();
-        if (!s_audio_mutex) {
-            ESP_LOGE(TAG, "audio mutex alloc failed");
+        s_rules_mutex = xSemaphoreCreateMutex();
+        if (!s_audio_mutex || !s_rules_mutex) {
+            ESP_LOGE(TAG, "alert mutex alloc failed");
             s_audio_failed = true;
             return false;
         }
@@ -74,6 +105,35 @@ static esp_err_t ensure_audio_ready(void)
     return ESP_OK;
 }
 
+static uint32_t gcd_u32(uint32_t a, uint32_t b)
+{
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static void ensure_tone_table(uint32_t freq_hz)
+{
+    if (s_tone_len > 0 && s_tone_freq == freq_hz) {
+        return;
+    }
+    size_t len = ALERT_SAMPLE_RATE / gcd_u32(ALERT_SAMPLE_RATE, freq_hz);
+    if (len > ALERT_TONE_TABLE_MAX) {
+        /* Not an exact loop; the phase error at the wrap is inaudible for a
+         * short beep. */
+        len = ALERT_TONE_TABLE_MAX;
+    }
+    const float step = (2.0f * (float)M_PI * (float)freq_hz) / (float)ALERT_SAMPLE_RATE;
+    for (size_t i = 0; i < len; ++i) {
+        s_tone_table[i] = (int16_t)(sinf(step * (float)i) * (float)ALERT_VOLUME_SCALE);
+    }
+    s_tone_len = len;
+    s_tone_freq = freq_hz;
+}
+
 static void play_tone(uint32_t freq_hz, uint32_t duration_ms)
 {
     if (!ensure_initialized()) {
@@ -88,22 +148,20 @@ static void play_tone(uint32_t freq_hz, uint32_t duration_ms)
         return;
     }
 
+    ensure_tone_table(freq_hz);
     const size_t total_samples = (ALERT_SAMPLE_RATE * duration_ms) / 1000;
-    const float step = (2.0f * (float)M_PI * (float)freq_hz) / (float)ALERT_SAMPLE_RATE;
-    float phase = 0.0f;
+    size_t table_index = 0;
     int16_t samples[ALERT_BUFFER_SAMPLES * 2];
 
     size_t remaining = total_samples;
     while (remaining > 0) {
         size_t chunk = remaining > ALERT_BUFFER_SAMPLES ? ALERT_BUFFER_SAMPLES : remaining;
         for (size_t i = 0; i < chunk; ++i) {
-            float value = sinf(phase);
-            int16_t sample = (int16_t)(value * (float)ALERT_VOLUME_SCALE);
+            int16_t sample = s_tone_table[table_index];
             samples[2 * i] = sample;
             samples[2 * i + 1] = sample;
-            phase += step;
-            if (phase > 2.0f * (float)M_PI) {
-                phase -= 2.0f * (float)M_PI;
+            if (++table_index == s_tone_len) {
+                table_index = 0;
             }
         }
         size_t bytes_to_write = chunk * 2 * sizeof(int16_t);
@@ -119,22 +177,84 @@ static void play_tone(uint32_t freq_hz, uint32_t duration_ms)
     xSemaphoreGive(s_audio_mutex);
 }
 
-static bool equals_ignore_case(const char *a, const char *b)
-{
-    if (!a || !b) {
-        return false;
-    }
-    while (*a && *b) {
-        char ca = (char)toupper((unsigned char)*a);
-        char cb = (char)toupper((unsigned char)*b);
-        if (ca != cb) {
-            return false;
-        }
-        ++a;
-        ++b;
-    }
-    return (*a == '\0' && *b == '\0');
-}
+#define RULE_GROUP_STATE      (1u << 0)
+#define RULE_GROUP_COUNTRY    (1u << 1)
+#define RULE_GROUP_FILTER     (1u << 2)
+#define RULE_GROUP_KEYWORD    (1u << 3)
+#define RULE_GROUP_BAND       (1u << 4)
+
+#define RULE_COMMENT_GROUPS   (RULE_GROUP_STATE | RULE_GROUP_FILTER | RULE_GROUP_KEYWORD)
+
+#define RULE_TOKEN_DELIMS     ",;\n"
+
+typedef struct {
+    const char *name;
+    double min_mhz;
+    double max_mhz;
+} band_range_t;
+
+static const band_range_t BAND_RANGES[] = {
+    {"160", 1.8, 2.0},
+    {"80", 3.3, 4.1},
+    {"60", 5.2, 5.5},
+    {"40", 6.8, 7.5},
+    {"30", 9.9, 10.2},
+    {"20", 13.9, 14.5},
+    {"17", 17.9, 18.2},
+    {"15", 20.9, 21.5},
+    {"12", 24.8, 25.1},
+    {"10", 27.9, 30.1},
+    {"6", 50.0, 54.5},
+    {"2", 144.0, 149.0},
+    {"70", 420.0, 451.0},
+};
+
+#define BAND_RANGE_COUNT (sizeof(BAND_RANGES) / sizeof(BAND_RANGES[0]))
+
+static const char *PRIORITY_KEYWORDS[] = {"!", "ALERT", "DXPED", "DXPEDITION", "RARE", "SOTA", "POTA", "IOTA", "URGENT", "SPECIAL"};
+
+/* Open-addressed set of upper-case tokens; slots hold pool offset + 1. */
+typedef struct {
+    uint16_t *slots;
+    size_t mask;
+} rule_set_t;
+
+/* Aho-Corasick trie node. Children are kept as a sibling list because the
+ * pattern set is small and the alphabet is not. out_mask already includes
+ * the groups reachable through the failure chain. */
+typedef struct {
+    uint16_t first_child;
+    uint16_t next_sibling;
+    uint16_t fail;
+    uint8_t ch;
+    uint8_t out_mask;
+} rule_node_t;
+
+/* Immutable, compiled form of the alert-related settings. A new object is
+ * built whenever settings change and published with a single pointer swap,
+ * so matching never takes a lock. */
+typedef struct {
+    char *pool;
+    rule_set_t calls;
+    rule_set_t states;
+    rule_set_t continents;
+    rule_node_t *nodes;
+    size_t node_count;
+    struct {
+        double min_mhz;
+        double max_mhz;
+    } bands[BAND_RANGE_COUNT];
+    size_t band_count;
+    bool sound_enabled;
+} alert_rules_t;
+
+/* Matchers read s_rules without a lock. Each one registers in the reader
+ * count of the current epoch for the duration of its match. An update swaps
+ * the pointer, flips the epoch and waits for the old epoch's readers to
+ * leave before freeing the rules they may still hold. */
+static _Atomic(alert_rules_t *) s_rules = NULL;
+static atomic_uint s_rules_epoch = 0;
+static atomic_uint s_rules_readers[2];
 
 static bool contains_ignore_case(const char *haystack, const char *needle)
 {
@@ -166,186 +286,449 @@ static bool contains_ignore_case(const char *haystack, const char *needle)
     return false;
 }
 
-static void uppercase_copy(char *dst, size_t dst_len, const char *src)
+/* Yields the next trimmed, non-empty token of a comma/semicolon/newline
+ * separated list without modifying it. */
+static bool next_token(const char **cursor, const char **start, size_t *len)
 {
-    if (!dst || dst_len == 0) {
-        return;
-    }
-    if (!src) {
-        dst[0] = '\0';
-        return;
+    const char *p = *cursor;
+    while (*p) {
+        while (*p && strchr(RULE_TOKEN_DELIMS, *p)) {
+            p++;
+        }
+        const char *begin = p;
+        while (*p && !strchr(RULE_TOKEN_DELIMS, *p)) {
+            p++;
+        }
+        const char *end = p;
+        while (begin < end && isspace((unsigned char)*begin)) {
+            begin++;
+        }
+        while (end > begin && isspace((unsigned char)end[-1])) {
+            end--;
+        }
+        if (end > begin) {
+            *cursor = p;
+            *start = begin;
+            *len = (size_t)(end - begin);
+            return true;
+        }
     }
-    size_t len = strlcpy(dst, src, dst_len);
+    *cursor = p;
+    return false;
+}
+
+static size_t count_tokens(const char *list)
+{
+    const char *cursor = list;
+    const char *start = NULL;
+    size_t len = 0;
+    size_t count = 0;
+    while (next_token(&cursor, &start, &len)) {
+        count++;
+    }
+    return count;
+}
+
+static uint32_t hash_upper(const char *text, size_t len)
+{
+    uint32_t hash = 2166136261u;
     for (size_t i = 0; i < len; ++i) {
-        dst[i] = (char)toupper((unsigned char)dst[i]);
+        hash ^= (uint8_t)toupper((unsigned char)text[i]);
+        hash *= 16777619u;
     }
+    return hash;
 }
 
-static void trim_in_place(char *text)
+static bool rule_set_init(rule_set_t *set, size_t entries)
 {
-    if (!text) {
-        return;
+    set->slots = NULL;
+    set->mask = 0;
+    if (entries == 0) {
+        return true;
     }
-    size_t len = strlen(text);
-    size_t start = 0;
-    while (start < len && isspace((unsigned char)text[start])) {
-        start++;
+    size_t capacity = 8;
+    while (capacity < entries * 2) {
+        capacity <<= 1;
     }
-    size_t end = len;
-    while (end > start && isspace((unsigned char)text[end - 1])) {
-        end--;
+    set->slots = (uint16_t *)calloc(capacity, sizeof(uint16_t));
+    if (!set->slots) {
+        return false;
     }
-    if (start > 0 || end < len) {
-        memmove(text, text + start, end - start);
-        text[end - start] = '\0';
+    set->mask = capacity - 1;
+    return true;
+}
+
+static bool pool_equals_upper(const char *pooled, const char *text, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        if (pooled[i] != (char)toupper((unsigned char)text[i])) {
+            return false;
+        }
     }
+    return pooled[len] == '\0';
 }
 
-static bool token_list_match(const char *list, const char *value, bool substring)
+static bool rule_set_contains(const alert_rules_t *rules, const rule_set_t *set, const char *text)
 {
-    if (!list || list[0] == '\0' || !value || value[0] == '\0') {
+    if (!set->slots || !text || text[0] == '\0') {
         return false;
     }
-
-    char list_copy[128];
-    strlcpy(list_copy, list, sizeof(list_copy));
-
-    char value_upper[128];
-    uppercase_copy(value_upper, sizeof(value_upper), value);
-
-    char *token = strtok(list_copy, ",;\n");
-    while (token) {
-        trim_in_place(token);
-        if (*token) {
-            char token_upper[128];
-            uppercase_copy(token_upper, sizeof(token_upper), token);
-            if (substring) {
-                if (strstr(value_upper, token_upper)) {
-                    return true;
-                }
-            } else {
-                if (strcmp(value_upper, token_upper) == 0) {
-                    return true;
-                }
-            }
+    size_t len = strlen(text);
+    size_t slot = hash_upper(text, len) & set->mask;
+    while (set->slots[slot]) {
+        if (pool_equals_upper(&rules->pool[set->slots[slot] - 1], text, len)) {
+            return true;
         }
-        token = strtok(NULL, ",;\n");
+        slot = (slot + 1) & set->mask;
     }
     return false;
 }
 
-static bool band_filter_matches(const hamview_spot_t *spot, const char *filter)
+static void rule_set_add(alert_rules_t *rules, rule_set_t *set, size_t *pool_used, const char *text, size_t len)
 {
-    if (!spot || !filter || filter[0] == '\0') {
-        return false;
+    if (!set->slots || len == 0) {
+        return;
     }
-    double freq_mhz = atof(spot->frequency);
-    if (freq_mhz <= 0.0) {
-        return false;
+    size_t slot = hash_upper(text, len) & set->mask;
+    while (set->slots[slot]) {
+        if (pool_equals_upper(&rules->pool[set->slots[slot] - 1], text, len)) {
+            return;
+        }
+        slot = (slot + 1) & set->mask;
+    }
+    char *dst = &rules->pool[*pool_used];
+    for (size_t i = 0; i < len; ++i) {
+        dst[i] = (char)toupper((unsigned char)text[i]);
     }
+    dst[len] = '\0';
+    set->slots[slot] = (uint16_t)(*pool_used + 1);
+    *pool_used += len + 1;
+}
 
-    struct band_range {
-        const char *name;
-        double min_mhz;
-        double max_mhz;
-    };
+static void rule_set_add_list(alert_rules_t *rules, rule_set_t *set, size_t *pool_used, const char *list)
+{
+    const char *cursor = list;
+    const char *start = NULL;
+    size_t len = 0;
+    while (next_token(&cursor, &start, &len)) {
+        rule_set_add(rules, set, pool_used, start, len);
+    }
+}
 
-    static const struct band_range bands[] = {
-        {"160", 1.8, 2.0},
-        {"80", 3.3, 4.1},
-        {"60", 5.2, 5.5},
-        {"40", 6.8, 7.5},
-        {"30", 9.9, 10.2},
-        {"20", 13.9, 14.5},
-        {"17", 17.9, 18.2},
-        {"15", 20.9, 21.5},
-        {"12", 24.8, 25.1},
-        {"10", 27.9, 30.1},
-        {"6", 50.0, 54.5},
-        {"2", 144.0, 149.0},
-        {"70", 420.0, 451.0},
-    };
+static uint16_t trie_find_child(const alert_rules_t *rules, uint16_t node, uint8_t ch)
+{
+    uint16_t child = rules->nodes[node].first_child;
+    while (child && rules->nodes[child].ch != ch) {
+        child = rules->nodes[child].next_sibling;
+    }
+    return child;
+}
+
+static void trie_add(alert_rules_t *rules, const char *text, size_t len, uint8_t group)
+{
+    if (len == 0) {
+        return;
+    }
+    uint16_t node = 0;
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t ch = (uint8_t)toupper((unsigned char)text[i]);
+        uint16_t child = trie_find_child(rules, node, ch);
+        if (!child) {
+            child = (uint16_t)rules->node_count++;
+            rule_node_t *fresh = &rules->nodes[child];
+            memset(fresh, 0, sizeof(*fresh));
+            fresh->ch = ch;
+            fresh->next_sibling = rules->nodes[node].first_child;
+            rules->nodes[node].first_child = child;
+        }
+        node = child;
+    }
+    rules->nodes[node].out_mask |= group;
+}
+
+static void trie_add_list(alert_rules_t *rules, const char *list, uint8_t group)
+{
+    const char *cursor = list;
+    const char *start = NULL;
+    size_t len = 0;
+    while (next_token(&cursor, &start, &len)) {
+        trie_add(rules, start, len, group);
+    }
+}
 
-    for (size_t i = 0; i < sizeof(bands) / sizeof(bands[0]); ++i) {
-        if (contains_ignore_case(filter, bands[i].name)) {
-            if (freq_mhz >= bands[i].min_mhz && freq_mhz <= bands[i].max_mhz) {
-                return true;
+static bool trie_build_links(alert_rules_t *rules)
+{
+    uint16_t *queue = (uint16_t *)malloc(rules->node_count * sizeof(uint16_t));
+    if (!queue) {
+        return false;
+    }
+    size_t head = 0;
+    size_t tail = 0;
+    for (uint16_t child = rules->nodes[0].first_child; child; child = rules->nodes[child].next_sibling) {
+        rules->nodes[child].fail = 0;
+        queue[tail++] = child;
+    }
+    while (head < tail) {
+        uint16_t node = queue[head++];
+        for (uint16_t child = rules->nodes[node].first_child; child; child = rules->nodes[child].next_sibling) {
+            uint16_t fail = rules->nodes[node].fail;
+            uint16_t target = trie_find_child(rules, fail, rules->nodes[child].ch);
+            while (!target && fail) {
+                fail = rules->nodes[fail].fail;
+                target = trie_find_child(rules, fail, rules->nodes[child].ch);
             }
+            rules->nodes[child].fail = target;
+            rules->nodes[child].out_mask |= rules->nodes[target].out_mask;
+            queue[tail++] = child;
         }
     }
-    return false;
+    free(queue);
+    return true;
 }
 
-static bool has_priority_keyword(const hamview_spot_t *spot)
+/* Scans text once and reports whether any pattern in the wanted groups
+ * occurs in it, case-insensitively. */
+static bool trie_scan(const alert_rules_t *rules, const char *text, uint8_t wanted)
 {
-    static const char *KEYWORDS[] = {"ALERT", "DXPED", "DXPEDITION", "RARE", "SOTA", "POTA", "IOTA", "URGENT", "SPECIAL"};
-    if (!spot) {
+    if (!text || !rules->nodes) {
         return false;
     }
-    if (spot->comment[0]) {
-        if (strchr(spot->comment, '!')) {
-            return true;
+    uint16_t node = 0;
+    for (const char *p = text; *p; ++p) {
+        uint8_t ch = (uint8_t)toupper((unsigned char)*p);
+        uint16_t next = trie_find_child(rules, node, ch);
+        while (!next && node) {
+            node = rules->nodes[node].fail;
+            next = trie_find_child(rules, node, ch);
         }
-        for (size_t i = 0; i < sizeof(KEYWORDS) / sizeof(KEYWORDS[0]); ++i) {
-            if (contains_ignore_case(spot->comment, KEYWORDS[i])) {
-                return true;
-            }
+        node = next;
+        if (rules->nodes[node].out_mask & wanted) {
+            return true;
         }
     }
     return false;
 }
 
-void hamview_alert_init(void)
+static void free_rules(alert_rules_t *rules)
 {
-    ensure_initialized();
+    if (!rules) {
+        return;
+    }
+    free(rules->calls.slots);
+    free(rules->states.slots);
+    free(rules->continents.slots);
+    free(rules->nodes);
+    free(rules->pool);
+    free(rules);
 }
 
-bool hamview_alert_is_high_priority(const hamview_spot_t *spot)
+static alert_rules_t *compile_rules(const hamview_settings_t *settings)
 {
-    if (!spot) {
-        return false;
+    alert_rules_t *rules = (alert_rules_t *)calloc(1, sizeof(alert_rules_t));
+    if (!rules) {
+        return NULL;
+    }
+    rules->sound_enabled = settings->alert_sound_enabled;
+
+    size_t keyword_chars = 0;
+    for (size_t i = 0; i < sizeof(PRIORITY_KEYWORDS) / sizeof(PRIORITY_KEYWORDS[0]); ++i) {
+        keyword_chars += strlen(PRIORITY_KEYWORDS[i]);
+    }
+    size_t calls_len = strlen(settings->alert_callsigns);
+    size_t states_len = strlen(settings->alert_states);
+    size_t countries_len = strlen(settings->alert_countries);
+    size_t filter_call_len = strlen(settings->filter_callsign);
+    size_t filter_band_len = strlen(settings->filter_band);
+
+    size_t pool_size = calls_len + states_len + countries_len + filter_call_len + 4;
+    size_t node_capacity = 1 + keyword_chars + states_len + countries_len + filter_call_len + filter_band_len;
+
+    rules->pool = (char *)malloc(pool_size);
+    rules->nodes = (rule_node_t *)calloc(node_capacity, sizeof(rule_node_t));
+    if (!rules->pool || !rules->nodes ||
+        !rule_set_init(&rules->calls, count_tokens(settings->alert_callsigns) + (filter_call_len > 0 ? 1 : 0)) ||
+        !rule_set_init(&rules->states, count_tokens(settings->alert_states)) ||
+        !rule_set_init(&rules->continents, count_tokens(settings->alert_countries))) {
+        free_rules(rules);
+        return NULL;
+    }
+
+    size_t pool_used = 0;
+    rule_set_add_list(rules, &rules->calls, &pool_used, settings->alert_callsigns);
+    rule_set_add(rules, &rules->calls, &pool_used, settings->filter_callsign, filter_call_len);
+    rule_set_add_list(rules, &rules->states, &pool_used, settings->alert_states);
+    rule_set_add_list(rules, &rules->continents, &pool_used, settings->alert_countries);
+
+    rules->node_count = 1;
+    for (size_t i = 0; i < sizeof(PRIORITY_KEYWORDS) / sizeof(PRIORITY_KEYWORDS[0]); ++i) {
+        trie_add(rules, PRIORITY_KEYWORDS[i], strlen(PRIORITY_KEYWORDS[i]), RULE_GROUP_KEYWORD);
+    }
+    trie_add_list(rules, settings->alert_states, RULE_GROUP_STATE);
+    trie_add_list(rules, settings->alert_countries, RULE_GROUP_COUNTRY);
+    trie_add(rules, settings->filter_callsign, filter_call_len, RULE_GROUP_FILTER);
+    trie_add(rules, settings->filter_band, filter_band_len, RULE_GROUP_BAND);
+    if (!trie_build_links(rules)) {
+        free_rules(rules);
+        return NULL;
+    }
+
+    if (filter_band_len > 0) {
+        for (size_t i = 0; i < BAND_RANGE_COUNT; ++i) {
+            if (contains_ignore_case(settings->filter_band, BAND_RANGES[i].name)) {
+                rules->bands[rules->band_count].min_mhz = BAND_RANGES[i].min_mhz;
+                rules->bands[rules->band_count].max_mhz = BAND_RANGES[i].max_mhz;
+                rules->band_count++;
+            }
+        }
     }
-    hamview_settings_t settings;
-    hamview_settings_get(&settings);
+    return rules;
+}
 
-    if (settings.alert_callsigns[0]) {
-        if (token_list_match(settings.alert_callsigns, spot->callsign, false) ||
-            token_list_match(settings.alert_callsigns, spot->spotter, false)) {
-            return true;
+/* Every call must be paired with rules_read_end(*epoch), also when it
+ * returns NULL. */
+static const alert_rules_t *rules_read_begin(unsigned *epoch)
+{
+    if (!atomic_load(&s_rules)) {
+        hamview_alert_on_settings_updated();
+    }
+    while (true) {
+        unsigned e = atomic_load(&s_rules_epoch) & 1;
+        atomic_fetch_add(&s_rules_readers[e], 1);
+        /* Counted in an epoch an update has already flipped away from: the
+         * update may have stopped waiting for it. Retry in the new one. */
+        if ((atomic_load(&s_rules_epoch) & 1) == e) {
+            *epoch = e;
+            return atomic_load(&s_rules);
         }
+        atomic_fetch_sub(&s_rules_readers[e], 1);
     }
+}
 
-    if (settings.alert_states[0]) {
-        if (token_list_match(settings.alert_states, spot->state, false) ||
-            token_list_match(settings.alert_states, spot->comment, true)) {
+static void rules_read_end(unsigned epoch)
+{
+    atomic_fetch_sub(&s_rules_readers[epoch], 1);
+}
+
+static bool band_rules_match(const alert_rules_t *rules, const hamview_spot_t *spot)
+{
+    if (rules->band_count == 0) {
+        return false;
+    }
+    double freq_mhz = strtod(spot->frequency, NULL);
+    if (freq_mhz <= 0.0) {
+        return false;
+    }
+    for (size_t i = 0; i < rules->band_count; ++i) {
+        if (freq_mhz >= rules->bands[i].min_mhz && freq_mhz <= rules->bands[i].max_mhz) {
             return true;
         }
     }
+    return false;
+}
 
-    if (settings.alert_countries[0]) {
-        if (token_list_match(settings.alert_countries, spot->country, true) ||
-            token_list_match(settings.alert_countries, spot->dxcc, true) ||
-            token_list_match(settings.alert_countries, spot->continent, false)) {
-            return true;
-        }
+void hamview_alert_init(void)
+{
+    if (ensure_initialized()) {
+        ensure_alert_task();
     }
+    if (!atomic_load_explicit(&s_rules, memory_order_acquire)) {
+        hamview_alert_on_settings_updated();
+    }
+}
 
-    if (settings.filter_callsign[0]) {
-        if (equals_ignore_case(spot->callsign, settings.filter_callsign) ||
-            equals_ignore_case(spot->spotter, settings.filter_callsign) ||
-            contains_ignore_case(spot->comment, settings.filter_callsign)) {
-            return true;
-        }
+void hamview_alert_on_settings_updated(void)
+{
+    if (!ensure_initialized()) {
+        return;
     }
+    /* Compile straight from the snapshot instead of copying it. */
+    unsigned settings_epoch;
+    const hamview_settings_t *settings = hamview_settings_acquire(&settings_epoch);
+    alert_rules_t *rules = settings ? compile_rules(settings) : NULL;
+    hamview_settings_release(settings_epoch);
+    if (!rules) {
+        ESP_LOGE(TAG, "alert rule compile failed; keeping previous rules");
+        return;
+    }
+    xSemaphoreTake(s_rules_mutex, portMAX_DELAY);
+    alert_rules_t *previous = atomic_exchange(&s_rules, rules);
+    unsigned old_epoch = atomic_fetch_xor(&s_rules_epoch, 1) & 1;
+    while (atomic_load(&s_rules_readers[old_epoch]) != 0) {
+        vTaskDelay(1);
+    }
+    xSemaphoreGive(s_rules_mutex);
+    free_rules(previous);
+}
 
-    if (settings.filter_band[0]) {
-        if (contains_ignore_case(spot->frequency, settings.filter_band) ||
-            band_filter_matches(spot, settings.filter_band)) {
-            return true;
+bool hamview_alert_is_high_priority(const hamview_spot_t *spot)
+{
+    if (!spot) {
+        return false;
+    }
+    unsigned epoch;
+    const alert_rules_t *rules = rules_read_begin(&epoch);
+    bool match = rules &&
+                 (rule_set_contains(rules, &rules->calls, spot->callsign) ||
+                  rule_set_contains(rules, &rules->calls, spot->spotter) ||
+                  rule_set_contains(rules, &rules->states, spot->state) ||
+                  rule_set_contains(rules, &rules->continents, spot->continent) ||
+                  trie_scan(rules, spot->comment, RULE_COMMENT_GROUPS) ||
+                  trie_scan(rules, spot->country, RULE_GROUP_COUNTRY) ||
+                  trie_scan(rules, spot->dxcc, RULE_GROUP_COUNTRY) ||
+                  trie_scan(rules, spot->frequency, RULE_GROUP_BAND) ||
+                  band_rules_match(rules, spot));
+    rules_read_end(epoch);
+    return match;
+}
+
+/* Runs off the ingestion path. Alerts arriving while a tone is playing or
+ * within the cooldown window are folded into the last tone. */
+static void alert_task(void *arg)
+{
+    (void)arg;
+    alert_event_t event;
+    while (true) {
+        if (xQueueReceive(s_alert_queue, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        hamview_screen_record_activity();
+
+        unsigned epoch;
+        const alert_rules_t *rules = rules_read_begin(&epoch);
+        bool sound_enabled = rules && rules->sound_enabled;
+        rules_read_end(epoch);
+        if (!sound_enabled || s_muted) {
+            continue;
+        }
+        uint64_t now = esp_timer_get_time();
+        if (s_last_alert_us != 0 && now - s_last_alert_us < ALERT_COOLDOWN_US) {
+            atomic_fetch_add_explicit(&s_stats.coalesced, 1, memory_order_relaxed);
+            continue;
         }
+        s_last_alert_us = now;
+        atomic_fetch_add_explicit(&s_stats.tones_played, 1, memory_order_relaxed);
+        play_tone(ALERT_FREQ_HZ, ALERT_DURATION_MS);
     }
+}
 
-    return has_priority_keyword(spot);
+static bool ensure_alert_task(void)
+{
+    if (s_alert_task) {
+        return true;
+    }
+    if (!s_alert_queue) {
+        s_alert_queue = xQueueCreate(ALERT_QUEUE_DEPTH, sizeof(alert_event_t));
+        if (!s_alert_queue) {
+            ESP_LOGE(TAG, "alert queue alloc failed");
+            return false;
+        }
+    }
+    if (xTaskCreatePinnedToCore(alert_task, "hamview_alert", ALERT_TASK_STACK, NULL, ALERT_TASK_PRIORITY, &s_alert_task, tskNO_AFFINITY) != pdPASS) {
+        ESP_LOGE(TAG, "alert task create failed");
+        s_alert_task = NULL;
+        return false;
+    }
+    return true;
 }
 
 void hamview_alert_notify(const hamview_spot_t *spot)
@@ -356,23 +739,28 @@ void hamview_alert_notify(const hamview_spot_t *spot)
     if (s_muted) {
         return;
     }
-    hamview_alert_init();
-    hamview_settings_t settings;
-    hamview_settings_get(&settings);
-
-    bool sound_enabled = settings.alert_sound_enabled;
-
-
-    hamview_screen_record_activity();
+    if (!s_alert_task && !ensure_alert_task()) {
+        return;
+    }
+    alert_event_t event = {
+        .queued_us = (uint64_t)esp_timer_get_time(),
+    };
+    if (xQueueSend(s_alert_queue, &event, 0) == pdTRUE) {
+        atomic_fetch_add_explicit(&s_stats.queued, 1, memory_order_relaxed);
+    } else {
+        atomic_fetch_add_explicit(&s_stats.dropped, 1, memory_order_relaxed);
+    }
+}
 
-    if (sound_enabled) {
-        uint64_t now = esp_timer_get_time();
-        if (now - s_last_alert_us < ALERT_COOLDOWN_US) {
-            return;
-        }
-        s_last_alert_us = now;
-        play_tone(ALERT_FREQ_HZ, ALERT_DURATION_MS);
+void hamview_alert_get_stats(hamview_alert_stats_t *out)
+{
+    if (!out) {
+        return;
     }
+    out->queued = atomic_load_explicit(&s_stats.queued, memory_order_relaxed);
+    out->coalesced = atomic_load_explicit(&s_stats.coalesced, memory_order_relaxed);
+    out->dropped = atomic_load_explicit(&s_stats.dropped, memory_order_relaxed);
+    out->tones_played = atomic_load_explicit(&s_stats.tones_played, memory_order_relaxed);
 }
 
 void hamview_alert_set_muted(bool muted)
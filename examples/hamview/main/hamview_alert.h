@@ -2,6 +2,7 @@
 #define HAMVIEW_ALERT_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "hamview_backend.h"
 
@@ -9,12 +10,21 @@
 extern "C" {
 #endif
 
+typedef struct {
+    uint32_t queued;
+    uint32_t coalesced;
+    uint32_t dropped;
+    uint32_t tones_played;
+} hamview_alert_stats_t;
+
 void hamview_alert_init(void);
+void hamview_alert_on_settings_updated(void);
 bool hamview_alert_is_high_priority(const hamview_spot_t *spot);
 void hamview_alert_notify(const hamview_spot_t *spot);
 void hamview_alert_set_muted(bool muted);
 bool hamview_alert_is_muted(void);
 void hamview_alert_toggle_muted(void);
+void hamview_alert_get_stats(hamview_alert_stats_t *out);
 
 #ifdef __cplusplus
 }
@@ -2,6 +2,8 @@
 
 #include <ctype.h>
 #include <errno.h>
+#include <inttypes.h>
+#include <stdatomic.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -13,12 +15,12 @@
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 
-#include "cJSON.h"
 #include "esp_event.h"
 #include "esp_http_client.h"
 #include "esp_sntp.h"
 #include "esp_log.h"
 #include "esp_heap_caps.h"
+#include "esp_system.h"
 #include "esp_timer.h"
 #include "esp_wifi.h"
 #include "lwip/inet.h"
@@ -34,33 +36,74 @@
 #include "hamview_settings.h"
 #include "hamview_alert.h"
 #include "hamview_event_log.h"
+#include "hamview_history.h"
+#include "hamview_history_store.h"
+#include "hamview_ingest.h"
+#include "hamview_json.h"
+#include "hamview_spot_parser.h"
+#include "hamview_spot_ring.h"
+#include "hamview_stream.h"
+#include "hamview_ui.h"
 #include "hamview_weather.h"
+#include "lv_port.h"
 
 extern esp_err_t esp_crt_bundle_attach(void *conf);
 
+/* Overridable so the telnet feed can be pointed at a local stand-in that
+ * replays a recorded session. */
+#ifndef HAMALERT_HOST
 #define HAMALERT_HOST "hamalert.org"
+#endif
+#ifndef HAMALERT_PORT
 #define HAMALERT_PORT 7300
+#endif
 #define REST_URL_BASE "https://hamalert.org/api.php"
 #define HTTP_PORT 8080
+#define HTTP_JSON_BUF_SIZE 2048
+#define HTTP_SPOTS_JSON_SIZE (2 + HAMVIEW_MAX_SPOTS * (HAMVIEW_JSON_STRING_MAX(sizeof(hamview_spot_t)) + 192))
+#define HTTP_HISTORY_PAGE_MAX 20
+#define HTTP_HISTORY_JSON_SIZE (64 + HTTP_HISTORY_PAGE_MAX * (HAMVIEW_JSON_STRING_MAX(sizeof(hamview_spot_t)) + 192))
 #define FETCH_INTERVAL_MS 30000
 #define KEEPALIVE_INTERVAL_MS 120000
-#define HAMVIEW_HISTORY_MAX_SPOTS 512
+#define HAMVIEW_HISTORY_MAX_SPOTS 16384
+#define HISTORY_RESTORE_WAIT_MS 15000
+/* Monotonic timestamps start this far past zero so spots restored from the
+ * flash log, which predate this boot, still get a positive received_us. */
+#define BACKEND_CLOCK_BASE_US (48ULL * 60ULL * 60ULL * 1000000ULL)
 
 #define BACKEND_EVENT_SETTINGS (1 << 0)
 
+/* Rolling activity counter. epoch is the absolute bucket number
+ * (received_us / span) the count belongs to; a slot is reset the first
+ * time a newer epoch maps onto it. */
 typedef struct {
-    hamview_spot_t spot;
-    uint64_t received_us;
-} stored_spot_t;
+    uint32_t epoch;
+    uint16_t count;
+} activity_bucket_t;
 
 static const char *TAG = "hamview_backend";
 
-static stored_spot_t s_spots[HAMVIEW_MAX_SPOTS];
-static size_t s_spot_count = 0;
+static stored_spot_t s_spot_slots[HAMVIEW_MAX_SPOTS];
+static spot_ring_t s_spots = {
+    .entries = s_spot_slots,
+    .capacity = HAMVIEW_MAX_SPOTS,
+};
 static SemaphoreHandle_t s_spot_mutex;
-static stored_spot_t *s_history_spots = NULL;
-static size_t s_history_capacity = 0;
-static size_t s_history_count = 0;
+static activity_bucket_t s_timeline_buckets[HAMVIEW_ACTIVITY_BUCKET_COUNT];
+static activity_bucket_t s_hourly_buckets[HAMVIEW_ACTIVITY_HOURLY_COUNT];
+static uint32_t s_mode_totals[HAMVIEW_ACTIVITY_MODE_COUNT];
+
+#define ACTIVITY_BUCKET_SPAN_US ((uint64_t)HAMVIEW_ACTIVITY_BUCKET_MINUTES * 60ULL * 1000000ULL)
+#define ACTIVITY_HOUR_SPAN_US (60ULL * 60ULL * 1000000ULL)
+
+/* Copy-on-write double buffer. The writer only ever fills the buffer that is
+ * not published and has no readers pinned on it; if a reader is still
+ * holding it, the publish is deferred to the next acquire. */
+static hamview_backend_snapshot_t s_snapshots[2];
+static atomic_uint s_snapshot_refs[2];
+static atomic_int s_snapshot_active = 0;
+static atomic_bool s_snapshot_stale = true;
+static uint32_t s_snapshot_generation = 0;
 
 static bool s_wifi_connected = false;
 static bool s_hamalert_connected = false;
@@ -74,9 +117,35 @@ static EventGroupHandle_t s_backend_events;
 static TaskHandle_t s_backend_task_handle = NULL;
 static httpd_handle_t s_httpd = NULL;
 
+/* Response buffers for the JSON endpoints. httpd serves requests from a
+ * single task, so these need no locking. The spots body is only rebuilt
+ * when the snapshot generation moves. */
+static char s_http_json_buf[HTTP_JSON_BUF_SIZE];
+static char *s_spots_json = NULL;
+static size_t s_spots_json_len = 0;
+static uint32_t s_spots_json_generation = 0;
+static char *s_history_json = NULL;
+static hamview_spot_t *s_history_rows = NULL;
+static uint32_t s_http_requests = 0;
+static uint32_t s_http_not_modified = 0;
+static uint32_t s_http_serializations = 0;
+static uint32_t s_http_etag_nonce = 0;
+
 static hamview_settings_t s_settings;
 static uint64_t s_last_fetch_us = 0;
 
+static void mark_snapshot_stale(void)
+{
+    atomic_store(&s_snapshot_stale, true);
+}
+
+/* Status changes come from other tasks; wake the UI to pick them up. */
+static void mark_snapshot_stale_and_notify(void)
+{
+    mark_snapshot_stale();
+    lv_port_notify();
+}
+
 static void set_last_error(const char *fmt, ...)
 {
     if (!s_status_mutex) return;
@@ -86,6 +155,7 @@ static void set_last_error(const char *fmt, ...)
     vsnprintf(s_last_error, sizeof(s_last_error), fmt, args);
     xSemaphoreGive(s_status_mutex);
     va_end(args);
+    mark_snapshot_stale_and_notify();
     if (s_last_error[0]) {
         hamview_event_log_append("backend", "%s", s_last_error);
     }
@@ -93,15 +163,16 @@ static void set_last_error(const char *fmt, ...)
 
 static uint64_t now_us(void)
 {
-    return esp_timer_get_time();
+    return (uint64_t)esp_timer_get_time() + BACKEND_CLOCK_BASE_US;
 }
+static bool is_time_valid(void);
 static void prune_expired_spots_locked(uint64_t now_us);
 static uint64_t spot_ttl_us(void);
 static void prune_history_locked(uint64_t now_us);
 static uint32_t history_window_minutes(void);
 static uint32_t classify_activity_mode(const char *mode_text);
-static esp_err_t ensure_history_buffer(void);
 static size_t history_capacity(void);
+static void publish_snapshot_locked(uint64_t now);
 
 static void copy_status(hamview_status_t *out)
 {
@@ -127,6 +198,7 @@ static void set_hamalert_connected(bool connected)
         s_last_fetch_us = 0;
     }
     xSemaphoreGive(s_status_mutex);
+    mark_snapshot_stale_and_notify();
     hamview_event_log_append("backend", "HamAlert %s", connected ? "connected" : "offline");
 }
 
@@ -135,57 +207,117 @@ static void set_ip_address(const char *ip_str)
     xSemaphoreTake(s_status_mutex, portMAX_DELAY);
     strlcpy(s_ip_address, ip_str ? ip_str : "", sizeof(s_ip_address));
     xSemaphoreGive(s_status_mutex);
+    mark_snapshot_stale_and_notify();
     hamview_event_log_append("backend", "IP %s", (ip_str && *ip_str) ? ip_str : "cleared");
 }
 
-static void update_spot(const hamview_spot_t *spot)
+static void activity_bucket_add(activity_bucket_t *buckets, size_t count, uint32_t epoch)
 {
-    if (!spot) return;
-    if (!s_spot_mutex) return;
-    xSemaphoreTake(s_spot_mutex, portMAX_DELAY);
+    activity_bucket_t *slot = &buckets[epoch % count];
+    if (slot->epoch != epoch) {
+        slot->epoch = epoch;
+        slot->count = 0;
+    }
+    if (slot->count < UINT16_MAX) {
+        slot->count++;
+    }
+}
 
-    uint64_t now = now_us();
-    hamview_spot_t alert_candidate = {0};
-    bool trigger_alert = false;
-    for (int i = (int)HAMVIEW_MAX_SPOTS - 1; i > 0; --i) {
-        s_spots[i] = s_spots[i - 1];
+static void activity_bucket_remove(activity_bucket_t *buckets, size_t count, uint32_t epoch)
+{
+    activity_bucket_t *slot = &buckets[epoch % count];
+    if (slot->epoch == epoch && slot->count > 0) {
+        slot->count--;
     }
-    s_spots[0].spot = *spot;
-    s_spots[0].received_us = now;
-    s_spots[0].spot.is_new = true;
+}
 
-    size_t history_cap = history_capacity();
-    if (history_cap > 0) {
-        for (size_t i = history_cap; i > 1; --i) {
-            s_history_spots[i - 1] = s_history_spots[i - 2];
-        }
-        s_history_spots[0].spot = *spot;
-        s_history_spots[0].spot.is_new = true;
-        s_history_spots[0].received_us = now;
-        if (s_history_count < history_cap) {
-            ++s_history_count;
+/* Copies the count buckets ending at current_epoch into out, oldest first. */
+static void activity_bucket_read(const activity_bucket_t *buckets, size_t count, uint32_t current_epoch, uint16_t *out)
+{
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t back = (uint32_t)(count - 1 - i);
+        if (back > current_epoch) {
+            out[i] = 0;
+            continue;
         }
-    } else {
-        s_history_count = 0;
+        uint32_t epoch = current_epoch - back;
+        const activity_bucket_t *slot = &buckets[epoch % count];
+        out[i] = (slot->epoch == epoch) ? slot->count : 0;
     }
+}
 
-    if (hamview_alert_is_high_priority(&s_spots[0].spot)) {
-        alert_candidate = s_spots[0].spot;
-        trigger_alert = true;
+static void history_on_insert(uint64_t received_us, uint8_t mode_class)
+{
+    activity_bucket_add(s_timeline_buckets, HAMVIEW_ACTIVITY_BUCKET_COUNT,
+                        (uint32_t)(received_us / ACTIVITY_BUCKET_SPAN_US));
+    activity_bucket_add(s_hourly_buckets, HAMVIEW_ACTIVITY_HOURLY_COUNT,
+                        (uint32_t)(received_us / ACTIVITY_HOUR_SPAN_US));
+    if (mode_class < HAMVIEW_ACTIVITY_MODE_COUNT) {
+        s_mode_totals[mode_class]++;
     }
+}
 
-    if (s_spot_count < HAMVIEW_MAX_SPOTS) {
-        s_spot_count++;
+/* History keeps whole seconds; both spans are whole seconds too, so the
+ * truncated timestamp lands in the same bucket the insert counted. */
+static void history_on_evict(uint64_t received_us, uint8_t mode_class)
+{
+    activity_bucket_remove(s_timeline_buckets, HAMVIEW_ACTIVITY_BUCKET_COUNT,
+                           (uint32_t)(received_us / ACTIVITY_BUCKET_SPAN_US));
+    activity_bucket_remove(s_hourly_buckets, HAMVIEW_ACTIVITY_HOURLY_COUNT,
+                           (uint32_t)(received_us / ACTIVITY_HOUR_SPAN_US));
+    if (mode_class < HAMVIEW_ACTIVITY_MODE_COUNT && s_mode_totals[mode_class] > 0) {
+        s_mode_totals[mode_class]--;
     }
+}
+
+static void update_spot(const hamview_spot_t *spot)
+{
+    if (!spot) return;
+    if (!s_spot_mutex) return;
+    xSemaphoreTake(s_spot_mutex, portMAX_DELAY);
 
-    for (size_t i = 1; i < s_spot_count; ++i) {
-        s_spots[i].spot.is_new = false;
+    uint64_t now = now_us();
+    hamview_spot_t alert_candidate = {0};
+    bool trigger_alert = false;
+
+    stored_spot_t *latest = spot_ring_push(&s_spots);
+    latest->spot = *spot;
+    latest->spot.is_new = true;
+    latest->received_us = now;
+    latest->mode_class = (uint8_t)classify_activity_mode(spot->mode);
+
+    if (history_capacity() > 0) {
+        hamview_history_push(&latest->spot, now, latest->mode_class);
+        history_on_insert(now, latest->mode_class);
+    }
+    if (is_time_valid()) {
+        hamview_history_record_t record = {
+            .epoch = (uint32_t)time(NULL),
+            .mode_class = latest->mode_class,
+        };
+        strlcpy(record.callsign, spot->callsign, sizeof(record.callsign));
+        strlcpy(record.frequency, spot->frequency, sizeof(record.frequency));
+        strlcpy(record.mode, spot->mode, sizeof(record.mode));
+        strlcpy(record.spotter, spot->spotter, sizeof(record.spotter));
+        strlcpy(record.dxcc, spot->dxcc, sizeof(record.dxcc));
+        strlcpy(record.continent, spot->continent, sizeof(record.continent));
+        strlcpy(record.country, spot->country, sizeof(record.country));
+        strlcpy(record.comment, spot->comment, sizeof(record.comment));
+        hamview_history_store_append(&record);
+    }
+
+    if (hamview_alert_is_high_priority(&latest->spot)) {
+        alert_candidate = latest->spot;
+        trigger_alert = true;
     }
 
     prune_expired_spots_locked(now);
     prune_history_locked(now);
+    publish_snapshot_locked(now);
 
     xSemaphoreGive(s_spot_mutex);
+    lv_port_notify();
+    hamview_stream_publish_spot(spot);
 
     if (trigger_alert) {
         hamview_alert_notify(&alert_candidate);
@@ -225,67 +357,16 @@ static uint32_t history_window_minutes(void)
 
 static size_t history_capacity(void)
 {
-    return (s_history_spots && s_history_capacity > 0) ? s_history_capacity : 0;
-}
-
-static esp_err_t ensure_history_buffer(void)
-{
-    if (s_history_spots) {
-        return ESP_OK;
-    }
-
-    size_t capacity = (size_t)HAMVIEW_HISTORY_MAX_SPOTS;
-    stored_spot_t *buffer = NULL;
-
-    while (capacity >= 64 && !buffer) {
-        size_t bytes = capacity * sizeof(stored_spot_t);
-        buffer = (stored_spot_t *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-        if (!buffer) {
-            buffer = (stored_spot_t *)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-        }
-        if (buffer) {
-            memset(buffer, 0, bytes);
-            s_history_spots = buffer;
-            s_history_capacity = capacity;
-            s_history_count = 0;
-            ESP_LOGI(TAG, "History buffer allocated for %zu spots", capacity);
-            return ESP_OK;
-        }
-        capacity /= 2;
-    }
-
-    ESP_LOGE(TAG, "Failed to allocate history buffer (requested %u spots)", HAMVIEW_HISTORY_MAX_SPOTS);
-    s_history_capacity = 0;
-    s_history_count = 0;
-    return ESP_ERR_NO_MEM;
+    return hamview_history_capacity();
 }
 
 static void prune_history_locked(uint64_t now)
 {
-    size_t history_cap = history_capacity();
-    if (history_cap == 0 || s_history_count == 0) {
-        s_history_count = 0;
+    if (history_capacity() == 0) {
         return;
     }
-    if (s_history_count > history_cap) {
-        s_history_count = history_cap;
-    }
     uint64_t window_us = (uint64_t)history_window_minutes() * 60ULL * 1000000ULL;
-    size_t write = 0;
-    for (size_t read = 0; read < s_history_count; ++read) {
-        uint64_t age_us = (now >= s_history_spots[read].received_us)
-                              ? (now - s_history_spots[read].received_us)
-                              : 0;
-        if (age_us <= window_us) {
-            if (write != read) {
-                s_history_spots[write] = s_history_spots[read];
-            }
-            ++write;
-        }
-    }
-    if (write < s_history_count) {
-        s_history_count = write;
-    }
+    hamview_history_expire(now, window_us);
 }
 
 static uint32_t classify_activity_mode(const char *mode_text)
@@ -314,25 +395,64 @@ static uint32_t classify_activity_mode(const char *mode_text)
 static void prune_expired_spots_locked(uint64_t now)
 {
     uint64_t ttl = spot_ttl_us();
-    if (ttl == 0 || s_spot_count == 0) {
+    if (ttl == 0) {
         return;
     }
+    size_t before = s_spots.count;
+    spot_ring_expire(&s_spots, now, ttl);
+    if (s_spots.count != before) {
+        mark_snapshot_stale();
+    }
+}
 
-    size_t write = 0;
-    for (size_t read = 0; read < s_spot_count; ++read) {
-        uint64_t age_us = (now >= s_spots[read].received_us)
-                              ? (now - s_spots[read].received_us)
-                              : 0;
-        if (age_us <= ttl) {
-            if (write != read) {
-                s_spots[write] = s_spots[read];
-            }
-            ++write;
+static uint64_t snapshot_refresh_deadline_locked(uint64_t now)
+{
+    uint64_t deadline = (now / ACTIVITY_BUCKET_SPAN_US + 1) * ACTIVITY_BUCKET_SPAN_US;
+    uint64_t ttl = spot_ttl_us();
+    if (ttl > 0 && s_spots.count > 0) {
+        uint64_t expiry = spot_ring_at(&s_spots, s_spots.count - 1)->received_us + ttl + 1;
+        if (expiry < deadline) {
+            deadline = expiry;
         }
     }
+    return deadline;
+}
 
-    if (write < s_spot_count) {
-        s_spot_count = write;
+static void publish_snapshot_locked(uint64_t now)
+{
+    int next = 1 - atomic_load(&s_snapshot_active);
+    if (atomic_load(&s_snapshot_refs[next]) != 0) {
+        mark_snapshot_stale();
+        return;
+    }
+    atomic_store(&s_snapshot_stale, false);
+
+    hamview_backend_snapshot_t *snap = &s_snapshots[next];
+    snap->generation = ++s_snapshot_generation;
+    snap->published_us = now;
+    snap->refresh_at_us = snapshot_refresh_deadline_locked(now);
+    snap->spot_count = s_spots.count;
+    for (size_t i = 0; i < snap->spot_count; ++i) {
+        const stored_spot_t *entry = spot_ring_at(&s_spots, i);
+        snap->spots[i] = entry->spot;
+        snap->spots[i].is_new = (i == 0);
+        uint64_t diff_us = (now >= entry->received_us) ? (now - entry->received_us) : 0;
+        snap->spots[i].age_seconds = (uint32_t)(diff_us / 1000000ULL);
+        snap->received_us[i] = entry->received_us;
+    }
+    copy_status(&snap->status);
+    atomic_store(&s_snapshot_active, next);
+}
+
+static const hamview_backend_snapshot_t *snapshot_pin(void)
+{
+    while (true) {
+        int active = atomic_load(&s_snapshot_active);
+        atomic_fetch_add(&s_snapshot_refs[active], 1);
+        if (atomic_load(&s_snapshot_active) == active) {
+            return &s_snapshots[active];
+        }
+        atomic_fetch_sub(&s_snapshot_refs[active], 1);
     }
 }
 
@@ -346,12 +466,14 @@ size_t hamview_backend_get_spots(hamview_spot_t *out, size_t max_out)
     xSemaphoreTake(s_spot_mutex, portMAX_DELAY);
     uint64_t now = now_us();
     prune_expired_spots_locked(now);
-    size_t count = s_spot_count;
+    size_t count = s_spots.count;
     if (count > max_out) count = max_out;
     for (size_t i = 0; i < count; ++i) {
-        out[i] = s_spots[i].spot;
-        uint64_t diff_us = (now >= s_spots[i].received_us)
-                               ? (now - s_spots[i].received_us)
+        const stored_spot_t *entry = spot_ring_at(&s_spots, i);
+        out[i] = entry->spot;
+        out[i].is_new = (i == 0);
+        uint64_t diff_us = (now >= entry->received_us)
+                               ? (now - entry->received_us)
                                : 0;
         out[i].age_seconds = (uint32_t)(diff_us / 1000000ULL);
     }
@@ -359,11 +481,77 @@ size_t hamview_backend_get_spots(hamview_spot_t *out, size_t max_out)
     return count;
 }
 
+size_t hamview_backend_get_history(hamview_spot_t *out, size_t offset, size_t max_out, size_t *total)
+{
+    if (total) {
+        *total = 0;
+    }
+    if (!out || max_out == 0 || !s_spot_mutex) {
+        return 0;
+    }
+
+    xSemaphoreTake(s_spot_mutex, portMAX_DELAY);
+    uint64_t now = now_us();
+    prune_history_locked(now);
+    size_t count = 0;
+    uint64_t received_us = 0;
+    while (count < max_out && hamview_history_get(offset + count, &out[count], &received_us)) {
+        out[count].age_seconds = (uint32_t)((now >= received_us ? now - received_us : 0) / 1000000ULL);
+        count++;
+    }
+    if (total) {
+        *total = hamview_history_count();
+    }
+    xSemaphoreGive(s_spot_mutex);
+    return count;
+}
+
 void hamview_backend_get_status(hamview_status_t *out)
 {
     copy_status(out);
 }
 
+const hamview_backend_snapshot_t *hamview_backend_snapshot_acquire(void)
+{
+    if (!s_spot_mutex) {
+        return NULL;
+    }
+    const hamview_backend_snapshot_t *snap = snapshot_pin();
+    uint64_t now = now_us();
+    if (!atomic_load(&s_snapshot_stale) && now < snap->refresh_at_us) {
+        return snap;
+    }
+    hamview_backend_snapshot_release(snap);
+
+    xSemaphoreTake(s_spot_mutex, portMAX_DELAY);
+    prune_expired_spots_locked(now);
+    prune_history_locked(now);
+    publish_snapshot_locked(now);
+    xSemaphoreGive(s_spot_mutex);
+    return snapshot_pin();
+}
+
+void hamview_backend_snapshot_release(const hamview_backend_snapshot_t *snapshot)
+{
+    if (!snapshot) {
+        return;
+    }
+    size_t index = (size_t)(snapshot - s_snapshots);
+    if (index < 2) {
+        atomic_fetch_sub(&s_snapshot_refs[index], 1);
+    }
+}
+
+uint32_t hamview_backend_snapshot_spot_age(const hamview_backend_snapshot_t *snapshot, size_t index)
+{
+    if (!snapshot || index >= snapshot->spot_count) {
+        return 0;
+    }
+    uint64_t now = now_us();
+    uint64_t received = snapshot->received_us[index];
+    return (uint32_t)((now >= received ? now - received : 0) / 1000000ULL);
+}
+
 void hamview_backend_get_activity_summary(hamview_activity_summary_t *out)
 {
     if (!out) {
@@ -379,38 +567,18 @@ void hamview_backend_get_activity_summary(hamview_activity_summary_t *out)
         return;
     }
 
-    const uint64_t bucket_span_us = (uint64_t)HAMVIEW_ACTIVITY_BUCKET_MINUTES * 60ULL * 1000000ULL;
-    const uint64_t hour_span_us = 60ULL * 60ULL * 1000000ULL;
-
     xSemaphoreTake(s_spot_mutex, portMAX_DELAY);
     uint64_t now = now_us();
     prune_history_locked(now);
-    size_t history_cap = history_capacity();
-    size_t history_count = s_history_count;
-    if (history_cap > 0 && history_count > 0) {
-        for (size_t i = 0; i < history_count; ++i) {
-            const stored_spot_t *entry = &s_history_spots[i];
-            uint64_t age_us = (now >= entry->received_us) ? (now - entry->received_us) : 0;
-            uint32_t bucket_from_now = bucket_span_us > 0 ? (uint32_t)(age_us / bucket_span_us) : 0;
-            if (bucket_from_now < HAMVIEW_ACTIVITY_BUCKET_COUNT) {
-                size_t bucket_index = HAMVIEW_ACTIVITY_BUCKET_COUNT - 1 - bucket_from_now;
-                if (bucket_index < HAMVIEW_ACTIVITY_BUCKET_COUNT) {
-                    out->timeline_buckets[bucket_index]++;
-                }
-            }
-            uint32_t hour_from_now = hour_span_us > 0 ? (uint32_t)(age_us / hour_span_us) : 0;
-            if (hour_from_now < HAMVIEW_ACTIVITY_HOURLY_COUNT) {
-                size_t hour_index = HAMVIEW_ACTIVITY_HOURLY_COUNT - 1 - hour_from_now;
-                if (hour_index < HAMVIEW_ACTIVITY_HOURLY_COUNT) {
-                    out->hourly_counts[hour_index]++;
-                }
-            }
-            uint32_t mode_index = classify_activity_mode(entry->spot.mode);
-            if (mode_index < HAMVIEW_ACTIVITY_MODE_COUNT) {
-                out->mode_counts[mode_index]++;
-            }
-            out->total_spots++;
+    if (history_capacity() > 0 && hamview_history_count() > 0) {
+        activity_bucket_read(s_timeline_buckets, HAMVIEW_ACTIVITY_BUCKET_COUNT,
+                             (uint32_t)(now / ACTIVITY_BUCKET_SPAN_US), out->timeline_buckets);
+        activity_bucket_read(s_hourly_buckets, HAMVIEW_ACTIVITY_HOURLY_COUNT,
+                             (uint32_t)(now / ACTIVITY_HOUR_SPAN_US), out->hourly_counts);
+        for (size_t i = 0; i < HAMVIEW_ACTIVITY_MODE_COUNT; ++i) {
+            out->mode_counts[i] = s_mode_totals[i] > UINT16_MAX ? UINT16_MAX : (uint16_t)s_mode_totals[i];
         }
+        out->total_spots = (uint32_t)hamview_history_count();
     }
     xSemaphoreGive(s_spot_mutex);
 
@@ -448,18 +616,16 @@ void hamview_backend_get_activity_summary(hamview_activity_summary_t *out)
     }
 }
 
+/* Drops the live spot list on reconnect. History and the activity charts
+ * are kept; they only age out through prune_history_locked(). */
 static void clear_spots(void)
 {
     if (!s_spot_mutex) return;
     xSemaphoreTake(s_spot_mutex, portMAX_DELAY);
-    memset(s_spots, 0, sizeof(s_spots));
-    s_spot_count = 0;
-    size_t hist_cap = history_capacity();
-    if (s_history_spots && hist_cap > 0) {
-        memset(s_history_spots, 0, hist_cap * sizeof(stored_spot_t));
-    }
-    s_history_count = 0;
+    spot_ring_clear(&s_spots);
+    publish_snapshot_locked(now_us());
     xSemaphoreGive(s_spot_mutex);
+    lv_port_notify();
 }
 
 static void handle_wifi_event(void *handler_args, esp_event_base_t base, int32_t id, void *event_data)
@@ -473,6 +639,7 @@ static void handle_wifi_event(void *handler_args, esp_event_base_t base, int32_t
     xSemaphoreTake(s_status_mutex, portMAX_DELAY);
     s_wifi_connected = st->is_connected;
     xSemaphoreGive(s_status_mutex);
+    mark_snapshot_stale_and_notify();
 
     if (st->is_connected) {
         set_last_error("");
@@ -498,27 +665,6 @@ static void handle_wifi_event(void *handler_args, esp_event_base_t base, int32_t
     }
 }
 
-static void add_field(char *dst, size_t dst_len, const cJSON *obj, const char *key, const char *fallback_key)
-{
-    const char *val = NULL;
-    if (obj) {
-        const cJSON *node = cJSON_GetObjectItemCaseSensitive(obj, key);
-        if (cJSON_IsString(node) && node->valuestring) {
-            val = node->valuestring;
-        }
-        if (!val && fallback_key) {
-            node = cJSON_GetObjectItemCaseSensitive(obj, fallback_key);
-            if (cJSON_IsString(node) && node->valuestring) {
-                val = node->valuestring;
-            }
-        }
-    }
-    if (!val) {
-        val = "";
-    }
-    strlcpy(dst, val, dst_len);
-}
-
 static void ensure_sntp_started(void)
 {
     if (s_sntp_started) {
@@ -538,67 +684,100 @@ static bool is_time_valid(void)
     return now > 1700000000;
 }
 
-static void process_spot_json_obj(cJSON *obj)
+typedef struct {
+    uint64_t now;
+    uint32_t epoch_now;
+    uint64_t last_received_us;
+} history_restore_ctx_t;
+
+static void restore_history_record(const hamview_history_record_t *record, void *arg)
 {
-    if (!obj) return;
+    history_restore_ctx_t *ctx = arg;
+    if (history_capacity() == 0 || record->epoch > ctx->epoch_now) {
+        return;
+    }
+    uint64_t age_us = (uint64_t)(ctx->epoch_now - record->epoch) * 1000000ULL;
+    uint64_t received_us = (age_us < ctx->now) ? ctx->now - age_us : 0;
+    /* Keep the ring ordered even if the wall clock stepped back between
+     * the writes. */
+    if (received_us < ctx->last_received_us) {
+        received_us = ctx->last_received_us;
+    }
+    ctx->last_received_us = received_us;
+
+    /* The spot time is not logged; HamAlert sends it as HH:MM UTC, which the
+     * record epoch gives back. */
     hamview_spot_t spot = {0};
-    add_field(spot.callsign, sizeof(spot.callsign), obj, "callsign", "dx");
-    if (strlen(spot.callsign) == 0) {
+    time_t epoch = (time_t)record->epoch;
+    struct tm tm_utc;
+    gmtime_r(&epoch, &tm_utc);
+    strftime(spot.time_utc, sizeof(spot.time_utc), "%H:%M", &tm_utc);
+    strlcpy(spot.callsign, record->callsign, sizeof(spot.callsign));
+    strlcpy(spot.frequency, record->frequency, sizeof(spot.frequency));
+    strlcpy(spot.mode, record->mode, sizeof(spot.mode));
+    strlcpy(spot.spotter, record->spotter, sizeof(spot.spotter));
+    strlcpy(spot.dxcc, record->dxcc, sizeof(spot.dxcc));
+    strlcpy(spot.continent, record->continent, sizeof(spot.continent));
+    strlcpy(spot.country, record->country, sizeof(spot.country));
+    strlcpy(spot.comment, record->comment, sizeof(spot.comment));
+    hamview_history_push(&spot, received_us, record->mode_class);
+    history_on_insert(received_us, record->mode_class);
+}
+
+/* Rebuilds the history window from flash once per boot. It runs before the
+ * first HamAlert connection so restored records, which are all older than
+ * anything live, can simply be pushed in log order. Needs the wall clock;
+ * if SNTP has not answered within HISTORY_RESTORE_WAIT_MS it gives up. */
+static void restore_history_once(void)
+{
+    static bool s_history_restored = false;
+    if (s_history_restored) {
         return;
     }
-    add_field(spot.frequency, sizeof(spot.frequency), obj, "frequency", "freq");
-    add_field(spot.mode, sizeof(spot.mode), obj, "mode", NULL);
-    add_field(spot.spotter, sizeof(spot.spotter), obj, "spotter", "de");
-    add_field(spot.time_utc, sizeof(spot.time_utc), obj, "time", NULL);
-    add_field(spot.dxcc, sizeof(spot.dxcc), obj, "dxcc", "country");
-    add_field(spot.state, sizeof(spot.state), obj, "state", "us_state");
-    add_field(spot.country, sizeof(spot.country), obj, "country", "dxcc");
-    add_field(spot.continent, sizeof(spot.continent), obj, "continent", "cont");
-    add_field(spot.comment, sizeof(spot.comment), obj, "comment", "comments");
-
-    if (strlen(spot.frequency) > 0) {
-        double freq_val = atof(spot.frequency);
-        if (freq_val > 0) {
-            char buf[16];
-            snprintf(buf, sizeof(buf), "%.3f", freq_val);
-            strlcpy(spot.frequency, buf, sizeof(spot.frequency));
+    for (int waited = 0; !is_time_valid(); waited += 250) {
+        if (waited >= HISTORY_RESTORE_WAIT_MS || !s_wifi_connected) {
+            ESP_LOGW(TAG, "No wall clock yet, skipping history restore");
+            s_history_restored = true;
+            return;
+        }
+        vTaskDelay(pdMS_TO_TICKS(250));
+    }
+    s_history_restored = true;
+
+    xSemaphoreTake(s_spot_mutex, portMAX_DELAY);
+    history_restore_ctx_t ctx = {
+        .now = now_us(),
+        .epoch_now = (uint32_t)time(NULL),
+    };
+    if (history_capacity() > 0 && hamview_history_count() == 0) {
+        uint32_t window_s = history_window_minutes() * 60U;
+        uint32_t since = ctx.epoch_now > window_s ? ctx.epoch_now - window_s : 0;
+        size_t restored = hamview_history_store_restore(since, restore_history_record, &ctx);
+        prune_history_locked(ctx.now);
+        publish_snapshot_locked(ctx.now);
+        if (restored > 0) {
+            hamview_event_log_append("backend", "Restored %u history spots", (unsigned)restored);
         }
     }
+    xSemaphoreGive(s_spot_mutex);
+    lv_port_notify();
+}
 
-    update_spot(&spot);
+static void handle_parsed_spot(const hamview_spot_t *spot, void *ctx)
+{
+    (void)ctx;
+    update_spot(spot);
 }
 
-static void process_spot_json(const char *json)
+static void process_spot_json(const char *json, size_t len)
 {
-    if (!json || strlen(json) == 0) {
+    if (!json || len == 0) {
         return;
     }
-    cJSON *root = cJSON_Parse(json);
-    if (!root) {
+    if (hamview_spot_parse_json(json, len, handle_parsed_spot, NULL) < 0) {
         ESP_LOGW(TAG, "JSON parse failed");
         return;
     }
-    if (cJSON_IsArray(root)) {
-        cJSON *item = NULL;
-        cJSON_ArrayForEach(item, root) {
-            if (cJSON_IsObject(item)) {
-                process_spot_json_obj(item);
-            }
-        }
-    } else if (cJSON_IsObject(root)) {
-        cJSON *spots = cJSON_GetObjectItem(root, "spots");
-        if (cJSON_IsArray(spots)) {
-            cJSON *item = NULL;
-            cJSON_ArrayForEach(item, spots) {
-                if (cJSON_IsObject(item)) {
-                    process_spot_json_obj(item);
-                }
-            }
-        } else {
-            process_spot_json_obj(root);
-        }
-    }
-    cJSON_Delete(root);
     s_last_fetch_us = now_us();
 }
 
@@ -631,8 +810,11 @@ static int telnet_connect(void)
     hints.ai_family = AF_INET;
     hints.ai_socktype = SOCK_STREAM;
 
+    char port[8];
+    snprintf(port, sizeof(port), "%u", (unsigned)HAMALERT_PORT);
+
     struct addrinfo *res = NULL;
-    int err = getaddrinfo(HAMALERT_HOST, "7300", &hints, &res);
+    int err = getaddrinfo(HAMALERT_HOST, port, &hints, &res);
     if (err != 0 || !res) {
         set_last_error("DNS error: %d", err);
         return -1;
@@ -709,13 +891,13 @@ static void telnet_loop(void)
 {
     int sock = -1;
     char recv_buf[1024];
-    size_t recv_len = 0;
     uint64_t last_keepalive = now_us();
 
     while (s_wifi_connected && !s_use_rest) {
         if (sock < 0) {
             telnet_close(&sock);
             clear_spots();
+            restore_history_once();
             if (strlen(s_settings.username) == 0 || strlen(s_settings.password) == 0) {
                 set_last_error("Set HamAlert credentials");
                 vTaskDelay(pdMS_TO_TICKS(2000));
@@ -733,29 +915,16 @@ static void telnet_loop(void)
             }
             set_hamalert_connected(true);
             set_last_error("");
-            recv_len = 0;
+            hamview_ingest_reset_line();
             last_keepalive = now_us();
             ESP_LOGI(TAG, "HamAlert telnet connected");
         }
 
-        int n = recv(sock, recv_buf + recv_len, sizeof(recv_buf) - recv_len - 1, 0);
+        /* This task only reads and splits lines; JSON parsing and spot
+         * ingestion run on the hamview_ingest task. */
+        int n = recv(sock, recv_buf, sizeof(recv_buf), 0);
         if (n > 0) {
-            recv_len += n;
-            recv_buf[recv_len] = '\0';
-
-            char *line_start = recv_buf;
-            char *newline = NULL;
-            while ((newline = strchr(line_start, '\n')) != NULL) {
-                *newline = '\0';
-                char *line = line_start;
-                while (*line == '\r' || *line == '\n') line++;
-                if (strlen(line) > 0 && line[0] == '{') {
-                    process_spot_json(line);
-                }
-                line_start = newline + 1;
-            }
-            recv_len = strlen(line_start);
-            memmove(recv_buf, line_start, recv_len + 1);
+            hamview_ingest_feed(recv_buf, (size_t)n);
             last_keepalive = now_us();
         } else if (n == 0) {
             set_last_error("HamAlert closed connection");
@@ -883,7 +1052,7 @@ static esp_err_t rest_fetch_once(void)
         esp_http_client_cleanup(client);
         return ESP_FAIL;
     }
-    process_spot_json(buffer);
+    process_spot_json(buffer, strlen(buffer));
     free(buffer);
     esp_http_client_close(client);
     esp_http_client_cleanup(client);
@@ -909,59 +1078,337 @@ static void rest_loop(void)
     set_hamalert_connected(false);
 }
 
-static esp_err_t http_send_spots(httpd_req_t *req)
+/* If-None-Match holds "*" or a comma-separated list of entity tags, each
+ * possibly weak (W/"..."). Every tag is compared whole, so "s1" does not
+ * match "s12". A header too long for the buffer never matches, which only
+ * costs a full response. */
+static bool http_etag_matches(httpd_req_t *req, const char *etag)
 {
-    hamview_spot_t spots[HAMVIEW_MAX_SPOTS];
-    size_t count = hamview_backend_get_spots(spots, HAMVIEW_MAX_SPOTS);
+    char header[128];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", header, sizeof(header)) != ESP_OK) {
+        return false;
+    }
+    size_t etag_len = strlen(etag);
+    const char *p = header;
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') {
+            p++;
+        }
+        if (*p == '*') {
+            return true;
+        }
+        if (p[0] == 'W' && p[1] == '/') {
+            p += 2;
+        }
+        if (*p != '"') {
+            /* Not an entity tag: skip to the next list element. */
+            p += strcspn(p, ",");
+            continue;
+        }
+        const char *end = strchr(p + 1, '"');
+        if (!end) {
+            return false;
+        }
+        end++;
+        if ((size_t)(end - p) == etag_len && memcmp(p, etag, etag_len) == 0) {
+            return true;
+        }
+        p = end;
+    }
+    return false;
+}
 
-    cJSON *root = cJSON_CreateArray();
-    for (size_t i = 0; i < count; ++i) {
-        cJSON *obj = cJSON_CreateObject();
-        cJSON_AddStringToObject(obj, "callsign", spots[i].callsign);
-        cJSON_AddStringToObject(obj, "frequency", spots[i].frequency);
-        cJSON_AddStringToObject(obj, "mode", spots[i].mode);
-        cJSON_AddStringToObject(obj, "spotter", spots[i].spotter);
-        cJSON_AddStringToObject(obj, "time", spots[i].time_utc);
-        cJSON_AddStringToObject(obj, "dxcc", spots[i].dxcc);
-        cJSON_AddStringToObject(obj, "state", spots[i].state);
-        cJSON_AddStringToObject(obj, "country", spots[i].country);
-        cJSON_AddStringToObject(obj, "continent", spots[i].continent);
-        cJSON_AddStringToObject(obj, "comment", spots[i].comment);
-        cJSON_AddNumberToObject(obj, "age", spots[i].age_seconds);
-        cJSON_AddBoolToObject(obj, "isNew", spots[i].is_new);
-        cJSON_AddItemToArray(root, obj);
-    }
-    char *json = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
-    if (!json) {
+/* Sends a serialized body, or 304 when the client already holds this ETag.
+ * etag may be NULL for responses that are never revalidated. */
+static esp_err_t http_send_json(httpd_req_t *req, const char *json, size_t len, const char *etag)
+{
+    s_http_requests++;
+    if (len == 0) {
         return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "json error");
     }
+    if (etag) {
+        httpd_resp_set_hdr(req, "ETag", etag);
+        httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+        if (http_etag_matches(req, etag)) {
+            s_http_not_modified++;
+            httpd_resp_set_status(req, "304 Not Modified");
+            return httpd_resp_send(req, NULL, 0);
+        }
+    }
     httpd_resp_set_type(req, "application/json");
-    esp_err_t resp = httpd_resp_sendstr(req, json);
-    free(json);
-    return resp;
+    return httpd_resp_send(req, json, (ssize_t)len);
+}
+
+void hamview_backend_write_spot_json(hamview_json_writer_t *w, const hamview_spot_t *spot)
+{
+    hamview_json_begin_object(w);
+    hamview_json_kv_string(w, "callsign", spot->callsign);
+    hamview_json_kv_string(w, "frequency", spot->frequency);
+    hamview_json_kv_string(w, "mode", spot->mode);
+    hamview_json_kv_string(w, "spotter", spot->spotter);
+    hamview_json_kv_string(w, "time", spot->time_utc);
+    hamview_json_kv_string(w, "dxcc", spot->dxcc);
+    hamview_json_kv_string(w, "state", spot->state);
+    hamview_json_kv_string(w, "country", spot->country);
+    hamview_json_kv_string(w, "continent", spot->continent);
+    hamview_json_kv_string(w, "comment", spot->comment);
+    hamview_json_kv_uint(w, "age", spot->age_seconds);
+    hamview_json_kv_bool(w, "isNew", spot->is_new);
+    hamview_json_end_object(w);
+}
+
+static size_t serialize_spots(const hamview_backend_snapshot_t *snap, char *buf, size_t cap)
+{
+    hamview_json_writer_t w;
+    hamview_json_init(&w, buf, cap);
+    hamview_json_begin_array(&w);
+    for (size_t i = 0; i < snap->spot_count; ++i) {
+        hamview_backend_write_spot_json(&w, &snap->spots[i]);
+    }
+    hamview_json_end_array(&w);
+    return hamview_json_finish(&w);
+}
+
+/* The body is keyed by snapshot generation, so every client polling an
+ * unchanged list gets a 304 and nothing is re-serialized. Generations restart
+ * at 1 on every boot, so the ETag also carries a per-boot nonce: a page left
+ * open across a reboot must not revalidate its stale list. Ages in the body
+ * are as of publication; X-Snapshot-Age carries the seconds elapsed since,
+ * and is refreshed on 304s too. */
+static esp_err_t http_send_spots(httpd_req_t *req)
+{
+    if (!s_spots_json) {
+        s_spots_json = heap_caps_malloc(HTTP_SPOTS_JSON_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!s_spots_json) {
+            s_spots_json = heap_caps_malloc(HTTP_SPOTS_JSON_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        }
+        if (!s_spots_json) {
+            return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "out of memory");
+        }
+    }
+
+    const hamview_backend_snapshot_t *snap = hamview_backend_snapshot_acquire();
+    if (!snap) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "backend not ready");
+    }
+    if (s_spots_json_len == 0 || s_spots_json_generation != snap->generation) {
+        s_spots_json_len = serialize_spots(snap, s_spots_json, HTTP_SPOTS_JSON_SIZE);
+        s_spots_json_generation = snap->generation;
+        s_http_serializations++;
+    }
+    uint64_t now = now_us();
+    uint32_t snapshot_age = (uint32_t)((now > snap->published_us ? now - snap->published_us : 0) / 1000000ULL);
+    uint32_t generation = snap->generation;
+    hamview_backend_snapshot_release(snap);
+
+    char etag[24];
+    char age[12];
+    snprintf(etag, sizeof(etag), "\"s%08" PRIx32 "-%" PRIu32 "\"", s_http_etag_nonce, generation);
+    snprintf(age, sizeof(age), "%" PRIu32, snapshot_age);
+    httpd_resp_set_hdr(req, "X-Snapshot-Age", age);
+    return http_send_json(req, s_spots_json, s_spots_json_len, etag);
+}
+
+/* GET /api/history?offset=N&limit=M pages through the compact history,
+ * newest first; only the requested rows are materialized. */
+static esp_err_t http_send_history(httpd_req_t *req)
+{
+    if (!s_history_json) {
+        s_history_json = heap_caps_malloc(HTTP_HISTORY_JSON_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        s_history_rows = heap_caps_malloc(HTTP_HISTORY_PAGE_MAX * sizeof(hamview_spot_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!s_history_json || !s_history_rows) {
+            heap_caps_free(s_history_json);
+            heap_caps_free(s_history_rows);
+            s_history_json = NULL;
+            s_history_rows = NULL;
+            return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "out of memory");
+        }
+    }
+
+    size_t offset = 0;
+    size_t limit = HTTP_HISTORY_PAGE_MAX;
+    char query[48];
+    char value[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "offset", value, sizeof(value)) == ESP_OK) {
+            offset = strtoul(value, NULL, 10);
+        }
+        if (httpd_query_key_value(query, "limit", value, sizeof(value)) == ESP_OK) {
+            limit = strtoul(value, NULL, 10);
+        }
+    }
+    if (limit == 0 || limit > HTTP_HISTORY_PAGE_MAX) {
+        limit = HTTP_HISTORY_PAGE_MAX;
+    }
+
+    size_t total = 0;
+    size_t count = hamview_backend_get_history(s_history_rows, offset, limit, &total);
+
+    hamview_json_writer_t w;
+    hamview_json_init(&w, s_history_json, HTTP_HISTORY_JSON_SIZE);
+    hamview_json_begin_object(&w);
+    hamview_json_kv_uint(&w, "total", total);
+    hamview_json_kv_uint(&w, "offset", offset);
+    hamview_json_key(&w, "spots");
+    hamview_json_begin_array(&w);
+    for (size_t i = 0; i < count; ++i) {
+        hamview_backend_write_spot_json(&w, &s_history_rows[i]);
+    }
+    hamview_json_end_array(&w);
+    hamview_json_end_object(&w);
+    return http_send_json(req, s_history_json, hamview_json_finish(&w), NULL);
 }
 
+/* The body is mostly counters, the http ones included, so it differs on
+ * every poll: it is rebuilt each time and sent without an ETag, since no
+ * validator could ever match. */
 static esp_err_t http_send_status(httpd_req_t *req)
 {
     hamview_status_t status;
     hamview_backend_get_status(&status);
+    hamview_alert_stats_t alert_stats;
+    hamview_alert_get_stats(&alert_stats);
+    hamview_ingest_stats_t ingest;
+    hamview_ingest_get_stats(&ingest);
+    hamview_stream_stats_t stream;
+    hamview_stream_get_stats(&stream);
+    hamview_history_store_stats_t store;
+    hamview_history_store_get_stats(&store);
+    hamview_ui_refresh_stats_t ui;
+    hamview_ui_get_refresh_stats(&ui);
+    hamview_history_stats_t history;
+    xSemaphoreTake(s_spot_mutex, portMAX_DELAY);
+    hamview_history_get_stats(&history);
+    xSemaphoreGive(s_spot_mutex);
 
-    cJSON *obj = cJSON_CreateObject();
-    cJSON_AddBoolToObject(obj, "wifiConnected", status.wifi_connected);
-    cJSON_AddBoolToObject(obj, "hamalertConnected", status.hamalert_connected);
-    cJSON_AddBoolToObject(obj, "usingRest", status.using_rest);
-    cJSON_AddStringToObject(obj, "ip", status.ip_address);
-    cJSON_AddStringToObject(obj, "lastError", status.last_error);
-    char *json = cJSON_PrintUnformatted(obj);
-    cJSON_Delete(obj);
-    if (!json) {
-        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "json error");
+    hamview_json_writer_t w;
+    hamview_json_init(&w, s_http_json_buf, sizeof(s_http_json_buf));
+    hamview_json_begin_object(&w);
+    hamview_json_kv_bool(&w, "wifiConnected", status.wifi_connected);
+    hamview_json_kv_bool(&w, "hamalertConnected", status.hamalert_connected);
+    hamview_json_kv_bool(&w, "usingRest", status.using_rest);
+    hamview_json_kv_string(&w, "ip", status.ip_address);
+    hamview_json_kv_string(&w, "lastError", status.last_error);
+    hamview_json_kv_uint(&w, "alertsQueued", alert_stats.queued);
+    hamview_json_kv_uint(&w, "alertsCoalesced", alert_stats.coalesced);
+    hamview_json_kv_uint(&w, "alertsDropped", alert_stats.dropped);
+    hamview_json_key(&w, "ingest");
+    hamview_json_begin_object(&w);
+    hamview_json_kv_uint(&w, "lines", ingest.lines);
+    hamview_json_kv_uint(&w, "bytes", ingest.bytes);
+    hamview_json_kv_double(&w, "linesPerSec", ingest.lines_per_s);
+    hamview_json_kv_double(&w, "bytesPerSec", ingest.bytes_per_s);
+    hamview_json_kv_uint(&w, "queueDepth", ingest.queue_depth);
+    hamview_json_kv_uint(&w, "maxQueueDepth", ingest.max_queue_depth);
+    hamview_json_kv_uint(&w, "droppedLines", ingest.dropped_lines);
+    hamview_json_kv_uint(&w, "oversizedLines", ingest.oversized_lines);
+    hamview_json_kv_uint(&w, "parseUsP50", ingest.parse_us_p50);
+    hamview_json_kv_uint(&w, "parseUsP99", ingest.parse_us_p99);
+    hamview_json_kv_uint(&w, "parseUsMax", ingest.parse_us_max);
+    hamview_json_end_object(&w);
+    hamview_json_key(&w, "http");
+    hamview_json_begin_object(&w);
+    hamview_json_kv_uint(&w, "requests", s_http_requests);
+    hamview_json_kv_uint(&w, "notModified", s_http_not_modified);
+    hamview_json_kv_uint(&w, "spotSerializations", s_http_serializations);
+    hamview_json_end_object(&w);
+    hamview_json_key(&w, "stream");
+    hamview_json_begin_object(&w);
+    hamview_json_kv_uint(&w, "subscribers", stream.subscribers);
+    hamview_json_kv_uint(&w, "events", stream.events);
+    hamview_json_kv_uint(&w, "droppedEvents", stream.dropped_events);
+    hamview_json_kv_uint(&w, "oversizedEvents", stream.oversized_events);
+    hamview_json_kv_uint(&w, "rejectedSubscribers", stream.rejected_subscribers);
+    hamview_json_kv_uint(&w, "stalledDisconnects", stream.stalled_disconnects);
+    hamview_json_end_object(&w);
+    hamview_json_key(&w, "history");
+    hamview_json_begin_object(&w);
+    hamview_json_kv_uint(&w, "capacity", history.capacity);
+    hamview_json_kv_uint(&w, "count", history.count);
+    hamview_json_kv_uint(&w, "strings", history.strings);
+    hamview_json_kv_uint(&w, "stringBytes", history.string_bytes);
+    hamview_json_kv_uint(&w, "stringArenaBytes", history.string_arena_bytes);
+    hamview_json_kv_uint(&w, "commentArenaBytes", history.comment_arena_bytes);
+    hamview_json_kv_uint(&w, "memoryBytes", history.memory_bytes);
+    hamview_json_kv_uint(&w, "compactions", history.compactions);
+    hamview_json_kv_uint(&w, "internOverflows", history.intern_overflows);
+    hamview_json_end_object(&w);
+    hamview_json_key(&w, "historyStore");
+    hamview_json_begin_object(&w);
+    hamview_json_kv_bool(&w, "available", store.available);
+    hamview_json_kv_uint(&w, "sectors", store.sectors);
+    hamview_json_kv_uint(&w, "appended", store.appended);
+    hamview_json_kv_uint(&w, "dropped", store.dropped);
+    hamview_json_kv_uint(&w, "checkpoints", store.checkpoints);
+    hamview_json_kv_uint(&w, "sectorsErased", store.sectors_erased);
+    hamview_json_kv_uint(&w, "flashBytesWritten", store.flash_bytes_written);
+    hamview_json_kv_double(&w, "writeAmplification",
+                           store.payload_bytes ? (double)store.flash_bytes_written / (double)store.payload_bytes : 0.0);
+    hamview_json_kv_uint(&w, "restored", store.restored);
+    hamview_json_kv_uint(&w, "restoreMs", store.restore_ms);
+    hamview_json_end_object(&w);
+    hamview_json_key(&w, "uiRefresh");
+    hamview_json_begin_object(&w);
+    hamview_json_kv_uint(&w, "ticks", ui.ticks);
+    hamview_json_kv_uint(&w, "skippedTicks", ui.skipped_ticks);
+    hamview_json_kv_uint(&w, "tickUsLast", ui.last_tick_us);
+    hamview_json_kv_uint(&w, "tickUsMax", ui.max_tick_us);
+    hamview_json_kv_uint(&w, "tickUsAvg", ui.ticks ? (uint32_t)(ui.total_tick_us / ui.ticks) : 0);
+    hamview_json_kv_uint(&w, "cellsUpdated", ui.cells_updated);
+    hamview_json_kv_uint(&w, "invalidatedPx", ui.invalidated_px);
+    hamview_json_end_object(&w);
+    hamview_json_end_object(&w);
+    return http_send_json(req, s_http_json_buf, hamview_json_finish(&w), NULL);
+}
+
+static esp_err_t http_send_display(httpd_req_t *req)
+{
+    lv_port_stats_t stats;
+    lv_port_get_stats(&stats);
+    uint32_t frames = stats.frames ? stats.frames : 1;
+
+    hamview_json_writer_t w;
+    hamview_json_init(&w, s_http_json_buf, sizeof(s_http_json_buf));
+    hamview_json_begin_object(&w);
+    hamview_json_kv_string(&w, "mode", lv_port_render_mode_name(stats.mode));
+    hamview_json_kv_uint(&w, "frames", stats.frames);
+    hamview_json_kv_uint(&w, "flushCount", stats.flush_count);
+    hamview_json_kv_uint(&w, "bytesFlushed", stats.bytes_flushed);
+    hamview_json_kv_uint(&w, "bytesCopied", stats.bytes_copied);
+    hamview_json_kv_uint(&w, "renderUsLast", stats.last_render_us);
+    hamview_json_kv_uint(&w, "renderUsMax", stats.max_render_us);
+    hamview_json_kv_uint(&w, "renderUsAvg", stats.total_render_us / frames);
+    hamview_json_kv_uint(&w, "flushUsLast", stats.last_flush_us);
+    hamview_json_kv_uint(&w, "flushUsMax", stats.max_flush_us);
+    hamview_json_kv_uint(&w, "flushUsAvg", stats.total_flush_us / frames);
+    hamview_json_end_object(&w);
+    return http_send_json(req, s_http_json_buf, hamview_json_finish(&w), NULL);
+}
+
+static esp_err_t http_handler_display(httpd_req_t *req)
+{
+    return http_send_display(req);
+}
+
+/* POST /api/display?mode=partial|full|direct switches the LVGL render mode
+ * and resets the display counters. */
+static esp_err_t http_handler_display_mode(httpd_req_t *req)
+{
+    char query[32];
+    char value[16];
+    lv_port_render_mode_t mode;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, "mode", value, sizeof(value)) != ESP_OK ||
+        !lv_port_render_mode_from_name(value, &mode)) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "mode must be partial, full or direct");
+    }
+    esp_err_t err = lv_port_set_render_mode(mode);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Render mode %s rejected: %s", value, esp_err_to_name(err));
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "render mode not available on this board");
     }
-    httpd_resp_set_type(req, "application/json");
-    esp_err_t resp = httpd_resp_sendstr(req, json);
-    free(json);
-    return resp;
+    hamview_event_log_append("display", "Render mode %s", value);
+    return http_send_display(req);
 }
 
 static esp_err_t http_handler_spots(httpd_req_t *req)
@@ -969,6 +1416,11 @@ static esp_err_t http_handler_spots(httpd_req_t *req)
     return http_send_spots(req);
 }
 
+static esp_err_t http_handler_history(httpd_req_t *req)
+{
+    return http_send_history(req);
+}
+
 static esp_err_t http_handler_test(httpd_req_t *req)
 {
     httpd_resp_set_type(req, "text/plain");
@@ -985,18 +1437,24 @@ static esp_err_t http_handler_root(httpd_req_t *req)
         "h1{color:#0ff;text-align:center;}table{width:100%;border-collapse:collapse;}"
         "th,td{padding:8px;border-bottom:1px solid #333;}th{color:#ff0;}"
         ".status{margin-bottom:20px;}</style>"
-        "<script>async function refresh(){const spots=await fetch('/api/spots').then(r=>r.json());"
+        "<script>async function refresh(){const sr=await fetch('/api/spots');const spots=await sr.json();"
+        "const skew=parseInt(sr.headers.get('X-Snapshot-Age'))||0;"
         "const status=await fetch('/api/status').then(r=>r.json());"
         "document.getElementById('ip').textContent=status.ip;"
         "document.getElementById('hamalert').textContent=status.hamalertConnected?'Connected':'Offline';"
         "document.getElementById('mode').textContent=status.usingRest?'REST':'Telnet';"
         "document.getElementById('error').textContent=status.lastError||'None';"
+        "const disp=await fetch('/api/display').then(r=>r.json());"
+        "document.getElementById('dmode').value=disp.mode;"
+        "document.getElementById('dstats').textContent=`${disp.frames} frames, ${disp.flushCount} flushes, ${disp.bytesFlushed} B flushed, ${disp.bytesCopied} B copied, render ${disp.renderUsAvg}/${disp.renderUsMax} us, flush ${disp.flushUsAvg}/${disp.flushUsMax} us (avg/max)`;"
         "const body=document.getElementById('tbody');body.innerHTML='';"
         "if(spots.length===0){body.innerHTML='<tr><td colspan=9>No spots yet</td></tr>';}"
         "spots.forEach(s=>{const row=document.createElement('tr');"
-        "row.innerHTML=`<td>${s.callsign}</td><td>${s.frequency}</td><td>${s.mode}</td><td>${s.spotter}</td><td>${s.time}</td><td>${s.continent}</td><td>${s.dxcc}</td><td>${s.age}s</td><td>${s.comment}</td>`;body.appendChild(row);});"
-        "}setInterval(refresh,5000);window.onload=refresh;</script></head><body>"
+        "row.innerHTML=`<td>${s.callsign}</td><td>${s.frequency}</td><td>${s.mode}</td><td>${s.spotter}</td><td>${s.time}</td><td>${s.continent}</td><td>${s.dxcc}</td><td>${s.age+skew}s</td><td>${s.comment}</td>`;body.appendChild(row);});"
+        "}async function setMode(m){const r=await fetch('/api/display?mode='+m,{method:'POST'});if(!r.ok){alert(await r.text());}refresh();}"
+        "setInterval(refresh,5000);window.onload=refresh;</script></head><body>"
         "<h1>HamView Spots</h1><div class='status'>IP: <span id='ip'></span> | HamAlert: <span id='hamalert'></span> | Mode: <span id='mode'></span> | Error: <span id='error'></span></div>"
+        "<div class='status'>Display: <select id='dmode' onchange='setMode(this.value)'><option>partial</option><option>full</option><option>direct</option></select> <span id='dstats'></span></div>"
         "<table><thead><tr><th>Call</th><th>Freq</th><th>Mode</th><th>Spotter</th><th>Time</th><th>Cont</th><th>DXCC</th><th>Age</th><th>Comment</th></tr></thead><tbody id='tbody'></tbody></table></body></html>";
 
     httpd_resp_set_type(req, "text/html");
@@ -1011,18 +1469,34 @@ static esp_err_t http_handler_status(httpd_req_t *req)
 static void start_http_server(void)
 {
     if (s_httpd) return;
+    s_http_etag_nonce = esp_random();
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = HTTP_PORT;
     config.ctrl_port = HTTP_PORT + 1;
+    /* Stream subscribers keep their sockets; the stream module has to hear
+     * about every close to free the slot. */
+    config.close_fn = hamview_stream_on_close;
+    config.max_uri_handlers = 12;
     if (httpd_start(&s_httpd, &config) == ESP_OK) {
+        if (hamview_stream_init(s_httpd) != ESP_OK) {
+            ESP_LOGW(TAG, "Spot stream unavailable");
+        }
         httpd_uri_t uri_root = {.uri = "/", .method = HTTP_GET, .handler = http_handler_root, .user_ctx = NULL};
         httpd_uri_t uri_spots = {.uri = "/api/spots", .method = HTTP_GET, .handler = http_handler_spots, .user_ctx = NULL};
         httpd_uri_t uri_status = {.uri = "/api/status", .method = HTTP_GET, .handler = http_handler_status, .user_ctx = NULL};
         httpd_uri_t uri_test = {.uri = "/test", .method = HTTP_GET, .handler = http_handler_test, .user_ctx = NULL};
+        httpd_uri_t uri_display = {.uri = "/api/display", .method = HTTP_GET, .handler = http_handler_display, .user_ctx = NULL};
+        httpd_uri_t uri_display_mode = {.uri = "/api/display", .method = HTTP_POST, .handler = http_handler_display_mode, .user_ctx = NULL};
+        httpd_uri_t uri_history = {.uri = "/api/history", .method = HTTP_GET, .handler = http_handler_history, .user_ctx = NULL};
+        httpd_uri_t uri_stream = {.uri = "/api/stream", .method = HTTP_GET, .handler = hamview_stream_handler, .user_ctx = NULL};
         httpd_register_uri_handler(s_httpd, &uri_root);
         httpd_register_uri_handler(s_httpd, &uri_spots);
         httpd_register_uri_handler(s_httpd, &uri_status);
         httpd_register_uri_handler(s_httpd, &uri_test);
+        httpd_register_uri_handler(s_httpd, &uri_display);
+        httpd_register_uri_handler(s_httpd, &uri_display_mode);
+        httpd_register_uri_handler(s_httpd, &uri_stream);
+        httpd_register_uri_handler(s_httpd, &uri_history);
         ESP_LOGI(TAG, "HTTP server started on %d", HTTP_PORT);
     } else {
         ESP_LOGE(TAG, "Failed to start HTTP server");
@@ -1066,11 +1540,17 @@ esp_err_t hamview_backend_init(void)
 
     hamview_settings_get(&s_settings);
     s_use_rest = false;
-    if (ensure_history_buffer() != ESP_OK) {
+    if (hamview_history_init(HAMVIEW_HISTORY_MAX_SPOTS, history_on_evict) != ESP_OK) {
         ESP_LOGW(TAG, "History buffer unavailable; extended analytics limited");
     }
+    if (hamview_history_store_init() != ESP_OK) {
+        ESP_LOGW(TAG, "History log unavailable; activity charts restart empty after reboot");
+    }
 
     hamview_alert_init();
+    if (hamview_ingest_init(process_spot_json) != ESP_OK) {
+        ESP_LOGE(TAG, "Spot ingest pipeline unavailable");
+    }
 
     ESP_ERROR_CHECK(esp_event_handler_instance_register_with(view_event_handle, VIEW_EVENT_BASE, VIEW_EVENT_WIFI_ST, handle_wifi_event, NULL, NULL));
 
@@ -1084,11 +1564,13 @@ void hamview_backend_on_settings_updated(void)
 {
     hamview_settings_get(&s_settings);
     s_use_rest = false;
+    hamview_alert_on_settings_updated();
     if (s_spot_mutex) {
         xSemaphoreTake(s_spot_mutex, portMAX_DELAY);
         uint64_t now = now_us();
         prune_expired_spots_locked(now);
         prune_history_locked(now);
+        publish_snapshot_locked(now);
         xSemaphoreGive(s_spot_mutex);
     }
     xEventGroupSetBits(s_backend_events, BACKEND_EVENT_SETTINGS);
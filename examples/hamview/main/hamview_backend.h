@@ -5,6 +5,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "hamview_json.h"
 #include "hamview_settings.h"
 
 #ifdef __cplusplus
@@ -54,11 +55,33 @@ typedef struct {
     bool hourly_is_day[HAMVIEW_ACTIVITY_HOURLY_COUNT];
 } hamview_activity_summary_t;
 
+/* Immutable view of the live spot list and connection status. A new one is
+ * published with a higher generation whenever either changes, so readers can
+ * skip all work while the generation they last rendered is still current.
+ * received_us lets readers derive spot ages without re-acquiring. */
+typedef struct {
+    uint32_t generation;
+    uint64_t published_us;
+    uint64_t refresh_at_us;
+    size_t spot_count;
+    hamview_spot_t spots[HAMVIEW_MAX_SPOTS];
+    uint64_t received_us[HAMVIEW_MAX_SPOTS];
+    hamview_status_t status;
+} hamview_backend_snapshot_t;
+
 esp_err_t hamview_backend_init(void);
 void hamview_backend_on_settings_updated(void);
 size_t hamview_backend_get_spots(hamview_spot_t *out, size_t max_out);
+/* Materializes up to max_out history rows starting offset entries back from
+ * the newest, with ages filled in. total receives the history length. */
+size_t hamview_backend_get_history(hamview_spot_t *out, size_t offset, size_t max_out, size_t *total);
 void hamview_backend_get_status(hamview_status_t *out);
 void hamview_backend_get_activity_summary(hamview_activity_summary_t *out);
+const hamview_backend_snapshot_t *hamview_backend_snapshot_acquire(void);
+void hamview_backend_snapshot_release(const hamview_backend_snapshot_t *snapshot);
+uint32_t hamview_backend_snapshot_spot_age(const hamview_backend_snapshot_t *snapshot, size_t index);
+/* Writes one spot as the JSON object used by /api/spots and /api/stream. */
+void hamview_backend_write_spot_json(hamview_json_writer_t *w, const hamview_spot_t *spot);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,499 @@
+#include "hamview_history.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#define HISTORY_MIN_CAPACITY        (64)
+#define HISTORY_STRING_AVG_BYTES    (8)
+#define HISTORY_COMMENT_AVG_BYTES   (16)
+#define HISTORY_STRING_ID_MAX       (65535)
+
+/* Text fields kept through the string table. The frequency text is only
+ * interned when it does not parse as a plain kHz value. */
+enum {
+    FIELD_CALLSIGN,
+    FIELD_MODE,
+    FIELD_SPOTTER,
+    FIELD_TIME,
+    FIELD_DXCC,
+    FIELD_STATE,
+    FIELD_COUNTRY,
+    FIELD_CONTINENT,
+    FIELD_COUNT,
+};
+
+#define SPOT_FIELD(name) {offsetof(hamview_spot_t, name), sizeof(((hamview_spot_t *)0)->name)}
+
+static const struct {
+    size_t offset;
+    size_t size;
+} k_fields[FIELD_COUNT] = {
+    [FIELD_CALLSIGN] = SPOT_FIELD(callsign),
+    [FIELD_MODE] = SPOT_FIELD(mode),
+    [FIELD_SPOTTER] = SPOT_FIELD(spotter),
+    [FIELD_TIME] = SPOT_FIELD(time_utc),
+    [FIELD_DXCC] = SPOT_FIELD(dxcc),
+    [FIELD_STATE] = SPOT_FIELD(state),
+    [FIELD_COUNTRY] = SPOT_FIELD(country),
+    [FIELD_CONTINENT] = SPOT_FIELD(continent),
+};
+
+typedef struct {
+    uint32_t received_s;
+    uint32_t freq_hz;
+    uint32_t comment_pos;
+    uint16_t str[FIELD_COUNT];
+    uint16_t freq_str;
+    uint8_t comment_len;
+    uint8_t mode_class;
+} history_entry_t;
+
+_Static_assert(sizeof(history_entry_t) == 32, "history entry should stay 32 bytes");
+
+/* String table entry; id 0 is the empty string and never stored. */
+typedef struct {
+    uint32_t offset;
+    uint32_t hash;
+    uint32_t refs;
+    uint16_t next;
+    uint8_t len;
+} intern_entry_t;
+
+static const char *TAG = "hamview_history";
+
+static history_entry_t *s_entries = NULL;
+static size_t s_capacity = 0;
+static size_t s_head = 0;
+static size_t s_count = 0;
+static hamview_history_evict_cb_t s_on_evict = NULL;
+
+static intern_entry_t *s_strings = NULL;
+static size_t s_string_slots = 0;
+static uint16_t *s_buckets = NULL;
+static size_t s_bucket_mask = 0;
+static uint16_t s_string_free = 0;
+static size_t s_string_live = 0;
+static size_t s_string_live_bytes = 0;
+static char *s_string_arena = NULL;
+/* Same size as the arena; compaction copies into it and swaps, so it never
+ * allocates while the caller holds the spot mutex. */
+static char *s_string_spare = NULL;
+static size_t s_string_arena_size = 0;
+static size_t s_string_arena_used = 0;
+
+/* FIFO comment arena addressed by absolute byte position; a comment is
+ * still readable while the writer is less than one arena length past it. */
+static char *s_comments = NULL;
+static size_t s_comment_size = 0;
+static uint32_t s_comment_head = 0;
+
+static uint32_t s_compactions = 0;
+static uint32_t s_intern_overflows = 0;
+
+static void *history_alloc(size_t bytes)
+{
+    void *ptr = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!ptr) {
+        ptr = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    return ptr;
+}
+
+static void history_free_all(void)
+{
+    heap_caps_free(s_entries);
+    heap_caps_free(s_strings);
+    heap_caps_free(s_buckets);
+    heap_caps_free(s_string_arena);
+    heap_caps_free(s_string_spare);
+    heap_caps_free(s_comments);
+    s_entries = NULL;
+    s_strings = NULL;
+    s_buckets = NULL;
+    s_string_arena = NULL;
+    s_string_spare = NULL;
+    s_comments = NULL;
+    s_capacity = 0;
+}
+
+static uint32_t intern_hash(const char *text, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ (uint8_t)text[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/* Moves every live string to the front of the spare arena, which then
+ * becomes the arena. Ids are untouched, so history entries need no fix-up. */
+static void intern_compact(void)
+{
+    char *fresh = s_string_spare;
+    size_t used = 0;
+    for (size_t id = 1; id < s_string_slots; ++id) {
+        intern_entry_t *e = &s_strings[id];
+        if (e->refs == 0) {
+            continue;
+        }
+        memcpy(fresh + used, s_string_arena + e->offset, e->len);
+        e->offset = (uint32_t)used;
+        used += e->len;
+    }
+    s_string_spare = s_string_arena;
+    s_string_arena = fresh;
+    s_string_arena_used = used;
+    s_compactions++;
+}
+
+/* Returns false when the table or its arena is full. *id is 0 for an
+ * empty string. */
+static bool intern_acquire(const char *text, size_t max_len, uint16_t *id_out)
+{
+    size_t len = strnlen(text, max_len);
+    *id_out = 0;
+    if (len == 0) {
+        return true;
+    }
+    if (len > UINT8_MAX) {
+        len = UINT8_MAX;
+    }
+    uint32_t hash = intern_hash(text, len);
+    uint16_t *bucket = &s_buckets[hash & s_bucket_mask];
+    for (uint16_t id = *bucket; id != 0; id = s_strings[id].next) {
+        intern_entry_t *e = &s_strings[id];
+        if (e->hash == hash && e->len == len && memcmp(s_string_arena + e->offset, text, len) == 0) {
+            e->refs++;
+            *id_out = id;
+            return true;
+        }
+    }
+
+    /* Only compact once the live strings leave an eighth of the arena free,
+     * so a full arena is not copied again for every new string. Until then
+     * the caller frees space by evicting old entries. */
+    if (s_string_free == 0) {
+        return false;
+    }
+    if (s_string_arena_used + len > s_string_arena_size) {
+        if (s_string_live_bytes + len > s_string_arena_size - s_string_arena_size / 8) {
+            return false;
+        }
+        intern_compact();
+    }
+    uint16_t id = s_string_free;
+    intern_entry_t *e = &s_strings[id];
+    s_string_free = e->next;
+    memcpy(s_string_arena + s_string_arena_used, text, len);
+    e->offset = (uint32_t)s_string_arena_used;
+    e->hash = hash;
+    e->refs = 1;
+    e->len = (uint8_t)len;
+    e->next = *bucket;
+    *bucket = id;
+    s_string_arena_used += len;
+    s_string_live++;
+    s_string_live_bytes += len;
+    *id_out = id;
+    return true;
+}
+
+static void intern_release(uint16_t id)
+{
+    if (id == 0) {
+        return;
+    }
+    intern_entry_t *e = &s_strings[id];
+    if (e->refs == 0 || --e->refs > 0) {
+        return;
+    }
+    uint16_t *link = &s_buckets[e->hash & s_bucket_mask];
+    while (*link != 0 && *link != id) {
+        link = &s_strings[*link].next;
+    }
+    if (*link == id) {
+        *link = e->next;
+    }
+    e->next = s_string_free;
+    s_string_free = id;
+    s_string_live--;
+    s_string_live_bytes -= e->len;
+}
+
+static void intern_copy(uint16_t id, char *out, size_t out_len)
+{
+    if (id == 0 || out_len == 0) {
+        if (out_len > 0) {
+            out[0] = '\0';
+        }
+        return;
+    }
+    const intern_entry_t *e = &s_strings[id];
+    size_t len = e->len < out_len - 1 ? e->len : out_len - 1;
+    memcpy(out, s_string_arena + e->offset, len);
+    out[len] = '\0';
+}
+
+/* "14074.500" (kHz, as normalized by the spot parser) to Hz. Returns 0
+ * when the text is not a plain decimal or is above ~4.29 GHz. */
+static uint32_t parse_freq_hz(const char *text)
+{
+    const char *p = text;
+    uint64_t value = 0;
+    int whole_digits = 0;
+    while (isdigit((unsigned char)*p)) {
+        if (++whole_digits > 7) {
+            return 0;
+        }
+        value = value * 10 + (uint64_t)(*p++ - '0');
+    }
+    int frac_digits = 0;
+    if (*p == '.') {
+        p++;
+        while (isdigit((unsigned char)*p) && frac_digits < 3) {
+            value = value * 10 + (uint64_t)(*p++ - '0');
+            frac_digits++;
+        }
+        while (*p == '0') {
+            p++;
+        }
+    }
+    if (*p != '\0' || whole_digits == 0) {
+        return 0;
+    }
+    for (; frac_digits < 3; ++frac_digits) {
+        value *= 10;
+    }
+    return value <= UINT32_MAX ? (uint32_t)value : 0;
+}
+
+static void comment_write(const char *text, size_t max_len, history_entry_t *entry)
+{
+    size_t len = strnlen(text, max_len);
+    if (len > UINT8_MAX) {
+        len = UINT8_MAX;
+    }
+    entry->comment_pos = s_comment_head;
+    entry->comment_len = (uint8_t)len;
+    size_t at = s_comment_head % s_comment_size;
+    size_t first = len < s_comment_size - at ? len : s_comment_size - at;
+    memcpy(s_comments + at, text, first);
+    memcpy(s_comments, text + first, len - first);
+    s_comment_head += (uint32_t)len;
+}
+
+static void comment_read(const history_entry_t *entry, char *out, size_t out_len)
+{
+    size_t len = entry->comment_len < out_len - 1 ? entry->comment_len : out_len - 1;
+    if ((uint32_t)(s_comment_head - entry->comment_pos) > s_comment_size) {
+        len = 0;
+    }
+    size_t at = entry->comment_pos % s_comment_size;
+    size_t first = len < s_comment_size - at ? len : s_comment_size - at;
+    memcpy(out, s_comments + at, first);
+    memcpy(out + first, s_comments, len - first);
+    out[len] = '\0';
+}
+
+static history_entry_t *entry_at(size_t index)
+{
+    return &s_entries[(s_head + s_capacity - 1 - index) % s_capacity];
+}
+
+static void entry_release_strings(const history_entry_t *entry)
+{
+    for (size_t f = 0; f < FIELD_COUNT; ++f) {
+        intern_release(entry->str[f]);
+    }
+    intern_release(entry->freq_str);
+}
+
+/* On failure the strings already taken are given back and entry->str is
+ * left all zero. */
+static bool entry_intern(history_entry_t *entry, const hamview_spot_t *spot)
+{
+    bool ok = true;
+    for (size_t f = 0; f < FIELD_COUNT && ok; ++f) {
+        ok = intern_acquire((const char *)spot + k_fields[f].offset, k_fields[f].size, &entry->str[f]);
+    }
+    if (ok && entry->freq_hz == 0) {
+        ok = intern_acquire(spot->frequency, sizeof(spot->frequency), &entry->freq_str);
+    }
+    if (!ok) {
+        entry_release_strings(entry);
+        memset(entry->str, 0, sizeof(entry->str));
+        entry->freq_str = 0;
+    }
+    return ok;
+}
+
+static void entry_release(const history_entry_t *entry)
+{
+    entry_release_strings(entry);
+    if (s_on_evict) {
+        s_on_evict((uint64_t)entry->received_s * 1000000ULL, entry->mode_class);
+    }
+}
+
+static esp_err_t history_alloc_all(size_t capacity)
+{
+    /* Callsign, spotter and time are the fields that rarely repeat; three
+     * ids per entry covers a feed where all of them are unique, the other
+     * fields draw from a small shared set. Should a feed still fill the
+     * table, the push evicts the oldest entries instead. */
+    s_string_slots = capacity * 3 + FIELD_COUNT * 64;
+    if (s_string_slots > HISTORY_STRING_ID_MAX) {
+        s_string_slots = HISTORY_STRING_ID_MAX;
+    }
+    size_t buckets = 1;
+    while (buckets < s_string_slots) {
+        buckets <<= 1;
+    }
+    s_string_arena_size = s_string_slots * HISTORY_STRING_AVG_BYTES;
+    s_comment_size = capacity * HISTORY_COMMENT_AVG_BYTES;
+
+    s_entries = history_alloc(capacity * sizeof(history_entry_t));
+    s_strings = history_alloc(s_string_slots * sizeof(intern_entry_t));
+    s_buckets = history_alloc(buckets * sizeof(uint16_t));
+    s_string_arena = history_alloc(s_string_arena_size);
+    s_string_spare = history_alloc(s_string_arena_size);
+    s_comments = history_alloc(s_comment_size);
+    if (!s_entries || !s_strings || !s_buckets || !s_string_arena || !s_string_spare || !s_comments) {
+        history_free_all();
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(s_buckets, 0, buckets * sizeof(uint16_t));
+    memset(s_strings, 0, s_string_slots * sizeof(intern_entry_t));
+    for (size_t id = 1; id + 1 < s_string_slots; ++id) {
+        s_strings[id].next = (uint16_t)(id + 1);
+    }
+    s_string_free = s_string_slots > 1 ? 1 : 0;
+    s_bucket_mask = buckets - 1;
+    s_capacity = capacity;
+    return ESP_OK;
+}
+
+esp_err_t hamview_history_init(size_t capacity, hamview_history_evict_cb_t on_evict)
+{
+    if (s_entries) {
+        return ESP_OK;
+    }
+    s_on_evict = on_evict;
+    for (; capacity >= HISTORY_MIN_CAPACITY; capacity /= 2) {
+        if (history_alloc_all(capacity) == ESP_OK) {
+            hamview_history_stats_t stats;
+            hamview_history_get_stats(&stats);
+            ESP_LOGI(TAG, "History holds %u spots in %u KB", (unsigned)capacity, (unsigned)(stats.memory_bytes / 1024));
+            return ESP_OK;
+        }
+        ESP_LOGW(TAG, "History allocation for %u spots failed, halving", (unsigned)capacity);
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+size_t hamview_history_capacity(void)
+{
+    return s_capacity;
+}
+
+size_t hamview_history_count(void)
+{
+    return s_count;
+}
+
+void hamview_history_push(const hamview_spot_t *spot, uint64_t received_us, uint8_t mode_class)
+{
+    if (!spot || s_capacity == 0) {
+        return;
+    }
+    if (s_count == s_capacity) {
+        entry_release(entry_at(s_count - 1));
+        s_count--;
+    }
+
+    history_entry_t staged;
+    memset(&staged, 0, sizeof(staged));
+    staged.received_s = (uint32_t)(received_us / 1000000ULL);
+    staged.mode_class = mode_class;
+    staged.freq_hz = parse_freq_hz(spot->frequency);
+    /* A full string table costs the oldest entries, never the fields of
+     * the new one. */
+    while (!entry_intern(&staged, spot)) {
+        s_intern_overflows++;
+        if (s_count == 0) {
+            ESP_LOGW(TAG, "Spot %s does not fit the string table", spot->callsign);
+            return;
+        }
+        entry_release(entry_at(s_count - 1));
+        s_count--;
+    }
+
+    history_entry_t *entry = &s_entries[s_head];
+    *entry = staged;
+    comment_write(spot->comment, sizeof(spot->comment), entry);
+    s_head = (s_head + 1) % s_capacity;
+    s_count++;
+}
+
+void hamview_history_expire(uint64_t now_us, uint64_t max_age_us)
+{
+    while (s_count > 0) {
+        history_entry_t *oldest = entry_at(s_count - 1);
+        uint64_t received_us = (uint64_t)oldest->received_s * 1000000ULL;
+        uint64_t age_us = (now_us >= received_us) ? (now_us - received_us) : 0;
+        if (age_us <= max_age_us) {
+            break;
+        }
+        entry_release(oldest);
+        s_count--;
+    }
+}
+
+bool hamview_history_get(size_t index, hamview_spot_t *out, uint64_t *received_us)
+{
+    if (!out || index >= s_count) {
+        return false;
+    }
+    const history_entry_t *entry = entry_at(index);
+    memset(out, 0, sizeof(*out));
+    for (size_t f = 0; f < FIELD_COUNT; ++f) {
+        intern_copy(entry->str[f], (char *)out + k_fields[f].offset, k_fields[f].size);
+    }
+    if (entry->freq_hz) {
+        snprintf(out->frequency, sizeof(out->frequency), "%u.%03u",
+                 (unsigned)(entry->freq_hz / 1000), (unsigned)(entry->freq_hz % 1000));
+    } else {
+        intern_copy(entry->freq_str, out->frequency, sizeof(out->frequency));
+    }
+    comment_read(entry, out->comment, sizeof(out->comment));
+    if (received_us) {
+        *received_us = (uint64_t)entry->received_s * 1000000ULL;
+    }
+    return true;
+}
+
+void hamview_history_get_stats(hamview_history_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    out->capacity = s_capacity;
+    out->count = s_count;
+    out->strings = s_string_live;
+    out->string_bytes = s_string_arena_used;
+    out->string_arena_bytes = s_string_arena_size;
+    out->comment_arena_bytes = s_comment_size;
+    out->compactions = s_compactions;
+    out->intern_overflows = s_intern_overflows;
+    if (s_capacity > 0) {
+        out->memory_bytes = s_capacity * sizeof(history_entry_t) + s_string_slots * sizeof(intern_entry_t) +
+                            (s_bucket_mask + 1) * sizeof(uint16_t) + 2 * s_string_arena_size + s_comment_size;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef HAMVIEW_HISTORY_H
+#define HAMVIEW_HISTORY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "hamview_backend.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    size_t capacity;
+    size_t count;
+    size_t strings;
+    size_t string_bytes;
+    size_t string_arena_bytes;
+    size_t comment_arena_bytes;
+    size_t memory_bytes;
+    uint32_t compactions;
+    uint32_t intern_overflows; /* entries evicted early because the string table was full */
+} hamview_history_stats_t;
+
+typedef void (*hamview_history_evict_cb_t)(uint64_t received_us, uint8_t mode_class);
+
+/* Compact spot history ring. Each entry is 32 bytes: times and frequency as
+ * integers, text fields as ids into a shared refcounted string table and
+ * the comment as a slice of a FIFO byte arena (old comments may be
+ * overwritten before their entry expires). Full hamview_spot_t values are
+ * only rebuilt on demand by hamview_history_get().
+ *
+ * Not thread-safe; the backend calls everything under its spot mutex. */
+esp_err_t hamview_history_init(size_t capacity, hamview_history_evict_cb_t on_evict);
+size_t hamview_history_capacity(void);
+size_t hamview_history_count(void);
+void hamview_history_push(const hamview_spot_t *spot, uint64_t received_us, uint8_t mode_class);
+void hamview_history_expire(uint64_t now_us, uint64_t max_age_us);
+/* index 0 is the newest entry. */
+bool hamview_history_get(size_t index, hamview_spot_t *out, uint64_t *received_us);
+void hamview_history_get_stats(hamview_history_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,438 @@
+#include "hamview_history_store.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_crc.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#define STORE_PARTITION_LABEL       "hamhist"
+#define STORE_SECTOR_SIZE           (4096)
+#define STORE_MAGIC                 (0x32485648u) /* "HVH2" */
+#define STORE_RECORD_SIZE           (128)
+#define STORE_RECORDS_PER_SECTOR    (STORE_SECTOR_SIZE / STORE_RECORD_SIZE - 1)
+#define STORE_V1_MAGIC              (0x31485648u) /* "HVH1" */
+#define STORE_V1_RECORD_SIZE        (32)
+#define STORE_PENDING_MAX           (64)
+#define STORE_CHECKPOINT_RECORDS    (32)
+#define STORE_CHECKPOINT_MS         (60000)
+#define STORE_TASK_STACK            (3072)
+#define STORE_TASK_PRIORITY         (2)
+
+/* Flash layout: the partition is a ring of 4 KB sectors, each opened with a
+ * header carrying an increasing sequence number and then filled with fixed
+ * 128-byte records in arrival order. Sectors are erased strictly
+ * round-robin, so wear is spread evenly and the sector after the newest one
+ * is always the oldest. A record is programmed exactly once; the only
+ * overhead is the header slot of each sector.
+ *
+ * The first layout ("HVH1") had 32-byte records with only callsign and
+ * frequency. Its sectors are still read back; the first boot with this
+ * layout opens a new sector after the newest old one, and the rest are
+ * overwritten as the ring comes round. */
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint16_t record_size;
+    uint8_t reserved[22];
+} store_sector_header_t;
+
+typedef struct {
+    uint32_t epoch;
+    uint16_t crc;
+    uint8_t mode_class;
+    uint8_t reserved;
+    char callsign[12];
+    char frequency[12];
+    char mode[8];
+    char spotter[12];
+    char dxcc[4];
+    char continent[4];
+    char country[24];
+    char comment[44];
+} store_record_t;
+
+typedef struct {
+    uint32_t epoch;
+    uint16_t crc;
+    uint8_t mode_class;
+    uint8_t reserved;
+    char callsign[12];
+    char frequency[12];
+} store_record_v1_t;
+
+_Static_assert(sizeof(store_sector_header_t) == STORE_V1_RECORD_SIZE, "sector header must fill one v1 record slot");
+_Static_assert(sizeof(store_record_t) == STORE_RECORD_SIZE, "record layout changed");
+_Static_assert(sizeof(store_record_v1_t) == STORE_V1_RECORD_SIZE, "v1 record layout changed");
+
+static const char *TAG = "hamview_history_store";
+
+static const esp_partition_t *s_part = NULL;
+static uint32_t s_sector_count = 0;
+static uint32_t s_cur_sector = 0;
+static uint32_t s_cur_seq = 0;
+static uint32_t s_cur_index = 0;
+static SemaphoreHandle_t s_flash_lock = NULL;
+static TaskHandle_t s_task = NULL;
+
+/* Records waiting for the next checkpoint. Appends come from the ingest
+ * path, so this is a plain array behind a spinlock. */
+static portMUX_TYPE s_pending_lock = portMUX_INITIALIZER_UNLOCKED;
+static store_record_t s_pending[STORE_PENDING_MAX];
+static size_t s_pending_count = 0;
+static store_record_t s_batch[STORE_PENDING_MAX];
+static hamview_history_store_stats_t s_stats;
+
+/* Both layouts start with epoch, crc and mode_class, so one CRC covers
+ * either: everything but the crc field itself. */
+static uint16_t record_crc(const void *rec, size_t size)
+{
+    const uint8_t *bytes = rec;
+    uint16_t crc = esp_crc16_le(0, bytes, offsetof(store_record_t, crc));
+    return esp_crc16_le(crc, bytes + offsetof(store_record_t, mode_class), size - offsetof(store_record_t, mode_class));
+}
+
+static bool slot_is_erased(const void *slot, size_t size)
+{
+    const uint32_t *words = slot;
+    for (size_t i = 0; i < size / sizeof(uint32_t); ++i) {
+        if (words[i] != 0xFFFFFFFFu) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t slot_offset(uint32_t sector, uint32_t index)
+{
+    return (size_t)sector * STORE_SECTOR_SIZE + (size_t)(index + 1) * STORE_RECORD_SIZE;
+}
+
+/* Record size of a valid sector header of either layout, 0 otherwise. */
+static size_t header_record_size(const store_sector_header_t *header)
+{
+    if (header->seq == 0xFFFFFFFFu) {
+        return 0;
+    }
+    if (header->magic == STORE_MAGIC && header->record_size == STORE_RECORD_SIZE) {
+        return STORE_RECORD_SIZE;
+    }
+    if (header->magic == STORE_V1_MAGIC && header->record_size == STORE_V1_RECORD_SIZE) {
+        return STORE_V1_RECORD_SIZE;
+    }
+    return 0;
+}
+
+/* Decodes one programmed slot of either layout; false for erased, torn or
+ * corrupt slots. */
+static bool decode_slot(const void *slot, size_t record_size, hamview_history_record_t *out)
+{
+    const store_record_t *rec = slot;
+    if (slot_is_erased(slot, record_size) || rec->crc != record_crc(slot, record_size)) {
+        return false;
+    }
+    memset(out, 0, sizeof(*out));
+    out->epoch = rec->epoch;
+    out->mode_class = rec->mode_class;
+#define COPY_FIELD(field) \
+    do { \
+        memcpy(out->field, rec->field, sizeof(out->field)); \
+        out->field[sizeof(out->field) - 1] = '\0'; \
+    } while (0)
+    COPY_FIELD(callsign);
+    COPY_FIELD(frequency);
+    if (record_size == STORE_RECORD_SIZE) {
+        COPY_FIELD(mode);
+        COPY_FIELD(spotter);
+        COPY_FIELD(dxcc);
+        COPY_FIELD(continent);
+        COPY_FIELD(country);
+        COPY_FIELD(comment);
+    }
+#undef COPY_FIELD
+    return true;
+}
+
+static esp_err_t open_sector(uint32_t sector, uint32_t seq)
+{
+    esp_err_t err = esp_partition_erase_range(s_part, (size_t)sector * STORE_SECTOR_SIZE, STORE_SECTOR_SIZE);
+    if (err != ESP_OK) {
+        return err;
+    }
+    store_sector_header_t header;
+    memset(&header, 0xFF, sizeof(header));
+    header.magic = STORE_MAGIC;
+    header.seq = seq;
+    header.record_size = STORE_RECORD_SIZE;
+    err = esp_partition_write(s_part, (size_t)sector * STORE_SECTOR_SIZE, &header, sizeof(header));
+    if (err != ESP_OK) {
+        return err;
+    }
+    s_cur_sector = sector;
+    s_cur_seq = seq;
+    s_cur_index = 0;
+    taskENTER_CRITICAL(&s_pending_lock);
+    s_stats.sectors_erased++;
+    s_stats.flash_bytes_written += sizeof(header);
+    taskEXIT_CRITICAL(&s_pending_lock);
+    return ESP_OK;
+}
+
+/* Finds the newest sector and the first free slot in it. A log whose
+ * newest sector has the first layout continues in a fresh sector. */
+static esp_err_t locate_head(void)
+{
+    bool found = false;
+    size_t head_record_size = 0;
+    for (uint32_t i = 0; i < s_sector_count; ++i) {
+        store_sector_header_t header;
+        if (esp_partition_read(s_part, (size_t)i * STORE_SECTOR_SIZE, &header, sizeof(header)) != ESP_OK) {
+            continue;
+        }
+        size_t record_size = header_record_size(&header);
+        if (record_size == 0) {
+            continue;
+        }
+        if (!found || header.seq > s_cur_seq) {
+            s_cur_sector = i;
+            s_cur_seq = header.seq;
+            head_record_size = record_size;
+            found = true;
+        }
+    }
+    if (!found) {
+        ESP_LOGI(TAG, "Empty history log, formatting");
+        return open_sector(0, 1);
+    }
+    if (head_record_size != STORE_RECORD_SIZE) {
+        ESP_LOGI(TAG, "History log has %u-byte records, continuing with %u-byte ones",
+                 (unsigned)head_record_size, (unsigned)STORE_RECORD_SIZE);
+        return open_sector((s_cur_sector + 1) % s_sector_count, s_cur_seq + 1);
+    }
+
+    store_record_t *records = malloc(STORE_SECTOR_SIZE);
+    if (!records) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t err = esp_partition_read(s_part, (size_t)s_cur_sector * STORE_SECTOR_SIZE, records, STORE_SECTOR_SIZE);
+    if (err == ESP_OK) {
+        /* Resume after the last programmed slot, torn ones included. */
+        s_cur_index = 0;
+        for (uint32_t i = STORE_RECORDS_PER_SECTOR; i > 0; --i) {
+            if (!slot_is_erased(&records[i], STORE_RECORD_SIZE)) {
+                s_cur_index = i;
+                break;
+            }
+        }
+    }
+    free(records);
+    return err;
+}
+
+static void store_checkpoint(void)
+{
+    size_t count;
+    taskENTER_CRITICAL(&s_pending_lock);
+    count = s_pending_count;
+    memcpy(s_batch, s_pending, count * sizeof(s_batch[0]));
+    s_pending_count = 0;
+    taskEXIT_CRITICAL(&s_pending_lock);
+    if (count == 0) {
+        return;
+    }
+
+    xSemaphoreTake(s_flash_lock, portMAX_DELAY);
+    size_t done = 0;
+    esp_err_t err = ESP_OK;
+    while (done < count) {
+        if (s_cur_index >= STORE_RECORDS_PER_SECTOR) {
+            err = open_sector((s_cur_sector + 1) % s_sector_count, s_cur_seq + 1);
+            if (err != ESP_OK) {
+                break;
+            }
+        }
+        size_t run = count - done;
+        if (run > STORE_RECORDS_PER_SECTOR - s_cur_index) {
+            run = STORE_RECORDS_PER_SECTOR - s_cur_index;
+        }
+        err = esp_partition_write(s_part, slot_offset(s_cur_sector, s_cur_index), &s_batch[done], run * STORE_RECORD_SIZE);
+        if (err != ESP_OK) {
+            break;
+        }
+        s_cur_index += run;
+        done += run;
+    }
+    xSemaphoreGive(s_flash_lock);
+
+    taskENTER_CRITICAL(&s_pending_lock);
+    s_stats.checkpoints++;
+    s_stats.flash_bytes_written += done * STORE_RECORD_SIZE;
+    s_stats.dropped += count - done;
+    taskEXIT_CRITICAL(&s_pending_lock);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Checkpoint failed after %u of %u records: %s", (unsigned)done, (unsigned)count, esp_err_to_name(err));
+    }
+}
+
+static void store_task(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(STORE_CHECKPOINT_MS));
+        store_checkpoint();
+    }
+}
+
+esp_err_t hamview_history_store_init(void)
+{
+    if (s_task) {
+        return ESP_OK;
+    }
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, STORE_PARTITION_LABEL);
+    if (!s_part) {
+        ESP_LOGW(TAG, "No \"%s\" partition; history will not survive a reboot", STORE_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_sector_count = s_part->size / STORE_SECTOR_SIZE;
+    if (s_sector_count < 2) {
+        s_part = NULL;
+        return ESP_ERR_INVALID_SIZE;
+    }
+    s_flash_lock = xSemaphoreCreateMutex();
+    if (!s_flash_lock) {
+        s_part = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t err = locate_head();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "History log unreadable: %s", esp_err_to_name(err));
+        s_part = NULL;
+        return err;
+    }
+    if (xTaskCreatePinnedToCore(store_task, "hamview_hist", STORE_TASK_STACK, NULL, STORE_TASK_PRIORITY, &s_task, tskNO_AFFINITY) != pdPASS) {
+        s_task = NULL;
+        s_part = NULL;
+        return ESP_FAIL;
+    }
+    s_stats.available = true;
+    s_stats.sectors = s_sector_count;
+    ESP_LOGI(TAG, "History log: %u sectors, head at sector %u slot %u (seq %u)",
+             (unsigned)s_sector_count, (unsigned)s_cur_sector, (unsigned)s_cur_index, (unsigned)s_cur_seq);
+    return ESP_OK;
+}
+
+void hamview_history_store_append(const hamview_history_record_t *record)
+{
+    if (!record || !s_task) {
+        return;
+    }
+    store_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.epoch = record->epoch;
+    rec.mode_class = record->mode_class;
+    strlcpy(rec.callsign, record->callsign, sizeof(rec.callsign));
+    strlcpy(rec.frequency, record->frequency, sizeof(rec.frequency));
+    strlcpy(rec.mode, record->mode, sizeof(rec.mode));
+    strlcpy(rec.spotter, record->spotter, sizeof(rec.spotter));
+    strlcpy(rec.dxcc, record->dxcc, sizeof(rec.dxcc));
+    strlcpy(rec.continent, record->continent, sizeof(rec.continent));
+    strlcpy(rec.country, record->country, sizeof(rec.country));
+    strlcpy(rec.comment, record->comment, sizeof(rec.comment));
+    rec.crc = record_crc(&rec, sizeof(rec));
+
+    bool checkpoint_due = false;
+    taskENTER_CRITICAL(&s_pending_lock);
+    if (s_pending_count < STORE_PENDING_MAX) {
+        s_pending[s_pending_count++] = rec;
+        s_stats.appended++;
+        s_stats.payload_bytes += sizeof(rec);
+        checkpoint_due = s_pending_count >= STORE_CHECKPOINT_RECORDS;
+    } else {
+        s_stats.dropped++;
+    }
+    taskEXIT_CRITICAL(&s_pending_lock);
+
+    if (checkpoint_due) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+size_t hamview_history_store_restore(uint32_t since_epoch, hamview_history_restore_cb_t cb, void *ctx)
+{
+    if (!s_part || !cb) {
+        return 0;
+    }
+    uint8_t *sector_buf = malloc(STORE_SECTOR_SIZE);
+    if (!sector_buf) {
+        return 0;
+    }
+    int64_t start_us = esp_timer_get_time();
+    size_t replayed = 0;
+    hamview_history_record_t out;
+
+    xSemaphoreTake(s_flash_lock, portMAX_DELAY);
+    for (uint32_t step = 1; step <= s_sector_count; ++step) {
+        uint32_t sector = (s_cur_sector + step) % s_sector_count;
+        bool newest = (sector == s_cur_sector);
+        store_sector_header_t header;
+        if (esp_partition_read(s_part, (size_t)sector * STORE_SECTOR_SIZE, &header, sizeof(header)) != ESP_OK) {
+            continue;
+        }
+        size_t record_size = header_record_size(&header);
+        if (record_size == 0 || header.seq > s_cur_seq) {
+            continue;
+        }
+        uint32_t used = newest ? s_cur_index : STORE_SECTOR_SIZE / record_size - 1;
+        if (used == 0) {
+            continue;
+        }
+
+        /* A full sector whose last record is already too old holds nothing
+         * worth reading. */
+        if (!newest) {
+            size_t last = (size_t)sector * STORE_SECTOR_SIZE + used * record_size;
+            if (esp_partition_read(s_part, last, sector_buf, record_size) != ESP_OK) {
+                continue;
+            }
+            if (decode_slot(sector_buf, record_size, &out) && out.epoch < since_epoch) {
+                continue;
+            }
+        }
+
+        if (esp_partition_read(s_part, (size_t)sector * STORE_SECTOR_SIZE, sector_buf, STORE_SECTOR_SIZE) != ESP_OK) {
+            continue;
+        }
+        for (uint32_t i = 1; i <= used; ++i) {
+            if (!decode_slot(sector_buf + i * record_size, record_size, &out) || out.epoch < since_epoch) {
+                continue;
+            }
+            cb(&out, ctx);
+            replayed++;
+        }
+    }
+    xSemaphoreGive(s_flash_lock);
+    free(sector_buf);
+
+    uint32_t elapsed_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+    taskENTER_CRITICAL(&s_pending_lock);
+    s_stats.restored = (uint32_t)replayed;
+    s_stats.restore_ms = elapsed_ms;
+    taskEXIT_CRITICAL(&s_pending_lock);
+    ESP_LOGI(TAG, "Restored %u records in %u ms", (unsigned)replayed, (unsigned)elapsed_ms);
+    return replayed;
+}
+
+void hamview_history_store_get_stats(hamview_history_store_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_pending_lock);
+    *out = s_stats;
+    taskEXIT_CRITICAL(&s_pending_lock);
+}
@@ -0,0 +1,63 @@
+#ifndef HAMVIEW_HISTORY_STORE_H
+#define HAMVIEW_HISTORY_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* What the flash log keeps per spot: enough to rebuild the activity charts
+ * and the history rows. Longer fields are truncated; records logged by the
+ * first layout come back with only callsign and frequency set. */
+typedef struct {
+    uint32_t epoch;
+    uint8_t mode_class;
+    char callsign[12];
+    char frequency[12];
+    char mode[8];
+    char spotter[12];
+    char dxcc[4];
+    char continent[4];
+    char country[24];
+    char comment[44];
+} hamview_history_record_t;
+
+typedef struct {
+    bool available;
+    uint32_t sectors;
+    uint32_t appended;
+    uint32_t dropped;
+    uint32_t checkpoints;
+    uint32_t sectors_erased;
+    uint64_t payload_bytes;
+    uint64_t flash_bytes_written;
+    uint32_t restored;
+    uint32_t restore_ms;
+} hamview_history_store_stats_t;
+
+typedef void (*hamview_history_restore_cb_t)(const hamview_history_record_t *record, void *ctx);
+
+/* Opens the "hamhist" partition and starts the checkpoint task. Without the
+ * partition the store stays disabled and appends are ignored. */
+esp_err_t hamview_history_store_init(void);
+
+/* Queues a record for the next checkpoint; never touches flash itself, so
+ * it is safe to call with the spot mutex held. */
+void hamview_history_store_append(const hamview_history_record_t *record);
+
+/* Replays every logged record with epoch >= since_epoch, oldest first, with
+ * one sequential pass over the log. Returns the number of records replayed. */
+size_t hamview_history_store_restore(uint32_t since_epoch, hamview_history_restore_cb_t cb, void *ctx);
+
+void hamview_history_store_get_stats(hamview_history_store_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
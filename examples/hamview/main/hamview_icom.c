@@ -1,5 +1,6 @@
 #include "hamview_icom.h"
 
+#include <stdatomic.h>
 #include <string.h>
 #include <errno.h>
 
@@ -50,10 +51,23 @@
 
 static const char *TAG = "hamview_icom";
 
+/* s_state is published with a seqlock: writers serialize on s_state_mutex
+ * and bump s_state_seq to odd while they modify it; readers never lock. */
 static hamview_icom_state_t s_state;
 static SemaphoreHandle_t s_state_mutex;
-static uint8_t s_civ_buf[CIV_MAX_FRAME];
-static size_t s_civ_len = 0;
+static atomic_uint s_state_seq = 0;
+
+/* Owned by the task of its transport; hamview_icom_reset() only raises
+ * reset, which that task honours before its next buffer. */
+typedef struct {
+    uint8_t buf[CIV_MAX_FRAME];
+    size_t len;
+    uint32_t frames;
+    uint32_t dropped;
+    atomic_bool reset;
+} civ_parser_t;
+
+static civ_parser_t s_civ_parsers[HAMVIEW_ICOM_TRANSPORT_COUNT];
 static TaskHandle_t s_civ_task_handle = NULL;
 static bool s_civ_wifi_enabled = false;
 static char s_civ_ip[32] = "";
@@ -62,6 +76,13 @@ static char s_civ_username[32] = "";
 static char s_civ_password[32] = "";
 static uint64_t s_civ_last_rx_ms = 0;
 
+/* SPSC sample ring: the CI-V parser advances head, the UI advances tail. */
+#define CIV_SAMPLE_RING_SIZE 256
+static hamview_icom_sample_t s_samples[CIV_SAMPLE_RING_SIZE];
+static atomic_uint s_sample_head = 0;
+static atomic_uint s_sample_tail = 0;
+static uint32_t s_samples_dropped = 0;
+
 #define CIV_ADDR_IC705 0xA4
 #define CIV_ADDR_CTRL  0xE1
 
@@ -354,7 +375,7 @@ static void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_
             break;
         }
         case ESP_GATTC_NOTIFY_EVT: {
-            hamview_icom_on_civ_bytes(param->notify.value, param->notify.value_len);
+            hamview_icom_on_civ_bytes(HAMVIEW_ICOM_TRANSPORT_BLE, param->notify.value, param->notify.value_len);
             break;
         }
         case ESP_GATTC_DISCONNECT_EVT: {
@@ -513,7 +534,7 @@ static void spp_event_handler(esp_spp_cb_event_t event, esp_spp_cb_param_t *para
             break;
         }
         case ESP_SPP_DATA_IND_EVT: {
-            hamview_icom_on_civ_bytes(param->data_ind.data, param->data_ind.len);
+            hamview_icom_on_civ_bytes(HAMVIEW_ICOM_TRANSPORT_SPP, param->data_ind.data, param->data_ind.len);
             break;
         }
         case ESP_SPP_CLOSE_EVT: {
@@ -585,6 +606,30 @@ static void state_unlock(void)
     }
 }
 
+/* Readers retry while the sequence is odd. Callers hold the state lock. */
+static void state_seq_open(void)
+{
+    atomic_fetch_add_explicit(&s_state_seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static void state_seq_close(void)
+{
+    atomic_fetch_add_explicit(&s_state_seq, 1, memory_order_release);
+}
+
+static void state_write_begin(void)
+{
+    state_lock();
+    state_seq_open();
+}
+
+static void state_write_end(void)
+{
+    state_seq_close();
+    state_unlock();
+}
+
 static uint64_t civ_bcd_to_hz(const uint8_t *bcd, size_t len)
 {
     uint64_t value = 0;
@@ -620,47 +665,352 @@ static const char *civ_mode_to_text(uint8_t mode)
     }
 }
 
-static void civ_process_frame(const uint8_t *frame, size_t len)
+typedef enum {
+    CIV_PARAM_FREQ,
+    CIV_PARAM_MODE,
+    CIV_PARAM_SMETER,
+    CIV_PARAM_TX,
+    CIV_PARAM_POWER,
+    CIV_PARAM_SWR,
+    CIV_PARAM_ALC,
+    CIV_PARAM_SPLIT,
+    CIV_PARAM_DATA_MODE,
+    CIV_PARAM_FILTER_WIDTH,
+    CIV_PARAM_RF_POWER,
+    CIV_PARAM_COUNT,
+} civ_param_t;
+
+typedef struct {
+    uint64_t seen_ms;
+    uint64_t changed_ms;
+    uint64_t pushed_ms;
+} civ_activity_t;
+
+/* Guarded by the state mutex; written by whoever parses CI-V frames. */
+static civ_activity_t s_civ_activity[CIV_PARAM_COUNT];
+
+static void civ_push_sample(uint64_t now, uint64_t freq_hz, uint8_t s_meter_raw)
 {
-    if (!frame || len < 6 || frame[0] != 0xFE || frame[1] != 0xFE || frame[len - 1] != 0xFD) {
+    unsigned head = atomic_load_explicit(&s_sample_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&s_sample_tail, memory_order_acquire);
+    if (head - tail >= CIV_SAMPLE_RING_SIZE) {
+        s_samples_dropped++;
         return;
     }
+    hamview_icom_sample_t *slot = &s_samples[head % CIV_SAMPLE_RING_SIZE];
+    slot->t_ms = (uint32_t)now;
+    slot->freq_hz = freq_hz > UINT32_MAX ? UINT32_MAX : (uint32_t)freq_hz;
+    slot->s_meter_raw = s_meter_raw;
+    atomic_store_explicit(&s_sample_head, head + 1, memory_order_release);
+}
+
+/* Big-endian BCD, as used by the level and meter commands ("0255"). */
+static uint32_t civ_bcd_be(const uint8_t *bcd, size_t len)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < len; ++i) {
+        value = value * 100U + ((bcd[i] >> 4) & 0x0F) * 10U + (bcd[i] & 0x0F);
+    }
+    return value;
+}
+
+static bool civ_set_u8(uint8_t *field, uint32_t value)
+{
+    uint8_t v = value > 255U ? 255U : (uint8_t)value;
+    bool changed = *field != v;
+    *field = v;
+    return changed;
+}
+
+static bool civ_set_bool(bool *field, bool value)
+{
+    bool changed = *field != value;
+    *field = value;
+    return changed;
+}
+
+/* Decoders get the payload after the command and sub-command bytes and
+ * return true when the state changed. */
+typedef bool (*civ_decode_fn_t)(hamview_icom_state_t *st, const uint8_t *data, size_t len);
+
+static bool civ_decode_freq(hamview_icom_state_t *st, const uint8_t *data, size_t len)
+{
+    uint64_t freq = civ_bcd_to_hz(data, 5);
+    bool changed = freq != st->freq_hz;
+    st->freq_hz = freq;
+    return changed;
+}
+
+static bool civ_decode_unselected_freq(hamview_icom_state_t *st, const uint8_t *data, size_t len)
+{
+    uint64_t freq = civ_bcd_to_hz(data, 5);
+    bool changed = freq != st->unselected_freq_hz;
+    st->unselected_freq_hz = freq;
+    return changed;
+}
+
+static bool civ_decode_mode(hamview_icom_state_t *st, const uint8_t *data, size_t len)
+{
+    bool changed = false;
+    const char *mode = civ_mode_to_text(data[0]);
+    if (mode[0]) {
+        changed = strcmp(st->mode, mode) != 0;
+        strlcpy(st->mode, mode, sizeof(st->mode));
+    }
+    if (len >= 2) {
+        changed |= civ_set_u8(&st->filter, data[1]);
+    }
+    return changed;
+}
+
+static bool civ_decode_split(hamview_icom_state_t *st, const uint8_t *data, size_t len)
+{
+    return civ_set_bool(&st->split, data[0] != 0x00);
+}
+
+static bool civ_decode_rf_power(hamview_icom_state_t *st, const uint8_t *data, size_t len)
+{
+    return civ_set_u8(&st->rf_power_raw, civ_bcd_be(data, 2));
+}
+
+/* Older firmware answers with a single raw byte instead of BCD "0000".."0255". */
+static bool civ_decode_smeter(hamview_icom_state_t *st, const uint8_t *data, size_t len)
+{
+    return civ_set_u8(&st->s_meter_raw, len >= 2 ? civ_bcd_be(data, 2) : data[0]);
+}
+
+static bool civ_decode_power_meter(hamview_icom_state_t *st, const uint8_t *data, size_t len)
+{
+    return civ_set_u8(&st->power_meter_raw, civ_bcd_be(data, 2));
+}
+
+static bool civ_decode_swr(hamview_icom_state_t *st, const uint8_t *data, size_t len)
+{
+    return civ_set_u8(&st->swr_raw, civ_bcd_be(data, 2));
+}
+
+static bool civ_decode_alc(hamview_icom_state_t *st, const uint8_t *data, size_t len)
+{
+    return civ_set_u8(&st->alc_raw, civ_bcd_be(data, 2));
+}
+
+/* IF filter width index 0..49: 200 Hz steps in AM; otherwise 50 Hz steps up
+ * to 500 Hz, then 100 Hz steps from 600 Hz. FM has fixed filters. */
+static bool civ_decode_filter_width(hamview_icom_state_t *st, const uint8_t *data, size_t len)
+{
+    uint32_t index = civ_bcd_be(data, 1);
+    uint16_t width = 0;
+    if (strncmp(st->mode, "FM", 2) == 0 || strcmp(st->mode, "WFM") == 0) {
+        width = 0;
+    } else if (strncmp(st->mode, "AM", 2) == 0) {
+        width = (uint16_t)((index + 1U) * 200U);
+    } else if (index < 10U) {
+        width = (uint16_t)((index + 1U) * 50U);
+    } else {
+        width = (uint16_t)(600U + (index - 10U) * 100U);
+    }
+    bool changed = width != st->filter_width_hz;
+    st->filter_width_hz = width;
+    return changed;
+}
+
+static bool civ_decode_data_mode(hamview_icom_state_t *st, const uint8_t *data, size_t len)
+{
+    bool changed = civ_set_u8(&st->data_mode, data[0]);
+    if (len >= 2 && data[1] != 0x00) {
+        changed |= civ_set_u8(&st->filter, data[1]);
+    }
+    return changed;
+}
+
+static bool civ_decode_tx(hamview_icom_state_t *st, const uint8_t *data, size_t len)
+{
+    bool changed = civ_set_bool(&st->transmitting, data[0] != 0x00);
+    if (changed && !st->transmitting) {
+        st->power_meter_raw = 0;
+        st->swr_raw = 0;
+        st->alc_raw = 0;
+    }
+    return changed;
+}
+
+typedef struct {
+    uint8_t cmd;
+    int16_t sub;      /* -1 when the command has no sub-command */
+    uint8_t min_len;  /* payload bytes required after cmd/sub */
+    int8_t param;     /* civ_param_t credited to the poll scheduler, or -1 */
+    civ_decode_fn_t decode;
+} civ_decoder_t;
+
+/* Sorted by command. 0x00/0x01 are transceive broadcasts, 0x03/0x04 poll
+ * replies and 0x05/0x06 another controller's set commands seen on a shared
+ * bus; all three describe the same VFO state. */
+static const civ_decoder_t CIV_DECODERS[] = {
+    { 0x00, -1, 5, CIV_PARAM_FREQ, civ_decode_freq },
+    { 0x01, -1, 1, CIV_PARAM_MODE, civ_decode_mode },
+    { 0x03, -1, 5, CIV_PARAM_FREQ, civ_decode_freq },
+    { 0x04, -1, 1, CIV_PARAM_MODE, civ_decode_mode },
+    { 0x05, -1, 5, CIV_PARAM_FREQ, civ_decode_freq },
+    { 0x06, -1, 1, CIV_PARAM_MODE, civ_decode_mode },
+    { 0x0F, -1, 1, CIV_PARAM_SPLIT, civ_decode_split },
+    { 0x14, 0x0A, 2, CIV_PARAM_RF_POWER, civ_decode_rf_power },
+    { 0x15, 0x02, 1, CIV_PARAM_SMETER, civ_decode_smeter },
+    { 0x15, 0x11, 2, CIV_PARAM_POWER, civ_decode_power_meter },
+    { 0x15, 0x12, 2, CIV_PARAM_SWR, civ_decode_swr },
+    { 0x15, 0x13, 2, CIV_PARAM_ALC, civ_decode_alc },
+    { 0x1A, 0x03, 1, CIV_PARAM_FILTER_WIDTH, civ_decode_filter_width },
+    { 0x1A, 0x06, 1, CIV_PARAM_DATA_MODE, civ_decode_data_mode },
+    { 0x1C, 0x00, 1, CIV_PARAM_TX, civ_decode_tx },
+    { 0x25, 0x00, 5, CIV_PARAM_FREQ, civ_decode_freq },
+    { 0x25, 0x01, 5, -1, civ_decode_unselected_freq },
+};
+
+static const civ_decoder_t *civ_find_decoder(uint8_t cmd, const uint8_t *data, size_t data_len)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(CIV_DECODERS); ++i) {
+        const civ_decoder_t *d = &CIV_DECODERS[i];
+        if (d->cmd < cmd) {
+            continue;
+        }
+        if (d->cmd > cmd) {
+            break;
+        }
+        if (d->sub < 0 || (data_len > 0 && data[0] == (uint8_t)d->sub)) {
+            return d;
+        }
+    }
+    return NULL;
+}
+
+/* One write section per receive buffer, locked and opened by the first
+ * frame that actually decodes; OK/NG acks and unknown commands never take
+ * the lock. */
+typedef struct {
+    bool open;
+    uint64_t now;
+} civ_batch_t;
 
+static void civ_dispatch_frame(civ_batch_t *batch, const uint8_t *frame, size_t len)
+{
+    while (len > 6 && frame[2] == 0xFE) {
+        frame++;
+        len--;
+    }
+    if (len < 6) {
+        return;
+    }
     uint8_t cmd = frame[4];
     const uint8_t *data = &frame[5];
     size_t data_len = len - 6;
+    const civ_decoder_t *d = civ_find_decoder(cmd, data, data_len);
+    if (!d) {
+        return;
+    }
+    if (d->sub >= 0) {
+        data++;
+        data_len--;
+    }
+    if (data_len < d->min_len) {
+        return;
+    }
 
-    state_lock();
-    switch (cmd) {
-        case 0x03: {
-            if (data_len >= 5) {
-                s_state.freq_hz = civ_bcd_to_hz(data, 5);
-                s_state.last_update_ms = now_ms();
-            }
-            break;
+    if (!batch->open) {
+        batch->now = now_ms();
+        state_write_begin();
+        batch->open = true;
+    }
+    bool changed = d->decode(&s_state, data, data_len);
+    s_state.last_update_ms = batch->now;
+    if (d->param == CIV_PARAM_FREQ || d->param == CIV_PARAM_SMETER) {
+        civ_push_sample(batch->now, s_state.freq_hz, s_state.s_meter_raw);
+    }
+    if (d->param >= 0) {
+        civ_activity_t *a = &s_civ_activity[d->param];
+        a->seen_ms = batch->now;
+        if (changed) {
+            a->changed_ms = batch->now;
+        }
+        /* Transceive updates are broadcast to 0x00 with their own commands. */
+        if (frame[2] == 0x00 || cmd == 0x00 || cmd == 0x01) {
+            a->pushed_ms = batch->now;
         }
-        case 0x04:
-        case 0x05: {
-            if (data_len >= 2) {
-                const char *mode = civ_mode_to_text(data[0]);
-                if (mode[0]) {
-                    strlcpy(s_state.mode, mode, sizeof(s_state.mode));
+    }
+}
+
+/* Scans a whole buffer for FE FE ... FD frames and decodes them in place.
+ * Only a frame split across buffers is copied into the parser, which a
+ * pending reset empties first. */
+static void civ_parse_buffer(civ_parser_t *p, const uint8_t *data, size_t len)
+{
+    civ_batch_t batch = {0};
+    size_t i = 0;
+
+    if (atomic_exchange_explicit(&p->reset, false, memory_order_acquire)) {
+        p->len = 0;
+        p->frames = 0;
+        p->dropped = 0;
+    }
+    if (p->len > 0) {
+        if (p->len == 1 && data[0] != 0xFE) {
+            p->len = 0;
+        } else {
+            const uint8_t *end = memchr(data, 0xFD, len);
+            size_t take = end ? (size_t)(end - data) + 1 : len;
+            if (p->len + take > sizeof(p->buf)) {
+                p->dropped++;
+                p->len = 0;
+            } else {
+                memcpy(&p->buf[p->len], data, take);
+                p->len += take;
+                i = take;
+                if (end) {
+                    p->frames++;
+                    civ_dispatch_frame(&batch, p->buf, p->len);
+                    p->len = 0;
                 }
-                s_state.last_update_ms = now_ms();
             }
+        }
+    }
+
+    while (i < len) {
+        const uint8_t *start = memchr(&data[i], 0xFE, len - i);
+        if (!start) {
             break;
         }
-        case 0x15: {
-            if (data_len >= 2 && data[0] == 0x02) {
-                s_state.s_meter_raw = data[1];
-                s_state.last_update_ms = now_ms();
-            }
+        size_t s = (size_t)(start - data);
+        if (s + 1 >= len) {
+            p->buf[0] = 0xFE;
+            p->len = 1;
             break;
         }
-        default:
+        if (data[s + 1] != 0xFE) {
+            i = s + 1;
+            continue;
+        }
+        const uint8_t *end = memchr(&data[s + 2], 0xFD, len - s - 2);
+        if (!end) {
+            size_t rest = len - s;
+            if (rest <= sizeof(p->buf)) {
+                memcpy(p->buf, &data[s], rest);
+                p->len = rest;
+            } else {
+                p->dropped++;
+            }
             break;
+        }
+        size_t frame_len = (size_t)(end - &data[s]) + 1;
+        if (frame_len <= CIV_MAX_FRAME) {
+            p->frames++;
+            civ_dispatch_frame(&batch, &data[s], frame_len);
+        } else {
+            p->dropped++;
+        }
+        i = s + frame_len;
+    }
+
+    if (batch.open) {
+        state_write_end();
     }
-    state_unlock();
 }
 
 static size_t civ_build_frame(uint8_t *buf, size_t max, uint8_t dest, uint8_t src, uint8_t cmd, const uint8_t *data, size_t data_len)
@@ -682,6 +1032,192 @@ static size_t civ_build_frame(uint8_t *buf, size_t max, uint8_t dest, uint8_t sr
     return idx;
 }
 
+typedef struct {
+    uint8_t cmd;
+    int16_t sub;          /* -1 when the command has no sub-command */
+    uint16_t idle_ms;     /* poll period while the value is steady */
+    uint16_t active_ms;   /* poll period shortly after the value changed */
+    uint16_t pushed_ms;   /* poll period while transceive updates arrive */
+    bool tx_only;         /* only meaningful while transmitting */
+} civ_poll_spec_t;
+
+/* Frequency is polled every 80 ms, steady or not: a change is only seen on
+ * the next poll, so that period bounds the tracking latency, and it nearly
+ * stops being polled once the radio pushes transceive updates on its own.
+ * The S-meter is never pushed and sets the rate of the slower values, which
+ * ride along in the frequency datagrams; the TX meters are only asked for
+ * while keyed. */
+static const civ_poll_spec_t CIV_POLL_SPECS[CIV_PARAM_COUNT] = {
+    [CIV_PARAM_FREQ] = { 0x03, -1, 80, 80, 5000, false },
+    [CIV_PARAM_MODE] = { 0x04, -1, 2000, 500, 10000, false },
+    [CIV_PARAM_SMETER] = { 0x15, 0x02, 250, 250, 250, false },
+    [CIV_PARAM_TX] = { 0x1C, 0x00, 500, 250, 500, false },
+    [CIV_PARAM_POWER] = { 0x15, 0x11, 250, 250, 250, true },
+    [CIV_PARAM_SWR] = { 0x15, 0x12, 250, 250, 250, true },
+    [CIV_PARAM_ALC] = { 0x15, 0x13, 250, 250, 250, true },
+    [CIV_PARAM_SPLIT] = { 0x0F, -1, 2000, 1000, 2000, false },
+    [CIV_PARAM_DATA_MODE] = { 0x1A, 0x06, 2000, 1000, 2000, false },
+    [CIV_PARAM_FILTER_WIDTH] = { 0x1A, 0x03, 2000, 1000, 2000, false },
+    [CIV_PARAM_RF_POWER] = { 0x14, 0x0A, 5000, 1000, 5000, false },
+};
+
+#define CIV_ACTIVE_HOLD_MS 2000
+#define CIV_PUSH_HOLD_MS 15000
+#define CIV_SCHED_MAX_WAIT_MS 200
+
+/* Where CI-V requests go. Until the radio first answers we rotate through
+ * the combinations different firmware accepts, one per poll, and keep the
+ * one it replies on. */
+typedef struct {
+    bool via_ctrl;
+    bool alt_header;
+    uint8_t src;
+} civ_route_t;
+
+static const civ_route_t CIV_PROBE_ROUTES[] = {
+    { false, false, CIV_ADDR_CTRL },
+    { false, true, CIV_ADDR_CTRL },
+    { true, false, CIV_ADDR_CTRL },
+    { true, true, CIV_ADDR_CTRL },
+    { false, false, 0xE0 },
+    { false, true, 0xE0 },
+};
+
+typedef struct {
+    uint64_t last_sent_ms[CIV_PARAM_COUNT];
+    civ_route_t route;
+    bool route_locked;
+    size_t probe;
+    uint64_t last_rx_ms;
+    uint32_t datagrams;
+    uint32_t frames;
+} civ_sched_t;
+
+static void civ_sched_reset(civ_sched_t *sched)
+{
+    memset(sched, 0, sizeof(*sched));
+    sched->route = CIV_PROBE_ROUTES[0];
+}
+
+/* Next time each parameter should be asked for. Any reply or pushed update
+ * counts as fresh data, so a radio in transceive mode pushes the deadline
+ * out by itself. */
+static void civ_sched_deadlines(const civ_sched_t *sched, uint64_t now, uint64_t due[CIV_PARAM_COUNT],
+                                uint32_t period[CIV_PARAM_COUNT])
+{
+    civ_activity_t activity[CIV_PARAM_COUNT];
+    state_lock();
+    memcpy(activity, s_civ_activity, sizeof(activity));
+    bool transmitting = s_state.transmitting;
+    state_unlock();
+
+    for (size_t i = 0; i < CIV_PARAM_COUNT; ++i) {
+        const civ_poll_spec_t *spec = &CIV_POLL_SPECS[i];
+        const civ_activity_t *a = &activity[i];
+        if (spec->tx_only && !transmitting) {
+            period[i] = spec->idle_ms;
+            due[i] = UINT64_MAX;
+            continue;
+        }
+        uint32_t p = spec->idle_ms;
+        if (a->pushed_ms != 0 && now - a->pushed_ms < CIV_PUSH_HOLD_MS) {
+            p = spec->pushed_ms;
+        } else if (a->changed_ms != 0 && now - a->changed_ms < CIV_ACTIVE_HOLD_MS) {
+            p = spec->active_ms;
+        }
+        uint64_t base = sched->last_sent_ms[i];
+        if (a->seen_ms > base) {
+            base = a->seen_ms;
+        }
+        period[i] = p;
+        due[i] = base + p;
+    }
+}
+
+static uint32_t civ_sched_wait_ms(const civ_sched_t *sched, uint64_t now)
+{
+    uint64_t due[CIV_PARAM_COUNT];
+    uint32_t period[CIV_PARAM_COUNT];
+    civ_sched_deadlines(sched, now, due, period);
+    uint32_t wait = CIV_SCHED_MAX_WAIT_MS;
+    for (size_t i = 0; i < CIV_PARAM_COUNT; ++i) {
+        if (due[i] <= now) {
+            return 0;
+        }
+        if (due[i] - now < wait) {
+            wait = (uint32_t)(due[i] - now);
+        }
+    }
+    return wait;
+}
+
+/* Fills payload with one request frame per parameter that is due. Once
+ * something is going out anyway, parameters due within half a period ride
+ * along in the same datagram. Returns 0 when nothing is due. */
+static size_t civ_sched_collect(civ_sched_t *sched, uint64_t now, uint8_t *payload, size_t max)
+{
+    uint64_t due[CIV_PARAM_COUNT];
+    uint32_t period[CIV_PARAM_COUNT];
+    civ_sched_deadlines(sched, now, due, period);
+    if (!sched->route_locked) {
+        sched->route = CIV_PROBE_ROUTES[sched->probe];
+    }
+
+    bool any_due = false;
+    for (size_t i = 0; i < CIV_PARAM_COUNT; ++i) {
+        any_due |= due[i] <= now;
+    }
+    if (!any_due) {
+        return 0;
+    }
+
+    size_t len = 0;
+    for (size_t i = 0; i < CIV_PARAM_COUNT; ++i) {
+        if (due[i] > now + period[i] / 2) {
+            continue;
+        }
+        const civ_poll_spec_t *spec = &CIV_POLL_SPECS[i];
+        if (len + (spec->sub >= 0 ? 7 : 6) > max) {
+            break;
+        }
+        uint8_t sub = (uint8_t)spec->sub;
+        size_t n = civ_build_frame(payload + len, max - len, CIV_ADDR_IC705, sched->route.src, spec->cmd,
+                                   spec->sub >= 0 ? &sub : NULL, spec->sub >= 0 ? 1 : 0);
+        if (n == 0) {
+            break;
+        }
+        len += n;
+        sched->last_sent_ms[i] = now;
+        sched->frames++;
+    }
+    if (len > 0) {
+        sched->datagrams++;
+        if (!sched->route_locked) {
+            sched->probe = (sched->probe + 1) % ARRAY_SIZE(CIV_PROBE_ROUTES);
+        }
+    }
+    return len;
+}
+
+/* Called for every CI-V payload from the radio. The socket and header style
+ * it arrived with, and the address it was sent to, are what the radio
+ * answers on. */
+static void civ_sched_learn_route(civ_sched_t *sched, bool via_ctrl, bool alt_header, const uint8_t *data, size_t len)
+{
+    sched->last_rx_ms = now_ms();
+    if (sched->route_locked) {
+        return;
+    }
+    sched->route.via_ctrl = via_ctrl;
+    sched->route.alt_header = alt_header;
+    if (len >= 3 && data[0] == 0xFE && data[1] == 0xFE && (data[2] == CIV_ADDR_CTRL || data[2] == 0xE0)) {
+        sched->route.src = data[2];
+    }
+    sched->route_locked = true;
+    ESP_LOGI(TAG, "CIV route: %s socket, %s header, from 0x%02x",
+             via_ctrl ? "control" : "CI-V", alt_header ? "type 0" : "0xC1", sched->route.src);
+}
+
 static void icom_tx_store(icom_tx_entry_t *entries, size_t entry_count, uint16_t seq, const uint8_t *data, size_t len)
 {
     if (!entries || entry_count == 0 || !data || len == 0) {
@@ -887,45 +1423,32 @@ static void icom_send_civ_openclose(int sock, const struct sockaddr_in *dest, ui
     icom_send_tracked(sock, dest, seq, tx, tx_count, packet, sizeof(packet));
 }
 
+/* The radio accepts CI-V either as a 0xC1 packet or as a type 0 packet
+ * tagged 0xC1 at offset 0x10, depending on firmware; alt_header picks the
+ * latter. */
 static void icom_send_civ_data(int sock, const struct sockaddr_in *dest, uint16_t *seq, icom_tx_entry_t *tx, size_t tx_count,
-                               uint32_t my_id, uint32_t remote_id, uint16_t *civ_seq, const uint8_t *payload, size_t payload_len)
+                               uint32_t my_id, uint32_t remote_id, uint16_t *civ_seq, bool alt_header,
+                               const uint8_t *payload, size_t payload_len)
 {
     if (!payload || payload_len == 0) {
         return;
     }
-    uint8_t header[ICOM_CIV_HEADER_SIZE] = {0};
-    write_u32_le(header, 0, (uint32_t)(ICOM_CIV_HEADER_SIZE + payload_len));
-    write_u16_le(header, 4, 0xC1);
-    write_u32_le(header, 8, my_id);
-    write_u32_le(header, 12, remote_id);
-    header[0x10] = 0x00;
-    write_u16_le(header, 0x11, (uint16_t)payload_len);
-    write_u16_le(header, 0x13, *civ_seq);
-    (*civ_seq)++;
-
     uint8_t buffer[ICOM_CIV_HEADER_SIZE + CIV_MAX_FRAME];
     size_t total = ICOM_CIV_HEADER_SIZE + payload_len;
     if (total > sizeof(buffer)) {
         return;
     }
-    memcpy(buffer, header, ICOM_CIV_HEADER_SIZE);
+    memset(buffer, 0, ICOM_CIV_HEADER_SIZE);
+    write_u32_le(buffer, 0, (uint32_t)total);
+    write_u16_le(buffer, 4, alt_header ? 0x00 : 0xC1);
+    write_u32_le(buffer, 8, my_id);
+    write_u32_le(buffer, 12, remote_id);
+    buffer[0x10] = alt_header ? 0xC1 : 0x00;
+    write_u16_le(buffer, 0x11, (uint16_t)payload_len);
+    write_u16_le(buffer, 0x13, *civ_seq);
+    (*civ_seq)++;
     memcpy(buffer + ICOM_CIV_HEADER_SIZE, payload, payload_len);
     icom_send_tracked(sock, dest, seq, tx, tx_count, buffer, total);
-
-    if (s_civ_last_rx_ms == 0) {
-        uint8_t alt_header[ICOM_CIV_HEADER_SIZE] = {0};
-        write_u32_le(alt_header, 0, (uint32_t)(ICOM_CIV_HEADER_SIZE + payload_len));
-        write_u16_le(alt_header, 4, 0x00);
-        write_u32_le(alt_header, 8, my_id);
-        write_u32_le(alt_header, 12, remote_id);
-        alt_header[0x10] = 0xC1;
-        write_u16_le(alt_header, 0x11, (uint16_t)payload_len);
-        write_u16_le(alt_header, 0x13, *civ_seq);
-        (*civ_seq)++;
-        memcpy(buffer, alt_header, ICOM_CIV_HEADER_SIZE);
-        memcpy(buffer + ICOM_CIV_HEADER_SIZE, payload, payload_len);
-        icom_send_tracked(sock, dest, seq, tx, tx_count, buffer, total);
-    }
 }
 
 static bool icom_open_udp_socket(int *sock_out, uint16_t *port_out)
@@ -1055,8 +1578,9 @@ static void civ_wifi_task(void *arg)
     uint64_t last_ping = 0;
     uint64_t last_idle = 0;
     uint64_t last_token = 0;
-    uint64_t last_poll = 0;
     uint64_t last_civ_open = 0;
+    civ_sched_t sched;
+    civ_sched_reset(&sched);
 
     s_civ_last_rx_ms = 0;
     hamview_icom_set_device("IC-705 WiFi", s_civ_ip);
@@ -1072,7 +1596,11 @@ static void civ_wifi_task(void *arg)
                 maxfd = civ_sock;
             }
         }
-        struct timeval tv = { .tv_sec = 0, .tv_usec = 200000 };
+        uint32_t wait_ms = CIV_SCHED_MAX_WAIT_MS;
+        if (stream_open && civ_ready) {
+            wait_ms = civ_sched_wait_ms(&sched, now_ms());
+        }
+        struct timeval tv = { .tv_sec = 0, .tv_usec = (suseconds_t)wait_ms * 1000 };
         int sel = select(maxfd + 1, &readset, NULL, NULL, &tv);
 
         if (sel > 0 && FD_ISSET(ctrl_sock, &readset)) {
@@ -1118,7 +1646,8 @@ static void civ_wifi_task(void *arg)
                 } else if ((type == 0xC1 || (type == 0x00 && rx_buf[0x10] == 0xC1)) && len >= ICOM_CIV_HEADER_SIZE) {
                     uint16_t data_len = (uint16_t)(rx_buf[0x11] | (rx_buf[0x12] << 8));
                     if (data_len > 0 && (ICOM_CIV_HEADER_SIZE + data_len) <= (size_t)len) {
-                        hamview_icom_on_civ_bytes(&rx_buf[ICOM_CIV_HEADER_SIZE], data_len);
+                        civ_sched_learn_route(&sched, true, type == 0x00, &rx_buf[ICOM_CIV_HEADER_SIZE], data_len);
+                        hamview_icom_on_civ_bytes(HAMVIEW_ICOM_TRANSPORT_WIFI, &rx_buf[ICOM_CIV_HEADER_SIZE], data_len);
                         s_civ_last_rx_ms = now_ms();
                         hamview_icom_set_connected(true);
                     }
@@ -1300,7 +1829,8 @@ static void civ_wifi_task(void *arg)
                 } else if ((type == 0xC1 || (type == 0x00 && rx_buf[0x10] == 0xC1)) && len >= ICOM_CIV_HEADER_SIZE) {
                     uint16_t data_len = (uint16_t)(rx_buf[0x11] | (rx_buf[0x12] << 8));
                     if (data_len > 0 && (ICOM_CIV_HEADER_SIZE + data_len) <= (size_t)len) {
-                        hamview_icom_on_civ_bytes(&rx_buf[ICOM_CIV_HEADER_SIZE], data_len);
+                        civ_sched_learn_route(&sched, false, type == 0x00, &rx_buf[ICOM_CIV_HEADER_SIZE], data_len);
+                        hamview_icom_on_civ_bytes(HAMVIEW_ICOM_TRANSPORT_WIFI, &rx_buf[ICOM_CIV_HEADER_SIZE], data_len);
                         s_civ_last_rx_ms = now_ms();
                         hamview_icom_set_connected(true);
                     }
@@ -1398,35 +1928,16 @@ static void civ_wifi_task(void *arg)
             last_civ_open = now;
         }
 
-        if (stream_open && civ_sock >= 0 && civ_ready && (now - last_poll) > 500) {
-            uint8_t frame[CIV_MAX_FRAME];
-            size_t len;
-            len = civ_build_frame(frame, sizeof(frame), CIV_ADDR_IC705, CIV_ADDR_CTRL, 0x03, NULL, 0);
-            icom_send_civ_data(civ_sock, &civ_dest, &civ_send_seq, civ_tx, ICOM_TX_BUF_COUNT, civ_my_id, civ_remote_id, &civ_seq, frame, len);
-            len = civ_build_frame(frame, sizeof(frame), CIV_ADDR_IC705, CIV_ADDR_CTRL, 0x04, NULL, 0);
-            icom_send_civ_data(civ_sock, &civ_dest, &civ_send_seq, civ_tx, ICOM_TX_BUF_COUNT, civ_my_id, civ_remote_id, &civ_seq, frame, len);
-            uint8_t smeter_req[1] = {0x02};
-            len = civ_build_frame(frame, sizeof(frame), CIV_ADDR_IC705, CIV_ADDR_CTRL, 0x15, smeter_req, sizeof(smeter_req));
-            icom_send_civ_data(civ_sock, &civ_dest, &civ_send_seq, civ_tx, ICOM_TX_BUF_COUNT, civ_my_id, civ_remote_id, &civ_seq, frame, len);
-
-            if (s_civ_last_rx_ms == 0) {
-                len = civ_build_frame(frame, sizeof(frame), CIV_ADDR_IC705, CIV_ADDR_CTRL, 0x03, NULL, 0);
-                icom_send_civ_data(ctrl_sock, &ctrl_dest, &ctrl_send_seq, ctrl_tx, ICOM_TX_BUF_COUNT, my_id, remote_id, &civ_seq, frame, len);
-                len = civ_build_frame(frame, sizeof(frame), CIV_ADDR_IC705, CIV_ADDR_CTRL, 0x04, NULL, 0);
-                icom_send_civ_data(ctrl_sock, &ctrl_dest, &ctrl_send_seq, ctrl_tx, ICOM_TX_BUF_COUNT, my_id, remote_id, &civ_seq, frame, len);
-                len = civ_build_frame(frame, sizeof(frame), CIV_ADDR_IC705, CIV_ADDR_CTRL, 0x15, smeter_req, sizeof(smeter_req));
-                icom_send_civ_data(ctrl_sock, &ctrl_dest, &ctrl_send_seq, ctrl_tx, ICOM_TX_BUF_COUNT, my_id, remote_id, &civ_seq, frame, len);
+        if (stream_open && civ_sock >= 0 && civ_ready) {
+            uint8_t payload[CIV_MAX_FRAME];
+            size_t len = civ_sched_collect(&sched, now, payload, sizeof(payload));
+            if (len > 0 && sched.route.via_ctrl) {
+                icom_send_civ_data(ctrl_sock, &ctrl_dest, &ctrl_send_seq, ctrl_tx, ICOM_TX_BUF_COUNT, my_id, remote_id,
+                                   &civ_seq, sched.route.alt_header, payload, len);
+            } else if (len > 0) {
+                icom_send_civ_data(civ_sock, &civ_dest, &civ_send_seq, civ_tx, ICOM_TX_BUF_COUNT, civ_my_id, civ_remote_id,
+                                   &civ_seq, sched.route.alt_header, payload, len);
             }
-
-            if (s_civ_last_rx_ms == 0) {
-                len = civ_build_frame(frame, sizeof(frame), CIV_ADDR_IC705, 0xE0, 0x03, NULL, 0);
-                icom_send_civ_data(civ_sock, &civ_dest, &civ_send_seq, civ_tx, ICOM_TX_BUF_COUNT, civ_my_id, civ_remote_id, &civ_seq, frame, len);
-                len = civ_build_frame(frame, sizeof(frame), CIV_ADDR_IC705, 0xE0, 0x04, NULL, 0);
-                icom_send_civ_data(civ_sock, &civ_dest, &civ_send_seq, civ_tx, ICOM_TX_BUF_COUNT, civ_my_id, civ_remote_id, &civ_seq, frame, len);
-                len = civ_build_frame(frame, sizeof(frame), CIV_ADDR_IC705, 0xE0, 0x15, smeter_req, sizeof(smeter_req));
-                icom_send_civ_data(civ_sock, &civ_dest, &civ_send_seq, civ_tx, ICOM_TX_BUF_COUNT, civ_my_id, civ_remote_id, &civ_seq, frame, len);
-            }
-            last_poll = now;
         }
 
         if (stream_open && civ_sock >= 0 && civ_ready && (now - s_civ_last_rx_ms) > ICOM_CIV_WATCHDOG_MS) {
@@ -1438,6 +1949,10 @@ static void civ_wifi_task(void *arg)
         if (s_civ_last_rx_ms == 0 || (now - s_civ_last_rx_ms) > 5000) {
             hamview_icom_set_connected(false);
         }
+        if (sched.route_locked && (now - sched.last_rx_ms) > 5000) {
+            ESP_LOGW(TAG, "CIV route silent (%u polls sent), probing again", (unsigned)sched.datagrams);
+            sched.route_locked = false;
+        }
     }
 
     if (civ_sock >= 0 && stream_open) {
@@ -1470,31 +1985,34 @@ void hamview_icom_init(void)
 
 void hamview_icom_reset(void)
 {
-    state_lock();
+    state_write_begin();
     memset(&s_state, 0, sizeof(s_state));
+    memset(s_civ_activity, 0, sizeof(s_civ_activity));
     s_state.last_update_ms = 0;
     s_state.mode[0] = '\0';
-    state_unlock();
-    s_civ_len = 0;
+    state_write_end();
+    for (size_t i = 0; i < ARRAY_SIZE(s_civ_parsers); ++i) {
+        atomic_store_explicit(&s_civ_parsers[i].reset, true, memory_order_release);
+    }
 }
 
 void hamview_icom_set_connected(bool connected)
 {
-    state_lock();
+    state_write_begin();
     s_state.connected = connected;
-    state_unlock();
+    state_write_end();
 }
 
 void hamview_icom_set_device(const char *name, const char *addr)
 {
-    state_lock();
+    state_write_begin();
     if (name) {
         strlcpy(s_state.device_name, name, sizeof(s_state.device_name));
     }
     if (addr) {
         strlcpy(s_state.device_addr, addr, sizeof(s_state.device_addr));
     }
-    state_unlock();
+    state_write_end();
 }
 
 bool hamview_icom_connect(const char *addr)
@@ -1570,50 +2088,51 @@ void hamview_icom_set_civ_wifi(bool enable, const char *ip, uint16_t port, const
     }
 }
 
-void hamview_icom_on_civ_bytes(const uint8_t *data, size_t len)
+void hamview_icom_on_civ_bytes(hamview_icom_transport_t transport, const uint8_t *data, size_t len)
 {
-    if (!data || len == 0) {
+    if (!data || len == 0 || transport >= HAMVIEW_ICOM_TRANSPORT_COUNT) {
         return;
     }
+    civ_parse_buffer(&s_civ_parsers[transport], data, len);
+}
 
-    for (size_t i = 0; i < len; ++i) {
-        uint8_t byte = data[i];
-        if (s_civ_len == 0) {
-            if (byte == 0xFE) {
-                s_civ_buf[s_civ_len++] = byte;
-            }
+bool hamview_icom_get_state(hamview_icom_state_t *out)
+{
+    if (!out) {
+        return false;
+    }
+    while (true) {
+        unsigned seq = atomic_load_explicit(&s_state_seq, memory_order_acquire);
+        if (seq & 1U) {
+            /* The writer may be a lower-priority task on this core. */
+            vTaskDelay(1);
             continue;
         }
-
-        if (s_civ_len == 1) {
-            if (byte != 0xFE) {
-                s_civ_len = 0;
-                continue;
-            }
-            s_civ_buf[s_civ_len++] = byte;
-            continue;
-        }
-
-        if (s_civ_len < CIV_MAX_FRAME) {
-            s_civ_buf[s_civ_len++] = byte;
-        } else {
-            s_civ_len = 0;
-        }
-
-        if (byte == 0xFD && s_civ_len >= 6) {
-            civ_process_frame(s_civ_buf, s_civ_len);
-            s_civ_len = 0;
+        memcpy(out, &s_state, sizeof(*out));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&s_state_seq, memory_order_relaxed) == seq) {
+            return true;
         }
     }
 }
 
-bool hamview_icom_get_state(hamview_icom_state_t *out)
+size_t hamview_icom_read_samples(hamview_icom_sample_t *out, size_t max)
 {
     if (!out) {
-        return false;
+        return 0;
     }
-    state_lock();
-    *out = s_state;
-    state_unlock();
-    return true;
+    unsigned tail = atomic_load_explicit(&s_sample_tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&s_sample_head, memory_order_acquire);
+    size_t n = 0;
+    while (n < max && tail != head) {
+        out[n++] = s_samples[tail % CIV_SAMPLE_RING_SIZE];
+        tail++;
+    }
+    atomic_store_explicit(&s_sample_tail, tail, memory_order_release);
+    return n;
+}
+
+uint32_t hamview_icom_samples_dropped(void)
+{
+    return s_samples_dropped;
 }
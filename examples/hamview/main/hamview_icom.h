@@ -13,19 +13,51 @@ typedef struct {
     char device_name[32];
     char device_addr[18];
     uint64_t freq_hz;
+    uint64_t unselected_freq_hz; /* other VFO; the TX frequency when split */
     char mode[12];
-    uint8_t s_meter_raw;
+    uint8_t filter;              /* FIL1..FIL3, 0 when unknown */
+    uint16_t filter_width_hz;    /* 0 when unknown */
+    uint8_t data_mode;           /* 0 off, 1..3 for D1..D3 */
+    bool split;
+    bool transmitting;
+    uint8_t rf_power_raw;        /* RF POWER setting, 0..255 */
+    uint8_t s_meter_raw;         /* meters are 0..255 as reported by the radio */
+    uint8_t power_meter_raw;
+    uint8_t swr_raw;
+    uint8_t alc_raw;
     uint64_t last_update_ms;
 } hamview_icom_state_t;
 
+typedef enum {
+    HAMVIEW_ICOM_TRANSPORT_BLE,
+    HAMVIEW_ICOM_TRANSPORT_SPP,
+    HAMVIEW_ICOM_TRANSPORT_WIFI,
+    HAMVIEW_ICOM_TRANSPORT_COUNT,
+} hamview_icom_transport_t;
+
+/* One CI-V reading: the frequency and S-meter as of t_ms (uptime ms). */
+typedef struct {
+    uint32_t t_ms;
+    uint32_t freq_hz;
+    uint8_t s_meter_raw;
+} hamview_icom_sample_t;
+
 void hamview_icom_init(void);
 void hamview_icom_reset(void);
 void hamview_icom_set_connected(bool connected);
 void hamview_icom_set_device(const char *name, const char *addr);
-void hamview_icom_on_civ_bytes(const uint8_t *data, size_t len);
+/* Decodes a receive buffer from one transport. Each transport keeps its own
+ * partial-frame state, so interleaved links cannot corrupt each other. */
+void hamview_icom_on_civ_bytes(hamview_icom_transport_t transport, const uint8_t *data, size_t len);
 bool hamview_icom_connect(const char *addr);
 void hamview_icom_disconnect(void);
+/* Lock-free; retries while the radio task is mid-update. */
 bool hamview_icom_get_state(hamview_icom_state_t *out);
+/* Drains up to max samples, oldest first. Single consumer (the UI); the
+ * CI-V parser is the single producer. Samples that arrive while the ring is
+ * full are dropped and counted. */
+size_t hamview_icom_read_samples(hamview_icom_sample_t *out, size_t max);
+uint32_t hamview_icom_samples_dropped(void);
 void hamview_icom_set_civ_wifi(bool enable, const char *ip, uint16_t port, const char *username, const char *password);
 
 #ifdef __cplusplus
@@ -0,0 +1,263 @@
+#include "hamview_ingest.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#define INGEST_LINE_MAX         (1024)
+#define INGEST_RING_SLOTS       (16)
+#define INGEST_PUSH_WAIT_MS     (200)
+#define INGEST_PARSE_SAMPLES    (128)
+#define INGEST_RATE_WINDOW_US   (10LL * 1000000LL)
+#define INGEST_TASK_STACK       (6144)
+#define INGEST_TASK_PRIORITY    (4)
+
+_Static_assert((INGEST_RING_SLOTS & (INGEST_RING_SLOTS - 1)) == 0, "ring size must be a power of two");
+
+typedef struct {
+    uint16_t len;
+    char text[INGEST_LINE_MAX];
+} ingest_slot_t;
+
+static const char *TAG = "hamview_ingest";
+
+/* Single-producer/single-consumer ring of complete lines. The reader only
+ * advances s_head, the parser only advances s_tail; a slot is handed to the
+ * line callback in place and released afterwards. */
+static ingest_slot_t *s_slots = NULL;
+static atomic_uint s_head = 0;
+static atomic_uint s_tail = 0;
+static TaskHandle_t s_parser_task = NULL;
+static SemaphoreHandle_t s_space_sem = NULL;
+static hamview_ingest_line_cb_t s_line_cb = NULL;
+
+/* Line being assembled by the reader. */
+static char s_line[INGEST_LINE_MAX];
+static size_t s_line_len = 0;
+static bool s_line_oversized = false;
+
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_lines = 0;
+static uint64_t s_bytes = 0;
+static uint32_t s_max_depth = 0;
+static uint32_t s_dropped = 0;
+static uint32_t s_oversized = 0;
+static uint32_t s_parse_max_us = 0;
+static uint32_t s_parse_samples[INGEST_PARSE_SAMPLES];
+static uint32_t s_parse_count = 0;
+static int64_t s_rate_start_us = 0;
+static uint32_t s_rate_start_lines = 0;
+static uint64_t s_rate_start_bytes = 0;
+static float s_lines_per_s = 0;
+static float s_bytes_per_s = 0;
+
+static void ingest_task(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        unsigned tail = atomic_load_explicit(&s_tail, memory_order_relaxed);
+        unsigned head = atomic_load_explicit(&s_head, memory_order_acquire);
+        if (tail == head) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        ingest_slot_t *slot = &s_slots[tail & (INGEST_RING_SLOTS - 1)];
+        int64_t start_us = esp_timer_get_time();
+        s_line_cb(slot->text, slot->len);
+        uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+        atomic_store_explicit(&s_tail, tail + 1, memory_order_release);
+        xSemaphoreGive(s_space_sem);
+
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_parse_samples[s_parse_count % INGEST_PARSE_SAMPLES] = elapsed_us;
+        s_parse_count++;
+        if (elapsed_us > s_parse_max_us) {
+            s_parse_max_us = elapsed_us;
+        }
+        taskEXIT_CRITICAL(&s_stats_lock);
+    }
+}
+
+esp_err_t hamview_ingest_init(hamview_ingest_line_cb_t cb)
+{
+    if (s_parser_task) {
+        return ESP_OK;
+    }
+    if (!cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_line_cb = cb;
+
+    size_t bytes = sizeof(ingest_slot_t) * INGEST_RING_SLOTS;
+    s_slots = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_slots) {
+        s_slots = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (!s_slots) {
+        ESP_LOGE(TAG, "line ring alloc failed");
+        return ESP_ERR_NO_MEM;
+    }
+    s_space_sem = xSemaphoreCreateBinary();
+    if (!s_space_sem) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_rate_start_us = esp_timer_get_time();
+    if (xTaskCreatePinnedToCore(ingest_task, "hamview_ingest", INGEST_TASK_STACK, NULL, INGEST_TASK_PRIORITY, &s_parser_task, tskNO_AFFINITY) != pdPASS) {
+        s_parser_task = NULL;
+        ESP_LOGE(TAG, "ingest task create failed");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/* Waits up to INGEST_PUSH_WAIT_MS for a free slot. While the reader waits it
+ * is not calling recv, so the socket buffer fills and TCP throttles the
+ * server; only a sustained stall drops lines. */
+static bool ingest_push(const char *line, size_t len)
+{
+    int64_t deadline_us = esp_timer_get_time() + INGEST_PUSH_WAIT_MS * 1000LL;
+    unsigned head = atomic_load_explicit(&s_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&s_tail, memory_order_acquire);
+    while (head - tail >= INGEST_RING_SLOTS) {
+        int64_t remaining_us = deadline_us - esp_timer_get_time();
+        if (remaining_us <= 0) {
+            return false;
+        }
+        xSemaphoreTake(s_space_sem, pdMS_TO_TICKS(remaining_us / 1000) + 1);
+        tail = atomic_load_explicit(&s_tail, memory_order_acquire);
+    }
+
+    ingest_slot_t *slot = &s_slots[head & (INGEST_RING_SLOTS - 1)];
+    memcpy(slot->text, line, len);
+    slot->text[len] = '\0';
+    slot->len = (uint16_t)len;
+    atomic_store_explicit(&s_head, head + 1, memory_order_release);
+    xTaskNotifyGive(s_parser_task);
+
+    uint32_t depth = head + 1 - tail;
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_lines++;
+    if (depth > s_max_depth) {
+        s_max_depth = depth;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+    return true;
+}
+
+static void ingest_finish_line(void)
+{
+    if (s_line_oversized) {
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_oversized++;
+        taskEXIT_CRITICAL(&s_stats_lock);
+        ESP_LOGW(TAG, "Discarded line longer than %d bytes", INGEST_LINE_MAX - 1);
+    } else {
+        size_t start = 0;
+        while (start < s_line_len && (s_line[start] == '\r' || s_line[start] == '\n')) {
+            start++;
+        }
+        if (start < s_line_len && s_line[start] == '{' && s_parser_task) {
+            if (!ingest_push(s_line + start, s_line_len - start)) {
+                taskENTER_CRITICAL(&s_stats_lock);
+                s_dropped++;
+                taskEXIT_CRITICAL(&s_stats_lock);
+                ESP_LOGW(TAG, "Parser backlog full, dropped spot line");
+            }
+        }
+    }
+    s_line_len = 0;
+    s_line_oversized = false;
+}
+
+void hamview_ingest_feed(const char *data, size_t len)
+{
+    if (!data || len == 0) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_bytes += len;
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    while (len > 0) {
+        const char *newline = memchr(data, '\n', len);
+        size_t chunk = newline ? (size_t)(newline - data) : len;
+        /* A line that outgrows the buffer is skipped up to its newline
+         * instead of wedging the reader. */
+        if (!s_line_oversized) {
+            if (s_line_len + chunk < INGEST_LINE_MAX) {
+                memcpy(s_line + s_line_len, data, chunk);
+                s_line_len += chunk;
+            } else {
+                s_line_oversized = true;
+            }
+        }
+        if (!newline) {
+            break;
+        }
+        ingest_finish_line();
+        data = newline + 1;
+        len -= chunk + 1;
+    }
+}
+
+void hamview_ingest_reset_line(void)
+{
+    s_line_len = 0;
+    s_line_oversized = false;
+}
+
+void hamview_ingest_get_stats(hamview_ingest_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    uint32_t samples[INGEST_PARSE_SAMPLES];
+    size_t count;
+    int64_t now_us = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    if (now_us - s_rate_start_us >= INGEST_RATE_WINDOW_US) {
+        float seconds = (float)(now_us - s_rate_start_us) / 1000000.0f;
+        s_lines_per_s = (float)(s_lines - s_rate_start_lines) / seconds;
+        s_bytes_per_s = (float)(s_bytes - s_rate_start_bytes) / seconds;
+        s_rate_start_us = now_us;
+        s_rate_start_lines = s_lines;
+        s_rate_start_bytes = s_bytes;
+    }
+    out->lines = s_lines;
+    out->bytes = s_bytes;
+    out->lines_per_s = s_lines_per_s;
+    out->bytes_per_s = s_bytes_per_s;
+    out->max_queue_depth = s_max_depth;
+    out->dropped_lines = s_dropped;
+    out->oversized_lines = s_oversized;
+    out->parse_us_max = s_parse_max_us;
+    count = s_parse_count < INGEST_PARSE_SAMPLES ? s_parse_count : INGEST_PARSE_SAMPLES;
+    memcpy(samples, s_parse_samples, count * sizeof(samples[0]));
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    unsigned tail = atomic_load(&s_tail);
+    out->queue_depth = atomic_load(&s_head) - tail;
+
+    /* Percentiles over the most recent parses. */
+    for (size_t i = 1; i < count; ++i) {
+        uint32_t value = samples[i];
+        size_t j = i;
+        while (j > 0 && samples[j - 1] > value) {
+            samples[j] = samples[j - 1];
+            --j;
+        }
+        samples[j] = value;
+    }
+    out->parse_us_p50 = count ? samples[(count - 1) * 50 / 100] : 0;
+    out->parse_us_p99 = count ? samples[(count - 1) * 99 / 100] : 0;
+}
@@ -0,0 +1,45 @@
+#ifndef HAMVIEW_INGEST_H
+#define HAMVIEW_INGEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*hamview_ingest_line_cb_t)(const char *line, size_t len);
+
+typedef struct {
+    uint32_t lines;
+    uint64_t bytes;
+    float lines_per_s;
+    float bytes_per_s;
+    uint32_t queue_depth;
+    uint32_t max_queue_depth;
+    uint32_t dropped_lines;
+    uint32_t oversized_lines;
+    uint32_t parse_us_p50;
+    uint32_t parse_us_p99;
+    uint32_t parse_us_max;
+} hamview_ingest_stats_t;
+
+/* Starts the parser task. cb runs on that task for every complete JSON line;
+ * the line is only valid for the duration of the call. */
+esp_err_t hamview_ingest_init(hamview_ingest_line_cb_t cb);
+
+/* Reader side, single producer: splits raw socket data into lines and queues
+ * them. Blocks briefly when the queue is full so TCP flow control can push
+ * back on the server before lines are dropped. */
+void hamview_ingest_feed(const char *data, size_t len);
+void hamview_ingest_reset_line(void);
+
+void hamview_ingest_get_stats(hamview_ingest_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
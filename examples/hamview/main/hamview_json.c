@@ -0,0 +1,508 @@
+#include "hamview_json.h"
+
+#include <ctype.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void json_put(hamview_json_writer_t *w, const char *data, size_t len)
+{
+    if (w->overflow) {
+        return;
+    }
+    if (w->len + len + 1 > w->cap) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->len, data, len);
+    w->len += len;
+}
+
+static void json_putc(hamview_json_writer_t *w, char c)
+{
+    json_put(w, &c, 1);
+}
+
+/* Emits the separator owed before a new value in the current container.
+ * A value written right after its key never needs one. */
+static void json_before_value(hamview_json_writer_t *w)
+{
+    if (w->after_key) {
+        w->after_key = false;
+        return;
+    }
+    if (w->depth == 0) {
+        return;
+    }
+    if (w->has_items[w->depth - 1]) {
+        json_putc(w, ',');
+    }
+    w->has_items[w->depth - 1] = true;
+}
+
+static void json_open(hamview_json_writer_t *w, char c)
+{
+    json_before_value(w);
+    json_putc(w, c);
+    if (w->depth >= HAMVIEW_JSON_MAX_DEPTH) {
+        w->overflow = true;
+        return;
+    }
+    w->has_items[w->depth++] = false;
+}
+
+static void json_close(hamview_json_writer_t *w, char c)
+{
+    if (w->depth > 0) {
+        w->depth--;
+    }
+    json_putc(w, c);
+}
+
+void hamview_json_init(hamview_json_writer_t *w, char *buf, size_t cap)
+{
+    memset(w, 0, sizeof(*w));
+    w->buf = buf;
+    w->cap = cap;
+    if (!buf || cap == 0) {
+        w->overflow = true;
+    }
+}
+
+void hamview_json_begin_object(hamview_json_writer_t *w)
+{
+    json_open(w, '{');
+}
+
+void hamview_json_end_object(hamview_json_writer_t *w)
+{
+    json_close(w, '}');
+}
+
+void hamview_json_begin_array(hamview_json_writer_t *w)
+{
+    json_open(w, '[');
+}
+
+void hamview_json_end_array(hamview_json_writer_t *w)
+{
+    json_close(w, ']');
+}
+
+static void json_escaped(hamview_json_writer_t *w, const char *value)
+{
+    static const char hex[] = "0123456789abcdef";
+    json_putc(w, '"');
+    const char *run = value;
+    for (const char *p = value; *p; ++p) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        json_put(w, run, (size_t)(p - run));
+        run = p + 1;
+        switch (c) {
+        case '"':
+            json_put(w, "\\\"", 2);
+            break;
+        case '\\':
+            json_put(w, "\\\\", 2);
+            break;
+        case '\n':
+            json_put(w, "\\n", 2);
+            break;
+        case '\r':
+            json_put(w, "\\r", 2);
+            break;
+        case '\t':
+            json_put(w, "\\t", 2);
+            break;
+        default: {
+            char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0f]};
+            json_put(w, esc, sizeof(esc));
+            break;
+        }
+        }
+    }
+    json_put(w, run, strlen(run));
+    json_putc(w, '"');
+}
+
+void hamview_json_key(hamview_json_writer_t *w, const char *key)
+{
+    json_before_value(w);
+    json_escaped(w, key);
+    json_putc(w, ':');
+    w->after_key = true;
+}
+
+void hamview_json_string(hamview_json_writer_t *w, const char *value)
+{
+    json_before_value(w);
+    json_escaped(w, value ? value : "");
+}
+
+void hamview_json_uint(hamview_json_writer_t *w, uint64_t value)
+{
+    char num[24];
+    json_before_value(w);
+    int n = snprintf(num, sizeof(num), "%" PRIu64, value);
+    json_put(w, num, (size_t)n);
+}
+
+void hamview_json_double(hamview_json_writer_t *w, double value)
+{
+    char num[32];
+    json_before_value(w);
+    int n = snprintf(num, sizeof(num), "%.6g", value);
+    /* JSON has no NaN/Inf. */
+    if (n <= 0 || value != value || value > 1e300 || value < -1e300) {
+        json_putc(w, '0');
+        return;
+    }
+    json_put(w, num, (size_t)n);
+}
+
+void hamview_json_bool(hamview_json_writer_t *w, bool value)
+{
+    json_before_value(w);
+    if (value) {
+        json_put(w, "true", 4);
+    } else {
+        json_put(w, "false", 5);
+    }
+}
+
+void hamview_json_kv_string(hamview_json_writer_t *w, const char *key, const char *value)
+{
+    hamview_json_key(w, key);
+    hamview_json_string(w, value);
+}
+
+void hamview_json_kv_uint(hamview_json_writer_t *w, const char *key, uint64_t value)
+{
+    hamview_json_key(w, key);
+    hamview_json_uint(w, value);
+}
+
+void hamview_json_kv_double(hamview_json_writer_t *w, const char *key, double value)
+{
+    hamview_json_key(w, key);
+    hamview_json_double(w, value);
+}
+
+void hamview_json_kv_bool(hamview_json_writer_t *w, const char *key, bool value)
+{
+    hamview_json_key(w, key);
+    hamview_json_bool(w, value);
+}
+
+size_t hamview_json_finish(hamview_json_writer_t *w)
+{
+    if (w->overflow || w->depth != 0) {
+        if (w->buf && w->cap > 0) {
+            w->buf[0] = '\0';
+        }
+        return 0;
+    }
+    w->buf[w->len] = '\0';
+    return w->len;
+}
+
+enum {
+    READER_VALUE,
+    READER_VALUE_OR_CLOSE,
+    READER_KEY,
+    READER_KEY_OR_CLOSE,
+    READER_COLON,
+    READER_AFTER_VALUE,
+    READER_STRING,
+    READER_LITERAL,
+    READER_DONE,
+};
+
+/* text_len keeps counting past the buffer so truncation stays visible. */
+static void reader_putc(hamview_json_reader_t *r, char c)
+{
+    if (r->text_len < sizeof(r->text) - 1) {
+        r->text[r->text_len] = c;
+    }
+    r->text_len++;
+}
+
+static void reader_put_utf8(hamview_json_reader_t *r, uint16_t cp)
+{
+    if (cp < 0x80) {
+        reader_putc(r, (char)cp);
+    } else if (cp < 0x800) {
+        reader_putc(r, (char)(0xC0 | (cp >> 6)));
+        reader_putc(r, (char)(0x80 | (cp & 0x3F)));
+    } else {
+        reader_putc(r, (char)(0xE0 | (cp >> 12)));
+        reader_putc(r, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        reader_putc(r, (char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+static void reader_terminate(hamview_json_reader_t *r)
+{
+    size_t end = r->text_len < sizeof(r->text) ? r->text_len : sizeof(r->text) - 1;
+    r->text[end] = '\0';
+}
+
+static void reader_emit(hamview_json_reader_t *r, hamview_json_type_t type, double number, bool boolean)
+{
+    reader_terminate(r);
+    hamview_json_value_t value = {
+        .type = type,
+        .text = r->text,
+        .number = number,
+        .boolean = boolean,
+    };
+    if (r->on_value) {
+        r->on_value(r, &value, r->ctx);
+    }
+    r->state = (r->depth == 0) ? READER_DONE : READER_AFTER_VALUE;
+}
+
+static bool reader_end_literal(hamview_json_reader_t *r)
+{
+    if (r->text_len >= sizeof(r->text)) {
+        return false;
+    }
+    reader_terminate(r);
+    if (strcmp(r->text, "true") == 0 || strcmp(r->text, "false") == 0) {
+        reader_emit(r, HAMVIEW_JSON_BOOL, 0.0, r->text[0] == 't');
+        return true;
+    }
+    if (strcmp(r->text, "null") == 0) {
+        reader_emit(r, HAMVIEW_JSON_NULL, 0.0, false);
+        return true;
+    }
+    if (strspn(r->text, "0123456789+-.eE") != r->text_len) {
+        return false;
+    }
+    char *end = NULL;
+    double number = strtod(r->text, &end);
+    if (end != r->text + r->text_len) {
+        return false;
+    }
+    reader_emit(r, HAMVIEW_JSON_NUMBER, number, false);
+    return true;
+}
+
+static bool reader_open(hamview_json_reader_t *r, char c)
+{
+    if (r->depth >= HAMVIEW_JSON_MAX_DEPTH) {
+        return false;
+    }
+    r->container[r->depth] = c;
+    r->index[r->depth] = 0;
+    r->key[r->depth][0] = '\0';
+    r->depth++;
+    r->state = (c == '{') ? READER_KEY_OR_CLOSE : READER_VALUE_OR_CLOSE;
+    return true;
+}
+
+static bool reader_close(hamview_json_reader_t *r, char c)
+{
+    if (r->depth == 0 || r->container[r->depth - 1] != (c == '}' ? '{' : '[')) {
+        return false;
+    }
+    r->depth--;
+    r->state = (r->depth == 0) ? READER_DONE : READER_AFTER_VALUE;
+    return true;
+}
+
+static int reader_hex(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = (char)tolower((unsigned char)c);
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+/* escape is 1 right after a backslash and 2..5 while reading \uXXXX. */
+static bool reader_string_char(hamview_json_reader_t *r, char c)
+{
+    if (r->escape == 1) {
+        r->escape = 0;
+        switch (c) {
+            case '"':
+            case '\\':
+            case '/':
+                reader_putc(r, c);
+                return true;
+            case 'b':
+                reader_putc(r, '\b');
+                return true;
+            case 'f':
+                reader_putc(r, '\f');
+                return true;
+            case 'n':
+                reader_putc(r, '\n');
+                return true;
+            case 'r':
+                reader_putc(r, '\r');
+                return true;
+            case 't':
+                reader_putc(r, '\t');
+                return true;
+            case 'u':
+                r->escape = 2;
+                r->unicode = 0;
+                return true;
+            default:
+                return false;
+        }
+    }
+    if (r->escape >= 2) {
+        int digit = reader_hex(c);
+        if (digit < 0) {
+            return false;
+        }
+        r->unicode = (uint16_t)((r->unicode << 4) | (uint16_t)digit);
+        if (++r->escape < 6) {
+            return true;
+        }
+        r->escape = 0;
+        reader_put_utf8(r, r->unicode);
+        return true;
+    }
+    if (c == '\\') {
+        r->escape = 1;
+        return true;
+    }
+    if (c == '"') {
+        if (!r->in_key) {
+            reader_emit(r, HAMVIEW_JSON_STRING, 0.0, false);
+            return true;
+        }
+        reader_terminate(r);
+        char *key = r->key[r->depth - 1];
+        size_t n = strnlen(r->text, HAMVIEW_JSON_READER_KEY_MAX - 1);
+        memcpy(key, r->text, n);
+        key[n] = '\0';
+        r->state = READER_COLON;
+        return true;
+    }
+    if ((unsigned char)c < 0x20) {
+        return false;
+    }
+    reader_putc(r, c);
+    return true;
+}
+
+static bool reader_step(hamview_json_reader_t *r, char c)
+{
+    if (r->state == READER_STRING) {
+        return reader_string_char(r, c);
+    }
+    if (r->state == READER_LITERAL) {
+        if (isalnum((unsigned char)c) || c == '+' || c == '-' || c == '.') {
+            reader_putc(r, c);
+            return true;
+        }
+        /* The terminator still has to be handled below. */
+        if (!reader_end_literal(r)) {
+            return false;
+        }
+    }
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        return true;
+    }
+
+    switch (r->state) {
+        case READER_VALUE_OR_CLOSE:
+            if (c == ']') {
+                return reader_close(r, c);
+            }
+            /* fall through */
+        case READER_VALUE:
+            if (c == '{' || c == '[') {
+                return reader_open(r, c);
+            }
+            r->text_len = 0;
+            if (c == '"') {
+                r->in_key = false;
+                r->state = READER_STRING;
+                return true;
+            }
+            if (c == '-' || isdigit((unsigned char)c) || c == 't' || c == 'f' || c == 'n') {
+                reader_putc(r, c);
+                r->state = READER_LITERAL;
+                return true;
+            }
+            return false;
+        case READER_KEY_OR_CLOSE:
+            if (c == '}') {
+                return reader_close(r, c);
+            }
+            /* fall through */
+        case READER_KEY:
+            if (c != '"') {
+                return false;
+            }
+            r->text_len = 0;
+            r->in_key = true;
+            r->state = READER_STRING;
+            return true;
+        case READER_COLON:
+            if (c != ':') {
+                return false;
+            }
+            r->state = READER_VALUE;
+            return true;
+        case READER_AFTER_VALUE:
+            if (c == ',') {
+                if (r->container[r->depth - 1] == '[') {
+                    r->index[r->depth - 1]++;
+                    r->state = READER_VALUE;
+                } else {
+                    r->state = READER_KEY;
+                }
+                return true;
+            }
+            if (c == '}' || c == ']') {
+                return reader_close(r, c);
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+void hamview_json_reader_init(hamview_json_reader_t *r, hamview_json_value_cb_t on_value, void *ctx)
+{
+    memset(r, 0, sizeof(*r));
+    r->on_value = on_value;
+    r->ctx = ctx;
+    r->state = READER_VALUE;
+}
+
+bool hamview_json_reader_feed(hamview_json_reader_t *r, const char *data, size_t len)
+{
+    if (r->error) {
+        return false;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        if (!reader_step(r, data[i])) {
+            r->error = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool hamview_json_reader_finish(hamview_json_reader_t *r)
+{
+    if (!r->error && r->state == READER_LITERAL && !reader_end_literal(r)) {
+        r->error = true;
+    }
+    return !r->error && r->state == READER_DONE;
+}
@@ -0,0 +1,100 @@
+#ifndef HAMVIEW_JSON_H
+#define HAMVIEW_JSON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HAMVIEW_JSON_MAX_DEPTH 8
+
+/* Streaming JSON writer into a caller-owned buffer; no heap use. Commas are
+ * inserted automatically. Once the buffer overflows every further call is a
+ * no-op and hamview_json_finish() returns 0. */
+typedef struct {
+    char *buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+    uint8_t depth;
+    bool after_key;
+    bool has_items[HAMVIEW_JSON_MAX_DEPTH];
+} hamview_json_writer_t;
+
+void hamview_json_init(hamview_json_writer_t *w, char *buf, size_t cap);
+void hamview_json_begin_object(hamview_json_writer_t *w);
+void hamview_json_end_object(hamview_json_writer_t *w);
+void hamview_json_begin_array(hamview_json_writer_t *w);
+void hamview_json_end_array(hamview_json_writer_t *w);
+void hamview_json_key(hamview_json_writer_t *w, const char *key);
+void hamview_json_string(hamview_json_writer_t *w, const char *value);
+void hamview_json_uint(hamview_json_writer_t *w, uint64_t value);
+void hamview_json_double(hamview_json_writer_t *w, double value);
+void hamview_json_bool(hamview_json_writer_t *w, bool value);
+void hamview_json_kv_string(hamview_json_writer_t *w, const char *key, const char *value);
+void hamview_json_kv_uint(hamview_json_writer_t *w, const char *key, uint64_t value);
+void hamview_json_kv_double(hamview_json_writer_t *w, const char *key, double value);
+void hamview_json_kv_bool(hamview_json_writer_t *w, const char *key, bool value);
+/* NUL-terminates and returns the length, or 0 if the output did not fit. */
+size_t hamview_json_finish(hamview_json_writer_t *w);
+
+/* Worst-case escaped size of a string field of n bytes, quotes included. */
+#define HAMVIEW_JSON_STRING_MAX(n) ((n) * 6 + 2)
+
+#define HAMVIEW_JSON_READER_KEY_MAX 32
+#define HAMVIEW_JSON_READER_TEXT_MAX 64
+
+typedef enum {
+    HAMVIEW_JSON_STRING,
+    HAMVIEW_JSON_NUMBER,
+    HAMVIEW_JSON_BOOL,
+    HAMVIEW_JSON_NULL,
+} hamview_json_type_t;
+
+typedef struct {
+    hamview_json_type_t type;
+    const char *text;   /* raw text, NUL-terminated; strings may be truncated */
+    double number;
+    bool boolean;
+} hamview_json_value_t;
+
+typedef struct hamview_json_reader hamview_json_reader_t;
+typedef void (*hamview_json_value_cb_t)(const hamview_json_reader_t *r, const hamview_json_value_t *value, void *ctx);
+
+/* Incremental push parser: feed the document in chunks of any size and get
+ * one callback per scalar value; containers are never materialised, so
+ * memory use is this struct regardless of document size. During a callback
+ * the value sits at nesting level depth - 1 and, for every open level L,
+ * key[L] is the member name (objects) and index[L] the element position
+ * (arrays). Keys longer than the key buffer are truncated. */
+struct hamview_json_reader {
+    hamview_json_value_cb_t on_value;
+    void *ctx;
+    uint8_t state;
+    uint8_t depth;
+    uint8_t escape;
+    bool in_key;
+    bool error;
+    uint16_t unicode;
+    size_t text_len;
+    char container[HAMVIEW_JSON_MAX_DEPTH];
+    uint32_t index[HAMVIEW_JSON_MAX_DEPTH];
+    char key[HAMVIEW_JSON_MAX_DEPTH][HAMVIEW_JSON_READER_KEY_MAX];
+    char text[HAMVIEW_JSON_READER_TEXT_MAX];
+};
+
+void hamview_json_reader_init(hamview_json_reader_t *r, hamview_json_value_cb_t on_value, void *ctx);
+/* Returns false once the input is malformed or nested deeper than
+ * HAMVIEW_JSON_MAX_DEPTH; later calls are then no-ops. */
+bool hamview_json_reader_feed(hamview_json_reader_t *r, const char *data, size_t len);
+/* True if exactly one complete value was read. */
+bool hamview_json_reader_finish(hamview_json_reader_t *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
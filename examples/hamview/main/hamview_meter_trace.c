@@ -0,0 +1,100 @@
+#include "hamview_meter_trace.h"
+
+#include <string.h>
+
+/* A column with no samples repeats the previous value while the last sample
+ * is this recent, so polling jitter does not punch holes in the 1-minute
+ * view. */
+#define METER_TRACE_HOLD_MS 1000
+
+void hamview_meter_trace_init(hamview_meter_trace_t *trace, uint32_t span_ms, uint16_t columns)
+{
+    if (!trace) {
+        return;
+    }
+    memset(trace, 0, sizeof(*trace));
+    trace->span_ms = span_ms ? span_ms : 1;
+    trace->columns = columns ? columns : 1;
+}
+
+static void close_column(hamview_meter_trace_t *trace, hamview_meter_column_cb_t cb, void *ctx)
+{
+    hamview_meter_column_t column = {0};
+    if (trace->count > 0) {
+        column.min = trace->min;
+        column.max = trace->max;
+        column.avg = (uint8_t)(trace->sum / trace->count);
+        column.valid = true;
+        trace->last_avg = column.avg;
+    } else if (trace->have_last && trace->start_ms - trace->last_sample_ms < METER_TRACE_HOLD_MS) {
+        column.min = trace->last_avg;
+        column.max = trace->last_avg;
+        column.avg = trace->last_avg;
+        column.valid = true;
+    }
+    column.retuned = trace->retuned;
+    if (cb) {
+        cb(&column, ctx);
+    }
+    trace->start_ms += trace->span_ms;
+    trace->sum = 0;
+    trace->count = 0;
+    trace->retuned = false;
+}
+
+/* Uptime in ms wraps after 49 days; differences stay correct as unsigned. */
+static void roll_to(hamview_meter_trace_t *trace, uint32_t t_ms, hamview_meter_column_cb_t cb, void *ctx)
+{
+    if (!trace->started) {
+        trace->started = true;
+        trace->start_ms = t_ms;
+        return;
+    }
+    uint32_t elapsed = t_ms - trace->start_ms;
+    if ((int32_t)elapsed < 0) {
+        return;
+    }
+    uint32_t closed = elapsed / trace->span_ms;
+    if (closed > trace->columns) {
+        /* The whole chart went stale; draw it empty and restart at t_ms. */
+        for (uint16_t i = 0; i < trace->columns; ++i) {
+            close_column(trace, cb, ctx);
+        }
+        trace->start_ms = t_ms;
+        return;
+    }
+    while (closed--) {
+        close_column(trace, cb, ctx);
+    }
+}
+
+void hamview_meter_trace_add(hamview_meter_trace_t *trace, uint32_t t_ms, uint32_t freq_hz, uint8_t s_meter,
+                             hamview_meter_column_cb_t cb, void *ctx)
+{
+    if (!trace) {
+        return;
+    }
+    roll_to(trace, t_ms, cb, ctx);
+    if (trace->count == 0 || s_meter < trace->min) {
+        trace->min = s_meter;
+    }
+    if (trace->count == 0 || s_meter > trace->max) {
+        trace->max = s_meter;
+    }
+    trace->sum += s_meter;
+    trace->count++;
+    if (trace->have_last && freq_hz != trace->freq_hz) {
+        trace->retuned = true;
+    }
+    trace->freq_hz = freq_hz;
+    trace->have_last = true;
+    trace->last_sample_ms = t_ms;
+}
+
+void hamview_meter_trace_advance(hamview_meter_trace_t *trace, uint32_t now_ms, hamview_meter_column_cb_t cb, void *ctx)
+{
+    if (!trace || !trace->started) {
+        return;
+    }
+    roll_to(trace, now_ms, cb, ctx);
+}
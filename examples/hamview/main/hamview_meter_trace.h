@@ -0,0 +1,55 @@
+#ifndef HAMVIEW_METER_TRACE_H
+#define HAMVIEW_METER_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* One strip-chart column: the S-meter range and mean over span_ms. */
+typedef struct {
+    uint8_t min;
+    uint8_t max;
+    uint8_t avg;
+    bool valid;   /* false when the radio was silent for the whole column */
+    bool retuned; /* the frequency changed within the column */
+} hamview_meter_column_t;
+
+typedef void (*hamview_meter_column_cb_t)(const hamview_meter_column_t *column, void *ctx);
+
+/* Downsamples CI-V samples into fixed-width time columns with min/max/avg,
+ * emitting each column once it closes. Constant memory regardless of the
+ * sample rate; one instance per chart resolution. */
+typedef struct {
+    uint32_t span_ms;
+    uint16_t columns;
+    bool started;
+    uint32_t start_ms;
+    uint32_t sum;
+    uint32_t count;
+    uint8_t min;
+    uint8_t max;
+    bool retuned;
+    uint32_t freq_hz;
+    bool have_last;
+    uint32_t last_sample_ms;
+    uint8_t last_avg;
+} hamview_meter_trace_t;
+
+/* columns is the chart width; longer gaps emit at most that many empty
+ * columns. */
+void hamview_meter_trace_init(hamview_meter_trace_t *trace, uint32_t span_ms, uint16_t columns);
+void hamview_meter_trace_add(hamview_meter_trace_t *trace, uint32_t t_ms, uint32_t freq_hz, uint8_t s_meter,
+                             hamview_meter_column_cb_t cb, void *ctx);
+/* Closes the columns that ended by now_ms, so the chart keeps moving while
+ * no samples arrive. */
+void hamview_meter_trace_advance(hamview_meter_trace_t *trace, uint32_t now_ms, hamview_meter_column_cb_t cb, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -8,6 +8,7 @@
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "lv_port.h"
 
 static const char *TAG = "hamview_screen";
 
@@ -151,6 +152,7 @@ static void screen_wake(void)
     set_backlight(true);
     s_sleeping = false;
     s_last_activity_us = esp_timer_get_time();
+    lv_port_notify();
 }
 
 static void screen_sleep(void)
@@ -160,6 +162,7 @@ static void screen_sleep(void)
     }
     set_backlight(false);
     s_sleeping = true;
+    lv_port_notify();
 }
 
 void hamview_screen_init(void)
@@ -232,6 +235,11 @@ void hamview_screen_timer_tick(void)
     }
 }
 
+bool hamview_screen_is_sleeping(void)
+{
+    return s_sleeping;
+}
+
 void hamview_screen_set_brightness(uint8_t percent)
 {
     if (percent > 100) {
@@ -1,6 +1,7 @@
 #ifndef HAMVIEW_SCREEN_H
 #define HAMVIEW_SCREEN_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "lvgl.h"
 
@@ -10,5 +11,6 @@ void hamview_screen_record_activity(void);
 void hamview_screen_handle_button(uint32_t key, lv_indev_state_t state);
 void hamview_screen_timer_tick(void);
 void hamview_screen_set_brightness(uint8_t percent);
+bool hamview_screen_is_sleeping(void);
 
 #endif
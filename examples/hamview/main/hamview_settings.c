@@ -1,341 +1,449 @@
 #include "hamview_settings.h"
 
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "esp_crc.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "nvs.h"
 #include "nvs_flash.h"
 
 static const char *TAG = "hamview_settings";
 static const char *NAMESPACE = "hamview";
-
-static hamview_settings_t s_settings;
-static bool s_loaded = false;
-
-static void ensure_defaults(void)
+static const char *BLOB_KEY = "settings";
+
+#define SETTINGS_BLOB_MAGIC 0x31535648u /* "HVS1" */
+/* Bump when a field changes meaning, size or position, and teach
+ * load_blob() to migrate the previous version. Appending fields to
+ * hamview_settings_t does not need a bump: shorter blobs load into the
+ * leading part of the struct and the rest keeps its defaults. */
+#define SETTINGS_BLOB_VERSION 1
+#define SETTINGS_SAVE_DEBOUNCE_MS 1500
+#define SETTINGS_RETRY_MS 5000
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t crc;
+} settings_blob_header_t;
+
+typedef struct {
+    settings_blob_header_t header;
+    hamview_settings_t settings;
+} settings_blob_t;
+
+typedef enum {
+    FIELD_STR,
+    FIELD_U16,
+    FIELD_U8,
+    FIELD_BOOL,
+} settings_field_type_t;
+
+typedef struct {
+    const char *legacy_key;
+    settings_field_type_t type;
+    size_t offset;
+    size_t size;
+} settings_field_t;
+
+#define FIELD(key, type, member) \
+    { key, type, offsetof(hamview_settings_t, member), sizeof(((hamview_settings_t *)0)->member) }
+
+/* Every member of hamview_settings_t, with the NVS key it used before the
+ * blob existed. */
+static const settings_field_t FIELDS[] = {
+    FIELD("username", FIELD_STR, username),
+    FIELD("password", FIELD_STR, password),
+    FIELD("filter_call", FIELD_STR, filter_callsign),
+    FIELD("filter_band", FIELD_STR, filter_band),
+    FIELD("weather_zip", FIELD_STR, weather_zip),
+    FIELD("icom_ip", FIELD_STR, icom_wifi_ip),
+    FIELD("icom_user", FIELD_STR, icom_wifi_user),
+    FIELD("icom_pass", FIELD_STR, icom_wifi_pass),
+    FIELD("icom_port", FIELD_U16, icom_wifi_port),
+    FIELD("icom_wifi_en", FIELD_BOOL, icom_wifi_enabled),
+    FIELD("spot_ttl", FIELD_U16, spot_ttl_minutes),
+    FIELD("spot_age_filter", FIELD_U16, spot_age_filter_minutes),
+    FIELD("screen_timeout", FIELD_U16, screen_timeout_minutes),
+    FIELD("alert_sound", FIELD_BOOL, alert_sound_enabled),
+    FIELD("screen_bright", FIELD_U8, screen_brightness_percent),
+    FIELD("alert_calls", FIELD_STR, alert_callsigns),
+    FIELD("alert_states", FIELD_STR, alert_states),
+    FIELD("alert_countries", FIELD_STR, alert_countries),
+};
+
+#define FIELD_COUNT (sizeof(FIELDS) / sizeof(FIELDS[0]))
+
+/* s_current is the published snapshot, never modified once stored there.
+ * Readers take no lock: each registers in the reader count of the current
+ * epoch while it uses the snapshot. A save swaps the pointer, flips the
+ * epoch and waits for the old epoch's readers to leave before freeing the
+ * snapshot they may still hold. s_mutex only serializes saves. */
+static _Atomic(hamview_settings_t *) s_current = NULL;
+static atomic_uint s_epoch = 0;
+static atomic_uint s_readers[2];
+static SemaphoreHandle_t s_mutex = NULL;
+static TaskHandle_t s_writer_task = NULL;
+
+/* Only touched by init and the writer task. */
+static settings_blob_t s_blob;
+static uint32_t s_stored_crc = 0;
+static bool s_stored_valid = false;
+
+static void ensure_defaults(hamview_settings_t *s)
 {
-    if (strlen(s_settings.filter_band) == 0) {
-        strlcpy(s_settings.filter_band, "", sizeof(s_settings.filter_band));
-    }
-    if (strlen(s_settings.filter_callsign) == 0) {
-        strlcpy(s_settings.filter_callsign, "", sizeof(s_settings.filter_callsign));
-    }
-    if (strlen(s_settings.weather_zip) == 0) {
-        strlcpy(s_settings.weather_zip, "", sizeof(s_settings.weather_zip));
+    if (s->icom_wifi_port == 0) {
+        s->icom_wifi_port = 50001;
     }
-    if (strlen(s_settings.icom_wifi_ip) == 0) {
-        strlcpy(s_settings.icom_wifi_ip, "", sizeof(s_settings.icom_wifi_ip));
+    if (s->spot_ttl_minutes == 0 || s->spot_ttl_minutes > 720) {
+        s->spot_ttl_minutes = 30;
     }
-    if (strlen(s_settings.icom_wifi_user) == 0) {
-        strlcpy(s_settings.icom_wifi_user, "", sizeof(s_settings.icom_wifi_user));
+    if (s->spot_age_filter_minutes > 720) {
+        s->spot_age_filter_minutes = 0;
     }
-    if (strlen(s_settings.icom_wifi_pass) == 0) {
-        strlcpy(s_settings.icom_wifi_pass, "", sizeof(s_settings.icom_wifi_pass));
+    if (s->screen_timeout_minutes > 720) {
+        s->screen_timeout_minutes = 0;
     }
-    if (s_settings.icom_wifi_port == 0) {
-        s_settings.icom_wifi_port = 50001;
+    if (s->screen_brightness_percent == 0 || s->screen_brightness_percent > 100) {
+        s->screen_brightness_percent = 100;
     }
-    if (strlen(s_settings.alert_callsigns) == 0) {
-        strlcpy(s_settings.alert_callsigns, "", sizeof(s_settings.alert_callsigns));
+}
+
+/* Copies field by field into a zeroed struct so padding and the bytes after
+ * each string terminator are always zero. Equal settings then compare and
+ * checksum equal byte for byte. */
+static void canonicalize(hamview_settings_t *dst, const hamview_settings_t *src)
+{
+    const uint8_t *in = (const uint8_t *)src;
+    uint8_t *out = (uint8_t *)dst;
+    memset(dst, 0, sizeof(*dst));
+    for (size_t i = 0; i < FIELD_COUNT; ++i) {
+        const settings_field_t *f = &FIELDS[i];
+        switch (f->type) {
+        case FIELD_STR:
+            strlcpy((char *)out + f->offset, (const char *)in + f->offset, f->size);
+            break;
+        case FIELD_BOOL:
+            *(bool *)(out + f->offset) = *(const bool *)(in + f->offset);
+            break;
+        default:
+            memcpy(out + f->offset, in + f->offset, f->size);
+            break;
+        }
+    }
+    ensure_defaults(dst);
+}
+
+static uint32_t settings_crc(const hamview_settings_t *s)
+{
+    return esp_crc32_le(0, (const uint8_t *)s, sizeof(*s));
+}
+
+static bool load_legacy(nvs_handle_t handle, hamview_settings_t *out)
+{
+    uint8_t *base = (uint8_t *)out;
+    bool found = false;
+    for (size_t i = 0; i < FIELD_COUNT; ++i) {
+        const settings_field_t *f = &FIELDS[i];
+        esp_err_t err;
+        switch (f->type) {
+        case FIELD_STR: {
+            size_t len = f->size;
+            err = nvs_get_str(handle, f->legacy_key, (char *)base + f->offset, &len);
+            if (err != ESP_OK) {
+                base[f->offset] = '\0';
+            }
+            break;
+        }
+        case FIELD_U16: {
+            uint16_t value = 0;
+            err = nvs_get_u16(handle, f->legacy_key, &value);
+            if (err == ESP_OK) {
+                memcpy(base + f->offset, &value, sizeof(value));
+            }
+            break;
+        }
+        default: {
+            uint8_t value = 0;
+            err = nvs_get_u8(handle, f->legacy_key, &value);
+            if (err == ESP_OK) {
+                if (f->type == FIELD_BOOL) {
+                    *(bool *)(base + f->offset) = value != 0;
+                } else {
+                    base[f->offset] = value;
+                }
+            }
+            break;
+        }
+        }
+        if (err == ESP_OK) {
+            found = true;
+        } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGW(TAG, "load %s failed: %s", f->legacy_key, esp_err_to_name(err));
+        }
+    }
+    return found;
+}
+
+static void erase_legacy(nvs_handle_t handle)
+{
+    for (size_t i = 0; i < FIELD_COUNT; ++i) {
+        esp_err_t err = nvs_erase_key(handle, FIELDS[i].legacy_key);
+        if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGW(TAG, "erase %s failed: %s", FIELDS[i].legacy_key, esp_err_to_name(err));
+        }
     }
-    if (strlen(s_settings.alert_states) == 0) {
-        strlcpy(s_settings.alert_states, "", sizeof(s_settings.alert_states));
+    nvs_commit(handle);
+}
+
+/* Returns true when out holds settings from a valid blob. *stale is set
+ * when the blob should be rewritten because its size differs from ours.
+ * Blobs from a newer build of the same version may be longer than our
+ * struct; their prefix is still ours. A blob of any other version is
+ * rejected rather than copied into members that moved. */
+static bool load_blob(nvs_handle_t handle, hamview_settings_t *out, bool *stale)
+{
+    size_t len = 0;
+    esp_err_t err = nvs_get_blob(handle, BLOB_KEY, NULL, &len);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return false;
     }
-    if (strlen(s_settings.alert_countries) == 0) {
-        strlcpy(s_settings.alert_countries, "", sizeof(s_settings.alert_countries));
+    if (err != ESP_OK || len < sizeof(settings_blob_header_t)) {
+        ESP_LOGW(TAG, "load settings blob failed: %s", esp_err_to_name(err));
+        return false;
     }
-    if (s_settings.spot_ttl_minutes == 0 || s_settings.spot_ttl_minutes > 720) {
-        s_settings.spot_ttl_minutes = 30;
+    uint8_t *buf = malloc(len);
+    if (!buf) {
+        return false;
     }
-    if (s_settings.spot_age_filter_minutes > 720) {
-        s_settings.spot_age_filter_minutes = 0;
+    bool ok = false;
+    err = nvs_get_blob(handle, BLOB_KEY, buf, &len);
+    if (err == ESP_OK) {
+        settings_blob_header_t header;
+        memcpy(&header, buf, sizeof(header));
+        size_t payload = len - sizeof(header);
+        const uint8_t *body = buf + sizeof(header);
+        if (header.magic != SETTINGS_BLOB_MAGIC || header.size != payload ||
+            esp_crc32_le(0, body, payload) != header.crc) {
+            ESP_LOGW(TAG, "settings blob failed header/CRC check; ignoring");
+        } else if (header.version != SETTINGS_BLOB_VERSION) {
+            ESP_LOGW(TAG, "settings blob v%u has no migration to v%d; ignoring",
+                     (unsigned)header.version, SETTINGS_BLOB_VERSION);
+        } else {
+            memcpy(out, body, payload < sizeof(*out) ? payload : sizeof(*out));
+            *stale = payload != sizeof(*out);
+            ok = true;
+        }
+    } else {
+        ESP_LOGW(TAG, "load settings blob failed: %s", esp_err_to_name(err));
     }
-    if (s_settings.screen_timeout_minutes > 720) {
-        s_settings.screen_timeout_minutes = 0;
+    free(buf);
+    return ok;
+}
+
+static esp_err_t store_blob(nvs_handle_t handle)
+{
+    uint32_t crc = settings_crc(&s_blob.settings);
+    if (s_stored_valid && crc == s_stored_crc) {
+        return ESP_OK;
+    }
+    s_blob.header.magic = SETTINGS_BLOB_MAGIC;
+    s_blob.header.version = SETTINGS_BLOB_VERSION;
+    s_blob.header.size = sizeof(s_blob.settings);
+    s_blob.header.crc = crc;
+    esp_err_t err = nvs_set_blob(handle, BLOB_KEY, &s_blob, sizeof(s_blob));
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
     }
-    if (s_settings.screen_brightness_percent == 0 || s_settings.screen_brightness_percent > 100) {
-        s_settings.screen_brightness_percent = 100;
+    if (err == ESP_OK) {
+        s_stored_crc = crc;
+        s_stored_valid = true;
+        ESP_LOGI(TAG, "settings stored (%u bytes)", (unsigned)sizeof(s_blob));
+    } else {
+        ESP_LOGE(TAG, "nvs save failed: %s", esp_err_to_name(err));
     }
+    return err;
 }
 
-esp_err_t hamview_settings_init(void)
+static esp_err_t flush_current(void)
 {
-    memset(&s_settings, 0, sizeof(s_settings));
-    s_settings.alert_sound_enabled = false;
-    s_settings.screen_brightness_percent = 100;
+    hamview_settings_get(&s_blob.settings);
 
+    if (s_stored_valid && settings_crc(&s_blob.settings) == s_stored_crc) {
+        return ESP_OK;
+    }
     nvs_handle_t handle;
     esp_err_t err = nvs_open(NAMESPACE, NVS_READWRITE, &handle);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "nvs_open failed: %s", esp_err_to_name(err));
         return err;
     }
-
-    size_t len = sizeof(s_settings.username);
-    err = nvs_get_str(handle, "username", s_settings.username, &len);
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.username[0] = '\0';
-        err = ESP_OK;
-    } else if (err != ESP_OK) {
-        ESP_LOGW(TAG, "load username failed: %s", esp_err_to_name(err));
-        s_settings.username[0] = '\0';
-        err = ESP_OK;
-    }
-
-    len = sizeof(s_settings.password);
-    esp_err_t err_pass = nvs_get_str(handle, "password", s_settings.password, &len);
-    if (err_pass == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.password[0] = '\0';
-    } else if (err_pass != ESP_OK) {
-        ESP_LOGW(TAG, "load password failed: %s", esp_err_to_name(err_pass));
-        s_settings.password[0] = '\0';
-    }
-
-    len = sizeof(s_settings.filter_callsign);
-    esp_err_t err_call = nvs_get_str(handle, "filter_call", s_settings.filter_callsign, &len);
-    if (err_call == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.filter_callsign[0] = '\0';
-    } else if (err_call != ESP_OK) {
-        ESP_LOGW(TAG, "load filter_call failed: %s", esp_err_to_name(err_call));
-        s_settings.filter_callsign[0] = '\0';
-    }
-
-    len = sizeof(s_settings.filter_band);
-    esp_err_t err_band = nvs_get_str(handle, "filter_band", s_settings.filter_band, &len);
-    if (err_band == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.filter_band[0] = '\0';
-    } else if (err_band != ESP_OK) {
-        ESP_LOGW(TAG, "load filter_band failed: %s", esp_err_to_name(err_band));
-        s_settings.filter_band[0] = '\0';
-    }
-
-    len = sizeof(s_settings.weather_zip);
-    esp_err_t err_zip = nvs_get_str(handle, "weather_zip", s_settings.weather_zip, &len);
-    if (err_zip == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.weather_zip[0] = '\0';
-    } else if (err_zip != ESP_OK) {
-        ESP_LOGW(TAG, "load weather_zip failed: %s", esp_err_to_name(err_zip));
-        s_settings.weather_zip[0] = '\0';
-    }
-
-    len = sizeof(s_settings.icom_wifi_ip);
-    esp_err_t err_icom_ip = nvs_get_str(handle, "icom_ip", s_settings.icom_wifi_ip, &len);
-    if (err_icom_ip == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.icom_wifi_ip[0] = '\0';
-    } else if (err_icom_ip != ESP_OK) {
-        ESP_LOGW(TAG, "load icom_ip failed: %s", esp_err_to_name(err_icom_ip));
-        s_settings.icom_wifi_ip[0] = '\0';
-    }
-
-    len = sizeof(s_settings.icom_wifi_user);
-    esp_err_t err_icom_user = nvs_get_str(handle, "icom_user", s_settings.icom_wifi_user, &len);
-    if (err_icom_user == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.icom_wifi_user[0] = '\0';
-    } else if (err_icom_user != ESP_OK) {
-        ESP_LOGW(TAG, "load icom_user failed: %s", esp_err_to_name(err_icom_user));
-        s_settings.icom_wifi_user[0] = '\0';
-    }
-
-    len = sizeof(s_settings.icom_wifi_pass);
-    esp_err_t err_icom_pass = nvs_get_str(handle, "icom_pass", s_settings.icom_wifi_pass, &len);
-    if (err_icom_pass == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.icom_wifi_pass[0] = '\0';
-    } else if (err_icom_pass != ESP_OK) {
-        ESP_LOGW(TAG, "load icom_pass failed: %s", esp_err_to_name(err_icom_pass));
-        s_settings.icom_wifi_pass[0] = '\0';
-    }
-
-    uint16_t icom_port = 0;
-    esp_err_t err_icom_port = nvs_get_u16(handle, "icom_port", &icom_port);
-    if (err_icom_port == ESP_OK) {
-        s_settings.icom_wifi_port = icom_port;
-    } else if (err_icom_port == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.icom_wifi_port = 0;
-    } else {
-        ESP_LOGW(TAG, "load icom_port failed: %s", esp_err_to_name(err_icom_port));
-        s_settings.icom_wifi_port = 0;
-    }
-
-    uint8_t icom_wifi_en = s_settings.icom_wifi_enabled ? 1 : 0;
-    esp_err_t err_icom_en = nvs_get_u8(handle, "icom_wifi_en", &icom_wifi_en);
-    if (err_icom_en == ESP_OK) {
-        s_settings.icom_wifi_enabled = icom_wifi_en != 0;
-    } else if (err_icom_en != ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGW(TAG, "load icom_wifi_en failed: %s", esp_err_to_name(err_icom_en));
-        s_settings.icom_wifi_enabled = false;
-    }
-
-    uint8_t alert_sound = s_settings.alert_sound_enabled ? 1 : 0;
-    esp_err_t err_sound = nvs_get_u8(handle, "alert_sound", &alert_sound);
-    if (err_sound == ESP_OK) {
-        s_settings.alert_sound_enabled = false;
-    } else if (err_sound != ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGW(TAG, "load alert_sound failed: %s", esp_err_to_name(err_sound));
-    }
-
-    uint8_t brightness = s_settings.screen_brightness_percent;
-    esp_err_t err_bright = nvs_get_u8(handle, "screen_bright", &brightness);
-    if (err_bright == ESP_OK) {
-        s_settings.screen_brightness_percent = brightness;
-    } else if (err_bright != ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGW(TAG, "load screen_bright failed: %s", esp_err_to_name(err_bright));
-    }
-
-    size_t len_alert = sizeof(s_settings.alert_callsigns);
-    esp_err_t err_calls = nvs_get_str(handle, "alert_calls", s_settings.alert_callsigns, &len_alert);
-    if (err_calls == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.alert_callsigns[0] = '\0';
-    } else if (err_calls != ESP_OK) {
-        ESP_LOGW(TAG, "load alert_calls failed: %s", esp_err_to_name(err_calls));
-        s_settings.alert_callsigns[0] = '\0';
-    }
-
-    len_alert = sizeof(s_settings.alert_states);
-    esp_err_t err_states = nvs_get_str(handle, "alert_states", s_settings.alert_states, &len_alert);
-    if (err_states == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.alert_states[0] = '\0';
-    } else if (err_states != ESP_OK) {
-        ESP_LOGW(TAG, "load alert_states failed: %s", esp_err_to_name(err_states));
-        s_settings.alert_states[0] = '\0';
-    }
-
-    len_alert = sizeof(s_settings.alert_countries);
-    esp_err_t err_countries = nvs_get_str(handle, "alert_countries", s_settings.alert_countries, &len_alert);
-    if (err_countries == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.alert_countries[0] = '\0';
-    } else if (err_countries != ESP_OK) {
-        ESP_LOGW(TAG, "load alert_countries failed: %s", esp_err_to_name(err_countries));
-        s_settings.alert_countries[0] = '\0';
-    }
-
-    uint16_t spot_ttl = 0;
-    esp_err_t err_ttl = nvs_get_u16(handle, "spot_ttl", &spot_ttl);
-    if (err_ttl == ESP_OK) {
-        s_settings.spot_ttl_minutes = spot_ttl;
-    } else if (err_ttl == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.spot_ttl_minutes = 0;
-    } else {
-        ESP_LOGW(TAG, "load spot_ttl failed: %s", esp_err_to_name(err_ttl));
-        s_settings.spot_ttl_minutes = 0;
-    }
-
-    uint16_t spot_age = 0;
-    esp_err_t err_age = nvs_get_u16(handle, "spot_age_filter", &spot_age);
-    if (err_age == ESP_OK) {
-        s_settings.spot_age_filter_minutes = spot_age;
-    } else if (err_age == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.spot_age_filter_minutes = 0;
-    } else {
-        ESP_LOGW(TAG, "load spot_age_filter failed: %s", esp_err_to_name(err_age));
-        s_settings.spot_age_filter_minutes = 0;
-    }
-
-    uint16_t screen_timeout = 0;
-    esp_err_t err_screen = nvs_get_u16(handle, "screen_timeout", &screen_timeout);
-    if (err_screen == ESP_OK) {
-        s_settings.screen_timeout_minutes = screen_timeout;
-    } else if (err_screen == ESP_ERR_NVS_NOT_FOUND) {
-        s_settings.screen_timeout_minutes = 0;
-    } else {
-        ESP_LOGW(TAG, "load screen_timeout failed: %s", esp_err_to_name(err_screen));
-        s_settings.screen_timeout_minutes = 0;
-    }
-
+    err = store_blob(handle);
     nvs_close(handle);
-    ensure_defaults();
-    s_loaded = true;
-    ESP_LOGI(TAG, "settings loaded (user=%s)", s_settings.username);
     return err;
 }
 
-void hamview_settings_get(hamview_settings_t *out)
+/* Waits for a save, lets further saves within the debounce window fold into
+ * it, then writes the newest snapshot. Keeps NVS writes off the LVGL task. */
+static void settings_writer_task(void *arg)
 {
-    if (!s_loaded) {
-        hamview_settings_init();
-    }
-    if (out) {
-        *out = s_settings;
+    (void)arg;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SETTINGS_SAVE_DEBOUNCE_MS)) > 0) {
+        }
+        while (flush_current() != ESP_OK) {
+            vTaskDelay(pdMS_TO_TICKS(SETTINGS_RETRY_MS));
+        }
     }
 }
 
-esp_err_t hamview_settings_save(const hamview_settings_t *settings)
+/* Returns false, keeping the current snapshot, when next holds the same
+ * settings. Only saves free snapshots, so previous is safe to compare
+ * while s_mutex is held. */
+static bool publish(hamview_settings_t *next)
 {
-    if (!settings) {
-        return ESP_ERR_INVALID_ARG;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    hamview_settings_t *previous = atomic_load(&s_current);
+    if (previous && memcmp(previous, next, sizeof(*next)) == 0) {
+        xSemaphoreGive(s_mutex);
+        return false;
+    }
+    atomic_store(&s_current, next);
+    unsigned old_epoch = atomic_fetch_xor(&s_epoch, 1) & 1;
+    while (atomic_load(&s_readers[old_epoch]) != 0) {
+        vTaskDelay(1);
+    }
+    xSemaphoreGive(s_mutex);
+    free(previous);
+    return true;
+}
+
+esp_err_t hamview_settings_init(void)
+{
+    if (atomic_load(&s_current)) {
+        return ESP_OK;
+    }
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    hamview_settings_t *loaded = calloc(1, sizeof(*loaded));
+    if (!loaded) {
+        return ESP_ERR_NO_MEM;
     }
 
     nvs_handle_t handle;
     esp_err_t err = nvs_open(NAMESPACE, NVS_READWRITE, &handle);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "nvs_open failed: %s", esp_err_to_name(err));
+        free(loaded);
         return err;
     }
 
-    err = nvs_set_str(handle, "username", settings->username);
-    if (err != ESP_OK) goto done;
-
-    err = nvs_set_str(handle, "password", settings->password);
-    if (err != ESP_OK) goto done;
-
-    err = nvs_set_str(handle, "filter_call", settings->filter_callsign);
-    if (err != ESP_OK) goto done;
-
-    err = nvs_set_str(handle, "filter_band", settings->filter_band);
-    if (err != ESP_OK) goto done;
-
-    err = nvs_set_str(handle, "weather_zip", settings->weather_zip);
-    if (err != ESP_OK) goto done;
-
-    err = nvs_set_str(handle, "icom_ip", settings->icom_wifi_ip);
-    if (err != ESP_OK) goto done;
-
-    err = nvs_set_str(handle, "icom_user", settings->icom_wifi_user);
-    if (err != ESP_OK) goto done;
-
-    err = nvs_set_str(handle, "icom_pass", settings->icom_wifi_pass);
-    if (err != ESP_OK) goto done;
-
-    err = nvs_set_u16(handle, "icom_port", settings->icom_wifi_port);
-    if (err != ESP_OK) goto done;
-
-    err = nvs_set_u8(handle, "icom_wifi_en", settings->icom_wifi_enabled ? 1 : 0);
-    if (err != ESP_OK) goto done;
-
-    err = nvs_set_u16(handle, "spot_ttl", settings->spot_ttl_minutes);
-    if (err != ESP_OK) goto done;
-
-    err = nvs_set_u16(handle, "spot_age_filter", settings->spot_age_filter_minutes);
-    if (err != ESP_OK) goto done;
+    hamview_settings_t raw = { 0 };
+    bool stale = false;
+    bool migrated = false;
+    if (load_blob(handle, &raw, &stale)) {
+        canonicalize(loaded, &raw);
+        if (!stale) {
+            s_stored_crc = settings_crc(loaded);
+            s_stored_valid = true;
+        }
+    } else {
+        migrated = load_legacy(handle, &raw);
+        canonicalize(loaded, &raw);
+    }
 
-    err = nvs_set_u16(handle, "screen_timeout", settings->screen_timeout_minutes);
-    if (err != ESP_OK) goto done;
+    /* Boot runs before the UI, so rewriting inline here is fine. */
+    memcpy(&s_blob.settings, loaded, sizeof(s_blob.settings));
+    if (store_blob(handle) == ESP_OK && migrated) {
+        erase_legacy(handle);
+        ESP_LOGI(TAG, "migrated legacy settings keys to blob v%d", SETTINGS_BLOB_VERSION);
+    }
+    nvs_close(handle);
 
-    err = nvs_set_u8(handle, "alert_sound", settings->alert_sound_enabled ? 1 : 0);
-    if (err != ESP_OK) goto done;
+    /* The alert sound is stored like any other field, but every boot starts
+     * with it off, from the blob and from the legacy keys alike; it has
+     * always had to be switched on again in each session. */
+    loaded->alert_sound_enabled = false;
 
-    err = nvs_set_u8(handle, "screen_bright", settings->screen_brightness_percent);
-    if (err != ESP_OK) goto done;
+    atomic_store(&s_current, loaded);
+    if (!s_writer_task) {
+        xTaskCreatePinnedToCore(settings_writer_task, "hamview_cfg", 3072, NULL, 2, &s_writer_task, tskNO_AFFINITY);
+    }
+    ESP_LOGI(TAG, "settings loaded (user=%s)", loaded->username);
+    return ESP_OK;
+}
 
-    err = nvs_set_str(handle, "alert_calls", settings->alert_callsigns);
-    if (err != ESP_OK) goto done;
+const hamview_settings_t *hamview_settings_acquire(unsigned *epoch)
+{
+    if (!atomic_load(&s_current)) {
+        hamview_settings_init();
+    }
+    while (true) {
+        unsigned e = atomic_load(&s_epoch) & 1;
+        atomic_fetch_add(&s_readers[e], 1);
+        /* Counted in an epoch a save has already flipped away from: the
+         * save may have stopped waiting for it. Retry in the new one. */
+        if ((atomic_load(&s_epoch) & 1) == e) {
+            *epoch = e;
+            return atomic_load(&s_current);
+        }
+        atomic_fetch_sub(&s_readers[e], 1);
+    }
+}
 
-    err = nvs_set_str(handle, "alert_states", settings->alert_states);
-    if (err != ESP_OK) goto done;
+void hamview_settings_release(unsigned epoch)
+{
+    atomic_fetch_sub(&s_readers[epoch], 1);
+}
 
-    err = nvs_set_str(handle, "alert_countries", settings->alert_countries);
-    if (err != ESP_OK) goto done;
+void hamview_settings_get(hamview_settings_t *out)
+{
+    if (!out) {
+        return;
+    }
+    unsigned epoch;
+    const hamview_settings_t *current = hamview_settings_acquire(&epoch);
+    if (current) {
+        *out = *current;
+    }
+    hamview_settings_release(epoch);
+}
 
-    err = nvs_commit(handle);
-    if (err == ESP_OK) {
-        s_settings = *settings;
-        ensure_defaults();
-        s_loaded = true;
+esp_err_t hamview_settings_save(const hamview_settings_t *settings)
+{
+    if (!settings) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    hamview_settings_t *next = malloc(sizeof(*next));
+    if (!next) {
+        return ESP_ERR_NO_MEM;
     }
+    canonicalize(next, settings);
 
- done:
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "nvs save failed: %s", esp_err_to_name(err));
+    if (!atomic_load(&s_current)) {
+        esp_err_t err = hamview_settings_init();
+        if (err != ESP_OK) {
+            free(next);
+            return err;
+        }
     }
-    nvs_close(handle);
-    return err;
+    if (!publish(next)) {
+        free(next);
+        return ESP_OK;
+    }
+    if (s_writer_task) {
+        xTaskNotifyGive(s_writer_task);
+    }
+    return ESP_OK;
 }
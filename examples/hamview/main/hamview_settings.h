@@ -25,13 +25,28 @@ typedef struct {
     uint16_t screen_timeout_minutes;
     bool alert_sound_enabled;
     uint8_t screen_brightness_percent;
-    char alert_callsigns[128];
+    char alert_callsigns[1024];
     char alert_states[128];
     char alert_countries[128];
 } hamview_settings_t;
 
+/* Loads the settings blob, migrating the legacy per-field NVS keys on first
+ * boot after an upgrade. */
 esp_err_t hamview_settings_init(void);
+
+/* Lock-free pointer to the current immutable settings snapshot, or NULL if
+ * the settings cannot be loaded. It stays valid until the matching
+ * hamview_settings_release(epoch), which must follow every call, also one
+ * that returned NULL, and soon: a save waits for it. */
+const hamview_settings_t *hamview_settings_acquire(unsigned *epoch);
+void hamview_settings_release(unsigned epoch);
+
+/* Copies the current settings snapshot. */
 void hamview_settings_get(hamview_settings_t *out);
+
+/* Publishes a new snapshot immediately when anything changed. The flash
+ * write happens on a background task, debounced, so rapid saves cost one
+ * NVS write and the caller never blocks on flash. */
 esp_err_t hamview_settings_save(const hamview_settings_t *settings);
 
 #ifdef __cplusplus
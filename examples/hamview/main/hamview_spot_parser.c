@@ -0,0 +1,556 @@
+#include "hamview_spot_parser.h"
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define PARSER_MAX_DEPTH 32
+#define PARSER_KEY_MAX 16
+
+typedef enum {
+    FIELD_CALLSIGN = 0,
+    FIELD_FREQUENCY,
+    FIELD_MODE,
+    FIELD_SPOTTER,
+    FIELD_TIME,
+    FIELD_DXCC,
+    FIELD_STATE,
+    FIELD_COUNTRY,
+    FIELD_CONTINENT,
+    FIELD_COMMENT,
+    FIELD_COUNT,
+    FIELD_NONE = 0xFF,
+} spot_field_t;
+
+/* Primary keys win over their fallback aliases regardless of the order in
+ * which they appear, matching the old cJSON lookups. */
+#define RANK_FALLBACK 1
+#define RANK_PRIMARY 2
+
+typedef struct {
+    const char *key;
+    uint8_t field;
+    uint8_t rank;
+    uint8_t alt_field;
+    uint8_t alt_rank;
+} key_map_t;
+
+static const key_map_t KEY_MAP[] = {
+    {"callsign", FIELD_CALLSIGN, RANK_PRIMARY, FIELD_NONE, 0},
+    {"dx", FIELD_CALLSIGN, RANK_FALLBACK, FIELD_NONE, 0},
+    {"frequency", FIELD_FREQUENCY, RANK_PRIMARY, FIELD_NONE, 0},
+    {"freq", FIELD_FREQUENCY, RANK_FALLBACK, FIELD_NONE, 0},
+    {"mode", FIELD_MODE, RANK_PRIMARY, FIELD_NONE, 0},
+    {"spotter", FIELD_SPOTTER, RANK_PRIMARY, FIELD_NONE, 0},
+    {"de", FIELD_SPOTTER, RANK_FALLBACK, FIELD_NONE, 0},
+    {"time", FIELD_TIME, RANK_PRIMARY, FIELD_NONE, 0},
+    {"dxcc", FIELD_DXCC, RANK_PRIMARY, FIELD_COUNTRY, RANK_FALLBACK},
+    {"country", FIELD_COUNTRY, RANK_PRIMARY, FIELD_DXCC, RANK_FALLBACK},
+    {"state", FIELD_STATE, RANK_PRIMARY, FIELD_NONE, 0},
+    {"us_state", FIELD_STATE, RANK_FALLBACK, FIELD_NONE, 0},
+    {"continent", FIELD_CONTINENT, RANK_PRIMARY, FIELD_NONE, 0},
+    {"cont", FIELD_CONTINENT, RANK_FALLBACK, FIELD_NONE, 0},
+    {"comment", FIELD_COMMENT, RANK_PRIMARY, FIELD_NONE, 0},
+    {"comments", FIELD_COMMENT, RANK_FALLBACK, FIELD_NONE, 0},
+};
+
+typedef struct {
+    hamview_spot_t spot;
+    uint8_t rank[FIELD_COUNT];
+} spot_builder_t;
+
+typedef struct {
+    const char *p;
+    const char *end;
+    unsigned depth;
+    hamview_spot_parser_cb_t cb;
+    void *ctx;
+    int emitted;
+} parser_t;
+
+static bool parse_spot_array(parser_t *ps);
+
+static char *field_ptr(hamview_spot_t *spot, uint8_t field, size_t *len)
+{
+    switch (field) {
+    case FIELD_CALLSIGN: *len = sizeof(spot->callsign); return spot->callsign;
+    case FIELD_FREQUENCY: *len = sizeof(spot->frequency); return spot->frequency;
+    case FIELD_MODE: *len = sizeof(spot->mode); return spot->mode;
+    case FIELD_SPOTTER: *len = sizeof(spot->spotter); return spot->spotter;
+    case FIELD_TIME: *len = sizeof(spot->time_utc); return spot->time_utc;
+    case FIELD_DXCC: *len = sizeof(spot->dxcc); return spot->dxcc;
+    case FIELD_STATE: *len = sizeof(spot->state); return spot->state;
+    case FIELD_COUNTRY: *len = sizeof(spot->country); return spot->country;
+    case FIELD_CONTINENT: *len = sizeof(spot->continent); return spot->continent;
+    case FIELD_COMMENT: *len = sizeof(spot->comment); return spot->comment;
+    default: *len = 0; return NULL;
+    }
+}
+
+static const key_map_t *lookup_key(const char *key)
+{
+    for (size_t i = 0; i < sizeof(KEY_MAP) / sizeof(KEY_MAP[0]); ++i) {
+        if (strcmp(KEY_MAP[i].key, key) == 0) {
+            return &KEY_MAP[i];
+        }
+    }
+    return NULL;
+}
+
+static void skip_ws(parser_t *ps)
+{
+    while (ps->p < ps->end && (*ps->p == ' ' || *ps->p == '\t' || *ps->p == '\r' || *ps->p == '\n')) {
+        ps->p++;
+    }
+}
+
+static bool peek(parser_t *ps, char c)
+{
+    return ps->p < ps->end && *ps->p == c;
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool parse_hex4(parser_t *ps, uint32_t *out)
+{
+    if (ps->end - ps->p < 4) {
+        return false;
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        int digit = hex_value(ps->p[i]);
+        if (digit < 0) {
+            return false;
+        }
+        value = (value << 4) | (uint32_t)digit;
+    }
+    ps->p += 4;
+    *out = value;
+    return true;
+}
+
+/* Appends one byte, silently truncating like strlcpy; *overflow records that
+ * something was dropped. */
+static void put_byte(char *dst, size_t dst_len, size_t *pos, bool *overflow, char c)
+{
+    if (!dst) {
+        return;
+    }
+    if (*pos + 1 < dst_len) {
+        dst[(*pos)++] = c;
+    } else {
+        *overflow = true;
+    }
+}
+
+static bool put_codepoint(char *dst, size_t dst_len, size_t *pos, bool *overflow, uint32_t cp)
+{
+    if (cp == 0) {
+        return false;
+    }
+    if (cp < 0x80) {
+        put_byte(dst, dst_len, pos, overflow, (char)cp);
+    } else if (cp < 0x800) {
+        put_byte(dst, dst_len, pos, overflow, (char)(0xC0 | (cp >> 6)));
+        put_byte(dst, dst_len, pos, overflow, (char)(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        put_byte(dst, dst_len, pos, overflow, (char)(0xE0 | (cp >> 12)));
+        put_byte(dst, dst_len, pos, overflow, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        put_byte(dst, dst_len, pos, overflow, (char)(0x80 | (cp & 0x3F)));
+    } else {
+        put_byte(dst, dst_len, pos, overflow, (char)(0xF0 | (cp >> 18)));
+        put_byte(dst, dst_len, pos, overflow, (char)(0x80 | ((cp >> 12) & 0x3F)));
+        put_byte(dst, dst_len, pos, overflow, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        put_byte(dst, dst_len, pos, overflow, (char)(0x80 | (cp & 0x3F)));
+    }
+    return true;
+}
+
+/* Decodes a JSON string at ps->p into dst (or just validates it when dst is
+ * NULL). The output is always NUL-terminated when dst_len > 0. */
+static bool parse_string(parser_t *ps, char *dst, size_t dst_len, bool *overflow)
+{
+    size_t pos = 0;
+    bool dropped = false;
+    if (!peek(ps, '"')) {
+        return false;
+    }
+    ps->p++;
+    while (ps->p < ps->end) {
+        char c = *ps->p++;
+        if (c == '"') {
+            if (dst && dst_len > 0) {
+                dst[pos] = '\0';
+            }
+            if (overflow) {
+                *overflow = dropped;
+            }
+            return true;
+        }
+        if ((unsigned char)c < 0x20) {
+            return false;
+        }
+        if (c != '\\') {
+            put_byte(dst, dst_len, &pos, &dropped, c);
+            continue;
+        }
+        if (ps->p >= ps->end) {
+            return false;
+        }
+        char esc = *ps->p++;
+        switch (esc) {
+        case '"': put_byte(dst, dst_len, &pos, &dropped, '"'); break;
+        case '\\': put_byte(dst, dst_len, &pos, &dropped, '\\'); break;
+        case '/': put_byte(dst, dst_len, &pos, &dropped, '/'); break;
+        case 'b': put_byte(dst, dst_len, &pos, &dropped, '\b'); break;
+        case 'f': put_byte(dst, dst_len, &pos, &dropped, '\f'); break;
+        case 'n': put_byte(dst, dst_len, &pos, &dropped, '\n'); break;
+        case 'r': put_byte(dst, dst_len, &pos, &dropped, '\r'); break;
+        case 't': put_byte(dst, dst_len, &pos, &dropped, '\t'); break;
+        case 'u': {
+            uint32_t cp = 0;
+            if (!parse_hex4(ps, &cp)) {
+                return false;
+            }
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+                uint32_t low = 0;
+                if (ps->end - ps->p < 6 || ps->p[0] != '\\' || ps->p[1] != 'u') {
+                    return false;
+                }
+                ps->p += 2;
+                if (!parse_hex4(ps, &low) || low < 0xDC00 || low > 0xDFFF) {
+                    return false;
+                }
+                cp = 0x10000 + (((cp & 0x3FF) << 10) | (low & 0x3FF));
+            } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                return false;
+            }
+            if (!put_codepoint(dst, dst_len, &pos, &dropped, cp)) {
+                return false;
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+static bool skip_number(parser_t *ps)
+{
+    const char *start = ps->p;
+    if (peek(ps, '-')) ps->p++;
+    if (!(ps->p < ps->end && isdigit((unsigned char)*ps->p))) {
+        return false;
+    }
+    while (ps->p < ps->end && isdigit((unsigned char)*ps->p)) ps->p++;
+    if (peek(ps, '.')) {
+        ps->p++;
+        if (!(ps->p < ps->end && isdigit((unsigned char)*ps->p))) return false;
+        while (ps->p < ps->end && isdigit((unsigned char)*ps->p)) ps->p++;
+    }
+    if (peek(ps, 'e') || peek(ps, 'E')) {
+        ps->p++;
+        if (peek(ps, '+') || peek(ps, '-')) ps->p++;
+        if (!(ps->p < ps->end && isdigit((unsigned char)*ps->p))) return false;
+        while (ps->p < ps->end && isdigit((unsigned char)*ps->p)) ps->p++;
+    }
+    return ps->p > start;
+}
+
+static bool skip_literal(parser_t *ps, const char *word)
+{
+    size_t len = strlen(word);
+    if ((size_t)(ps->end - ps->p) < len || memcmp(ps->p, word, len) != 0) {
+        return false;
+    }
+    ps->p += len;
+    return true;
+}
+
+static bool skip_value(parser_t *ps)
+{
+    skip_ws(ps);
+    if (ps->p >= ps->end) {
+        return false;
+    }
+    char c = *ps->p;
+    if (c == '"') {
+        return parse_string(ps, NULL, 0, NULL);
+    }
+    if (c == '{' || c == '[') {
+        char close = (c == '{') ? '}' : ']';
+        if (++ps->depth > PARSER_MAX_DEPTH) {
+            return false;
+        }
+        ps->p++;
+        skip_ws(ps);
+        if (peek(ps, close)) {
+            ps->p++;
+            ps->depth--;
+            return true;
+        }
+        while (true) {
+            if (c == '{') {
+                skip_ws(ps);
+                if (!parse_string(ps, NULL, 0, NULL)) return false;
+                skip_ws(ps);
+                if (!peek(ps, ':')) return false;
+                ps->p++;
+            }
+            if (!skip_value(ps)) return false;
+            skip_ws(ps);
+            if (peek(ps, ',')) {
+                ps->p++;
+                continue;
+            }
+            if (peek(ps, close)) {
+                ps->p++;
+                ps->depth--;
+                return true;
+            }
+            return false;
+        }
+    }
+    if (c == 't') return skip_literal(ps, "true");
+    if (c == 'f') return skip_literal(ps, "false");
+    if (c == 'n') return skip_literal(ps, "null");
+    return skip_number(ps);
+}
+
+/* Rewrites a numeric frequency in kHz with three decimals ("14074.5" ->
+ * "14074.500", i.e. Hz resolution) using integer arithmetic; the unit is
+ * kept as received, nothing is scaled. Returns false for anything that is
+ * not a plain positive decimal so the caller can fall back to strtod. */
+static bool normalize_frequency_fixed(char *text, size_t text_len)
+{
+    const char *p = text;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p == '+') p++;
+    uint64_t whole = 0;
+    int whole_digits = 0;
+    while (isdigit((unsigned char)*p)) {
+        if (++whole_digits > 12) return false;
+        whole = whole * 10 + (uint64_t)(*p++ - '0');
+    }
+    uint32_t frac = 0;
+    int frac_digits = 0;
+    bool round_up = false;
+    if (*p == '.') {
+        p++;
+        while (isdigit((unsigned char)*p)) {
+            if (frac_digits < 3) {
+                frac = frac * 10 + (uint32_t)(*p - '0');
+            } else if (frac_digits == 3) {
+                round_up = (*p >= '5');
+            }
+            frac_digits++;
+            p++;
+        }
+    }
+    if (whole_digits == 0 && frac_digits == 0) return false;
+    if (*p == 'e' || *p == 'E') return false;
+    while (frac_digits < 3) {
+        frac *= 10;
+        frac_digits++;
+    }
+    if (round_up && ++frac == 1000) {
+        frac = 0;
+        whole++;
+    }
+    if (whole == 0 && frac == 0) {
+        /* atof() <= 0 left the text untouched before as well. */
+        return true;
+    }
+    char buf[24];
+    size_t pos = sizeof(buf);
+    buf[--pos] = '\0';
+    for (int i = 0; i < 3; ++i) {
+        buf[--pos] = (char)('0' + frac % 10);
+        frac /= 10;
+    }
+    buf[--pos] = '.';
+    do {
+        buf[--pos] = (char)('0' + whole % 10);
+        whole /= 10;
+    } while (whole > 0);
+    strlcpy(text, &buf[pos], text_len);
+    return true;
+}
+
+static void normalize_frequency(char *text, size_t text_len)
+{
+    if (text[0] == '\0' || normalize_frequency_fixed(text, text_len)) {
+        return;
+    }
+    double freq_val = strtod(text, NULL);
+    if (freq_val > 0) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%.3f", freq_val);
+        strlcpy(text, buf, text_len);
+    }
+}
+
+static void builder_emit(parser_t *ps, spot_builder_t *b)
+{
+    if (b->spot.callsign[0] == '\0') {
+        return;
+    }
+    normalize_frequency(b->spot.frequency, sizeof(b->spot.frequency));
+    if (ps->cb) {
+        ps->cb(&b->spot, ps->ctx);
+    }
+    ps->emitted++;
+}
+
+static bool parse_field_value(parser_t *ps, spot_builder_t *b, const key_map_t *map)
+{
+    size_t len = 0;
+    char *dst = NULL;
+    if (map->rank > b->rank[map->field]) {
+        dst = field_ptr(&b->spot, map->field, &len);
+    }
+    if (dst) {
+        if (!parse_string(ps, dst, len, NULL)) return false;
+        b->rank[map->field] = map->rank;
+    } else {
+        const char *start = ps->p;
+        if (!parse_string(ps, NULL, 0, NULL)) return false;
+        if (map->alt_field == FIELD_NONE || map->alt_rank <= b->rank[map->alt_field]) {
+            return true;
+        }
+        /* Only the alias target wants this value; decode it again in place. */
+        ps->p = start;
+        dst = field_ptr(&b->spot, map->alt_field, &len);
+        if (!parse_string(ps, dst, len, NULL)) return false;
+        b->rank[map->alt_field] = map->alt_rank;
+        return true;
+    }
+    if (map->alt_field != FIELD_NONE && map->alt_rank > b->rank[map->alt_field]) {
+        size_t alt_len = 0;
+        char *alt = field_ptr(&b->spot, map->alt_field, &alt_len);
+        strlcpy(alt, dst, alt_len);
+        b->rank[map->alt_field] = map->alt_rank;
+    }
+    return true;
+}
+
+static bool parse_spot_object(parser_t *ps, bool allow_envelope)
+{
+    spot_builder_t builder;
+    memset(&builder, 0, sizeof(builder));
+    bool envelope = false;
+
+    if (!peek(ps, '{') || ++ps->depth > PARSER_MAX_DEPTH) {
+        return false;
+    }
+    ps->p++;
+    skip_ws(ps);
+    if (peek(ps, '}')) {
+        ps->p++;
+        ps->depth--;
+        return true;
+    }
+    while (true) {
+        char key[PARSER_KEY_MAX];
+        bool key_truncated = false;
+        skip_ws(ps);
+        if (!parse_string(ps, key, sizeof(key), &key_truncated)) return false;
+        skip_ws(ps);
+        if (!peek(ps, ':')) return false;
+        ps->p++;
+        skip_ws(ps);
+
+        const key_map_t *map = key_truncated ? NULL : lookup_key(key);
+        if (allow_envelope && !envelope && !key_truncated && strcasecmp(key, "spots") == 0 && peek(ps, '[')) {
+            envelope = true;
+            if (!parse_spot_array(ps)) return false;
+        } else if (map && peek(ps, '"')) {
+            if (!parse_field_value(ps, &builder, map)) return false;
+        } else if (!skip_value(ps)) {
+            return false;
+        }
+
+        skip_ws(ps);
+        if (peek(ps, ',')) {
+            ps->p++;
+            continue;
+        }
+        if (peek(ps, '}')) {
+            ps->p++;
+            ps->depth--;
+            break;
+        }
+        return false;
+    }
+
+    if (!envelope) {
+        builder_emit(ps, &builder);
+    }
+    return true;
+}
+
+static bool parse_spot_array(parser_t *ps)
+{
+    if (!peek(ps, '[') || ++ps->depth > PARSER_MAX_DEPTH) {
+        return false;
+    }
+    ps->p++;
+    skip_ws(ps);
+    if (peek(ps, ']')) {
+        ps->p++;
+        ps->depth--;
+        return true;
+    }
+    while (true) {
+        skip_ws(ps);
+        bool ok = peek(ps, '{') ? parse_spot_object(ps, false) : skip_value(ps);
+        if (!ok) return false;
+        skip_ws(ps);
+        if (peek(ps, ',')) {
+            ps->p++;
+            continue;
+        }
+        if (peek(ps, ']')) {
+            ps->p++;
+            ps->depth--;
+            return true;
+        }
+        return false;
+    }
+}
+
+int hamview_spot_parse_json(const char *json, size_t len, hamview_spot_parser_cb_t cb, void *ctx)
+{
+    if (!json) {
+        return -1;
+    }
+    parser_t ps = {
+        .p = json,
+        .end = json + len,
+        .depth = 0,
+        .cb = cb,
+        .ctx = ctx,
+        .emitted = 0,
+    };
+    skip_ws(&ps);
+    bool ok;
+    if (peek(&ps, '[')) {
+        ok = parse_spot_array(&ps);
+    } else if (peek(&ps, '{')) {
+        ok = parse_spot_object(&ps, true);
+    } else {
+        ok = skip_value(&ps);
+    }
+    return ok ? ps.emitted : -1;
+}
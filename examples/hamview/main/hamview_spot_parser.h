@@ -0,0 +1,25 @@
+#ifndef HAMVIEW_SPOT_PARSER_H
+#define HAMVIEW_SPOT_PARSER_H
+
+#include <stddef.h>
+
+#include "hamview_backend.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*hamview_spot_parser_cb_t)(const hamview_spot_t *spot, void *ctx);
+
+/* Parses a HamAlert JSON payload (a single spot object, an array of spots or
+ * a {"spots":[...]} envelope) in one pass without heap allocation. Every spot
+ * with a callsign is handed to cb as soon as its object closes. Returns the
+ * number of spots delivered, or -1 if the payload is not valid JSON; spots
+ * completed before the error are still delivered. */
+int hamview_spot_parse_json(const char *json, size_t len, hamview_spot_parser_cb_t cb, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
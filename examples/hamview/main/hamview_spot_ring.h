@@ -0,0 +1,74 @@
+#ifndef HAMVIEW_SPOT_RING_H
+#define HAMVIEW_SPOT_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hamview_backend.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    hamview_spot_t spot;
+    uint64_t received_us;
+    uint8_t mode_class;
+} stored_spot_t;
+
+/* Fixed-capacity ring of spots in arrival order. Logical index 0 is the
+ * newest entry; the oldest sits at count - 1. Inserts overwrite the oldest
+ * slot once full, and expiry pops from the old end, so neither path moves
+ * any other entry.
+ *
+ * Not thread-safe; the backend calls everything under its spot mutex. */
+typedef struct {
+    stored_spot_t *entries;
+    size_t capacity;
+    size_t head;
+    size_t count;
+} spot_ring_t;
+
+static inline stored_spot_t *spot_ring_at(const spot_ring_t *ring, size_t index)
+{
+    size_t slot = (ring->head + ring->capacity - 1 - index) % ring->capacity;
+    return &ring->entries[slot];
+}
+
+static inline stored_spot_t *spot_ring_push(spot_ring_t *ring)
+{
+    stored_spot_t *slot = &ring->entries[ring->head];
+    if (ring->count < ring->capacity) {
+        ring->count++;
+    }
+    ring->head = (ring->head + 1) % ring->capacity;
+    return slot;
+}
+
+static inline void spot_ring_expire(spot_ring_t *ring, uint64_t now, uint64_t max_age_us)
+{
+    while (ring->count > 0) {
+        const stored_spot_t *oldest = spot_ring_at(ring, ring->count - 1);
+        uint64_t age_us = (now >= oldest->received_us) ? (now - oldest->received_us) : 0;
+        if (age_us <= max_age_us) {
+            break;
+        }
+        ring->count--;
+    }
+}
+
+static inline void spot_ring_clear(spot_ring_t *ring)
+{
+    if (ring->entries && ring->capacity > 0) {
+        memset(ring->entries, 0, ring->capacity * sizeof(stored_spot_t));
+    }
+    ring->head = 0;
+    ring->count = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
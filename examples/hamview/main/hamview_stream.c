@@ -0,0 +1,345 @@
+#include "hamview_stream.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "hamview_json.h"
+
+#define STREAM_RING_EVENTS      (16)
+#define STREAM_EVENT_MAX        (1024)
+#define STREAM_CLIENT_QUEUE     (8)
+#define STREAM_RETRY_MS         (100)
+#define STREAM_KEEPALIVE_US     (15LL * 1000000LL)
+#define STREAM_STALL_US         (30LL * 1000000LL)
+#define STREAM_TASK_STACK       (3072)
+#define STREAM_TASK_PRIORITY    (3)
+
+_Static_assert(STREAM_CLIENT_QUEUE < STREAM_RING_EVENTS, "client queue must fit in the event ring");
+
+typedef struct {
+    uint16_t len;
+    char text[STREAM_EVENT_MAX];
+} stream_event_t;
+
+/* A subscriber reads the shared event ring through its own cursor, so an
+ * event is serialized once however many clients follow it. Its queue is the
+ * window between next_seq and the ring head, capped at STREAM_CLIENT_QUEUE. */
+typedef struct {
+    int fd;
+    bool closing;
+    bool ping;
+    uint32_t next_seq;
+    size_t offset;
+    int64_t last_progress_us;
+    int64_t last_send_us;
+} stream_client_t;
+
+static const char *TAG = "hamview_stream";
+static const char STREAM_HEADERS[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "\r\n"
+    "retry: 5000\n\n";
+static const char STREAM_PING[] = ": ping\n\n";
+
+static httpd_handle_t s_httpd = NULL;
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task = NULL;
+static stream_event_t *s_ring = NULL;
+static uint32_t s_head = 0;
+static stream_client_t s_clients[HAMVIEW_STREAM_MAX_SUBSCRIBERS];
+static hamview_stream_stats_t s_stats;
+
+/* Sends as much of the client's backlog as the socket takes without
+ * blocking. Returns true while data is still pending. */
+static bool stream_client_flush(stream_client_t *c, int64_t now)
+{
+    while (true) {
+        const char *item;
+        size_t item_len;
+        if (c->ping) {
+            item = STREAM_PING;
+            item_len = sizeof(STREAM_PING) - 1;
+        } else if (c->next_seq != s_head) {
+            const stream_event_t *event = &s_ring[c->next_seq % STREAM_RING_EVENTS];
+            item = event->text;
+            item_len = event->len;
+        } else if (now - c->last_send_us >= STREAM_KEEPALIVE_US) {
+            c->ping = true;
+            continue;
+        } else {
+            return false;
+        }
+
+        int sent = httpd_socket_send(s_httpd, c->fd, item + c->offset, item_len - c->offset, MSG_DONTWAIT);
+        if (sent == HTTPD_SOCK_ERR_TIMEOUT) {
+            if (now - c->last_progress_us >= STREAM_STALL_US) {
+                ESP_LOGW(TAG, "Subscriber fd %d stalled, disconnecting", c->fd);
+                s_stats.stalled_disconnects++;
+                c->closing = true;
+                return false;
+            }
+            return true;
+        }
+        if (sent <= 0) {
+            c->closing = true;
+            return false;
+        }
+        c->last_progress_us = now;
+        c->offset += (size_t)sent;
+        if (c->offset < item_len) {
+            return true;
+        }
+        c->offset = 0;
+        c->last_send_us = now;
+        if (c->ping) {
+            c->ping = false;
+        } else {
+            c->next_seq++;
+        }
+    }
+}
+
+static void stream_task(void *arg)
+{
+    (void)arg;
+    TickType_t wait = portMAX_DELAY;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        int close_fds[HAMVIEW_STREAM_MAX_SUBSCRIBERS];
+        size_t close_count = 0;
+        bool pending = false;
+        bool any = false;
+        int64_t now = esp_timer_get_time();
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        for (size_t i = 0; i < HAMVIEW_STREAM_MAX_SUBSCRIBERS; ++i) {
+            stream_client_t *c = &s_clients[i];
+            if (c->fd < 0 || c->closing) {
+                continue;
+            }
+            any = true;
+            pending |= stream_client_flush(c, now);
+            if (c->closing) {
+                close_fds[close_count++] = c->fd;
+            }
+        }
+        xSemaphoreGive(s_lock);
+
+        /* The slot is released by hamview_stream_on_close once httpd has
+         * torn the session down. */
+        for (size_t i = 0; i < close_count; ++i) {
+            httpd_sess_trigger_close(s_httpd, close_fds[i]);
+        }
+
+        if (pending) {
+            wait = pdMS_TO_TICKS(STREAM_RETRY_MS);
+        } else if (any) {
+            wait = pdMS_TO_TICKS(STREAM_KEEPALIVE_US / 1000);
+        } else {
+            wait = portMAX_DELAY;
+        }
+    }
+}
+
+esp_err_t hamview_stream_init(httpd_handle_t hd)
+{
+    if (s_task) {
+        s_httpd = hd;
+        return ESP_OK;
+    }
+    size_t bytes = sizeof(stream_event_t) * STREAM_RING_EVENTS;
+    s_ring = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_ring) {
+        s_ring = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (!s_ring) {
+        ESP_LOGE(TAG, "event ring alloc failed");
+        return ESP_ERR_NO_MEM;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    if (!s_lock) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (size_t i = 0; i < HAMVIEW_STREAM_MAX_SUBSCRIBERS; ++i) {
+        s_clients[i].fd = -1;
+    }
+    s_httpd = hd;
+    if (xTaskCreatePinnedToCore(stream_task, "hamview_stream", STREAM_TASK_STACK, NULL, STREAM_TASK_PRIORITY, &s_task, tskNO_AFFINITY) != pdPASS) {
+        s_task = NULL;
+        ESP_LOGE(TAG, "stream task create failed");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t hamview_stream_handler(httpd_req_t *req)
+{
+    if (!s_task) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "stream not available");
+    }
+    int fd = httpd_req_to_sockfd(req);
+    stream_client_t *slot = NULL;
+
+    /* Reserve a slot as closing so the sender skips it until the response
+     * headers are out. */
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (size_t i = 0; i < HAMVIEW_STREAM_MAX_SUBSCRIBERS; ++i) {
+        if (s_clients[i].fd < 0) {
+            slot = &s_clients[i];
+            memset(slot, 0, sizeof(*slot));
+            slot->fd = fd;
+            slot->closing = true;
+            break;
+        }
+    }
+    if (!slot) {
+        s_stats.rejected_subscribers++;
+    }
+    xSemaphoreGive(s_lock);
+
+    if (!slot) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_type(req, "text/plain");
+        return httpd_resp_sendstr(req, "too many stream subscribers");
+    }
+
+    int sent = httpd_send(req, STREAM_HEADERS, sizeof(STREAM_HEADERS) - 1);
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (sent == (int)(sizeof(STREAM_HEADERS) - 1)) {
+        int64_t now = esp_timer_get_time();
+        slot->closing = false;
+        slot->next_seq = s_head;
+        slot->last_progress_us = now;
+        slot->last_send_us = now;
+    } else {
+        slot->fd = -1;
+    }
+    xSemaphoreGive(s_lock);
+
+    if (slot->fd < 0) {
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Subscriber connected on fd %d", fd);
+    return ESP_OK;
+}
+
+void hamview_stream_on_close(httpd_handle_t hd, int sockfd)
+{
+    (void)hd;
+    if (s_lock) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        for (size_t i = 0; i < HAMVIEW_STREAM_MAX_SUBSCRIBERS; ++i) {
+            if (s_clients[i].fd == sockfd) {
+                s_clients[i].fd = -1;
+                ESP_LOGI(TAG, "Subscriber on fd %d closed", sockfd);
+            }
+        }
+        xSemaphoreGive(s_lock);
+    }
+    close(sockfd);
+}
+
+void hamview_stream_publish_spot(const hamview_spot_t *spot)
+{
+    if (!spot || !s_task) {
+        return;
+    }
+    hamview_spot_t fresh = *spot;
+    fresh.age_seconds = 0;
+    fresh.is_new = true;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool any = false;
+    for (size_t i = 0; i < HAMVIEW_STREAM_MAX_SUBSCRIBERS; ++i) {
+        if (s_clients[i].fd >= 0 && !s_clients[i].closing) {
+            any = true;
+        }
+    }
+    if (!any) {
+        xSemaphoreGive(s_lock);
+        return;
+    }
+
+    stream_event_t *event = &s_ring[s_head % STREAM_RING_EVENTS];
+    int prefix = snprintf(event->text, sizeof(event->text), "id: %u\nevent: spot\ndata: ", (unsigned)s_head);
+    hamview_json_writer_t w;
+    /* Leave room for the blank line that ends the event. */
+    hamview_json_init(&w, event->text + prefix, sizeof(event->text) - (size_t)prefix - 2);
+    hamview_backend_write_spot_json(&w, &fresh);
+    size_t json_len = hamview_json_finish(&w);
+    if (json_len == 0) {
+        s_stats.oversized_events++;
+        xSemaphoreGive(s_lock);
+        return;
+    }
+    memcpy(event->text + prefix + json_len, "\n\n", 2);
+    event->len = (uint16_t)(prefix + json_len + 2);
+    s_head++;
+    s_stats.events++;
+
+    /* Drop policy: a client more than STREAM_CLIENT_QUEUE events behind
+     * loses its oldest ones. One stuck mid-event cannot skip, so it is cut
+     * off before the ring overwrites the event it is still sending. */
+    int close_fds[HAMVIEW_STREAM_MAX_SUBSCRIBERS];
+    size_t close_count = 0;
+    for (size_t i = 0; i < HAMVIEW_STREAM_MAX_SUBSCRIBERS; ++i) {
+        stream_client_t *c = &s_clients[i];
+        if (c->fd < 0 || c->closing) {
+            continue;
+        }
+        uint32_t lag = s_head - c->next_seq;
+        if (lag <= STREAM_CLIENT_QUEUE) {
+            continue;
+        }
+        if (c->offset == 0 || c->ping) {
+            s_stats.dropped_events += lag - STREAM_CLIENT_QUEUE;
+            c->next_seq = s_head - STREAM_CLIENT_QUEUE;
+        } else if (lag >= STREAM_RING_EVENTS) {
+            s_stats.stalled_disconnects++;
+            c->closing = true;
+            close_fds[close_count++] = c->fd;
+        }
+    }
+    xSemaphoreGive(s_lock);
+
+    for (size_t i = 0; i < close_count; ++i) {
+        httpd_sess_trigger_close(s_httpd, close_fds[i]);
+    }
+    xTaskNotifyGive(s_task);
+}
+
+void hamview_stream_get_stats(hamview_stream_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    if (!s_lock) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *out = s_stats;
+    out->subscribers = 0;
+    for (size_t i = 0; i < HAMVIEW_STREAM_MAX_SUBSCRIBERS; ++i) {
+        if (s_clients[i].fd >= 0) {
+            out->subscribers++;
+        }
+    }
+    xSemaphoreGive(s_lock);
+}
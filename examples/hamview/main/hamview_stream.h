@@ -0,0 +1,45 @@
+#ifndef HAMVIEW_STREAM_H
+#define HAMVIEW_STREAM_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#include "hamview_backend.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HAMVIEW_STREAM_MAX_SUBSCRIBERS 3
+
+typedef struct {
+    uint32_t subscribers;
+    uint32_t events;
+    uint32_t dropped_events;
+    uint32_t oversized_events;
+    uint32_t rejected_subscribers;
+    uint32_t stalled_disconnects;
+} hamview_stream_stats_t;
+
+/* Starts the sender task that owns all subscriber sockets of hd. */
+esp_err_t hamview_stream_init(httpd_handle_t hd);
+
+/* GET handler for /api/stream: answers with an open text/event-stream and
+ * registers the socket, or 503 when all subscriber slots are taken. */
+esp_err_t hamview_stream_handler(httpd_req_t *req);
+
+/* httpd close_fn; forgets the subscriber on sockfd and closes it. */
+void hamview_stream_on_close(httpd_handle_t hd, int sockfd);
+
+/* Queues a "spot" event for every subscriber. Never waits on a client. */
+void hamview_stream_publish_spot(const hamview_spot_t *spot);
+
+void hamview_stream_get_stats(hamview_stream_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
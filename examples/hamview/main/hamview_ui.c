@@ -11,6 +11,7 @@
 #include "esp_err.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "radio.h"
 #include "sdkconfig.h"
 #if defined(__has_include)
@@ -42,6 +43,8 @@
 #include "hamview_alert.h"
 #include "hamview_event_log.h"
 #include "hamview_icom.h"
+#include "hamview_meter_trace.h"
+#include "esp_heap_caps.h"
 #include "indicator/config.h"
 #include "indicator/view_data.h"
 #include "lv_port.h"
@@ -85,6 +88,9 @@ static lv_obj_t *time_format_switch = NULL;
 static lv_obj_t *temp_unit_switch = NULL;
 static lv_obj_t *spot_age_dropdown = NULL;
 static lv_timer_t *refresh_timer = NULL;
+/* Set while the screen sleeps: the refresh timer is paused and the dashboard
+ * is brought up to date in one pass on wake. */
+static bool refresh_deferred = false;
 static bool dashboard_loaded = false;
 static lv_obj_t *mode_filter_dropdown = NULL;
 static lv_obj_t *band_filter_dropdown = NULL;
@@ -135,6 +141,26 @@ static spot_filter_mode_t current_mode_filter = SPOT_FILTER_MODE_ALL;
 static spot_filter_band_t current_band_filter = SPOT_FILTER_BAND_ALL;
 static spot_row_info_t current_row_info[HAMVIEW_MAX_SPOTS];
 
+#define SPOTS_TABLE_COLS 5
+#define SPOTS_CELL_SHADOW_LEN 192
+#define SPOTS_REFRESH_PERIOD_MS 5000
+#define WIFI_SCAN_PERIOD_US (30LL * 1000000LL)
+
+/* What the spots table currently shows: the snapshot generation it was built
+ * from, which snapshot entry each row came from and a shadow of every cell's
+ * text. lv_table_set_cell_value reallocates the cell and invalidates it (or
+ * the whole table if the row height changes), so it is only called for cells
+ * whose text differs. */
+static uint32_t spots_rendered_generation = 0;
+static bool spots_table_force = true;
+static size_t spots_displayed = 0;
+static uint8_t spots_row_source[HAMVIEW_MAX_SPOTS];
+static char spots_cell_shadow[HAMVIEW_MAX_SPOTS][SPOTS_TABLE_COLS][SPOTS_CELL_SHADOW_LEN];
+static uint32_t status_rendered_generation = 0;
+static int8_t status_rendered_rssi = 0;
+static bool status_rendered_wifi = false;
+static hamview_ui_refresh_stats_t refresh_stats;
+
 static lv_obj_t *weather_location_label = NULL;
 static lv_obj_t *weather_condition_label = NULL;
 static lv_obj_t *weather_temp_label = NULL;
@@ -142,6 +168,14 @@ static lv_obj_t *weather_extra_label = NULL;
 static lv_obj_t *weather_updated_label = NULL;
 static lv_obj_t *weather_sun_label = NULL;
 static lv_obj_t *weather_alerts_container = NULL;
+static lv_obj_t *weather_alerts_title = NULL;
+static lv_obj_t *weather_alerts_placeholder = NULL;
+static lv_obj_t *weather_alert_labels[HAMVIEW_WEATHER_MAX_ALERTS] = {NULL};
+static lv_obj_t *weather_alerts_error_label = NULL;
+static uint32_t weather_rendered_generation = 0;
+static bool weather_rendered_celsius = false;
+static bool weather_rendered_24h = false;
+static bool weather_rendered_valid = false;
 static lv_obj_t *weather_warning_label = NULL;
 static lv_obj_t *weather_forecast_label = NULL;
 static lv_obj_t *weather_action_row = NULL;
@@ -181,6 +215,7 @@ static lv_obj_t *ic705_freq_label = NULL;
 static lv_obj_t *ic705_mode_label = NULL;
 static lv_obj_t *ic705_smeter_label = NULL;
 static lv_obj_t *ic705_smeter_bar = NULL;
+static lv_obj_t *ic705_tx_label = NULL;
 static lv_obj_t *ic705_last_update_label = NULL;
 static lv_obj_t *ic705_connect_btn = NULL;
 static lv_obj_t *ic705_select_modal = NULL;
@@ -190,6 +225,47 @@ static lv_obj_t *ic705_select_hint = NULL;
 static lv_obj_t *ic705_select_list = NULL;
 static lv_obj_t *ic705_rescan_btn = NULL;
 static lv_obj_t *ic705_close_btn = NULL;
+static lv_obj_t *ic705_strip_img = NULL;
+static lv_obj_t *ic705_strip_btn = NULL;
+static lv_obj_t *ic705_strip_btn_label = NULL;
+static lv_timer_t *ic705_strip_timer = NULL;
+
+/* S-meter strip charts. Each view owns a pixel ring buffer shown through an
+ * lv_img whose x offset scrolls it, so a new column costs one column of
+ * pixel writes and a blit instead of a chart redraw. Both views are fed all
+ * the time so switching is instant. */
+#define IC705_STRIP_HEIGHT 72
+#define IC705_STRIP_COL_PX 2
+#define IC705_STRIP_MAX_COLUMNS 240
+#define IC705_STRIP_PERIOD_MS 250
+
+typedef struct {
+    const char *name;
+    uint32_t window_ms;
+    hamview_meter_trace_t trace;
+    lv_img_dsc_t img;
+    lv_color_t *pixels;
+    uint16_t columns;
+    uint16_t head;
+    bool dirty;
+} ic705_strip_t;
+
+static ic705_strip_t ic705_strips[] = {
+    { .name = "1 min", .window_ms = 60U * 1000U },
+    { .name = "1 h", .window_ms = 60U * 60U * 1000U },
+};
+static size_t ic705_strip_view = 0;
+
+/* Theme colours the pixel rings are painted with; a theme change repaints
+ * the rings from these to the new ones. */
+typedef struct {
+    lv_color_t bg;
+    lv_color_t range;
+    lv_color_t mean;
+    lv_color_t mark;
+} ic705_strip_colors_t;
+
+static ic705_strip_colors_t ic705_strip_colors;
 
 #define HAMVIEW_THEME_MAX_CARDS 32
 typedef struct {
@@ -203,7 +279,9 @@ static size_t theme_card_count = 0;
 static void update_spots_table(void);
 static void update_spots_table_internal(void);
 static void update_spots_table_async(void *param);
+static bool render_spots_table(const hamview_backend_snapshot_t *snap);
 static void update_status_labels(void);
+static void render_status_labels(const hamview_status_t *status);
 static void update_weather_panel(void);
 static void update_clock_labels(void);
 static void open_settings_modal(void);
@@ -214,7 +292,7 @@ static void settings_time_format_event_cb(lv_event_t *e);
 static void settings_temp_unit_event_cb(lv_event_t *e);
 static void settings_wifi_scan_btn_cb(lv_event_t *e);
 static void filter_dropdown_event_cb(lv_event_t *e);
-static bool spot_passes_filters(const hamview_spot_t *spot, spot_row_info_t *info_out);
+static bool spot_passes_filters(const hamview_spot_t *spot, uint32_t age_seconds, spot_row_info_t *info_out);
 static void spots_table_draw_event(lv_event_t *e);
 static void update_activity_charts(void);
 static void update_activity_charts_internal(void);
@@ -242,6 +320,8 @@ static void ic705_select_refresh(void);
 static void ic705_select_item_event_cb(lv_event_t *e);
 static void ic705_rescan_btn_event_cb(lv_event_t *e);
 static void ic705_close_btn_event_cb(lv_event_t *e);
+static void ic705_strip_btn_event_cb(lv_event_t *e);
+static void ic705_strip_apply_theme(void);
 static void rf_ble_start_scan(void);
 static void rf_ble_stop_scan(void);
 #if HAMVIEW_HAS_BT_CLASSIC
@@ -436,6 +516,32 @@ static void set_label_error(lv_obj_t *label)
     }
 }
 
+/* lv_label_set_text() always reallocates and invalidates, even for the
+ * same text. */
+static void set_label_text_if_changed(lv_obj_t *label, const char *text)
+{
+    if (!label) {
+        return;
+    }
+    const char *existing = lv_label_get_text(label);
+    if (existing && strcmp(existing, text) == 0) {
+        return;
+    }
+    lv_label_set_text(label, text);
+}
+
+static void set_obj_visible(lv_obj_t *obj, bool visible)
+{
+    if (!obj || lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN) == !visible) {
+        return;
+    }
+    if (visible) {
+        lv_obj_clear_flag(obj, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
 static void configure_card_surface(lv_obj_t *obj, bool alternate)
 {
     if (!obj) return;
@@ -638,6 +744,8 @@ static void apply_theme(void)
     }
     style_primary_button(ic705_rescan_btn);
     style_primary_button(ic705_close_btn);
+    style_primary_button(ic705_strip_btn);
+    ic705_strip_apply_theme();
 
     style_table(table);
 
@@ -686,6 +794,13 @@ static void apply_theme(void)
     if (weather_updated_label) {
         set_label_muted(weather_updated_label);
     }
+    set_label_primary(weather_alerts_title);
+    set_label_muted(weather_alerts_placeholder);
+    for (size_t i = 0; i < HAMVIEW_WEATHER_MAX_ALERTS; ++i) {
+        set_label_secondary(weather_alert_labels[i]);
+    }
+    set_label_warning(weather_alerts_error_label);
+    weather_rendered_valid = false;
     if (log_label) {
         set_label_primary(log_label);
     }
@@ -1146,12 +1261,34 @@ static lv_obj_t *create_status_card(lv_obj_t *parent, const char *title, lv_obj_
 static void refresh_timer_cb(lv_timer_t *timer)
 {
     (void)timer;
-    static uint8_t scan_tick = 0;
+    static int64_t last_scan_us = 0;
+    int64_t start_us = esp_timer_get_time();
+    bool skipped = true;
+    refresh_stats.cells_updated = 0;
+    refresh_stats.invalidated_px = 0;
     hamview_screen_timer_tick();
+    if (hamview_screen_is_sleeping()) {
+        lv_timer_pause(refresh_timer);
+        refresh_deferred = true;
+        return;
+    }
     lv_port_sem_take();
     if (dashboard_loaded) {
-        update_status_labels();
-        update_spots_table();
+        const hamview_backend_snapshot_t *snap = hamview_backend_snapshot_acquire();
+        if (snap) {
+            if (snap->generation != status_rendered_generation || last_wifi_rssi != status_rendered_rssi ||
+                last_wifi_connected != status_rendered_wifi) {
+                render_status_labels(&snap->status);
+                status_rendered_generation = snap->generation;
+                status_rendered_rssi = last_wifi_rssi;
+                status_rendered_wifi = last_wifi_connected;
+                skipped = false;
+            }
+            if (render_spots_table(snap)) {
+                skipped = false;
+            }
+            hamview_backend_snapshot_release(snap);
+        }
         update_weather_panel();
         update_weather_action_buttons();
         update_event_log_panel();
@@ -1168,12 +1305,48 @@ static void refresh_timer_cb(lv_timer_t *timer)
             rf_bt_list_dirty = false;
         }
 #endif
-        if (++scan_tick >= 6) {
-            scan_tick = 0;
+        /* Timed rather than counted: notifications make ticks irregular. */
+        if (start_us - last_scan_us >= WIFI_SCAN_PERIOD_US) {
+            last_scan_us = start_us;
             request_wifi_scan();
         }
     }
     lv_port_sem_give();
+
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    refresh_stats.ticks++;
+    if (skipped) {
+        refresh_stats.skipped_ticks++;
+    }
+    refresh_stats.last_tick_us = elapsed_us;
+    if (elapsed_us > refresh_stats.max_tick_us) {
+        refresh_stats.max_tick_us = elapsed_us;
+    }
+    refresh_stats.total_tick_us += elapsed_us;
+}
+
+/* Runs in the LVGL task when the backend has published something new or
+ * the screen went to sleep or woke up. */
+static void refresh_notify_cb(void)
+{
+    if (!refresh_timer || hamview_screen_is_sleeping()) {
+        return;
+    }
+    if (refresh_deferred) {
+        refresh_deferred = false;
+        lv_timer_resume(refresh_timer);
+    }
+    lv_timer_ready(refresh_timer);
+}
+
+void hamview_ui_get_refresh_stats(hamview_ui_refresh_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    lv_port_sem_take();
+    *out = refresh_stats;
+    lv_port_sem_give();
 }
 
 static void request_wifi_scan(void)
@@ -1277,8 +1450,14 @@ static void update_ic705_panel(void)
     }
 
     if (state.mode[0]) {
-        char mode_line[32];
-        snprintf(mode_line, sizeof(mode_line), "Mode: %s", state.mode);
+        char mode_line[64];
+        int used = snprintf(mode_line, sizeof(mode_line), "Mode: %s%s", state.mode, state.data_mode ? "-D" : "");
+        if (state.filter && used > 0 && (size_t)used < sizeof(mode_line)) {
+            used += snprintf(mode_line + used, sizeof(mode_line) - used, "  FIL%u", (unsigned)state.filter);
+        }
+        if (state.filter_width_hz && used > 0 && (size_t)used < sizeof(mode_line)) {
+            snprintf(mode_line + used, sizeof(mode_line) - used, " %u Hz", (unsigned)state.filter_width_hz);
+        }
         lv_label_set_text(ic705_mode_label, mode_line);
     } else {
         lv_label_set_text(ic705_mode_label, "Mode: --");
@@ -1294,6 +1473,28 @@ static void update_ic705_panel(void)
         lv_bar_set_value(ic705_smeter_bar, 0, LV_ANIM_OFF);
     }
 
+    if (ic705_tx_label) {
+        char tx_line[96];
+        int used;
+        if (state.transmitting) {
+            used = snprintf(tx_line, sizeof(tx_line), "TX  Po %u  SWR %u  ALC %u",
+                            (unsigned)state.power_meter_raw, (unsigned)state.swr_raw, (unsigned)state.alc_raw);
+        } else {
+            used = snprintf(tx_line, sizeof(tx_line), "RX");
+        }
+        if (state.rf_power_raw && used > 0 && (size_t)used < sizeof(tx_line)) {
+            used += snprintf(tx_line + used, sizeof(tx_line) - used, "  RF %u%%", (unsigned)((state.rf_power_raw * 100U + 127U) / 255U));
+        }
+        if (state.split && used > 0 && (size_t)used < sizeof(tx_line)) {
+            if (state.unselected_freq_hz) {
+                snprintf(tx_line + used, sizeof(tx_line) - used, "  Split %llu Hz", (unsigned long long)state.unselected_freq_hz);
+            } else {
+                snprintf(tx_line + used, sizeof(tx_line) - used, "  Split");
+            }
+        }
+        lv_label_set_text(ic705_tx_label, tx_line);
+    }
+
     if (state.last_update_ms > 0) {
         char update_line[48];
         snprintf(update_line, sizeof(update_line), "Last update: %llums", (unsigned long long)state.last_update_ms);
@@ -1303,6 +1504,184 @@ static void update_ic705_panel(void)
     }
 }
 
+static lv_color_t ic705_strip_recolor(lv_color_t c, const ic705_strip_colors_t *from, const ic705_strip_colors_t *to)
+{
+    if (c.full == from->bg.full) {
+        return to->bg;
+    }
+    if (c.full == from->range.full) {
+        return to->range;
+    }
+    if (c.full == from->mean.full) {
+        return to->mean;
+    }
+    if (c.full == from->mark.full) {
+        return to->mark;
+    }
+    return c;
+}
+
+/* Repaints the history already in the rings with the current theme. */
+static void ic705_strip_apply_theme(void)
+{
+    ic705_strip_colors_t next = {
+        .bg = theme_surface_alt(),
+        .range = theme_chart_bar(),
+        .mean = theme_chart_line(),
+        .mark = theme_warning(),
+    };
+    if (memcmp(&next, &ic705_strip_colors, sizeof(next)) == 0) {
+        return;
+    }
+    for (size_t v = 0; v < ARRAY_SIZE(ic705_strips); ++v) {
+        ic705_strip_t *strip = &ic705_strips[v];
+        if (!strip->pixels) {
+            continue;
+        }
+        size_t count = (size_t)strip->columns * IC705_STRIP_COL_PX * IC705_STRIP_HEIGHT;
+        for (size_t i = 0; i < count; ++i) {
+            strip->pixels[i] = ic705_strip_recolor(strip->pixels[i], &ic705_strip_colors, &next);
+        }
+    }
+    ic705_strip_colors = next;
+    if (ic705_strip_img) {
+        lv_obj_invalidate(ic705_strip_img);
+    }
+}
+
+static void ic705_strip_init(lv_coord_t width)
+{
+    ic705_strip_apply_theme();
+    uint16_t columns = (uint16_t)(width / IC705_STRIP_COL_PX);
+    if (columns > IC705_STRIP_MAX_COLUMNS) {
+        columns = IC705_STRIP_MAX_COLUMNS;
+    }
+    for (size_t v = 0; v < ARRAY_SIZE(ic705_strips); ++v) {
+        ic705_strip_t *strip = &ic705_strips[v];
+        if (strip->pixels) {
+            continue;
+        }
+        uint32_t w = (uint32_t)columns * IC705_STRIP_COL_PX;
+        size_t bytes = (size_t)w * IC705_STRIP_HEIGHT * sizeof(lv_color_t);
+        strip->pixels = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!strip->pixels) {
+            ESP_LOGW(TAG, "IC-705 %s strip chart unavailable", strip->name);
+            continue;
+        }
+        for (size_t i = 0; i < w * IC705_STRIP_HEIGHT; ++i) {
+            strip->pixels[i] = ic705_strip_colors.bg;
+        }
+        strip->columns = columns;
+        strip->head = 0;
+        strip->img.header.always_zero = 0;
+        strip->img.header.w = w;
+        strip->img.header.h = IC705_STRIP_HEIGHT;
+        strip->img.header.cf = LV_IMG_CF_TRUE_COLOR;
+        strip->img.data_size = bytes;
+        strip->img.data = (const uint8_t *)strip->pixels;
+        hamview_meter_trace_init(&strip->trace, strip->window_ms / columns, columns);
+    }
+}
+
+static lv_coord_t ic705_strip_y(uint8_t value)
+{
+    return (lv_coord_t)(IC705_STRIP_HEIGHT - 1 - ((uint32_t)value * (IC705_STRIP_HEIGHT - 1)) / 255U);
+}
+
+/* Paints one column at the ring head: the min..max range as a bar, the mean
+ * as a brighter tick and a retune as a marker along the top edge. */
+static void ic705_strip_column_cb(const hamview_meter_column_t *column, void *ctx)
+{
+    ic705_strip_t *strip = ctx;
+    if (!strip->pixels) {
+        return;
+    }
+    uint32_t w = (uint32_t)strip->columns * IC705_STRIP_COL_PX;
+    lv_coord_t x0 = (lv_coord_t)(strip->head * IC705_STRIP_COL_PX);
+    lv_color_t bg = ic705_strip_colors.bg;
+    lv_color_t range = ic705_strip_colors.range;
+    lv_color_t mean = ic705_strip_colors.mean;
+    lv_color_t mark = ic705_strip_colors.mark;
+    lv_coord_t top = column->valid ? ic705_strip_y(column->max) : IC705_STRIP_HEIGHT;
+    lv_coord_t bottom = column->valid ? ic705_strip_y(column->min) : -1;
+    lv_coord_t avg = column->valid ? ic705_strip_y(column->avg) : -1;
+    for (lv_coord_t y = 0; y < IC705_STRIP_HEIGHT; ++y) {
+        lv_color_t c = bg;
+        if (y == avg) {
+            c = mean;
+        } else if (y >= top && y <= bottom) {
+            c = range;
+        } else if (y < 2 && column->retuned) {
+            c = mark;
+        }
+        lv_color_t *row = &strip->pixels[(uint32_t)y * w];
+        for (lv_coord_t dx = 0; dx < IC705_STRIP_COL_PX; ++dx) {
+            row[x0 + dx] = c;
+        }
+    }
+    strip->head = (uint16_t)((strip->head + 1) % strip->columns);
+    strip->dirty = true;
+}
+
+static void ic705_strip_show(void)
+{
+    ic705_strip_t *strip = &ic705_strips[ic705_strip_view];
+    if (ic705_strip_btn_label) {
+        char text[32];
+        snprintf(text, sizeof(text), "S-meter: %s", strip->name);
+        lv_label_set_text(ic705_strip_btn_label, text);
+    }
+    if (!ic705_strip_img || !strip->pixels) {
+        return;
+    }
+    if (lv_img_get_src(ic705_strip_img) != &strip->img) {
+        lv_img_set_src(ic705_strip_img, &strip->img);
+    }
+    /* Oldest column at the left edge, newest at the right. */
+    uint32_t w = (uint32_t)strip->columns * IC705_STRIP_COL_PX;
+    uint32_t end = (uint32_t)strip->head * IC705_STRIP_COL_PX;
+    lv_img_set_offset_x(ic705_strip_img, (lv_coord_t)((w - end) % w));
+    strip->dirty = false;
+}
+
+/* Sole consumer of the CI-V sample ring. Runs even when the tab is hidden
+ * so the ring never backs up and both views stay current. */
+static void ic705_strip_timer_cb(lv_timer_t *timer)
+{
+    (void)timer;
+    hamview_icom_sample_t samples[32];
+    size_t n;
+    uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
+    lv_port_sem_take();
+    while ((n = hamview_icom_read_samples(samples, ARRAY_SIZE(samples))) > 0) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t v = 0; v < ARRAY_SIZE(ic705_strips); ++v) {
+                if (!ic705_strips[v].pixels) {
+                    continue;
+                }
+                hamview_meter_trace_add(&ic705_strips[v].trace, samples[i].t_ms, samples[i].freq_hz,
+                                        samples[i].s_meter_raw, ic705_strip_column_cb, &ic705_strips[v]);
+            }
+        }
+    }
+    for (size_t v = 0; v < ARRAY_SIZE(ic705_strips); ++v) {
+        hamview_meter_trace_advance(&ic705_strips[v].trace, now, ic705_strip_column_cb, &ic705_strips[v]);
+    }
+    if (ic705_strips[ic705_strip_view].dirty) {
+        ic705_strip_show();
+    }
+    lv_port_sem_give();
+}
+
+static void ic705_strip_btn_event_cb(lv_event_t *e)
+{
+    if (!e || lv_event_get_code(e) != LV_EVENT_CLICKED) {
+        return;
+    }
+    ic705_strip_view = (ic705_strip_view + 1) % ARRAY_SIZE(ic705_strips);
+    ic705_strip_show();
+}
+
 static void radar_ble_toggle_event_cb(lv_event_t *e)
 {
     if (!e || lv_event_get_code(e) != LV_EVENT_VALUE_CHANGED) {
@@ -2536,6 +2915,11 @@ static void build_dashboard_ui(void)
     weather_extra_label = NULL;
     weather_updated_label = NULL;
     weather_alerts_container = NULL;
+    weather_alerts_title = NULL;
+    weather_alerts_placeholder = NULL;
+    memset(weather_alert_labels, 0, sizeof(weather_alert_labels));
+    weather_alerts_error_label = NULL;
+    weather_rendered_valid = false;
     weather_warning_label = NULL;
     weather_forecast_label = NULL;
     weather_action_row = NULL;
@@ -2556,6 +2940,7 @@ static void build_dashboard_ui(void)
     ic705_freq_label = NULL;
     ic705_mode_label = NULL;
     ic705_smeter_label = NULL;
+    ic705_tx_label = NULL;
     ic705_last_update_label = NULL;
     ic705_connect_btn = NULL;
     ic705_select_modal = NULL;
@@ -2565,6 +2950,9 @@ static void build_dashboard_ui(void)
     ic705_select_list = NULL;
     ic705_rescan_btn = NULL;
     ic705_close_btn = NULL;
+    ic705_strip_img = NULL;
+    ic705_strip_btn = NULL;
+    ic705_strip_btn_label = NULL;
 
     const lv_coord_t hor = lv_disp_get_hor_res(NULL);
     const lv_coord_t ver = lv_disp_get_ver_res(NULL);
@@ -2623,6 +3011,8 @@ static void build_dashboard_ui(void)
     lv_obj_align(error_label, LV_ALIGN_TOP_LEFT, pad, pad + 140);
 
     table = lv_table_create(main_tab);
+    memset(spots_cell_shadow, 0, sizeof(spots_cell_shadow));
+    spots_displayed = 0;
     lv_table_set_col_cnt(table, 5);
     lv_table_set_row_cnt(table, HAMVIEW_MAX_SPOTS + 1);
     lv_table_set_col_width(table, 0, 90);
@@ -2710,6 +3100,32 @@ static void build_dashboard_ui(void)
     lv_obj_set_style_border_width(weather_alerts_container, 0, 0);
     lv_obj_set_size(weather_alerts_container, hor - (pad * 2), 80);
     lv_obj_align(weather_alerts_container, LV_ALIGN_BOTTOM_LEFT, pad, -36);
+    lv_obj_set_flex_flow(weather_alerts_container, LV_FLEX_FLOW_COLUMN);
+
+    /* Fixed label pool; update_weather_panel() only edits and hides these. */
+    weather_alerts_title = lv_label_create(weather_alerts_container);
+    lv_obj_set_style_text_font(weather_alerts_title, &lv_font_montserrat_18, 0);
+    set_label_primary(weather_alerts_title);
+    lv_label_set_text(weather_alerts_title, "Alerts");
+
+    weather_alerts_placeholder = lv_label_create(weather_alerts_container);
+    lv_obj_set_style_text_font(weather_alerts_placeholder, &lv_font_montserrat_16, 0);
+    set_label_muted(weather_alerts_placeholder);
+    lv_label_set_text(weather_alerts_placeholder, "No alerts available");
+
+    for (size_t i = 0; i < HAMVIEW_WEATHER_MAX_ALERTS; ++i) {
+        weather_alert_labels[i] = lv_label_create(weather_alerts_container);
+        lv_obj_set_style_text_font(weather_alert_labels[i], &lv_font_montserrat_16, 0);
+        set_label_secondary(weather_alert_labels[i]);
+        lv_label_set_text(weather_alert_labels[i], "");
+        lv_obj_add_flag(weather_alert_labels[i], LV_OBJ_FLAG_HIDDEN);
+    }
+
+    weather_alerts_error_label = lv_label_create(weather_alerts_container);
+    lv_obj_set_style_text_font(weather_alerts_error_label, &lv_font_montserrat_14, 0);
+    set_label_warning(weather_alerts_error_label);
+    lv_label_set_text(weather_alerts_error_label, "");
+    lv_obj_add_flag(weather_alerts_error_label, LV_OBJ_FLAG_HIDDEN);
 
     rf_radar_label = lv_label_create(radar_tab);
     lv_label_set_text(rf_radar_label, "RF Radar\nWi-Fi: disabled\nLoRa: not enabled\n");
@@ -2818,88 +3234,166 @@ static void build_dashboard_ui(void)
     lv_obj_set_style_bg_opa(ic705_smeter_bar, LV_OPA_60, LV_PART_MAIN);
     lv_obj_set_style_bg_color(ic705_smeter_bar, theme_accent_primary(), LV_PART_INDICATOR);
 
+    ic705_tx_label = lv_label_create(ic705_container);
+    lv_label_set_text(ic705_tx_label, "RX");
+    set_label_secondary(ic705_tx_label);
+    lv_obj_set_style_text_font(ic705_tx_label, &lv_font_montserrat_14, 0);
+
     ic705_last_update_label = lv_label_create(ic705_container);
     lv_label_set_text(ic705_last_update_label, "Last update: --");
     set_label_muted(ic705_last_update_label);
     lv_obj_set_style_text_font(ic705_last_update_label, &lv_font_montserrat_14, 0);
 
+    ic705_strip_init(hor - pad * 2);
+    ic705_strip_btn = lv_btn_create(ic705_container);
+    style_primary_button(ic705_strip_btn);
+    lv_obj_add_event_cb(ic705_strip_btn, ic705_strip_btn_event_cb, LV_EVENT_CLICKED, NULL);
+    ic705_strip_btn_label = lv_label_create(ic705_strip_btn);
+    lv_obj_set_style_text_font(ic705_strip_btn_label, &lv_font_montserrat_14, 0);
+
+    ic705_strip_img = lv_img_create(ic705_container);
+    ic705_strip_show();
+
     update_spots_table();
 }
 
-static void update_spots_table_internal(void)
+static void set_spot_cell(size_t index, int col, const char *text)
 {
-    if (!table) return;
-    hamview_spot_t spots[HAMVIEW_MAX_SPOTS];
-    size_t count = hamview_backend_get_spots(spots, HAMVIEW_MAX_SPOTS);
+    char *shadow = spots_cell_shadow[index][col];
+    if (strncmp(shadow, text, SPOTS_CELL_SHADOW_LEN) == 0) {
+        return;
+    }
+    strlcpy(shadow, text, SPOTS_CELL_SHADOW_LEN);
+    lv_table_set_cell_value(table, index + 1, col, text);
+    const lv_table_t *t = (const lv_table_t *)table;
+    refresh_stats.cells_updated++;
+    refresh_stats.invalidated_px += (uint32_t)t->col_w[col] * (uint32_t)t->row_h[index + 1];
+}
 
-    for (size_t i = 0; i < HAMVIEW_MAX_SPOTS; ++i) {
-        current_row_info[i].occupied = false;
+/* Ages are shown no finer than the table is refreshed, and in whole minutes
+ * once past the first minute, so most ticks leave the column untouched. */
+static void format_spot_age(uint32_t age_seconds, char *buf, size_t len)
+{
+    const uint32_t step = SPOTS_REFRESH_PERIOD_MS / 1000U;
+    if (age_seconds < 60U) {
+        snprintf(buf, len, "%lus", (unsigned long)((age_seconds / step) * step));
+    } else if (age_seconds < 3600U) {
+        snprintf(buf, len, "%lum", (unsigned long)(age_seconds / 60U));
+    } else {
+        snprintf(buf, len, "%luh%02lum", (unsigned long)(age_seconds / 3600U),
+                 (unsigned long)((age_seconds / 60U) % 60U));
+    }
+}
+
+static void format_spot_comment(const hamview_spot_t *spot, uint32_t age_seconds, bool is_priority,
+                                char *location_buf, size_t location_len, char *comment_buf, size_t comment_len)
+{
+    location_buf[0] = '\0';
+    if (spot->state[0] && spot->country[0]) {
+        snprintf(location_buf, location_len, "%s, %s", spot->state, spot->country);
+    } else if (spot->state[0]) {
+        strlcpy(location_buf, spot->state, location_len);
+    } else if (spot->country[0]) {
+        strlcpy(location_buf, spot->country, location_len);
+    } else if (spot->dxcc[0]) {
+        strlcpy(location_buf, spot->dxcc, location_len);
+    }
+
+    const char *alert_prefix = is_priority ? "[ALERT] " : "";
+    char age_buf[16];
+    format_spot_age(age_seconds, age_buf, sizeof(age_buf));
+    if (spot->comment[0] && location_buf[0]) {
+        snprintf(comment_buf, comment_len, "%s%s  |  %s  |  Age %s", alert_prefix, spot->comment, location_buf, age_buf);
+    } else if (spot->comment[0]) {
+        snprintf(comment_buf, comment_len, "%s%s  |  Age %s", alert_prefix, spot->comment, age_buf);
+    } else if (location_buf[0]) {
+        snprintf(comment_buf, comment_len, "%s%s  |  Age %s", alert_prefix, location_buf, age_buf);
+    } else {
+        snprintf(comment_buf, comment_len, "%sAge %s", alert_prefix, age_buf);
+    }
+}
+
+/* Same generation as last render: only the age text can have moved. Rows
+ * that have aged past the age filter force a full rebuild instead. */
+static bool refresh_spot_ages(const hamview_backend_snapshot_t *snap)
+{
+    uint32_t max_age = (uint32_t)spot_age_filter_minutes * 60U;
+    for (size_t row = 0; row < spots_displayed; ++row) {
+        size_t src = spots_row_source[row];
+        if (max_age > 0 && hamview_backend_snapshot_spot_age(snap, src) > max_age) {
+            return false;
+        }
+    }
+    for (size_t row = 0; row < spots_displayed; ++row) {
+        size_t src = spots_row_source[row];
+        char location_buf[96];
+        char comment_buf[192];
+        format_spot_comment(&snap->spots[src], hamview_backend_snapshot_spot_age(snap, src),
+                            current_row_info[row].is_priority, location_buf, sizeof(location_buf),
+                            comment_buf, sizeof(comment_buf));
+        set_spot_cell(row, 4, comment_buf);
+    }
+    return true;
+}
+
+/* Returns true when the table was rebuilt from a new snapshot generation. */
+static bool render_spots_table(const hamview_backend_snapshot_t *snap)
+{
+    if (!table || !snap) return false;
+
+    bool generation_changed = snap->generation != spots_rendered_generation;
+    if (!generation_changed && !spots_table_force && refresh_spot_ages(snap)) {
+        return false;
     }
 
     size_t display_index = 0;
-    for (size_t i = 0; i < count && display_index < HAMVIEW_MAX_SPOTS; ++i) {
+    for (size_t i = 0; i < snap->spot_count && display_index < HAMVIEW_MAX_SPOTS; ++i) {
+        const hamview_spot_t *spot = &snap->spots[i];
+        uint32_t age_seconds = hamview_backend_snapshot_spot_age(snap, i);
         spot_row_info_t info = {0};
-        if (!spot_passes_filters(&spots[i], &info)) {
+        if (!spot_passes_filters(spot, age_seconds, &info)) {
             continue;
         }
         current_row_info[display_index] = info;
         current_row_info[display_index].occupied = true;
+        spots_row_source[display_index] = (uint8_t)i;
 
         char call_buf[48];
         if (info.is_priority) {
-            snprintf(call_buf, sizeof(call_buf), LV_SYMBOL_WARNING " %s", spots[i].callsign);
-        } else if (spots[i].is_new) {
-            snprintf(call_buf, sizeof(call_buf), LV_SYMBOL_BELL " %s", spots[i].callsign);
+            snprintf(call_buf, sizeof(call_buf), LV_SYMBOL_WARNING " %s", spot->callsign);
+        } else if (spot->is_new) {
+            snprintf(call_buf, sizeof(call_buf), LV_SYMBOL_BELL " %s", spot->callsign);
         } else {
-            strlcpy(call_buf, spots[i].callsign, sizeof(call_buf));
-        }
-
-        char location_buf[96] = "";
-        if (spots[i].state[0] && spots[i].country[0]) {
-            snprintf(location_buf, sizeof(location_buf), "%s, %s", spots[i].state, spots[i].country);
-        } else if (spots[i].state[0]) {
-            strlcpy(location_buf, spots[i].state, sizeof(location_buf));
-        } else if (spots[i].country[0]) {
-            strlcpy(location_buf, spots[i].country, sizeof(location_buf));
-        } else if (spots[i].dxcc[0]) {
-            strlcpy(location_buf, spots[i].dxcc, sizeof(location_buf));
+            strlcpy(call_buf, spot->callsign, sizeof(call_buf));
         }
 
-        const char *alert_prefix = info.is_priority ? "[ALERT] " : "";
+        char location_buf[96];
         char comment_buf[192];
-        if (spots[i].comment[0] && location_buf[0]) {
-            snprintf(comment_buf, sizeof(comment_buf), "%s%s  |  %s  |  Age %lus", alert_prefix, spots[i].comment, location_buf, (unsigned long)spots[i].age_seconds);
-        } else if (spots[i].comment[0]) {
-            snprintf(comment_buf, sizeof(comment_buf), "%s%s  |  Age %lus", alert_prefix, spots[i].comment, (unsigned long)spots[i].age_seconds);
-        } else if (location_buf[0]) {
-            snprintf(comment_buf, sizeof(comment_buf), "%s%s  |  Age %lus", alert_prefix, location_buf, (unsigned long)spots[i].age_seconds);
-        } else {
-            snprintf(comment_buf, sizeof(comment_buf), "%sAge %lus", alert_prefix, (unsigned long)spots[i].age_seconds);
-        }
-
-        size_t row = display_index + 1;
-        lv_table_set_cell_value(table, row, 0, call_buf);
-        lv_table_set_cell_value(table, row, 1, spots[i].frequency);
-        lv_table_set_cell_value(table, row, 2, spots[i].mode);
-        lv_table_set_cell_value(table, row, 3, spots[i].spotter);
-        lv_table_set_cell_value(table, row, 4, comment_buf);
-        if (spots[i].is_new && info.is_priority) {
+        format_spot_comment(spot, age_seconds, info.is_priority, location_buf, sizeof(location_buf),
+                            comment_buf, sizeof(comment_buf));
+
+        set_spot_cell(display_index, 0, call_buf);
+        set_spot_cell(display_index, 1, spot->frequency);
+        set_spot_cell(display_index, 2, spot->mode);
+        set_spot_cell(display_index, 3, spot->spotter);
+        set_spot_cell(display_index, 4, comment_buf);
+        if (generation_changed && spot->is_new && info.is_priority) {
             if (location_buf[0]) {
-                set_message("Alert: %s on %s %s (%s)", spots[i].callsign, spots[i].frequency, spots[i].mode, location_buf);
+                set_message("Alert: %s on %s %s (%s)", spot->callsign, spot->frequency, spot->mode, location_buf);
             } else {
-                set_message("Alert: %s on %s %s", spots[i].callsign, spots[i].frequency, spots[i].mode);
+                set_message("Alert: %s on %s %s", spot->callsign, spot->frequency, spot->mode);
             }
         }
         ++display_index;
     }
 
     for (size_t i = display_index; i < HAMVIEW_MAX_SPOTS; ++i) {
-        size_t row = i + 1;
-        for (int col = 0; col < 5; ++col) {
-            lv_table_set_cell_value(table, row, col, "");
+        for (int col = 0; col < SPOTS_TABLE_COLS; ++col) {
+            set_spot_cell(i, col, "");
         }
         current_row_info[i].occupied = false;
     }
+    spots_displayed = display_index;
 
     if (message_label) {
         const char *existing = lv_label_get_text(message_label);
@@ -2912,7 +3406,19 @@ static void update_spots_table_internal(void)
         }
     }
 
-    update_activity_charts();
+    spots_table_force = false;
+    if (generation_changed) {
+        spots_rendered_generation = snap->generation;
+        update_activity_charts();
+    }
+    return true;
+}
+
+static void update_spots_table_internal(void)
+{
+    const hamview_backend_snapshot_t *snap = hamview_backend_snapshot_acquire();
+    render_spots_table(snap);
+    hamview_backend_snapshot_release(snap);
 }
 
 static void update_spots_table_async(void *param)
@@ -2923,6 +3429,7 @@ static void update_spots_table_async(void *param)
 
 static void update_spots_table(void)
 {
+    spots_table_force = true;
     if (!lv_port_is_in_lvgl_task()) {
         lv_async_call(update_spots_table_async, NULL);
         return;
@@ -2930,7 +3437,7 @@ static void update_spots_table(void)
     update_spots_table_internal();
 }
 
-static bool spot_passes_filters(const hamview_spot_t *spot, spot_row_info_t *info_out)
+static bool spot_passes_filters(const hamview_spot_t *spot, uint32_t age_seconds, spot_row_info_t *info_out)
 {
     if (!spot) {
         return false;
@@ -2938,7 +3445,7 @@ static bool spot_passes_filters(const hamview_spot_t *spot, spot_row_info_t *inf
 
     if (spot_age_filter_minutes > 0) {
         uint32_t max_age = (uint32_t)spot_age_filter_minutes * 60U;
-        if (spot->age_seconds > max_age) {
+        if (age_seconds > max_age) {
             return false;
         }
     }
@@ -3024,19 +3531,23 @@ static void update_status_labels(void)
 {
     hamview_status_t status;
     hamview_backend_get_status(&status);
+    render_status_labels(&status);
+}
 
+static void render_status_labels(const hamview_status_t *status)
+{
     if (wifi_status_label) {
-        const char *symbol = status.wifi_connected ? LV_SYMBOL_OK : LV_SYMBOL_CLOSE;
+        const char *symbol = status->wifi_connected ? LV_SYMBOL_OK : LV_SYMBOL_CLOSE;
         char wifi_text[32];
         snprintf(wifi_text, sizeof(wifi_text), "%s Wi-Fi", symbol);
         lv_label_set_text(wifi_status_label, wifi_text);
         lv_obj_set_style_text_color(wifi_status_label,
-                        status.wifi_connected ? theme_accent_secondary() : theme_error(), 0);
+                        status->wifi_connected ? theme_accent_secondary() : theme_error(), 0);
     }
 
     if (wifi_signal_label) {
         char signal_text[48];
-        if (status.wifi_connected && last_wifi_connected) {
+        if (status->wifi_connected && last_wifi_connected) {
             int bars = 0;
             if (last_wifi_rssi >= -50) {
                 bars = 4;
@@ -3055,26 +3566,26 @@ static void update_status_labels(void)
     }
 
     if (ham_status_label) {
-        const char *symbol = status.hamalert_connected ? LV_SYMBOL_OK : LV_SYMBOL_CLOSE;
+        const char *symbol = status->hamalert_connected ? LV_SYMBOL_OK : LV_SYMBOL_CLOSE;
         char ham_text[48];
-        if (status.hamalert_connected) {
+        if (status->hamalert_connected) {
             snprintf(ham_text, sizeof(ham_text), "%s HamAlert Connected", symbol);
         } else {
             snprintf(ham_text, sizeof(ham_text), "%s HamAlert", symbol);
         }
         lv_label_set_text(ham_status_label, ham_text);
         lv_obj_set_style_text_color(ham_status_label,
-                                    status.hamalert_connected ? theme_accent_secondary() : theme_error(), 0);
+                                    status->hamalert_connected ? theme_accent_secondary() : theme_error(), 0);
     }
 
-    if (strlen(status.last_error) > 0) {
-        lv_label_set_text(error_label, status.last_error);
+    if (strlen(status->last_error) > 0) {
+        lv_label_set_text(error_label, status->last_error);
         set_label_error(error_label);
     } else {
         lv_label_set_text(error_label, "");
     }
 
-    if (!status.hamalert_connected) {
+    if (!status->hamalert_connected) {
         set_message("Configure HamAlert credentials via Settings");
     }
 }
@@ -3160,38 +3671,44 @@ static void update_weather_panel(void)
         return;
     }
 
+    /* Weather changes every few minutes at most; nothing to do until the
+     * data or one of the display toggles moves. */
+    uint32_t generation = hamview_weather_generation();
+    if (weather_rendered_valid && generation == weather_rendered_generation &&
+        weather_show_celsius == weather_rendered_celsius && time_use_24h == weather_rendered_24h) {
+        return;
+    }
+    weather_rendered_valid = true;
+    weather_rendered_generation = generation;
+    weather_rendered_celsius = weather_show_celsius;
+    weather_rendered_24h = time_use_24h;
+
     hamview_weather_info_t info;
     memset(&info, 0, sizeof(info));
     bool have_info = hamview_weather_get(&info);
 
     if (!have_info || !info.has_data) {
-        lv_label_set_text(weather_location_label, "Weather: configure ZIP in Settings");
-        lv_label_set_text(weather_condition_label, info.last_error[0] ? info.last_error : "Waiting for weather data...");
-        lv_label_set_text(weather_temp_label, "--");
-        lv_label_set_text(weather_extra_label, "Humidity: --    Wind: --");
-        lv_label_set_text(weather_updated_label, "Updated: --");
-        if (weather_sun_label) {
-            lv_label_set_text(weather_sun_label, "Sunrise: --   Sunset: --");
-        }
+        set_label_text_if_changed(weather_location_label, "Weather: configure ZIP in Settings");
+        set_label_text_if_changed(weather_condition_label, info.last_error[0] ? info.last_error : "Waiting for weather data...");
+        set_label_text_if_changed(weather_temp_label, "--");
+        set_label_text_if_changed(weather_extra_label, "Humidity: --    Wind: --");
+        set_label_text_if_changed(weather_updated_label, "Updated: --");
+        set_label_text_if_changed(weather_sun_label, "Sunrise: --   Sunset: --");
         if (weather_warning_label) {
-            lv_label_set_text(weather_warning_label, "Warnings: --");
+            set_label_text_if_changed(weather_warning_label, "Warnings: --");
             set_label_warning(weather_warning_label);
         }
         if (weather_forecast_label) {
-            lv_label_set_text(weather_forecast_label, "Hourly forecast unavailable");
+            set_label_text_if_changed(weather_forecast_label, "Hourly forecast unavailable");
             set_label_muted(weather_forecast_label);
         }
 
-        lv_obj_clean(weather_alerts_container);
-        lv_obj_t *alerts_title = lv_label_create(weather_alerts_container);
-        lv_obj_set_style_text_font(alerts_title, &lv_font_montserrat_18, 0);
-        set_label_primary(alerts_title);
-        lv_label_set_text(alerts_title, "Alerts");
-
-        lv_obj_t *placeholder = lv_label_create(weather_alerts_container);
-        lv_obj_set_style_text_font(placeholder, &lv_font_montserrat_16, 0);
-        set_label_muted(placeholder);
-        lv_label_set_text(placeholder, "No alerts available");
+        set_label_text_if_changed(weather_alerts_placeholder, "No alerts available");
+        set_obj_visible(weather_alerts_placeholder, true);
+        for (size_t i = 0; i < HAMVIEW_WEATHER_MAX_ALERTS; ++i) {
+            set_obj_visible(weather_alert_labels[i], false);
+        }
+        set_obj_visible(weather_alerts_error_label, false);
         return;
     }
 
@@ -3201,10 +3718,10 @@ static void update_weather_panel(void)
     } else {
         snprintf(location_buf, sizeof(location_buf), "Weather");
     }
-    lv_label_set_text(weather_location_label, location_buf);
+    set_label_text_if_changed(weather_location_label, location_buf);
 
     if (weather_condition_label) {
-        lv_label_set_text(weather_condition_label, info.condition[0] ? info.condition : "Condition unavailable");
+        set_label_text_if_changed(weather_condition_label, info.condition[0] ? info.condition : "Condition unavailable");
     }
 
     if (weather_temp_label) {
@@ -3218,7 +3735,7 @@ static void update_weather_panel(void)
         } else {
             snprintf(temp_buf, sizeof(temp_buf), "--");
         }
-        lv_label_set_text(weather_temp_label, temp_buf);
+        set_label_text_if_changed(weather_temp_label, temp_buf);
     }
 
     if (weather_extra_label) {
@@ -3226,7 +3743,7 @@ static void update_weather_panel(void)
         snprintf(extra_buf, sizeof(extra_buf), "Humidity: %s    Wind: %s",
                  info.humidity[0] ? info.humidity : "--",
                  info.wind_mph[0] ? info.wind_mph : "--");
-        lv_label_set_text(weather_extra_label, extra_buf);
+        set_label_text_if_changed(weather_extra_label, extra_buf);
     }
 
     if (weather_sun_label) {
@@ -3253,7 +3770,7 @@ static void update_weather_panel(void)
         } else {
             snprintf(sun_buf, sizeof(sun_buf), "Sunrise: --   Sunset: --");
         }
-        lv_label_set_text(weather_sun_label, sun_buf);
+        set_label_text_if_changed(weather_sun_label, sun_buf);
     }
 
     if (weather_warning_label) {
@@ -3268,10 +3785,10 @@ static void update_weather_panel(void)
             } else {
                 snprintf(warn_buf, sizeof(warn_buf), "%s Warnings: %s", LV_SYMBOL_WARNING, light_text ? light_text : "");
             }
-            lv_label_set_text(weather_warning_label, warn_buf);
+            set_label_text_if_changed(weather_warning_label, warn_buf);
             lv_obj_set_style_text_color(weather_warning_label, theme_error(), 0);
         } else {
-            lv_label_set_text(weather_warning_label, "Warnings: none");
+            set_label_text_if_changed(weather_warning_label, "Warnings: none");
             lv_obj_set_style_text_color(weather_warning_label, theme_accent_primary(), 0);
         }
     }
@@ -3308,10 +3825,10 @@ static void update_weather_panel(void)
                     }
                 }
             }
-            lv_label_set_text(weather_forecast_label, forecast_buf);
+            set_label_text_if_changed(weather_forecast_label, forecast_buf);
             set_label_secondary(weather_forecast_label);
         } else {
-            lv_label_set_text(weather_forecast_label, "Hourly forecast not available");
+            set_label_text_if_changed(weather_forecast_label, "Hourly forecast not available");
             set_label_muted(weather_forecast_label);
         }
     }
@@ -3323,35 +3840,23 @@ static void update_weather_panel(void)
         } else {
             snprintf(updated_buf, sizeof(updated_buf), "Updated: --");
         }
-        lv_label_set_text(weather_updated_label, updated_buf);
+        set_label_text_if_changed(weather_updated_label, updated_buf);
     }
 
-    lv_obj_clean(weather_alerts_container);
-
-    lv_obj_t *alerts_title = lv_label_create(weather_alerts_container);
-    lv_obj_set_style_text_font(alerts_title, &lv_font_montserrat_18, 0);
-    lv_label_set_text(alerts_title, "Alerts");
-
-    if (info.alert_count == 0) {
-        lv_obj_t *placeholder = lv_label_create(weather_alerts_container);
-        lv_obj_set_style_text_font(placeholder, &lv_font_montserrat_16, 0);
-        set_label_muted(placeholder);
-        lv_label_set_text(placeholder, "No active alerts");
-    } else {
-        for (size_t idx = 0; idx < info.alert_count && idx < 3; ++idx) {
-            lv_obj_t *alert_label = lv_label_create(weather_alerts_container);
-            lv_obj_set_style_text_font(alert_label, &lv_font_montserrat_16, 0);
-            set_label_secondary(alert_label);
-            lv_label_set_text(alert_label, info.alerts[idx]);
+    set_label_text_if_changed(weather_alerts_placeholder, "No active alerts");
+    set_obj_visible(weather_alerts_placeholder, info.alert_count == 0);
+    for (size_t idx = 0; idx < HAMVIEW_WEATHER_MAX_ALERTS; ++idx) {
+        bool used = idx < info.alert_count;
+        if (used) {
+            set_label_text_if_changed(weather_alert_labels[idx], info.alerts[idx]);
         }
+        set_obj_visible(weather_alert_labels[idx], used);
     }
 
     if (info.last_error[0]) {
-        lv_obj_t *warning = lv_label_create(weather_alerts_container);
-        lv_obj_set_style_text_font(warning, &lv_font_montserrat_14, 0);
-        set_label_warning(warning);
-        lv_label_set_text(warning, info.last_error);
+        set_label_text_if_changed(weather_alerts_error_label, info.last_error);
     }
+    set_obj_visible(weather_alerts_error_label, info.last_error[0] != '\0');
 }
 
 static bool format_event_log_timestamp(uint32_t epoch, char *out, size_t out_size)
@@ -3593,6 +4098,10 @@ void hamview_ui_init(void)
     request_wifi_scan();
 
     if (!refresh_timer) {
-        refresh_timer = lv_timer_create(refresh_timer_cb, 5000, NULL);
+        refresh_timer = lv_timer_create(refresh_timer_cb, SPOTS_REFRESH_PERIOD_MS, NULL);
+    }
+    if (!ic705_strip_timer) {
+        ic705_strip_timer = lv_timer_create(ic705_strip_timer_cb, IC705_STRIP_PERIOD_MS, NULL);
     }
+    lv_port_set_notify_cb(refresh_notify_cb);
 }
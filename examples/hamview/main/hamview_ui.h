@@ -1,7 +1,23 @@
 #ifndef HAMVIEW_UI_H
 #define HAMVIEW_UI_H
 
+#include <stdint.h>
+
+/* Cost of the periodic dashboard refresh. A tick is skipped when the backend
+ * snapshot generation has not moved since the last render. cells_updated and
+ * invalidated_px describe the spots table on the last tick only. */
+typedef struct {
+    uint32_t ticks;
+    uint32_t skipped_ticks;
+    uint32_t cells_updated;
+    uint32_t invalidated_px;
+    uint32_t last_tick_us;
+    uint32_t max_tick_us;
+    uint64_t total_tick_us;
+} hamview_ui_refresh_stats_t;
+
 void hamview_ui_init(void);
 void hamview_ui_show_dashboard(void);
+void hamview_ui_get_refresh_stats(hamview_ui_refresh_stats_t *out);
 
 #endif
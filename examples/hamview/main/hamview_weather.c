@@ -2,7 +2,9 @@
 
 #include <stdarg.h>
 #include <ctype.h>
+#include <inttypes.h>
 #include <math.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -15,12 +17,16 @@
 #include "freertos/task.h"
 
 #include "cJSON.h"
+#include "esp_crc.h"
 #include "esp_event.h"
 #include "esp_http_client.h"
 #include "esp_log.h"
 #include "esp_netif.h"
 #include "esp_sntp.h"
+#include "esp_timer.h"
+#include "nvs.h"
 
+#include "hamview_json.h"
 #include "hamview_settings.h"
 #include "indicator/config.h"
 #include "indicator/view_data.h"
@@ -32,10 +38,19 @@ extern esp_err_t esp_crt_bundle_attach(void *conf);
 #define WEATHER_EVENT_FETCH    (1 << 0)
 #define WEATHER_EVENT_SETTINGS (1 << 1)
 
+/* Servers drop idle keep-alive connections after about a minute anyway, so
+ * ours are closed (freeing the TLS context) after this much idle time. */
+#define WEATHER_SESSION_IDLE_MS 45000
+#define WEATHER_HTTP_CHUNK 1024
+#define WEATHER_BODY_MAX (32 * 1024)
+#define WEATHER_ISO_LEN 20
+#define GEO_CACHE_NAMESPACE "hamview_geo"
+
 static const char *TAG = "hamview_weather";
 
 static SemaphoreHandle_t s_info_mutex;
 static hamview_weather_info_t s_info;
+static atomic_uint s_info_generation;
 static EventGroupHandle_t s_weather_events;
 static TaskHandle_t s_weather_task;
 static bool s_wifi_connected = false;
@@ -43,22 +58,80 @@ static bool s_has_ip = false;
 static bool s_sntp_started = false;
 static bool s_time_synced = false;
 
+/* One HTTP client per host, reused across requests so consecutive fetches
+ * ride the same TLS connection. Only the weather task touches these. */
+typedef struct {
+    const char *host;
+    esp_http_client_handle_t client;
+    bool connected;
+    int64_t last_used_us;
+} weather_session_t;
+
+static weather_session_t s_sessions[] = {
+    { .host = "api.open-meteo.com" },
+    { .host = "geocoding-api.open-meteo.com" },
+};
+static uint32_t s_tls_handshakes;
+
+typedef struct {
+    char query[64];
+    double latitude;
+    double longitude;
+    char display_name[64];
+} geo_cache_entry_t;
+
+static geo_cache_entry_t s_geo_cache;
+static bool s_geo_cache_valid;
+
+typedef bool (*weather_body_cb_t)(const char *data, size_t len, void *ctx);
+
+/* Forecast fields kept while the response streams past: current
+ * conditions, a window of HAMVIEW_WEATHER_HOURLY_COUNT hourly slots indexed
+ * by hour % HAMVIEW_WEATHER_HOURLY_COUNT, and the first sunrise/sunset
+ * strings. Open-Meteo emits current_weather before hourly and hourly.time
+ * before the value arrays, so the window is fixed before values arrive. */
+typedef struct {
+    hamview_json_reader_t reader;
+    hamview_weather_info_t *info;
+    bool has_current;
+    char current_time[WEATHER_ISO_LEN];
+    double current_temp_f;
+    double current_wind_mph;
+    int current_code;
+    double current_humidity;
+    double current_apparent;
+    uint32_t hour_count;
+    uint32_t window_start;
+    bool window_found;
+    int32_t current_hour;
+    char hour_time[HAMVIEW_WEATHER_HOURLY_COUNT][WEATHER_ISO_LEN];
+    double hour_temp[HAMVIEW_WEATHER_HOURLY_COUNT];
+    double hour_apparent[HAMVIEW_WEATHER_HOURLY_COUNT];
+    double hour_precip[HAMVIEW_WEATHER_HOURLY_COUNT];
+    double hour_wind[HAMVIEW_WEATHER_HOURLY_COUNT];
+    int hour_code[HAMVIEW_WEATHER_HOURLY_COUNT];
+    size_t sunrise_count;
+    size_t sunset_count;
+    char sunrise[HAMVIEW_WEATHER_SUN_TIMES][WEATHER_ISO_LEN];
+    char sunset[HAMVIEW_WEATHER_SUN_TIMES][WEATHER_ISO_LEN];
+} weather_forecast_t;
+
 static void ensure_sntp_started(void);
 static void update_time_sync_flag(bool synced);
 static bool url_encode_component(const char *src, char *dst, size_t dst_len);
+static esp_err_t weather_http_get(const char *url, weather_body_cb_t on_body, void *ctx, int *out_status);
 static char *http_get_json(const char *url, int *out_status);
 static const char *weather_code_to_text(int code);
 static void format_temperature(char *dst, size_t dst_len, double value, char unit);
 static void format_percentage(char *dst, size_t dst_len, double value);
 static void format_speed(char *dst, size_t dst_len, double value);
 static void format_observation_time(const char *iso8601, char *dst, size_t dst_len);
-static bool find_hourly_value(cJSON *hourly, const char *field_name, const char *target_time, double *out_value);
 static esp_err_t geocode_location(const char *query, double *out_lat, double *out_lon, char *display_name, size_t display_len);
 static void fetch_weather_alerts(double latitude, double longitude, hamview_weather_info_t *info);
 static bool parse_local_iso8601(const char *iso, int *year, int *month, int *day, int *hour, int *minute, int *second);
 static bool local_datetime_to_epoch(int year, int month, int day, int hour, int minute, int second, int offset_minutes, uint32_t *epoch_out);
-static void populate_sun_times(cJSON *daily, int offset_minutes, hamview_weather_info_t *info);
-static void populate_hourly_forecast(cJSON *hourly, const char *current_time_iso, hamview_weather_info_t *info);
+static void populate_sun_times(const weather_forecast_t *fc, int offset_minutes, hamview_weather_info_t *info);
+static void populate_hourly_forecast(const weather_forecast_t *fc, hamview_weather_info_t *info);
 
 static void update_time_sync_flag(bool synced)
 {
@@ -67,8 +140,12 @@ static void update_time_sync_flag(bool synced)
         return;
     }
     xSemaphoreTake(s_info_mutex, portMAX_DELAY);
+    bool changed = s_info.time_synced != synced;
     s_info.time_synced = synced;
     xSemaphoreGive(s_info_mutex);
+    if (changed) {
+        atomic_fetch_add(&s_info_generation, 1);
+    }
 }
 
 static void time_sync_notification_cb(struct timeval *tv)
@@ -93,89 +170,172 @@ static void ensure_sntp_started(void)
     ESP_LOGI(TAG, "SNTP started using time.nist.gov");
 }
 
-static char *http_get_json(const char *url, int *out_status)
+static weather_session_t *weather_session_for(const char *url)
 {
-    esp_http_client_config_t cfg = {
-        .url = url,
-        .timeout_ms = 12000,
-        .crt_bundle_attach = esp_crt_bundle_attach,
-    };
-
-    esp_http_client_handle_t client = esp_http_client_init(&cfg);
-    if (!client) {
-        if (out_status) {
-            *out_status = -1;
+    const char *host = strstr(url, "://");
+    host = host ? host + 3 : url;
+    size_t host_len = strcspn(host, ":/?");
+    for (size_t i = 0; i < sizeof(s_sessions) / sizeof(s_sessions[0]); ++i) {
+        if (strlen(s_sessions[i].host) == host_len && strncmp(s_sessions[i].host, host, host_len) == 0) {
+            return &s_sessions[i];
         }
-        return NULL;
     }
+    return NULL;
+}
 
-    esp_err_t err = esp_http_client_open(client, 0);
-    if (err != ESP_OK) {
-        esp_http_client_cleanup(client);
-        if (out_status) {
-            *out_status = -1;
+static void weather_session_close(weather_session_t *session)
+{
+    if (session->client && session->connected) {
+        esp_http_client_close(session->client);
+    }
+    session->connected = false;
+}
+
+static bool weather_sessions_connected(void)
+{
+    for (size_t i = 0; i < sizeof(s_sessions) / sizeof(s_sessions[0]); ++i) {
+        if (s_sessions[i].connected) {
+            return true;
         }
-        return NULL;
     }
+    return false;
+}
+
+static void weather_sessions_reap(bool all)
+{
+    int64_t now = esp_timer_get_time();
+    for (size_t i = 0; i < sizeof(s_sessions) / sizeof(s_sessions[0]); ++i) {
+        weather_session_t *session = &s_sessions[i];
+        if (session->connected && (all || now - session->last_used_us >= (int64_t)WEATHER_SESSION_IDLE_MS * 1000)) {
+            weather_session_close(session);
+        }
+    }
+}
+
+/* Streams a GET response body to on_body in WEATHER_HTTP_CHUNK pieces. The
+ * connection stays open when the body was read to the end; a reused
+ * connection the server has dropped in the meantime is retried once. */
+static esp_err_t weather_http_get(const char *url, weather_body_cb_t on_body, void *ctx, int *out_status)
+{
+    if (out_status) {
+        *out_status = -1;
+    }
+    weather_session_t *session = weather_session_for(url);
+    if (!session) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!session->client) {
+        esp_http_client_config_t cfg = {
+            .url = url,
+            .timeout_ms = 12000,
+            .crt_bundle_attach = esp_crt_bundle_attach,
+        };
+        session->client = esp_http_client_init(&cfg);
+        if (!session->client) {
+            return ESP_ERR_NO_MEM;
+        }
+    } else if (esp_http_client_set_url(session->client, url) != ESP_OK) {
+        weather_session_close(session);
+        return ESP_FAIL;
+    }
+    esp_http_client_handle_t client = session->client;
 
-    int status_code = esp_http_client_fetch_headers(client);
-    size_t buf_size = 4096;
-    char *buffer = malloc(buf_size);
-    if (!buffer) {
+    for (int attempt = 0;; ++attempt) {
+        bool reused = session->connected;
+        if (!reused) {
+            s_tls_handshakes++;
+        }
+        esp_err_t err = esp_http_client_open(client, 0);
+        if (err == ESP_OK && esp_http_client_fetch_headers(client) >= 0) {
+            session->connected = true;
+            break;
+        }
         esp_http_client_close(client);
-        esp_http_client_cleanup(client);
-        if (out_status) {
-            *out_status = -1;
+        session->connected = false;
+        if (!reused || attempt > 0) {
+            return (err != ESP_OK) ? err : ESP_FAIL;
         }
-        return NULL;
+        ESP_LOGD(TAG, "stale connection to %s, reconnecting", session->host);
+    }
+
+    int status_code = esp_http_client_get_status_code(client);
+    if (out_status) {
+        *out_status = status_code;
+    }
+    if (status_code != 200) {
+        weather_session_close(session);
+        return ESP_FAIL;
     }
 
-    size_t read_len = 0;
+    char *chunk = malloc(WEATHER_HTTP_CHUNK);
+    if (!chunk) {
+        weather_session_close(session);
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t result = ESP_OK;
     while (true) {
-        if (read_len >= buf_size - 1) {
-            size_t new_size = buf_size * 2;
-            char *tmp = realloc(buffer, new_size);
-            if (!tmp) {
-                free(buffer);
-                esp_http_client_close(client);
-                esp_http_client_cleanup(client);
-                if (out_status) {
-                    *out_status = -1;
-                }
-                return NULL;
-            }
-            buffer = tmp;
-            buf_size = new_size;
-        }
-        int r = esp_http_client_read(client, buffer + read_len, buf_size - read_len - 1);
+        int r = esp_http_client_read(client, chunk, WEATHER_HTTP_CHUNK);
         if (r < 0) {
-            free(buffer);
-            esp_http_client_close(client);
-            esp_http_client_cleanup(client);
-            if (out_status) {
-                *out_status = -1;
-            }
-            return NULL;
+            result = ESP_FAIL;
+            break;
         }
         if (r == 0) {
             break;
         }
-        read_len += r;
+        if (!on_body(chunk, (size_t)r, ctx)) {
+            result = ESP_ERR_INVALID_RESPONSE;
+            break;
+        }
     }
-    buffer[read_len] = '\0';
+    free(chunk);
 
-    status_code = esp_http_client_get_status_code(client);
-    esp_http_client_close(client);
-    esp_http_client_cleanup(client);
-    if (out_status) {
-        *out_status = status_code;
+    if (result != ESP_OK || !esp_http_client_is_complete_data_received(client)) {
+        weather_session_close(session);
+    } else {
+        session->last_used_us = esp_timer_get_time();
     }
+    return result;
+}
 
-    if (status_code != 200) {
-        free(buffer);
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t cap;
+} weather_body_t;
+
+static bool weather_body_append(const char *data, size_t len, void *ctx)
+{
+    weather_body_t *body = (weather_body_t *)ctx;
+    if (body->len + len + 1 > body->cap) {
+        size_t cap = body->cap ? body->cap : 2048;
+        while (cap < body->len + len + 1) {
+            cap *= 2;
+        }
+        if (cap > WEATHER_BODY_MAX) {
+            return false;
+        }
+        char *tmp = realloc(body->buf, cap);
+        if (!tmp) {
+            return false;
+        }
+        body->buf = tmp;
+        body->cap = cap;
+    }
+    memcpy(body->buf + body->len, data, len);
+    body->len += len;
+    body->buf[body->len] = '\0';
+    return true;
+}
+
+/* Whole-body fetch for the small geocoding and warnings responses. */
+static char *http_get_json(const char *url, int *out_status)
+{
+    weather_body_t body = {0};
+    if (weather_http_get(url, weather_body_append, &body, out_status) != ESP_OK || !body.buf) {
+        free(body.buf);
         return NULL;
     }
-    return buffer;
+    return body.buf;
 }
 
 static bool url_encode_component(const char *src, char *dst, size_t dst_len)
@@ -260,37 +420,6 @@ static void format_observation_time(const char *iso8601, char *dst, size_t dst_l
     strlcpy(dst, iso8601, dst_len);
 }
 
-static bool find_hourly_value(cJSON *hourly, const char *field_name, const char *target_time, double *out_value)
-{
-    if (!hourly || !field_name || !target_time || !out_value) {
-        return false;
-    }
-    cJSON *time_arr = cJSON_GetObjectItem(hourly, "time");
-    cJSON *value_arr = cJSON_GetObjectItem(hourly, field_name);
-    if (!cJSON_IsArray(time_arr) || !cJSON_IsArray(value_arr)) {
-        return false;
-    }
-    int count = cJSON_GetArraySize(time_arr);
-    if (cJSON_GetArraySize(value_arr) != count) {
-        return false;
-    }
-    for (int i = 0; i < count; ++i) {
-        cJSON *time_item = cJSON_GetArrayItem(time_arr, i);
-        if (!cJSON_IsString(time_item) || !time_item->valuestring) {
-            continue;
-        }
-        if (strcmp(time_item->valuestring, target_time) == 0) {
-            cJSON *value_item = cJSON_GetArrayItem(value_arr, i);
-            if (cJSON_IsNumber(value_item)) {
-                *out_value = value_item->valuedouble;
-                return true;
-            }
-            break;
-        }
-    }
-    return false;
-}
-
 static const char *weather_code_to_text(int code)
 {
     switch (code) {
@@ -423,6 +552,75 @@ static esp_err_t geocode_location(const char *query, double *out_lat, double *ou
     return ESP_OK;
 }
 
+static void geo_cache_key(const char *query, char *key, size_t key_len)
+{
+    snprintf(key, key_len, "z%08" PRIx32, esp_crc32_le(0, (const uint8_t *)query, strlen(query)));
+}
+
+static bool geo_cache_load(const char *query, geo_cache_entry_t *out)
+{
+    nvs_handle_t handle;
+    if (nvs_open(GEO_CACHE_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+    char key[16];
+    geo_cache_key(query, key, sizeof(key));
+    size_t len = sizeof(*out);
+    esp_err_t err = nvs_get_blob(handle, key, out, &len);
+    nvs_close(handle);
+    if (err != ESP_OK || len != sizeof(*out)) {
+        return false;
+    }
+    out->query[sizeof(out->query) - 1] = '\0';
+    out->display_name[sizeof(out->display_name) - 1] = '\0';
+    return strcmp(out->query, query) == 0;
+}
+
+static void geo_cache_store(const geo_cache_entry_t *entry)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(GEO_CACHE_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "geocode cache open failed: %s", esp_err_to_name(err));
+        return;
+    }
+    char key[16];
+    geo_cache_key(entry->query, key, sizeof(key));
+    err = nvs_set_blob(handle, key, entry, sizeof(*entry));
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "geocode cache write failed: %s", esp_err_to_name(err));
+    }
+}
+
+/* A ZIP always geocodes to the same place, so each one is looked up once
+ * and remembered in RAM and NVS (keyed by a hash of the query). */
+static esp_err_t geocode_cached(const char *query, double *out_lat, double *out_lon, char *display_name, size_t display_len)
+{
+    if (!s_geo_cache_valid || strcmp(s_geo_cache.query, query) != 0) {
+        geo_cache_entry_t entry;
+        if (!geo_cache_load(query, &entry)) {
+            memset(&entry, 0, sizeof(entry));
+            strlcpy(entry.query, query, sizeof(entry.query));
+            esp_err_t err = geocode_location(query, &entry.latitude, &entry.longitude,
+                                             entry.display_name, sizeof(entry.display_name));
+            if (err != ESP_OK) {
+                return err;
+            }
+            geo_cache_store(&entry);
+        }
+        s_geo_cache = entry;
+        s_geo_cache_valid = true;
+    }
+    *out_lat = s_geo_cache.latitude;
+    *out_lon = s_geo_cache.longitude;
+    strlcpy(display_name, s_geo_cache.display_name, display_len);
+    return ESP_OK;
+}
+
 static void fetch_weather_alerts(double latitude, double longitude, hamview_weather_info_t *info)
 {
     if (!info) {
@@ -452,7 +650,7 @@ static void fetch_weather_alerts(double latitude, double longitude, hamview_weat
         size_t idx = 0;
         cJSON *entry = NULL;
         cJSON_ArrayForEach(entry, warnings) {
-            if (idx >= 3) {
+            if (idx >= HAMVIEW_WEATHER_MAX_ALERTS) {
                 break;
             }
             const char *headline = NULL;
@@ -569,9 +767,9 @@ static bool local_datetime_to_epoch(int year, int month, int day, int hour, int
     return true;
 }
 
-static void populate_sun_times(cJSON *daily, int offset_minutes, hamview_weather_info_t *info)
+static void populate_sun_times(const weather_forecast_t *fc, int offset_minutes, hamview_weather_info_t *info)
 {
-    if (!daily || !info) {
+    if (!fc || !info) {
         return;
     }
 
@@ -582,40 +780,15 @@ static void populate_sun_times(cJSON *daily, int offset_minutes, hamview_weather
     memset(info->sunrise_minutes, 0, sizeof(info->sunrise_minutes));
     memset(info->sunset_minutes, 0, sizeof(info->sunset_minutes));
 
-    if (!cJSON_IsObject(daily)) {
-        return;
-    }
-    cJSON *sunrise_arr = cJSON_GetObjectItem(daily, "sunrise");
-    cJSON *sunset_arr = cJSON_GetObjectItem(daily, "sunset");
-    if (!cJSON_IsArray(sunrise_arr) || !cJSON_IsArray(sunset_arr)) {
-        return;
-    }
-
-    int sunrise_count = cJSON_GetArraySize(sunrise_arr);
-    int sunset_count = cJSON_GetArraySize(sunset_arr);
-    if (sunrise_count <= 0 || sunset_count <= 0) {
-        return;
-    }
-
-    int count = sunrise_count < sunset_count ? sunrise_count : sunset_count;
-    if (count > (int)HAMVIEW_WEATHER_SUN_TIMES) {
-        count = (int)HAMVIEW_WEATHER_SUN_TIMES;
-    }
-
-    for (int i = 0; i < count; ++i) {
-        cJSON *sunrise_item = cJSON_GetArrayItem(sunrise_arr, i);
-        cJSON *sunset_item = cJSON_GetArrayItem(sunset_arr, i);
-        if (!cJSON_IsString(sunrise_item) || !cJSON_IsString(sunset_item)) {
-            continue;
-        }
-
+    size_t count = fc->sunrise_count < fc->sunset_count ? fc->sunrise_count : fc->sunset_count;
+    for (size_t i = 0; i < count; ++i) {
         int sr_year = 0;
         int sr_month = 0;
         int sr_day = 0;
         int sr_hour = 0;
         int sr_min = 0;
         int sr_sec = 0;
-        if (!parse_local_iso8601(sunrise_item->valuestring, &sr_year, &sr_month, &sr_day, &sr_hour, &sr_min, &sr_sec)) {
+        if (!parse_local_iso8601(fc->sunrise[i], &sr_year, &sr_month, &sr_day, &sr_hour, &sr_min, &sr_sec)) {
             continue;
         }
 
@@ -625,7 +798,7 @@ static void populate_sun_times(cJSON *daily, int offset_minutes, hamview_weather
         int ss_hour = 0;
         int ss_min = 0;
         int ss_sec = 0;
-        if (!parse_local_iso8601(sunset_item->valuestring, &ss_year, &ss_month, &ss_day, &ss_hour, &ss_min, &ss_sec)) {
+        if (!parse_local_iso8601(fc->sunset[i], &ss_year, &ss_month, &ss_day, &ss_hour, &ss_min, &ss_sec)) {
             continue;
         }
 
@@ -652,61 +825,175 @@ static void populate_sun_times(cJSON *daily, int offset_minutes, hamview_weather
     info->sun_times_valid = info->sun_times_count > 0;
 }
 
-static void populate_hourly_forecast(cJSON *hourly, const char *current_time_iso, hamview_weather_info_t *info)
+/* Without a usable current time the newest hours are shown, as before. */
+static uint32_t forecast_window_start(const weather_forecast_t *fc)
 {
-    if (!hourly || !info) {
-        return;
+    if (fc->window_found) {
+        return fc->window_start;
     }
+    return (fc->hour_count > HAMVIEW_WEATHER_HOURLY_COUNT) ? fc->hour_count - HAMVIEW_WEATHER_HOURLY_COUNT : 0;
+}
 
-    info->forecast_valid = false;
-    info->forecast_count = 0;
-    memset(info->forecast, 0, sizeof(info->forecast));
+static bool forecast_slot(const weather_forecast_t *fc, uint32_t hour, size_t *slot)
+{
+    uint32_t start = forecast_window_start(fc);
+    if (hour < start || hour >= fc->hour_count || hour - start >= HAMVIEW_WEATHER_HOURLY_COUNT) {
+        return false;
+    }
+    *slot = hour % HAMVIEW_WEATHER_HOURLY_COUNT;
+    return true;
+}
+
+static void forecast_on_hour_time(weather_forecast_t *fc, uint32_t hour, const char *text)
+{
+    if (!fc->window_found && fc->current_time[0] && strcmp(text, fc->current_time) >= 0) {
+        fc->window_found = true;
+        fc->window_start = hour;
+        if (strcmp(text, fc->current_time) == 0) {
+            fc->current_hour = (int32_t)hour;
+        }
+    }
+    if (hour + 1 > fc->hour_count) {
+        fc->hour_count = hour + 1;
+    }
+    /* Until the window is found the slots hold the newest hours seen. */
+    if (!fc->window_found || hour - fc->window_start < HAMVIEW_WEATHER_HOURLY_COUNT) {
+        strlcpy(fc->hour_time[hour % HAMVIEW_WEATHER_HOURLY_COUNT], text, WEATHER_ISO_LEN);
+    }
+}
 
-    cJSON *time_arr = cJSON_GetObjectItem(hourly, "time");
-    if (!cJSON_IsArray(time_arr)) {
+static void forecast_on_hour_value(weather_forecast_t *fc, const char *field, uint32_t hour, double value)
+{
+    bool current = fc->current_hour >= 0 && hour == (uint32_t)fc->current_hour;
+    if (strcmp(field, "relativehumidity_2m") == 0) {
+        if (current) {
+            fc->current_humidity = value;
+        }
         return;
     }
+    if (current && strcmp(field, "apparent_temperature") == 0) {
+        fc->current_apparent = value;
+    }
 
-    int total = cJSON_GetArraySize(time_arr);
-    if (total <= 0) {
+    size_t slot = 0;
+    if (!forecast_slot(fc, hour, &slot)) {
         return;
     }
+    if (strcmp(field, "temperature_2m") == 0) {
+        fc->hour_temp[slot] = value;
+    } else if (strcmp(field, "apparent_temperature") == 0) {
+        fc->hour_apparent[slot] = value;
+    } else if (strcmp(field, "precipitation_probability") == 0) {
+        fc->hour_precip[slot] = value;
+    } else if (strcmp(field, "windspeed_10m") == 0) {
+        fc->hour_wind[slot] = value;
+    } else if (strcmp(field, "weathercode") == 0) {
+        fc->hour_code[slot] = (int)value;
+    }
+}
 
-    cJSON *temp_arr = cJSON_GetObjectItem(hourly, "temperature_2m");
-    cJSON *apparent_arr = cJSON_GetObjectItem(hourly, "apparent_temperature");
-    cJSON *precip_arr = cJSON_GetObjectItem(hourly, "precipitation_probability");
-    cJSON *code_arr = cJSON_GetObjectItem(hourly, "weathercode");
-    cJSON *wind_arr = cJSON_GetObjectItem(hourly, "windspeed_10m");
+static void forecast_on_value(const hamview_json_reader_t *r, const hamview_json_value_t *value, void *ctx)
+{
+    weather_forecast_t *fc = (weather_forecast_t *)ctx;
+    hamview_weather_info_t *info = fc->info;
+    bool is_number = value->type == HAMVIEW_JSON_NUMBER;
+    bool is_string = value->type == HAMVIEW_JSON_STRING;
+
+    if (r->depth == 1) {
+        if (is_string && strcmp(r->key[0], "timezone") == 0) {
+            strlcpy(info->timezone_name, value->text, sizeof(info->timezone_name));
+            info->timezone_valid = true;
+        } else if (is_number && strcmp(r->key[0], "utc_offset_seconds") == 0) {
+            info->timezone_offset_minutes = (int)value->number / 60;
+            info->timezone_valid = true;
+        }
+        return;
+    }
 
-    int start_idx = 0;
-    bool start_found = false;
-    if (current_time_iso && *current_time_iso) {
-        for (int i = 0; i < total; ++i) {
-            cJSON *time_item = cJSON_GetArrayItem(time_arr, i);
-            if (!cJSON_IsString(time_item) || !time_item->valuestring) {
-                continue;
+    if (r->depth == 2 && strcmp(r->key[0], "current_weather") == 0) {
+        fc->has_current = true;
+        const char *key = r->key[1];
+        if (is_string && strcmp(key, "time") == 0) {
+            strlcpy(fc->current_time, value->text, sizeof(fc->current_time));
+        } else if (is_number && strcmp(key, "temperature") == 0) {
+            fc->current_temp_f = value->number;
+        } else if (is_number && strcmp(key, "windspeed") == 0) {
+            fc->current_wind_mph = value->number;
+        } else if (is_number && strcmp(key, "weathercode") == 0) {
+            fc->current_code = (int)value->number;
+        }
+        return;
+    }
+
+    if (r->depth != 3 || r->container[2] != '[') {
+        return;
+    }
+    uint32_t index = r->index[2];
+    if (strcmp(r->key[0], "hourly") == 0) {
+        if (strcmp(r->key[1], "time") == 0) {
+            if (is_string) {
+                forecast_on_hour_time(fc, index, value->text);
             }
-            int cmp = strcmp(time_item->valuestring, current_time_iso);
-            if (cmp >= 0) {
-                start_idx = i;
-                start_found = true;
-                break;
+        } else if (is_number) {
+            forecast_on_hour_value(fc, r->key[1], index, value->number);
+        }
+    } else if (strcmp(r->key[0], "daily") == 0 && is_string && index < HAMVIEW_WEATHER_SUN_TIMES) {
+        if (strcmp(r->key[1], "sunrise") == 0) {
+            strlcpy(fc->sunrise[index], value->text, WEATHER_ISO_LEN);
+            if (index + 1 > fc->sunrise_count) {
+                fc->sunrise_count = index + 1;
+            }
+        } else if (strcmp(r->key[1], "sunset") == 0) {
+            strlcpy(fc->sunset[index], value->text, WEATHER_ISO_LEN);
+            if (index + 1 > fc->sunset_count) {
+                fc->sunset_count = index + 1;
             }
         }
     }
+}
 
-    if (!start_found) {
-        if (total > HAMVIEW_WEATHER_HOURLY_COUNT) {
-            start_idx = total - HAMVIEW_WEATHER_HOURLY_COUNT;
-        } else {
-            start_idx = 0;
-        }
+static bool forecast_on_body(const char *data, size_t len, void *ctx)
+{
+    weather_forecast_t *fc = (weather_forecast_t *)ctx;
+    return hamview_json_reader_feed(&fc->reader, data, len);
+}
+
+static void forecast_init(weather_forecast_t *fc, hamview_weather_info_t *info)
+{
+    memset(fc, 0, sizeof(*fc));
+    fc->info = info;
+    fc->current_temp_f = NAN;
+    fc->current_wind_mph = NAN;
+    fc->current_code = -1;
+    fc->current_humidity = NAN;
+    fc->current_apparent = NAN;
+    fc->current_hour = -1;
+    for (size_t i = 0; i < HAMVIEW_WEATHER_HOURLY_COUNT; ++i) {
+        fc->hour_temp[i] = NAN;
+        fc->hour_apparent[i] = NAN;
+        fc->hour_precip[i] = NAN;
+        fc->hour_wind[i] = NAN;
+        fc->hour_code[i] = -1;
+    }
+    hamview_json_reader_init(&fc->reader, forecast_on_value, fc);
+}
+
+static void populate_hourly_forecast(const weather_forecast_t *fc, hamview_weather_info_t *info)
+{
+    if (!fc || !info) {
+        return;
     }
 
+    info->forecast_valid = false;
+    info->forecast_count = 0;
+    memset(info->forecast, 0, sizeof(info->forecast));
+
+    uint32_t start = forecast_window_start(fc);
     size_t written = 0;
-    for (int idx = start_idx; idx < total && written < HAMVIEW_WEATHER_HOURLY_COUNT; ++idx) {
-        cJSON *time_item = cJSON_GetArrayItem(time_arr, idx);
-        if (!cJSON_IsString(time_item) || !time_item->valuestring) {
+    for (uint32_t hour = start; hour < fc->hour_count && written < HAMVIEW_WEATHER_HOURLY_COUNT; ++hour) {
+        size_t slot = hour % HAMVIEW_WEATHER_HOURLY_COUNT;
+        const char *time_iso = fc->hour_time[slot];
+        if (!time_iso[0]) {
             continue;
         }
 
@@ -715,25 +1002,16 @@ static void populate_hourly_forecast(cJSON *hourly, const char *current_time_iso
 
         int sr_hour = 0;
         int sr_minute = 0;
-        if (parse_local_iso8601(time_item->valuestring, NULL, NULL, NULL, &sr_hour, &sr_minute, NULL)) {
+        if (parse_local_iso8601(time_iso, NULL, NULL, NULL, &sr_hour, &sr_minute, NULL)) {
             snprintf(entry->time_local, sizeof(entry->time_local), "%02d:%02d", sr_hour, sr_minute);
         } else {
-            strncpy(entry->time_local, time_item->valuestring, sizeof(entry->time_local) - 1);
+            strncpy(entry->time_local, time_iso, sizeof(entry->time_local) - 1);
             entry->time_local[sizeof(entry->time_local) - 1] = '\0';
         }
 
-        double temp_val = NAN;
-        if (cJSON_IsArray(temp_arr)) {
-            cJSON *temp_item = cJSON_GetArrayItem(temp_arr, idx);
-            if (cJSON_IsNumber(temp_item)) {
-                temp_val = temp_item->valuedouble;
-            }
-        }
-        if (!isfinite(temp_val) && cJSON_IsArray(apparent_arr)) {
-            cJSON *temp_item = cJSON_GetArrayItem(apparent_arr, idx);
-            if (cJSON_IsNumber(temp_item)) {
-                temp_val = temp_item->valuedouble;
-            }
+        double temp_val = fc->hour_temp[slot];
+        if (!isfinite(temp_val)) {
+            temp_val = fc->hour_apparent[slot];
         }
         if (isfinite(temp_val)) {
             format_temperature(entry->temp_f, sizeof(entry->temp_f), temp_val, 'F');
@@ -741,23 +1019,14 @@ static void populate_hourly_forecast(cJSON *hourly, const char *current_time_iso
             format_temperature(entry->temp_c, sizeof(entry->temp_c), temp_c, 'C');
         }
 
-        if (cJSON_IsArray(precip_arr)) {
-            cJSON *precip_item = cJSON_GetArrayItem(precip_arr, idx);
-            if (cJSON_IsNumber(precip_item)) {
-                double percent = precip_item->valuedouble;
-                if (percent < 0) percent = 0;
-                if (percent > 100) percent = 100;
-                entry->precip_percent = (uint8_t)(percent + 0.5);
-            }
+        double percent = fc->hour_precip[slot];
+        if (isfinite(percent)) {
+            if (percent < 0) percent = 0;
+            if (percent > 100) percent = 100;
+            entry->precip_percent = (uint8_t)(percent + 0.5);
         }
 
-        double wind_val = NAN;
-        if (cJSON_IsArray(wind_arr)) {
-            cJSON *wind_item = cJSON_GetArrayItem(wind_arr, idx);
-            if (cJSON_IsNumber(wind_item)) {
-                wind_val = wind_item->valuedouble;
-            }
-        }
+        double wind_val = fc->hour_wind[slot];
         if (isfinite(wind_val)) {
             if (wind_val < 0) wind_val = 0;
             if (wind_val > 255) wind_val = 255;
@@ -767,15 +1036,10 @@ static void populate_hourly_forecast(cJSON *hourly, const char *current_time_iso
             }
         }
 
-        if (cJSON_IsArray(code_arr)) {
-            cJSON *code_item = cJSON_GetArrayItem(code_arr, idx);
-            if (cJSON_IsNumber(code_item)) {
-                int code = code_item->valueint;
-                if (code == 95 || code == 96 || code == 99) {
-                    entry->lightning_risk = true;
-                    info->lightning_warning = true;
-                }
-            }
+        int code = fc->hour_code[slot];
+        if (code == 95 || code == 96 || code == 99) {
+            entry->lightning_risk = true;
+            info->lightning_warning = true;
         }
 
         written++;
@@ -797,6 +1061,7 @@ static void set_error(const char *fmt, ...)
     s_info.has_data = false;
     xSemaphoreGive(s_info_mutex);
     va_end(args);
+    atomic_fetch_add(&s_info_generation, 1);
     if (s_info.last_error[0]) {
         hamview_event_log_append("weather", "%s", s_info.last_error);
     }
@@ -808,8 +1073,12 @@ static void clear_error(void)
         return;
     }
     xSemaphoreTake(s_info_mutex, portMAX_DELAY);
+    bool changed = s_info.last_error[0] != '\0';
     s_info.last_error[0] = '\0';
     xSemaphoreGive(s_info_mutex);
+    if (changed) {
+        atomic_fetch_add(&s_info_generation, 1);
+    }
 }
 
 static esp_err_t fetch_weather_now(void)
@@ -840,7 +1109,7 @@ static esp_err_t fetch_weather_now(void)
     double latitude = 0.0;
     double longitude = 0.0;
     char display_location[64];
-    esp_err_t geo_err = geocode_location(search_query, &latitude, &longitude, display_location, sizeof(display_location));
+    esp_err_t geo_err = geocode_cached(search_query, &latitude, &longitude, display_location, sizeof(display_location));
     if (geo_err != ESP_OK) {
         if (geo_err == ESP_ERR_NOT_FOUND) {
             set_error("Location not found");
@@ -860,20 +1129,6 @@ static esp_err_t fetch_weather_now(void)
              "&daily=sunrise,sunset&past_days=1&forecast_days=2",
              latitude, longitude);
 
-    int status = 0;
-    char *payload = http_get_json(forecast_url, &status);
-    if (!payload) {
-        set_error("Forecast HTTP %d", status);
-        return ESP_FAIL;
-    }
-
-    cJSON *root = cJSON_Parse(payload);
-    free(payload);
-    if (!root) {
-        set_error("Forecast parse error");
-        return ESP_FAIL;
-    }
-
     hamview_weather_info_t info = {0};
     info.time_synced = s_time_synced;
     if (s_info_mutex) {
@@ -893,82 +1148,75 @@ static esp_err_t fetch_weather_now(void)
         strlcpy(info.location, location_query, sizeof(info.location));
     }
 
-    cJSON *tz_node = cJSON_GetObjectItem(root, "timezone");
-    if (cJSON_IsString(tz_node) && tz_node->valuestring) {
-        strlcpy(info.timezone_name, tz_node->valuestring, sizeof(info.timezone_name));
-        info.timezone_valid = true;
+    /* The forecast body is parsed as it arrives; only the fields shown are
+     * kept, never the whole document. */
+    weather_forecast_t *fc = malloc(sizeof(*fc));
+    if (!fc) {
+        set_error("Forecast out of memory");
+        return ESP_ERR_NO_MEM;
     }
-    cJSON *offset_node = cJSON_GetObjectItem(root, "utc_offset_seconds");
-    if (cJSON_IsNumber(offset_node)) {
-        info.timezone_offset_minutes = offset_node->valueint / 60;
-        info.timezone_valid = true;
+    forecast_init(fc, &info);
+
+    int status = 0;
+    esp_err_t err = weather_http_get(forecast_url, forecast_on_body, fc, &status);
+    if (err == ESP_OK && !hamview_json_reader_finish(&fc->reader)) {
+        err = ESP_ERR_INVALID_RESPONSE;
     }
+    if (err != ESP_OK) {
+        free(fc);
+        if (err == ESP_ERR_INVALID_RESPONSE) {
+            set_error("Forecast parse error");
+        } else {
+            set_error("Forecast HTTP %d", status);
+        }
+        return ESP_FAIL;
+    }
+
     if (info.timezone_valid) {
         ensure_sntp_started();
     }
 
-    cJSON *current_weather = cJSON_GetObjectItem(root, "current_weather");
-    if (!cJSON_IsObject(current_weather)) {
-        cJSON_Delete(root);
+    if (!fc->has_current) {
+        free(fc);
         set_error("No current weather");
         return ESP_FAIL;
     }
 
-    double temp_f = NAN;
-    cJSON *temp_node = cJSON_GetObjectItem(current_weather, "temperature");
-    if (cJSON_IsNumber(temp_node)) {
-        temp_f = temp_node->valuedouble;
-        format_temperature(info.temperature_f, sizeof(info.temperature_f), temp_f, 'F');
-        double temp_c = (temp_f - 32.0) * (5.0 / 9.0);
+    if (isfinite(fc->current_temp_f)) {
+        format_temperature(info.temperature_f, sizeof(info.temperature_f), fc->current_temp_f, 'F');
+        double temp_c = (fc->current_temp_f - 32.0) * (5.0 / 9.0);
         format_temperature(info.temperature_c, sizeof(info.temperature_c), temp_c, 'C');
     }
 
-    cJSON *wind_node = cJSON_GetObjectItem(current_weather, "windspeed");
-    if (cJSON_IsNumber(wind_node)) {
-        double wind_mph = wind_node->valuedouble;
-        format_speed(info.wind_mph, sizeof(info.wind_mph), wind_mph);
-        if (wind_mph >= 30.0) {
+    if (isfinite(fc->current_wind_mph)) {
+        format_speed(info.wind_mph, sizeof(info.wind_mph), fc->current_wind_mph);
+        if (fc->current_wind_mph >= 30.0) {
             info.high_wind_warning = true;
         }
     }
 
-    const char *time_str = NULL;
-    cJSON *time_node = cJSON_GetObjectItem(current_weather, "time");
-    if (cJSON_IsString(time_node) && time_node->valuestring) {
-        time_str = time_node->valuestring;
-        format_observation_time(time_str, info.observation_time, sizeof(info.observation_time));
+    if (fc->current_time[0]) {
+        format_observation_time(fc->current_time, info.observation_time, sizeof(info.observation_time));
     }
 
-    int weather_code = -1;
-    cJSON *code_node = cJSON_GetObjectItem(current_weather, "weathercode");
-    if (cJSON_IsNumber(code_node)) {
-        weather_code = code_node->valueint;
-        if (weather_code == 95 || weather_code == 96 || weather_code == 99) {
-            info.lightning_warning = true;
-        }
+    int weather_code = fc->current_code;
+    if (weather_code == 95 || weather_code == 96 || weather_code == 99) {
+        info.lightning_warning = true;
     }
     strlcpy(info.condition, weather_code_to_text(weather_code), sizeof(info.condition));
 
-    cJSON *hourly = cJSON_GetObjectItem(root, "hourly");
-    if (cJSON_IsObject(hourly) && time_str) {
-        double humidity = NAN;
-        if (find_hourly_value(hourly, "relativehumidity_2m", time_str, &humidity)) {
-            format_percentage(info.humidity, sizeof(info.humidity), humidity);
-        }
-        double apparent = NAN;
-        if (find_hourly_value(hourly, "apparent_temperature", time_str, &apparent)) {
-            format_temperature(info.feels_like_f, sizeof(info.feels_like_f), apparent, 'F');
-        }
+    if (isfinite(fc->current_humidity)) {
+        format_percentage(info.humidity, sizeof(info.humidity), fc->current_humidity);
     }
-
-    if (cJSON_IsObject(hourly)) {
-        populate_hourly_forecast(hourly, time_str, &info);
+    if (isfinite(fc->current_apparent)) {
+        format_temperature(info.feels_like_f, sizeof(info.feels_like_f), fc->current_apparent, 'F');
     }
 
-    cJSON *daily = cJSON_GetObjectItem(root, "daily");
+    populate_hourly_forecast(fc, &info);
     if (info.timezone_valid) {
-        populate_sun_times(daily, info.timezone_offset_minutes, &info);
+        populate_sun_times(fc, info.timezone_offset_minutes, &info);
     }
+    free(fc);
 
     fetch_weather_alerts(latitude, longitude, &info);
 
@@ -976,12 +1224,11 @@ static esp_err_t fetch_weather_now(void)
     info.last_update_epoch = (uint32_t)time(NULL);
     info.last_error[0] = '\0';
 
-    cJSON_Delete(root);
-
     info.time_synced = s_time_synced;
     xSemaphoreTake(s_info_mutex, portMAX_DELAY);
     s_info = info;
     xSemaphoreGive(s_info_mutex);
+    atomic_fetch_add(&s_info_generation, 1);
     hamview_event_log_append("weather", "Updated %s (%u alerts)",
                              info.location[0] ? info.location : "weather",
                              (unsigned)info.alert_count);
@@ -991,17 +1238,25 @@ static esp_err_t fetch_weather_now(void)
 static void weather_task(void *arg)
 {
     (void)arg;
+    int64_t next_fetch_us = esp_timer_get_time() + (int64_t)WEATHER_FETCH_INTERVAL_MS * 1000;
     while (true) {
+        int64_t wait_ms = (next_fetch_us - esp_timer_get_time()) / 1000;
+        if (wait_ms < 0) {
+            wait_ms = 0;
+        }
+        if (weather_sessions_connected() && wait_ms > WEATHER_SESSION_IDLE_MS) {
+            wait_ms = WEATHER_SESSION_IDLE_MS;
+        }
         EventBits_t bits = xEventGroupWaitBits(s_weather_events, WEATHER_EVENT_FETCH | WEATHER_EVENT_SETTINGS,
-                                               pdTRUE, pdFALSE, pdMS_TO_TICKS(WEATHER_FETCH_INTERVAL_MS));
+                                               pdTRUE, pdFALSE, pdMS_TO_TICKS(wait_ms));
+        weather_sessions_reap(false);
         bool trigger = (bits & (WEATHER_EVENT_FETCH | WEATHER_EVENT_SETTINGS)) != 0;
-        if (!trigger) {
-            trigger = true; // timer elapsed
-        }
-        if (!trigger) {
-            continue;
+        if (!trigger && esp_timer_get_time() < next_fetch_us) {
+            continue; // woke only to drop idle connections
         }
+        next_fetch_us = esp_timer_get_time() + (int64_t)WEATHER_FETCH_INTERVAL_MS * 1000;
         if (!s_wifi_connected || !s_has_ip) {
+            weather_sessions_reap(true);
             continue;
         }
         hamview_settings_t settings;
@@ -1016,6 +1271,7 @@ static void weather_task(void *arg)
         } else {
             clear_error();
         }
+        ESP_LOGD(TAG, "TLS handshakes since boot: %" PRIu32, s_tls_handshakes);
     }
 }
 
@@ -1095,6 +1351,11 @@ bool hamview_weather_get(hamview_weather_info_t *out)
     return out->has_data;
 }
 
+uint32_t hamview_weather_generation(void)
+{
+    return atomic_load(&s_info_generation);
+}
+
 void hamview_weather_request_refresh(void)
 {
     if (s_weather_events) {
@@ -1,5 +1,6 @@
 #define HAMVIEW_WEATHER_SUN_TIMES 3
 #define HAMVIEW_WEATHER_HOURLY_COUNT 12
+#define HAMVIEW_WEATHER_MAX_ALERTS 3
 
 #ifndef HAMVIEW_WEATHER_H
 #define HAMVIEW_WEATHER_H
@@ -33,7 +34,7 @@ typedef struct {
     char wind_mph[16];
     char observation_time[16];
     size_t alert_count;
-    char alerts[3][96];
+    char alerts[HAMVIEW_WEATHER_MAX_ALERTS][96];
     uint32_t last_update_epoch;
     char last_error[96];
     bool timezone_valid;
@@ -56,6 +57,9 @@ typedef struct {
 esp_err_t hamview_weather_init(void);
 void hamview_weather_on_settings_updated(void);
 bool hamview_weather_get(hamview_weather_info_t *out);
+/* Bumped whenever the data hamview_weather_get() returns changes, so the
+ * UI can skip copying and redrawing while it still shows the current one. */
+uint32_t hamview_weather_generation(void);
 void hamview_weather_request_refresh(void);
 
 #ifdef __cplusplus
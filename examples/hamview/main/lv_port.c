@@ -20,10 +20,26 @@
 
 #define LV_PORT_BUFFER_HEIGHT           (brd->LCD_HEIGHT)
 #define LV_PORT_BUFFER_MALLOC           (MALLOC_CAP_SPIRAM)
-#define LV_PORT_TASK_DELAY_MS           (5)
+#define LV_PORT_STRIP_LINES             (32)
+#define LV_PORT_STRIP_MALLOC            (MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA)
+#define LV_PORT_TASK_MIN_DELAY_MS       (5)
+#define LV_PORT_TASK_MAX_DELAY_MS       (1000)
+#define LV_PORT_SLEEP_INDEV_PERIOD_MS   (100)
 
 static const char *TAG = "lvgl_port";
 static lv_disp_drv_t disp_drv;
+static lv_disp_draw_buf_t disp_buf;
+static lv_disp_t *disp_handle = NULL;
+static lv_port_render_mode_t render_mode = LV_PORT_RENDER_PARTIAL;
+static void *strip_buf1 = NULL;
+static void *strip_buf2 = NULL;
+static void *psram_buf = NULL;
+static lv_port_stats_t port_stats;
+static int64_t frame_start_us = 0;
+static uint32_t frame_flush_us = 0;
+static int64_t last_tick_us = 0;
+static void (*notify_cb)(void) = NULL;
+static bool screen_asleep = false;
 static lv_indev_t *indev_touchpad = NULL;
 static lv_indev_t *indev_button = NULL;
 static SemaphoreHandle_t lvgl_mutex = NULL;
@@ -42,6 +58,8 @@ static void disp_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_
 static esp_err_t lv_port_tick_init(void);
 static void lvgl_task(void *args);
 static void lv_port_direct_mode_copy(void);
+static void disp_render_start(lv_disp_drv_t *drv);
+static esp_err_t lv_port_apply_render_mode(lv_port_render_mode_t mode);
 static void button_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data);
 
 void lv_port_init(void)
@@ -87,10 +105,41 @@ static bool lv_port_flush_is_last(void)
     return lv_disp_flush_is_last(&disp_drv);
 }
 
+static void disp_render_start(lv_disp_drv_t *drv)
+{
+    (void)drv;
+    frame_start_us = esp_timer_get_time();
+    frame_flush_us = 0;
+}
+
 static void disp_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p)
 {
-    (void)disp_drv;
+    bool last = lv_disp_flush_is_last(disp_drv);
+    int64_t start_us = esp_timer_get_time();
     bsp_lcd_flush(area->x1, area->y1, area->x2 + 1, area->y2 + 1, (uint8_t *)color_p);
+    int64_t end_us = esp_timer_get_time();
+
+    frame_flush_us += (uint32_t)(end_us - start_us);
+    port_stats.flush_count++;
+    port_stats.bytes_flushed += (uint64_t)lv_area_get_size(area) * sizeof(lv_color_t);
+    if (!last) {
+        return;
+    }
+
+    uint32_t frame_us = (frame_start_us > 0) ? (uint32_t)(end_us - frame_start_us) : frame_flush_us;
+    uint32_t render_us = (frame_us > frame_flush_us) ? frame_us - frame_flush_us : 0;
+    port_stats.frames++;
+    port_stats.last_render_us = render_us;
+    port_stats.total_render_us += render_us;
+    if (render_us > port_stats.max_render_us) {
+        port_stats.max_render_us = render_us;
+    }
+    port_stats.last_flush_us = frame_flush_us;
+    port_stats.total_flush_us += frame_flush_us;
+    if (frame_flush_us > port_stats.max_flush_us) {
+        port_stats.max_flush_us = frame_flush_us;
+    }
+    frame_start_us = 0;
 }
 
 static void button_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data)
@@ -143,43 +192,176 @@ static IRAM_ATTR void touchpad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *
     }
 }
 
-static void lv_port_disp_init(void)
+static bool lv_port_alloc_partial_buffers(const board_res_desc_t *brd, void **buf1, void **buf2, uint32_t *size)
 {
-    static lv_disp_draw_buf_t disp_buf;
-    const board_res_desc_t *brd = bsp_board_get_description();
+    uint32_t strip_px = brd->LCD_WIDTH * LV_PORT_STRIP_LINES;
+    if (!strip_buf1) {
+        strip_buf1 = heap_caps_malloc(strip_px * sizeof(lv_color_t), LV_PORT_STRIP_MALLOC);
+    }
+    if (strip_buf1 && !strip_buf2) {
+        strip_buf2 = heap_caps_malloc(strip_px * sizeof(lv_color_t), LV_PORT_STRIP_MALLOC);
+    }
+    if (strip_buf1 && strip_buf2) {
+        *buf1 = strip_buf1;
+        *buf2 = strip_buf2;
+        *size = strip_px;
+        return true;
+    }
+
+    /* Not enough internal RAM: fall back to one screen-sized PSRAM buffer. */
+    ESP_LOGW(TAG, "SRAM strip alloc failed, using PSRAM draw buffer");
+    uint32_t full_px = brd->LCD_WIDTH * LV_PORT_BUFFER_HEIGHT;
+    if (!psram_buf) {
+        psram_buf = heap_caps_malloc(full_px * sizeof(lv_color_t), LV_PORT_BUFFER_MALLOC);
+    }
+    if (!psram_buf) {
+        return false;
+    }
+    *buf1 = psram_buf;
+    *buf2 = NULL;
+    *size = full_px;
+    return true;
+}
 
+/* Must run with the LVGL mutex held (or before the LVGL task exists). */
+static esp_err_t lv_port_apply_render_mode(lv_port_render_mode_t mode)
+{
+    const board_res_desc_t *brd = bsp_board_get_description();
     void *buf1 = NULL;
     void *buf2 = NULL;
-    int buffer_size;
+    uint32_t size = 0;
+
+    switch (mode) {
+    case LV_PORT_RENDER_FULL:
+    case LV_PORT_RENDER_DIRECT:
 #if CONFIG_LCD_AVOID_TEAR
-    buffer_size = brd->LCD_WIDTH * brd->LCD_HEIGHT;
-    bsp_lcd_get_frame_buffer(&buf1, &buf2);
+        bsp_lcd_get_frame_buffer(&buf1, &buf2);
+        size = brd->LCD_WIDTH * brd->LCD_HEIGHT;
+        break;
 #else
-    buffer_size = brd->LCD_WIDTH * LV_PORT_BUFFER_HEIGHT;
-    buf1 = heap_caps_malloc(buffer_size * sizeof(lv_color_t), LV_PORT_BUFFER_MALLOC);
-    assert(buf1);
+        return ESP_ERR_NOT_SUPPORTED;
 #endif
-    lv_disp_draw_buf_init(&disp_buf, buf1, buf2, buffer_size);
+    case LV_PORT_RENDER_PARTIAL:
+        if (!lv_port_alloc_partial_buffers(brd, &buf1, &buf2, &size)) {
+            return ESP_ERR_NO_MEM;
+        }
+        break;
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    lv_disp_draw_buf_init(&disp_buf, buf1, buf2, size);
+    disp_drv.full_refresh = (mode == LV_PORT_RENDER_FULL) ? 1 : 0;
+    disp_drv.direct_mode = (mode == LV_PORT_RENDER_DIRECT) ? 1 : 0;
+#if CONFIG_LCD_AVOID_TEAR
+    bsp_lcd_set_flush_mode(mode == LV_PORT_RENDER_FULL     ? BSP_LCD_FLUSH_FULL
+                           : mode == LV_PORT_RENDER_DIRECT ? BSP_LCD_FLUSH_DIRECT
+                                                           : BSP_LCD_FLUSH_PARTIAL);
+#endif
+
+    render_mode = mode;
+    memset(&port_stats, 0, sizeof(port_stats));
+    port_stats.mode = mode;
+    frame_start_us = 0;
+
+    if (disp_handle) {
+        lv_disp_drv_update(disp_handle, &disp_drv);
+        /* Both frame buffers must start out identical in direct mode. */
+        lv_obj_invalidate(lv_disp_get_scr_act(disp_handle));
+    }
+    ESP_LOGI(TAG, "Render mode: %s", lv_port_render_mode_name(mode));
+    return ESP_OK;
+}
+
+static void lv_port_disp_init(void)
+{
+    const board_res_desc_t *brd = bsp_board_get_description();
 
     lv_disp_drv_init(&disp_drv);
     disp_drv.hor_res = brd->LCD_WIDTH;
     disp_drv.ver_res = brd->LCD_HEIGHT;
     disp_drv.flush_cb = disp_flush;
+    disp_drv.render_start_cb = disp_render_start;
     disp_drv.draw_buf = &disp_buf;
+
 #if CONFIG_LCD_LVGL_FULL_REFRESH
-    disp_drv.full_refresh = 1;
+    lv_port_render_mode_t mode = LV_PORT_RENDER_FULL;
 #elif CONFIG_LCD_LVGL_DIRECT_MODE
-    disp_drv.direct_mode = 1;
+    lv_port_render_mode_t mode = LV_PORT_RENDER_DIRECT;
+#else
+    lv_port_render_mode_t mode = LV_PORT_RENDER_PARTIAL;
 #endif
+    ESP_ERROR_CHECK(lv_port_apply_render_mode(mode));
 
     bsp_lcd_set_cb(lv_port_flush_ready, NULL);
 
-#if CONFIG_LCD_LVGL_DIRECT_MODE
+#if CONFIG_LCD_AVOID_TEAR
     bsp_lcd_flush_is_last_register(lv_port_flush_is_last);
     bsp_lcd_direct_mode_register(lv_port_direct_mode_copy);
 #endif
 
-    lv_disp_drv_register(&disp_drv);
+    disp_handle = lv_disp_drv_register(&disp_drv);
+}
+
+esp_err_t lv_port_set_render_mode(lv_port_render_mode_t mode)
+{
+    if (lv_port_is_in_lvgl_task()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    lv_port_sem_take();
+    esp_err_t err = ESP_OK;
+    if (mode != render_mode) {
+        /* SPI panels flush asynchronously; let the last one land first. */
+        while (disp_buf.flushing) {
+            vTaskDelay(1);
+        }
+        err = lv_port_apply_render_mode(mode);
+    }
+    lv_port_sem_give();
+    return err;
+}
+
+lv_port_render_mode_t lv_port_get_render_mode(void)
+{
+    return render_mode;
+}
+
+const char *lv_port_render_mode_name(lv_port_render_mode_t mode)
+{
+    switch (mode) {
+    case LV_PORT_RENDER_FULL:
+        return "full";
+    case LV_PORT_RENDER_DIRECT:
+        return "direct";
+    case LV_PORT_RENDER_PARTIAL:
+        return "partial";
+    default:
+        return "unknown";
+    }
+}
+
+bool lv_port_render_mode_from_name(const char *name, lv_port_render_mode_t *out)
+{
+    if (!name || !out) {
+        return false;
+    }
+    for (int mode = LV_PORT_RENDER_PARTIAL; mode <= LV_PORT_RENDER_DIRECT; ++mode) {
+        if (strcmp(name, lv_port_render_mode_name((lv_port_render_mode_t)mode)) == 0) {
+            *out = (lv_port_render_mode_t)mode;
+            return true;
+        }
+    }
+    return false;
+}
+
+void lv_port_get_stats(lv_port_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    lv_port_sem_take();
+    *out = port_stats;
+    lv_port_sem_give();
 }
 
 static void lv_port_indev_init(void)
@@ -205,31 +387,88 @@ static void lv_port_indev_init(void)
     }
 }
 
-static void lv_tick_inc_cb(void *data)
+/* The LVGL tick is advanced from esp_timer right before each handler pass
+ * instead of by a 2 ms periodic timer, so an idle UI causes no wakeups. */
+static esp_err_t lv_port_tick_init(void)
 {
-    uint32_t tick_inc_period_ms = *((uint32_t *)data);
-    lv_tick_inc(tick_inc_period_ms);
+    last_tick_us = esp_timer_get_time();
+    return ESP_OK;
 }
 
-static esp_err_t lv_port_tick_init(void)
+static void lv_port_tick_update(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    uint32_t elapsed_ms = (uint32_t)((now_us - last_tick_us) / 1000);
+    if (elapsed_ms > 0) {
+        lv_tick_inc(elapsed_ms);
+        last_tick_us += (int64_t)elapsed_ms * 1000;
+    }
+}
+
+void lv_port_notify(void)
 {
-    static const uint32_t tick_inc_period_ms = 2;
-    const esp_timer_create_args_t periodic_timer_args = {
-        .callback = lv_tick_inc_cb,
-        .name = "",
-        .arg = &tick_inc_period_ms,
-        .dispatch_method = ESP_TIMER_TASK,
-        .skip_unhandled_events = true,
-    };
-
-    esp_timer_handle_t periodic_timer;
-    ESP_ERROR_CHECK(esp_timer_create(&periodic_timer_args, &periodic_timer));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(periodic_timer, tick_inc_period_ms * 1000));
+    if (lvgl_task_handle) {
+        xTaskNotifyGive(lvgl_task_handle);
+    }
+}
 
-    return ESP_OK;
+void lv_port_set_notify_cb(void (*cb)(void))
+{
+    notify_cb = cb;
+}
+
+/* While the backlight is off nothing is rendered: the display refresh timer
+ * is paused and input is polled just often enough to notice a wake touch.
+ * Invalidated areas accumulate and are drawn on wake. */
+static void lv_port_apply_sleep_state(bool asleep)
+{
+    if (asleep == screen_asleep || !disp_handle) {
+        return;
+    }
+    screen_asleep = asleep;
+    lv_timer_t *refr_timer = _lv_disp_get_refr_timer(disp_handle);
+    if (asleep) {
+        lv_timer_pause(refr_timer);
+    } else {
+        lv_timer_resume(refr_timer);
+        lv_timer_ready(refr_timer);
+    }
+
+    lv_indev_t *indev = lv_indev_get_next(NULL);
+    while (indev) {
+        lv_timer_t *read_timer = indev->driver->read_timer;
+        if (read_timer) {
+            lv_timer_set_period(read_timer, asleep ? LV_PORT_SLEEP_INDEV_PERIOD_MS : LV_INDEV_DEF_READ_PERIOD);
+        }
+        indev = lv_indev_get_next(indev);
+    }
+}
+
+#if CONFIG_LCD_AVOID_TEAR
+/* Joins areas whose union costs no more than copying both separately, which
+ * also catches the vertically stacked same-width areas (table cells, list
+ * rows) that LVGL's own strict join leaves apart. */
+static uint16_t lv_port_merge_areas(lv_area_t *areas, uint16_t count)
+{
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (uint16_t i = 0; i < count; ++i) {
+            for (uint16_t j = i + 1; j < count; ++j) {
+                lv_area_t joined;
+                _lv_area_join(&joined, &areas[i], &areas[j]);
+                if (lv_area_get_size(&joined) <= lv_area_get_size(&areas[i]) + lv_area_get_size(&areas[j])) {
+                    areas[i] = joined;
+                    areas[j] = areas[--count];
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+    return count;
 }
 
-#if CONFIG_LCD_LVGL_DIRECT_MODE
 static void lv_port_direct_mode_copy(void)
 {
     lv_disp_t *disp_refr = _lv_refr_get_disp_refreshing();
@@ -238,42 +477,41 @@ static void lv_port_direct_mode_copy(void)
     uint8_t *buf1 = disp_refr->driver->draw_buf->buf1;
     uint8_t *buf2 = disp_refr->driver->draw_buf->buf2;
     int h_res = disp_refr->driver->hor_res;
-    int v_res = disp_refr->driver->ver_res;
 
     uint8_t *fb_from = buf_act;
     uint8_t *fb_to = (fb_from == buf1) ? buf2 : buf1;
 
-    int32_t i;
-    lv_coord_t x_start;
-    lv_coord_t x_end;
-    lv_coord_t y_start;
-    lv_coord_t y_end;
-    uint32_t copy_bytes_per_line;
-    uint32_t bytes_to_flush;
-    uint32_t bytes_per_line = h_res * 2;
-    uint8_t *from;
-    uint8_t *to;
-    uint8_t *flush_ptr;
-    for (i = 0; i < disp_refr->inv_p; i++) {
+    lv_area_t areas[LV_INV_BUF_SIZE];
+    uint16_t count = 0;
+    for (int32_t i = 0; i < disp_refr->inv_p; i++) {
         if (disp_refr->inv_area_joined[i] == 0) {
-            x_start = disp_refr->inv_areas[i].x1;
-            x_end = disp_refr->inv_areas[i].x2 + 1;
-            y_start = disp_refr->inv_areas[i].y1;
-            y_end = disp_refr->inv_areas[i].y2 + 1;
-
-            copy_bytes_per_line = (x_end - x_start) * 2;
-            from = fb_from + (y_start * h_res + x_start) * 2;
-            to = fb_to + (y_start * h_res + x_start) * 2;
+            areas[count++] = disp_refr->inv_areas[i];
+        }
+    }
+    count = lv_port_merge_areas(areas, count);
+
+    uint32_t bytes_per_line = h_res * sizeof(lv_color_t);
+    for (uint16_t i = 0; i < count; i++) {
+        lv_coord_t x_start = areas[i].x1;
+        lv_coord_t y_start = areas[i].y1;
+        lv_coord_t y_end = areas[i].y2 + 1;
+        uint32_t copy_bytes_per_line = lv_area_get_width(&areas[i]) * sizeof(lv_color_t);
+        uint8_t *from = fb_from + (y_start * h_res + x_start) * sizeof(lv_color_t);
+        uint8_t *to = fb_to + (y_start * h_res + x_start) * sizeof(lv_color_t);
+        uint32_t bytes_to_flush = (y_end - y_start) * bytes_per_line;
+
+        if (copy_bytes_per_line == bytes_per_line) {
+            memcpy(to, from, bytes_to_flush);
+        } else {
             for (int y = y_start; y < y_end; y++) {
                 memcpy(to, from, copy_bytes_per_line);
                 from += bytes_per_line;
                 to += bytes_per_line;
             }
-            bytes_to_flush = (y_end - y_start) * bytes_per_line;
-            flush_ptr = fb_to + y_start * bytes_per_line;
-
-            Cache_WriteBack_Addr((uint32_t)flush_ptr, bytes_to_flush);
         }
+        port_stats.bytes_copied += (uint64_t)copy_bytes_per_line * (y_end - y_start);
+
+        Cache_WriteBack_Addr((uint32_t)(fb_to + y_start * bytes_per_line), bytes_to_flush);
     }
 }
 #else
@@ -285,10 +523,23 @@ static void lv_port_direct_mode_copy(void)
 static void lvgl_task(void *args)
 {
     (void)args;
+    bool notified = false;
     for (;;) {
         xSemaphoreTake(lvgl_mutex, portMAX_DELAY);
-        lv_task_handler();
+        lv_port_apply_sleep_state(hamview_screen_is_sleeping());
+        if (notified && notify_cb) {
+            notify_cb();
+        }
+        lv_port_tick_update();
+        uint32_t next_ms = lv_task_handler();
         xSemaphoreGive(lvgl_mutex);
-        vTaskDelay(pdMS_TO_TICKS(LV_PORT_TASK_DELAY_MS));
+
+        /* Sleep until the next LVGL timer is due or someone notifies us. */
+        if (next_ms < LV_PORT_TASK_MIN_DELAY_MS) {
+            next_ms = LV_PORT_TASK_MIN_DELAY_MS;
+        } else if (next_ms > LV_PORT_TASK_MAX_DELAY_MS) {
+            next_ms = LV_PORT_TASK_MAX_DELAY_MS;
+        }
+        notified = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(next_ms)) > 0;
     }
 }
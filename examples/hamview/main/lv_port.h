@@ -2,6 +2,9 @@
 #define LV_PORT_H
 
 #include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
 
 #include "lvgl.h"
 
@@ -9,10 +12,42 @@
 extern "C" {
 #endif
 
+typedef enum {
+    LV_PORT_RENDER_PARTIAL = 0, /* two internal SRAM strips, areas copied to the panel */
+    LV_PORT_RENDER_FULL,        /* whole frames into the two panel frame buffers */
+    LV_PORT_RENDER_DIRECT,      /* dirty areas into the panel frame buffers, then synced */
+} lv_port_render_mode_t;
+
+/* Counters since the last render mode change. Render time is the part of a
+ * frame spent outside the flush callback. */
+typedef struct {
+    lv_port_render_mode_t mode;
+    uint32_t frames;
+    uint32_t flush_count;
+    uint64_t bytes_flushed;
+    uint64_t bytes_copied;
+    uint32_t last_render_us;
+    uint32_t max_render_us;
+    uint64_t total_render_us;
+    uint32_t last_flush_us;
+    uint32_t max_flush_us;
+    uint64_t total_flush_us;
+} lv_port_stats_t;
+
 void lv_port_init(void);
 void lv_port_sem_take(void);
 void lv_port_sem_give(void);
 bool lv_port_is_in_lvgl_task(void);
+esp_err_t lv_port_set_render_mode(lv_port_render_mode_t mode);
+lv_port_render_mode_t lv_port_get_render_mode(void);
+const char *lv_port_render_mode_name(lv_port_render_mode_t mode);
+bool lv_port_render_mode_from_name(const char *name, lv_port_render_mode_t *out);
+void lv_port_get_stats(lv_port_stats_t *out);
+/* Wakes the LVGL task early; safe from any task. The callback set with
+ * lv_port_set_notify_cb then runs in the LVGL task before the next handler
+ * pass. */
+void lv_port_notify(void);
+void lv_port_set_notify_cb(void (*cb)(void));
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,274 @@
+/* Throughput and allocation benchmark of the HamAlert spot parser.
+ *
+ * Replays a generated feed of HamAlert telnet lines through
+ * hamview_spot_parse_json() and counts heap calls by interposing the glibc
+ * allocator. When built with HAVE_CJSON (the Makefile sets it if it finds
+ * ESP-IDF's cJSON) the same feed also goes through the cJSON path that
+ * process_spot_json() used before, and the decoded spots of both are compared.
+ */
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hamview_spot_parser.h"
+
+#ifdef HAVE_CJSON
+#include "cJSON.h"
+#endif
+
+#define FEED_LINES 20000
+#define LINE_MAX 1024
+#define ROUNDS 10
+
+/* ---- allocation counting ---- */
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static uint64_t s_allocs;
+
+void *malloc(size_t size)
+{
+    s_allocs++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    s_allocs++;
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    s_allocs++;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+/* ---- feed ---- */
+
+static const char *const MODES[] = { "ft8", "cw", "ssb", "ft4", "rtty" };
+static const char *const ENTITIES[] = { "United States", "Japan", "Fed. Rep. of Germany", "Italy", "Brazil" };
+static const char *const CONTINENTS[] = { "NA", "AS", "EU", "EU", "SA" };
+
+static char s_feed[FEED_LINES][LINE_MAX];
+static size_t s_feed_len[FEED_LINES];
+
+static void build_feed(void)
+{
+    uint32_t state = 1;
+    for (uint32_t i = 0; i < FEED_LINES; ++i) {
+        state = state * 1103515245u + 12345u;
+        uint32_t r = state >> 8;
+        uint32_t e = r % 5;
+        uint32_t khz = 1800 + (r % 52000);
+        int len = snprintf(s_feed[i], LINE_MAX,
+                           "{\"fullCallsign\":\"K%" PRIu32 "ABC/P\",\"callsign\":\"K%" PRIu32 "ABC\","
+                           "\"frequency\":\"%" PRIu32 ".%" PRIu32 "\",\"band\":\"20m\",\"mode\":\"%s\","
+                           "\"modeDetail\":\"%s\",\"time\":\"%02" PRIu32 ":%02" PRIu32 "\",\"dxcc\":\"%" PRIu32 "\","
+                           "\"homeDxcc\":\"291\",\"spotterDxcc\":\"230\",\"cq\":\"5\",\"continent\":\"%s\","
+                           "\"entity\":\"%s\",\"homeEntity\":\"%s\",\"spotterEntity\":\"Fed. Rep. of Germany\","
+                           "\"spotter\":\"DL%" PRIu32 "XY-#\",\"spotterCq\":\"14\",\"spotterContinent\":\"EU\","
+                           "\"rawText\":\"DX de DL%" PRIu32 "XY-#: %" PRIu32 ".%" PRIu32 " K%" PRIu32 "ABC %s %" PRIu32 " dB\","
+                           "\"title\":\"HamAlert K%" PRIu32 "ABC\",\"comment\":\"%s -%" PRIu32 " dB %" PRIu32 " Hz \\u00e9\","
+                           "\"source\":\"rbn\",\"speed\":\"\",\"snr\":\"-%" PRIu32 "\",\"triggerComment\":\"\","
+                           "\"summitRef\":\"\",\"wwffRef\":\"\"}",
+                           r % 10, r % 10, khz, r % 10, MODES[e], MODES[e], (r / 7) % 24, (r / 3) % 60,
+                           100 + r % 240, CONTINENTS[e], ENTITIES[e], ENTITIES[e], r % 9, r % 9, khz, r % 10,
+                           r % 10, MODES[e], r % 30, r % 10, MODES[e], r % 30, r % 3000, r % 30);
+        s_feed_len[i] = (size_t)len;
+    }
+}
+
+/* ---- parsers under test ---- */
+
+typedef struct {
+    hamview_spot_t *spots;
+    size_t count;
+} sink_t;
+
+static void on_spot(const hamview_spot_t *spot, void *ctx)
+{
+    sink_t *sink = ctx;
+    sink->spots[sink->count++] = *spot;
+}
+
+static void stream_parse(const char *json, size_t len, sink_t *sink)
+{
+    hamview_spot_parse_json(json, len, on_spot, sink);
+}
+
+#ifdef HAVE_CJSON
+/* process_spot_json() before the streaming parser, with update_spot() replaced
+ * by the sink. */
+static void add_field(char *dst, size_t dst_len, const cJSON *obj, const char *key, const char *fallback_key)
+{
+    const char *val = NULL;
+    if (obj) {
+        const cJSON *node = cJSON_GetObjectItemCaseSensitive(obj, key);
+        if (cJSON_IsString(node) && node->valuestring) {
+            val = node->valuestring;
+        }
+        if (!val && fallback_key) {
+            node = cJSON_GetObjectItemCaseSensitive(obj, fallback_key);
+            if (cJSON_IsString(node) && node->valuestring) {
+                val = node->valuestring;
+            }
+        }
+    }
+    if (!val) {
+        val = "";
+    }
+    strlcpy(dst, val, dst_len);
+}
+
+static void legacy_parse_obj(cJSON *obj, sink_t *sink)
+{
+    hamview_spot_t spot = {0};
+    add_field(spot.callsign, sizeof(spot.callsign), obj, "callsign", "dx");
+    if (strlen(spot.callsign) == 0) {
+        return;
+    }
+    add_field(spot.frequency, sizeof(spot.frequency), obj, "frequency", "freq");
+    add_field(spot.mode, sizeof(spot.mode), obj, "mode", NULL);
+    add_field(spot.spotter, sizeof(spot.spotter), obj, "spotter", "de");
+    add_field(spot.time_utc, sizeof(spot.time_utc), obj, "time", NULL);
+    add_field(spot.dxcc, sizeof(spot.dxcc), obj, "dxcc", "country");
+    add_field(spot.state, sizeof(spot.state), obj, "state", "us_state");
+    add_field(spot.country, sizeof(spot.country), obj, "country", "dxcc");
+    add_field(spot.continent, sizeof(spot.continent), obj, "continent", "cont");
+    add_field(spot.comment, sizeof(spot.comment), obj, "comment", "comments");
+
+    if (strlen(spot.frequency) > 0) {
+        double freq_val = atof(spot.frequency);
+        if (freq_val > 0) {
+            char buf[16];
+            snprintf(buf, sizeof(buf), "%.3f", freq_val);
+            strlcpy(spot.frequency, buf, sizeof(spot.frequency));
+        }
+    }
+    on_spot(&spot, sink);
+}
+
+static void legacy_parse(const char *json, size_t len, sink_t *sink)
+{
+    (void)len;
+    if (!json || strlen(json) == 0) {
+        return;
+    }
+    cJSON *root = cJSON_Parse(json);
+    if (!root) {
+        return;
+    }
+    if (cJSON_IsArray(root)) {
+        cJSON *item = NULL;
+        cJSON_ArrayForEach(item, root) {
+            if (cJSON_IsObject(item)) {
+                legacy_parse_obj(item, sink);
+            }
+        }
+    } else if (cJSON_IsObject(root)) {
+        cJSON *spots = cJSON_GetObjectItem(root, "spots");
+        if (cJSON_IsArray(spots)) {
+            cJSON *item = NULL;
+            cJSON_ArrayForEach(item, spots) {
+                if (cJSON_IsObject(item)) {
+                    legacy_parse_obj(item, sink);
+                }
+            }
+        } else {
+            legacy_parse_obj(root, sink);
+        }
+    }
+    cJSON_Delete(root);
+}
+#endif
+
+/* ---- benchmark ---- */
+
+#ifdef HAVE_CJSON
+#define SAME_FIELD(a, b, field) (strcmp((a)->field, (b)->field) == 0)
+
+static int same_spot(const hamview_spot_t *a, const hamview_spot_t *b)
+{
+    return SAME_FIELD(a, b, callsign) && SAME_FIELD(a, b, frequency) && SAME_FIELD(a, b, mode) &&
+           SAME_FIELD(a, b, spotter) && SAME_FIELD(a, b, time_utc) && SAME_FIELD(a, b, dxcc) &&
+           SAME_FIELD(a, b, state) && SAME_FIELD(a, b, country) && SAME_FIELD(a, b, continent) &&
+           SAME_FIELD(a, b, comment);
+}
+#endif
+
+typedef void (*parse_fn_t)(const char *json, size_t len, sink_t *sink);
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void run(const char *name, parse_fn_t parse, hamview_spot_t *out, uint64_t bytes)
+{
+    sink_t sink = { .spots = out };
+    uint64_t best_ns = UINT64_MAX;
+    uint64_t allocs = 0;
+
+    for (int round = 0; round < ROUNDS; ++round) {
+        sink.count = 0;
+        uint64_t allocs_before = s_allocs;
+        uint64_t t0 = now_ns();
+        for (size_t i = 0; i < FEED_LINES; ++i) {
+            parse(s_feed[i], s_feed_len[i], &sink);
+        }
+        uint64_t elapsed = now_ns() - t0;
+        allocs = s_allocs - allocs_before;
+        if (elapsed < best_ns) {
+            best_ns = elapsed;
+        }
+    }
+    printf("%-10s %7.0f ns/line  %6.1f MB/s  %6.1f allocations/line  %zu spots\n", name,
+           (double)best_ns / FEED_LINES, (double)bytes * 1000.0 / (double)best_ns,
+           (double)allocs / FEED_LINES, sink.count);
+}
+
+int main(void)
+{
+    static hamview_spot_t stream_out[FEED_LINES];
+    uint64_t bytes = 0;
+
+    build_feed();
+    for (size_t i = 0; i < FEED_LINES; ++i) {
+        bytes += s_feed_len[i];
+    }
+    printf("%d lines, %.0f bytes/line\n", FEED_LINES, (double)bytes / FEED_LINES);
+
+    run("streaming", stream_parse, stream_out, bytes);
+
+#ifdef HAVE_CJSON
+    static hamview_spot_t legacy_out[FEED_LINES];
+    run("cJSON", legacy_parse, legacy_out, bytes);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < FEED_LINES; ++i) {
+        if (!same_spot(&stream_out[i], &legacy_out[i])) {
+            if (mismatches++ == 0) {
+                printf("first mismatch on line %zu: %s\n", i, s_feed[i]);
+            }
+        }
+    }
+    printf("decoded spots differ on %zu of %d lines\n", mismatches, FEED_LINES);
+#else
+    printf("cJSON comparison skipped, build with CJSON_DIR=<path to cJSON.c>\n");
+#endif
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""Writes the HamAlert telnet session test_ingest_replay replays.
+
+hamalert_feed.txt is what the server sends after the login prompt: the
+greeting, the set/json acknowledgement, then one JSON spot per CRLF line, in
+the shape HamAlert uses for RBN, cluster, SOTA and POTA spots. A keep-alive
+blank line and one spot with an oversized comment are mixed in, as seen on
+the real feed when a cluster node relays a runaway announcement.
+
+hamalert_feed.exp counts, independently of the C code, the lines the reader
+must queue (complete JSON lines shorter than the 1024-byte line buffer) and
+the ones it must discard as oversized.
+"""
+import json
+import os
+import random
+
+random.seed(11)
+HERE = os.path.dirname(os.path.abspath(__file__))
+LINE_MAX = 1024
+NB_SPOTS = 200
+
+ENTITIES = [("United States", "291", "NA"), ("Japan", "339", "AS"), ("Fed. Rep. of Germany", "230", "EU"),
+            ("Italy", "248", "EU"), ("Brazil", "108", "SA"), ("Australia", "150", "OC")]
+BANDS = [("160m", 1800, 2000), ("40m", 7000, 7300), ("30m", 10100, 10150), ("20m", 14000, 14350),
+         ("17m", 18068, 18168), ("15m", 21000, 21450), ("10m", 28000, 29700)]
+MODES = ["ft8", "cw", "ssb", "ft4", "rtty"]
+
+
+def call():
+    prefix = random.choice(["K", "W", "N", "JA", "DL", "I", "PY", "VK"])
+    return f"{prefix}{random.randint(0, 9)}{''.join(random.choice('ABCDEFGHIJKLMNOPQRSTUVWXYZ') for _ in range(3))}"
+
+
+def spot(i):
+    entity, dxcc, continent = random.choice(ENTITIES)
+    band, lo, hi = random.choice(BANDS)
+    mode = random.choice(MODES)
+    source = random.choice(["rbn", "rbn", "cluster", "sota", "pota"])
+    dx = call()
+    spotter = call() + ("-#" if source == "rbn" else "")
+    freq = f"{random.uniform(lo, hi):.1f}"
+    snr = random.randint(-24, 30)
+    obj = {
+        "fullCallsign": dx + random.choice(["", "", "/P", "/M"]), "callsign": dx, "frequency": freq,
+        "band": band, "mode": mode, "modeDetail": mode, "time": f"{(i // 60) % 24:02d}:{i % 60:02d}",
+        "dxcc": dxcc, "homeDxcc": "291", "spotterDxcc": "230", "cq": str(random.randint(1, 40)),
+        "continent": continent, "entity": entity, "homeEntity": entity,
+        "spotterEntity": "Fed. Rep. of Germany", "spotter": spotter, "spotterCq": "14",
+        "spotterContinent": "EU", "rawText": f"DX de {spotter}: {freq} {dx} {mode.upper()} {snr} dB",
+        "title": f"HamAlert {dx}", "comment": f"{mode.upper()} {snr} dB {random.randint(10, 35)} WPM",
+        "source": source, "speed": "", "snr": str(snr), "triggerComment": "",
+    }
+    if source == "sota":
+        obj["summitRef"] = f"W6/CT-{random.randint(1, 300):03d}"
+    if source == "pota":
+        obj["wwffRef"] = f"K-{random.randint(1, 9999):04d}"
+    return obj
+
+
+def main():
+    lines = ["Hello N0CALL, this is HamAlert", "", "N0CALL de HamAlert >", "Operation successful"]
+    queued = oversized = 0
+    for i in range(NB_SPOTS):
+        obj = spot(i)
+        if i == 137:
+            obj["comment"] = "QRV " * 400
+        if i == 150:
+            lines.append("")
+        line = json.dumps(obj, separators=(",", ":"), ensure_ascii=False)
+        lines.append(line)
+        # The reader keeps the CR of the CRLF, so it counts towards the buffer.
+        if len((line + "\r").encode()) < LINE_MAX:
+            queued += 1
+        else:
+            oversized += 1
+    with open(os.path.join(HERE, "hamalert_feed.txt"), "wb") as f:
+        f.write("".join(line + "\r\n" for line in lines).encode())
+    with open(os.path.join(HERE, "hamalert_feed.exp"), "w") as f:
+        f.write(f"{queued} {oversized}\n")
+
+
+if __name__ == "__main__":
+    main()
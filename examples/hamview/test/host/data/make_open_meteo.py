@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Writes the Open-Meteo forecast fixtures test_weather_replay replays.
+
+Each fixture is a response in the shape the forecast request asks for, plus
+a .exp file with what the weather panel should show, worked out here
+independently of the C code: the 12 hours from the current hour on as
+"HH:MM temp precip% wind lightning", then "humidity|feels like", which are
+only known when current_weather.time falls exactly on an hourly slot.
+
+Also prints the heap the previous cJSON path needed for each body: the
+doubling body buffer plus a DOM of 40-byte nodes (32-bit target) and their
+strings.
+"""
+import json
+import os
+import random
+
+random.seed(7)
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def response(cur_time):
+    times = [f"2026-10-{16 + d // 24:02d}T{d % 24:02d}:00" for d in range(72)]
+    return {
+        "latitude": 30.27, "longitude": -97.74, "generationtime_ms": 0.123,
+        "utc_offset_seconds": -18000, "timezone": "America/Chicago",
+        "timezone_abbreviation": "CDT", "elevation": 149.0,
+        "current_weather_units": {"time": "iso8601", "interval": "seconds", "temperature": "°F",
+                                  "windspeed": "mp/h", "winddirection": "°", "is_day": "",
+                                  "weathercode": "wmo code"},
+        "current_weather": {"time": cur_time, "interval": 900, "temperature": 71.3, "windspeed": 9.4,
+                            "winddirection": 180, "is_day": 1, "weathercode": 2},
+        "hourly_units": {"time": "iso8601", "temperature_2m": "°F"},
+        "hourly": {
+            "time": times,
+            "temperature_2m": [round(60 + random.random() * 20, 1) for _ in times],
+            "apparent_temperature": [round(58 + random.random() * 20, 1) for _ in times],
+            "relativehumidity_2m": [random.randint(30, 95) for _ in times],
+            "precipitation_probability": [random.choice([0, 5, 10, 40, 80, None]) for _ in times],
+            "weathercode": [random.choice([0, 1, 2, 3, 61, 95]) for _ in times],
+            "windspeed_10m": [round(random.random() * 35, 1) for _ in times],
+        },
+        "daily_units": {"time": "iso8601", "sunrise": "iso8601", "sunset": "iso8601"},
+        "daily": {
+            "time": ["2026-10-16", "2026-10-17", "2026-10-18"],
+            "sunrise": ["2026-10-16T07:31", "2026-10-17T07:32", "2026-10-18T07:32"],
+            "sunset": ["2026-10-16T18:55", "2026-10-17T18:54", "2026-10-18T18:53"],
+        },
+    }
+
+
+def expected(r, cur):
+    h = r["hourly"]
+    t = h["time"]
+    start = next((i for i, x in enumerate(t) if x >= cur), None)
+    if start is None:
+        start = max(0, len(t) - 12)
+    lines = []
+    for i in range(start, min(start + 12, len(t))):
+        p = h["precipitation_probability"][i]
+        lines.append("%s %dF %d %d %d" % (t[i][11:16], int(h["temperature_2m"][i] + 0.5),
+                                          int(p + 0.5) if p is not None else 0,
+                                          int(h["windspeed_10m"][i] + 0.5),
+                                          1 if h["weathercode"][i] in (95, 96, 99) else 0))
+    cur_i = t.index(cur) if cur in t else None
+    humidity = "%d%%" % int(h["relativehumidity_2m"][cur_i] + 0.5) if cur_i is not None else ""
+    feels = "%dF" % int(h["apparent_temperature"][cur_i] + 0.5) if cur_i is not None else ""
+    return "\n".join(lines) + "\n" + humidity + "|" + feels + "\n"
+
+
+def cjson_heap(r, body):
+    buf = 4096
+    while buf - 1 <= len(body):
+        buf *= 2
+    nodes = 0
+    strings = 0
+
+    def walk(o, key=None):
+        nonlocal nodes, strings
+        nodes += 1
+        if key is not None:
+            strings += len(key) + 1
+        if isinstance(o, dict):
+            for k, v in o.items():
+                walk(v, k)
+        elif isinstance(o, list):
+            for v in o:
+                walk(v)
+        elif isinstance(o, str):
+            strings += len(o.encode()) + 1
+
+    walk(r)
+    return buf, nodes, buf + nodes * 40 + strings
+
+
+for name, cur in (("exact", "2026-10-17T14:00"), ("quarter", "2026-10-17T14:15")):
+    r = response(cur)
+    body = json.dumps(r, separators=(",", ":"))
+    base = os.path.join(HERE, "open_meteo_" + name)
+    with open(base + ".json", "w") as f:
+        f.write(body)
+    with open(base + ".exp", "w") as f:
+        f.write(expected(r, cur))
+    buf, nodes, peak = cjson_heap(r, body)
+    print(f"{name}: body {len(body)} B, cJSON path peak ~{peak} B (buffer {buf}, {nodes} nodes)")
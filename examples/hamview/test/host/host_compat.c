@@ -0,0 +1,24 @@
+#include "host_compat.h"
+
+#include <string.h>
+
+/* Weak so that a libc which already has them wins. */
+__attribute__((weak)) size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+__attribute__((weak)) size_t strlcat(char *dst, const char *src, size_t size)
+{
+    size_t len = strnlen(dst, size);
+    if (len == size) {
+        return size + strlen(src);
+    }
+    return len + strlcpy(dst + len, src, size - len);
+}
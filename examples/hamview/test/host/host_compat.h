@@ -0,0 +1,8 @@
+/* Forced into every hamview host test build (-include): declares what newlib
+ * provides on the target but older glibc does not. */
+#pragma once
+
+#include <stddef.h>
+
+size_t strlcpy(char *dst, const char *src, size_t size);
+size_t strlcat(char *dst, const char *src, size_t size);
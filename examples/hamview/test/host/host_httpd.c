@@ -0,0 +1,396 @@
+/* A small esp_http_server on loopback TCP, for host tests that serve the
+ * hamview handlers to real clients. Like the ESP-IDF server it is a single
+ * task multiplexing its sockets with select(), keeps connections alive, and
+ * stores response header pointers until the response is sent. Buffers are
+ * static: the server itself never allocates per request. */
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "esp_http_server.h"
+
+#define HTTPD_MAX_HANDLERS 16
+#define HTTPD_MAX_SESSIONS 8
+#define HTTPD_REQUEST_MAX 2048
+#define HTTPD_RESP_HDRS_MAX 8
+
+typedef struct {
+    int fd;
+    char buf[HTTPD_REQUEST_MAX];
+    size_t len;
+} session_t;
+
+typedef struct {
+    httpd_req_t req;
+    session_t *session;
+    const char *query;
+    const char *headers;
+    const char *status;
+    const char *type;
+    const char *hdr_field[HTTPD_RESP_HDRS_MAX];
+    const char *hdr_value[HTTPD_RESP_HDRS_MAX];
+    int nb_hdrs;
+} host_req_t;
+
+static httpd_config_t s_config;
+static httpd_uri_t s_handlers[HTTPD_MAX_HANDLERS];
+static int s_nb_handlers;
+static session_t s_sessions[HTTPD_MAX_SESSIONS];
+static int s_listen_fd = -1;
+static uint16_t s_port;
+static pthread_t s_thread;
+static char s_resp_head[1024];
+
+__thread bool host_httpd_in_server;
+
+uint16_t host_httpd_port(void)
+{
+    return s_port;
+}
+
+uint64_t host_httpd_cpu_us(void)
+{
+    clockid_t clock;
+    struct timespec ts;
+    if (!s_port || pthread_getcpuclockid(s_thread, &clock) != 0 || clock_gettime(clock, &ts) != 0) {
+        return 0;
+    }
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static void session_close(session_t *session)
+{
+    if (s_config.close_fn) {
+        s_config.close_fn(&s_config, session->fd);
+    }
+    close(session->fd);
+    session->fd = -1;
+    session->len = 0;
+}
+
+static void dispatch(session_t *session, char *request, size_t head_len)
+{
+    host_req_t hr = { .session = session, .status = "200 OK", .type = "text/html" };
+    char *line_end = strstr(request, "\r\n");
+    *line_end = '\0';
+    hr.headers = line_end + 2;
+    request[head_len - 2] = '\0'; /* the blank line ending the headers */
+
+    char *method = request;
+    char *uri = strchr(method, ' ');
+    if (!uri) {
+        return;
+    }
+    *uri++ = '\0';
+    char *version = strchr(uri, ' ');
+    if (version) {
+        *version = '\0';
+    }
+    char *query = strchr(uri, '?');
+    if (query) {
+        *query++ = '\0';
+    }
+    hr.query = query;
+    hr.req.handle = &s_config;
+    hr.req.method = strcmp(method, "POST") == 0 ? HTTP_POST : HTTP_GET;
+    hr.req.uri = uri;
+    hr.req.aux = &hr;
+
+    for (int i = 0; i < s_nb_handlers; ++i) {
+        if ((int)s_handlers[i].method == hr.req.method && strcmp(s_handlers[i].uri, uri) == 0) {
+            hr.req.user_ctx = s_handlers[i].user_ctx;
+            s_handlers[i].handler(&hr.req);
+            return;
+        }
+    }
+    httpd_resp_send_err(&hr.req, HTTPD_404_NOT_FOUND, "not found");
+}
+
+/* Serves every complete request in the session buffer. Requests carry no
+ * body: the hamview clients only GET and POST with an empty body. */
+static void session_serve(session_t *session)
+{
+    while (true) {
+        session->buf[session->len] = '\0';
+        char *end = strstr(session->buf, "\r\n\r\n");
+        if (!end) {
+            return;
+        }
+        size_t head_len = (size_t)(end - session->buf) + 4;
+        dispatch(session, session->buf, head_len);
+        if (session->fd < 0) {
+            return;
+        }
+        memmove(session->buf, session->buf + head_len, session->len - head_len);
+        session->len -= head_len;
+    }
+}
+
+static void *server_thread(void *arg)
+{
+    host_httpd_in_server = true;
+    while (true) {
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(s_listen_fd, &fds);
+        int max_fd = s_listen_fd;
+        for (int i = 0; i < HTTPD_MAX_SESSIONS; ++i) {
+            if (s_sessions[i].fd >= 0) {
+                FD_SET(s_sessions[i].fd, &fds);
+                max_fd = s_sessions[i].fd > max_fd ? s_sessions[i].fd : max_fd;
+            }
+        }
+        if (select(max_fd + 1, &fds, NULL, NULL, NULL) < 0) {
+            continue;
+        }
+        if (FD_ISSET(s_listen_fd, &fds)) {
+            int fd = accept(s_listen_fd, NULL, NULL);
+            int slot = -1;
+            for (int i = 0; fd >= 0 && i < HTTPD_MAX_SESSIONS && i < s_config.max_open_sockets; ++i) {
+                if (s_sessions[i].fd < 0) {
+                    slot = i;
+                    break;
+                }
+            }
+            if (slot < 0) {
+                if (fd >= 0) {
+                    close(fd);
+                }
+            } else {
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                s_sessions[slot].fd = fd;
+                s_sessions[slot].len = 0;
+            }
+        }
+        for (int i = 0; i < HTTPD_MAX_SESSIONS; ++i) {
+            session_t *session = &s_sessions[i];
+            if (session->fd < 0 || !FD_ISSET(session->fd, &fds)) {
+                continue;
+            }
+            ssize_t n = recv(session->fd, session->buf + session->len, sizeof(session->buf) - 1 - session->len, 0);
+            if (n <= 0) {
+                session_close(session);
+                continue;
+            }
+            session->len += (size_t)n;
+            session_serve(session);
+            if (session->fd >= 0 && session->len == sizeof(session->buf) - 1) {
+                session_close(session);
+            }
+        }
+    }
+    return NULL;
+}
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
+{
+    /* Always an ephemeral port: the target's port may be taken on the host. */
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t addr_len = sizeof(addr);
+    s_config = *config;
+    for (int i = 0; i < HTTPD_MAX_SESSIONS; ++i) {
+        s_sessions[i].fd = -1;
+    }
+    s_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (s_listen_fd < 0 || bind(s_listen_fd, (struct sockaddr *)&addr, addr_len) != 0 ||
+        listen(s_listen_fd, HTTPD_MAX_SESSIONS) != 0 ||
+        getsockname(s_listen_fd, (struct sockaddr *)&addr, &addr_len) != 0) {
+        return ESP_FAIL;
+    }
+    if (pthread_create(&s_thread, NULL, server_thread, NULL) != 0) {
+        return ESP_FAIL;
+    }
+    s_port = ntohs(addr.sin_port);
+    *handle = &s_config;
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler)
+{
+    if (s_nb_handlers >= HTTPD_MAX_HANDLERS || s_nb_handlers >= s_config.max_uri_handlers) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_handlers[s_nb_handlers++] = *uri_handler;
+    return ESP_OK;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size)
+{
+    host_req_t *hr = r->aux;
+    size_t field_len = strlen(field);
+    const char *line = hr->headers;
+    while (*line) {
+        const char *line_end = strstr(line, "\r\n");
+        size_t line_len = line_end ? (size_t)(line_end - line) : strlen(line);
+        if (line_len > field_len && line[field_len] == ':' && strncasecmp(line, field, field_len) == 0) {
+            const char *value = line + field_len + 1;
+            while (*value == ' ') {
+                value++;
+            }
+            size_t value_len = (size_t)(line + line_len - value);
+            if (value_len >= val_size) {
+                memcpy(val, value, val_size - 1);
+                val[val_size - 1] = '\0';
+                return ESP_ERR_HTTPD_RESULT_TRUNC;
+            }
+            memcpy(val, value, value_len);
+            val[value_len] = '\0';
+            return ESP_OK;
+        }
+        if (!line_end) {
+            break;
+        }
+        line = line_end + 2;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    host_req_t *hr = r->aux;
+    if (!hr->query) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (strlen(hr->query) >= buf_len) {
+        return ESP_ERR_HTTPD_RESULT_TRUNC;
+    }
+    strcpy(buf, hr->query);
+    return ESP_OK;
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size)
+{
+    size_t key_len = strlen(key);
+    const char *p = qry;
+    while (*p) {
+        const char *end = strchr(p, '&');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (len > key_len && p[key_len] == '=' && strncmp(p, key, key_len) == 0) {
+            size_t value_len = len - key_len - 1;
+            if (value_len >= val_size) {
+                return ESP_ERR_HTTPD_RESULT_TRUNC;
+            }
+            memcpy(val, p + key_len + 1, value_len);
+            val[value_len] = '\0';
+            return ESP_OK;
+        }
+        if (!end) {
+            break;
+        }
+        p = end + 1;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status)
+{
+    ((host_req_t *)r->aux)->status = status;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type)
+{
+    ((host_req_t *)r->aux)->type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value)
+{
+    host_req_t *hr = r->aux;
+    if (hr->nb_hdrs >= HTTPD_RESP_HDRS_MAX) {
+        return ESP_ERR_NO_MEM;
+    }
+    hr->hdr_field[hr->nb_hdrs] = field;
+    hr->hdr_value[hr->nb_hdrs] = value;
+    hr->nb_hdrs++;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    host_req_t *hr = r->aux;
+    if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = buf ? (ssize_t)strlen(buf) : 0;
+    }
+    int len = snprintf(s_resp_head, sizeof(s_resp_head), "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zd\r\n",
+                       hr->status, hr->type, buf_len);
+    for (int i = 0; i < hr->nb_hdrs; ++i) {
+        len += snprintf(s_resp_head + len, sizeof(s_resp_head) - (size_t)len, "%s: %s\r\n", hr->hdr_field[i],
+                        hr->hdr_value[i]);
+    }
+    len += snprintf(s_resp_head + len, sizeof(s_resp_head) - (size_t)len, "\r\n");
+
+    struct iovec iov[2] = { { s_resp_head, (size_t)len }, { (void *)buf, (size_t)buf_len } };
+    struct msghdr msg = { .msg_iov = iov, .msg_iovlen = buf_len > 0 ? 2 : 1 };
+    size_t total = (size_t)len + (size_t)buf_len;
+    while (total > 0) {
+        ssize_t sent = sendmsg(hr->session->fd, &msg, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            session_close(hr->session);
+            return ESP_FAIL;
+        }
+        total -= (size_t)sent;
+        while (msg.msg_iovlen > 0 && (size_t)sent >= msg.msg_iov[0].iov_len) {
+            sent -= (ssize_t)msg.msg_iov[0].iov_len;
+            msg.msg_iov++;
+            msg.msg_iovlen--;
+        }
+        if (msg.msg_iovlen > 0) {
+            msg.msg_iov[0].iov_base = (char *)msg.msg_iov[0].iov_base + sent;
+            msg.msg_iov[0].iov_len -= (size_t)sent;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_sendstr(httpd_req_t *r, const char *str)
+{
+    return httpd_resp_send(r, str, HTTPD_RESP_USE_STRLEN);
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg)
+{
+    static const char *const STATUS[] = {
+        [HTTPD_400_BAD_REQUEST] = "400 Bad Request",
+        [HTTPD_404_NOT_FOUND] = "404 Not Found",
+        [HTTPD_500_INTERNAL_SERVER_ERROR] = "500 Internal Server Error",
+    };
+    httpd_resp_set_status(req, STATUS[error]);
+    httpd_resp_set_type(req, "text/plain");
+    return httpd_resp_sendstr(req, msg);
+}
+
+int httpd_req_to_sockfd(httpd_req_t *r)
+{
+    return ((host_req_t *)r->aux)->session->fd;
+}
+
+int httpd_send(httpd_req_t *r, const char *buf, size_t buf_len)
+{
+    return (int)send(httpd_req_to_sockfd(r), buf, buf_len, MSG_NOSIGNAL);
+}
+
+int httpd_socket_send(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags)
+{
+    return (int)send(sockfd, buf, buf_len, flags | MSG_NOSIGNAL);
+}
+
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd)
+{
+    for (int i = 0; i < HTTPD_MAX_SESSIONS; ++i) {
+        if (s_sessions[i].fd == sockfd) {
+            shutdown(sockfd, SHUT_RDWR);
+        }
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,2 @@
+/* Host stand-in for the board support header; nothing in it is used off target. */
+#pragma once
@@ -0,0 +1,15 @@
+/* Host stand-in for the ESP-IDF header: handlers are accepted and never run. */
+#pragma once
+
+#include "esp_err.h"
+#include "esp_event_base.h"
+
+typedef void *esp_event_handler_instance_t;
+
+static inline esp_err_t esp_event_handler_instance_register_with(esp_event_loop_handle_t loop,
+                                                                 esp_event_base_t base, int32_t id,
+                                                                 esp_event_handler_t handler, void *arg,
+                                                                 esp_event_handler_instance_t *instance)
+{
+    return ESP_OK;
+}
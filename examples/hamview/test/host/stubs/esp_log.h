@@ -0,0 +1,17 @@
+/* Host stand-in for the ESP-IDF header: warnings and errors go to stderr, the
+ * rest is only type-checked. */
+#pragma once
+
+#include <stdio.h>
+
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOG_DISCARD(tag, fmt, ...) \
+    do { \
+        if (0) { \
+            fprintf(stderr, "%s: " fmt "\n", tag, ##__VA_ARGS__); \
+        } \
+    } while (0)
+#define ESP_LOGI(tag, fmt, ...) ESP_LOG_DISCARD(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) ESP_LOG_DISCARD(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) ESP_LOG_DISCARD(tag, fmt, ##__VA_ARGS__)
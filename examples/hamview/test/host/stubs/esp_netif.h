@@ -0,0 +1,36 @@
+/* Host stand-in for the ESP-IDF header: the station interface is the
+ * loopback address. */
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_err.h"
+
+typedef struct {
+    uint32_t addr;
+} esp_ip4_addr_t;
+
+typedef struct {
+    esp_ip4_addr_t ip;
+    esp_ip4_addr_t netmask;
+    esp_ip4_addr_t gw;
+} esp_netif_ip_info_t;
+
+typedef struct esp_netif_obj esp_netif_t;
+
+#define esp_ip4_addr_get_byte(ipaddr, idx) (((const uint8_t *)(&(ipaddr)->addr))[idx])
+
+static inline esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key)
+{
+    static int sta;
+    return strcmp(if_key, "WIFI_STA_DEF") == 0 ? (esp_netif_t *)&sta : NULL;
+}
+
+static inline esp_err_t esp_netif_get_ip_info(esp_netif_t *netif, esp_netif_ip_info_t *ip_info)
+{
+    static const uint8_t loopback[4] = { 127, 0, 0, 1 };
+    memset(ip_info, 0, sizeof(*ip_info));
+    memcpy(&ip_info->ip.addr, loopback, sizeof(loopback));
+    return ESP_OK;
+}
@@ -0,0 +1,13 @@
+/* Host stand-in for the ESP-IDF header: SNTP never starts on the host. */
+#pragma once
+
+#include <sys/time.h>
+
+#define SNTP_OPMODE_POLL 0
+
+typedef void (*sntp_sync_time_cb_t)(struct timeval *tv);
+
+static inline void sntp_setoperatingmode(int mode) {}
+static inline void sntp_setservername(int idx, const char *server) {}
+static inline void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback) {}
+static inline void sntp_init(void) {}
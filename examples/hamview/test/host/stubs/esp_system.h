@@ -0,0 +1,10 @@
+/* Host stand-in for the ESP-IDF header. */
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+
+static inline uint32_t esp_random(void)
+{
+    return (uint32_t)random();
+}
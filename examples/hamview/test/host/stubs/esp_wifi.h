@@ -0,0 +1,5 @@
+/* Host stand-in for the ESP-IDF header; the hamview modules only get WiFi
+ * state through view events. */
+#pragma once
+
+#include "esp_err.h"
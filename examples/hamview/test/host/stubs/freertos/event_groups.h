@@ -0,0 +1,25 @@
+/* Host stand-in for the FreeRTOS header. The host tests drive the module
+ * functions directly, so nothing ever waits on a group. */
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef uint32_t EventBits_t;
+typedef void *EventGroupHandle_t;
+
+static inline EventGroupHandle_t xEventGroupCreate(void)
+{
+    static int group;
+    return &group;
+}
+
+static inline EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    return bits;
+}
+
+static inline EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                              BaseType_t wait_for_all, TickType_t ticks)
+{
+    return 0;
+}
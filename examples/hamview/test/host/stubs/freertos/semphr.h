@@ -0,0 +1,79 @@
+/* Host stand-in for the FreeRTOS header: a mutex is a pthread mutex, a binary
+ * semaphore a flag behind a condition variable so that timed takes work. */
+#pragma once
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool binary;
+    bool given;
+} host_semaphore_t;
+
+typedef host_semaphore_t *SemaphoreHandle_t;
+
+static inline SemaphoreHandle_t host_semaphore_create(bool binary)
+{
+    SemaphoreHandle_t sem = calloc(1, sizeof(*sem));
+    if (sem) {
+        pthread_mutex_init(&sem->mutex, NULL);
+        pthread_cond_init(&sem->cond, NULL);
+        sem->binary = binary;
+    }
+    return sem;
+}
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return host_semaphore_create(false);
+}
+
+static inline SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return host_semaphore_create(true);
+}
+
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    if (!sem->binary) {
+        return pthread_mutex_lock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+    }
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ticks / 1000;
+    deadline.tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_mutex_lock(&sem->mutex);
+    int err = 0;
+    while (!sem->given && err != ETIMEDOUT) {
+        err = ticks == portMAX_DELAY ? pthread_cond_wait(&sem->cond, &sem->mutex)
+                                     : pthread_cond_timedwait(&sem->cond, &sem->mutex, &deadline);
+    }
+    BaseType_t taken = sem->given ? pdTRUE : pdFALSE;
+    sem->given = false;
+    pthread_mutex_unlock(&sem->mutex);
+    return taken;
+}
+
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    if (!sem->binary) {
+        return pthread_mutex_unlock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+    }
+    pthread_mutex_lock(&sem->mutex);
+    BaseType_t given = sem->given ? pdFALSE : pdTRUE;
+    sem->given = true;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->mutex);
+    return given;
+}
@@ -0,0 +1,3 @@
+/* Host stand-in for the LVGL header: host builds only reach the lv_port
+ * declarations, which use no LVGL type. */
+#pragma once
@@ -0,0 +1,5 @@
+/* Host stand-in for the lwIP header: the BSD socket API is the host's own. */
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
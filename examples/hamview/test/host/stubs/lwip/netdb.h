@@ -0,0 +1,4 @@
+/* Host stand-in for the lwIP header: the resolver is the host's own. */
+#pragma once
+
+#include <netdb.h>
@@ -0,0 +1,6 @@
+/* Host stand-in for the lwIP header: the BSD socket API is the host's own. */
+#pragma once
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
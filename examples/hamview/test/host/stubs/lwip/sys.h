@@ -0,0 +1,2 @@
+/* Host stand-in for the lwIP header; nothing in it is used off target. */
+#pragma once
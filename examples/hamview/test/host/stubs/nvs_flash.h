@@ -0,0 +1,4 @@
+/* Host stand-in for the ESP-IDF header. */
+#pragma once
+
+#include "nvs.h"
@@ -0,0 +1,3 @@
+/* Host stand-in for the generated header: no Bluetooth, so the BLE and SPP
+ * transports compile out. */
+#pragma once
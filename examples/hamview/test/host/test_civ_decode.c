@@ -0,0 +1,162 @@
+/* Host test and benchmark of the CI-V decoder.
+ *
+ * Replays a CI-V byte stream in the IC-705 reply format through
+ * hamview_icom_on_civ_bytes(): once split at every chunk size, where the
+ * final state must always come out the same, once interleaved over two
+ * transports, and then in 512-byte reads for throughput. Raw captures given
+ * on the command line (bytes as read from the serial port, BLE or the CI-V
+ * socket payload) are replayed for throughput as well.
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hamview_icom.h"
+
+#define REPLAY_BYTES (1 << 16)
+#define REPLAY_ROUNDS 2000
+#define READ_SIZE 512
+
+/* One poll cycle's worth of replies plus a transceive push. */
+static const uint8_t STREAM[] = {
+    0xFE, 0xFE, 0xE1, 0xA4, 0x03, 0x00, 0x40, 0x07, 0x14, 0x00, 0xFD,       /* frequency 14.074000 */
+    0xFE, 0xFE, 0xE1, 0xA4, 0x04, 0x01, 0x02, 0xFD,                         /* USB, FIL2 */
+    0xFE, 0xFE, 0xE1, 0xA4, 0x15, 0x02, 0x01, 0x20, 0xFD,                   /* S-meter 120 */
+    0xFE, 0xFE, 0xE1, 0xA4, 0xFB, 0xFD,                                     /* OK */
+    0xFE, 0xFE, 0xE1, 0xA4, 0x1A, 0x06, 0x01, 0x02, 0xFD,                   /* data mode D1 */
+    0xFE, 0xFE, 0xE1, 0xA4, 0x1A, 0x03, 0x31, 0xFD,                         /* filter width index 31 */
+    0xFE, 0xFE, 0xE1, 0xA4, 0x0F, 0x01, 0xFD,                               /* split on */
+    0xFE, 0xFE, 0xE1, 0xA4, 0x25, 0x01, 0x00, 0x50, 0x07, 0x14, 0x00, 0xFD, /* unselected 14.075000 */
+    0xFE, 0xFE, 0xE1, 0xA4, 0x1C, 0x00, 0x01, 0xFD,                         /* transmitting */
+    0xFE, 0xFE, 0xE1, 0xA4, 0x15, 0x11, 0x02, 0x00, 0xFD,                   /* Po 200 */
+    0xFE, 0xFE, 0xE1, 0xA4, 0x15, 0x12, 0x00, 0x35, 0xFD,                   /* SWR 35 */
+    0xFE, 0xFE, 0xE1, 0xA4, 0x15, 0x13, 0x00, 0x07, 0xFD,                   /* ALC 7 */
+    0xFE, 0xFE, 0xE1, 0xA4, 0x14, 0x0A, 0x01, 0x28, 0xFD,                   /* RF power 128 */
+    0xFE, 0xFE, 0xFE, 0x00, 0xA4, 0x00, 0x00, 0x60, 0x07, 0x14, 0x00, 0xFD, /* pushed 14.076000, extra preamble */
+};
+#define STREAM_FRAMES 14
+
+static int check_state(const char *what)
+{
+    hamview_icom_state_t st;
+    hamview_icom_get_state(&st);
+    if (st.freq_hz != 14076000 || strcmp(st.mode, "USB") != 0 || st.filter != 2 || st.s_meter_raw != 120 ||
+        st.data_mode != 1 || st.filter_width_hz != 2700 || !st.split || st.unselected_freq_hz != 14075000 ||
+        !st.transmitting || st.power_meter_raw != 200 || st.swr_raw != 35 || st.alc_raw != 7 ||
+        st.rf_power_raw != 128) {
+        printf("%s: freq %" PRIu64 " mode %s filter %u S %u data %u width %u split %d unselected %" PRIu64
+               " tx %d Po %u SWR %u ALC %u RF %u\n",
+               what, st.freq_hz, st.mode, st.filter, st.s_meter_raw, st.data_mode, st.filter_width_hz, st.split,
+               st.unselected_freq_hz, st.transmitting, st.power_meter_raw, st.swr_raw, st.alc_raw, st.rf_power_raw);
+        return 1;
+    }
+    return 0;
+}
+
+static void feed(hamview_icom_transport_t transport, const uint8_t *data, size_t len, size_t chunk)
+{
+    for (size_t off = 0; off < len; off += chunk) {
+        size_t n = len - off < chunk ? len - off : chunk;
+        hamview_icom_on_civ_bytes(transport, data + off, n);
+    }
+}
+
+static double seconds_since(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* Decodes `len` bytes `rounds` times in READ_SIZE reads. */
+static double replay_seconds(const uint8_t *data, size_t len, int rounds)
+{
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < rounds; ++r) {
+        feed(HAMVIEW_ICOM_TRANSPORT_BLE, data, len, READ_SIZE);
+    }
+    return seconds_since(&start);
+}
+
+static size_t count_frames(const uint8_t *data, size_t len)
+{
+    size_t frames = 0;
+    for (size_t i = 0; i < len; ++i) {
+        frames += data[i] == 0xFD;
+    }
+    return frames;
+}
+
+static int replay_file(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        printf("%s: cannot open\n", path);
+        return 1;
+    }
+    uint8_t *data = malloc(REPLAY_BYTES);
+    size_t len = fread(data, 1, REPLAY_BYTES, f);
+    fclose(f);
+    size_t frames = count_frames(data, len);
+    int rounds = (int)(REPLAY_BYTES * (size_t)REPLAY_ROUNDS / (len ? len : 1));
+    hamview_icom_reset();
+    double s = replay_seconds(data, len, rounds);
+    printf("%s: %zu bytes, %zu frames, %.1f M frames/s\n", path, len, frames, (double)frames * rounds / s / 1e6);
+    free(data);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int errors = 0;
+    hamview_icom_init();
+
+    for (size_t chunk = 1; chunk <= sizeof(STREAM); ++chunk) {
+        hamview_icom_reset();
+        feed(HAMVIEW_ICOM_TRANSPORT_WIFI, STREAM, sizeof(STREAM), chunk);
+        char what[32];
+        snprintf(what, sizeof(what), "chunk size %zu", chunk);
+        if (check_state(what)) {
+            errors++;
+            break;
+        }
+    }
+    printf("every chunking decodes the same state: %s\n", errors ? "FAILED" : "ok");
+
+    /* Two links delivering the same stream in different read sizes, read by
+     * read in turn: a partial frame on one must not leak into the other. */
+    hamview_icom_reset();
+    size_t ble_off = 0;
+    size_t spp_off = 0;
+    while (ble_off < sizeof(STREAM) || spp_off < sizeof(STREAM)) {
+        size_t n = sizeof(STREAM) - ble_off < 5 ? sizeof(STREAM) - ble_off : 5;
+        hamview_icom_on_civ_bytes(HAMVIEW_ICOM_TRANSPORT_BLE, STREAM + ble_off, n);
+        ble_off += n;
+        n = sizeof(STREAM) - spp_off < 7 ? sizeof(STREAM) - spp_off : 7;
+        hamview_icom_on_civ_bytes(HAMVIEW_ICOM_TRANSPORT_SPP, STREAM + spp_off, n);
+        spp_off += n;
+    }
+    int interleaved = check_state("interleaved transports");
+    printf("interleaved transports: %s\n", interleaved ? "FAILED" : "ok");
+    errors += interleaved;
+
+    static uint8_t big[REPLAY_BYTES];
+    size_t len = 0;
+    while (len + sizeof(STREAM) <= sizeof(big)) {
+        memcpy(big + len, STREAM, sizeof(STREAM));
+        len += sizeof(STREAM);
+    }
+    size_t frames = len / sizeof(STREAM) * STREAM_FRAMES;
+    hamview_icom_reset();
+    double s = replay_seconds(big, len, REPLAY_ROUNDS);
+    printf("replay in %d-byte reads: %.1f M frames/s (%zu frames in %.2f s)\n", READ_SIZE,
+           (double)frames * REPLAY_ROUNDS / s / 1e6, frames * REPLAY_ROUNDS, s);
+
+    for (int i = 1; i < argc; ++i) {
+        errors += replay_file(argv[i]);
+    }
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
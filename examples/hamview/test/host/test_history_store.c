@@ -0,0 +1,322 @@
+/* Host test and benchmark of the on-flash spot history log.
+ *
+ * The store is compiled into this file so that the test can play the role of
+ * the checkpoint task and reboot the module by resetting its state. The
+ * partition is a RAM array with NOR semantics: erase sets a sector to 0xFF,
+ * programming can only clear bits, and any write that would need to set a bit
+ * is counted as a violation.
+ *
+ * The benchmark feeds 10k spots spread over 24 h, checkpointing the way the
+ * task does (every 32 records or 60 s), then reboots and restores the window.
+ * It reports write amplification, erases, programs and what the restore read.
+ * A log left by the first 32-byte record layout must still restore, followed
+ * by what is appended after the upgrade.
+ */
+#include "hamview_history_store.c"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#define FLASH_SIZE (2 * 1024 * 1024)
+#define DAY_S 86400u
+#define EPOCH_BASE 1700000000u
+
+/* ---- flash model ---- */
+
+static uint8_t s_flash[FLASH_SIZE];
+static esp_partition_t s_partition = { .type = ESP_PARTITION_TYPE_DATA, .size = FLASH_SIZE, .label = "hamhist" };
+static uint32_t s_sector_erases[FLASH_SIZE / STORE_SECTOR_SIZE];
+static uint64_t s_bytes_programmed;
+static uint64_t s_program_ops;
+static uint64_t s_bytes_read;
+static uint64_t s_read_ops;
+static uint64_t s_nor_violations;
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+    return strcmp(label, s_partition.label) == 0 ? &s_partition : NULL;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    if (src_offset + size > partition->size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(dst, &s_flash[src_offset], size);
+    s_bytes_read += size;
+    s_read_ops++;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    if (dst_offset + size > partition->size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    const uint8_t *bytes = src;
+    for (size_t i = 0; i < size; ++i) {
+        if ((s_flash[dst_offset + i] & bytes[i]) != bytes[i]) {
+            s_nor_violations++;
+        }
+        s_flash[dst_offset + i] &= bytes[i];
+    }
+    s_bytes_programmed += size;
+    s_program_ops++;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    if (offset % STORE_SECTOR_SIZE || size % STORE_SECTOR_SIZE || offset + size > partition->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(&s_flash[offset], 0xFF, size);
+    for (size_t s = offset / STORE_SECTOR_SIZE; s < (offset + size) / STORE_SECTOR_SIZE; ++s) {
+        s_sector_erases[s]++;
+    }
+    return ESP_OK;
+}
+
+/* ---- checkpoint task ---- */
+
+static int s_task_handle;
+static bool s_notified;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    *handle = &s_task_handle;
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    s_notified = true;
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    return 0;
+}
+
+static void reset_flash(void)
+{
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    memset(s_sector_erases, 0, sizeof(s_sector_erases));
+    s_bytes_programmed = 0;
+    s_program_ops = 0;
+    s_nor_violations = 0;
+}
+
+/* Power cycle: the RAM side of the store is gone, the flash stays. */
+static void reboot(void)
+{
+    s_part = NULL;
+    s_task = NULL;
+    s_sector_count = 0;
+    s_cur_sector = 0;
+    s_cur_seq = 0;
+    s_cur_index = 0;
+    s_pending_count = 0;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_notified = false;
+    if (hamview_history_store_init() != ESP_OK) {
+        printf("store init failed\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* Appends `count` records `interval_s` apart starting at `first_epoch`, with
+ * the task's checkpoint policy. Returns the epoch of the last record. */
+static uint32_t feed(uint32_t first_epoch, uint32_t count, uint32_t interval_s)
+{
+    uint32_t epoch = first_epoch;
+    uint32_t last_checkpoint = first_epoch;
+    for (uint32_t i = 0; i < count; ++i) {
+        epoch = first_epoch + i * interval_s;
+        hamview_history_record_t rec = { .epoch = epoch, .mode_class = (uint8_t)(i % 4) };
+        snprintf(rec.callsign, sizeof(rec.callsign), "K%" PRIu32 "X", epoch % 100000);
+        snprintf(rec.frequency, sizeof(rec.frequency), "%" PRIu32 ".000", 1800 + epoch % 50000);
+        snprintf(rec.mode, sizeof(rec.mode), "%s", i % 2 ? "FT8" : "CW");
+        snprintf(rec.spotter, sizeof(rec.spotter), "W%" PRIu32 "SKM", epoch % 10);
+        snprintf(rec.dxcc, sizeof(rec.dxcc), "291");
+        snprintf(rec.continent, sizeof(rec.continent), "NA");
+        snprintf(rec.country, sizeof(rec.country), "United States");
+        snprintf(rec.comment, sizeof(rec.comment), "CQ %" PRIu32 " dB, a comment too long for the record",
+                 epoch % 30);
+        hamview_history_store_append(&rec);
+        if (s_notified || epoch - last_checkpoint >= STORE_CHECKPOINT_MS / 1000) {
+            s_notified = false;
+            last_checkpoint = epoch;
+            store_checkpoint();
+        }
+    }
+    store_checkpoint();
+    return epoch;
+}
+
+/* ---- restore checks ---- */
+
+typedef struct {
+    uint32_t expected_epoch;
+    uint32_t interval_s;
+    uint32_t v1_until; /* records before this epoch were logged by the first layout */
+    size_t count;
+    size_t errors;
+} restore_ctx_t;
+
+static void on_restore(const hamview_history_record_t *rec, void *arg)
+{
+    restore_ctx_t *ctx = arg;
+    char callsign[sizeof(rec->callsign)];
+    char spotter[sizeof(rec->spotter)];
+    char comment[sizeof(rec->comment)];
+    snprintf(callsign, sizeof(callsign), "K%" PRIu32 "X", rec->epoch % 100000);
+    if (rec->epoch < ctx->v1_until) {
+        spotter[0] = '\0';
+        comment[0] = '\0';
+    } else {
+        snprintf(spotter, sizeof(spotter), "W%" PRIu32 "SKM", rec->epoch % 10);
+        snprintf(comment, sizeof(comment), "CQ %" PRIu32 " dB, a comment too long for the record",
+                 rec->epoch % 30);
+    }
+    if (rec->epoch != ctx->expected_epoch || strcmp(rec->callsign, callsign) != 0 ||
+        strcmp(rec->spotter, spotter) != 0 || strcmp(rec->comment, comment) != 0 ||
+        strcmp(rec->country, rec->epoch < ctx->v1_until ? "" : "United States") != 0) {
+        if (ctx->errors++ == 0) {
+            printf("  record %zu: epoch %" PRIu32 " %s, expected %" PRIu32 "\n", ctx->count, rec->epoch,
+                   rec->callsign, ctx->expected_epoch);
+        }
+    }
+    ctx->expected_epoch = rec->epoch + ctx->interval_s;
+    ctx->count++;
+}
+
+static int check_restore_v1(const char *name, uint32_t since, uint32_t first_expected, size_t expected_count,
+                            uint32_t interval_s, uint32_t v1_until)
+{
+    restore_ctx_t ctx = { .expected_epoch = first_expected, .interval_s = interval_s, .v1_until = v1_until };
+    size_t replayed = hamview_history_store_restore(since, on_restore, &ctx);
+    bool ok = replayed == ctx.count && ctx.count == expected_count && ctx.errors == 0;
+    printf("%-28s %5zu records (expected %zu) %s\n", name, ctx.count, expected_count, ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+static int check_restore(const char *name, uint32_t since, uint32_t first_expected, size_t expected_count,
+                         uint32_t interval_s)
+{
+    return check_restore_v1(name, since, first_expected, expected_count, interval_s, 0);
+}
+
+/* Writes what the first layout left behind: `sectors` full sectors of
+ * 32-byte records, `interval_s` apart from `first_epoch`, then `tail` more
+ * in the next sector. Returns the epoch after the last one. */
+static uint32_t write_v1_log(uint32_t first_epoch, uint32_t sectors, uint32_t tail, uint32_t interval_s)
+{
+    const uint32_t per_sector = STORE_SECTOR_SIZE / STORE_V1_RECORD_SIZE - 1;
+    uint32_t epoch = first_epoch;
+    for (uint32_t sector = 0; sector <= sectors; ++sector) {
+        store_sector_header_t header;
+        memset(&header, 0xFF, sizeof(header));
+        header.magic = STORE_V1_MAGIC;
+        header.seq = sector + 1;
+        header.record_size = STORE_V1_RECORD_SIZE;
+        esp_partition_write(&s_partition, sector * STORE_SECTOR_SIZE, &header, sizeof(header));
+        uint32_t count = sector < sectors ? per_sector : tail;
+        for (uint32_t i = 0; i < count; ++i, epoch += interval_s) {
+            store_record_v1_t rec;
+            memset(&rec, 0, sizeof(rec));
+            rec.epoch = epoch;
+            snprintf(rec.callsign, sizeof(rec.callsign), "K%" PRIu32 "X", epoch % 100000);
+            snprintf(rec.frequency, sizeof(rec.frequency), "%" PRIu32 ".000", 1800 + epoch % 50000);
+            rec.crc = record_crc(&rec, sizeof(rec));
+            esp_partition_write(&s_partition, sector * STORE_SECTOR_SIZE + (i + 1) * STORE_V1_RECORD_SIZE, &rec,
+                                sizeof(rec));
+        }
+    }
+    return epoch;
+}
+
+static uint32_t max_sector_erases(void)
+{
+    uint32_t max = 0;
+    for (size_t s = 0; s < FLASH_SIZE / STORE_SECTOR_SIZE; ++s) {
+        if (s_sector_erases[s] > max) {
+            max = s_sector_erases[s];
+        }
+    }
+    return max;
+}
+
+int main(void)
+{
+    const uint32_t records = 10000;
+    const uint32_t interval_s = DAY_S / records;
+    const uint32_t capacity = (FLASH_SIZE / STORE_SECTOR_SIZE) * STORE_RECORDS_PER_SECTOR;
+    hamview_history_store_stats_t stats;
+    int errors = 0;
+
+    /* 10k spots over one day into an empty partition. */
+    reset_flash();
+    reboot();
+    uint32_t last = feed(EPOCH_BASE, records, interval_s);
+    hamview_history_store_get_stats(&stats);
+    printf("write: %" PRIu32 " records, %" PRIu64 " payload bytes, %" PRIu64 " programmed in %" PRIu64
+           " programs, %" PRIu32 " erases\n",
+           stats.appended, stats.payload_bytes, s_bytes_programmed, s_program_ops, stats.sectors_erased);
+    printf("write amplification %.4f, %" PRIu32 " checkpoints, %" PRIu64 " NOR violations, %" PRIu32 " dropped\n",
+           (double)s_bytes_programmed / (double)stats.payload_bytes, stats.checkpoints, s_nor_violations,
+           stats.dropped);
+    errors += s_nor_violations != 0 || stats.dropped != 0;
+
+    reboot();
+    s_bytes_read = 0;
+    s_read_ops = 0;
+    int64_t t0 = esp_timer_get_time();
+    errors += check_restore("restore last 24 h", last - DAY_S, EPOCH_BASE, records, interval_s);
+    int64_t elapsed_us = esp_timer_get_time() - t0;
+    printf("restore read %" PRIu64 " bytes in %" PRIu64 " reads, %.2f ms on the host\n", s_bytes_read, s_read_ops,
+           (double)elapsed_us / 1000.0);
+
+    s_bytes_read = 0;
+    errors += check_restore("restore last hour", last - 3600, last - (3600 / interval_s) * interval_s,
+                            3600 / interval_s + 1, interval_s);
+    printf("restore read %" PRIu64 " bytes\n", s_bytes_read);
+
+    /* A power cut in the middle of a program leaves a torn slot behind. */
+    size_t torn = slot_offset(s_cur_sector, s_cur_index);
+    memset(&s_flash[torn], 0x00, STORE_RECORD_SIZE / 2);
+    reboot();
+    uint32_t resumed = last + interval_s;
+    last = feed(resumed, 100, interval_s);
+    reboot();
+    errors += check_restore("restore after torn write", resumed, resumed, 100, interval_s);
+    errors += s_nor_violations != 0;
+
+    /* Four times the capacity: the ring wraps and erases stay level. */
+    reset_flash();
+    reboot();
+    last = feed(EPOCH_BASE, 4 * capacity, 5);
+    hamview_history_store_get_stats(&stats);
+    reboot();
+    /* Every sector but the head one is full and holds the newest records. */
+    size_t kept = (size_t)(s_sector_count - 1) * STORE_RECORDS_PER_SECTOR + s_cur_index;
+    errors += check_restore("restore after wrap", 0, last - (uint32_t)(kept - 1) * 5, kept, 5);
+    printf("wrap: %" PRIu32 " erases, max %" PRIu32 " per sector over %u sectors, %" PRIu64 " NOR violations\n",
+           stats.sectors_erased, max_sector_erases(), FLASH_SIZE / STORE_SECTOR_SIZE, s_nor_violations);
+    errors += s_nor_violations != 0;
+
+    /* Upgrade: a first-layout log, then spots logged by this one. */
+    reset_flash();
+    uint32_t v1_count = 3 * (STORE_SECTOR_SIZE / STORE_V1_RECORD_SIZE - 1) + 40;
+    uint32_t upgraded = write_v1_log(EPOCH_BASE, 3, 40, 5);
+    reboot();
+    last = feed(upgraded, 100, 5);
+    reboot();
+    errors += check_restore_v1("restore after upgrade", 0, EPOCH_BASE, v1_count + 100, 5, upgraded);
+    errors += s_nor_violations != 0;
+
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,392 @@
+/* Host test and load benchmark of the hamview JSON endpoints.
+ *
+ * The backend is compiled into this file and its real httpd handlers are
+ * served by host_httpd.c, a single-task esp_http_server stand-in on loopback.
+ * The spot list is fed through the real parser and update path; the other
+ * modules the backend talks to (settings, alerts, stream, UI, flash log) are
+ * inert stand-ins below.
+ *
+ * Checks the conditional GET rules: /api/spots revalidates to 304 only on an
+ * exact entity tag (also inside a list, weak or "*"), not on a prefix, and
+ * not on a tag from a previous boot even when the generation number comes
+ * back; /api/status carries no ETag and is always sent whole.
+ *
+ * Then several dashboards poll the three endpoints the page polls as fast
+ * as the server answers while spots keep arriving. Reported: requests/s,
+ * the share of /api/spots answered with 304, serializations, server CPU per
+ * request, and heap churn per request on the server task.
+ */
+#include <malloc.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+
+#include "hamview_backend.c"
+
+#define NB_DASHBOARDS 4
+#define LOAD_SECONDS 3
+#define SPOT_INTERVAL_MS 50
+#define CLIENT_BUF_SIZE (64 * 1024)
+
+/* ---- heap accounting, server task only ---- */
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static atomic_ulong s_server_allocs;
+static atomic_ulong s_server_alloc_bytes;
+
+static void heap_count(size_t size)
+{
+    if (host_httpd_in_server) {
+        atomic_fetch_add(&s_server_allocs, 1);
+        atomic_fetch_add(&s_server_alloc_bytes, size);
+    }
+}
+
+void *malloc(size_t size)
+{
+    heap_count(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    heap_count(nmemb * size);
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    heap_count(size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+/* ---- inert stand-ins for the rest of the firmware ---- */
+
+ESP_EVENT_DEFINE_BASE(VIEW_EVENT_BASE);
+esp_event_loop_handle_t view_event_handle;
+
+void hamview_settings_get(hamview_settings_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->spot_ttl_minutes = 30;
+}
+
+void hamview_alert_init(void) {}
+void hamview_alert_on_settings_updated(void) {}
+bool hamview_alert_is_high_priority(const hamview_spot_t *spot) { return false; }
+void hamview_alert_notify(const hamview_spot_t *spot) {}
+void hamview_alert_get_stats(hamview_alert_stats_t *out) { memset(out, 0, sizeof(*out)); }
+void hamview_event_log_append(const char *source, const char *fmt, ...) {}
+esp_err_t hamview_history_store_init(void) { return ESP_ERR_NOT_FOUND; }
+void hamview_history_store_append(const hamview_history_record_t *record) {}
+size_t hamview_history_store_restore(uint32_t since_epoch, hamview_history_restore_cb_t cb, void *ctx) { return 0; }
+void hamview_history_store_get_stats(hamview_history_store_stats_t *out) { memset(out, 0, sizeof(*out)); }
+esp_err_t hamview_stream_init(httpd_handle_t hd) { return ESP_OK; }
+esp_err_t hamview_stream_handler(httpd_req_t *req) { return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "no stream"); }
+void hamview_stream_on_close(httpd_handle_t hd, int sockfd) {}
+void hamview_stream_publish_spot(const hamview_spot_t *spot) {}
+void hamview_stream_get_stats(hamview_stream_stats_t *out) { memset(out, 0, sizeof(*out)); }
+void hamview_ui_get_refresh_stats(hamview_ui_refresh_stats_t *out) { memset(out, 0, sizeof(*out)); }
+bool hamview_weather_get(hamview_weather_info_t *out) { return false; }
+esp_err_t hamview_ingest_init(hamview_ingest_line_cb_t cb) { return ESP_OK; }
+void hamview_ingest_feed(const char *data, size_t len) {}
+void hamview_ingest_reset_line(void) {}
+void hamview_ingest_get_stats(hamview_ingest_stats_t *out) { memset(out, 0, sizeof(*out)); }
+void lv_port_notify(void) {}
+void lv_port_get_stats(lv_port_stats_t *out) { memset(out, 0, sizeof(*out)); }
+esp_err_t lv_port_set_render_mode(lv_port_render_mode_t mode) { return ESP_ERR_NOT_SUPPORTED; }
+const char *lv_port_render_mode_name(lv_port_render_mode_t mode) { return "partial"; }
+bool lv_port_render_mode_from_name(const char *name, lv_port_render_mode_t *out) { return false; }
+
+/* The REST fallback is compiled but never reached. */
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config) { return NULL; }
+esp_err_t esp_http_client_open(esp_http_client_handle_t client, int write_len) { return ESP_FAIL; }
+int64_t esp_http_client_fetch_headers(esp_http_client_handle_t client) { return -1; }
+int esp_http_client_get_status_code(esp_http_client_handle_t client) { return 0; }
+int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len) { return -1; }
+esp_err_t esp_http_client_close(esp_http_client_handle_t client) { return ESP_OK; }
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client) { return ESP_OK; }
+
+/* ---- HTTP client ---- */
+
+typedef struct {
+    int fd;
+    char *buf;
+    int status;
+    char etag[32];
+    bool has_etag;
+    size_t body_len;
+} client_t;
+
+static bool client_connect(client_t *c)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(host_httpd_port()),
+                                .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    int one = 1;
+    c->buf = __libc_malloc(CLIENT_BUF_SIZE);
+    c->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (!c->buf || c->fd < 0 || connect(c->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        return false;
+    }
+    setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return true;
+}
+
+/* One keep-alive GET; fills status, ETag and body length. */
+static bool client_get(client_t *c, const char *path, const char *if_none_match)
+{
+    char request[256];
+    int len = snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: hamview\r\n", path);
+    if (if_none_match) {
+        len += snprintf(request + len, sizeof(request) - (size_t)len, "If-None-Match: %s\r\n", if_none_match);
+    }
+    len += snprintf(request + len, sizeof(request) - (size_t)len, "\r\n");
+    if (send(c->fd, request, (size_t)len, MSG_NOSIGNAL) != len) {
+        return false;
+    }
+
+    size_t have = 0;
+    char *head_end = NULL;
+    while (!head_end) {
+        ssize_t n = recv(c->fd, c->buf + have, CLIENT_BUF_SIZE - 1 - have, 0);
+        if (n <= 0) {
+            return false;
+        }
+        have += (size_t)n;
+        c->buf[have] = '\0';
+        head_end = strstr(c->buf, "\r\n\r\n");
+    }
+    size_t head_len = (size_t)(head_end - c->buf) + 4;
+    c->status = atoi(c->buf + 9);
+    const char *length = strcasestr(c->buf, "\r\nContent-Length: ");
+    c->body_len = length && length < head_end ? strtoul(length + 18, NULL, 10) : 0;
+    const char *etag = strcasestr(c->buf, "\r\nETag: ");
+    c->has_etag = etag && etag < head_end;
+    if (c->has_etag) {
+        size_t etag_len = strcspn(etag + 8, "\r");
+        snprintf(c->etag, sizeof(c->etag), "%.*s", (int)etag_len, etag + 8);
+    }
+    if (head_len + c->body_len >= CLIENT_BUF_SIZE) {
+        return false;
+    }
+    while (have < head_len + c->body_len) {
+        ssize_t n = recv(c->fd, c->buf + have, head_len + c->body_len - have, 0);
+        if (n <= 0) {
+            return false;
+        }
+        have += (size_t)n;
+    }
+    return true;
+}
+
+/* ---- spot feed ---- */
+
+static uint32_t s_spot_seq;
+
+static void add_spot(void)
+{
+    char json[256];
+    uint32_t seq = ++s_spot_seq;
+    int len = snprintf(json, sizeof(json),
+                       "{\"callsign\":\"K%" PRIu32 "ABC\",\"frequency\":\"%" PRIu32 ".5\",\"mode\":\"ft8\","
+                       "\"spotter\":\"W1AW\",\"time\":\"12:%02" PRIu32 "\",\"dxcc\":\"291\",\"continent\":\"NA\","
+                       "\"entity\":\"United States\",\"comment\":\"-12 dB\"}",
+                       seq % 10, 14000 + seq % 350, seq % 60);
+    process_spot_json(json, (size_t)len);
+}
+
+/* ---- conditional GET rules ---- */
+
+static int expect(const char *what, client_t *c, int status, bool has_etag)
+{
+    if (c->status == status && c->has_etag == has_etag) {
+        return 0;
+    }
+    printf("%s: got %d%s, expected %d%s\n", what, c->status, c->has_etag ? " with ETag" : "", status,
+           has_etag ? " with ETag" : "");
+    return 1;
+}
+
+static int check_conditional_get(void)
+{
+    client_t c;
+    char etag[32];
+    char other[64];
+    int errors = 0;
+    if (!client_connect(&c)) {
+        printf("cannot connect to the httpd stand-in\n");
+        return 1;
+    }
+    while (s_snapshot_generation < 12) {
+        add_spot();
+    }
+
+    client_get(&c, "/api/spots", NULL);
+    errors += expect("first GET", &c, 200, true);
+    strlcpy(etag, c.etag, sizeof(etag));
+    client_get(&c, "/api/spots", etag);
+    errors += expect("same ETag", &c, 304, true);
+    errors += c.body_len != 0;
+
+    /* "...-12" held, "...-1" and "...-123" sent: both are other generations. */
+    snprintf(other, sizeof(other), "%.*s\"", (int)strlen(etag) - 2, etag);
+    client_get(&c, "/api/spots", other);
+    errors += expect("ETag prefix", &c, 200, true);
+    snprintf(other, sizeof(other), "%.*s3\"", (int)strlen(etag) - 1, etag);
+    client_get(&c, "/api/spots", other);
+    errors += expect("ETag extension", &c, 200, true);
+    snprintf(other, sizeof(other), "W/\"x\", %s", etag);
+    client_get(&c, "/api/spots", other);
+    errors += expect("ETag in a list", &c, 304, true);
+    client_get(&c, "/api/spots", "*");
+    errors += expect("If-None-Match: *", &c, 304, true);
+
+    add_spot();
+    client_get(&c, "/api/spots", etag);
+    errors += expect("after a new spot", &c, 200, true);
+    errors += strcmp(c.etag, etag) == 0;
+
+    /* Reboot: empty cache, a new nonce, and generations counting up from
+     * where they were to the one the page still holds. */
+    uint32_t held = s_spots_json_generation - 1;
+    s_http_etag_nonce ^= 0x5a5a5a5au;
+    s_spots_json_len = 0;
+    xSemaphoreTake(s_spot_mutex, portMAX_DELAY);
+    s_snapshot_generation = held - 1;
+    xSemaphoreGive(s_spot_mutex);
+    add_spot();
+    client_get(&c, "/api/spots", etag);
+    errors += expect("ETag from before a reboot", &c, 200, true);
+    if (s_spots_json_generation != held) {
+        printf("reboot: generation %" PRIu32 ", expected %" PRIu32 "\n", s_spots_json_generation, held);
+        errors++;
+    }
+
+    client_get(&c, "/api/status", NULL);
+    errors += expect("status", &c, 200, false);
+    client_get(&c, "/api/status", "*");
+    errors += expect("status, If-None-Match: *", &c, 200, false);
+
+    close(c.fd);
+    __libc_free(c.buf);
+    printf("conditional GET: %s\n", errors ? "FAILED" : "ok");
+    return errors;
+}
+
+/* ---- load ---- */
+
+typedef struct {
+    pthread_t thread;
+    uint32_t requests;
+    uint32_t spots_200;
+    uint32_t spots_304;
+    uint32_t failures;
+} dashboard_t;
+
+static atomic_bool s_stop;
+
+static void *dashboard_thread(void *arg)
+{
+    dashboard_t *d = arg;
+    client_t c;
+    char etag[32] = "";
+    if (!client_connect(&c)) {
+        d->failures++;
+        return NULL;
+    }
+    while (!atomic_load(&s_stop)) {
+        if (!client_get(&c, "/api/spots", etag[0] ? etag : NULL) ||
+            (c.status == 200 ? d->spots_200++ : c.status == 304 ? d->spots_304++ : d->failures++, false)) {
+            d->failures++;
+            break;
+        }
+        strlcpy(etag, c.etag, sizeof(etag));
+        if (!client_get(&c, "/api/status", NULL) || c.status != 200 || !client_get(&c, "/api/display", NULL) ||
+            c.status != 200) {
+            d->failures++;
+            break;
+        }
+        d->requests += 3;
+    }
+    close(c.fd);
+    __libc_free(c.buf);
+    return NULL;
+}
+
+static int run_load(void)
+{
+    dashboard_t dashboards[NB_DASHBOARDS] = { 0 };
+    uint32_t requests = 0;
+    uint32_t spots_200 = 0;
+    uint32_t spots_304 = 0;
+    uint32_t failures = 0;
+    uint32_t serializations = s_http_serializations;
+    uint64_t cpu_us = host_httpd_cpu_us();
+    atomic_store(&s_server_allocs, 0);
+    atomic_store(&s_server_alloc_bytes, 0);
+
+    int64_t start_us = esp_timer_get_time();
+    for (int i = 0; i < NB_DASHBOARDS; ++i) {
+        pthread_create(&dashboards[i].thread, NULL, dashboard_thread, &dashboards[i]);
+    }
+    while (esp_timer_get_time() - start_us < LOAD_SECONDS * 1000000LL) {
+        usleep(SPOT_INTERVAL_MS * 1000);
+        add_spot();
+    }
+    atomic_store(&s_stop, true);
+    for (int i = 0; i < NB_DASHBOARDS; ++i) {
+        pthread_join(dashboards[i].thread, NULL);
+        requests += dashboards[i].requests;
+        spots_200 += dashboards[i].spots_200;
+        spots_304 += dashboards[i].spots_304;
+        failures += dashboards[i].failures;
+    }
+    double seconds = (double)(esp_timer_get_time() - start_us) / 1e6;
+    cpu_us = host_httpd_cpu_us() - cpu_us;
+    serializations = s_http_serializations - serializations;
+
+    printf("%d dashboards, spot every %d ms: %.0f requests/s, /api/spots %.1f%% 304, %" PRIu32
+           " serializations for %" PRIu32 " spot requests\n",
+           NB_DASHBOARDS, SPOT_INTERVAL_MS, requests / seconds, 100.0 * spots_304 / (spots_200 + spots_304),
+           serializations, spots_200 + spots_304);
+    printf("server task: %.1f us CPU per request, heap %.3f allocations and %.1f bytes per request\n",
+           (double)cpu_us / requests, (double)atomic_load(&s_server_allocs) / requests,
+           (double)atomic_load(&s_server_alloc_bytes) / requests);
+    if (failures || requests == 0) {
+        printf("%" PRIu32 " failed requests\n", failures);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    s_spot_mutex = xSemaphoreCreateMutex();
+    s_status_mutex = xSemaphoreCreateMutex();
+    s_backend_events = xEventGroupCreate();
+    hamview_settings_get(&s_settings);
+    if (hamview_history_init(HAMVIEW_HISTORY_MAX_SPOTS, history_on_evict) != ESP_OK) {
+        printf("history init failed\n");
+        return EXIT_FAILURE;
+    }
+    set_ip_address("127.0.0.1");
+    set_hamalert_connected(true);
+    start_http_server();
+    if (!host_httpd_port()) {
+        printf("httpd stand-in did not start\n");
+        return EXIT_FAILURE;
+    }
+
+    int errors = check_conditional_get();
+    errors += run_load();
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
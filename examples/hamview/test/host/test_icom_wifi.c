@@ -0,0 +1,515 @@
+/* Host test of the IC-705 WiFi link against a UDP stand-in of the radio.
+ *
+ * The stand-in listens on a control port and on the CI-V port next to it,
+ * answers the handshake (are-you-there, login, token, stream request, CI-V
+ * open) and every CI-V poll, and can push transceive updates the way the
+ * radio does when "CI-V Transceive" is on. Like the radio it only accepts
+ * CI-V on the CI-V port with the type 0 header, so the route probing runs
+ * too. civ_wifi_task() runs unmodified on a pthread and talks to it over
+ * loopback.
+ *
+ * Reported: time from start to the first decoded frequency, CI-V datagrams
+ * per second while idle, and how long a frequency change on the radio takes
+ * to reach hamview_icom_get_state(), with and without transceive. Checked:
+ * every change arrives within TRACKING_MAX_MS, and the CI-V datagram rate
+ * stays within one per frequency poll period when polling, and under the
+ * six per second of the old fixed 500 ms poll once the radio pushes.
+ */
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hamview_icom.h"
+
+#define RADIO_ID 0x1A2B3C4Du
+#define RADIO_ADDR 0xA4
+#define TUNE_STEPS 40
+#define TUNE_STEP_MS 100
+#define TRACKING_MAX_MS 100
+/* Datagrams/s: one per 80 ms frequency poll plus slack, and the three
+ * datagrams per 500 ms the old poll loop sent. */
+#define POLLED_CIV_RATE_MAX 13.5
+#define PUSHED_CIV_RATE_MAX 6.0
+
+/* ---- radio stand-in ---- */
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+typedef struct {
+    int ctrl_sock;
+    int civ_sock;
+    uint16_t ctrl_port;
+    pthread_t thread;
+    atomic_bool stop;
+
+    pthread_mutex_t lock;
+    uint64_t freq_hz;
+    bool transceive;
+    bool civ_open;
+    struct sockaddr_in civ_peer;
+    uint16_t civ_seq;
+
+    /* What the client sent, for the packet counts. */
+    atomic_uint ctrl_datagrams;
+    atomic_uint civ_datagrams;
+    atomic_uint civ_requests;
+    atomic_uint civ_frames;
+    atomic_uint civ_rejected;
+} radio_t;
+
+static radio_t s_radio;
+
+static void put_u16_le(uint8_t *buf, size_t off, uint16_t v)
+{
+    buf[off] = (uint8_t)v;
+    buf[off + 1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32_le(uint8_t *buf, size_t off, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) {
+        buf[off + i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static void put_u16_be(uint8_t *buf, size_t off, uint16_t v)
+{
+    buf[off] = (uint8_t)(v >> 8);
+    buf[off + 1] = (uint8_t)v;
+}
+
+static uint16_t get_u16_le(const uint8_t *buf, size_t off)
+{
+    return (uint16_t)(buf[off] | (buf[off + 1] << 8));
+}
+
+static uint32_t get_u32_le(const uint8_t *buf, size_t off)
+{
+    return (uint32_t)buf[off] | ((uint32_t)buf[off + 1] << 8) | ((uint32_t)buf[off + 2] << 16) |
+           ((uint32_t)buf[off + 3] << 24);
+}
+
+static void reply(int sock, const struct sockaddr_in *to, const uint8_t *packet, size_t len)
+{
+    sendto(sock, packet, len, 0, (const struct sockaddr *)to, sizeof(*to));
+}
+
+static void reply_control(int sock, const struct sockaddr_in *to, const uint8_t *rx, uint16_t type)
+{
+    uint8_t packet[0x10] = {0};
+    put_u32_le(packet, 0, sizeof(packet));
+    put_u16_le(packet, 4, type);
+    put_u16_le(packet, 6, get_u16_le(rx, 6));
+    put_u32_le(packet, 8, RADIO_ID);
+    put_u32_le(packet, 12, get_u32_le(rx, 8));
+    reply(sock, to, packet, sizeof(packet));
+}
+
+static void freq_to_bcd(uint64_t hz, uint8_t out[5])
+{
+    for (int i = 0; i < 5; ++i) {
+        uint8_t low = (uint8_t)(hz % 10);
+        hz /= 10;
+        uint8_t high = (uint8_t)(hz % 10);
+        hz /= 10;
+        out[i] = (uint8_t)((high << 4) | low);
+    }
+}
+
+/* Sends CI-V bytes to the client's CI-V socket with the type 0 header. */
+static void send_civ(radio_t *r, const uint8_t *civ, size_t len)
+{
+    uint8_t packet[0x15 + 64] = {0};
+    put_u32_le(packet, 0, (uint32_t)(0x15 + len));
+    put_u16_le(packet, 4, 0x00);
+    put_u32_le(packet, 8, RADIO_ID);
+    packet[0x10] = 0xC1;
+    put_u16_le(packet, 0x11, (uint16_t)len);
+    put_u16_le(packet, 0x13, r->civ_seq++);
+    memcpy(packet + 0x15, civ, len);
+    reply(r->civ_sock, &r->civ_peer, packet, 0x15 + len);
+}
+
+/* Builds the answer to one CI-V request frame (FE FE A4 src cmd [sub] FD). */
+static size_t answer_frame(radio_t *r, const uint8_t *frame, size_t len, uint8_t *out)
+{
+    uint8_t src = frame[3];
+    uint8_t cmd = frame[4];
+    uint8_t sub = len > 6 ? frame[5] : 0;
+    size_t n = 0;
+    out[n++] = 0xFE;
+    out[n++] = 0xFE;
+    out[n++] = src;
+    out[n++] = RADIO_ADDR;
+    out[n++] = cmd;
+    switch (cmd) {
+    case 0x03:
+        freq_to_bcd(r->freq_hz, &out[n]);
+        n += 5;
+        break;
+    case 0x04:
+        out[n++] = 0x01; /* USB */
+        out[n++] = 0x02; /* FIL2 */
+        break;
+    case 0x0F:
+        out[n++] = 0x00;
+        break;
+    case 0x14:
+    case 0x15:
+        out[n++] = sub;
+        out[n++] = 0x01;
+        out[n++] = 0x20;
+        break;
+    case 0x1A:
+        out[n++] = sub;
+        if (sub == 0x06) {
+            out[n++] = 0x00;
+            out[n++] = 0x00;
+        } else {
+            out[n++] = 0x31;
+        }
+        break;
+    case 0x1C:
+        out[n++] = sub;
+        out[n++] = 0x00;
+        break;
+    default:
+        out[4] = 0xFA;
+        break;
+    }
+    out[n++] = 0xFD;
+    return n;
+}
+
+static void handle_civ_data(radio_t *r, const uint8_t *rx, int len)
+{
+    uint16_t data_len = get_u16_le(rx, 0x11);
+    if (0x15 + (int)data_len > len) {
+        return;
+    }
+    const uint8_t *data = rx + 0x15;
+    uint8_t answer[64];
+    size_t answer_len = 0;
+    atomic_fetch_add(&r->civ_requests, 1);
+    for (size_t i = 0; i + 5 < data_len;) {
+        if (data[i] != 0xFE || data[i + 1] != 0xFE) {
+            i++;
+            continue;
+        }
+        size_t end = i + 2;
+        while (end < data_len && data[end] != 0xFD) {
+            end++;
+        }
+        if (end >= data_len) {
+            break;
+        }
+        atomic_fetch_add(&r->civ_frames, 1);
+        if (data[i + 2] == RADIO_ADDR) {
+            uint8_t one[16];
+            size_t n = answer_frame(r, &data[i], end - i + 1, one);
+            if (answer_len + n > sizeof(answer)) {
+                send_civ(r, answer, answer_len);
+                answer_len = 0;
+            }
+            memcpy(answer + answer_len, one, n);
+            answer_len += n;
+        }
+        i = end + 1;
+    }
+    if (answer_len) {
+        send_civ(r, answer, answer_len);
+    }
+}
+
+static void handle_ctrl(radio_t *r, const uint8_t *rx, int len, const struct sockaddr_in *from)
+{
+    uint16_t type = get_u16_le(rx, 4);
+    uint8_t packet[0xA8] = {0};
+
+    if (len == 0x10 && type == 0x03) {
+        reply_control(r->ctrl_sock, from, rx, 0x04);
+    } else if (len == 0x10 && type == 0x06) {
+        reply_control(r->ctrl_sock, from, rx, 0x06);
+    } else if (len == 0x15 && type == 0x07 && rx[0x10] == 0x00) {
+        memcpy(packet, rx, 0x15);
+        put_u32_le(packet, 8, RADIO_ID);
+        put_u32_le(packet, 12, get_u32_le(rx, 8));
+        packet[0x10] = 0x01;
+        reply(r->ctrl_sock, from, packet, 0x15);
+    } else if (len == 0x80) {
+        /* Login: accept, echo the token request and hand out a token. */
+        put_u32_le(packet, 0, 0x60);
+        put_u32_le(packet, 8, RADIO_ID);
+        put_u32_le(packet, 12, get_u32_le(rx, 8));
+        put_u16_le(packet, 0x1a, get_u16_le(rx, 0x1a));
+        put_u32_le(packet, 0x1c, 0xCAFEF00Du);
+        put_u16_le(packet, 0x20, 0x1234);
+        reply(r->ctrl_sock, from, packet, 0x60);
+    } else if (len == 0x40 && (rx[0x15] == 0x02 || rx[0x15] == 0x05)) {
+        put_u32_le(packet, 0, 0x40);
+        put_u32_le(packet, 8, RADIO_ID);
+        put_u32_le(packet, 12, get_u32_le(rx, 8));
+        packet[0x14] = 0x02;
+        packet[0x15] = rx[0x15];
+        put_u16_le(packet, 0x1a, get_u16_le(rx, 0x1a));
+        put_u16_le(packet, 0x27, 0x8010);
+        memcpy(&packet[0x2a], "\x00\x90\xc7\x12\x34\x56", 6);
+        reply(r->ctrl_sock, from, packet, 0x40);
+    } else if (len == 0x42) {
+        /* Capabilities: one radio record. */
+        put_u32_le(packet, 0, 0xA8);
+        put_u32_le(packet, 8, RADIO_ID);
+        put_u32_le(packet, 12, get_u32_le(rx, 8));
+        uint8_t *rad = &packet[0x42];
+        put_u16_le(rad, 0x07, 0x8010);
+        memcpy(rad + 0x0a, "\x00\x90\xc7\x12\x34\x56", 6);
+        memcpy(rad + 0x10, "IC-705", 6);
+        rad[0x52] = RADIO_ADDR;
+        reply(r->ctrl_sock, from, packet, 0xA8);
+    } else if (len == 0x90) {
+        /* Stream request: status with the CI-V port. */
+        put_u32_le(packet, 0, 0x50);
+        put_u32_le(packet, 8, RADIO_ID);
+        put_u32_le(packet, 12, get_u32_le(rx, 8));
+        put_u16_be(packet, 0x42, (uint16_t)(r->ctrl_port + 1));
+        reply(r->ctrl_sock, from, packet, 0x50);
+    } else if (len >= 0x15 && (type == 0xC1 || (type == 0x00 && rx[0x10] == 0xC1))) {
+        /* The radio does not take CI-V on the control port. */
+        atomic_fetch_add(&r->civ_rejected, 1);
+    }
+}
+
+static void handle_civ_port(radio_t *r, const uint8_t *rx, int len, const struct sockaddr_in *from)
+{
+    uint16_t type = get_u16_le(rx, 4);
+    if (len == 0x10 && type == 0x03) {
+        reply_control(r->civ_sock, from, rx, 0x04);
+    } else if (len == 0x10 && type == 0x06) {
+        reply_control(r->civ_sock, from, rx, 0x06);
+    } else if (len == 0x16) {
+        pthread_mutex_lock(&r->lock);
+        r->civ_peer = *from;
+        r->civ_open = rx[0x15] == 0x04;
+        pthread_mutex_unlock(&r->lock);
+    } else if (len >= 0x15 && type == 0x00 && rx[0x10] == 0xC1) {
+        pthread_mutex_lock(&r->lock);
+        r->civ_peer = *from;
+        if (r->civ_open) {
+            handle_civ_data(r, rx, len);
+        }
+        pthread_mutex_unlock(&r->lock);
+    } else if (len >= 0x15 && type == 0xC1) {
+        atomic_fetch_add(&r->civ_rejected, 1);
+    }
+}
+
+static void *radio_thread(void *arg)
+{
+    radio_t *r = arg;
+    while (!atomic_load(&r->stop)) {
+        fd_set set;
+        FD_ZERO(&set);
+        FD_SET(r->ctrl_sock, &set);
+        FD_SET(r->civ_sock, &set);
+        struct timeval tv = { .tv_sec = 0, .tv_usec = 20000 };
+        int maxfd = r->ctrl_sock > r->civ_sock ? r->ctrl_sock : r->civ_sock;
+        if (select(maxfd + 1, &set, NULL, NULL, &tv) <= 0) {
+            continue;
+        }
+        uint8_t rx[512];
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        if (FD_ISSET(r->ctrl_sock, &set)) {
+            int len = (int)recvfrom(r->ctrl_sock, rx, sizeof(rx), 0, (struct sockaddr *)&from, &from_len);
+            if (len >= 0x10) {
+                atomic_fetch_add(&r->ctrl_datagrams, 1);
+                handle_ctrl(r, rx, len, &from);
+            }
+        }
+        from_len = sizeof(from);
+        if (FD_ISSET(r->civ_sock, &set)) {
+            int len = (int)recvfrom(r->civ_sock, rx, sizeof(rx), 0, (struct sockaddr *)&from, &from_len);
+            if (len >= 0x10) {
+                atomic_fetch_add(&r->civ_datagrams, 1);
+                handle_civ_port(r, rx, len, &from);
+            }
+        }
+    }
+    return NULL;
+}
+
+static int bind_udp(uint16_t port)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port) };
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (sock < 0 || bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        if (sock >= 0) {
+            close(sock);
+        }
+        return -1;
+    }
+    return sock;
+}
+
+static bool radio_start(radio_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    pthread_mutex_init(&r->lock, NULL);
+    r->freq_hz = 14074000;
+    /* Two adjacent free ports, as on the radio (50001/50002 by default). */
+    for (uint16_t port = 40001; port < 41000; port += 2) {
+        r->ctrl_sock = bind_udp(port);
+        if (r->ctrl_sock < 0) {
+            continue;
+        }
+        r->civ_sock = bind_udp((uint16_t)(port + 1));
+        if (r->civ_sock >= 0) {
+            r->ctrl_port = port;
+            break;
+        }
+        close(r->ctrl_sock);
+    }
+    if (r->ctrl_port == 0) {
+        return false;
+    }
+    return pthread_create(&r->thread, NULL, radio_thread, r) == 0;
+}
+
+/* Turns the dial. With transceive on the radio announces the change itself. */
+static void radio_set_freq(radio_t *r, uint64_t hz)
+{
+    pthread_mutex_lock(&r->lock);
+    r->freq_hz = hz;
+    if (r->transceive && r->civ_open) {
+        uint8_t push[11] = { 0xFE, 0xFE, 0x00, RADIO_ADDR, 0x00 };
+        freq_to_bcd(hz, &push[5]);
+        push[10] = 0xFD;
+        send_civ(r, push, sizeof(push));
+    }
+    pthread_mutex_unlock(&r->lock);
+}
+
+/* ---- measurements ---- */
+
+static uint64_t wait_for_freq(uint64_t hz, uint64_t timeout_ms)
+{
+    uint64_t start = now_ms();
+    hamview_icom_state_t st;
+    while (now_ms() - start < timeout_ms) {
+        if (hamview_icom_get_state(&st) && st.freq_hz == hz) {
+            return now_ms() - start;
+        }
+        usleep(500);
+    }
+    return UINT64_MAX;
+}
+
+static int check_rate(const char *label, double rate, double rate_max)
+{
+    if (rate > rate_max) {
+        printf("%s: %.1f CI-V datagrams/s, budget %.1f\n", label, rate, rate_max);
+        return 1;
+    }
+    return 0;
+}
+
+static int measure_idle(const char *label, uint32_t seconds, double rate_max)
+{
+    unsigned ctrl0 = atomic_load(&s_radio.ctrl_datagrams);
+    unsigned requests0 = atomic_load(&s_radio.civ_requests);
+    unsigned frames0 = atomic_load(&s_radio.civ_frames);
+    sleep(seconds);
+    double rate = (double)(atomic_load(&s_radio.civ_requests) - requests0) / seconds;
+    printf("%-26s %5.1f CI-V datagrams/s (%4.1f frames/s), %5.1f control datagrams/s\n", label, rate,
+           (double)(atomic_load(&s_radio.civ_frames) - frames0) / seconds,
+           (double)(atomic_load(&s_radio.ctrl_datagrams) - ctrl0) / seconds);
+    return check_rate(label, rate, rate_max);
+}
+
+static int measure_tuning(const char *label, double rate_max)
+{
+    uint64_t total = 0;
+    uint64_t worst = 0;
+    unsigned requests0 = atomic_load(&s_radio.civ_requests);
+    uint64_t start = now_ms();
+    for (int step = 1; step <= TUNE_STEPS; ++step) {
+        uint64_t hz = 14074000 + (uint64_t)step * 100;
+        uint64_t t0 = now_ms();
+        radio_set_freq(&s_radio, hz);
+        uint64_t latency = wait_for_freq(hz, 2000);
+        if (latency == UINT64_MAX) {
+            printf("%s: frequency %" PRIu64 " never seen\n", label, hz);
+            return 1;
+        }
+        total += latency;
+        if (latency > worst) {
+            worst = latency;
+        }
+        uint64_t spent = now_ms() - t0;
+        if (spent < TUNE_STEP_MS) {
+            usleep((useconds_t)(TUNE_STEP_MS - spent) * 1000);
+        }
+    }
+    double seconds = (double)(now_ms() - start) / 1000.0;
+    double rate = (double)(atomic_load(&s_radio.civ_requests) - requests0) / seconds;
+    printf("%-26s tracking mean %5.1f ms, worst %3" PRIu64 " ms, %5.1f CI-V datagrams/s\n", label,
+           (double)total / TUNE_STEPS, worst, rate);
+    int errors = check_rate(label, rate, rate_max);
+    if (worst >= TRACKING_MAX_MS) {
+        printf("%s: worst tracking latency %" PRIu64 " ms, target under %d ms\n", label, worst, TRACKING_MAX_MS);
+        errors++;
+    }
+    return errors;
+}
+
+int main(void)
+{
+    int errors = 0;
+    if (!radio_start(&s_radio)) {
+        printf("cannot bind the radio stand-in ports\n");
+        return EXIT_FAILURE;
+    }
+
+    hamview_icom_init();
+    uint64_t t0 = now_ms();
+    hamview_icom_set_civ_wifi(true, "127.0.0.1", s_radio.ctrl_port, "user", "pass");
+    uint64_t handshake = wait_for_freq(14074000, 10000);
+    if (handshake == UINT64_MAX) {
+        printf("handshake: no frequency after 10 s\n");
+        return EXIT_FAILURE;
+    }
+    printf("%-26s first frequency after %" PRIu64 " ms, %u CI-V requests rejected while probing\n", "handshake",
+           now_ms() - t0, atomic_load(&s_radio.civ_rejected));
+
+    sleep(3);
+    errors += measure_idle("idle", 5, POLLED_CIV_RATE_MAX);
+    errors += measure_tuning("tuning", POLLED_CIV_RATE_MAX);
+
+    pthread_mutex_lock(&s_radio.lock);
+    s_radio.transceive = true;
+    pthread_mutex_unlock(&s_radio.lock);
+    errors += measure_tuning("tuning, transceive", PUSHED_CIV_RATE_MAX);
+    sleep(3);
+    errors += measure_idle("idle, transceive", 5, PUSHED_CIV_RATE_MAX);
+
+    hamview_icom_set_civ_wifi(false, NULL, 0, NULL, NULL);
+    usleep(500000);
+    atomic_store(&s_radio.stop, true);
+    pthread_join(s_radio.thread, NULL);
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
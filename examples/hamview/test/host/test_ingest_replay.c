@@ -0,0 +1,325 @@
+/* Host test and benchmark of the HamAlert ingest pipeline against a telnet
+ * stand-in.
+ *
+ * The stand-in listens on loopback and replays a HamAlert session, by default
+ * data/hamalert_feed.txt (see make_hamalert_feed.py), in writes of random
+ * size. The reader loop mirrors telnet_loop(): recv() into a 1024-byte buffer
+ * and hamview_ingest_feed(). The module is compiled into this file so that
+ * every run starts from zeroed counters; its parser task runs on
+ * host_freertos.c and hands each line to the real spot parser.
+ *
+ * Three runs: full speed; a parser slowed to 1 ms per line, which the reader
+ * must absorb by waiting, with TCP flow control holding the stand-in back;
+ * and one 500 ms parser stall, which must drop lines and count them. Checks
+ * that every queued line reaches the parser once and in order, and that the
+ * oversized line is discarded. Reports lines/s, MB/s, the deepest queue,
+ * drops and the parse time p50/p99.
+ *
+ * A recorded session can be replayed instead: ./test_ingest_replay session.txt
+ * (the expected counts are then only reported, not checked).
+ */
+#include "esp_log.h"
+
+/* Oversized and dropped lines are counted in the stats the report prints; a
+ * warning per line would bury it. */
+#undef ESP_LOGW
+#define ESP_LOGW ESP_LOG_DISCARD
+
+#include "hamview_ingest.c"
+
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "hamview_spot_parser.h"
+
+#define FEED_PATH "data/hamalert_feed.txt"
+#define FEED_EXP_PATH "data/hamalert_feed.exp"
+#define FULL_SPEED_LOOPS 250
+#define SLOW_PARSE_US 1000
+#define STALL_MS 500
+#define STALL_AT_LINE 1000
+
+/* ---- recorded session ---- */
+
+static char *s_feed;
+static size_t s_feed_len;
+
+static bool load_feed(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    s_feed_len = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    s_feed = malloc(s_feed_len);
+    bool ok = s_feed && fread(s_feed, 1, s_feed_len, f) == s_feed_len;
+    fclose(f);
+    return ok;
+}
+
+static uint32_t fnv1a(uint32_t hash, const char *data, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ (uint8_t)data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/* What the reader must queue from one replay of the session: complete lines
+ * starting with '{' that fit the line buffer, after leading CR/LF. */
+static uint32_t expected_lines(uint32_t *hash, uint32_t *oversized)
+{
+    uint32_t count = 0;
+    const char *p = s_feed;
+    const char *end = s_feed + s_feed_len;
+    while (p < end) {
+        const char *newline = memchr(p, '\n', (size_t)(end - p));
+        if (!newline) {
+            break;
+        }
+        size_t len = (size_t)(newline - p);
+        if (len >= INGEST_LINE_MAX) {
+            (*oversized)++;
+        } else {
+            const char *line = p;
+            while (line < newline && (*line == '\r' || *line == '\n')) {
+                line++;
+            }
+            if (line < newline && *line == '{') {
+                *hash = fnv1a(*hash, line, (size_t)(newline - line));
+                count++;
+            }
+        }
+        p = newline + 1;
+    }
+    return count;
+}
+
+/* ---- telnet stand-in ---- */
+
+typedef struct {
+    int listen_sock;
+    uint16_t port;
+    uint32_t loops;
+    pthread_t thread;
+} server_t;
+
+static void *server_thread(void *arg)
+{
+    server_t *server = arg;
+    int sock = accept(server->listen_sock, NULL, NULL);
+    if (sock < 0) {
+        return NULL;
+    }
+    uint32_t state = 1;
+    for (uint32_t loop = 0; loop < server->loops; ++loop) {
+        size_t pos = 0;
+        while (pos < s_feed_len) {
+            state = state * 1103515245u + 12345u;
+            size_t chunk = 1 + (state >> 8) % 1460;
+            if (chunk > s_feed_len - pos) {
+                chunk = s_feed_len - pos;
+            }
+            ssize_t sent = send(sock, s_feed + pos, chunk, 0);
+            if (sent <= 0) {
+                close(sock);
+                return NULL;
+            }
+            pos += (size_t)sent;
+        }
+    }
+    close(sock);
+    return NULL;
+}
+
+static bool server_start(server_t *server, uint32_t loops)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t addr_len = sizeof(addr);
+    server->loops = loops;
+    server->listen_sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (server->listen_sock < 0 || bind(server->listen_sock, (struct sockaddr *)&addr, addr_len) != 0 ||
+        listen(server->listen_sock, 1) != 0 ||
+        getsockname(server->listen_sock, (struct sockaddr *)&addr, &addr_len) != 0) {
+        return false;
+    }
+    server->port = ntohs(addr.sin_port);
+    return pthread_create(&server->thread, NULL, server_thread, server) == 0;
+}
+
+/* ---- parser side ---- */
+
+typedef struct {
+    uint32_t parse_delay_us;
+    uint32_t stall_at_line;
+    uint32_t delivered;
+    uint32_t spots;
+    uint32_t parse_errors;
+    uint32_t hash;
+} run_t;
+
+static run_t s_run;
+
+static void on_spot(const hamview_spot_t *spot, void *ctx)
+{
+    s_run.spots++;
+}
+
+/* Runs on the hamview_ingest task. */
+static void on_line(const char *line, size_t len)
+{
+    s_run.hash = fnv1a(s_run.hash, line, len);
+    s_run.delivered++;
+    if (hamview_spot_parse_json(line, len, on_spot, NULL) < 0) {
+        s_run.parse_errors++;
+    }
+    if (s_run.parse_delay_us) {
+        usleep(s_run.parse_delay_us);
+    }
+    if (s_run.delivered == s_run.stall_at_line) {
+        usleep(STALL_MS * 1000);
+    }
+}
+
+static void reset_pipeline(void)
+{
+    hamview_ingest_reset_line();
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_lines = 0;
+    s_bytes = 0;
+    s_max_depth = 0;
+    s_dropped = 0;
+    s_oversized = 0;
+    s_parse_max_us = 0;
+    s_parse_count = 0;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+/* ---- runs ---- */
+
+static int replay(const char *name, uint32_t loops, uint32_t parse_delay_us, uint32_t stall_at_line,
+                  uint32_t queued_per_loop, uint32_t oversized_per_loop, bool check)
+{
+    server_t server;
+    if (!server_start(&server, loops)) {
+        printf("%s: cannot start the telnet stand-in\n", name);
+        return 1;
+    }
+    reset_pipeline();
+    memset(&s_run, 0, sizeof(s_run));
+    s_run.hash = 2166136261u;
+    s_run.parse_delay_us = parse_delay_us;
+    s_run.stall_at_line = stall_at_line;
+
+    /* telnet_loop(), minus login and keep-alive. */
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(server.port),
+                                .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    if (sock < 0 || connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        printf("%s: cannot connect to the telnet stand-in\n", name);
+        return 1;
+    }
+    char recv_buf[1024];
+    int64_t start_us = esp_timer_get_time();
+    ssize_t n;
+    while ((n = recv(sock, recv_buf, sizeof(recv_buf), 0)) > 0) {
+        hamview_ingest_feed(recv_buf, (size_t)n);
+    }
+    close(sock);
+    while (atomic_load(&s_tail) != atomic_load(&s_head)) {
+        usleep(100);
+    }
+    double seconds = (double)(esp_timer_get_time() - start_us) / 1e6;
+    pthread_join(server.thread, NULL);
+    close(server.listen_sock);
+
+    hamview_ingest_stats_t stats;
+    hamview_ingest_get_stats(&stats);
+    printf("%-22s %6" PRIu32 " lines %8.0f lines/s %6.1f MB/s  depth max %2" PRIu32 "  dropped %" PRIu32
+           "  oversized %" PRIu32 "  parse p50 %3" PRIu32 " us p99 %3" PRIu32 " us max %6" PRIu32 " us\n",
+           name, s_run.delivered, s_run.delivered / seconds, stats.bytes / seconds / 1e6, stats.max_queue_depth,
+           stats.dropped_lines, stats.oversized_lines, stats.parse_us_p50, stats.parse_us_p99, stats.parse_us_max);
+
+    int errors = 0;
+    if (s_run.parse_errors || s_run.spots != s_run.delivered) {
+        printf("    %" PRIu32 " lines failed to parse, %" PRIu32 " spots from %" PRIu32 " lines\n", s_run.parse_errors,
+               s_run.spots, s_run.delivered);
+        errors++;
+    }
+    if (s_run.delivered != stats.lines || stats.bytes != (uint64_t)loops * s_feed_len) {
+        printf("    %" PRIu32 " lines parsed but %" PRIu32 " queued, %" PRIu64 " bytes fed\n", s_run.delivered,
+               stats.lines, stats.bytes);
+        errors++;
+    }
+    if (!check) {
+        return errors;
+    }
+    uint32_t expected = queued_per_loop * loops;
+    if (stats.oversized_lines != oversized_per_loop * loops ||
+        s_run.delivered + stats.dropped_lines != expected) {
+        printf("    expected %" PRIu32 " lines and %" PRIu32 " oversized\n", expected, oversized_per_loop * loops);
+        errors++;
+    }
+    if (stall_at_line) {
+        if (stats.dropped_lines == 0) {
+            printf("    a %d ms stall dropped nothing\n", STALL_MS);
+            errors++;
+        }
+    } else {
+        uint32_t hash = 2166136261u;
+        for (uint32_t loop = 0; loop < loops; ++loop) {
+            uint32_t oversized = 0;
+            expected_lines(&hash, &oversized);
+        }
+        if (stats.dropped_lines != 0 || s_run.hash != hash) {
+            printf("    lines lost or reordered (hash %08" PRIx32 ", expected %08" PRIx32 ")\n", s_run.hash, hash);
+            errors++;
+        }
+    }
+    return errors;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : FEED_PATH;
+    if (!load_feed(path)) {
+        printf("cannot read %s\n", path);
+        return EXIT_FAILURE;
+    }
+    uint32_t hash = 2166136261u;
+    uint32_t oversized = 0;
+    uint32_t queued = expected_lines(&hash, &oversized);
+    bool check = argc <= 1;
+    if (check) {
+        uint32_t exp_queued = 0;
+        uint32_t exp_oversized = 0;
+        FILE *f = fopen(FEED_EXP_PATH, "r");
+        if (!f || fscanf(f, "%" SCNu32 " %" SCNu32, &exp_queued, &exp_oversized) != 2 || exp_queued != queued ||
+            exp_oversized != oversized) {
+            printf("%s: %" PRIu32 " JSON lines and %" PRIu32 " oversized, %s says otherwise\n", path, queued,
+                   oversized, FEED_EXP_PATH);
+            return EXIT_FAILURE;
+        }
+        fclose(f);
+    }
+    printf("%s: %zu bytes, %" PRIu32 " JSON lines, %" PRIu32 " oversized\n", path, s_feed_len, queued, oversized);
+
+    if (hamview_ingest_init(on_line) != ESP_OK) {
+        printf("ingest init failed\n");
+        return EXIT_FAILURE;
+    }
+    int errors = 0;
+    errors += replay("full speed", FULL_SPEED_LOOPS, 0, 0, queued, oversized, check);
+    errors += replay("parser 1 ms per line", 1, SLOW_PARSE_US, 0, queued, oversized, check);
+    errors += replay("parser stall 500 ms", 10, 0, STALL_AT_LINE, queued, oversized, check);
+    printf("%s\n", errors ? "FAILED" : "ok");
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
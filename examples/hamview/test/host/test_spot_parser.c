@@ -0,0 +1,232 @@
+/* Host test of the streaming HamAlert spot parser.
+ *
+ * A set of fixtures pins the decoded fields (aliases, envelopes, escapes,
+ * truncation, frequency normalisation). The fixtures then seed a mutation
+ * fuzzer; every input is copied into an exact-size heap buffer so that the
+ * sanitizers catch any read past the end, and every delivered spot is checked
+ * for terminated fields and a non-empty callsign.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hamview_spot_parser.h"
+
+#define FUZZ_ITERATIONS 500000
+#define FUZZ_MAX_LEN 1024
+#define MAX_EXPECTED 4
+
+typedef struct {
+    const char *callsign;
+    const char *frequency;
+    const char *spotter;
+    const char *dxcc;
+    const char *country;
+    const char *comment;
+} expected_spot_t;
+
+typedef struct {
+    const char *json;
+    int result;
+    expected_spot_t spots[MAX_EXPECTED];
+} fixture_t;
+
+static const fixture_t FIXTURES[] = {
+    {
+        "{\"fullCallsign\":\"K1ABC/P\",\"callsign\":\"K1ABC\",\"frequency\":\"14074.5\",\"mode\":\"ft8\","
+        "\"spotter\":\"W1AW\",\"time\":\"12:00\",\"dxcc\":\"United States\",\"continent\":\"NA\","
+        "\"comment\":\"cq \\\"dx\\\" \\u00e9 \\ud83d\\ude00\",\"x\":[1,2,{\"a\":null}],\"y\":true}",
+        1,
+        { { "K1ABC", "14074.500", "W1AW", "United States", "United States", "cq \"dx\" \xc3\xa9 \xf0\x9f\x98\x80" } },
+    },
+    {
+        "[{\"dx\":\"JA1X\",\"freq\":\"7.0255\",\"country\":\"Japan\",\"de\":\"X\"},{\"callsign\":\"\"},5,"
+        "{\"dx\":\"A\",\"callsign\":\"B\",\"freq\":\"1e3\"}]",
+        2,
+        { { "JA1X", "7.026", "X", "Japan", "Japan", "" }, { "B", "1000.000", "", "", "", "" } },
+    },
+    {
+        "{\"Spots\":[{\"callsign\":\"Z\",\"frequency\":\"0\"}],\"callsign\":\"ROOT\"}",
+        1,
+        { { "Z", "0", "", "", "", "" } },
+    },
+    {
+        "{\"country\":\"Italy\",\"dxcc\":\"248\",\"callsign\":\"I2XYZ\",\"comments\":\"alias\",\"comment\":\"primary\"}",
+        1,
+        { { "I2XYZ", "", "", "248", "Italy", "primary" } },
+    },
+    {
+        "{\"callsign\":\"BAD\"",
+        -1,
+        { { NULL } },
+    },
+    {
+        "{\"callsign\":\"C\",\"frequency\":\"7.0009999\"}   trailing",
+        1,
+        { { "C", "7.001", "", "", "", "" } },
+    },
+    {
+        "{\"callsign\":\"D\",\"frequency\":\"-5\",\"comment\":\"0123456789012345678901234567890123456789"
+        "012345678901234567890123456789012345678901234567890123456789\"}",
+        1,
+        { { "D", "-5", "", "", "", "01234567890123456789012345678901234567890123456789012345678901234567890123456789"
+                                   "012345678901234" } },
+    },
+    {
+        "  [ ]  ",
+        0,
+        { { NULL } },
+    },
+};
+
+typedef struct {
+    const fixture_t *fixture;
+    int seen;
+    int errors;
+} fixture_ctx_t;
+
+static int check_field(const char *name, const char *got, const char *want)
+{
+    if (strcmp(got, want) != 0) {
+        printf("  %s: got \"%s\", want \"%s\"\n", name, got, want);
+        return 1;
+    }
+    return 0;
+}
+
+static void on_fixture_spot(const hamview_spot_t *spot, void *ctx)
+{
+    fixture_ctx_t *c = ctx;
+    if (c->seen >= MAX_EXPECTED || !c->fixture->spots[c->seen].callsign) {
+        printf("  unexpected spot %s\n", spot->callsign);
+        c->errors++;
+        c->seen++;
+        return;
+    }
+    const expected_spot_t *want = &c->fixture->spots[c->seen++];
+    c->errors += check_field("callsign", spot->callsign, want->callsign);
+    c->errors += check_field("frequency", spot->frequency, want->frequency);
+    c->errors += check_field("spotter", spot->spotter, want->spotter);
+    c->errors += check_field("dxcc", spot->dxcc, want->dxcc);
+    c->errors += check_field("country", spot->country, want->country);
+    c->errors += check_field("comment", spot->comment, want->comment);
+}
+
+static int run_fixtures(void)
+{
+    int errors = 0;
+    for (size_t i = 0; i < sizeof(FIXTURES) / sizeof(FIXTURES[0]); ++i) {
+        const fixture_t *f = &FIXTURES[i];
+        fixture_ctx_t ctx = { .fixture = f };
+        size_t len = strlen(f->json);
+        char *copy = malloc(len);
+        memcpy(copy, f->json, len);
+        int result = hamview_spot_parse_json(copy, len, on_fixture_spot, &ctx);
+        free(copy);
+        if (result != f->result) {
+            printf("  returned %d, want %d\n", result, f->result);
+            ctx.errors++;
+        }
+        if (ctx.errors) {
+            printf("fixture %zu failed\n", i);
+            errors++;
+        }
+    }
+    return errors;
+}
+
+/* ---- fuzzing ---- */
+
+static uint32_t s_rand_state = 1;
+
+static uint32_t rand_next(void)
+{
+    s_rand_state ^= s_rand_state << 13;
+    s_rand_state ^= s_rand_state >> 17;
+    s_rand_state ^= s_rand_state << 5;
+    return s_rand_state;
+}
+
+#define CHECK_TERMINATED(spot, field) (memchr((spot)->field, '\0', sizeof((spot)->field)) != NULL)
+
+static void on_fuzz_spot(const hamview_spot_t *spot, void *ctx)
+{
+    int *errors = ctx;
+    if (!CHECK_TERMINATED(spot, callsign) || !CHECK_TERMINATED(spot, frequency) ||
+        !CHECK_TERMINATED(spot, mode) || !CHECK_TERMINATED(spot, spotter) ||
+        !CHECK_TERMINATED(spot, time_utc) || !CHECK_TERMINATED(spot, dxcc) ||
+        !CHECK_TERMINATED(spot, state) || !CHECK_TERMINATED(spot, country) ||
+        !CHECK_TERMINATED(spot, continent) || !CHECK_TERMINATED(spot, comment) ||
+        spot->callsign[0] == '\0') {
+        (*errors)++;
+    }
+}
+
+static size_t mutate(char *buf, size_t len)
+{
+    static const char tokens[] = "{}[]\",:\\u0123ae-. x";
+    int edits = 1 + (int)(rand_next() % 6);
+    for (int k = 0; k < edits && len > 0; ++k) {
+        size_t pos = rand_next() % len;
+        switch (rand_next() % 3) {
+        case 0:
+            buf[pos] = tokens[rand_next() % (sizeof(tokens) - 1)];
+            break;
+        case 1:
+            memmove(buf + pos, buf + pos + 1, len - pos - 1);
+            len--;
+            break;
+        default:
+            if (len < FUZZ_MAX_LEN) {
+                memmove(buf + pos + 1, buf + pos, len - pos);
+                buf[pos] = (char)(rand_next() & 0xFF);
+                len++;
+            }
+            break;
+        }
+    }
+    return len;
+}
+
+static int run_fuzz(long iterations, long *spots)
+{
+    static char buf[FUZZ_MAX_LEN];
+    size_t fixture_count = sizeof(FIXTURES) / sizeof(FIXTURES[0]);
+    int errors = 0;
+
+    for (long it = 0; it < iterations; ++it) {
+        const char *seed = FIXTURES[rand_next() % fixture_count].json;
+        size_t len = strlen(seed);
+        memcpy(buf, seed, len);
+        len = mutate(buf, len);
+
+        char *copy = malloc(len ? len : 1);
+        memcpy(copy, buf, len);
+        int before = errors;
+        int result = hamview_spot_parse_json(copy, len, on_fuzz_spot, &errors);
+        free(copy);
+        if (result < -1) {
+            errors++;
+        }
+        if (result > 0) {
+            *spots += result;
+        }
+        if (errors != before) {
+            printf("fuzz input %ld failed: %.*s\n", it, (int)len, buf);
+            break;
+        }
+    }
+    return errors;
+}
+
+int main(int argc, char **argv)
+{
+    long iterations = (argc > 1) ? strtol(argv[1], NULL, 10) : FUZZ_ITERATIONS;
+    long spots = 0;
+
+    int errors = run_fixtures();
+    printf("fixtures: %s\n", errors ? "FAILED" : "ok");
+    errors += run_fuzz(iterations, &spots);
+    printf("fuzz: %ld inputs, %ld spots delivered, %s\n", iterations, spots, errors ? "FAILED" : "ok");
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,322 @@
+/* Host test and microbenchmark of the live spot ring and the history store.
+ *
+ * The ring is checked against a plain newest-first array for random
+ * insert/expire/clear sequences. The benchmark then replays one hour of feed
+ * at 10, 100 and 1000 spots/s and times what update_spot() does per spot
+ * (ring insert plus history push) and what a UI refresh does once a second:
+ * expire and snapshot the live list, then expire the history and read one
+ * page of it. The same feed is
+ * replayed through a model of the previous code, which shifted the live list
+ * and a 512-entry history array on every insert and compacted them on read.
+ * The history pushes, string table compactions included, must not allocate:
+ * the backend makes them with the spot mutex held.
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hamview_history.h"
+#include "hamview_spot_ring.h"
+
+extern void *__libc_malloc(size_t size);
+
+/* Counts allocations while set, to catch any under the spot mutex. */
+static bool s_count_allocs;
+static uint32_t s_allocs;
+
+void *malloc(size_t size)
+{
+    s_allocs += s_count_allocs;
+    return __libc_malloc(size);
+}
+
+#define LIVE_TTL_US (30ULL * 60ULL * 1000000ULL)
+#define HISTORY_WINDOW_US (24ULL * 60ULL * 60ULL * 1000000ULL)
+#define HISTORY_CAPACITY 16384
+#define HISTORY_PAGE 20
+#define FEED_SECONDS 3600
+#define SHIFT_HISTORY_MAX 512
+
+static uint32_t s_rand_state = 1;
+
+static uint32_t rand_next(void)
+{
+    s_rand_state ^= s_rand_state << 13;
+    s_rand_state ^= s_rand_state >> 17;
+    s_rand_state ^= s_rand_state << 5;
+    return s_rand_state;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void make_spot(hamview_spot_t *spot, uint32_t n)
+{
+    memset(spot, 0, sizeof(*spot));
+    snprintf(spot->callsign, sizeof(spot->callsign), "DX%" PRIu32, n % 7000);
+    snprintf(spot->spotter, sizeof(spot->spotter), "SP%" PRIu32, (n * 7) % 2500);
+    snprintf(spot->frequency, sizeof(spot->frequency), "%" PRIu32 ".%03" PRIu32, 1800 + n % 50000, n % 1000);
+    strlcpy(spot->mode, (n % 3) ? "FT8" : "CW", sizeof(spot->mode));
+    snprintf(spot->time_utc, sizeof(spot->time_utc), "%02" PRIu32 ":%02" PRIu32, (n / 60) % 24, n % 60);
+    snprintf(spot->dxcc, sizeof(spot->dxcc), "%" PRIu32, n % 340);
+    snprintf(spot->country, sizeof(spot->country), "Country %" PRIu32, n % 340);
+    strlcpy(spot->continent, "EU", sizeof(spot->continent));
+    snprintf(spot->comment, sizeof(spot->comment), "cq test %" PRIu32, n);
+}
+
+/* ---- correctness ---- */
+
+static int check_ring(size_t capacity, int steps)
+{
+    stored_spot_t *slots = calloc(capacity, sizeof(stored_spot_t));
+    stored_spot_t *model = calloc(capacity, sizeof(stored_spot_t));
+    spot_ring_t ring = { .entries = slots, .capacity = capacity };
+    size_t model_count = 0;
+    uint64_t now = 1000000;
+    int errors = 0;
+
+    for (int step = 0; step < steps; ++step) {
+        uint32_t op = rand_next() % 16;
+        now += rand_next() % 5000000;
+        if (op < 11) {
+            stored_spot_t entry = { .received_us = now, .mode_class = (uint8_t)(step & 3) };
+            make_spot(&entry.spot, (uint32_t)step);
+            *spot_ring_push(&ring) = entry;
+            size_t keep = model_count < capacity ? model_count : capacity - 1;
+            memmove(&model[1], &model[0], keep * sizeof(stored_spot_t));
+            model[0] = entry;
+            model_count = keep + 1;
+        } else if (op < 15) {
+            uint64_t max_age = rand_next() % 20000000;
+            spot_ring_expire(&ring, now, max_age);
+            while (model_count > 0 && now - model[model_count - 1].received_us > max_age) {
+                model_count--;
+            }
+        } else {
+            spot_ring_clear(&ring);
+            model_count = 0;
+        }
+
+        if (ring.count != model_count) {
+            printf("capacity %zu step %d: count %zu, expected %zu\n", capacity, step, ring.count, model_count);
+            errors++;
+            break;
+        }
+        for (size_t i = 0; i < model_count; ++i) {
+            const stored_spot_t *got = spot_ring_at(&ring, i);
+            if (got->received_us != model[i].received_us || strcmp(got->spot.callsign, model[i].spot.callsign) != 0) {
+                printf("capacity %zu step %d: index %zu differs\n", capacity, step, i);
+                errors++;
+                break;
+            }
+        }
+        if (errors) {
+            break;
+        }
+    }
+
+    free(slots);
+    free(model);
+    return errors;
+}
+
+/* ---- previous code, shift on insert and compact on read ---- */
+
+typedef struct {
+    stored_spot_t live[HAMVIEW_MAX_SPOTS];
+    size_t live_count;
+    stored_spot_t *history;
+    size_t history_count;
+} shift_store_t;
+
+static void shift_insert(shift_store_t *store, const stored_spot_t *entry)
+{
+    size_t keep = store->live_count < HAMVIEW_MAX_SPOTS ? store->live_count : HAMVIEW_MAX_SPOTS - 1;
+    memmove(&store->live[1], &store->live[0], keep * sizeof(stored_spot_t));
+    store->live[0] = *entry;
+    store->live_count = keep + 1;
+
+    keep = store->history_count < SHIFT_HISTORY_MAX ? store->history_count : SHIFT_HISTORY_MAX - 1;
+    memmove(&store->history[1], &store->history[0], keep * sizeof(stored_spot_t));
+    store->history[0] = *entry;
+    store->history_count = keep + 1;
+}
+
+static size_t shift_compact(stored_spot_t *entries, size_t count, uint64_t now, uint64_t max_age_us)
+{
+    size_t out = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (now - entries[i].received_us <= max_age_us) {
+            if (out != i) {
+                entries[out] = entries[i];
+            }
+            out++;
+        }
+    }
+    return out;
+}
+
+/* ---- benchmark ---- */
+
+/* File scope so the copies cannot be optimized away. */
+static hamview_backend_snapshot_t snap;
+static hamview_spot_t page[HISTORY_PAGE];
+
+typedef struct {
+    uint64_t insert_ns;
+    uint64_t snapshot_ns;
+    uint64_t page_ns;
+    uint64_t inserts;
+    uint64_t refreshes;
+} bench_result_t;
+
+static void bench_rate(uint32_t rate, bench_result_t *ring_result, bench_result_t *shift_result)
+{
+    static stored_spot_t slots[HAMVIEW_MAX_SPOTS];
+    spot_ring_t ring = { .entries = slots, .capacity = HAMVIEW_MAX_SPOTS };
+    shift_store_t shift = { .history = calloc(SHIFT_HISTORY_MAX, sizeof(stored_spot_t)) };
+    stored_spot_t entry;
+    uint32_t n = 0;
+
+    memset(ring_result, 0, sizeof(*ring_result));
+    memset(shift_result, 0, sizeof(*shift_result));
+    spot_ring_clear(&ring);
+    hamview_history_init(HISTORY_CAPACITY, NULL);
+
+    for (uint32_t second = 0; second < FEED_SECONDS; ++second) {
+        uint64_t now = (uint64_t)(second + 1) * 1000000ULL;
+
+        for (uint32_t i = 0; i < rate; ++i) {
+            entry.received_us = now - 1000000ULL + (uint64_t)i * 1000000ULL / rate;
+            entry.mode_class = (uint8_t)(n & 3);
+            make_spot(&entry.spot, n++);
+
+            uint64_t t0 = now_ns();
+            stored_spot_t *latest = spot_ring_push(&ring);
+            *latest = entry;
+            s_count_allocs = true;
+            hamview_history_push(&entry.spot, entry.received_us, entry.mode_class);
+            s_count_allocs = false;
+            uint64_t t1 = now_ns();
+            shift_insert(&shift, &entry);
+            uint64_t t2 = now_ns();
+
+            ring_result->insert_ns += t1 - t0;
+            shift_result->insert_ns += t2 - t1;
+        }
+        ring_result->inserts += rate;
+        shift_result->inserts += rate;
+
+        uint64_t t0 = now_ns();
+        spot_ring_expire(&ring, now, LIVE_TTL_US);
+        snap.spot_count = ring.count;
+        for (size_t i = 0; i < ring.count; ++i) {
+            const stored_spot_t *e = spot_ring_at(&ring, i);
+            snap.spots[i] = e->spot;
+            snap.received_us[i] = e->received_us;
+        }
+        uint64_t t1 = now_ns();
+        hamview_history_expire(now, HISTORY_WINDOW_US);
+        for (size_t i = 0; i < HISTORY_PAGE; ++i) {
+            uint64_t received_us;
+            if (!hamview_history_get(i, &page[i], &received_us)) {
+                break;
+            }
+        }
+        uint64_t t2 = now_ns();
+        shift.live_count = shift_compact(shift.live, shift.live_count, now, LIVE_TTL_US);
+        snap.spot_count = shift.live_count;
+        for (size_t i = 0; i < shift.live_count; ++i) {
+            snap.spots[i] = shift.live[i].spot;
+            snap.received_us[i] = shift.live[i].received_us;
+        }
+        uint64_t t3 = now_ns();
+        shift.history_count = shift_compact(shift.history, shift.history_count, now, HISTORY_WINDOW_US);
+        for (size_t i = 0; i < HISTORY_PAGE && i < shift.history_count; ++i) {
+            page[i] = shift.history[i].spot;
+        }
+        uint64_t t4 = now_ns();
+
+        ring_result->snapshot_ns += t1 - t0;
+        ring_result->page_ns += t2 - t1;
+        shift_result->snapshot_ns += t3 - t2;
+        shift_result->page_ns += t4 - t3;
+        ring_result->refreshes++;
+        shift_result->refreshes++;
+    }
+
+    free(shift.history);
+}
+
+/* A feed of never-repeating callsigns and spotters fills the string arena
+ * over and over, so the table compacts; the newest entries must read back
+ * intact. Runs on the history the benchmark left behind. */
+static int check_compaction(void)
+{
+    hamview_spot_t spot;
+    hamview_spot_t got;
+    const uint32_t pushes = 200000;
+    int errors = 0;
+    for (uint32_t n = 0; n < pushes; ++n) {
+        make_spot(&spot, n);
+        snprintf(spot.callsign, sizeof(spot.callsign), "U%06" PRIu32, n);
+        snprintf(spot.spotter, sizeof(spot.spotter), "S%06" PRIu32, n);
+        s_count_allocs = true;
+        hamview_history_push(&spot, (uint64_t)(FEED_SECONDS + 1) * 1000000ULL + n, 0);
+        s_count_allocs = false;
+    }
+    for (size_t i = 0; i < HISTORY_PAGE; ++i) {
+        char callsign[sizeof(got.callsign)];
+        snprintf(callsign, sizeof(callsign), "U%06" PRIu32, pushes - 1 - (uint32_t)i);
+        if (!hamview_history_get(i, &got, NULL) || strcmp(got.callsign, callsign) != 0) {
+            printf("compaction: entry %zu is %s, expected %s\n", i, got.callsign, callsign);
+            errors++;
+            break;
+        }
+    }
+    hamview_history_stats_t stats;
+    hamview_history_get_stats(&stats);
+    if (stats.compactions == 0) {
+        printf("compaction: the unique feed never compacted the string table\n");
+        errors++;
+    }
+    return errors;
+}
+
+int main(void)
+{
+    int errors = 0;
+    errors += check_ring(1, 2000);
+    errors += check_ring(HAMVIEW_MAX_SPOTS, 20000);
+    errors += check_ring(64, 20000);
+    printf("ring model check: %s\n", errors ? "FAILED" : "ok");
+
+    static const uint32_t rates[] = { 10, 100, 1000 };
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); ++i) {
+        bench_result_t ring_result;
+        bench_result_t shift_result;
+        bench_rate(rates[i], &ring_result, &shift_result);
+        printf("%4" PRIu32 " spots/s  insert %5.0f ns (shift %5.0f)  live snapshot %4.0f ns (shift %4.0f)  "
+               "history page %5.0f ns (shift %5.0f)\n",
+               rates[i],
+               (double)ring_result.insert_ns / ring_result.inserts,
+               (double)shift_result.insert_ns / shift_result.inserts,
+               (double)ring_result.snapshot_ns / ring_result.refreshes,
+               (double)shift_result.snapshot_ns / shift_result.refreshes,
+               (double)ring_result.page_ns / ring_result.refreshes,
+               (double)shift_result.page_ns / shift_result.refreshes);
+    }
+    errors += check_compaction();
+    hamview_history_stats_t stats;
+    hamview_history_get_stats(&stats);
+    printf("history: %" PRIu32 " string table compactions, %" PRIu32 " allocations during pushes\n",
+           stats.compactions, s_allocs);
+    errors += s_allocs != 0;
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
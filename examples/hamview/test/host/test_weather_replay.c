@@ -0,0 +1,470 @@
+/* Host test and benchmark of the weather fetch path.
+ *
+ * The module is compiled into this file so that the test can call
+ * fetch_weather_now() and the session reaper directly, on a clock it moves
+ * by hand. HTTPS and NVS are in-memory fakes: the fake client serves saved
+ * Open-Meteo responses in reads of random size and counts connections, which
+ * stand for TLS handshakes.
+ *
+ * Checks the JSON reader on edge cases at every small chunk size, then
+ * replays the fixtures in data/ (see make_open_meteo.py) and compares the
+ * hourly window against the expected one. Reports the peak heap during a
+ * refresh, handshakes and geocode lookups over an hour of refreshes, and the
+ * forecast parse rate.
+ *
+ * Needs the real cJSON for the geocode and warning responses; the Makefile
+ * skips the test when CJSON_DIR has no cJSON source.
+ */
+#ifndef HAVE_CJSON
+#error "test_weather_replay needs cJSON: build it through the Makefile with CJSON_DIR set"
+#endif
+
+#include <malloc.h>
+#include <stdio.h>
+
+#include "esp_timer.h"
+
+static int64_t s_now_us;
+
+static int64_t test_now_us(void)
+{
+    return s_now_us;
+}
+
+#define esp_timer_get_time test_now_us
+#include "hamview_weather.c"
+#undef esp_timer_get_time
+
+#define FIXTURE_MAX (64 * 1024)
+#define PARSE_ROUNDS 20000
+
+/* ---- heap accounting ---- */
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static size_t s_heap_in_use;
+static size_t s_heap_peak;
+
+static void heap_add(void *ptr)
+{
+    if (ptr) {
+        s_heap_in_use += malloc_usable_size(ptr);
+        if (s_heap_in_use > s_heap_peak) {
+            s_heap_peak = s_heap_in_use;
+        }
+    }
+}
+
+static void heap_sub(void *ptr)
+{
+    if (ptr) {
+        s_heap_in_use -= malloc_usable_size(ptr);
+    }
+}
+
+void *malloc(size_t size)
+{
+    void *ptr = __libc_malloc(size);
+    heap_add(ptr);
+    return ptr;
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    void *ptr = __libc_calloc(nmemb, size);
+    heap_add(ptr);
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    heap_sub(ptr);
+    void *out = __libc_realloc(ptr, size);
+    heap_add(out ? out : ptr);
+    return out;
+}
+
+void free(void *ptr)
+{
+    heap_sub(ptr);
+    __libc_free(ptr);
+}
+
+/* ---- HTTPS fake ---- */
+
+struct esp_http_client {
+    char host[64];
+    bool connected;
+    const char *body;
+    size_t len;
+    size_t pos;
+};
+
+static const char *s_forecast_body;
+static const char *GEOCODE_BODY = "{\"results\":[{\"latitude\":30.27,\"longitude\":-97.74,\"name\":\"Austin\","
+                                  "\"admin1\":\"Texas\",\"country\":\"United States\"}]}";
+static const char *WARNINGS_BODY = "{\"warnings\":[]}";
+static uint32_t s_connects;
+static uint32_t s_requests;
+static uint32_t s_geocodes;
+static bool s_drop_idle_connection;
+static uint32_t s_rand_state = 1;
+
+static uint32_t rand_next(void)
+{
+    s_rand_state ^= s_rand_state << 13;
+    s_rand_state ^= s_rand_state >> 17;
+    s_rand_state ^= s_rand_state << 5;
+    return s_rand_state;
+}
+
+static void url_host(const char *url, char *host, size_t host_len)
+{
+    const char *p = strstr(url, "://");
+    p = p ? p + 3 : url;
+    size_t n = strcspn(p, ":/?");
+    snprintf(host, host_len, "%.*s", (int)n, p);
+}
+
+static void route(esp_http_client_handle_t client, const char *url)
+{
+    char host[64];
+    url_host(url, host, sizeof(host));
+    if (strcmp(host, client->host) != 0) {
+        client->connected = false;
+        strlcpy(client->host, host, sizeof(client->host));
+    }
+    if (strstr(url, "/v1/search")) {
+        client->body = GEOCODE_BODY;
+    } else if (strstr(url, "/v1/warnings")) {
+        client->body = WARNINGS_BODY;
+    } else {
+        client->body = s_forecast_body;
+    }
+}
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config)
+{
+    esp_http_client_handle_t client = calloc(1, sizeof(*client));
+    route(client, config->url);
+    return client;
+}
+
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char *url)
+{
+    route(client, url);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_open(esp_http_client_handle_t client, int write_len)
+{
+    if (client->connected && s_drop_idle_connection) {
+        s_drop_idle_connection = false;
+        client->connected = false;
+        return ESP_FAIL;
+    }
+    if (!client->connected) {
+        s_connects++;
+        client->connected = true;
+    }
+    s_requests++;
+    s_geocodes += client->body == GEOCODE_BODY;
+    client->len = strlen(client->body);
+    client->pos = 0;
+    return ESP_OK;
+}
+
+int64_t esp_http_client_fetch_headers(esp_http_client_handle_t client)
+{
+    return (int64_t)client->len;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client)
+{
+    return 200;
+}
+
+/* Like TLS records, reads return anything from one byte to a full buffer. */
+int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len)
+{
+    size_t n = 1 + rand_next() % (uint32_t)len;
+    if (n > client->len - client->pos) {
+        n = client->len - client->pos;
+    }
+    memcpy(buffer, client->body + client->pos, n);
+    client->pos += n;
+    return (int)n;
+}
+
+bool esp_http_client_is_complete_data_received(esp_http_client_handle_t client)
+{
+    return client->pos == client->len;
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t client)
+{
+    client->connected = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client)
+{
+    free(client);
+    return ESP_OK;
+}
+
+esp_err_t esp_crt_bundle_attach(void *conf)
+{
+    return ESP_OK;
+}
+
+/* ---- NVS fake ---- */
+
+#define NVS_SLOTS 4
+
+static char s_nvs_key[NVS_SLOTS][16];
+static uint8_t s_nvs_value[NVS_SLOTS][sizeof(geo_cache_entry_t)];
+static size_t s_nvs_len[NVS_SLOTS];
+static size_t s_nvs_count;
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    for (size_t i = 0; i < s_nvs_count; ++i) {
+        if (strcmp(s_nvs_key[i], key) == 0) {
+            if (*length < s_nvs_len[i]) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            memcpy(out_value, s_nvs_value[i], s_nvs_len[i]);
+            *length = s_nvs_len[i];
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    size_t i = 0;
+    while (i < s_nvs_count && strcmp(s_nvs_key[i], key) != 0) {
+        ++i;
+    }
+    if (i == NVS_SLOTS || length > sizeof(s_nvs_value[i])) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (i == s_nvs_count) {
+        s_nvs_count++;
+    }
+    strlcpy(s_nvs_key[i], key, sizeof(s_nvs_key[i]));
+    memcpy(s_nvs_value[i], value, length);
+    s_nvs_len[i] = length;
+    return ESP_OK;
+}
+
+/* ---- the rest of the firmware ---- */
+
+ESP_EVENT_DEFINE_BASE(VIEW_EVENT_BASE);
+esp_event_loop_handle_t view_event_handle;
+
+void hamview_settings_get(hamview_settings_t *settings)
+{
+    memset(settings, 0, sizeof(*settings));
+    strlcpy(settings->weather_zip, "78701", sizeof(settings->weather_zip));
+}
+
+void hamview_event_log_append(const char *source, const char *fmt, ...)
+{
+}
+
+/* ---- JSON reader ---- */
+
+static void count_values(const hamview_json_reader_t *r, const hamview_json_value_t *value, void *ctx)
+{
+    (*(int *)ctx)++;
+}
+
+static int check_reader(const char *doc, bool valid, int values, size_t chunk)
+{
+    hamview_json_reader_t reader;
+    int seen = 0;
+    hamview_json_reader_init(&reader, count_values, &seen);
+    size_t len = strlen(doc);
+    for (size_t off = 0; off < len; off += chunk) {
+        hamview_json_reader_feed(&reader, doc + off, len - off < chunk ? len - off : chunk);
+    }
+    bool ok = hamview_json_reader_finish(&reader);
+    if (ok != valid || (valid && seen != values)) {
+        printf("  %s: %s with %d values in chunks of %zu\n", doc, ok ? "accepted" : "rejected", seen, chunk);
+        return 1;
+    }
+    return 0;
+}
+
+static int run_reader_cases(void)
+{
+    static const struct {
+        const char *doc;
+        int values;
+    } GOOD[] = {
+        { "{\"a\":[1,2,{\"b\":\"x\\\"y\\u00e9\"}],\"c\":{},\"d\":[],\"e\":[[true],[false,null]],\"f\":-1.5e3}", 7 },
+        { "42", 1 },
+        { " \"s\" ", 1 },
+        { "[]", 0 },
+        { "{\"k\":[ 1 , 2 ]}", 2 },
+    };
+    static const char *const BAD[] = {
+        "{\"a\":1,}", "[1 2]", "{\"a\" 1}", "[1]]", "{\"a\":tru}", "[\"\\x\"]",
+        "[1.2.3]", "[01a]", "{\"a\":1", "[1] x", "[[[[[[[[[1]]]]]]]]]",
+    };
+    int errors = 0;
+    for (size_t chunk = 1; chunk < 8; ++chunk) {
+        for (size_t i = 0; i < sizeof(GOOD) / sizeof(GOOD[0]); ++i) {
+            errors += check_reader(GOOD[i].doc, true, GOOD[i].values, chunk);
+        }
+        for (size_t i = 0; i < sizeof(BAD) / sizeof(BAD[0]); ++i) {
+            errors += check_reader(BAD[i], false, 0, chunk);
+        }
+    }
+    return errors;
+}
+
+/* ---- replay ---- */
+
+static size_t read_file(const char *path, char *buf, size_t cap)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        printf("%s: cannot open\n", path);
+        exit(EXIT_FAILURE);
+    }
+    size_t len = fread(buf, 1, cap - 1, f);
+    fclose(f);
+    buf[len] = '\0';
+    return len;
+}
+
+static int replay_fixture(const char *name, char *body)
+{
+    char path[64];
+    char expected[2048];
+    snprintf(path, sizeof(path), "data/open_meteo_%s.json", name);
+    read_file(path, body, FIXTURE_MAX);
+    snprintf(path, sizeof(path), "data/open_meteo_%s.exp", name);
+    read_file(path, expected, sizeof(expected));
+
+    s_forecast_body = body;
+    size_t base = s_heap_in_use;
+    s_heap_peak = base;
+    esp_err_t err = fetch_weather_now();
+    size_t peak = s_heap_peak - base;
+    if (err != ESP_OK) {
+        printf("%-8s fetch failed: %s\n", name, s_info.last_error);
+        return 1;
+    }
+
+    char got[2048] = "";
+    for (size_t i = 0; i < s_info.forecast_count; ++i) {
+        const hamview_weather_hourly_entry_t *e = &s_info.forecast[i];
+        char line[64];
+        snprintf(line, sizeof(line), "%s %s %u %u %d\n", e->time_local, e->temp_f, e->precip_percent,
+                 e->sustained_wind_mph, e->lightning_risk);
+        strlcat(got, line, sizeof(got));
+    }
+    char line[64];
+    snprintf(line, sizeof(line), "%s|%s\n", s_info.humidity, s_info.feels_like_f);
+    strlcat(got, line, sizeof(got));
+
+    bool ok = strcmp(got, expected) == 0;
+    printf("%-8s %s: %zu hours from %s, %zu sun times, %s, peak heap %zu B\n", name, ok ? "ok" : "FAILED",
+           s_info.forecast_count, s_info.forecast_count ? s_info.forecast[0].time_local : "-",
+           s_info.sun_times_count, s_info.timezone_name, peak);
+    if (!ok) {
+        printf("got:\n%sexpected:\n%s", got, expected);
+    }
+    return ok ? 0 : 1;
+}
+
+int main(void)
+{
+    static char body[FIXTURE_MAX];
+    int errors = 0;
+
+    int reader_errors = run_reader_cases();
+    printf("reader edge cases: %s\n", reader_errors ? "FAILED" : "ok");
+    errors += reader_errors;
+
+    s_info_mutex = xSemaphoreCreateMutex();
+    errors += replay_fixture("exact", body);
+    errors += replay_fixture("quarter", body);
+    const uint32_t expected_geocodes = 1;
+    printf("geocode lookups: %" PRIu32 " (expected %" PRIu32 ")\n", s_geocodes, expected_geocodes);
+    errors += s_geocodes != expected_geocodes;
+
+    /* An hour of scheduled refreshes, reaping idle sessions the way the task
+     * does between them. Before, each refresh made three fresh connections:
+     * geocode, forecast and warnings. */
+    uint32_t connects = s_connects;
+    uint32_t requests = s_requests;
+    uint32_t geocodes = s_geocodes;
+    for (int i = 0; i < 6; ++i) {
+        s_now_us += (int64_t)WEATHER_FETCH_INTERVAL_MS * 1000;
+        weather_sessions_reap(false);
+        errors += fetch_weather_now() != ESP_OK;
+    }
+    printf("1 h of refreshes: %" PRIu32 " requests, %" PRIu32 " connections (%d before), %" PRIu32
+           " geocode lookups\n",
+           s_requests - requests, s_connects - connects, 6 * 3, s_geocodes - geocodes);
+    errors += s_geocodes != geocodes;
+
+    /* A manual refresh inside the idle window rides the open connection. */
+    connects = s_connects;
+    s_now_us += 5 * 1000000LL;
+    errors += fetch_weather_now() != ESP_OK;
+    printf("refresh within the idle window: %" PRIu32 " new connections\n", s_connects - connects);
+    errors += s_connects != connects;
+
+    /* The server closed the kept-alive connection: retried once, fresh. */
+    connects = s_connects;
+    s_drop_idle_connection = true;
+    esp_err_t err = fetch_weather_now();
+    printf("dropped keep-alive: %s, %" PRIu32 " new connections\n", err == ESP_OK ? "ok" : "FAILED",
+           s_connects - connects);
+    errors += err != ESP_OK;
+
+    size_t len = strlen(s_forecast_body);
+    hamview_weather_info_t info;
+    weather_forecast_t *fc = malloc(sizeof(*fc));
+    int64_t t0 = esp_timer_get_time();
+    for (int i = 0; i < PARSE_ROUNDS; ++i) {
+        memset(&info, 0, sizeof(info));
+        forecast_init(fc, &info);
+        hamview_json_reader_feed(&fc->reader, s_forecast_body, len);
+        if (!hamview_json_reader_finish(&fc->reader)) {
+            printf("forecast parse failed\n");
+            return EXIT_FAILURE;
+        }
+    }
+    int64_t elapsed_us = esp_timer_get_time() - t0;
+    printf("forecast parse: %.1f MB/s, %zu B of parser state\n", (double)len * PARSE_ROUNDS / (double)elapsed_us,
+           sizeof(weather_forecast_t));
+    free(fc);
+
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
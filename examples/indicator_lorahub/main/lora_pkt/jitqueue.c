@@ -15,9 +15,8 @@ License: Revised BSD License, see LICENSE.TXT file include in the project
 /* -------------------------------------------------------------------------- */
 /* --- DEPENDENCIES --------------------------------------------------------- */
 
-#include <stdlib.h> /* qsort_r */
 #include <stdio.h>  /* printf, fprintf, snprintf, fopen, fputs */
-#include <string.h> /* memset, memcpy */
+#include <string.h> /* memset, memcpy, memmove */
 #include <pthread.h>
 #include <assert.h>
 #include <math.h>
@@ -30,6 +29,8 @@ License: Revised BSD License, see LICENSE.TXT file include in the project
 /* -------------------------------------------------------------------------- */
 /* --- PRIVATE MACROS ------------------------------------------------------- */
 
+#define JIT_NODE( queue, rank ) ( &( queue )->nodes[( queue )->order[( rank )]] )
+
 /* -------------------------------------------------------------------------- */
 /* --- PRIVATE CONSTANTS & TYPES -------------------------------------------- */
 #define TX_START_DELAY 1500  /* microseconds */
@@ -50,9 +51,129 @@ static const char* TAG_JITQ = "jit_queue";
 /* --- PRIVATE VARIABLES (GLOBAL) ------------------------------------------- */
 static pthread_mutex_t mx_jit_queue = PTHREAD_MUTEX_INITIALIZER; /* control access to JIT queue */
 
+_Static_assert( JIT_QUEUE_MAX <= 32, "free_nodes bitmap holds 32 nodes" );
+
 /* -------------------------------------------------------------------------- */
 /* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
 
+static bool jit_collision_test( uint32_t p1_count_us, uint32_t p1_pre_delay, uint32_t p1_post_delay,
+                                uint32_t p2_count_us, uint32_t p2_pre_delay, uint32_t p2_post_delay )
+{
+    if( ( ( p1_count_us - p2_count_us ) <= ( p1_pre_delay + p2_post_delay + TX_MARGIN_DELAY ) ) ||
+        ( ( p2_count_us - p1_count_us ) <= ( p2_pre_delay + p1_post_delay + TX_MARGIN_DELAY ) ) )
+    {
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+/* Rank of the first packet scheduled at or after count_us (binary search).
+ *  Warning: unsigned arithmetic (handle roll-over), all queued packets are
+ *  within TX_MAX_ADVANCE_DELAY so a signed difference orders them */
+static int jit_search( struct jit_queue_s* queue, uint32_t count_us )
+{
+    int lo = 0;
+    int hi = queue->num_pkt;
+    int mid;
+
+    while( lo < hi )
+    {
+        mid = ( lo + hi ) / 2;
+        if( ( int32_t ) ( JIT_NODE( queue, mid )->pkt.count_us - count_us ) < 0 )
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+static bool jit_collides_with( struct jit_node_s* node, uint32_t count_us, uint32_t pre_delay, uint32_t post_delay,
+                               enum jit_pkt_type_e pkt_type )
+{
+    uint32_t target_pre_delay = node->pre_delay;
+
+    /* We ignore Beacon Guard for Class A/C downlinks */
+    if( ( ( pkt_type == JIT_PKT_TYPE_DOWNLINK_CLASS_A ) || ( pkt_type == JIT_PKT_TYPE_DOWNLINK_CLASS_C ) ) &&
+        ( node->pkt_type == JIT_PKT_TYPE_BEACON ) )
+    {
+        target_pre_delay = TX_START_DELAY;
+    }
+
+    return jit_collision_test( count_us, pre_delay, post_delay, node->pkt.count_us, target_pre_delay,
+                               node->post_delay );
+}
+
+/* Rank of a queued packet colliding with the given time frame, -1 if none.
+ * Downlinks already queued never overlap each other, so only the closest one
+ * on each side of 'rank' can collide; beacons (at most JIT_NUM_BEACON_IN_QUEUE)
+ * reserve a guard interval that may span other packets and are checked apart. */
+static int jit_find_collision( struct jit_queue_s* queue, int rank, uint32_t count_us, uint32_t pre_delay,
+                               uint32_t post_delay, enum jit_pkt_type_e pkt_type )
+{
+    int i;
+
+    for( i = rank - 1; i >= 0; i-- )
+    {
+        if( JIT_NODE( queue, i )->pkt_type != JIT_PKT_TYPE_BEACON )
+        {
+            if( jit_collides_with( JIT_NODE( queue, i ), count_us, pre_delay, post_delay, pkt_type ) == true )
+            {
+                return i;
+            }
+            break;
+        }
+    }
+
+    for( i = rank; i < queue->num_pkt; i++ )
+    {
+        if( JIT_NODE( queue, i )->pkt_type != JIT_PKT_TYPE_BEACON )
+        {
+            if( jit_collides_with( JIT_NODE( queue, i ), count_us, pre_delay, post_delay, pkt_type ) == true )
+            {
+                return i;
+            }
+            break;
+        }
+    }
+
+    if( queue->num_beacon > 0 )
+    {
+        for( i = 0; i < queue->num_pkt; i++ )
+        {
+            if( ( JIT_NODE( queue, i )->pkt_type == JIT_PKT_TYPE_BEACON ) &&
+                ( jit_collides_with( JIT_NODE( queue, i ), count_us, pre_delay, post_delay, pkt_type ) == true ) )
+            {
+                return i;
+            }
+        }
+    }
+
+    return -1;
+}
+
+static void jit_remove( struct jit_queue_s* queue, int rank )
+{
+    uint8_t node_idx = queue->order[rank];
+
+    if( queue->nodes[node_idx].pkt_type == JIT_PKT_TYPE_BEACON )
+    {
+        queue->num_beacon--;
+    }
+    memset( &( queue->nodes[node_idx] ), 0, sizeof( struct jit_node_s ) );
+    queue->free_nodes |= ( 1UL << node_idx );
+
+    queue->num_pkt--;
+    memmove( &( queue->order[rank] ), &( queue->order[rank + 1] ), queue->num_pkt - rank );
+}
+
 /* -------------------------------------------------------------------------- */
 /* --- PUBLIC FUNCTIONS DEFINITION ----------------------------------------- */
 
@@ -84,73 +205,25 @@ bool jit_queue_is_empty( struct jit_queue_s* queue )
 
 void jit_queue_init( struct jit_queue_s* queue )
 {
-    int i;
-
     pthread_mutex_lock( &mx_jit_queue );
 
     memset( queue, 0, sizeof( *queue ) );
-    for( i = 0; i < JIT_QUEUE_MAX; i++ )
-    {
-        queue->nodes[i].pre_delay  = 0;
-        queue->nodes[i].post_delay = 0;
-    }
+    queue->free_nodes = ( JIT_QUEUE_MAX == 32 ) ? 0xFFFFFFFFUL : ( ( 1UL << JIT_QUEUE_MAX ) - 1 );
 
     pthread_mutex_unlock( &mx_jit_queue );
 }
 
-int compare( const void* a, const void* b, void* arg )
-{
-    struct jit_node_s* p       = ( struct jit_node_s* ) a;
-    struct jit_node_s* q       = ( struct jit_node_s* ) b;
-    int*               counter = ( int* ) arg;
-    int                p_count, q_count;
-
-    p_count = p->pkt.count_us;
-    q_count = q->pkt.count_us;
-
-    if( p_count > q_count )
-        *counter = *counter + 1;
-
-    return p_count - q_count;
-}
-
-void jit_sort_queue( struct jit_queue_s* queue )
-{
-    int counter = 0;
-
-    if( queue->num_pkt == 0 )
-    {
-        return;
-    }
-
-    MSG_DEBUG( DEBUG_JIT, "sorting queue in ascending order packet timestamp - queue size:%u\n", queue->num_pkt );
-    qsort_r( queue->nodes, queue->num_pkt, sizeof( queue->nodes[0] ), compare, &counter );
-    MSG_DEBUG( DEBUG_JIT, "sorting queue done - swapped:%d\n", counter );
-}
-
-bool jit_collision_test( uint32_t p1_count_us, uint32_t p1_pre_delay, uint32_t p1_post_delay, uint32_t p2_count_us,
-                         uint32_t p2_pre_delay, uint32_t p2_post_delay )
-{
-    if( ( ( p1_count_us - p2_count_us ) <= ( p1_pre_delay + p2_post_delay + TX_MARGIN_DELAY ) ) ||
-        ( ( p2_count_us - p1_count_us ) <= ( p2_pre_delay + p1_post_delay + TX_MARGIN_DELAY ) ) )
-    {
-        return true;
-    }
-    else
-    {
-        return false;
-    }
-}
-
 enum jit_error_e jit_enqueue( struct jit_queue_s* queue, uint32_t time_us, struct lgw_pkt_tx_s* packet,
                               enum jit_pkt_type_e pkt_type )
 {
-    int              i                 = 0;
-    uint32_t         packet_post_delay = 0;
-    uint32_t         packet_pre_delay  = 0;
-    uint32_t         target_pre_delay  = 0;
-    enum jit_error_e err_collision;
-    uint32_t         asap_count_us;
+    int                i                 = 0;
+    int                rank              = 0;
+    uint32_t           packet_post_delay = 0;
+    uint32_t           packet_pre_delay  = 0;
+    enum jit_error_e   err_collision;
+    uint32_t           asap_count_us;
+    uint8_t            node_idx;
+    struct jit_node_s* node;
 
     MSG_DEBUG( DEBUG_JIT, "Current concentrator time is %lu, pkt_type=%d\n", time_us, pkt_type );
 
@@ -160,12 +233,6 @@ enum jit_error_e jit_enqueue( struct jit_queue_s* queue, uint32_t time_us, struc
         return JIT_ERROR_INVALID;
     }
 
-    if( jit_queue_is_full( queue ) )
-    {
-        MSG_DEBUG( DEBUG_JIT_ERROR, "ERROR: cannot enqueue packet, JIT queue is full\n" );
-        return JIT_ERROR_FULL;
-    }
-
     /* Compute packet pre/post delays depending on packet's type */
     switch( pkt_type )
     {
@@ -186,6 +253,13 @@ enum jit_error_e jit_enqueue( struct jit_queue_s* queue, uint32_t time_us, struc
 
     pthread_mutex_lock( &mx_jit_queue );
 
+    if( queue->num_pkt == JIT_QUEUE_MAX )
+    {
+        pthread_mutex_unlock( &mx_jit_queue );
+        MSG_DEBUG( DEBUG_JIT_ERROR, "ERROR: cannot enqueue packet, JIT queue is full\n" );
+        return JIT_ERROR_FULL;
+    }
+
     /* An immediate downlink becomes a timestamped downlink "ASAP" */
     /* Set the packet count_us to the first available slot */
     if( pkt_type == JIT_PKT_TYPE_DOWNLINK_CLASS_C )
@@ -193,79 +267,24 @@ enum jit_error_e jit_enqueue( struct jit_queue_s* queue, uint32_t time_us, struc
         /* change tx_mode to timestamped */
         packet->tx_mode = TIMESTAMPED;
 
-        /* Search for the ASAP timestamp to be given to the packet */
+        /* Search for the ASAP timestamp to be given to the packet:
+            - ASAP meaning NOW + MARGIN
+            - else right after the downlink it collides with, or after one of the next ones
+        */
         asap_count_us = time_us + 1E6; /* take 1 second margin */
-        if( queue->num_pkt == 0 )
-        {
-            /* If the jit queue is empty, we can insert this packet */
-            MSG_DEBUG( DEBUG_JIT, "DEBUG: insert IMMEDIATE downlink, first in JiT queue (count_us=%lu)\n",
-                       asap_count_us );
-        }
-        else
+        rank          = jit_search( queue, asap_count_us );
+        i = jit_find_collision( queue, rank, asap_count_us, packet_pre_delay, packet_post_delay, pkt_type );
+        while( i >= 0 )
         {
-            /* Else we can try to insert it:
-                - ASAP meaning NOW + MARGIN
-                - at the last index of the queue
-                - between 2 downlinks in the queue
-            */
-
-            /* First, try if the ASAP time collides with an already enqueued downlink */
-            for( i = 0; i < queue->num_pkt; i++ )
-            {
-                if( jit_collision_test( asap_count_us, packet_pre_delay, packet_post_delay,
-                                        queue->nodes[i].pkt.count_us, queue->nodes[i].pre_delay,
-                                        queue->nodes[i].post_delay ) == true )
-                {
-                    MSG_DEBUG(
-                        DEBUG_JIT,
-                        "DEBUG: cannot insert IMMEDIATE downlink at count_us=%lu, collides with %lu (index=%d)\n",
-                        asap_count_us, queue->nodes[i].pkt.count_us, i );
-                    break;
-                }
-            }
-            if( i == queue->num_pkt )
-            {
-                /* No collision with ASAP time, we can insert it */
-                MSG_DEBUG( DEBUG_JIT, "DEBUG: insert IMMEDIATE downlink ASAP at %lu (no collision)\n", asap_count_us );
-            }
-            else
-            {
-                /* Search for the best slot then */
-                for( i = 0; i < queue->num_pkt; i++ )
-                {
-                    asap_count_us = queue->nodes[i].pkt.count_us + queue->nodes[i].post_delay + packet_pre_delay +
-                                    TX_JIT_DELAY + TX_MARGIN_DELAY;
-                    if( i == ( queue->num_pkt - 1 ) )
-                    {
-                        /* Last packet index, we can insert after this one */
-                        MSG_DEBUG( DEBUG_JIT, "DEBUG: insert IMMEDIATE downlink, last in JiT queue (count_us=%lu)\n",
-                                   asap_count_us );
-                    }
-                    else
-                    {
-                        /* Check if packet can be inserted between this index and the next one */
-                        MSG_DEBUG(
-                            DEBUG_JIT,
-                            "DEBUG: try to insert IMMEDIATE downlink (count_us=%lu) between index %d and index %d?\n",
-                            asap_count_us, i, i + 1 );
-                        if( jit_collision_test( asap_count_us, packet_pre_delay, packet_post_delay,
-                                                queue->nodes[i + 1].pkt.count_us, queue->nodes[i + 1].pre_delay,
-                                                queue->nodes[i + 1].post_delay ) == true )
-                        {
-                            MSG_DEBUG( DEBUG_JIT,
-                                       "DEBUG: failed to insert IMMEDIATE downlink (count_us=%lu), continue...\n",
-                                       asap_count_us );
-                            continue;
-                        }
-                        else
-                        {
-                            MSG_DEBUG( DEBUG_JIT, "DEBUG: insert IMMEDIATE downlink (count_us=%lu)\n", asap_count_us );
-                            break;
-                        }
-                    }
-                }
-            }
+            MSG_DEBUG( DEBUG_JIT, "DEBUG: cannot insert IMMEDIATE downlink at count_us=%lu, collides with %lu (index=%d)\n",
+                       asap_count_us, JIT_NODE( queue, i )->pkt.count_us, i );
+            asap_count_us = JIT_NODE( queue, i )->pkt.count_us + JIT_NODE( queue, i )->post_delay + packet_pre_delay +
+                            TX_JIT_DELAY + TX_MARGIN_DELAY;
+            rank = jit_search( queue, asap_count_us );
+            i    = jit_find_collision( queue, rank, asap_count_us, packet_pre_delay, packet_post_delay, pkt_type );
         }
+        MSG_DEBUG( DEBUG_JIT, "DEBUG: insert IMMEDIATE downlink at %lu (index=%d)\n", asap_count_us, rank );
+
         /* Set packet with ASAP timestamp */
         packet->count_us = asap_count_us;
     }
@@ -315,73 +334,61 @@ enum jit_error_e jit_enqueue( struct jit_queue_s* queue, uint32_t time_us, struc
      *  Note: - need to take into account packet's pre_delay and post_delay of each packet
      *        - Valid for both Downlinks and beacon packets
      *        - Beacon guard can be ignored if we try to queue a Class A downlink
+     *
+     *  Warning: unsigned arithmetic (handle roll-over)
+     *      t_packet_new - pre_delay_packet_new < t_packet_prev + post_delay_packet_prev (OVERLAP on post delay)
+     *      t_packet_new + post_delay_packet_new > t_packet_prev - pre_delay_packet_prev (OVERLAP on pre delay)
      */
-    for( i = 0; i < queue->num_pkt; i++ )
+    rank = jit_search( queue, packet->count_us );
+    i    = jit_find_collision( queue, rank, packet->count_us, packet_pre_delay, packet_post_delay, pkt_type );
+    if( i >= 0 )
     {
-        /* We ignore Beacon Guard for Class A/C downlinks */
-        if( ( ( pkt_type == JIT_PKT_TYPE_DOWNLINK_CLASS_A ) || ( pkt_type == JIT_PKT_TYPE_DOWNLINK_CLASS_C ) ) &&
-            ( queue->nodes[i].pkt_type == JIT_PKT_TYPE_BEACON ) )
-        {
-            target_pre_delay = TX_START_DELAY;
-        }
-        else
+        node = JIT_NODE( queue, i );
+        switch( node->pkt_type )
         {
-            target_pre_delay = queue->nodes[i].pre_delay;
-        }
-
-        /* Check if there is a collision
-         *  Warning: unsigned arithmetic (handle roll-over)
-         *      t_packet_new - pre_delay_packet_new < t_packet_prev + post_delay_packet_prev (OVERLAP on post delay)
-         *      t_packet_new + post_delay_packet_new > t_packet_prev - pre_delay_packet_prev (OVERLAP on pre delay)
-         */
-        if( jit_collision_test( packet->count_us, packet_pre_delay, packet_post_delay, queue->nodes[i].pkt.count_us,
-                                target_pre_delay, queue->nodes[i].post_delay ) == true )
-        {
-            switch( queue->nodes[i].pkt_type )
+        case JIT_PKT_TYPE_DOWNLINK_CLASS_A:
+        case JIT_PKT_TYPE_DOWNLINK_CLASS_B:
+        case JIT_PKT_TYPE_DOWNLINK_CLASS_C:
+            MSG_DEBUG( DEBUG_JIT_ERROR,
+                       "ERROR: Packet (type=%d) REJECTED, collision with packet already programmed at %lu (%lu)\n",
+                       pkt_type, node->pkt.count_us, packet->count_us );
+            err_collision = JIT_ERROR_COLLISION_PACKET;
+            break;
+        case JIT_PKT_TYPE_BEACON:
+            if( pkt_type != JIT_PKT_TYPE_BEACON )
             {
-            case JIT_PKT_TYPE_DOWNLINK_CLASS_A:
-            case JIT_PKT_TYPE_DOWNLINK_CLASS_B:
-            case JIT_PKT_TYPE_DOWNLINK_CLASS_C:
+                /* do not overload logs for beacon/beacon collision, as it is expected to happen with beacon
+                 * pre-scheduling algorith used */
                 MSG_DEBUG( DEBUG_JIT_ERROR,
-                           "ERROR: Packet (type=%d) REJECTED, collision with packet already programmed at %lu (%lu)\n",
-                           pkt_type, queue->nodes[i].pkt.count_us, packet->count_us );
-                err_collision = JIT_ERROR_COLLISION_PACKET;
-                break;
-            case JIT_PKT_TYPE_BEACON:
-                if( pkt_type != JIT_PKT_TYPE_BEACON )
-                {
-                    /* do not overload logs for beacon/beacon collision, as it is expected to happen with beacon
-                     * pre-scheduling algorith used */
-                    MSG_DEBUG(
-                        DEBUG_JIT_ERROR,
-                        "ERROR: Packet (type=%d) REJECTED, collision with beacon already programmed at %lu (%lu)\n",
-                        pkt_type, queue->nodes[i].pkt.count_us, packet->count_us );
-                }
-                err_collision = JIT_ERROR_COLLISION_BEACON;
-                break;
-            default:
-                ESP_LOGE( TAG_JITQ, "ERROR: Unknown packet type, should not occur, BUG?\n" );
-                assert( 0 );
-                break;
+                           "ERROR: Packet (type=%d) REJECTED, collision with beacon already programmed at %lu (%lu)\n",
+                           pkt_type, node->pkt.count_us, packet->count_us );
             }
-            pthread_mutex_unlock( &mx_jit_queue );
-            return err_collision;
+            err_collision = JIT_ERROR_COLLISION_BEACON;
+            break;
+        default:
+            ESP_LOGE( TAG_JITQ, "ERROR: Unknown packet type, should not occur, BUG?\n" );
+            assert( 0 );
+            break;
         }
+        pthread_mutex_unlock( &mx_jit_queue );
+        return err_collision;
     }
 
-    /* Finally enqueue it */
-    /* Insert packet at the end of the queue */
-    memcpy( &( queue->nodes[queue->num_pkt].pkt ), packet, sizeof( struct lgw_pkt_tx_s ) );
-    queue->nodes[queue->num_pkt].pre_delay  = packet_pre_delay;
-    queue->nodes[queue->num_pkt].post_delay = packet_post_delay;
-    queue->nodes[queue->num_pkt].pkt_type   = pkt_type;
+    /* Finally enqueue it, in a free node, at its rank in timestamp order */
+    node_idx = __builtin_ctz( queue->free_nodes );
+    queue->free_nodes &= ~( 1UL << node_idx );
+    node = &( queue->nodes[node_idx] );
+    memcpy( &( node->pkt ), packet, sizeof( struct lgw_pkt_tx_s ) );
+    node->pre_delay  = packet_pre_delay;
+    node->post_delay = packet_post_delay;
+    node->pkt_type   = pkt_type;
     if( pkt_type == JIT_PKT_TYPE_BEACON )
     {
         queue->num_beacon++;
     }
+    memmove( &( queue->order[rank + 1] ), &( queue->order[rank] ), queue->num_pkt - rank );
+    queue->order[rank] = node_idx;
     queue->num_pkt++;
-    /* Sort the queue in ascending order of packet timestamp */
-    jit_sort_queue( queue );
 
     /* Done */
     pthread_mutex_unlock( &mx_jit_queue );
@@ -409,30 +416,23 @@ enum jit_error_e jit_dequeue( struct jit_queue_s* queue, int index, struct lgw_p
         return JIT_ERROR_INVALID;
     }
 
-    if( jit_queue_is_empty( queue ) )
+    pthread_mutex_lock( &mx_jit_queue );
+
+    if( index >= queue->num_pkt )
     {
+        pthread_mutex_unlock( &mx_jit_queue );
         ESP_LOGE( TAG_JITQ, "ERROR: cannot dequeue packet, JIT queue is empty\n" );
         return JIT_ERROR_EMPTY;
     }
 
-    pthread_mutex_lock( &mx_jit_queue );
-
     /* Dequeue requested packet */
-    memcpy( packet, &( queue->nodes[index].pkt ), sizeof( struct lgw_pkt_tx_s ) );
-    queue->num_pkt--;
-    *pkt_type = queue->nodes[index].pkt_type;
+    memcpy( packet, &( JIT_NODE( queue, index )->pkt ), sizeof( struct lgw_pkt_tx_s ) );
+    *pkt_type = JIT_NODE( queue, index )->pkt_type;
     if( *pkt_type == JIT_PKT_TYPE_BEACON )
     {
-        queue->num_beacon--;
         MSG_DEBUG( DEBUG_BEACON, "--- Beacon dequeued ---\n" );
     }
-
-    /* Replace dequeued packet with last packet of the queue */
-    memcpy( &( queue->nodes[index] ), &( queue->nodes[queue->num_pkt] ), sizeof( struct jit_node_s ) );
-    memset( &( queue->nodes[queue->num_pkt] ), 0, sizeof( struct jit_node_s ) );
-
-    /* Sort queue in ascending order of packet timestamp */
-    jit_sort_queue( queue );
+    jit_remove( queue, index );
 
     /* Done */
     pthread_mutex_unlock( &mx_jit_queue );
@@ -447,83 +447,93 @@ enum jit_error_e jit_dequeue( struct jit_queue_s* queue, int index, struct lgw_p
 enum jit_error_e jit_peek( struct jit_queue_s* queue, uint32_t time_us, int* pkt_idx )
 {
     /* Return index of node containing a packet inline with given time */
-    int i                    = 0;
-    int idx_highest_priority = -1;
+    struct jit_node_s* node;
+
     if( pkt_idx == NULL )
     {
         ESP_LOGE( TAG_JITQ, "ERROR: invalid parameter\n" );
         return JIT_ERROR_INVALID;
     }
 
-    if( jit_queue_is_empty( queue ) )
+    pthread_mutex_lock( &mx_jit_queue );
+
+    if( queue->num_pkt == 0 )
     {
+        pthread_mutex_unlock( &mx_jit_queue );
         return JIT_ERROR_EMPTY;
     }
 
-    pthread_mutex_lock( &mx_jit_queue );
-
-    /* Search for highest priority packet to be sent */
-    for( i = 0; i < queue->num_pkt; i++ )
+    /* The queue is sorted, outdated packets can only be at its head:
+     *  If a packet seems too much in advance, and was not rejected at enqueue time,
+     *  it means that we missed it for peeking, we need to drop it
+     *
+     *  Warning: unsigned arithmetic
+     *      t_packet > t_current + TX_MAX_ADVANCE_DELAY
+     */
+    *pkt_idx = -1;
+    while( queue->num_pkt > 0 )
     {
-        /* First check if that packet is outdated:
-         *  If a packet seems too much in advance, and was not rejected at enqueue time,
-         *  it means that we missed it for peeking, we need to drop it
-         *
-         *  Warning: unsigned arithmetic
-         *      t_packet > t_current + TX_MAX_ADVANCE_DELAY
-         */
-        if( ( queue->nodes[i].pkt.count_us - time_us ) >= TX_MAX_ADVANCE_DELAY )
+        node = JIT_NODE( queue, 0 );
+        if( ( node->pkt.count_us - time_us ) < TX_MAX_ADVANCE_DELAY )
         {
-            /* We drop the packet to avoid lock-up */
-            queue->num_pkt--;
-            if( queue->nodes[i].pkt_type == JIT_PKT_TYPE_BEACON )
-            {
-                queue->num_beacon--;
-                ESP_LOGW( TAG_JITQ, "WARNING: --- Beacon dropped (current_time=%lu, packet_time=%lu) ---\n", time_us,
-                          queue->nodes[i].pkt.count_us );
-            }
-            else
+            /* Peek criteria 1: look for a packet to be sent in next TX_JIT_DELAY ms timeframe
+             *  Warning: unsigned arithmetic (handle roll-over)
+             *      t_packet < t_current + TX_JIT_DELAY
+             */
+            if( ( node->pkt.count_us - time_us ) < TX_JIT_DELAY )
             {
-                ESP_LOGW( TAG_JITQ, "WARNING: --- Packet dropped (current_time=%lu, packet_time=%lu) ---\n", time_us,
-                          queue->nodes[i].pkt.count_us );
+                *pkt_idx = 0;
+                MSG_DEBUG( DEBUG_JIT, "peek packet with count_us=%lu at index 0\n", node->pkt.count_us );
             }
-
-            /* Replace dropped packet with last packet of the queue */
-            memcpy( &( queue->nodes[i] ), &( queue->nodes[queue->num_pkt] ), sizeof( struct jit_node_s ) );
-            memset( &( queue->nodes[queue->num_pkt] ), 0, sizeof( struct jit_node_s ) );
-
-            /* Sort queue in ascending order of packet timestamp */
-            jit_sort_queue( queue );
-
-            /* restart loop  after purge to find packet to be sent */
-            i = 0;
-            continue;
+            break;
         }
 
-        /* Then look for highest priority packet to be sent:
-         *  Warning: unsigned arithmetic (handle roll-over)
-         *      t_packet < t_highest
-         */
-        if( ( idx_highest_priority == -1 ) || ( ( ( queue->nodes[i].pkt.count_us - time_us ) <
-                                                  ( queue->nodes[idx_highest_priority].pkt.count_us - time_us ) ) ) )
+        /* We drop the packet to avoid lock-up */
+        if( node->pkt_type == JIT_PKT_TYPE_BEACON )
         {
-            idx_highest_priority = i;
+            ESP_LOGW( TAG_JITQ, "WARNING: --- Beacon dropped (current_time=%lu, packet_time=%lu) ---\n", time_us,
+                      node->pkt.count_us );
         }
+        else
+        {
+            ESP_LOGW( TAG_JITQ, "WARNING: --- Packet dropped (current_time=%lu, packet_time=%lu) ---\n", time_us,
+                      node->pkt.count_us );
+        }
+        jit_remove( queue, 0 );
     }
 
-    /* Peek criteria 1: look for a packet to be sent in next TX_JIT_DELAY ms timeframe
-     *  Warning: unsigned arithmetic (handle roll-over)
-     *      t_packet < t_current + TX_JIT_DELAY
-     */
-    if( ( queue->nodes[idx_highest_priority].pkt.count_us - time_us ) < TX_JIT_DELAY )
+    pthread_mutex_unlock( &mx_jit_queue );
+
+    return JIT_ERROR_OK;
+}
+
+enum jit_error_e jit_peek_delay( struct jit_queue_s* queue, uint32_t time_us, uint32_t* delay_us )
+{
+    uint32_t delta_us;
+
+    if( delay_us == NULL )
     {
-        *pkt_idx = idx_highest_priority;
-        MSG_DEBUG( DEBUG_JIT, "peek packet with count_us=%lu at index %d\n",
-                   queue->nodes[idx_highest_priority].pkt.count_us, idx_highest_priority );
+        ESP_LOGE( TAG_JITQ, "ERROR: invalid parameter\n" );
+        return JIT_ERROR_INVALID;
+    }
+
+    pthread_mutex_lock( &mx_jit_queue );
+
+    if( queue->num_pkt == 0 )
+    {
+        pthread_mutex_unlock( &mx_jit_queue );
+        return JIT_ERROR_EMPTY;
+    }
+
+    /* Same criteria as jit_peek(), outdated packets are due now (to be dropped) */
+    delta_us = JIT_NODE( queue, 0 )->pkt.count_us - time_us;
+    if( ( delta_us >= TX_MAX_ADVANCE_DELAY ) || ( delta_us < TX_JIT_DELAY ) )
+    {
+        *delay_us = 0;
     }
     else
     {
-        *pkt_idx = -1;
+        *delay_us = delta_us - TX_JIT_DELAY + 1;
     }
 
     pthread_mutex_unlock( &mx_jit_queue );
@@ -534,25 +544,27 @@ enum jit_error_e jit_peek( struct jit_queue_s* queue, uint32_t time_us, int* pkt
 void jit_print_queue( struct jit_queue_s* queue, bool show_all, int debug_level )
 {
     int i = 0;
-    int loop_end;
 
-    if( jit_queue_is_empty( queue ) )
+    pthread_mutex_lock( &mx_jit_queue );
+
+    if( queue->num_pkt == 0 )
     {
         MSG_DEBUG( debug_level, "INFO: [jit] queue is empty\n" );
     }
     else
     {
-        pthread_mutex_lock( &mx_jit_queue );
-
         MSG_DEBUG( debug_level, "INFO: [jit] queue contains %d packets:\n", queue->num_pkt );
         MSG_DEBUG( debug_level, "INFO: [jit] queue contains %d beacons:\n", queue->num_beacon );
-        loop_end = ( show_all == true ) ? JIT_QUEUE_MAX : queue->num_pkt;
-        for( i = 0; i < loop_end; i++ )
+        for( i = 0; i < queue->num_pkt; i++ )
         {
-            MSG_DEBUG( debug_level, " - node[%d]: count_us=%lu - type=%d\n", i, queue->nodes[i].pkt.count_us,
-                       queue->nodes[i].pkt_type );
+            MSG_DEBUG( debug_level, " - node[%d]: count_us=%lu - type=%d\n", i, JIT_NODE( queue, i )->pkt.count_us,
+                       JIT_NODE( queue, i )->pkt_type );
+        }
+        if( show_all == true )
+        {
+            MSG_DEBUG( debug_level, " - %d free nodes\n", JIT_QUEUE_MAX - queue->num_pkt );
         }
-
-        pthread_mutex_unlock( &mx_jit_queue );
     }
+
+    pthread_mutex_unlock( &mx_jit_queue );
 }
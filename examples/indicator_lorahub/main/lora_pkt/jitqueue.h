@@ -71,6 +71,8 @@ struct jit_queue_s
 {
     uint8_t           num_pkt;              /* Total number of packets in the queue (downlinks, beacons...) */
     uint8_t           num_beacon;           /* Number of beacons in the queue */
+    uint32_t          free_nodes;           /* Bitmap of unused entries in nodes[] */
+    uint8_t           order[JIT_QUEUE_MAX]; /* Indexes in nodes[], in ascending packet timestamp order */
     struct jit_node_s nodes[JIT_QUEUE_MAX]; /* Nodes/packets array in the queue */
 };
 
@@ -122,7 +124,7 @@ enum jit_error_e jit_enqueue( struct jit_queue_s* queue, uint32_t time_us, struc
 @brief Dequeue a packet from a Just-in-Time queue
 
 @param queue[in/out] Just in Time queue from which the packet should be removed
-@param index[in] in the queue where to get the packet to be removed
+@param index[in] rank in the queue (0 is the earliest packet) of the packet to be removed
 @param packet[out] that was at index
 @param pkt_type[out] Type of packet dequeued: Downlink, Beacon
 @return success if the function was able to dequeue the packet
@@ -142,11 +144,24 @@ enum jit_error_e jit_dequeue( struct jit_queue_s* queue, int index, struct lgw_p
 @return success if the function was able to parse the queue. pkt_idx is set to -1 if no packet found.
 
 This function is typically used to check in JiT queue if there is a packet soon to be sent.
-It search the packet with the highest priority in queue, and check if its timestamp is near
-enough the current concentrator time.
+The queue is kept in timestamp order, so only its head is checked against the current
+concentrator time (outdated packets at the head are dropped).
 */
 enum jit_error_e jit_peek( struct jit_queue_s* queue, uint32_t time_us, int* pkt_idx );
 
+/**
+@brief Get the time left before jit_peek() returns a packet.
+
+@param queue[in] Just in Time queue to be checked
+@param time_us[in] Current concentrator time
+@param delay_us[out] Time to wait, in microseconds (0 if a packet is already due)
+@return JIT_ERROR_EMPTY if there is no packet to wait for, JIT_ERROR_OK otherwise.
+
+This function is typically used by the JiT thread to sleep until the next packet must be
+programmed, instead of polling the queue.
+*/
+enum jit_error_e jit_peek_delay( struct jit_queue_s* queue, uint32_t time_us, uint32_t* delay_us );
+
 /**
 @brief Debug function to print the queue's content on console
 
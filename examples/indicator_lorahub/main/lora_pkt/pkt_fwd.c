@@ -39,7 +39,7 @@ License: Revised BSD License, see LICENSE.TXT file include in the project
 #include "pkt_fwd.h"
 #include "trace.h"
 #include "jitqueue.h"
-#include "parson.h"
+#include "txpk.h"
 #include "base64.h"
 #include "lorahub_hal.h"
 
@@ -72,7 +72,8 @@ License: Revised BSD License, see LICENSE.TXT file include in the project
 #define DEFAULT_STAT 30      /* default time interval for statistics */
 #define PUSH_TIMEOUT_MS 100
 #define PULL_TIMEOUT_MS 200
-#define FETCH_SLEEP_MS 10 /* nb of ms waited when a fetch return no packets */
+#define FETCH_WAIT_MS 100 /* max nb of ms waited for a packet before checking for a status report */
+#define JIT_WAIT_MAX_MS 1000 /* max nb of ms the JiT thread sleeps when no packet is due */
 
 #define PROTOCOL_VERSION 2 /* v1.3 */
 #define PROTOCOL_JSON_RXPK_FRAME_FORMAT 1
@@ -84,7 +85,8 @@ License: Revised BSD License, see LICENSE.TXT file include in the project
 #define PKT_PULL_ACK 4
 #define PKT_TX_ACK 5
 
-#define NB_PKT_MAX 1 /* max number of packets per fetch/send cycle */
+#define NB_PKT_MAX 8 /* max number of packets per fetch/send cycle */
+#define PUSH_BATCH_MS CONFIG_PUSH_DATA_BATCH_MS /* max time the first packet of a datagram waits for others */
 
 #define STATUS_SIZE 200
 #define TX_BUFF_SIZE ( ( 540 * NB_PKT_MAX ) + 30 + STATUS_SIZE )
@@ -177,6 +179,7 @@ static uint32_t autoquit_threshold =
 
 /* Just In Time TX scheduling */
 static struct jit_queue_s jit_queue[LGW_RF_CHAIN_NB];
+static TaskHandle_t       jit_task = NULL; /* woken up when a packet is enqueued */
 
 /* Gateway specificities */
 static int8_t antenna_gain = 0;
@@ -364,6 +367,37 @@ static int parse_radio_configuration( void )
         return -1;
     }
 
+#ifdef CONFIG_CHANNEL_SCAN
+    /* Scan config: channels spaced from the channel frequency, SFs from the channel datarate */
+    struct lgw_conf_scan_s scan_conf;
+    uint32_t               dr;
+    uint32_t               dr_max;
+    int                    i;
+
+    memset( &scan_conf, 0, sizeof( struct lgw_conf_scan_s ) );
+    scan_conf.enable  = true;
+    scan_conf.nb_chan = CONFIG_CHANNEL_SCAN_NB;
+    for( i = 0; i < scan_conf.nb_chan; i++ )
+    {
+        scan_conf.freq_hz[i] = rxrf_conf.freq_hz + i * CONFIG_CHANNEL_SCAN_STEP_HZ;
+    }
+    dr_max = ( CONFIG_CHANNEL_SCAN_DATARATE_MAX > rxif_conf.datarate ) ? CONFIG_CHANNEL_SCAN_DATARATE_MAX
+                                                                       : rxif_conf.datarate;
+    for( dr = rxif_conf.datarate; dr <= dr_max; dr++ )
+    {
+        scan_conf.datarate_mask |= ( 1 << dr );
+    }
+    ESP_LOGI( TAG_PKT_FWD, "Scan %u channels from %" PRIu32 "hz every %" PRIu32 "hz, SF%" PRIu32 " to SF%" PRIu32,
+              scan_conf.nb_chan, rxrf_conf.freq_hz, ( uint32_t ) CONFIG_CHANNEL_SCAN_STEP_HZ, rxif_conf.datarate,
+              dr_max );
+    err_lgw = lgw_scan_setconf( &scan_conf );
+    if( err_lgw != LGW_HAL_SUCCESS )
+    {
+        ESP_LOGE( TAG_PKT_FWD, "ERROR: lgw_scan_setconf() failed\n" );
+        return -1;
+    }
+#endif
+
     return 0;
 }
 
@@ -593,17 +627,88 @@ static int send_tx_ack( uint8_t token_h, uint8_t token_l, enum jit_error_e error
 static uint8_t buff_up[TX_BUFF_SIZE]; /* buffer to compose the upstream packet */
 static uint8_t buff_up_ack[32];       /* buffer to receive acknowledges */
 
+static struct lgw_pkt_rx_s rxpkt[NB_PKT_MAX]; /* array containing inbound packets + metadata */
+
+/* Fixed-buffer JSON number writers used to serialize rxpk objects. They write
+ * at 'buff' without bound checking (TX_BUFF_SIZE is sized for NB_PKT_MAX
+ * worst case packets) and return the number of chars written. */
+static int json_write_uint( uint8_t* buff, uint32_t value )
+{
+    uint8_t digits[10];
+    int     n = 0;
+    int     i;
+
+    do
+    {
+        digits[n++] = '0' + ( value % 10 );
+        value /= 10;
+    } while( value > 0 );
+
+    for( i = 0; i < n; i++ )
+    {
+        buff[i] = digits[n - 1 - i];
+    }
+
+    return n;
+}
+
+static int json_write_int( uint8_t* buff, int32_t value )
+{
+    if( value < 0 )
+    {
+        buff[0] = '-';
+        return 1 + json_write_uint( buff + 1, ( uint32_t ) ( -( int64_t ) value ) );
+    }
+
+    return json_write_uint( buff, ( uint32_t ) value );
+}
+
+/* write 'value / 10^nb_decimals' with exactly 'nb_decimals' digits after the point */
+static int json_write_ufixed( uint8_t* buff, uint32_t value, int nb_decimals )
+{
+    uint32_t scale = 1;
+    uint32_t frac;
+    int      n;
+    int      i;
+
+    for( i = 0; i < nb_decimals; i++ )
+    {
+        scale *= 10;
+    }
+
+    n         = json_write_uint( buff, value / scale );
+    buff[n++] = '.';
+    frac      = value % scale;
+    for( i = nb_decimals - 1; i >= 0; i-- )
+    {
+        buff[n + i] = '0' + ( frac % 10 );
+        frac /= 10;
+    }
+
+    return n + nb_decimals;
+}
+
+static int json_write_fixed( uint8_t* buff, int32_t value, int nb_decimals )
+{
+    if( value < 0 )
+    {
+        buff[0] = '-';
+        return 1 + json_write_ufixed( buff + 1, ( uint32_t ) ( -( int64_t ) value ), nb_decimals );
+    }
+
+    return json_write_ufixed( buff, ( uint32_t ) value, nb_decimals );
+}
+
 void thread_up( void )
 {
     int      i, j;         /* loop variables */
     unsigned pkt_in_dgram; /* nb on Lora packet in the current datagram */
-    char     stat_timestamp[24];
-    time_t   t;
 
-    /* allocate memory for packet fetching and processing */
-    struct lgw_pkt_rx_s  rxpkt[NB_PKT_MAX]; /* array containing inbound packets + metadata */
-    struct lgw_pkt_rx_s* p;                 /* pointer on a RX packet */
+    /* packet fetching and processing */
+    struct lgw_pkt_rx_s* p; /* pointer on a RX packet */
     int                  nb_pkt;
+    TickType_t           batch_end;
+    int32_t              batch_left;
 
     /* data buffers */
     int buff_index;
@@ -642,10 +747,8 @@ void thread_up( void )
     {
         // ESP_LOGI(TAG_UP, "UP");
 
-        /* fetch packets */
-        pthread_mutex_lock( &mx_concent );
+        /* fetch packets (queued by the HAL RX task, no need to lock the concentrator) */
         nb_pkt = lgw_receive( NB_PKT_MAX, rxpkt );
-        pthread_mutex_unlock( &mx_concent );
         if( nb_pkt == LGW_HAL_ERROR )
         {
             ESP_LOGE( TAG_UP, "ERROR: [up] failed packet fetch, exiting\n" );
@@ -657,16 +760,35 @@ void thread_up( void )
         send_report = report_ready; /* copy the variable so it doesn't change mid-function */
         /* no mutex, we're only reading */
 
-        /* wait a short time if no packets, nor status report */
+        /* wait for a packet if none, nor status report */
         if( ( nb_pkt == 0 ) && ( send_report == false ) )
         {
-            vTaskDelay( FETCH_SLEEP_MS / portTICK_PERIOD_MS );
+            lgw_receive_wait( FETCH_WAIT_MS );
             continue;
         }
 
-        /* get timestamp for statistics */
-        t = time( NULL );
-        strftime( stat_timestamp, sizeof stat_timestamp, "%F %T %Z", gmtime( &t ) );
+        /* let packets of the same burst share the datagram (and its ACK wait) */
+        if( ( nb_pkt > 0 ) && ( PUSH_BATCH_MS > 0 ) )
+        {
+            batch_end = xTaskGetTickCount( ) + pdMS_TO_TICKS( PUSH_BATCH_MS );
+            while( nb_pkt < NB_PKT_MAX )
+            {
+                batch_left = ( int32_t ) ( batch_end - xTaskGetTickCount( ) );
+                if( batch_left <= 0 )
+                {
+                    break;
+                }
+                if( lgw_receive_wait( pdTICKS_TO_MS( batch_left ) ) > 0 )
+                {
+                    j = lgw_receive( NB_PKT_MAX - nb_pkt, &rxpkt[nb_pkt] );
+                    if( j > 0 )
+                    {
+                        nb_pkt += j;
+                    }
+                }
+            }
+            send_report = report_ready;
+        }
 
         /* start composing datagram with the header */
         token_h    = ( uint8_t ) rand( ); /* random token */
@@ -760,46 +882,25 @@ void thread_up( void )
             }
 
             /* JSON rxpk frame format version, 8 useful chars */
-            j = snprintf( ( char* ) ( buff_up + buff_index ), TX_BUFF_SIZE - buff_index, "\"jver\":%d",
-                          PROTOCOL_JSON_RXPK_FRAME_FORMAT );
-            if( j > 0 )
-            {
-                buff_index += j;
-            }
-            else
-            {
-                ESP_LOGE( TAG_UP, "ERROR: [up] snprintf failed line %u\n", ( __LINE__ - 4 ) );
-                lorahub_log_display(LORAHUB_LOG_LEVEL_ERROR, "ERROR: [up] snprintf failed line %u\n", ( __LINE__ - 4 ) );
-                wait_on_error( LRHB_ERROR_UNKNOWN, __LINE__ );
-            }
+            memcpy( ( void* ) ( buff_up + buff_index ), ( void* ) "\"jver\":", 7 );
+            buff_index += 7;
+            buff_index += json_write_uint( buff_up + buff_index, PROTOCOL_JSON_RXPK_FRAME_FORMAT );
 
             /* RAW timestamp, 8-17 useful chars */
-            j = snprintf( ( char* ) ( buff_up + buff_index ), TX_BUFF_SIZE - buff_index, ",\"tmst\":%lu", p->count_us );
-            if( j > 0 )
-            {
-                buff_index += j;
-            }
-            else
-            {
-                ESP_LOGE( TAG_UP, "ERROR: [up] snprintf failed line %u\n", ( __LINE__ - 4 ) );
-                lorahub_log_display(LORAHUB_LOG_LEVEL_ERROR, "ERROR: [up] snprintf failed line %u\n", ( __LINE__ - 4 ) );
-                wait_on_error( LRHB_ERROR_UNKNOWN, __LINE__ );
-            }
+            memcpy( ( void* ) ( buff_up + buff_index ), ( void* ) ",\"tmst\":", 8 );
+            buff_index += 8;
+            buff_index += json_write_uint( buff_up + buff_index, p->count_us );
 
             /* Packet concentrator channel, RF chain & RX frequency, 34-36 useful chars */
-            j = snprintf( ( char* ) ( buff_up + buff_index ), TX_BUFF_SIZE - buff_index,
-                          ",\"chan\":%1u,\"rfch\":%1u,\"freq\":%.6lf", p->if_chain, p->rf_chain,
-                          ( ( double ) p->freq_hz / 1e6 ) );
-            if( j > 0 )
-            {
-                buff_index += j;
-            }
-            else
-            {
-                ESP_LOGE( TAG_UP, "ERROR: [up] snprintf failed line %u\n", ( __LINE__ - 4 ) );
-                lorahub_log_display(LORAHUB_LOG_LEVEL_ERROR, "ERROR: [up] snprintf failed line %u\n", ( __LINE__ - 4 ) );
-                wait_on_error( LRHB_ERROR_UNKNOWN, __LINE__ );
-            }
+            memcpy( ( void* ) ( buff_up + buff_index ), ( void* ) ",\"chan\":", 8 );
+            buff_index += 8;
+            buff_index += json_write_uint( buff_up + buff_index, p->if_chain );
+            memcpy( ( void* ) ( buff_up + buff_index ), ( void* ) ",\"rfch\":", 8 );
+            buff_index += 8;
+            buff_index += json_write_uint( buff_up + buff_index, p->rf_chain );
+            memcpy( ( void* ) ( buff_up + buff_index ), ( void* ) ",\"freq\":", 8 );
+            buff_index += 8;
+            buff_index += json_write_ufixed( buff_up + buff_index, p->freq_hz, 6 ); /* MHz */
 
             /* Packet status, 9-10 useful chars */
             switch( p->status )
@@ -926,16 +1027,9 @@ void thread_up( void )
                 }
 
                 /* Lora SNR */
-                j = snprintf( ( char* ) ( buff_up + buff_index ), TX_BUFF_SIZE - buff_index, ",\"lsnr\":%.1f", p->snr );
-                if( j > 0 )
-                {
-                    buff_index += j;
-                }
-                else
-                {
-                    ESP_LOGE( TAG_UP, "ERROR: [up] snprintf failed line %u\n", ( __LINE__ - 4 ) );
-                    wait_on_error( LRHB_ERROR_UNKNOWN, __LINE__ );
-                }
+                memcpy( ( void* ) ( buff_up + buff_index ), ( void* ) ",\"lsnr\":", 8 );
+                buff_index += 8;
+                buff_index += json_write_fixed( buff_up + buff_index, ( int32_t ) lroundf( p->snr * 10 ), 1 );
             }
             else
             {
@@ -945,18 +1039,12 @@ void thread_up( void )
             }
 
             /* Channel RSSI, payload size, 18-23 useful chars */
-            j = snprintf( ( char* ) ( buff_up + buff_index ), TX_BUFF_SIZE - buff_index, ",\"rssi\":%.0f,\"size\":%u",
-                          roundf( p->rssic ), p->size );
-            if( j > 0 )
-            {
-                buff_index += j;
-            }
-            else
-            {
-                ESP_LOGE( TAG_UP, "ERROR: [up] snprintf failed line %u\n", ( __LINE__ - 4 ) );
-                lorahub_log_display(LORAHUB_LOG_LEVEL_ERROR, "ERROR: [up] snprintf failed line %u\n", ( __LINE__ - 4 ) );
-                wait_on_error( LRHB_ERROR_UNKNOWN, __LINE__ );
-            }
+            memcpy( ( void* ) ( buff_up + buff_index ), ( void* ) ",\"rssi\":", 8 );
+            buff_index += 8;
+            buff_index += json_write_int( buff_up + buff_index, ( int32_t ) lroundf( p->rssic ) );
+            memcpy( ( void* ) ( buff_up + buff_index ), ( void* ) ",\"size\":", 8 );
+            buff_index += 8;
+            buff_index += json_write_uint( buff_up + buff_index, p->size );
 
             /* Packet base64-encoded payload, 14-350 useful chars */
             memcpy( ( void* ) ( buff_up + buff_index ), ( void* ) ",\"data\":\"", 9 );
@@ -1014,7 +1102,8 @@ void thread_up( void )
         {
             pthread_mutex_lock( &mx_stat_rep );
             report_ready = false;
-            j = snprintf( ( char* ) ( buff_up + buff_index ), TX_BUFF_SIZE - buff_index, "%s", status_report );
+            j = strnlen( status_report, STATUS_SIZE );
+            memcpy( ( void* ) ( buff_up + buff_index ), ( void* ) status_report, j );
             pthread_mutex_unlock( &mx_stat_rep );
             if( j > 0 )
             {
@@ -1125,11 +1214,8 @@ void thread_down( void )
     bool    req_ack = false; /* keep track of whether PULL_DATA was acknowledged or not */
 
     /* JSON parsing variables */
-    JSON_Value*  root_val = NULL;
-    JSON_Object* txpk_obj = NULL;
-    JSON_Value*  val      = NULL; /* needed to detect the absence of some fields */
-    const char*  str;             /* pointer to sub-strings in the JSON data */
-    short        x0, x1;
+    struct txpk_s txpk;       /* fields found in the 'txpk' object */
+    uint32_t      txpk_valid; /* fields found and successfully decoded */
 
     /* auto-quit variable */
     uint32_t autoquit_cnt = 0; /* count the number of PULL_DATA sent since the latest PULL_ACK */
@@ -1253,28 +1339,22 @@ void thread_down( void )
             printf( "\nJSON down: %s\n", ( char* ) ( buff_down + 4 ) ); /* DEBUG: display JSON payload */
             lorahub_log_display(LORAHUB_LOG_LEVEL_INFO, "\nJSON down: %s\n", ( char* ) ( buff_down + 4 ) );
 
-            /* initialize TX struct and try to parse JSON */
-            memset( &txpkt, 0, sizeof txpkt );
-            root_val = json_parse_string_with_comments( ( const char* ) ( buff_down + 4 ) ); /* JSON offset */
-            if( root_val == NULL )
+            /* decode the JSON 'txpk' object straight into the TX struct */
+            i = txpk_parse( ( const char* ) ( buff_down + 4 ), msg_len - 4, &txpkt, &txpk ); /* JSON offset */
+            if( i == TXPK_PARSE_ERROR )
             {
                 ESP_LOGW( TAG_DOWN, "WARNING: [down] invalid JSON, TX aborted\n" );
                 continue;
             }
-
-            /* look for JSON sub-object 'txpk' */
-            txpk_obj = json_object_get_object( json_value_get_object( root_val ), "txpk" );
-            if( txpk_obj == NULL )
+            if( i == TXPK_PARSE_NO_TXPK )
             {
                 ESP_LOGW( TAG_DOWN, "WARNING: [down] no \"txpk\" object in JSON, TX aborted\n" );
-                json_value_free( root_val );
                 continue;
             }
+            txpk_valid = txpk.fields & ~txpk.invalid;
 
             /* Parse "immediate" tag, or target timestamp, or UTC time to be converted by GPS (mandatory) */
-            i = json_object_get_boolean( txpk_obj,
-                                         "imme" ); /* can be 1 if true, 0 if false, or -1 if not a JSON boolean */
-            if( i == 1 )
+            if( txpk.imme == true )
             {
                 /* TX procedure: send immediately */
                 sent_immediate = true;
@@ -1284,234 +1364,135 @@ void thread_down( void )
             else
             {
                 sent_immediate = false;
-                val            = json_object_get_value( txpk_obj, "tmst" );
-                if( val != NULL )
+                if( ( txpk.fields & TXPK_FIELD_TMST ) == 0 )
                 {
-                    /* TX procedure: send on timestamp value */
-                    txpkt.count_us = ( uint32_t ) json_value_get_number( val );
-
-                    /* Concentrator timestamp is given, we consider it is a Class A downlink */
-                    downlink_type = JIT_PKT_TYPE_DOWNLINK_CLASS_A;
+                    ESP_LOGW( TAG_DOWN, "WARNING: [down] no mandatory \"txpk.tmst\" objects in JSON, TX aborted\n" );
+                    continue;
                 }
-                else
+                if( ( txpk.invalid & TXPK_FIELD_TMST ) != 0 )
                 {
-                    ESP_LOGW( TAG_DOWN, "WARNING: [down] no mandatory \"txpk.tmst\" objects in JSON, TX aborted\n" );
-                    json_value_free( root_val );
+                    ESP_LOGW( TAG_DOWN, "WARNING: [down] format error in \"txpk.tmst\", TX aborted\n" );
                     continue;
                 }
-            }
 
-            /* Parse "No CRC" flag (optional field) */
-            val = json_object_get_value( txpk_obj, "ncrc" );
-            if( val != NULL )
-            {
-                txpkt.no_crc = ( bool ) json_value_get_boolean( val );
+                /* Concentrator timestamp is given, we consider it is a Class A downlink */
+                downlink_type = JIT_PKT_TYPE_DOWNLINK_CLASS_A;
             }
 
-            /* Parse "No header" flag (optional field) */
-            val = json_object_get_value( txpk_obj, "nhdr" );
-            if( val != NULL )
-            {
-                txpkt.no_header = ( bool ) json_value_get_boolean( val );
-            }
+            /* "ncrc" and "nhdr" flags are optional, already decoded */
 
-            /* parse target frequency (mandatory) */
-            val = json_object_get_value( txpk_obj, "freq" );
-            if( val == NULL )
+            /* check target frequency (mandatory) */
+            if( ( txpk.fields & TXPK_FIELD_FREQ ) == 0 )
             {
                 ESP_LOGW( TAG_DOWN, "WARNING: [down] no mandatory \"txpk.freq\" object in JSON, TX aborted\n" );
-                json_value_free( root_val );
                 continue;
             }
-            txpkt.freq_hz = ( uint32_t )( ( double ) ( 1.0e6 ) * json_value_get_number( val ) );
+            if( ( txpk.invalid & TXPK_FIELD_FREQ ) != 0 )
+            {
+                ESP_LOGW( TAG_DOWN, "WARNING: [down] format error in \"txpk.freq\", TX aborted\n" );
+                continue;
+            }
 
-            /* parse RF chain used for TX (mandatory) */
-            val = json_object_get_value( txpk_obj, "rfch" );
-            if( val == NULL )
+            /* check RF chain used for TX (mandatory) */
+            if( ( txpk.fields & TXPK_FIELD_RFCH ) == 0 )
             {
                 ESP_LOGW( TAG_DOWN, "WARNING: [down] no mandatory \"txpk.rfch\" object in JSON, TX aborted\n" );
-                json_value_free( root_val );
                 continue;
             }
-            txpkt.rf_chain = ( uint8_t ) json_value_get_number( val );
-            if( tx_enable[txpkt.rf_chain] == false )
+            if( ( txpk.invalid & TXPK_FIELD_RFCH ) != 0 )
+            {
+                ESP_LOGW( TAG_DOWN, "WARNING: [down] format error in \"txpk.rfch\", TX aborted\n" );
+                continue;
+            }
+            if( ( txpkt.rf_chain >= LGW_RF_CHAIN_NB ) || ( tx_enable[txpkt.rf_chain] == false ) )
             {
                 ESP_LOGW( TAG_DOWN, "WARNING: [down] TX is not enabled on RF chain %u, TX aborted\n", txpkt.rf_chain );
-                json_value_free( root_val );
                 continue;
             }
 
-            /* parse TX power (optional field) */
-            val = json_object_get_value( txpk_obj, "powe" );
-            if( val != NULL )
+            /* TX power (optional field) is requested at the antenna */
+            if( ( txpk_valid & TXPK_FIELD_POWE ) != 0 )
             {
-                txpkt.rf_power = ( int8_t ) json_value_get_number( val ) - antenna_gain;
+                txpkt.rf_power -= antenna_gain;
             }
 
-            /* Parse modulation (mandatory) */
-            str = json_object_get_string( txpk_obj, "modu" );
-            if( str == NULL )
+            /* check modulation (mandatory), only Lora is supported */
+            if( ( txpk.fields & TXPK_FIELD_MODU ) == 0 )
             {
                 ESP_LOGW( TAG_DOWN, "WARNING: [down] no mandatory \"txpk.modu\" object in JSON, TX aborted\n" );
-                json_value_free( root_val );
                 continue;
             }
-            if( strcmp( str, "LORA" ) == 0 )
+            if( ( txpk.invalid & TXPK_FIELD_MODU ) != 0 )
             {
-                /* Lora modulation */
-                txpkt.modulation = MOD_LORA;
+                ESP_LOGW( TAG_DOWN, "WARNING: [down] invalid modulation in \"txpk.modu\", TX aborted\n" );
+                continue;
+            }
 
-                /* Parse Lora spreading-factor and modulation bandwidth (mandatory) */
-                str = json_object_get_string( txpk_obj, "datr" );
-                if( str == NULL )
-                {
-                    ESP_LOGW( TAG_DOWN, "WARNING: [down] no mandatory \"txpk.datr\" object in JSON, TX aborted\n" );
-                    json_value_free( root_val );
-                    continue;
-                }
-                i = sscanf( str, "SF%2hdBW%3hd", &x0, &x1 );
-                if( i != 2 )
-                {
-                    ESP_LOGW( TAG_DOWN, "WARNING: [down] format error in \"txpk.datr\", TX aborted\n" );
-                    json_value_free( root_val );
-                    continue;
-                }
-                switch( x0 )
-                {
-                case 5:
-                    txpkt.datarate = DR_LORA_SF5;
-                    break;
-                case 6:
-                    txpkt.datarate = DR_LORA_SF6;
-                    break;
-                case 7:
-                    txpkt.datarate = DR_LORA_SF7;
-                    break;
-                case 8:
-                    txpkt.datarate = DR_LORA_SF8;
-                    break;
-                case 9:
-                    txpkt.datarate = DR_LORA_SF9;
-                    break;
-                case 10:
-                    txpkt.datarate = DR_LORA_SF10;
-                    break;
-                case 11:
-                    txpkt.datarate = DR_LORA_SF11;
-                    break;
-                case 12:
-                    txpkt.datarate = DR_LORA_SF12;
-                    break;
-                default:
-                    ESP_LOGW( TAG_DOWN, "WARNING: [down] format error in \"txpk.datr\", invalid SF, TX aborted\n" );
-                    json_value_free( root_val );
-                    continue;
-                }
-                switch( x1 )
-                {
-                case 125:
-                    txpkt.bandwidth = BW_125KHZ;
-                    break;
-                case 250:
-                    txpkt.bandwidth = BW_250KHZ;
-                    break;
-                case 500:
-                    txpkt.bandwidth = BW_500KHZ;
-                    break;
-                default:
-                    ESP_LOGW( TAG_DOWN, "WARNING: [down] format error in \"txpk.datr\", invalid BW, TX aborted\n" );
-                    json_value_free( root_val );
-                    continue;
-                }
+            /* check Lora spreading-factor and modulation bandwidth (mandatory) */
+            if( ( txpk.fields & TXPK_FIELD_DATR ) == 0 )
+            {
+                ESP_LOGW( TAG_DOWN, "WARNING: [down] no mandatory \"txpk.datr\" object in JSON, TX aborted\n" );
+                continue;
+            }
+            if( ( txpk.invalid & TXPK_FIELD_DATR ) != 0 )
+            {
+                ESP_LOGW( TAG_DOWN, "WARNING: [down] format error in \"txpk.datr\", invalid SF or BW, TX aborted\n" );
+                continue;
+            }
 
-                /* Parse ECC coding rate (optional field) */
-                str = json_object_get_string( txpk_obj, "codr" );
-                if( str == NULL )
-                {
-                    ESP_LOGW( TAG_DOWN, "WARNING: [down] no mandatory \"txpk.codr\" object in json, TX aborted\n" );
-                    json_value_free( root_val );
-                    continue;
-                }
-                if( strcmp( str, "4/5" ) == 0 )
-                    txpkt.coderate = CR_LORA_4_5;
-                else if( strcmp( str, "4/6" ) == 0 )
-                    txpkt.coderate = CR_LORA_4_6;
-                else if( strcmp( str, "2/3" ) == 0 )
-                    txpkt.coderate = CR_LORA_4_6;
-                else if( strcmp( str, "4/7" ) == 0 )
-                    txpkt.coderate = CR_LORA_4_7;
-                else if( strcmp( str, "4/8" ) == 0 )
-                    txpkt.coderate = CR_LORA_4_8;
-                else if( strcmp( str, "1/2" ) == 0 )
-                    txpkt.coderate = CR_LORA_4_8;
-                else
-                {
-                    ESP_LOGW( TAG_DOWN, "WARNING: [down] format error in \"txpk.codr\", TX aborted\n" );
-                    json_value_free( root_val );
-                    continue;
-                }
+            /* check ECC coding rate (mandatory) */
+            if( ( txpk.fields & TXPK_FIELD_CODR ) == 0 )
+            {
+                ESP_LOGW( TAG_DOWN, "WARNING: [down] no mandatory \"txpk.codr\" object in json, TX aborted\n" );
+                continue;
+            }
+            if( ( txpk.invalid & TXPK_FIELD_CODR ) != 0 )
+            {
+                ESP_LOGW( TAG_DOWN, "WARNING: [down] format error in \"txpk.codr\", TX aborted\n" );
+                continue;
+            }
 
-                /* Parse signal polarity switch (optional field) */
-                val = json_object_get_value( txpk_obj, "ipol" );
-                if( val != NULL )
-                {
-                    txpkt.invert_pol = ( bool ) json_value_get_boolean( val );
-                }
+            /* "ipol" signal polarity switch is optional, already decoded */
 
-                /* parse Lora preamble length (optional field, optimum min value enforced) */
-                val = json_object_get_value( txpk_obj, "prea" );
-                if( val != NULL )
-                {
-                    i = ( int ) json_value_get_number( val );
-                    if( i >= MIN_LORA_PREAMBLE )
-                    {
-                        txpkt.preamble = ( uint16_t ) i;
-                    }
-                    else
-                    {
-                        txpkt.preamble = ( uint16_t ) MIN_LORA_PREAMBLE;
-                    }
-                }
-                else
-                {
-                    txpkt.preamble = ( uint16_t ) STD_LORA_PREAMBLE;
-                }
+            /* Lora preamble length (optional field, optimum min value enforced) */
+            if( ( txpk_valid & TXPK_FIELD_PREA ) == 0 )
+            {
+                txpkt.preamble = ( uint16_t ) STD_LORA_PREAMBLE;
             }
-            else
+            else if( txpkt.preamble < MIN_LORA_PREAMBLE )
             {
-                ESP_LOGW( TAG_DOWN, "WARNING: [down] invalid modulation in \"txpk.modu\", TX aborted\n" );
-                json_value_free( root_val );
-                continue;
+                txpkt.preamble = ( uint16_t ) MIN_LORA_PREAMBLE;
             }
 
-            /* Parse payload length (mandatory) */
-            val = json_object_get_value( txpk_obj, "size" );
-            if( val == NULL )
+            /* check payload length (mandatory) */
+            if( ( txpk.fields & TXPK_FIELD_SIZE ) == 0 )
             {
                 ESP_LOGW( TAG_DOWN, "WARNING: [down] no mandatory \"txpk.size\" object in JSON, TX aborted\n" );
-                json_value_free( root_val );
                 continue;
             }
-            txpkt.size = ( uint16_t ) json_value_get_number( val );
+            if( ( txpk.invalid & TXPK_FIELD_SIZE ) != 0 )
+            {
+                ESP_LOGW( TAG_DOWN, "WARNING: [down] format error in \"txpk.size\", TX aborted\n" );
+                continue;
+            }
 
-            /* Parse payload data (mandatory) */
-            str = json_object_get_string( txpk_obj, "data" );
-            if( str == NULL )
+            /* check payload data (mandatory), already base64 decoded */
+            if( ( txpk.fields & TXPK_FIELD_DATA ) == 0 )
             {
                 ESP_LOGW( TAG_DOWN, "WARNING: [down] no mandatory \"txpk.data\" object in JSON, TX aborted\n" );
-                json_value_free( root_val );
                 continue;
             }
-            i = b64_to_bin( str, strlen( str ), txpkt.payload, sizeof txpkt.payload );
-            if( i != txpkt.size )
+            if( ( txpk.invalid & TXPK_FIELD_DATA ) != 0 )
+            {
+                ESP_LOGW( TAG_DOWN, "WARNING: [down] format error in \"txpk.data\", TX aborted\n" );
+                continue;
+            }
+            if( txpk.data_size != txpkt.size )
             {
                 ESP_LOGW( TAG_DOWN,
                           "WARNING: [down] mismatch between .size and .data size once converter to binary\n" );
             }
 
-            /* free the JSON parse tree from memory */
-            json_value_free( root_val );
-
             /* select TX mode */
             if( sent_immediate )
             {
@@ -1584,6 +1565,12 @@ void thread_down( void )
                 {
                     /* In case of a warning having been raised before, we notify it */
                     jit_result = warning_result;
+
+                    /* the new packet may be due before the one the JiT thread sleeps for */
+                    if( jit_task != NULL )
+                    {
+                        xTaskNotifyGive( jit_task );
+                    }
                 }
                 pthread_mutex_lock( &mx_meas_dw );
                 meas_nb_tx_requested += 1;
@@ -1635,12 +1622,29 @@ void thread_jit( void )
     enum jit_error_e    jit_result;
     enum jit_pkt_type_e pkt_type;
     uint8_t             tx_status;
+    uint32_t            delay_us;
+    uint32_t            wait_us;
     int                 i;
 
+    jit_task = xTaskGetCurrentTaskHandle( );
+
     while( !exit_sig )
     {
-        // ESP_LOGI(TAG_JIT, "JIT");
-        vTaskDelay( 10 / portTICK_PERIOD_MS );
+        /* sleep until the earliest queued packet must be programmed, or a new one is enqueued */
+        wait_us = JIT_WAIT_MAX_MS * 1000;
+        lgw_get_instcnt( &current_concentrator_time );
+        for( i = 0; i < LGW_RF_CHAIN_NB; i++ )
+        {
+            if( ( jit_peek_delay( &jit_queue[i], current_concentrator_time, &delay_us ) == JIT_ERROR_OK ) &&
+                ( delay_us < wait_us ) )
+            {
+                wait_us = delay_us;
+            }
+        }
+        if( wait_us > 0 )
+        {
+            ulTaskNotifyTake( pdTRUE, pdMS_TO_TICKS( ( wait_us + 999 ) / 1000 ) );
+        }
 
         for( i = 0; i < LGW_RF_CHAIN_NB; i++ )
         {
@@ -1787,6 +1791,13 @@ void thread_pktfwd( void )
     uint32_t cp_nb_tx_rejected_too_late         = 0;
     uint32_t cp_nb_tx_rejected_too_early        = 0;
 
+    /* scan mode counters are cumulative, keep the previous ones to report the last interval */
+    struct lgw_scan_stat_s scan_stat[LGW_SCAN_CHAN_NB];
+    struct lgw_scan_stat_s scan_stat_prev[LGW_SCAN_CHAN_NB];
+    int                    nb_scan_chan;
+    uint32_t               nb_cad;
+    uint32_t               nb_detect;
+
     /* statistics variable */
     time_t t;
     char   stat_timestamp[24];
@@ -1897,6 +1908,8 @@ void thread_pktfwd( void )
     {
         ESP_LOGI( TAG_PKT_FWD, "INFO: [main] LoRaHub started, packet can now be received" );
         lorahub_log_display(LORAHUB_LOG_LEVEL_INFO, "INFO: [main] LoRaHub started, packet can now be received" );
+        /* lgw_start() zeroes the scan counters, so must the reference of the first interval */
+        memset( scan_stat_prev, 0, sizeof( scan_stat_prev ) );
     }
     else
     {
@@ -2052,6 +2065,22 @@ void thread_pktfwd( void )
                     100.0 * cp_nb_tx_rejected_too_early / cp_nb_tx_requested, cp_nb_tx_requested,
                     cp_nb_tx_rejected_too_early );
         }
+        nb_scan_chan = lgw_scan_get_stats( scan_stat, LGW_SCAN_CHAN_NB );
+        if( nb_scan_chan > 0 )
+        {
+            printf( "### [SCAN] ###\n" );
+            for( i = 0; i < nb_scan_chan; i++ )
+            {
+                nb_cad    = scan_stat[i].nb_cad - scan_stat_prev[i].nb_cad;
+                nb_detect = scan_stat[i].nb_detect - scan_stat_prev[i].nb_detect;
+                printf( "# %.1fkHz: CAD: %lu, detected: %lu (%.2f%%), CRC_OK: %lu, CRC_FAIL: %lu\n",
+                        scan_stat[i].freq_hz / 1e3, nb_cad, nb_detect,
+                        ( nb_cad > 0 ) ? 100.0 * nb_detect / nb_cad : 0.0,
+                        scan_stat[i].nb_rx_ok - scan_stat_prev[i].nb_rx_ok,
+                        scan_stat[i].nb_rx_bad - scan_stat_prev[i].nb_rx_bad );
+            }
+            memcpy( scan_stat_prev, scan_stat, nb_scan_chan * sizeof( struct lgw_scan_stat_s ) );
+        }
         printf( "### [JIT] ###\n" );
         jit_print_queue( &jit_queue[0], false, DEBUG_LOG );
         temperature = 0;
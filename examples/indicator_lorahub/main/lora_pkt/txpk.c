@@ -0,0 +1,770 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+  (C)2019 Semtech
+
+Description:
+    Streaming decoder for the "txpk" object of a PULL_RESP datagram
+
+    The JSON payload is walked once, without building a parse tree: known
+    "txpk" fields are converted straight into a struct lgw_pkt_tx_s, the
+    base64 "data" string is decoded into the payload buffer as it is scanned,
+    and anything else is skipped.
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include <stdint.h>  /* C99 types */
+#include <stdbool.h> /* bool type */
+#include <stdlib.h>  /* strtod */
+#include <string.h>  /* memset, memcpy, memcmp, strchr */
+#include <math.h>    /* isfinite, fabs, lround */
+#include <ctype.h>   /* isxdigit */
+
+#include "txpk.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE MACROS ------------------------------------------------------- */
+
+#define TXPK_KEY( a, b, c, d ) \
+    ( ( ( uint32_t ) ( a ) << 24 ) | ( ( uint32_t ) ( b ) << 16 ) | ( ( uint32_t ) ( c ) << 8 ) | ( uint32_t ) ( d ) )
+
+#define TXPK_IS_WS( c ) ( ( c ) == ' ' || ( c ) == '\t' || ( c ) == '\n' || ( c ) == '\r' )
+#define TXPK_IS_DIGIT( c ) ( ( c ) >= '0' && ( c ) <= '9' )
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define TXPK_NUMBER_LEN_MAX 32 /* longest number token accepted */
+#define TXPK_INT_DIGITS_MAX 18 /* integer part digits that fit in int64_t */
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+struct txpk_number_s
+{
+    int64_t  int_part; /* integer part, truncated toward zero */
+    uint32_t micro;    /* first 6 fraction digits of the absolute value, Hz when the value is in MHz */
+    bool     negative;
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static const char* txpk_skip_ws( const char* p, const char* end )
+{
+    while( ( p < end ) && TXPK_IS_WS( *p ) )
+    {
+        p++;
+    }
+    return p;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* p points to the opening quote, returns a pointer past the closing quote */
+static const char* txpk_string( const char* p, const char* end, const char** str, int* str_len, bool* escaped )
+{
+    const char* start = ++p;
+
+    *escaped = false;
+    while( p < end )
+    {
+        if( *p == '"' )
+        {
+            *str     = start;
+            *str_len = ( int ) ( p - start );
+            return p + 1;
+        }
+        if( ( uint8_t ) *p < 0x20 )
+        {
+            return NULL;
+        }
+        if( *p == '\\' )
+        {
+            *escaped = true;
+            if( ( ++p >= end ) || ( strchr( "\"\\/bfnrtu", *p ) == NULL ) || ( *p == '\0' ) )
+            {
+                return NULL;
+            }
+            if( *p == 'u' )
+            {
+                if( ( end - p <= 4 ) || !isxdigit( ( uint8_t ) p[1] ) || !isxdigit( ( uint8_t ) p[2] ) ||
+                    !isxdigit( ( uint8_t ) p[3] ) || !isxdigit( ( uint8_t ) p[4] ) )
+                {
+                    return NULL;
+                }
+                p += 4;
+            }
+        }
+        p++;
+    }
+    return NULL;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* p points to a number, true, false or null, returns a pointer past it if it is well formed */
+static const char* txpk_skip_scalar( const char* p, const char* end )
+{
+    const char* start;
+
+    if( ( end - p >= 4 ) && ( ( memcmp( p, "true", 4 ) == 0 ) || ( memcmp( p, "null", 4 ) == 0 ) ) )
+    {
+        return p + 4;
+    }
+    if( ( end - p >= 5 ) && ( memcmp( p, "false", 5 ) == 0 ) )
+    {
+        return p + 5;
+    }
+
+    /* -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? */
+    if( ( p < end ) && ( *p == '-' ) )
+    {
+        p++;
+    }
+    if( ( p < end ) && ( *p == '0' ) )
+    {
+        p++;
+    }
+    else
+    {
+        for( start = p; ( p < end ) && TXPK_IS_DIGIT( *p ); p++ )
+            ;
+        if( p == start )
+        {
+            return NULL;
+        }
+    }
+    if( ( p < end ) && ( *p == '.' ) )
+    {
+        for( start = ++p; ( p < end ) && TXPK_IS_DIGIT( *p ); p++ )
+            ;
+        if( p == start )
+        {
+            return NULL;
+        }
+    }
+    if( ( p < end ) && ( ( *p == 'e' ) || ( *p == 'E' ) ) )
+    {
+        p++;
+        if( ( p < end ) && ( ( *p == '+' ) || ( *p == '-' ) ) )
+        {
+            p++;
+        }
+        for( start = p; ( p < end ) && TXPK_IS_DIGIT( *p ); p++ )
+            ;
+        if( p == start )
+        {
+            return NULL;
+        }
+    }
+    return p;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* skip any JSON value, nested objects and arrays included, without recursion */
+static const char* txpk_skip_value( const char* p, const char* end )
+{
+    const char* str;
+    int         str_len;
+    bool        escaped;
+    int         depth = 0;
+
+    do
+    {
+        p = txpk_skip_ws( p, end );
+        if( p >= end )
+        {
+            return NULL;
+        }
+        switch( *p )
+        {
+        case '"':
+            p = txpk_string( p, end, &str, &str_len, &escaped );
+            break;
+        case '{':
+        case '[':
+            depth++;
+            p++;
+            break;
+        case '}':
+        case ']':
+            if( depth == 0 )
+            {
+                return NULL;
+            }
+            depth--;
+            p++;
+            break;
+        case ',':
+        case ':':
+            p = ( depth > 0 ) ? p + 1 : NULL;
+            break;
+        default:
+            p = txpk_skip_scalar( p, end );
+            break;
+        }
+    } while( ( p != NULL ) && ( depth > 0 ) );
+
+    return p;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* decode a well formed number token, exactly for plain decimals, through strtod when it has an exponent */
+static bool txpk_number( const char* tok, int tok_len, struct txpk_number_s* num )
+{
+    const char* p   = tok;
+    const char* end = tok + tok_len;
+    uint32_t    scale;
+    int         n;
+
+    memset( num, 0, sizeof *num );
+
+    if( *p == '-' )
+    {
+        num->negative = true;
+        p++;
+    }
+    for( n = 0; ( p < end ) && TXPK_IS_DIGIT( *p ); p++, n++ )
+    {
+        if( n == TXPK_INT_DIGITS_MAX )
+        {
+            return false;
+        }
+        num->int_part = ( num->int_part * 10 ) + ( *p - '0' );
+    }
+    if( ( p < end ) && ( *p == '.' ) )
+    {
+        for( p++, scale = 100000; ( p < end ) && TXPK_IS_DIGIT( *p ); p++, scale /= 10 )
+        {
+            num->micro += ( uint32_t ) ( *p - '0' ) * scale;
+        }
+    }
+    if( p < end )
+    {
+        /* exponent */
+        char   buff[TXPK_NUMBER_LEN_MAX + 1];
+        double d;
+
+        if( tok_len > TXPK_NUMBER_LEN_MAX )
+        {
+            return false;
+        }
+        memcpy( buff, tok, tok_len );
+        buff[tok_len] = '\0';
+        d             = strtod( buff, NULL );
+        if( !isfinite( d ) || ( fabs( d ) >= 1e18 ) )
+        {
+            return false;
+        }
+        num->negative = ( d < 0 );
+        num->int_part = ( int64_t ) fabs( d );
+        num->micro    = ( uint32_t ) lround( ( fabs( d ) - ( double ) num->int_part ) * 1e6 );
+        if( num->micro >= 1000000 )
+        {
+            num->int_part += 1;
+            num->micro -= 1000000;
+        }
+    }
+    if( num->negative )
+    {
+        num->int_part = -num->int_part;
+    }
+    return true;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static int64_t txpk_clamp( int64_t value, int64_t min, int64_t max )
+{
+    return ( value < min ) ? min : ( ( value > max ) ? max : value );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static int txpk_b64_code( char c )
+{
+    if( ( c >= 'A' ) && ( c <= 'Z' ) )
+    {
+        return c - 'A';
+    }
+    if( ( c >= 'a' ) && ( c <= 'z' ) )
+    {
+        return c - 'a' + 26;
+    }
+    if( ( c >= '0' ) && ( c <= '9' ) )
+    {
+        return c - '0' + 52;
+    }
+    if( c == '+' )
+    {
+        return 62;
+    }
+    if( c == '/' )
+    {
+        return 63;
+    }
+    return -1;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* p points to the opening quote of a base64 string, decoded into out while scanning for the closing quote */
+static const char* txpk_data( const char* p, const char* end, uint8_t* out, int max_len, int* size )
+{
+    uint32_t b     = 0;
+    int      chars = 0; /* characters accumulated in b */
+    int      pad   = 0;
+    int      n     = 0;
+    bool     error = false;
+    int      code;
+    char     c;
+
+    for( p++; ( p < end ) && ( *p != '"' ); p++ )
+    {
+        c = *p;
+        if( ( uint8_t ) c < 0x20 )
+        {
+            return NULL;
+        }
+        if( c == '\\' )
+        {
+            /* some JSON encoders escape the slash, any other escape is not base64 */
+            if( ( ++p >= end ) || ( strchr( "\"\\/bfnrtu", *p ) == NULL ) || ( *p == '\0' ) )
+            {
+                return NULL;
+            }
+            if( *p != '/' )
+            {
+                error = true;
+                continue;
+            }
+            c = '/';
+        }
+        if( c == '=' )
+        {
+            pad++;
+            continue;
+        }
+        code = txpk_b64_code( c );
+        if( ( code < 0 ) || ( pad > 0 ) )
+        {
+            error = true;
+            continue;
+        }
+        b = ( b << 6 ) | ( uint32_t ) code;
+        if( ++chars == 4 )
+        {
+            if( !error && ( n + 3 <= max_len ) )
+            {
+                out[n++] = ( b >> 16 ) & 0xFF;
+                out[n++] = ( b >> 8 ) & 0xFF;
+                out[n++] = b & 0xFF;
+            }
+            else
+            {
+                error = true;
+            }
+            b     = 0;
+            chars = 0;
+        }
+    }
+    if( p >= end )
+    {
+        return NULL;
+    }
+
+    /* last partial block, padding is optional but must complete it when present */
+    if( error || ( chars == 1 ) || ( pad > 2 ) || ( ( pad > 0 ) && ( ( ( chars + pad ) & 3 ) != 0 ) ) ||
+        ( n + chars - ( chars > 0 ) > max_len ) )
+    {
+        error = true;
+    }
+    else if( chars == 2 )
+    {
+        out[n++] = ( b >> 4 ) & 0xFF;
+    }
+    else if( chars == 3 )
+    {
+        out[n++] = ( b >> 10 ) & 0xFF;
+        out[n++] = ( b >> 2 ) & 0xFF;
+    }
+
+    *size = error ? -1 : n;
+    return p + 1;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static bool txpk_datr( const char* str, int len, struct lgw_pkt_tx_s* pkt )
+{
+    const char* end = str + len;
+    int         sf  = 0;
+    int         bw  = 0;
+    int         n;
+
+    /* same format as sscanf "SF%2hdBW%3hd", trailing characters ignored */
+    if( ( len < 2 ) || ( str[0] != 'S' ) || ( str[1] != 'F' ) )
+    {
+        return false;
+    }
+    for( str += 2, n = 0; ( str < end ) && ( n < 2 ) && TXPK_IS_DIGIT( *str ); str++, n++ )
+    {
+        sf = ( sf * 10 ) + ( *str - '0' );
+    }
+    if( ( n == 0 ) || ( end - str < 2 ) || ( str[0] != 'B' ) || ( str[1] != 'W' ) )
+    {
+        return false;
+    }
+    for( str += 2, n = 0; ( str < end ) && ( n < 3 ) && TXPK_IS_DIGIT( *str ); str++, n++ )
+    {
+        bw = ( bw * 10 ) + ( *str - '0' );
+    }
+    if( n == 0 )
+    {
+        return false;
+    }
+
+    if( ( sf < 5 ) || ( sf > 12 ) )
+    {
+        return false;
+    }
+    pkt->datarate = DR_LORA_SF5 + ( sf - 5 );
+    switch( bw )
+    {
+    case 125:
+        pkt->bandwidth = BW_125KHZ;
+        break;
+    case 250:
+        pkt->bandwidth = BW_250KHZ;
+        break;
+    case 500:
+        pkt->bandwidth = BW_500KHZ;
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static bool txpk_codr( const char* str, int len, struct lgw_pkt_tx_s* pkt )
+{
+    if( len != 3 )
+    {
+        return false;
+    }
+    if( ( memcmp( str, "4/5", 3 ) == 0 ) )
+        pkt->coderate = CR_LORA_4_5;
+    else if( ( memcmp( str, "4/6", 3 ) == 0 ) || ( memcmp( str, "2/3", 3 ) == 0 ) )
+        pkt->coderate = CR_LORA_4_6;
+    else if( memcmp( str, "4/7", 3 ) == 0 )
+        pkt->coderate = CR_LORA_4_7;
+    else if( ( memcmp( str, "4/8", 3 ) == 0 ) || ( memcmp( str, "1/2", 3 ) == 0 ) )
+        pkt->coderate = CR_LORA_4_8;
+    else
+        return false;
+    return true;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* decode the value of a known "txpk" field, p points to the first character of the value */
+static const char* txpk_field( uint32_t key, const char* p, const char* end, struct lgw_pkt_tx_s* pkt,
+                               struct txpk_s* txpk )
+{
+    struct txpk_number_s num;
+    const char*          str;
+    const char*          next;
+    int                  str_len;
+    bool                 escaped;
+    uint32_t             field;
+    bool                 valid = false;
+
+    switch( key )
+    {
+    case TXPK_KEY( 'i', 'm', 'm', 'e' ):
+        field = TXPK_FIELD_IMME;
+        break;
+    case TXPK_KEY( 't', 'm', 's', 't' ):
+        field = TXPK_FIELD_TMST;
+        break;
+    case TXPK_KEY( 'n', 'c', 'r', 'c' ):
+        field = TXPK_FIELD_NCRC;
+        break;
+    case TXPK_KEY( 'n', 'h', 'd', 'r' ):
+        field = TXPK_FIELD_NHDR;
+        break;
+    case TXPK_KEY( 'f', 'r', 'e', 'q' ):
+        field = TXPK_FIELD_FREQ;
+        break;
+    case TXPK_KEY( 'r', 'f', 'c', 'h' ):
+        field = TXPK_FIELD_RFCH;
+        break;
+    case TXPK_KEY( 'p', 'o', 'w', 'e' ):
+        field = TXPK_FIELD_POWE;
+        break;
+    case TXPK_KEY( 'm', 'o', 'd', 'u' ):
+        field = TXPK_FIELD_MODU;
+        break;
+    case TXPK_KEY( 'd', 'a', 't', 'r' ):
+        field = TXPK_FIELD_DATR;
+        break;
+    case TXPK_KEY( 'c', 'o', 'd', 'r' ):
+        field = TXPK_FIELD_CODR;
+        break;
+    case TXPK_KEY( 'i', 'p', 'o', 'l' ):
+        field = TXPK_FIELD_IPOL;
+        break;
+    case TXPK_KEY( 'p', 'r', 'e', 'a' ):
+        field = TXPK_FIELD_PREA;
+        break;
+    case TXPK_KEY( 's', 'i', 'z', 'e' ):
+        field = TXPK_FIELD_SIZE;
+        break;
+    case TXPK_KEY( 'd', 'a', 't', 'a' ):
+        field = TXPK_FIELD_DATA;
+        break;
+    default:
+        return txpk_skip_value( p, end );
+    }
+    txpk->fields |= field;
+    txpk->invalid &= ~field; /* the last occurrence of a field wins */
+
+    if( *p == '"' )
+    {
+        if( field == TXPK_FIELD_DATA )
+        {
+            next  = txpk_data( p, end, pkt->payload, sizeof pkt->payload, &txpk->data_size );
+            valid = ( txpk->data_size >= 0 );
+        }
+        else
+        {
+            next = txpk_string( p, end, &str, &str_len, &escaped );
+            if( ( next != NULL ) && !escaped )
+            {
+                switch( field )
+                {
+                case TXPK_FIELD_MODU:
+                    valid = ( str_len == 4 ) && ( memcmp( str, "LORA", 4 ) == 0 );
+                    if( valid )
+                    {
+                        pkt->modulation = MOD_LORA;
+                    }
+                    break;
+                case TXPK_FIELD_DATR:
+                    valid = txpk_datr( str, str_len, pkt );
+                    break;
+                case TXPK_FIELD_CODR:
+                    valid = txpk_codr( str, str_len, pkt );
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+    }
+    else if( ( *p == '-' ) || TXPK_IS_DIGIT( *p ) )
+    {
+        next = txpk_skip_scalar( p, end );
+        if( next == NULL )
+        {
+            return NULL;
+        }
+        valid = txpk_number( p, next - p, &num );
+        if( valid )
+        {
+            switch( field )
+            {
+            case TXPK_FIELD_TMST:
+                pkt->count_us = ( uint32_t ) num.int_part;
+                break;
+            case TXPK_FIELD_FREQ:
+                valid = !num.negative && ( num.int_part <= ( UINT32_MAX / 1000000 ) );
+                if( valid )
+                {
+                    uint64_t freq_hz = ( ( uint64_t ) num.int_part * 1000000 ) + num.micro;
+                    valid            = ( freq_hz <= UINT32_MAX );
+                    pkt->freq_hz     = ( uint32_t ) freq_hz;
+                }
+                break;
+            case TXPK_FIELD_RFCH:
+                valid         = ( num.int_part >= 0 ) && ( num.int_part <= UINT8_MAX );
+                pkt->rf_chain = ( uint8_t ) num.int_part;
+                break;
+            case TXPK_FIELD_POWE:
+                pkt->rf_power = ( int8_t ) txpk_clamp( num.int_part, INT8_MIN, INT8_MAX );
+                break;
+            case TXPK_FIELD_PREA:
+                pkt->preamble = ( uint16_t ) txpk_clamp( num.int_part, 0, UINT16_MAX );
+                break;
+            case TXPK_FIELD_SIZE:
+                pkt->size = ( uint16_t ) txpk_clamp( num.int_part, 0, UINT16_MAX );
+                break;
+            default:
+                valid = false;
+                break;
+            }
+        }
+    }
+    else
+    {
+        next = txpk_skip_value( p, end );
+        if( ( next != NULL ) && ( ( next - p == 4 && memcmp( p, "true", 4 ) == 0 ) ||
+                                  ( next - p == 5 && memcmp( p, "false", 5 ) == 0 ) ) )
+        {
+            bool flag = ( *p == 't' );
+
+            valid = true;
+            switch( field )
+            {
+            case TXPK_FIELD_IMME:
+                txpk->imme = flag;
+                break;
+            case TXPK_FIELD_NCRC:
+                pkt->no_crc = flag;
+                break;
+            case TXPK_FIELD_NHDR:
+                pkt->no_header = flag;
+                break;
+            case TXPK_FIELD_IPOL:
+                pkt->invert_pol = flag;
+                break;
+            default:
+                valid = false;
+                break;
+            }
+        }
+    }
+
+    if( !valid )
+    {
+        txpk->invalid |= field;
+    }
+    return next;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* walk the members of an object, p points to the opening brace, returns a pointer past the closing brace */
+static const char* txpk_object( const char* p, const char* end, struct lgw_pkt_tx_s* pkt, struct txpk_s* txpk,
+                                bool* found )
+{
+    const char* key;
+    int         key_len;
+    bool        escaped;
+
+    p = txpk_skip_ws( p + 1, end );
+    if( ( p < end ) && ( *p == '}' ) )
+    {
+        return p + 1;
+    }
+    while( p < end )
+    {
+        if( *p != '"' )
+        {
+            return NULL;
+        }
+        p = txpk_string( p, end, &key, &key_len, &escaped );
+        if( p == NULL )
+        {
+            return NULL;
+        }
+        p = txpk_skip_ws( p, end );
+        if( ( p >= end ) || ( *p != ':' ) )
+        {
+            return NULL;
+        }
+        p = txpk_skip_ws( p + 1, end );
+        if( p >= end )
+        {
+            return NULL;
+        }
+
+        if( found == NULL )
+        {
+            /* members of "txpk" */
+            if( ( key_len == 4 ) && !escaped )
+            {
+                p = txpk_field( TXPK_KEY( key[0], key[1], key[2], key[3] ), p, end, pkt, txpk );
+            }
+            else
+            {
+                p = txpk_skip_value( p, end );
+            }
+        }
+        else if( ( key_len == 4 ) && ( memcmp( key, "txpk", 4 ) == 0 ) && ( *p == '{' ) && !*found )
+        {
+            *found = true;
+            p      = txpk_object( p, end, pkt, txpk, NULL );
+        }
+        else
+        {
+            p = txpk_skip_value( p, end );
+        }
+        if( p == NULL )
+        {
+            return NULL;
+        }
+
+        p = txpk_skip_ws( p, end );
+        if( p >= end )
+        {
+            return NULL;
+        }
+        if( *p == '}' )
+        {
+            return p + 1;
+        }
+        if( *p != ',' )
+        {
+            return NULL;
+        }
+        p = txpk_skip_ws( p + 1, end );
+    }
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+int txpk_parse( const char* json, int len, struct lgw_pkt_tx_s* pkt, struct txpk_s* txpk )
+{
+    const char* end   = json + len;
+    const char* p     = json;
+    bool        found = false;
+
+    memset( pkt, 0, sizeof *pkt );
+    memset( txpk, 0, sizeof *txpk );
+    txpk->data_size = -1;
+
+    p = txpk_skip_ws( p, end );
+    if( ( p >= end ) || ( *p != '{' ) )
+    {
+        return TXPK_PARSE_ERROR;
+    }
+    p = txpk_object( p, end, pkt, txpk, &found );
+    if( p == NULL )
+    {
+        return TXPK_PARSE_ERROR;
+    }
+    p = txpk_skip_ws( p, end );
+    if( ( p < end ) && ( *p != '\0' ) )
+    {
+        return TXPK_PARSE_ERROR;
+    }
+
+    return found ? TXPK_PARSE_OK : TXPK_PARSE_NO_TXPK;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
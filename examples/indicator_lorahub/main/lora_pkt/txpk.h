@@ -0,0 +1,79 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+  (C)2019 Semtech
+
+Description:
+    Streaming decoder for the "txpk" object of a PULL_RESP datagram
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+#ifndef _LORA_PKTFWD_TXPK_H
+#define _LORA_PKTFWD_TXPK_H
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include <stdint.h>  /* C99 types */
+#include <stdbool.h> /* bool type */
+
+#include "lorahub_hal.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC CONSTANTS ----------------------------------------------------- */
+
+#define TXPK_PARSE_OK 0       /* JSON is well formed and contains a "txpk" object */
+#define TXPK_PARSE_ERROR -1   /* JSON is malformed */
+#define TXPK_PARSE_NO_TXPK -2 /* JSON is well formed but has no "txpk" object */
+
+/* Bits of txpk_s.fields / txpk_s.invalid, one per known "txpk" field */
+#define TXPK_FIELD_IMME ( 1 << 0 )
+#define TXPK_FIELD_TMST ( 1 << 1 )
+#define TXPK_FIELD_NCRC ( 1 << 2 )
+#define TXPK_FIELD_NHDR ( 1 << 3 )
+#define TXPK_FIELD_FREQ ( 1 << 4 )
+#define TXPK_FIELD_RFCH ( 1 << 5 )
+#define TXPK_FIELD_POWE ( 1 << 6 )
+#define TXPK_FIELD_MODU ( 1 << 7 )
+#define TXPK_FIELD_DATR ( 1 << 8 )
+#define TXPK_FIELD_CODR ( 1 << 9 )
+#define TXPK_FIELD_IPOL ( 1 << 10 )
+#define TXPK_FIELD_PREA ( 1 << 11 )
+#define TXPK_FIELD_SIZE ( 1 << 12 )
+#define TXPK_FIELD_DATA ( 1 << 13 )
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC TYPES --------------------------------------------------------- */
+
+struct txpk_s
+{
+    uint32_t fields;    /* TXPK_FIELD_x found in the "txpk" object */
+    uint32_t invalid;   /* TXPK_FIELD_x found but whose value could not be decoded */
+    bool     imme;      /* "imme" is the JSON literal true */
+    int      data_size; /* number of bytes decoded from "data", -1 if invalid or too large */
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS PROTOTYPES ------------------------------------------ */
+
+/**
+@brief Decode the "txpk" object of a PULL_RESP JSON payload in a single pass
+@param json pointer to the JSON payload, does not need to be null terminated
+@param len length of the JSON payload in bytes
+@param pkt [out] zeroed, then filled with the decoded fields ("data" is base64 decoded into pkt->payload)
+@param txpk [out] zeroed, then filled with the fields found and the ones that could not be decoded
+@return TXPK_PARSE_OK, TXPK_PARSE_ERROR or TXPK_PARSE_NO_TXPK
+
+No memory is allocated and the JSON payload is not modified. Fields are written as sent by the server:
+"powe" is the requested power without antenna gain compensation, "prea" is not clamped.
+Unknown fields and objects are skipped, the last occurrence of a duplicated field wins.
+*/
+int txpk_parse( const char* json, int len, struct lgw_pkt_tx_s* pkt, struct txpk_s* txpk );
+
+#endif
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,694 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+  (C)2019 Semtech
+
+Description:
+    Host simulation of the CAD scan coverage, on a simulated clock
+
+    lorahub_hal_rx.c and lorahub_hal_scan.c are compiled into this file and
+    drive a fake ral_t radio. The radio charges every command its SPI time.
+    It models CAD detection in the preamble, the RX lock after a detection,
+    and optionally a TCXO restart whenever it leaves STDBY_RC. Uplinks are
+    Poisson on 8 channels, SF7 45%, SF8 to SF12 the rest. The RX task part of
+    lorahub_hal.c (rx_task, rx_arm, rx_fetch) is mirrored below, because that
+    file needs the real clock; test_scan runs it for real.
+
+    Reported: share of the uplinks of the scan plan received (in-plan), share
+    of all uplinks received, per SF, CADs per second, false alarms, and the
+    delay from the end of a packet to its place in the RX ring.
+
+    Usage: bench_scan [policy=scan|rr|single] [ch=N] [sf=MIN-MAX] [spi=US] [tcxo=US] [rate=PER_S] [dur=S] [seed=N]
+        policy  scan: lgw_scan_next(), rr: round robin over the slots, single: RX on the first channel
+        spi     time of one radio command, about 350 us on the Indicator (NSS and BUSY behind the IO expander)
+        tcxo    TCXO start-up time, paid each time the radio leaves STDBY_RC
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include <stdint.h>  /* C99 types */
+#include <stdbool.h> /* bool type */
+#include <stdio.h>   /* printf */
+#include <stdlib.h>  /* rand, atof */
+#include <string.h>  /* strncmp */
+#include <math.h>    /* log, ceil, INFINITY */
+
+#include "esp_log.h"
+
+/* RX timeouts are part of the scan, and driver/gpio.h comes with lorahub_hal_rx.c */
+#undef ESP_LOGW
+#define ESP_LOGW( tag, fmt, ... )
+
+#include "lorahub_hal_rx.c"
+#include "lorahub_hal_scan.c"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define NB_CHAN_TRAFFIC 8    /* channels the uplinks are spread over */
+#define CHAN_FREQ_HZ 867100000
+#define CHAN_SPACING_HZ 200000
+#define PAYLOAD_SIZE 33      /* PHY payload bytes */
+#define WAKE_US 30           /* DIO interrupt to RX task */
+#define CAD_PROC_SYMB 0.5    /* CAD processing after the listen window, symbols */
+#define LOCK_SYMB 1.0        /* preamble symbols needed after the CAD for the demodulator to lock */
+#define CAD_PD 0.95          /* CAD detection probability, fully inside the preamble */
+#define CAD_PFA 0.002        /* CAD false alarm probability */
+#define TAIL_US 5000000      /* uplinks ending in the last 5 s are not counted */
+
+static const double sf_mix[13] = { 0, 0, 0, 0, 0, 0, 0, 0.45, 0.12, 0.12, 0.12, 0.09, 0.10 };
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+typedef enum
+{
+    POLICY_SCAN,        /* lgw_scan_next() */
+    POLICY_ROUND_ROBIN, /* every slot in turn */
+    POLICY_SINGLE,      /* no scan, RX on one channel */
+} policy_t;
+
+typedef struct
+{
+    double start_us; /* start of the preamble */
+    double toa_us;
+    int    chan;
+    int    sf;
+    bool   received;
+} uplink_t;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+/* parameters */
+static policy_t policy      = POLICY_SCAN;
+static double   spi_us      = 350;
+static double   tcxo_us     = 0;
+static double   rate_per_s  = 4;
+static double   duration_s  = 2000;
+
+/* simulated clock, us */
+static double now = 0;
+
+/* traffic */
+static uplink_t* uplinks;
+static int       nb_uplinks;
+static int       first_uplink = 0; /* earliest uplink a CAD may still catch */
+
+/* fake radio */
+static int       radio_sf;
+static int       radio_chan;
+static uint32_t  radio_cad_timeout_ms;
+static int       radio_uplink = -1; /* uplink being received, -1 if none */
+static int       radio_detect = -1; /* uplink detected by the CAD, -1 if none */
+static bool      radio_in_rc  = true;
+static double    irq_at       = INFINITY;
+static ral_irq_t irq_next     = RAL_IRQ_NONE;
+static ral_irq_t irq_pending  = RAL_IRQ_NONE;
+static long      nb_cad       = 0;
+static long      nb_false     = 0;
+
+/* HAL */
+static gpio_isr_t dio_handler;
+static bool       scan_enabled;
+static uint32_t   rx_freq_hz;
+static uint32_t   rx_datarate;
+static uint8_t    rx_if_chain;
+static bool       rx_reconfigure = true;
+static uint8_t    rr_next        = 0;
+static long       nb_received    = 0;
+static double     latency_sum_us = 0;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static double symbol_us( int sf )
+{
+    return ( double ) ( 1 << sf ) * 8.0; /* BW125 */
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static double time_on_air_us( int sf, int size )
+{
+    int    de = ( sf >= 11 );
+    double nb_symb =
+        8 + fmax( ceil( ( 8.0 * size - 4 * sf + 28 + 16 ) / ( 4.0 * ( sf - 2 * de ) ) ) * 5, 0 ); /* CR 4/5 */
+
+    return ( 8 + 4.25 + nb_symb ) * symbol_us( sf );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static double random_uniform( void )
+{
+    return ( rand( ) + 0.5 ) / ( ( double ) RAND_MAX + 1.0 );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void generate_uplinks( void )
+{
+    double t   = 1e6;
+    int    max = 1024;
+    double r;
+    double a;
+    int    sf;
+
+    uplinks    = malloc( sizeof( uplink_t ) * max );
+    nb_uplinks = 0;
+    while( t < duration_s * 1e6 )
+    {
+        t += -log( random_uniform( ) ) / rate_per_s * 1e6;
+        r  = random_uniform( );
+        a  = 0;
+        for( sf = 7; sf < 12; sf++ )
+        {
+            a += sf_mix[sf];
+            if( r < a )
+            {
+                break;
+            }
+        }
+        if( nb_uplinks == max )
+        {
+            max *= 2;
+            uplinks = realloc( uplinks, sizeof( uplink_t ) * max );
+        }
+        uplinks[nb_uplinks++] =
+            ( uplink_t ){ .start_us = t, .toa_us = time_on_air_us( sf, PAYLOAD_SIZE ), .chan = rand( ) % NB_CHAN_TRAFFIC, .sf = sf };
+    }
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static int freq_to_chan( uint32_t freq_hz )
+{
+    return ( int ) ( freq_hz - CHAN_FREQ_HZ ) / CHAN_SPACING_HZ;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void radio_command( int nb_cmd )
+{
+    now += nb_cmd * spi_us;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* RX from 'from' to 'until': the first uplink of the channel and SF whose preamble can still be locked on */
+static void radio_listen( double from, double until )
+{
+    double symb_us = symbol_us( radio_sf );
+    int    i;
+
+    for( i = first_uplink; i < nb_uplinks; i++ )
+    {
+        if( ( uplinks[i].chan != radio_chan ) || ( uplinks[i].sf != radio_sf ) ||
+            ( uplinks[i].start_us + ( 8 - LOCK_SYMB ) * symb_us < from ) )
+        {
+            continue;
+        }
+        if( uplinks[i].start_us > until )
+        {
+            break;
+        }
+        radio_uplink = i;
+        irq_at       = uplinks[i].start_us + uplinks[i].toa_us;
+        irq_next     = RAL_IRQ_RX_DONE;
+        return;
+    }
+    radio_uplink = -1;
+    irq_at       = until;
+    irq_next     = RAL_IRQ_RX_TIMEOUT;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void radio_start_cad( void )
+{
+    double symb_us = symbol_us( radio_sf );
+    double start   = now + ( radio_in_rc ? tcxo_us : 0 );
+    int    i;
+
+    nb_cad += 1;
+    radio_in_rc  = true; /* STDBY_RC again after the CAD */
+    irq_at       = start + ( 2 + CAD_PROC_SYMB ) * symb_us;
+    irq_next     = RAL_IRQ_CAD_DONE;
+    radio_detect = -1;
+    radio_uplink = -1;
+    while( ( first_uplink < nb_uplinks ) && ( uplinks[first_uplink].start_us + 30 * symbol_us( 12 ) < now ) )
+    {
+        first_uplink++;
+    }
+    for( i = first_uplink; ( i < nb_uplinks ) && ( uplinks[i].start_us <= start ); i++ )
+    {
+        /* the 2 CAD symbols must fall in the preamble */
+        if( ( uplinks[i].chan == radio_chan ) && ( uplinks[i].sf == radio_sf ) &&
+            ( start + 2 * symb_us <= uplinks[i].start_us + 8 * symb_us ) && ( random_uniform( ) < CAD_PD ) )
+        {
+            irq_next |= RAL_IRQ_CAD_OK;
+            radio_detect = i;
+            return;
+        }
+    }
+    if( random_uniform( ) < CAD_PFA )
+    {
+        irq_next |= RAL_IRQ_CAD_OK;
+        nb_false += 1;
+    }
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* CAD_OK raised at cad_done_us: the radio goes on to RX by itself */
+static void radio_cad_rx( double cad_done_us )
+{
+    double symb_us = symbol_us( radio_sf );
+    int    i       = radio_detect;
+
+    if( ( i >= 0 ) && ( uplinks[i].start_us + 8 * symb_us - cad_done_us >= LOCK_SYMB * symb_us ) )
+    {
+        radio_uplink = i;
+        irq_at       = uplinks[i].start_us + uplinks[i].toa_us;
+        irq_next     = RAL_IRQ_RX_DONE;
+        return;
+    }
+    radio_listen( cad_done_us, cad_done_us + radio_cad_timeout_ms * 1000.0 );
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- FAKE RADIO ----------------------------------------------------------- */
+
+static ral_status_t fake_set_standby( const void* context, ral_standby_cfg_t standby_cfg )
+{
+    radio_command( 1 );
+    irq_at      = INFINITY;
+    radio_in_rc = true;
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t fake_set_pkt_type( const void* context, const ral_pkt_type_t pkt_type )
+{
+    radio_command( 1 );
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t fake_set_lora_mod_params( const void* context, const ral_lora_mod_params_t* params )
+{
+    radio_command( 2 );
+    radio_sf = params->sf;
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t fake_set_lora_pkt_params( const void* context, const ral_lora_pkt_params_t* params )
+{
+    radio_command( 3 );
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t fake_set_dio_irq_params( const void* context, const ral_irq_t irq )
+{
+    radio_command( 1 );
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t fake_clear_irq_status( const void* context, const ral_irq_t irq )
+{
+    radio_command( 1 );
+    irq_pending &= ~irq;
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t fake_get_and_clear_irq_status( const void* context, ral_irq_t* irq )
+{
+    radio_command( 2 );
+    *irq        = irq_pending;
+    irq_pending = RAL_IRQ_NONE;
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t fake_set_rf_freq( const void* context, const uint32_t freq_in_hz )
+{
+    radio_command( 1 );
+    radio_chan = freq_to_chan( freq_in_hz );
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t fake_set_lora_symb_nb_timeout( const void* context, const uint16_t nb_of_symbs )
+{
+    radio_command( 1 );
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t fake_set_rx( const void* context, const uint32_t timeout_in_ms )
+{
+    double start;
+
+    radio_command( 1 );
+    start       = now + ( radio_in_rc ? tcxo_us : 0 );
+    radio_in_rc = false;
+    radio_listen( start, start + timeout_in_ms * 1000.0 );
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t fake_set_lora_cad_params( const void* context, const ral_lora_cad_params_t* params )
+{
+    radio_command( 1 );
+    radio_cad_timeout_ms = params->cad_timeout_in_ms;
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t fake_get_lora_cad_det_peak( const void* context, ral_lora_sf_t sf, ral_lora_bw_t bw,
+                                                ral_lora_cad_symbs_t nb_symbol, uint8_t* cad_det_peak )
+{
+    *cad_det_peak = 22;
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t fake_set_lora_cad( const void* context )
+{
+    radio_command( 1 );
+    radio_start_cad( );
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t fake_get_lora_rx_pkt_status( const void* context, ral_lora_rx_pkt_status_t* rx_pkt_status )
+{
+    radio_command( 1 );
+    rx_pkt_status->rssi_pkt_in_dbm = -80;
+    rx_pkt_status->snr_pkt_in_db   = 5;
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t fake_get_pkt_payload( const void* context, uint16_t max_size_in_bytes, uint8_t* buffer,
+                                          uint16_t* size_in_bytes )
+{
+    radio_command( 2 );
+    now += PAYLOAD_SIZE * 4; /* SPI read of the payload */
+    *size_in_bytes = PAYLOAD_SIZE;
+    return RAL_STATUS_OK;
+}
+
+static radio_context_t fake_context = { .gpio_led_rx = 0xFF, .gpio_led_tx = 0xFF, .gpio_dio1 = 1 };
+
+static const ral_t fake_ral = {
+    .context = &fake_context,
+    .driver  = {
+        .set_standby              = fake_set_standby,
+        .set_pkt_type             = fake_set_pkt_type,
+        .set_lora_mod_params      = fake_set_lora_mod_params,
+        .set_lora_pkt_params      = fake_set_lora_pkt_params,
+        .set_dio_irq_params       = fake_set_dio_irq_params,
+        .clear_irq_status         = fake_clear_irq_status,
+        .get_and_clear_irq_status = fake_get_and_clear_irq_status,
+        .set_rf_freq              = fake_set_rf_freq,
+        .set_lora_symb_nb_timeout = fake_set_lora_symb_nb_timeout,
+        .set_rx                   = fake_set_rx,
+        .set_lora_cad_params      = fake_set_lora_cad_params,
+        .get_lora_cad_det_peak    = fake_get_lora_cad_det_peak,
+        .set_lora_cad             = fake_set_lora_cad,
+        .get_lora_rx_pkt_status   = fake_get_lora_rx_pkt_status,
+        .get_pkt_payload          = fake_get_pkt_payload,
+    },
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PLATFORM STUBS ------------------------------------------------------- */
+
+int lgw_get_instcnt( uint32_t* inst_cnt_us )
+{
+    *inst_cnt_us = ( uint32_t ) ( uint64_t ) now;
+    return LGW_HAL_SUCCESS;
+}
+
+esp_err_t gpio_install_isr_service( int intr_alloc_flags )
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add( gpio_num_t gpio_num, gpio_isr_t isr_handler, void* args )
+{
+    dio_handler = isr_handler;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level( gpio_num_t gpio_num, uint32_t level )
+{
+    return ESP_OK;
+}
+
+void vTaskNotifyGiveFromISR( TaskHandle_t task, BaseType_t* higher_priority_task_woken )
+{
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- RX TASK, MIRRORED FROM LORAHUB_HAL.C --------------------------------- */
+
+static const struct lgw_scan_slot_s* next_slot( uint32_t count_us )
+{
+    if( policy == POLICY_SCAN )
+    {
+        return lgw_scan_next( count_us );
+    }
+
+    /* round robin, counted like lgw_scan_next() does */
+    scan_slot_cur                    = rr_next;
+    rr_next                          = ( rr_next + 1 ) % scan_slot_nb;
+    scan_slot[scan_slot_cur].visit_us = count_us;
+    scan_stat[scan_slot[scan_slot_cur].chan].nb_cad++;
+    return &scan_slot[scan_slot_cur];
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void rx_arm( void )
+{
+    const struct lgw_scan_slot_s* slot;
+    uint32_t                      count_us;
+
+    if( scan_enabled == false )
+    {
+        lgw_radio_set_rx( &fake_ral, rx_freq_hz, rx_datarate, BW_125KHZ, CR_LORA_4_5 );
+        return;
+    }
+
+    lgw_get_instcnt( &count_us );
+    slot        = next_slot( count_us );
+    rx_datarate = slot->datarate;
+    rx_freq_hz  = slot->freq_hz;
+    rx_if_chain = slot->chan;
+    lgw_radio_set_cad( &fake_ral, rx_freq_hz, rx_datarate, BW_125KHZ, CR_LORA_4_5, slot->rx_timeout_ms,
+                       rx_reconfigure );
+    rx_reconfigure = false;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void rx_fetch( void )
+{
+    static uint8_t payload[256];
+    uint32_t       count_us;
+    int8_t         rssi, snr;
+    uint8_t        status;
+    uint16_t       size;
+    bool           irq_received;
+    uplink_t*      u;
+
+    if( lgw_radio_get_pkt( &fake_ral, &irq_received, &count_us, &rssi, &snr, &status, &size, payload ) > 0 )
+    {
+        if( scan_enabled == true )
+        {
+            lgw_scan_count_rx( status );
+        }
+        /* received with the metadata of the slot it was sent on */
+        u = ( radio_uplink >= 0 ) ? &uplinks[radio_uplink] : NULL;
+        if( ( u != NULL ) && ( u->received == false ) && ( u->chan == freq_to_chan( rx_freq_hz ) ) &&
+            ( u->sf == ( int ) rx_datarate ) )
+        {
+            u->received = true;
+            nb_received += 1;
+            latency_sum_us += now - ( u->start_us + u->toa_us );
+        }
+    }
+    if( irq_received == true )
+    {
+        rx_arm( );
+    }
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void rx_task_wakeup( void )
+{
+    bool cad_done;
+    bool cad_detected;
+
+    lgw_radio_get_cad( &fake_ral, &cad_done, &cad_detected );
+    if( cad_done == false )
+    {
+        rx_fetch( );
+    }
+    else if( cad_detected == true )
+    {
+        lgw_scan_count_detect( );
+    }
+    else
+    {
+        rx_arm( );
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main( int argc, char** argv )
+{
+    struct lgw_conf_scan_s scan_conf = { 0 };
+    long                   nb_sent[13] = { 0 };
+    long                   nb_rcv[13]  = { 0 };
+    long                   nb_all      = 0;
+    long                   nb_all_rcv  = 0;
+    long                   nb_plan     = 0;
+    long                   nb_plan_rcv = 0;
+    int                    nb_chan     = 8;
+    int                    sf_min      = 7;
+    int                    sf_max      = 7;
+    unsigned               seed        = 1;
+    uint32_t               count_us;
+    ral_irq_t              irq;
+    double                 irq_time;
+    int                    i;
+    int                    sf;
+
+    for( i = 1; i < argc; i++ )
+    {
+        if( strcmp( argv[i], "policy=rr" ) == 0 )
+        {
+            policy = POLICY_ROUND_ROBIN;
+        }
+        else if( strcmp( argv[i], "policy=single" ) == 0 )
+        {
+            policy = POLICY_SINGLE;
+        }
+        else if( strncmp( argv[i], "ch=", 3 ) == 0 )
+        {
+            nb_chan = atoi( argv[i] + 3 );
+        }
+        else if( strncmp( argv[i], "sf=", 3 ) == 0 )
+        {
+            sscanf( argv[i] + 3, "%d-%d", &sf_min, &sf_max );
+        }
+        else if( strncmp( argv[i], "spi=", 4 ) == 0 )
+        {
+            spi_us = atof( argv[i] + 4 );
+        }
+        else if( strncmp( argv[i], "tcxo=", 5 ) == 0 )
+        {
+            tcxo_us = atof( argv[i] + 5 );
+        }
+        else if( strncmp( argv[i], "rate=", 5 ) == 0 )
+        {
+            rate_per_s = atof( argv[i] + 5 );
+        }
+        else if( strncmp( argv[i], "dur=", 4 ) == 0 )
+        {
+            duration_s = atof( argv[i] + 4 );
+        }
+        else if( strncmp( argv[i], "seed=", 5 ) == 0 )
+        {
+            seed = ( unsigned ) atoi( argv[i] + 5 );
+        }
+        else if( strcmp( argv[i], "policy=scan" ) != 0 )
+        {
+            printf( "unknown argument %s\n", argv[i] );
+            return EXIT_FAILURE;
+        }
+    }
+    if( policy == POLICY_SINGLE )
+    {
+        nb_chan = 1;
+        sf_max  = sf_min;
+    }
+
+    srand( seed );
+    generate_uplinks( );
+
+    scan_conf.enable  = ( policy != POLICY_SINGLE );
+    scan_conf.nb_chan = nb_chan;
+    for( i = 0; i < nb_chan; i++ )
+    {
+        scan_conf.freq_hz[i] = CHAN_FREQ_HZ + i * CHAN_SPACING_HZ;
+    }
+    for( sf = sf_min; sf <= sf_max; sf++ )
+    {
+        scan_conf.datarate_mask |= 1 << sf;
+    }
+    lgw_radio_init_rx( &fake_ral, NULL );
+    lgw_get_instcnt( &count_us );
+    scan_enabled = ( lgw_scan_init( &scan_conf, BW_125KHZ, count_us ) > 0 );
+    rx_freq_hz   = CHAN_FREQ_HZ;
+    rx_datarate  = sf_min;
+    rx_arm( );
+
+    while( now < duration_s * 1e6 )
+    {
+        if( irq_at == INFINITY )
+        {
+            printf( "radio left idle at %.0f us\n", now );
+            return EXIT_FAILURE;
+        }
+        if( irq_at > now )
+        {
+            now = irq_at;
+        }
+        irq      = irq_next;
+        irq_time = irq_at;
+        irq_at   = INFINITY;
+        irq_pending |= irq;
+        if( ( irq & RAL_IRQ_CAD_OK ) != 0 )
+        {
+            radio_cad_rx( irq_time );
+        }
+        dio_handler( NULL );
+        now += WAKE_US;
+        rx_task_wakeup( );
+    }
+
+    for( i = 0; i < nb_uplinks; i++ )
+    {
+        if( uplinks[i].start_us + uplinks[i].toa_us > duration_s * 1e6 - TAIL_US )
+        {
+            continue;
+        }
+        nb_all += 1;
+        nb_all_rcv += uplinks[i].received;
+        if( ( uplinks[i].chan < nb_chan ) && ( uplinks[i].sf >= sf_min ) && ( uplinks[i].sf <= sf_max ) )
+        {
+            nb_sent[uplinks[i].sf] += 1;
+            nb_rcv[uplinks[i].sf] += uplinks[i].received;
+            nb_plan += 1;
+            nb_plan_rcv += uplinks[i].received;
+        }
+    }
+    printf( "%-6s %d ch SF%d-%d spi %3.0f us tcxo %4.0f us | in-plan %5.1f%% all %5.1f%% |",
+            ( policy == POLICY_SCAN ) ? "scan" : ( policy == POLICY_ROUND_ROBIN ) ? "rr" : "single", nb_chan, sf_min,
+            sf_max, spi_us, tcxo_us, 100.0 * nb_plan_rcv / ( nb_plan ? nb_plan : 1 ),
+            100.0 * nb_all_rcv / ( nb_all ? nb_all : 1 ) );
+    for( sf = sf_min; sf <= sf_max; sf++ )
+    {
+        printf( " SF%d %5.1f%%", sf, 100.0 * nb_rcv[sf] / ( nb_sent[sf] ? nb_sent[sf] : 1 ) );
+    }
+    printf( " | %.0f CAD/s, %ld false alarms, end of packet to ring %.2f ms\n", nb_cad / duration_s, nb_false,
+            nb_received ? latency_sum_us / nb_received / 1000 : 0 );
+
+    return EXIT_SUCCESS;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,187 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+  (C)2019 Semtech
+
+Description:
+    Indicator board stand-in for the LoRaHub HAL host tests
+
+    GPIO and IO expander calls are accepted and ignored, except for the handler
+    registered on the DIO pin which host_board_raise_dio() calls. The shield
+    has no LED, no antenna switch and a crystal, so no TCXO startup time.
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include <stddef.h> /* NULL */
+
+#include "driver/gpio.h"
+#include "bsp_sx126x.h"
+#include "ral_sx126x_bsp.h"
+#include "smtc_shield_sx126x.h"
+
+#include "host_board.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define DIO1_GPIO 3
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DECLARATION ---------------------------------------- */
+
+static esp_err_t expander_set_direction( uint8_t pin, bool is_output );
+static esp_err_t expander_set_level( uint8_t pin, bool level );
+
+static const smtc_shield_sx126x_pinout_t*       shield_get_pinout( void );
+static const smtc_shield_sx126x_capabilities_t* shield_get_capabilities( void );
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static gpio_isr_t dio_isr     = NULL;
+static void*      dio_isr_arg = NULL;
+
+static io_expander_ops_t expander = { .set_direction = expander_set_direction, .set_level = expander_set_level };
+
+static const smtc_shield_sx126x_pinout_t shield_pinout = {
+    .nss = 0, .sclk = 0, .mosi = 0, .miso = 0, .reset = 0, .busy = 0, .irq = DIO1_GPIO,
+    .antenna_sw = 0xFF, .led_tx = 0xFF, .led_rx = 0xFF
+};
+
+static const smtc_shield_sx126x_capabilities_t shield_capabilities = {
+    .freq_hz_min = 150000000, .freq_hz_max = 960000000, .power_dbm_min = -9, .power_dbm_max = 22
+};
+
+static const smtc_shield_sx126x_t shield = { .get_pinout       = shield_get_pinout,
+                                             .get_capabilities = shield_get_capabilities };
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC VARIABLES ----------------------------------------------------- */
+
+io_expander_ops_t* indicator_io_expander = &expander;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static esp_err_t expander_set_direction( uint8_t pin, bool is_output )
+{
+    return ESP_OK;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static esp_err_t expander_set_level( uint8_t pin, bool level )
+{
+    return ESP_OK;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static const smtc_shield_sx126x_pinout_t* shield_get_pinout( void )
+{
+    return &shield_pinout;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static const smtc_shield_sx126x_capabilities_t* shield_get_capabilities( void )
+{
+    return &shield_capabilities;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+bool host_board_raise_dio( void )
+{
+    if( dio_isr == NULL )
+    {
+        return false;
+    }
+    dio_isr( dio_isr_arg );
+    return true;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+esp_err_t gpio_config( const gpio_config_t* config )
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin( gpio_num_t gpio_num )
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction( gpio_num_t gpio_num, gpio_mode_t mode )
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type( gpio_num_t gpio_num, gpio_int_type_t intr_type )
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level( gpio_num_t gpio_num, uint32_t level )
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service( int intr_alloc_flags )
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add( gpio_num_t gpio_num, gpio_isr_t isr_handler, void* args )
+{
+    if( gpio_num == DIO1_GPIO )
+    {
+        dio_isr     = isr_handler;
+        dio_isr_arg = args;
+    }
+    return ESP_OK;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+spi_device_handle_t bsp_sx126x_spi_handle_get( void )
+{
+    return NULL;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+const smtc_shield_sx126x_t* ral_sx126x_get_shield( void )
+{
+    return &shield;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void ral_sx126x_bsp_get_xosc_cfg( const void* context, ral_xosc_cfg_t* xosc_cfg,
+                                  sx126x_tcxo_ctrl_voltages_t* supply_voltage, uint32_t* startup_time_in_tick )
+{
+    if( xosc_cfg != NULL )
+    {
+        *xosc_cfg = RAL_XOSC_CFG_XTAL;
+    }
+    if( supply_voltage != NULL )
+    {
+        *supply_voltage = 0;
+    }
+    if( startup_time_in_tick != NULL )
+    {
+        *startup_time_in_tick = 0;
+    }
+}
+
+/* --- EOF ------------------------------------------------------------------ */
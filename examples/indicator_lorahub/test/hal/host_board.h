@@ -0,0 +1,35 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+  (C)2019 Semtech
+
+Description:
+    Indicator board stand-in for the LoRaHub HAL host tests
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+#ifndef _HOST_BOARD_H
+#define _HOST_BOARD_H
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include <stdbool.h> /* bool type */
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS PROTOTYPES ------------------------------------------ */
+
+/**
+ * @brief Call the handler registered on the radio DIO pin, as the GPIO interrupt would
+ *
+ * @return false if the HAL has not registered any handler yet
+ */
+bool host_board_raise_dio( void );
+
+#endif
+
+/* --- EOF ------------------------------------------------------------------ */
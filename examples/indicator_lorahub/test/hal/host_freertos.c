@@ -0,0 +1,284 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+  (C)2019 Semtech
+
+Description:
+    FreeRTOS calls of the LoRaHub HAL on top of pthreads, for the host tests
+
+    Each task is a thread with its own notification counter, semaphores are a
+    counter and a condition variable. Threads started with pthread_create(),
+    as the packet forwarder does, get their task the first time they need it.
+    Priorities are ignored, the host scheduler decides.
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include <stdlib.h>  /* calloc */
+#include <errno.h>   /* ETIMEDOUT */
+#include <pthread.h> /* threads, mutexes and condition variables */
+#include <time.h>    /* clock_gettime */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+struct host_task
+{
+    pthread_t       thread;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    uint32_t        notified;
+    TaskFunction_t  fn;
+    void*           arg;
+};
+
+struct host_semaphore
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    uint32_t        count;
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static __thread struct host_task* current_task = NULL;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static void cond_init( pthread_cond_t* cond )
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init( &attr );
+    pthread_condattr_setclock( &attr, CLOCK_MONOTONIC );
+    pthread_cond_init( cond, &attr );
+    pthread_condattr_destroy( &attr );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Waits on cond until *done is not 0 or ticks have passed, lock held. Returns 0 on timeout. */
+static int cond_wait_ticks( pthread_cond_t* cond, pthread_mutex_t* lock, const uint32_t* done, TickType_t ticks )
+{
+    struct timespec deadline;
+
+    clock_gettime( CLOCK_MONOTONIC, &deadline );
+    deadline.tv_sec += ticks / 1000;
+    deadline.tv_nsec += ( long ) ( ticks % 1000 ) * 1000000L;
+    if( deadline.tv_nsec >= 1000000000L )
+    {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    while( *done == 0 )
+    {
+        if( ticks == portMAX_DELAY )
+        {
+            pthread_cond_wait( cond, lock );
+        }
+        else if( pthread_cond_timedwait( cond, lock, &deadline ) == ETIMEDOUT )
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static struct host_task* task_alloc( void )
+{
+    struct host_task* task = calloc( 1, sizeof( struct host_task ) );
+
+    if( task != NULL )
+    {
+        pthread_mutex_init( &task->lock, NULL );
+        cond_init( &task->cond );
+    }
+    return task;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void* task_entry( void* arg )
+{
+    struct host_task* task = arg;
+
+    current_task = task;
+    task->fn( task->arg );
+    return NULL;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static SemaphoreHandle_t semaphore_create( uint32_t count )
+{
+    struct host_semaphore* sem = calloc( 1, sizeof( struct host_semaphore ) );
+
+    if( sem != NULL )
+    {
+        pthread_mutex_init( &sem->lock, NULL );
+        cond_init( &sem->cond );
+        sem->count = count;
+    }
+    return sem;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+BaseType_t xTaskCreate( TaskFunction_t fn, const char* name, uint32_t stack_size, void* arg, UBaseType_t priority,
+                        TaskHandle_t* handle )
+{
+    struct host_task* task = task_alloc( );
+
+    if( task == NULL )
+    {
+        return pdFAIL;
+    }
+    task->fn  = fn;
+    task->arg = arg;
+    if( handle != NULL )
+    {
+        *handle = task;
+    }
+    if( pthread_create( &task->thread, NULL, task_entry, task ) != 0 )
+    {
+        free( task );
+        return pdFAIL;
+    }
+    pthread_detach( task->thread );
+    return pdPASS;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+TaskHandle_t xTaskGetCurrentTaskHandle( void )
+{
+    if( current_task == NULL )
+    {
+        current_task = task_alloc( );
+    }
+    return current_task;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+TickType_t xTaskGetTickCount( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( TickType_t ) ( now.tv_sec * 1000 + now.tv_nsec / 1000000 );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+uint32_t ulTaskNotifyTake( BaseType_t clear_on_exit, TickType_t ticks_to_wait )
+{
+    struct host_task* task = xTaskGetCurrentTaskHandle( );
+    uint32_t          value;
+
+    pthread_mutex_lock( &task->lock );
+    cond_wait_ticks( &task->cond, &task->lock, &task->notified, ticks_to_wait );
+    value = task->notified;
+    if( value > 0 )
+    {
+        task->notified = ( clear_on_exit == pdTRUE ) ? 0 : value - 1;
+    }
+    pthread_mutex_unlock( &task->lock );
+    return value;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+BaseType_t xTaskNotifyGive( TaskHandle_t task )
+{
+    pthread_mutex_lock( &task->lock );
+    task->notified += 1;
+    pthread_cond_signal( &task->cond );
+    pthread_mutex_unlock( &task->lock );
+    return pdPASS;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void vTaskNotifyGiveFromISR( TaskHandle_t task, BaseType_t* higher_priority_task_woken )
+{
+    xTaskNotifyGive( task );
+    if( higher_priority_task_woken != NULL )
+    {
+        *higher_priority_task_woken = pdTRUE;
+    }
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void vTaskDelay( TickType_t ticks )
+{
+    struct timespec delay = { .tv_sec = ticks / 1000, .tv_nsec = ( long ) ( ticks % 1000 ) * 1000000L };
+
+    nanosleep( &delay, NULL );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+SemaphoreHandle_t xSemaphoreCreateMutex( void )
+{
+    return semaphore_create( 1 );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+SemaphoreHandle_t xSemaphoreCreateBinary( void )
+{
+    return semaphore_create( 0 );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+BaseType_t xSemaphoreTake( SemaphoreHandle_t sem, TickType_t ticks_to_wait )
+{
+    BaseType_t taken;
+
+    pthread_mutex_lock( &sem->lock );
+    taken = ( cond_wait_ticks( &sem->cond, &sem->lock, &sem->count, ticks_to_wait ) == 1 ) ? pdTRUE : pdFALSE;
+    if( taken == pdTRUE )
+    {
+        sem->count -= 1;
+    }
+    pthread_mutex_unlock( &sem->lock );
+    return taken;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+BaseType_t xSemaphoreGive( SemaphoreHandle_t sem )
+{
+    BaseType_t given = pdFALSE;
+
+    pthread_mutex_lock( &sem->lock );
+    if( sem->count == 0 ) /* mutexes and binary semaphores both top out at 1 */
+    {
+        sem->count = 1;
+        given      = pdTRUE;
+        pthread_cond_signal( &sem->cond );
+    }
+    pthread_mutex_unlock( &sem->lock );
+    return given;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
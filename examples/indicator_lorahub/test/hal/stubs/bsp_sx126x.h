@@ -0,0 +1,18 @@
+/* Host stand-in for the Indicator board header, see host_board.c */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/spi_master.h"
+#include "esp_err.h"
+
+typedef struct
+{
+    esp_err_t ( *set_direction )( uint8_t pin, bool is_output );
+    esp_err_t ( *set_level )( uint8_t pin, bool level );
+} io_expander_ops_t;
+
+extern io_expander_ops_t* indicator_io_expander;
+
+spi_device_handle_t bsp_sx126x_spi_handle_get( void );
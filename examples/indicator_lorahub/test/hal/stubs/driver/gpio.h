@@ -0,0 +1,42 @@
+/* Host stand-in for the ESP-IDF header. host_board.c records the DIO interrupt handler so that the fake radio can
+ * raise it, the other pins go nowhere. */
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define IRAM_ATTR
+
+typedef int gpio_num_t;
+typedef void ( *gpio_isr_t )( void* arg );
+
+typedef enum
+{
+    GPIO_MODE_INPUT,
+    GPIO_MODE_OUTPUT,
+} gpio_mode_t;
+
+typedef enum
+{
+    GPIO_INTR_DISABLE,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+} gpio_int_type_t;
+
+typedef struct
+{
+    uint64_t        pin_bit_mask;
+    gpio_mode_t     mode;
+    uint32_t        pull_up_en;
+    uint32_t        pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+esp_err_t gpio_config( const gpio_config_t* config );
+esp_err_t gpio_reset_pin( gpio_num_t gpio_num );
+esp_err_t gpio_set_direction( gpio_num_t gpio_num, gpio_mode_t mode );
+esp_err_t gpio_set_intr_type( gpio_num_t gpio_num, gpio_int_type_t intr_type );
+esp_err_t gpio_set_level( gpio_num_t gpio_num, uint32_t level );
+esp_err_t gpio_install_isr_service( int intr_alloc_flags );
+esp_err_t gpio_isr_handler_add( gpio_num_t gpio_num, gpio_isr_t isr_handler, void* args );
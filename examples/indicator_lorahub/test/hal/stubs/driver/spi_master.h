@@ -0,0 +1,4 @@
+/* Host stand-in for the ESP-IDF header, the radio is never reached through SPI on the host */
+#pragma once
+
+typedef struct spi_device_t* spi_device_handle_t;
@@ -0,0 +1,9 @@
+/* Host stand-in for the ESP-IDF header */
+#pragma once
+
+#include <unistd.h>
+
+static inline void esp_rom_delay_us( uint32_t us )
+{
+    usleep( us );
+}
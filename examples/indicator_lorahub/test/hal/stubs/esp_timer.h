@@ -0,0 +1,6 @@
+/* Host stand-in for the ESP-IDF header, the program under test provides the clock */
+#pragma once
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time( void );
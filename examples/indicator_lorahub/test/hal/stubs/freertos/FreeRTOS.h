@@ -0,0 +1,20 @@
+/* Host stand-in for the FreeRTOS header, ticks are 1 ms as on the Indicator */
+#pragma once
+
+#include <stdint.h>
+
+typedef int          BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t     TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define pdFAIL 0
+
+#define portMAX_DELAY ( ( TickType_t ) 0xFFFFFFFF )
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS( ms ) ( ( TickType_t ) ( ms ) )
+#define pdTICKS_TO_MS( ticks ) ( ( uint32_t ) ( ticks ) )
+
+#define portYIELD_FROM_ISR( woken ) ( ( void ) ( woken ) )
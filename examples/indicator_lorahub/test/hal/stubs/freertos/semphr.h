@@ -0,0 +1,11 @@
+/* Host stand-in for the FreeRTOS header, see host_freertos.c */
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_semaphore* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex( void );
+SemaphoreHandle_t xSemaphoreCreateBinary( void );
+BaseType_t        xSemaphoreTake( SemaphoreHandle_t sem, TickType_t ticks_to_wait );
+BaseType_t        xSemaphoreGive( SemaphoreHandle_t sem );
@@ -0,0 +1,16 @@
+/* Host stand-in for the FreeRTOS header, see host_freertos.c */
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task* TaskHandle_t;
+typedef void ( *TaskFunction_t )( void* );
+
+BaseType_t   xTaskCreate( TaskFunction_t fn, const char* name, uint32_t stack_size, void* arg, UBaseType_t priority,
+                          TaskHandle_t* handle );
+TaskHandle_t xTaskGetCurrentTaskHandle( void );
+TickType_t   xTaskGetTickCount( void );
+BaseType_t   xTaskNotifyGive( TaskHandle_t task );
+void         vTaskNotifyGiveFromISR( TaskHandle_t task, BaseType_t* higher_priority_task_woken );
+uint32_t     ulTaskNotifyTake( BaseType_t clear_on_exit, TickType_t ticks_to_wait );
+void         vTaskDelay( TickType_t ticks );
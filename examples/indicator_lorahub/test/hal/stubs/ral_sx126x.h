@@ -0,0 +1,53 @@
+/* Host stand-in for the SX126x RAL: lgw_ral drives the fake radio of the program under test, which defines the
+ * host_radio_* functions below. Only the RAL calls of the RX path are wired, the TX ones are left NULL. */
+#pragma once
+
+#include "ral_defs.h"
+#include "ral_drv.h"
+
+ral_status_t host_radio_reset( const void* context );
+ral_status_t host_radio_init( const void* context );
+ral_status_t host_radio_set_rx_tx_fallback_mode( const void* context, const ral_fallback_modes_t fallback_mode );
+ral_status_t host_radio_set_standby( const void* context, ral_standby_cfg_t standby_cfg );
+ral_status_t host_radio_set_rx( const void* context, const uint32_t timeout_in_ms );
+ral_status_t host_radio_set_lora_cad( const void* context );
+ral_status_t host_radio_get_pkt_payload( const void* context, uint16_t max_size_in_bytes, uint8_t* buffer,
+                                         uint16_t* size_in_bytes );
+ral_status_t host_radio_clear_irq_status( const void* context, const ral_irq_t irq );
+ral_status_t host_radio_get_and_clear_irq_status( const void* context, ral_irq_t* irq );
+ral_status_t host_radio_set_dio_irq_params( const void* context, const ral_irq_t irq );
+ral_status_t host_radio_set_rf_freq( const void* context, const uint32_t freq_in_hz );
+ral_status_t host_radio_set_pkt_type( const void* context, const ral_pkt_type_t pkt_type );
+ral_status_t host_radio_set_lora_mod_params( const void* context, const ral_lora_mod_params_t* params );
+ral_status_t host_radio_set_lora_pkt_params( const void* context, const ral_lora_pkt_params_t* params );
+ral_status_t host_radio_set_lora_cad_params( const void* context, const ral_lora_cad_params_t* params );
+ral_status_t host_radio_set_lora_symb_nb_timeout( const void* context, const uint16_t nb_of_symbs );
+ral_status_t host_radio_get_lora_rx_pkt_status( const void* context, ral_lora_rx_pkt_status_t* rx_pkt_status );
+ral_status_t host_radio_set_lora_sync_word( const void* context, const uint8_t sync_word );
+ral_status_t host_radio_get_lora_cad_det_peak( const void* context, ral_lora_sf_t sf, ral_lora_bw_t bw,
+                                               ral_lora_cad_symbs_t nb_symbol, uint8_t* cad_det_peak );
+
+#define RAL_SX126X_INSTANTIATE( ctx )                                              \
+    {                                                                              \
+        .context = ctx, .driver = {                                                \
+            .reset                    = host_radio_reset,                          \
+            .init                     = host_radio_init,                           \
+            .set_rx_tx_fallback_mode  = host_radio_set_rx_tx_fallback_mode,        \
+            .set_standby              = host_radio_set_standby,                    \
+            .set_rx                   = host_radio_set_rx,                         \
+            .set_lora_cad             = host_radio_set_lora_cad,                   \
+            .get_pkt_payload          = host_radio_get_pkt_payload,                \
+            .clear_irq_status         = host_radio_clear_irq_status,               \
+            .get_and_clear_irq_status = host_radio_get_and_clear_irq_status,       \
+            .set_dio_irq_params       = host_radio_set_dio_irq_params,             \
+            .set_rf_freq              = host_radio_set_rf_freq,                    \
+            .set_pkt_type             = host_radio_set_pkt_type,                   \
+            .set_lora_mod_params      = host_radio_set_lora_mod_params,            \
+            .set_lora_pkt_params      = host_radio_set_lora_pkt_params,            \
+            .set_lora_cad_params      = host_radio_set_lora_cad_params,            \
+            .set_lora_symb_nb_timeout = host_radio_set_lora_symb_nb_timeout,       \
+            .get_lora_rx_pkt_status   = host_radio_get_lora_rx_pkt_status,         \
+            .set_lora_sync_word       = host_radio_set_lora_sync_word,             \
+            .get_lora_cad_det_peak    = host_radio_get_lora_cad_det_peak,          \
+        }                                                                          \
+    }
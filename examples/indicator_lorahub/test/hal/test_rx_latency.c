@@ -0,0 +1,452 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+  (C)2019 Semtech
+
+Description:
+    Host test of the HAL RX path: DIO interrupt, RX task, ring, lgw_receive()
+
+    The HAL is built as is on top of pthreads, with a fake radio behind the RAL.
+    A radio thread receives a numbered packet whenever the HAL has armed RX,
+    at random 2 to 22 ms intervals, and calls the DIO interrupt handler. The
+    consumer drains the packets the way thread_up does, either blocked in
+    lgw_receive_wait() or sleeping 10 ms between empty lgw_receive() calls as
+    it did before, and the delay from the interrupt to lgw_receive() is
+    reported. Packets must come out complete, in order and timestamped with the
+    interrupt time.
+
+    A burst of packets left unread must fill the ring and count the overflow in
+    lgw_receive_dropped().
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include <stdint.h>  /* C99 types */
+#include <stdbool.h> /* bool type */
+#include <stdio.h>   /* printf */
+#include <stdlib.h>  /* qsort, rand */
+#include <string.h>  /* memcpy, memset */
+#include <pthread.h> /* radio thread */
+#include <time.h>    /* clock_gettime */
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "lorahub_hal.h"
+#include "lorahub_hal_rx.h"
+#include "ral_sx126x.h"
+
+#include "host_board.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define NB_PKT 400         /* packets received in each mode */
+#define GAP_MIN_MS 2       /* shortest interval between two packets */
+#define GAP_MAX_MS 22      /* longest interval between two packets */
+#define PKT_SIZE 24        /* payload size, sequence number first */
+#define NB_PKT_MAX 8       /* same as thread_up */
+#define FETCH_WAIT_MS 100  /* same as thread_up */
+#define FETCH_SLEEP_MS 10  /* thread_up sleep between polls before lgw_receive_wait() */
+#define BURST_PKT 12       /* packets received without reading any */
+#define RX_RING_SIZE 8     /* see lorahub_hal.c */
+#define ARM_TIMEOUT_MS 1000
+
+#define RX_FREQ_HZ 868100000
+#define RX_DATARATE DR_LORA_SF7
+#define RX_BANDWIDTH BW_125KHZ
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+typedef enum
+{
+    CONSUMER_WAIT, /* lgw_receive_wait() between reads */
+    CONSUMER_POLL, /* FETCH_SLEEP_MS between reads */
+} consumer_t;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static pthread_mutex_t radio_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  radio_cond = PTHREAD_COND_INITIALIZER;
+static bool            radio_armed   = false;
+static ral_irq_t       radio_irq     = RAL_IRQ_NONE;
+static uint8_t         radio_payload[PKT_SIZE];
+
+static int64_t irq_time_us[NB_PKT];
+static int     radio_nb_pkt = 0; /* packets the radio thread delivers, 0 to stop it */
+static int     radio_gaps   = 0; /* random gaps between packets, or back to back */
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+int64_t esp_timer_get_time( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( int64_t ) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void sleep_us( uint32_t us )
+{
+    struct timespec delay = { .tv_sec = us / 1000000, .tv_nsec = ( long ) ( us % 1000000 ) * 1000L };
+
+    nanosleep( &delay, NULL );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Receives packet seq as soon as RX is armed, then raises DIO. Returns false if the HAL never armed RX. */
+static bool radio_receive( int seq )
+{
+    struct timespec deadline;
+    int             i;
+
+    clock_gettime( CLOCK_REALTIME, &deadline ); /* clock of radio_cond */
+    deadline.tv_sec += ARM_TIMEOUT_MS / 1000;
+
+    pthread_mutex_lock( &radio_lock );
+    while( radio_armed == false )
+    {
+        if( pthread_cond_timedwait( &radio_cond, &radio_lock, &deadline ) != 0 )
+        {
+            pthread_mutex_unlock( &radio_lock );
+            return false;
+        }
+    }
+    radio_payload[0] = ( uint8_t ) ( seq >> 8 );
+    radio_payload[1] = ( uint8_t ) seq;
+    for( i = 2; i < PKT_SIZE; i++ )
+    {
+        radio_payload[i] = ( uint8_t ) ( seq + i );
+    }
+    radio_irq   = RAL_IRQ_RX_DONE;
+    radio_armed = false; /* single RX, back to standby until re-armed */
+    irq_time_us[seq % NB_PKT] = esp_timer_get_time( );
+    pthread_mutex_unlock( &radio_lock );
+
+    return host_board_raise_dio( );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void* radio_thread( void* arg )
+{
+    int seq;
+
+    for( seq = 0; seq < radio_nb_pkt; seq++ )
+    {
+        if( radio_gaps != 0 )
+        {
+            sleep_us( ( GAP_MIN_MS + rand( ) % ( GAP_MAX_MS - GAP_MIN_MS + 1 ) ) * 1000 +
+                      ( uint32_t ) ( rand( ) % 1000 ) );
+        }
+        if( radio_receive( seq ) == false )
+        {
+            printf( "packet %d: RX not re-armed within %d ms\n", seq, ARM_TIMEOUT_MS );
+            break;
+        }
+    }
+    return NULL;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Checks a received packet against what the radio sent. Returns its sequence number, -1 if it is wrong. */
+static int check_pkt( const struct lgw_pkt_rx_s* p )
+{
+    uint32_t correction = lgw_radio_timestamp_correction( RX_DATARATE, RX_BANDWIDTH );
+    int      seq;
+    int      i;
+
+    if( ( p->size != PKT_SIZE ) || ( p->status != STAT_CRC_OK ) || ( p->freq_hz != RX_FREQ_HZ ) ||
+        ( p->datarate != RX_DATARATE ) )
+    {
+        return -1;
+    }
+    seq = ( p->payload[0] << 8 ) | p->payload[1];
+    for( i = 2; i < PKT_SIZE; i++ )
+    {
+        if( p->payload[i] != ( uint8_t ) ( seq + i ) )
+        {
+            return -1;
+        }
+    }
+    /* The DIO interrupt timestamp is taken right after the radio thread recorded irq_time_us */
+    if( ( uint32_t ) ( p->count_us + correction - ( uint32_t ) irq_time_us[seq % NB_PKT] ) > 1000 )
+    {
+        return -1;
+    }
+    return seq;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static int compare_int64( const void* a, const void* b )
+{
+    int64_t x = *( const int64_t* ) a;
+    int64_t y = *( const int64_t* ) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static int run_consumer( consumer_t consumer, const char* name )
+{
+    static struct lgw_pkt_rx_s rxpkt[NB_PKT_MAX];
+    static int64_t             latency_us[NB_PKT];
+    pthread_t                  radio;
+    int64_t                    deadline = esp_timer_get_time( ) + ( int64_t ) NB_PKT * GAP_MAX_MS * 2000;
+    uint32_t                   dropped  = lgw_receive_dropped( );
+    int64_t                    sum_us   = 0;
+    int                        nb_rx    = 0;
+    int                        errors   = 0;
+    int                        nb_pkt;
+    int                        seq;
+    int                        i;
+
+    radio_nb_pkt = NB_PKT;
+    radio_gaps   = 1;
+    pthread_create( &radio, NULL, radio_thread, NULL );
+
+    while( ( nb_rx < NB_PKT ) && ( esp_timer_get_time( ) < deadline ) )
+    {
+        nb_pkt = lgw_receive( NB_PKT_MAX, rxpkt );
+        if( nb_pkt == 0 )
+        {
+            if( consumer == CONSUMER_WAIT )
+            {
+                lgw_receive_wait( FETCH_WAIT_MS );
+            }
+            else
+            {
+                vTaskDelay( pdMS_TO_TICKS( FETCH_SLEEP_MS ) );
+            }
+            continue;
+        }
+        for( i = 0; i < nb_pkt; i++ )
+        {
+            seq = check_pkt( &rxpkt[i] );
+            if( seq != nb_rx )
+            {
+                if( errors++ == 0 )
+                {
+                    printf( "%s: packet %d received as %d\n", name, nb_rx, seq );
+                }
+                seq = nb_rx;
+            }
+            latency_us[nb_rx] = esp_timer_get_time( ) - irq_time_us[seq];
+            sum_us += latency_us[nb_rx];
+            nb_rx += 1;
+        }
+    }
+    pthread_join( radio, NULL );
+
+    if( nb_rx < NB_PKT )
+    {
+        printf( "%s: %d of %d packets received\n", name, nb_rx, NB_PKT );
+        return 1;
+    }
+    qsort( latency_us, NB_PKT, sizeof( latency_us[0] ), compare_int64 );
+    printf( "%-32s IRQ to lgw_receive() mean %6.2f ms  p50 %6.2f ms  p99 %6.2f ms  max %6.2f ms  %s\n", name,
+            ( double ) sum_us / NB_PKT / 1000.0, ( double ) latency_us[NB_PKT / 2] / 1000.0,
+            ( double ) latency_us[NB_PKT * 99 / 100] / 1000.0, ( double ) latency_us[NB_PKT - 1] / 1000.0,
+            ( ( errors == 0 ) && ( lgw_receive_dropped( ) == dropped ) ) ? "ok" : "FAILED" );
+
+    return ( ( errors == 0 ) && ( lgw_receive_dropped( ) == dropped ) ) ? 0 : 1;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static int run_burst( void )
+{
+    static struct lgw_pkt_rx_s rxpkt[NB_PKT_MAX];
+    pthread_t                  radio;
+    uint32_t                   dropped = lgw_receive_dropped( );
+    int                        nb_pkt;
+    int                        errors = 0;
+    int                        i;
+
+    radio_nb_pkt = BURST_PKT;
+    radio_gaps   = 0;
+    pthread_create( &radio, NULL, radio_thread, NULL );
+    pthread_join( radio, NULL );
+    /* The last packet is fetched by the RX task after the radio thread is done with it */
+    vTaskDelay( pdMS_TO_TICKS( 50 ) );
+
+    nb_pkt = lgw_receive( NB_PKT_MAX, rxpkt );
+    errors += ( nb_pkt != RX_RING_SIZE );
+    for( i = 0; i < nb_pkt; i++ )
+    {
+        errors += ( check_pkt( &rxpkt[i] ) != i );
+    }
+    errors += ( lgw_receive( NB_PKT_MAX, rxpkt ) != 0 );
+    errors += ( lgw_receive_dropped( ) - dropped != BURST_PKT - RX_RING_SIZE );
+
+    printf( "burst of %d unread packets: %d queued, %u dropped  %s\n", BURST_PKT, nb_pkt,
+            lgw_receive_dropped( ) - dropped, ( errors == 0 ) ? "ok" : "FAILED" );
+    return ( errors == 0 ) ? 0 : 1;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- FAKE RADIO ----------------------------------------------------------- */
+
+ral_status_t host_radio_set_rx( const void* context, const uint32_t timeout_in_ms )
+{
+    pthread_mutex_lock( &radio_lock );
+    radio_armed = true;
+    pthread_cond_signal( &radio_cond );
+    pthread_mutex_unlock( &radio_lock );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_standby( const void* context, ral_standby_cfg_t standby_cfg )
+{
+    pthread_mutex_lock( &radio_lock );
+    radio_armed = false;
+    pthread_mutex_unlock( &radio_lock );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_get_and_clear_irq_status( const void* context, ral_irq_t* irq )
+{
+    pthread_mutex_lock( &radio_lock );
+    *irq      = radio_irq;
+    radio_irq = RAL_IRQ_NONE;
+    pthread_mutex_unlock( &radio_lock );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_clear_irq_status( const void* context, const ral_irq_t irq )
+{
+    pthread_mutex_lock( &radio_lock );
+    radio_irq &= ~irq;
+    pthread_mutex_unlock( &radio_lock );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_get_pkt_payload( const void* context, uint16_t max_size_in_bytes, uint8_t* buffer,
+                                         uint16_t* size_in_bytes )
+{
+    pthread_mutex_lock( &radio_lock );
+    memcpy( buffer, radio_payload, PKT_SIZE );
+    *size_in_bytes = PKT_SIZE;
+    pthread_mutex_unlock( &radio_lock );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_get_lora_rx_pkt_status( const void* context, ral_lora_rx_pkt_status_t* rx_pkt_status )
+{
+    rx_pkt_status->rssi_pkt_in_dbm        = -60;
+    rx_pkt_status->snr_pkt_in_db          = 8;
+    rx_pkt_status->signal_rssi_pkt_in_dbm = -61;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_rx_tx_fallback_mode( const void* context, const ral_fallback_modes_t fallback_mode )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_reset( const void* context )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_init( const void* context )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_lora_cad( const void* context )
+{
+    return RAL_STATUS_ERROR; /* scan mode is not configured here */
+}
+
+ral_status_t host_radio_set_dio_irq_params( const void* context, const ral_irq_t irq )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_rf_freq( const void* context, const uint32_t freq_in_hz )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_pkt_type( const void* context, const ral_pkt_type_t pkt_type )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_lora_mod_params( const void* context, const ral_lora_mod_params_t* params )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_lora_pkt_params( const void* context, const ral_lora_pkt_params_t* params )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_lora_cad_params( const void* context, const ral_lora_cad_params_t* params )
+{
+    return RAL_STATUS_ERROR;
+}
+
+ral_status_t host_radio_set_lora_symb_nb_timeout( const void* context, const uint16_t nb_of_symbs )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_lora_sync_word( const void* context, const uint8_t sync_word )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_get_lora_cad_det_peak( const void* context, ral_lora_sf_t sf, ral_lora_bw_t bw,
+                                               ral_lora_cad_symbs_t nb_symbol, uint8_t* cad_det_peak )
+{
+    return RAL_STATUS_ERROR;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main( void )
+{
+    struct lgw_conf_rxrf_s rxrf_conf = { .freq_hz = RX_FREQ_HZ, .tx_enable = false };
+    struct lgw_conf_rxif_s rxif_conf = {
+        .modulation = MOD_LORA, .bandwidth = RX_BANDWIDTH, .datarate = RX_DATARATE, .coderate = CR_LORA_4_5
+    };
+    int errors = 0;
+
+    srand( 1 );
+    if( ( lgw_rxrf_setconf( &rxrf_conf ) != LGW_HAL_SUCCESS ) || ( lgw_rxif_setconf( &rxif_conf ) != LGW_HAL_SUCCESS ) ||
+        ( lgw_start( ) != LGW_HAL_SUCCESS ) )
+    {
+        printf( "HAL start failed\n" );
+        return EXIT_FAILURE;
+    }
+
+    printf( "%d packets %d to %d ms apart\n", NB_PKT, GAP_MIN_MS, GAP_MAX_MS );
+    errors += run_consumer( CONSUMER_WAIT, "lgw_receive_wait()" );
+    errors += run_consumer( CONSUMER_POLL, "lgw_receive() every 10 ms" );
+    errors += run_burst( );
+
+    lgw_stop( );
+    return ( errors == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,489 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+  (C)2019 Semtech
+
+Description:
+    Host test of the HAL CAD scan mode: slot scheduling, CAD_RX, statistics
+
+    The HAL is built as is on top of pthreads, with a fake radio behind the RAL.
+    Scan mode is configured on 3 channels at SF7 to SF9. The radio thread
+    answers every CAD after CAD_US. It reports a detection only when a packet
+    is pending on that frequency and SF, and then an RX done once the RX task
+    has read the CAD IRQ.
+
+    Every packet must come out with the frequency, SF and channel index of its
+    slot, timestamped with its RX done IRQ. The per-channel statistics must
+    count each CAD, detection and packet. With no traffic, each SF must get
+    CADs in inverse proportion to its window (2:1 from one SF to the next). A
+    hop between two slots of the same SF must only set the frequency. An SF
+    outside the scan list must never be listened to.
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include <stdint.h>  /* C99 types */
+#include <stdbool.h> /* bool type */
+#include <stdio.h>   /* printf */
+#include <stdlib.h>  /* EXIT_SUCCESS */
+#include <string.h>  /* memcpy */
+#include <pthread.h> /* radio thread */
+#include <time.h>    /* clock_gettime */
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "lorahub_hal.h"
+#include "lorahub_hal_rx.h"
+#include "ral_sx126x.h"
+
+#include "host_board.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define NB_CHAN 3
+#define SF_MIN 7
+#define SF_MAX 9
+#define SF_OUT 10         /* not in the scan list */
+#define PKT_PER_SLOT 10   /* packets received on each (channel, SF) */
+#define PKT_SIZE 24       /* payload size, sequence number first */
+#define CAD_US 200        /* time from set_lora_cad() to the CAD done IRQ */
+#define RX_US 300         /* time from the detection to the RX done IRQ */
+#define IDLE_MS 300       /* scan without traffic to count the CADs of each SF */
+#define RX_WAIT_MS 1000   /* longest wait for a pending packet */
+
+static const uint32_t chan_freq_hz[NB_CHAN] = { 867100000, 867300000, 867500000 };
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static pthread_mutex_t radio_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  radio_cond = PTHREAD_COND_INITIALIZER;
+static bool            radio_stop = false;
+static ral_irq_t       radio_irq  = RAL_IRQ_NONE;
+static uint8_t         radio_payload[PKT_SIZE];
+
+/* radio settings, as the HAL commands them */
+static uint32_t radio_freq_hz;
+static uint32_t radio_sf;
+static bool     cad_armed = false;
+static uint32_t cad_freq_hz;
+static uint32_t cad_sf;
+
+/* packet waiting for a CAD on its slot, pending_seq < 0 if none */
+static int      pending_seq = -1;
+static uint32_t pending_freq_hz;
+static uint32_t pending_sf;
+static int64_t  pending_irq_us;
+
+/* counted by the fake radio */
+static uint32_t nb_cad;
+static uint32_t nb_cad_sf[13];
+static uint32_t nb_sf_change;
+static uint32_t nb_set_mod;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+int64_t esp_timer_get_time( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( int64_t ) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void sleep_us( uint32_t us )
+{
+    struct timespec delay = { .tv_sec = us / 1000000, .tv_nsec = ( long ) ( us % 1000000 ) * 1000L };
+
+    nanosleep( &delay, NULL );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Runs the CADs the HAL starts: detection if the pending packet is on the CAD slot, then RX done */
+static void* radio_thread( void* arg )
+{
+    struct timespec deadline;
+    bool            detected;
+    int             i;
+
+    pthread_mutex_lock( &radio_lock );
+    while( radio_stop == false )
+    {
+        if( cad_armed == false )
+        {
+            clock_gettime( CLOCK_REALTIME, &deadline ); /* clock of radio_cond */
+            deadline.tv_nsec += 10000000;
+            if( deadline.tv_nsec >= 1000000000 )
+            {
+                deadline.tv_sec += 1;
+                deadline.tv_nsec -= 1000000000;
+            }
+            pthread_cond_timedwait( &radio_cond, &radio_lock, &deadline );
+            continue;
+        }
+        cad_armed = false;
+        pthread_mutex_unlock( &radio_lock );
+        sleep_us( CAD_US );
+        pthread_mutex_lock( &radio_lock );
+
+        detected  = ( pending_seq >= 0 ) && ( cad_freq_hz == pending_freq_hz ) && ( cad_sf == pending_sf );
+        radio_irq = RAL_IRQ_CAD_DONE | ( detected ? RAL_IRQ_CAD_OK : 0 );
+        pthread_mutex_unlock( &radio_lock );
+        host_board_raise_dio( );
+        if( detected == false )
+        {
+            pthread_mutex_lock( &radio_lock );
+            continue;
+        }
+
+        /* CAD_RX exit mode: the radio receives by itself, the RX task reads the CAD IRQ meanwhile */
+        sleep_us( RX_US );
+        pthread_mutex_lock( &radio_lock );
+        while( radio_irq != RAL_IRQ_NONE )
+        {
+            pthread_mutex_unlock( &radio_lock );
+            sleep_us( 100 );
+            pthread_mutex_lock( &radio_lock );
+        }
+        radio_payload[0] = ( uint8_t ) ( pending_seq >> 8 );
+        radio_payload[1] = ( uint8_t ) pending_seq;
+        for( i = 2; i < PKT_SIZE; i++ )
+        {
+            radio_payload[i] = ( uint8_t ) ( pending_seq + i );
+        }
+        radio_irq      = RAL_IRQ_RX_DONE;
+        pending_seq    = -1;
+        pending_irq_us = esp_timer_get_time( );
+        pthread_mutex_unlock( &radio_lock );
+        host_board_raise_dio( );
+        pthread_mutex_lock( &radio_lock );
+    }
+    pthread_mutex_unlock( &radio_lock );
+    return NULL;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Sends packet seq on (chan, sf) and checks how it is received. Returns the RX done IRQ to lgw_receive() delay in
+ * us, -1 if the packet is missing or wrong. */
+static int64_t receive_one( int seq, int chan, uint32_t sf )
+{
+    struct lgw_pkt_rx_s pkt;
+    int64_t             deadline = esp_timer_get_time( ) + RX_WAIT_MS * 1000;
+    int                 nb_pkt   = 0;
+    int                 i;
+
+    pthread_mutex_lock( &radio_lock );
+    pending_freq_hz = chan_freq_hz[chan];
+    pending_sf      = sf;
+    pending_seq     = seq;
+    pthread_mutex_unlock( &radio_lock );
+
+    while( ( nb_pkt == 0 ) && ( esp_timer_get_time( ) < deadline ) )
+    {
+        lgw_receive_wait( 100 );
+        nb_pkt = lgw_receive( 1, &pkt );
+    }
+    if( nb_pkt != 1 )
+    {
+        printf( "packet %d on %lu Hz SF%lu not received\n", seq, ( unsigned long ) chan_freq_hz[chan],
+                ( unsigned long ) sf );
+        return -1;
+    }
+
+    if( ( pkt.size != PKT_SIZE ) || ( pkt.status != STAT_CRC_OK ) || ( pkt.freq_hz != chan_freq_hz[chan] ) ||
+        ( pkt.datarate != sf ) || ( pkt.if_chain != chan ) || ( pkt.payload[0] != ( uint8_t ) ( seq >> 8 ) ) ||
+        ( pkt.payload[1] != ( uint8_t ) seq ) ||
+        ( ( uint32_t ) ( pkt.count_us + lgw_radio_timestamp_correction( sf, BW_125KHZ ) -
+                         ( uint32_t ) pending_irq_us ) > 1000 ) )
+    {
+        printf( "packet %d sent on %lu Hz SF%lu, chan %d: received on %lu Hz SF%lu, chan %u\n", seq,
+                ( unsigned long ) chan_freq_hz[chan], ( unsigned long ) sf, chan, ( unsigned long ) pkt.freq_hz,
+                ( unsigned long ) pkt.datarate, pkt.if_chain );
+        return -1;
+    }
+    for( i = 2; i < PKT_SIZE; i++ )
+    {
+        if( pkt.payload[i] != ( uint8_t ) ( seq + i ) )
+        {
+            printf( "packet %d: payload corrupted\n", seq );
+            return -1;
+        }
+    }
+    return esp_timer_get_time( ) - pending_irq_us;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- FAKE RADIO ----------------------------------------------------------- */
+
+ral_status_t host_radio_set_lora_cad( const void* context )
+{
+    pthread_mutex_lock( &radio_lock );
+    nb_sf_change += ( nb_cad > 0 ) && ( radio_sf != cad_sf );
+    cad_armed   = true;
+    cad_freq_hz = radio_freq_hz;
+    cad_sf      = radio_sf;
+    nb_cad += 1;
+    nb_cad_sf[radio_sf] += 1;
+    pthread_cond_signal( &radio_cond );
+    pthread_mutex_unlock( &radio_lock );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_lora_cad_params( const void* context, const ral_lora_cad_params_t* params )
+{
+    /* the radio must go on to RX by itself on detection, long enough to get the header */
+    return ( ( params->cad_exit_mode == RAL_LORA_CAD_RX ) && ( params->cad_timeout_in_ms > 0 ) ) ? RAL_STATUS_OK
+                                                                                                  : RAL_STATUS_ERROR;
+}
+
+ral_status_t host_radio_get_lora_cad_det_peak( const void* context, ral_lora_sf_t sf, ral_lora_bw_t bw,
+                                               ral_lora_cad_symbs_t nb_symbol, uint8_t* cad_det_peak )
+{
+    *cad_det_peak = 22;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_rf_freq( const void* context, const uint32_t freq_in_hz )
+{
+    pthread_mutex_lock( &radio_lock );
+    radio_freq_hz = freq_in_hz;
+    pthread_mutex_unlock( &radio_lock );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_lora_mod_params( const void* context, const ral_lora_mod_params_t* params )
+{
+    pthread_mutex_lock( &radio_lock );
+    radio_sf = params->sf;
+    nb_set_mod += 1;
+    pthread_mutex_unlock( &radio_lock );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_rx( const void* context, const uint32_t timeout_in_ms )
+{
+    return RAL_STATUS_ERROR; /* scan mode only runs CADs */
+}
+
+ral_status_t host_radio_set_standby( const void* context, ral_standby_cfg_t standby_cfg )
+{
+    pthread_mutex_lock( &radio_lock );
+    cad_armed = false;
+    pthread_mutex_unlock( &radio_lock );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_get_and_clear_irq_status( const void* context, ral_irq_t* irq )
+{
+    pthread_mutex_lock( &radio_lock );
+    *irq      = radio_irq;
+    radio_irq = RAL_IRQ_NONE;
+    pthread_mutex_unlock( &radio_lock );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_clear_irq_status( const void* context, const ral_irq_t irq )
+{
+    pthread_mutex_lock( &radio_lock );
+    radio_irq &= ~irq;
+    pthread_mutex_unlock( &radio_lock );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_get_pkt_payload( const void* context, uint16_t max_size_in_bytes, uint8_t* buffer,
+                                         uint16_t* size_in_bytes )
+{
+    pthread_mutex_lock( &radio_lock );
+    memcpy( buffer, radio_payload, PKT_SIZE );
+    *size_in_bytes = PKT_SIZE;
+    pthread_mutex_unlock( &radio_lock );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_get_lora_rx_pkt_status( const void* context, ral_lora_rx_pkt_status_t* rx_pkt_status )
+{
+    rx_pkt_status->rssi_pkt_in_dbm        = -60;
+    rx_pkt_status->snr_pkt_in_db          = 8;
+    rx_pkt_status->signal_rssi_pkt_in_dbm = -61;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_rx_tx_fallback_mode( const void* context, const ral_fallback_modes_t fallback_mode )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_reset( const void* context )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_init( const void* context )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_dio_irq_params( const void* context, const ral_irq_t irq )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_pkt_type( const void* context, const ral_pkt_type_t pkt_type )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_lora_pkt_params( const void* context, const ral_lora_pkt_params_t* params )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_lora_symb_nb_timeout( const void* context, const uint16_t nb_of_symbs )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t host_radio_set_lora_sync_word( const void* context, const uint8_t sync_word )
+{
+    return RAL_STATUS_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main( void )
+{
+    struct lgw_conf_rxrf_s rxrf_conf = { .freq_hz = chan_freq_hz[0], .tx_enable = false };
+    struct lgw_conf_rxif_s rxif_conf = {
+        .modulation = MOD_LORA, .bandwidth = BW_125KHZ, .datarate = SF_MIN, .coderate = CR_LORA_4_5
+    };
+    struct lgw_conf_scan_s scan_conf = { .enable = true, .nb_chan = NB_CHAN };
+    struct lgw_scan_stat_s stats[LGW_SCAN_CHAN_NB];
+    struct lgw_pkt_rx_s    pkt;
+    pthread_t              radio;
+    uint32_t               idle_cad_sf[13];
+    uint32_t               sf;
+    int64_t                latency_us;
+    int64_t                sum_us = 0;
+    int                    nb_rx  = 0;
+    int                    errors = 0;
+    int                    seq    = 0;
+    int                    nb_stat;
+    int                    chan;
+    int                    i;
+    bool                   ok;
+
+    memcpy( scan_conf.freq_hz, chan_freq_hz, sizeof( chan_freq_hz ) );
+    for( sf = SF_MIN; sf <= SF_MAX; sf++ )
+    {
+        scan_conf.datarate_mask |= 1 << sf;
+    }
+
+    pthread_create( &radio, NULL, radio_thread, NULL );
+    if( ( lgw_rxrf_setconf( &rxrf_conf ) != LGW_HAL_SUCCESS ) || ( lgw_rxif_setconf( &rxif_conf ) != LGW_HAL_SUCCESS ) ||
+        ( lgw_scan_setconf( &scan_conf ) != LGW_HAL_SUCCESS ) || ( lgw_start( ) != LGW_HAL_SUCCESS ) )
+    {
+        printf( "HAL start failed\n" );
+        return EXIT_FAILURE;
+    }
+
+    /* every slot in turn, PKT_PER_SLOT times */
+    for( i = 0; i < PKT_PER_SLOT; i++ )
+    {
+        for( sf = SF_MIN; sf <= SF_MAX; sf++ )
+        {
+            for( chan = 0; chan < NB_CHAN; chan++ )
+            {
+                latency_us = receive_one( seq++, chan, sf );
+                if( latency_us < 0 )
+                {
+                    errors++;
+                    continue;
+                }
+                sum_us += latency_us;
+                nb_rx += 1;
+            }
+        }
+    }
+    printf( "%d packets on %d channels at SF%d to SF%d: %d received with their slot, RX done to lgw_receive() %.2f ms  %s\n",
+            seq, NB_CHAN, SF_MIN, SF_MAX, nb_rx, ( nb_rx > 0 ) ? ( double ) sum_us / nb_rx / 1000.0 : 0.0,
+            ( errors == 0 ) ? "ok" : "FAILED" );
+
+    /* no traffic: CADs per SF, and a packet at an SF outside the list */
+    pthread_mutex_lock( &radio_lock );
+    memcpy( idle_cad_sf, nb_cad_sf, sizeof( idle_cad_sf ) );
+    pending_freq_hz = chan_freq_hz[0];
+    pending_sf      = SF_OUT;
+    pending_seq     = seq;
+    pthread_mutex_unlock( &radio_lock );
+    vTaskDelay( pdMS_TO_TICKS( IDLE_MS ) );
+    pthread_mutex_lock( &radio_lock );
+    pending_seq = -1;
+    for( sf = SF_MIN; sf <= SF_MAX; sf++ )
+    {
+        idle_cad_sf[sf] = nb_cad_sf[sf] - idle_cad_sf[sf];
+    }
+    pthread_mutex_unlock( &radio_lock );
+    ok = ( ( idle_cad_sf[SF_MIN] * 10 > idle_cad_sf[SF_MIN + 1] * 16 ) &&
+          ( idle_cad_sf[SF_MIN] * 10 < idle_cad_sf[SF_MIN + 1] * 24 ) &&
+          ( idle_cad_sf[SF_MIN + 1] * 10 > idle_cad_sf[SF_MAX] * 16 ) &&
+          ( idle_cad_sf[SF_MIN + 1] * 10 < idle_cad_sf[SF_MAX] * 24 ) && ( nb_cad_sf[SF_OUT] == 0 ) &&
+          ( lgw_receive( 1, &pkt ) == 0 ) );
+    errors += ( ok == false );
+    printf( "%d ms without traffic: SF7 %lu, SF8 %lu, SF9 %lu CADs, SF%d never listened to  %s\n", IDLE_MS,
+            ( unsigned long ) idle_cad_sf[7], ( unsigned long ) idle_cad_sf[8], ( unsigned long ) idle_cad_sf[9],
+            SF_OUT, ok ? "ok" : "FAILED" );
+
+    /* stop the radio, then let the RX task arm its last CAD */
+    pthread_mutex_lock( &radio_lock );
+    radio_stop = true;
+    pthread_cond_signal( &radio_cond );
+    pthread_mutex_unlock( &radio_lock );
+    pthread_join( radio, NULL );
+    vTaskDelay( pdMS_TO_TICKS( 20 ) );
+
+    nb_stat = lgw_scan_get_stats( stats, LGW_SCAN_CHAN_NB );
+    ok      = ( nb_stat == NB_CHAN );
+    for( chan = 0; chan < nb_stat; chan++ )
+    {
+        ok = ok && ( stats[chan].freq_hz == chan_freq_hz[chan] ) &&
+            ( stats[chan].nb_detect == PKT_PER_SLOT * ( SF_MAX - SF_MIN + 1 ) ) &&
+            ( stats[chan].nb_rx_ok == stats[chan].nb_detect ) && ( stats[chan].nb_rx_bad == 0 );
+        nb_cad -= stats[chan].nb_cad;
+    }
+    ok = ok && ( nb_cad == 0 );
+    errors += ( ok == false );
+    printf( "scan statistics:" );
+    for( chan = 0; chan < nb_stat; chan++ )
+    {
+        printf( " [%lu Hz: %lu CAD, %lu detected, %lu ok]", ( unsigned long ) stats[chan].freq_hz,
+                ( unsigned long ) stats[chan].nb_cad, ( unsigned long ) stats[chan].nb_detect,
+                ( unsigned long ) stats[chan].nb_rx_ok );
+    }
+    printf( "  %s\n", ok ? "ok" : "FAILED" );
+
+    /* one mod params write at start, then one per change of SF */
+    ok = ( nb_set_mod <= nb_sf_change + 1 );
+    errors += ( ok == false );
+    printf( "modulation rewritten %lu times for %lu changes of SF  %s\n", ( unsigned long ) nb_set_mod,
+            ( unsigned long ) nb_sf_change, ok ? "ok" : "FAILED" );
+
+    lgw_stop( );
+    return ( errors == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
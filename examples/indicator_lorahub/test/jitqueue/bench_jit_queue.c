@@ -0,0 +1,207 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+  (C)2019 Semtech
+
+Description:
+    Host benchmark of the JiT queue and of the JiT thread wakeups
+
+    Class A downlinks are fed to the queue on a simulated concentrator clock,
+    once from 0 and once across the 32-bit roll-over. The JiT thread wakes up
+    when jit_peek_delay() says the head is due, or when thread_down notifies
+    it of a new packet. Built with JIT_QUEUE_QSORT against the qsort based
+    queue in qsort/, the thread polls every 10 ms instead, as it did with that
+    queue.
+
+    Reported: enqueue results, TX sequence checksum (the same in both builds
+    when the decisions are), thread wakeups, how late each packet is handed
+    to the concentrator after its TX_JIT_DELAY deadline, and the time of an
+    enqueue attempt into a queue of 31 packets.
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include <stdint.h> /* C99 types */
+#include <stdio.h>  /* printf */
+#include <stdlib.h> /* rand */
+#include <string.h> /* memset */
+#include <time.h>   /* clock_gettime */
+
+#include "jitqueue.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define NB_DOWNLINKS 20000
+#define NB_ATTEMPTS 200000
+#define TX_JIT_DELAY 30000 /* as in jitqueue.c */
+#define JIT_WAIT_MAX_MS 1000
+#define JIT_POLL_MS 10 /* thread_jit period with the qsort queue */
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static struct jit_queue_s queue;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+/* time on air in ms, carried by the packet size so that every packet picks its own */
+uint32_t lgw_time_on_air( const struct lgw_pkt_tx_s* packet )
+{
+    return packet->size;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static double now_ns( void )
+{
+    struct timespec t;
+
+    clock_gettime( CLOCK_MONOTONIC, &t );
+    return ( double ) t.tv_sec * 1e9 + ( double ) t.tv_nsec;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Next thread_jit wakeup after time_us, when nothing is enqueued in between */
+static uint32_t next_wakeup( uint32_t time_us )
+{
+#if defined( JIT_QUEUE_QSORT )
+    return time_us + JIT_POLL_MS * 1000;
+#else
+    uint32_t delay_us;
+
+    if( jit_peek_delay( &queue, time_us, &delay_us ) != JIT_ERROR_OK )
+    {
+        delay_us = JIT_WAIT_MAX_MS * 1000;
+    }
+    return time_us + ( delay_us + 999 ) / 1000 * 1000; /* ulTaskNotifyTake() sleeps whole ticks */
+#endif
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void simulate( uint32_t t0 )
+{
+    struct lgw_pkt_tx_s pkt;
+    enum jit_pkt_type_e pkt_type;
+    enum jit_error_e    err;
+    uint32_t            arrival_us = t0;
+    uint32_t            time_us    = t0;
+    uint32_t            wakeup_us  = t0;
+    unsigned            nb_result[JIT_ERROR_INVALID + 1] = { 0 };
+    unsigned            nb_wakeups = 0;
+    unsigned            nb_sent    = 0;
+    uint64_t            checksum   = 0;
+    double              late_sum   = 0;
+    int32_t             late_max   = 0;
+    int32_t             late;
+    int                 k   = 0;
+    int                 idx;
+
+    srand( 1 );
+    jit_queue_init( &queue );
+    arrival_us += rand( ) % 150000;
+
+    while( ( k < NB_DOWNLINKS ) || ( jit_queue_is_empty( &queue ) == false ) )
+    {
+        if( ( k < NB_DOWNLINKS ) && ( ( int32_t ) ( arrival_us - wakeup_us ) <= 0 ) )
+        {
+            /* thread_down: PULL_RESP for RX1 or RX2 of an uplink received up to 500 ms ago */
+            time_us = arrival_us;
+            memset( &pkt, 0, sizeof( pkt ) );
+            pkt.count_us = time_us + ( ( rand( ) % 2 ) ? 1000000 : 2000000 ) - 200000 - rand( ) % 300000;
+            pkt.size     = 30 + rand( ) % 120;
+            pkt.tx_mode  = TIMESTAMPED;
+            err          = jit_enqueue( &queue, time_us, &pkt, JIT_PKT_TYPE_DOWNLINK_CLASS_A );
+            nb_result[err]++;
+            k++;
+            arrival_us += rand( ) % 150000;
+#if !defined( JIT_QUEUE_QSORT )
+            if( err == JIT_ERROR_OK )
+            {
+                wakeup_us = time_us; /* notified */
+            }
+#endif
+            continue;
+        }
+
+        /* thread_jit */
+        time_us = wakeup_us;
+        nb_wakeups++;
+        while( ( jit_peek( &queue, time_us, &idx ) == JIT_ERROR_OK ) && ( idx >= 0 ) )
+        {
+            jit_dequeue( &queue, idx, &pkt, &pkt_type );
+            late = ( int32_t ) ( time_us - ( pkt.count_us - TX_JIT_DELAY ) );
+            late_sum += late;
+            late_max = ( late > late_max ) ? late : late_max;
+            checksum = checksum * 31 + pkt.count_us;
+            nb_sent++;
+        }
+        wakeup_us = next_wakeup( time_us );
+    }
+
+    printf( "t0=0x%08lX: %u ok, %u collisions, %u too late, %u sent (checksum %016llX)\n", ( unsigned long ) t0,
+            nb_result[JIT_ERROR_OK], nb_result[JIT_ERROR_COLLISION_PACKET], nb_result[JIT_ERROR_TOO_LATE], nb_sent,
+            ( unsigned long long ) checksum );
+    printf( "    %u wakeups, handed over late by %.2f ms on average, %.2f ms at most\n", nb_wakeups,
+            late_sum / nb_sent / 1000, late_max / 1000.0 );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void enqueue_cost( void )
+{
+    struct lgw_pkt_tx_s pkt;
+    enum jit_pkt_type_e pkt_type;
+    double              start;
+    int                 i;
+
+    jit_queue_init( &queue );
+    for( i = 0; i < JIT_QUEUE_MAX - 1; i++ )
+    {
+        memset( &pkt, 0, sizeof( pkt ) );
+        pkt.size     = 50;
+        pkt.count_us = 1000000 + i * 100000;
+        jit_enqueue( &queue, 0, &pkt, JIT_PKT_TYPE_DOWNLINK_CLASS_A );
+    }
+
+    /* mostly collisions, every accepted packet is dequeued back to stay at 31 */
+    start = now_ns( );
+    for( i = 0; i < NB_ATTEMPTS; i++ )
+    {
+        memset( &pkt, 0, sizeof( pkt ) );
+        pkt.size     = 50;
+        pkt.count_us = 1000000 + ( i % 3100 ) * 1000;
+        if( jit_enqueue( &queue, 0, &pkt, JIT_PKT_TYPE_DOWNLINK_CLASS_A ) == JIT_ERROR_OK )
+        {
+            jit_dequeue( &queue, 0, &pkt, &pkt_type );
+        }
+    }
+    printf( "enqueue attempt into 31 packets: %.0f ns\n", ( now_ns( ) - start ) / NB_ATTEMPTS );
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main( void )
+{
+#if defined( JIT_QUEUE_QSORT )
+    printf( "qsort queue, JiT thread polling every %d ms\n", JIT_POLL_MS );
+#else
+    printf( "sorted queue, JiT thread woken by jit_peek_delay() and thread_down\n" );
+#endif
+    simulate( 0 );
+    simulate( 0xFFFFFFFFUL - 600000000UL ); /* wraps 10 minutes in */
+    enqueue_cost( );
+    return EXIT_SUCCESS;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,317 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+  (C)2019 Semtech
+
+Description:
+    Host test of the JiT queue, checked against an exhaustive collision search
+
+    jitqueue.c is compiled into this file to reach its private helpers. A
+    random stream of class A, class C and beacon packets is enqueued while the
+    concentrator time moves forward, and due packets are peeked and dequeued
+    as thread_jit does, once from 0 and once across the 32-bit roll-over.
+
+    Every class A and beacon enqueue must return what testing the packet
+    against every queued node gives, where jit_enqueue() only tests the
+    closest downlinks and the beacons. After every call, the order[] array
+    must be sorted and match the free node bitmap, queued downlinks must not
+    overlap, and jit_peek_delay() must agree with jit_peek().
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include <stdlib.h> /* rand */
+
+#include "esp_log.h"
+
+/* count the packets jit_peek() drops instead of logging them */
+static unsigned nb_dropped = 0;
+#undef ESP_LOGW
+#define ESP_LOGW( tag, ... ) ( nb_dropped++ )
+
+#include "jitqueue.c"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define NB_STEPS 200000 /* packets offered per run */
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static struct jit_queue_s queue;
+static unsigned           nb_errors = 0;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+/* time on air in ms, carried by the packet size so that every packet picks its own */
+uint32_t lgw_time_on_air( const struct lgw_pkt_tx_s* packet )
+{
+    return packet->size;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void fail( const char* what, uint32_t time_us, uint32_t count_us )
+{
+    if( nb_errors++ < 10 )
+    {
+        printf( "FAILED at %lu: %s (count_us=%lu)\n", ( unsigned long ) time_us, what, ( unsigned long ) count_us );
+    }
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* What jit_enqueue() must return for a packet at count_us, testing every queued node */
+static enum jit_error_e expected_enqueue( uint32_t time_us, uint32_t count_us, uint32_t pre_delay,
+                                          uint32_t post_delay, enum jit_pkt_type_e pkt_type )
+{
+    bool beacon = false;
+    int  i;
+
+    if( queue.num_pkt == JIT_QUEUE_MAX )
+    {
+        return JIT_ERROR_FULL;
+    }
+    if( ( count_us - time_us ) <= ( TX_START_DELAY + TX_MARGIN_DELAY + TX_JIT_DELAY ) )
+    {
+        return JIT_ERROR_TOO_LATE;
+    }
+    if( ( pkt_type == JIT_PKT_TYPE_DOWNLINK_CLASS_A ) && ( ( count_us - time_us ) > TX_MAX_ADVANCE_DELAY ) )
+    {
+        return JIT_ERROR_TOO_EARLY;
+    }
+    for( i = 0; i < queue.num_pkt; i++ )
+    {
+        if( jit_collides_with( JIT_NODE( &queue, i ), count_us, pre_delay, post_delay, pkt_type ) == true )
+        {
+            if( JIT_NODE( &queue, i )->pkt_type != JIT_PKT_TYPE_BEACON )
+            {
+                return JIT_ERROR_COLLISION_PACKET;
+            }
+            beacon = true;
+        }
+    }
+    return ( beacon == true ) ? JIT_ERROR_COLLISION_BEACON : JIT_ERROR_OK;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static bool collides_with_queue( uint32_t count_us, uint32_t pre_delay, uint32_t post_delay,
+                                 enum jit_pkt_type_e pkt_type )
+{
+    return expected_enqueue( count_us - TX_MAX_ADVANCE_DELAY / 2, count_us, pre_delay, post_delay, pkt_type ) >=
+           JIT_ERROR_COLLISION_PACKET;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void check_queue( uint32_t time_us )
+{
+    uint32_t used = 0;
+    int      nb_beacon = 0;
+    int      i, j;
+    uint32_t delay_us;
+    int      idx;
+
+    for( i = 0; i < queue.num_pkt; i++ )
+    {
+        if( ( ( queue.free_nodes | used ) & ( 1UL << queue.order[i] ) ) != 0 )
+        {
+            fail( "order[] holds a free or repeated node", time_us, JIT_NODE( &queue, i )->pkt.count_us );
+        }
+        used |= 1UL << queue.order[i];
+        nb_beacon += ( JIT_NODE( &queue, i )->pkt_type == JIT_PKT_TYPE_BEACON );
+        if( ( i > 0 ) &&
+            ( ( int32_t ) ( JIT_NODE( &queue, i )->pkt.count_us - JIT_NODE( &queue, i - 1 )->pkt.count_us ) < 0 ) )
+        {
+            fail( "order[] not sorted", time_us, JIT_NODE( &queue, i )->pkt.count_us );
+        }
+        for( j = 0; j < i; j++ )
+        {
+            if( ( JIT_NODE( &queue, i )->pkt_type != JIT_PKT_TYPE_BEACON ) &&
+                ( JIT_NODE( &queue, j )->pkt_type != JIT_PKT_TYPE_BEACON ) &&
+                ( jit_collides_with( JIT_NODE( &queue, j ), JIT_NODE( &queue, i )->pkt.count_us,
+                                     JIT_NODE( &queue, i )->pre_delay, JIT_NODE( &queue, i )->post_delay,
+                                     JIT_NODE( &queue, i )->pkt_type ) == true ) )
+            {
+                fail( "queued downlinks overlap", time_us, JIT_NODE( &queue, i )->pkt.count_us );
+            }
+        }
+    }
+    if( ( ( used | queue.free_nodes ) != 0xFFFFFFFFUL ) || ( nb_beacon != queue.num_beacon ) )
+    {
+        fail( "free_nodes or num_beacon out of step with order[]", time_us, 0 );
+    }
+
+    /* the JiT thread sleeps delay_us, then jit_peek() must hand over the head, and not a microsecond before */
+    if( ( jit_peek_delay( &queue, time_us, &delay_us ) == JIT_ERROR_OK ) && ( delay_us > 0 ) )
+    {
+        if( ( jit_peek( &queue, time_us + delay_us - 1, &idx ) != JIT_ERROR_OK ) || ( idx != -1 ) ||
+            ( jit_peek( &queue, time_us + delay_us, &idx ) != JIT_ERROR_OK ) || ( idx != 0 ) )
+        {
+            fail( "jit_peek_delay() disagrees with jit_peek()", time_us, JIT_NODE( &queue, 0 )->pkt.count_us );
+        }
+    }
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Sends what is due at time_us, as thread_jit does. Returns the number of packets dequeued. */
+static int send_due( uint32_t time_us )
+{
+    struct lgw_pkt_tx_s pkt;
+    enum jit_pkt_type_e pkt_type;
+    uint32_t            head_us;
+    int                 idx;
+    int                 nb_sent = 0;
+
+    while( ( jit_peek( &queue, time_us, &idx ) == JIT_ERROR_OK ) && ( idx >= 0 ) )
+    {
+        head_us = JIT_NODE( &queue, 0 )->pkt.count_us;
+        if( ( jit_dequeue( &queue, idx, &pkt, &pkt_type ) != JIT_ERROR_OK ) || ( pkt.count_us != head_us ) )
+        {
+            fail( "jit_dequeue() did not return the peeked packet", time_us, head_us );
+        }
+        nb_sent++;
+    }
+    check_queue( time_us );
+    return nb_sent;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void run( uint32_t t0 )
+{
+    struct lgw_pkt_tx_s pkt;
+    enum jit_pkt_type_e pkt_type;
+    enum jit_error_e    expected;
+    enum jit_error_e    err;
+    uint32_t            time_us = t0;
+    uint32_t            pre_delay;
+    uint32_t            post_delay;
+    unsigned            nb_result[JIT_ERROR_INVALID + 1] = { 0 };
+    unsigned            nb_sent = 0;
+    int                 step;
+    int                 r;
+
+    jit_queue_init( &queue );
+    nb_dropped = 0;
+
+    for( step = 0; step < NB_STEPS; step++ )
+    {
+        time_us += rand( ) % 25000; /* within the TX_JIT_DELAY window, so nothing due is missed */
+        nb_sent += send_due( time_us );
+
+        /* the JiT thread sometimes misses a packet, jit_peek() must then drop it */
+        if( rand( ) % 2000 == 0 )
+        {
+            time_us += 100000;
+        }
+
+        memset( &pkt, 0, sizeof( pkt ) );
+        pkt.size = 10 + rand( ) % 400; /* time on air, ms */
+        r        = rand( ) % 100;
+        if( r < 2 )
+        {
+            /* beacons, at most JIT_NUM_BEACON_IN_QUEUE, as pkt_fwd.c loads them */
+            if( queue.num_beacon == JIT_NUM_BEACON_IN_QUEUE )
+            {
+                continue;
+            }
+            pkt_type     = JIT_PKT_TYPE_BEACON;
+            pkt.count_us = time_us + 4000000 + ( uint32_t ) rand( ) % 120000000;
+            pre_delay    = TX_START_DELAY + BEACON_GUARD + TX_JIT_DELAY;
+            post_delay   = BEACON_RESERVED;
+        }
+        else if( r < 4 )
+        {
+            pkt_type   = JIT_PKT_TYPE_DOWNLINK_CLASS_C;
+            pkt.tx_mode = IMMEDIATE;
+            pre_delay  = TX_START_DELAY + TX_JIT_DELAY;
+            post_delay = pkt.size * 1000;
+        }
+        else
+        {
+            /* RX1 or RX2 of an uplink received up to 400 ms ago, now and then a late or far off timestamp */
+            pkt_type     = JIT_PKT_TYPE_DOWNLINK_CLASS_A;
+            pkt.count_us = time_us + ( ( rand( ) % 2 ) ? 1000000 : 2000000 ) - ( uint32_t ) rand( ) % 400000;
+            if( r == 99 )
+            {
+                pkt.count_us = time_us + ( uint32_t ) rand( ) % 40000;
+            }
+            else if( ( r == 98 ) && ( rand( ) % 20 == 0 ) )
+            {
+                pkt.count_us = time_us + TX_MAX_ADVANCE_DELAY - 2000000 + ( uint32_t ) rand( ) % 4000000;
+            }
+            pre_delay  = TX_START_DELAY + TX_JIT_DELAY;
+            post_delay = pkt.size * 1000;
+        }
+
+        if( pkt_type == JIT_PKT_TYPE_DOWNLINK_CLASS_C )
+        {
+            err = jit_enqueue( &queue, time_us, &pkt, pkt_type );
+            if( err == JIT_ERROR_OK )
+            {
+                /* the ASAP slot must be at least 1 s ahead and overlap nothing; remove it to test that */
+                if( ( int32_t ) ( pkt.count_us - ( time_us + 1000000 ) ) < 0 )
+                {
+                    fail( "class C slot earlier than now + 1 s", time_us, pkt.count_us );
+                }
+                jit_remove( &queue, jit_search( &queue, pkt.count_us ) );
+                if( collides_with_queue( pkt.count_us, pre_delay, post_delay, pkt_type ) == true )
+                {
+                    fail( "class C slot overlaps a queued packet", time_us, pkt.count_us );
+                }
+                if( jit_enqueue( &queue, time_us, &pkt, JIT_PKT_TYPE_DOWNLINK_CLASS_A ) != JIT_ERROR_OK )
+                {
+                    fail( "class C packet not enqueued back", time_us, pkt.count_us );
+                }
+            }
+            else if( err != JIT_ERROR_FULL )
+            {
+                fail( "class C packet rejected", time_us, pkt.count_us );
+            }
+        }
+        else
+        {
+            expected = expected_enqueue( time_us, pkt.count_us, pre_delay, post_delay, pkt_type );
+            err      = jit_enqueue( &queue, time_us, &pkt, pkt_type );
+            if( err != expected )
+            {
+                fail( "jit_enqueue() result differs from the exhaustive search", time_us, pkt.count_us );
+            }
+        }
+        nb_result[err]++;
+        check_queue( time_us );
+    }
+
+    printf( "t0=0x%08lX: %u ok, %u too late, %u too early, %u full, %u packet and %u beacon collisions, %u sent, "
+            "%u dropped\n",
+            ( unsigned long ) t0, nb_result[JIT_ERROR_OK], nb_result[JIT_ERROR_TOO_LATE],
+            nb_result[JIT_ERROR_TOO_EARLY], nb_result[JIT_ERROR_FULL], nb_result[JIT_ERROR_COLLISION_PACKET],
+            nb_result[JIT_ERROR_COLLISION_BEACON], nb_sent, nb_dropped );
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main( void )
+{
+    srand( 1 );
+    run( 0 );
+    run( 0xFFFFFFFFUL - 600000000UL ); /* wraps 10 minutes in */
+
+    printf( "jit_enqueue() against the exhaustive search, queue invariants: %s\n",
+            ( nb_errors == 0 ) ? "ok" : "FAILED" );
+    return ( nb_errors == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
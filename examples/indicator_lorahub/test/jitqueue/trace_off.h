@@ -0,0 +1,31 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+  (C)2019 Semtech
+
+Description:
+    Forced-in ahead of trace.h (-include) to keep the JiT traces out of the
+    measurements: DEBUG_JIT_ERROR prints every rejected downlink, thousands
+    per run, and the printing would outweigh the queue itself
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+#ifndef _LORA_PKTFWD_TRACE_H
+#define _LORA_PKTFWD_TRACE_H
+
+#define DEBUG_PKT_FWD 0
+#define DEBUG_JIT 0
+#define DEBUG_JIT_ERROR 0
+#define DEBUG_TIMERSYNC 0
+#define DEBUG_BEACON 0
+#define DEBUG_LOG 0
+
+#define MSG_DEBUG( FLAG, fmt, ... )
+#define MSG_PRINTF( FLAG, fmt, ... )
+
+#endif
+/* --- EOF ------------------------------------------------------------------ */
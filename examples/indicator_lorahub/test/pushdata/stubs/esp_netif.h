@@ -0,0 +1,5 @@
+/* Host stand-in for the ESP-IDF header. On the target, lwIP's socket headers bring errno and strerror() in. */
+#pragma once
+
+#include <errno.h>
+#include <string.h>
@@ -0,0 +1,16 @@
+/* Host stand-in for the ESP-IDF header, the MAC address is only read with CONFIG_GATEWAY_ID_AUTO */
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef enum
+{
+    WIFI_IF_STA,
+} wifi_interface_t;
+
+static inline esp_err_t esp_wifi_get_mac( wifi_interface_t ifx, uint8_t mac[6] )
+{
+    return ESP_FAIL;
+}
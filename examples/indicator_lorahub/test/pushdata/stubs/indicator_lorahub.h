@@ -0,0 +1,49 @@
+/* Host stand-in for the Indicator application headers used by the packet forwarder: view events go nowhere and
+ * wait_on_error() is provided by the test */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#define LORAHUB_LOG_LEVEL_INFO 0
+#define LORAHUB_LOG_LEVEL_WARN 1
+#define LORAHUB_LOG_LEVEL_ERROR 2
+
+struct view_data_lorahub_log
+{
+    uint8_t level;
+    uint8_t data[128];
+};
+
+enum
+{
+    VIEW_EVENT_LORAHUB_EUI,
+    VIEW_EVENT_LORAHUB_MONITOR,
+};
+
+typedef void* esp_event_loop_handle_t;
+typedef const char* esp_event_base_t;
+
+static const esp_event_base_t  VIEW_EVENT_BASE   = "VIEW_EVENT_BASE";
+static esp_event_loop_handle_t view_event_handle = NULL;
+
+static inline esp_err_t esp_event_post_to( esp_event_loop_handle_t loop, esp_event_base_t base, int32_t id,
+                                           const void* data, size_t size, TickType_t ticks_to_wait )
+{
+    return ESP_OK;
+}
+
+typedef enum
+{
+    LRHB_ERROR_NONE,
+    LRHB_ERROR_WIFI,
+    LRHB_ERROR_LNS,
+    LRHB_ERROR_OS,
+    LRHB_ERROR_HAL,
+    LRHB_ERROR_UNKNOWN,
+} lorahub_error_t;
+
+void wait_on_error( lorahub_error_t error, int line );
@@ -0,0 +1,38 @@
+/* Host stand-in for the ESP-IDF header, the configuration is only read from NVS with CONFIG_GET_CFG_FROM_FLASH */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum
+{
+    NVS_READONLY,
+} nvs_open_mode_t;
+
+static inline esp_err_t nvs_open( const char* name, nvs_open_mode_t mode, nvs_handle_t* handle )
+{
+    return ESP_FAIL;
+}
+
+static inline esp_err_t nvs_get_str( nvs_handle_t handle, const char* key, char* value, size_t* length )
+{
+    return ESP_FAIL;
+}
+
+static inline esp_err_t nvs_get_u16( nvs_handle_t handle, const char* key, uint16_t* value )
+{
+    return ESP_FAIL;
+}
+
+static inline esp_err_t nvs_get_u32( nvs_handle_t handle, const char* key, uint32_t* value )
+{
+    return ESP_FAIL;
+}
+
+static inline void nvs_close( nvs_handle_t handle )
+{
+}
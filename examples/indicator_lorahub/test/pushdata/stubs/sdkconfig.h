@@ -0,0 +1,12 @@
+/* Host build configuration of the packet forwarder: custom gateway ID, one channel, no scan, no NVS */
+#pragma once
+
+#define CONFIG_NETWORK_SERVER_ADDRESS "127.0.0.1"
+#define CONFIG_NETWORK_SERVER_PORT 1700
+#define CONFIG_GATEWAY_ID_CUSTOM "0016C001FF1E5A5A"
+#define CONFIG_CHANNEL_FREQ_HZ 868100000
+#define CONFIG_CHANNEL_LORA_DATARATE 7
+#define CONFIG_CHANNEL_LORA_BANDWIDTH 125
+#ifndef CONFIG_PUSH_DATA_BATCH_MS
+#define CONFIG_PUSH_DATA_BATCH_MS 20
+#endif
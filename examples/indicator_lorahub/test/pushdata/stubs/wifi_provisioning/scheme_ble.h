@@ -0,0 +1,2 @@
+/* Host stand-in for the ESP-IDF header */
+#pragma once
@@ -0,0 +1,438 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+  (C)2019 Semtech
+
+Description:
+    Host test and benchmark of the packet forwarder upstream path (thread_up)
+
+    pkt_fwd.c is compiled into this file so that thread_up() can run as is on
+    a socket connected to a network server stand-in: a loopback UDP server
+    that checks every PUSH_DATA and acknowledges it, optionally after a delay.
+    A fake HAL hands out numbered packets through lgw_receive() and
+    lgw_receive_wait().
+
+    The test checks the number writers against the snprintf() formats they
+    replaced, then that every packet comes out once, in order, with its
+    timestamp, frequency (2.4 GHz included) and payload. The benchmark sends
+    packets as fast as thread_up takes them and reports packets per second,
+    datagrams and thread_up CPU time per packet.
+
+    Built with CONFIG_PUSH_DATA_BATCH_MS=0 and ONE_PKT_PER_RECEIVE, the same
+    program runs the forwarder the way it was before batching, one packet per
+    datagram.
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include "pkt_fwd.c"
+
+#include <fcntl.h>  /* open */
+#include <unistd.h> /* dup, usleep */
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define NB_VALUES 2000000 /* random values compared with snprintf() */
+#define TEST_PKT 1000     /* packets checked one by one */
+#define BENCH_PKT 20000   /* packets sent for throughput */
+#define ACK_DELAY_US 200  /* network server processing time before the PUSH_ACK */
+#define PAYLOAD_SIZE 20
+
+#if defined( ONE_PKT_PER_RECEIVE )
+#define RECEIVE_MAX 1 /* the HAL before the RX ring returned one packet per call */
+#else
+#define RECEIVE_MAX NB_PKT_MAX
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+volatile bool exit_sig = false;
+
+/* fake HAL */
+static pthread_mutex_t hal_lock    = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t        hal_next    = 0; /* next packet handed to lgw_receive() */
+static uint32_t        hal_nb_pkt  = 0; /* packets of the current run */
+static uint32_t        hal_freq_hz = 868100000;
+
+/* network server stand-in */
+static int             ns_sock;
+static uint32_t        ns_ack_delay_us = 0;
+static uint32_t        ns_expected     = 0; /* next packet number expected */
+static uint32_t        ns_nb_dgram     = 0;
+static uint32_t        ns_errors       = 0;
+static struct timespec ns_first;
+static struct timespec ns_last;
+
+/* thread_up CPU time, read by the thread itself when thread_up() returns */
+static struct timespec up_cpu;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+void wait_on_error( lorahub_error_t error, int line )
+{
+    fprintf( stderr, "wait_on_error(%d) from pkt_fwd.c line %d\n", error, line );
+    exit( EXIT_FAILURE );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void fill_pkt( struct lgw_pkt_rx_s* p, uint32_t n )
+{
+    int i;
+
+    memset( p, 0, sizeof( struct lgw_pkt_rx_s ) );
+    p->freq_hz    = hal_freq_hz;
+    p->status     = STAT_CRC_OK;
+    p->count_us   = n * 1000;
+    p->modulation = MOD_LORA;
+    p->bandwidth  = BW_125KHZ;
+    p->datarate   = DR_LORA_SF7;
+    p->coderate   = CR_LORA_4_5;
+    p->rssic      = -87.0f;
+    p->snr        = 7.0f;
+    p->size       = PAYLOAD_SIZE;
+    p->payload[0] = 0x40; /* unconfirmed data up, DevAddr and FCnt as thread_up logs them */
+    p->payload[1] = ( uint8_t ) n;
+    p->payload[2] = ( uint8_t ) ( n >> 8 );
+    p->payload[3] = ( uint8_t ) ( n >> 16 );
+    p->payload[4] = 0x26;
+    p->payload[6] = ( uint8_t ) n;
+    p->payload[7] = ( uint8_t ) ( n >> 8 );
+    for( i = 8; i < PAYLOAD_SIZE; i++ )
+    {
+        p->payload[i] = ( uint8_t ) ( n + i );
+    }
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static double seconds( const struct timespec* t )
+{
+    return ( double ) t->tv_sec + ( double ) t->tv_nsec / 1e9;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Checks one rxpk object of a PUSH_DATA against the packet it should carry */
+static bool check_rxpk( const char* rxpk, uint32_t n )
+{
+    struct lgw_pkt_rx_s p;
+    char                expected[512];
+    char                b64[64];
+
+    fill_pkt( &p, n );
+    bin_to_b64( p.payload, p.size, b64, sizeof( b64 ) );
+    snprintf( expected, sizeof( expected ),
+              "{\"jver\":1,\"tmst\":%lu,\"chan\":0,\"rfch\":0,\"freq\":%.6lf,\"stat\":1,\"modu\":\"LORA\","
+              "\"datr\":\"SF7BW125\",\"codr\":\"4/5\",\"lsnr\":%.1f,\"rssi\":%.0f,\"size\":%u,\"data\":\"%s\"}",
+              ( unsigned long ) p.count_us, ( double ) p.freq_hz / 1e6, p.snr, roundf( p.rssic ), p.size, b64 );
+    return strncmp( rxpk, expected, strlen( expected ) ) == 0;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void* ns_thread( void* arg )
+{
+    static uint8_t     dgram[TX_BUFF_SIZE + 1];
+    struct sockaddr_in from;
+    socklen_t          from_len;
+    const char*        rxpk;
+    uint32_t           n;
+    int                len;
+
+    while( 1 )
+    {
+        from_len = sizeof( from );
+        len      = recvfrom( ns_sock, dgram, TX_BUFF_SIZE, 0, ( struct sockaddr* ) &from, &from_len );
+        if( len < 12 )
+        {
+            continue;
+        }
+        dgram[len] = 0;
+        if( ( dgram[0] != PROTOCOL_VERSION ) || ( dgram[3] != PKT_PUSH_DATA ) ||
+            ( memcmp( dgram + 12, "{\"rxpk\":[", 9 ) != 0 ) || ( dgram[len - 2] != ']' ) ||
+            ( dgram[len - 1] != '}' ) )
+        {
+            if( ns_errors++ == 0 )
+            {
+                fprintf( stderr, "malformed PUSH_DATA: %s\n", ( char* ) dgram + 12 );
+            }
+            continue;
+        }
+        if( ns_nb_dgram++ == 0 )
+        {
+            clock_gettime( CLOCK_MONOTONIC, &ns_first );
+        }
+
+        /* one rxpk object per packet, in order */
+        rxpk = ( const char* ) dgram + 12 + 9;
+        do
+        {
+            n = ns_expected++;
+            if( check_rxpk( rxpk, n ) == false )
+            {
+                if( ns_errors++ == 0 )
+                {
+                    fprintf( stderr, "packet %u: %s\n", n, rxpk );
+                }
+            }
+            rxpk = strstr( rxpk, "},{" );
+            rxpk = ( rxpk != NULL ) ? rxpk + 2 : NULL;
+        } while( rxpk != NULL );
+        if( ns_expected >= hal_nb_pkt )
+        {
+            exit_sig = true;
+        }
+
+        if( ns_ack_delay_us > 0 )
+        {
+            usleep( ns_ack_delay_us );
+        }
+        dgram[3] = PKT_PUSH_ACK;
+        sendto( ns_sock, dgram, 4, 0, ( struct sockaddr* ) &from, from_len );
+        clock_gettime( CLOCK_MONOTONIC, &ns_last );
+    }
+    return NULL;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void* up_thread( void* arg )
+{
+    thread_up( );
+    clock_gettime( CLOCK_THREAD_CPUTIME_ID, &up_cpu );
+    return NULL;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Forwards nb_pkt packets through thread_up(), its console output discarded. Returns the number of errors. */
+static int forward( uint32_t nb_pkt, uint32_t ack_delay_us )
+{
+    pthread_t thread;
+    int       saved_stdout;
+    int       null_fd;
+
+    hal_next        = 0;
+    hal_nb_pkt      = nb_pkt;
+    ns_ack_delay_us = ack_delay_us;
+    ns_expected     = 0;
+    ns_nb_dgram     = 0;
+    ns_errors       = 0;
+    exit_sig        = false;
+
+    fflush( stdout );
+    saved_stdout = dup( STDOUT_FILENO );
+    null_fd      = open( "/dev/null", O_WRONLY );
+    dup2( null_fd, STDOUT_FILENO );
+
+    pthread_create( &thread, NULL, up_thread, NULL );
+    pthread_join( thread, NULL );
+
+    fflush( stdout );
+    dup2( saved_stdout, STDOUT_FILENO );
+    close( saved_stdout );
+    close( null_fd );
+
+    if( ns_expected != nb_pkt )
+    {
+        printf( "%u of %u packets reached the network server\n", ns_expected, nb_pkt );
+        return 1;
+    }
+    return ( ns_errors == 0 ) ? 0 : 1;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static int check_writers( void )
+{
+    char     a[32];
+    char     b[32];
+    uint32_t u;
+    int32_t  s;
+    float    f;
+    long     bad = 0;
+    long     k;
+    int      n;
+
+    srand( 1 );
+    for( k = 0; k < NB_VALUES; k++ )
+    {
+        u = ( uint32_t ) rand( ) * 7u + ( ( k & 1 ) ? 0 : ( uint32_t ) rand( ) );
+        n = json_write_uint( ( uint8_t* ) a, u );
+        a[n] = 0;
+        snprintf( b, sizeof( b ), "%lu", ( unsigned long ) u );
+        bad += ( strcmp( a, b ) != 0 );
+
+        /* rxpk freq, 150 MHz to 2.5 GHz */
+        u = 150000000u + ( uint32_t ) ( ( ( uint64_t ) rand( ) * 7u ) % 2350000000u );
+        n = json_write_ufixed( ( uint8_t* ) a, u, 6 );
+        a[n] = 0;
+        snprintf( b, sizeof( b ), "%.6lf", ( double ) u / 1e6 );
+        bad += ( strcmp( a, b ) != 0 );
+
+        /* rxpk lsnr, the HAL reports whole dB */
+        f = ( float ) ( rand( ) % 60 - 40 );
+        n = json_write_fixed( ( uint8_t* ) a, ( int32_t ) lroundf( f * 10 ), 1 );
+        a[n] = 0;
+        snprintf( b, sizeof( b ), "%.1f", f );
+        bad += ( strcmp( a, b ) != 0 );
+
+        /* rxpk rssi, snprintf wrote -0 for values rounding to 0 from below */
+        f = -( float ) ( rand( ) % 140 ) - 0.3f * ( float ) ( rand( ) % 3 );
+        s = ( int32_t ) lroundf( f );
+        n = json_write_int( ( uint8_t* ) a, s );
+        a[n] = 0;
+        snprintf( b, sizeof( b ), "%.0f", roundf( f ) );
+        bad += ( strcmp( a, ( strcmp( b, "-0" ) == 0 ) ? "0" : b ) != 0 );
+    }
+    printf( "number writers against snprintf, %d values each: %ld mismatches  %s\n", NB_VALUES, bad,
+            ( bad == 0 ) ? "ok" : "FAILED" );
+    return ( bad == 0 ) ? 0 : 1;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- FAKE HAL ------------------------------------------------------------- */
+
+int lgw_receive( uint8_t max_pkt, struct lgw_pkt_rx_s* pkt_data )
+{
+    int nb_pkt = 0;
+
+    pthread_mutex_lock( &hal_lock );
+    while( ( nb_pkt < max_pkt ) && ( nb_pkt < RECEIVE_MAX ) && ( hal_next < hal_nb_pkt ) )
+    {
+        fill_pkt( &pkt_data[nb_pkt], hal_next );
+        hal_next += 1;
+        nb_pkt += 1;
+    }
+    pthread_mutex_unlock( &hal_lock );
+    return nb_pkt;
+}
+
+int lgw_receive_wait( uint32_t timeout_ms )
+{
+    int nb_pkt;
+
+    pthread_mutex_lock( &hal_lock );
+    nb_pkt = ( int ) ( hal_nb_pkt - hal_next );
+    pthread_mutex_unlock( &hal_lock );
+    if( nb_pkt == 0 )
+    {
+        usleep( 1000 ); /* nothing more will come, only exit_sig matters */
+    }
+    return nb_pkt;
+}
+
+int lgw_get_instcnt( uint32_t* inst_cnt_us )
+{
+    *inst_cnt_us = 0;
+    return LGW_HAL_SUCCESS;
+}
+
+int lgw_rxrf_setconf( struct lgw_conf_rxrf_s* conf )
+{
+    return LGW_HAL_SUCCESS;
+}
+
+int lgw_rxif_setconf( struct lgw_conf_rxif_s* conf )
+{
+    return LGW_HAL_SUCCESS;
+}
+
+int lgw_scan_setconf( struct lgw_conf_scan_s* conf )
+{
+    return LGW_HAL_SUCCESS;
+}
+
+int lgw_scan_get_stats( struct lgw_scan_stat_s* stats, uint8_t max_chan )
+{
+    return 0;
+}
+
+int lgw_start( void )
+{
+    return LGW_HAL_SUCCESS;
+}
+
+int lgw_stop( void )
+{
+    return LGW_HAL_SUCCESS;
+}
+
+int lgw_send( struct lgw_pkt_tx_s* pkt_data )
+{
+    return LGW_HAL_ERROR;
+}
+
+int lgw_status( uint8_t rf_chain, uint8_t select, uint8_t* code )
+{
+    *code = 0;
+    return LGW_HAL_SUCCESS;
+}
+
+uint32_t lgw_time_on_air( const struct lgw_pkt_tx_s* packet )
+{
+    return 0;
+}
+
+void lgw_get_min_max_freq_hz( uint32_t* min_freq_hz, uint32_t* max_freq_hz )
+{
+    *min_freq_hz = 150000000;
+    *max_freq_hz = 960000000;
+}
+
+void lgw_get_min_max_power_dbm( int8_t* min_power_dbm, int8_t* max_power_dbm )
+{
+    *min_power_dbm = -9;
+    *max_power_dbm = 22;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main( void )
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl( INADDR_LOOPBACK ) };
+    socklen_t          addr_len = sizeof( addr );
+    pthread_t          ns;
+    double             wall_s;
+    int                errors = 0;
+
+    errors += check_writers( );
+
+    /* network server stand-in on an ephemeral loopback port, thread_up's socket connected to it */
+    ns_sock = socket( AF_INET, SOCK_DGRAM, 0 );
+    bind( ns_sock, ( struct sockaddr* ) &addr, sizeof( addr ) );
+    getsockname( ns_sock, ( struct sockaddr* ) &addr, &addr_len );
+    sock_up = socket( AF_INET, SOCK_DGRAM, 0 );
+    connect( sock_up, ( struct sockaddr* ) &addr, addr_len );
+    pthread_create( &ns, NULL, ns_thread, NULL );
+
+    hal_freq_hz = 868100000;
+    errors += forward( TEST_PKT, 0 );
+    hal_freq_hz = 2403000000u;
+    errors += forward( TEST_PKT, 0 );
+    printf( "%d packets at 868.1 then 2403 MHz, through thread_up: %s\n", TEST_PKT,
+            ( errors == 0 ) ? "ok" : "FAILED" );
+
+    hal_freq_hz = 868100000;
+    errors += forward( BENCH_PKT, ACK_DELAY_US );
+    wall_s = seconds( &ns_last ) - seconds( &ns_first );
+    printf( "batch %d ms, up to %d packets per lgw_receive(), PUSH_ACK after %d us:\n", PUSH_BATCH_MS, RECEIVE_MAX,
+            ACK_DELAY_US );
+    printf( "  %u packets in %u datagrams, %.0f packets/s, thread_up CPU %.2f us/packet\n", BENCH_PKT, ns_nb_dgram,
+            BENCH_PKT / wall_s, seconds( &up_cpu ) * 1e6 / BENCH_PKT );
+
+    return ( errors == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
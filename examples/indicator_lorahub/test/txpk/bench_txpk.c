@@ -0,0 +1,155 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+  (C)2019 Semtech
+
+Description:
+    Host benchmark of the txpk decoder against parson
+
+    The parson path does what thread_down() did before txpk_parse(): build the
+    DOM, read the fields, base64 decode "data" and free the DOM. The heap
+    allocations made by parson are counted through its allocator hooks.
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include <stdint.h>  /* C99 types */
+#include <stdbool.h> /* bool type */
+#include <stdio.h>   /* printf, snprintf */
+#include <stdlib.h>  /* malloc, free */
+#include <string.h>  /* strlen, strcmp */
+#include <time.h>    /* clock_gettime */
+
+#include "base64.h"
+#include "parson.h"
+#include "txpk.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define ITER_NB 200000
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static long nb_alloc = 0;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static void* count_malloc( size_t size )
+{
+    nb_alloc++;
+    return malloc( size );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static double now_ns( void )
+{
+    struct timespec t;
+
+    clock_gettime( CLOCK_MONOTONIC, &t );
+    return ( t.tv_sec * 1e9 ) + t.tv_nsec;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static long decode_parson( const char* json, struct lgw_pkt_tx_s* pkt )
+{
+    JSON_Value*  root_val;
+    JSON_Object* obj;
+    const char*  str;
+    short        x0;
+    short        x1;
+    long         sink = 0;
+
+    memset( pkt, 0, sizeof *pkt );
+    root_val      = json_parse_string_with_comments( json );
+    obj           = json_object_get_object( json_value_get_object( root_val ), "txpk" );
+    pkt->count_us = ( uint32_t ) json_object_get_number( obj, "tmst" );
+    pkt->freq_hz  = ( uint32_t ) ( 1.0e6 * json_object_get_number( obj, "freq" ) );
+    pkt->rf_chain = ( uint8_t ) json_object_get_number( obj, "rfch" );
+    pkt->rf_power = ( int8_t ) json_object_get_number( obj, "powe" );
+    sink += sscanf( json_object_get_string( obj, "datr" ), "SF%2hdBW%3hd", &x0, &x1 );
+    sink += strcmp( json_object_get_string( obj, "codr" ), "4/5" ) + strcmp( json_object_get_string( obj, "modu" ), "LORA" );
+    pkt->invert_pol = json_object_get_boolean( obj, "ipol" );
+    pkt->size       = ( uint16_t ) json_object_get_number( obj, "size" );
+    str             = json_object_get_string( obj, "data" );
+    sink += b64_to_bin( str, strlen( str ), pkt->payload, sizeof pkt->payload );
+    json_value_free( root_val );
+
+    return sink;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main( void )
+{
+    static char         json[3][1024];
+    uint8_t             payload[256];
+    char                b64[400];
+    struct lgw_pkt_tx_s pkt;
+    struct txpk_s       txpk;
+    volatile long       sink = 0;
+    double              t0, t1, t2;
+    long                allocs;
+    int                 len;
+    int                 i, k;
+
+    for( i = 0; i < ( int ) sizeof payload; i++ )
+    {
+        payload[i] = i * 7;
+    }
+
+    /* LoRaWAN ACK, 51 bytes at SF9 and 222 bytes at SF7 */
+    bin_to_b64( payload, 12, b64, sizeof b64 );
+    snprintf( json[0], sizeof json[0],
+              "{\"txpk\":{\"imme\":false,\"rfch\":0,\"powe\":14,\"ant\":0,\"brd\":0,\"tmst\":3512348611,\"freq\":868.1,"
+              "\"modu\":\"LORA\",\"datr\":\"SF7BW125\",\"codr\":\"4/5\",\"ipol\":true,\"size\":12,\"data\":\"%s\"}}",
+              b64 );
+    bin_to_b64( payload, 51, b64, sizeof b64 );
+    snprintf( json[1], sizeof json[1],
+              "{\"txpk\":{\"imme\":false,\"rfch\":0,\"powe\":14,\"tmst\":3512348611,\"freq\":869.525,\"modu\":\"LORA\","
+              "\"datr\":\"SF9BW125\",\"codr\":\"4/5\",\"ipol\":true,\"size\":51,\"data\":\"%s\"}}",
+              b64 );
+    bin_to_b64( payload, 222, b64, sizeof b64 );
+    snprintf( json[2], sizeof json[2],
+              "{\"txpk\":{\"imme\":false,\"rfch\":0,\"powe\":14,\"tmst\":3512348611,\"freq\":868.1,\"modu\":\"LORA\","
+              "\"datr\":\"SF7BW125\",\"codr\":\"4/5\",\"ipol\":true,\"size\":222,\"data\":\"%s\"}}",
+              b64 );
+
+    json_set_allocation_functions( count_malloc, free );
+    for( k = 0; k < 3; k++ )
+    {
+        len = strlen( json[k] );
+
+        nb_alloc = 0;
+        t0       = now_ns( );
+        for( i = 0; i < ITER_NB; i++ )
+        {
+            sink += decode_parson( json[k], &pkt );
+        }
+        t1     = now_ns( );
+        allocs = nb_alloc / ITER_NB;
+        for( i = 0; i < ITER_NB; i++ )
+        {
+            sink += txpk_parse( json[k], len, &pkt, &txpk ) + txpk.data_size;
+        }
+        t2 = now_ns( );
+
+        printf( "%4d B JSON, %3d B payload: parson %6.0f ns (%ld mallocs), txpk_parse %5.0f ns (0 malloc), x%.1f\n",
+                len, pkt.size, ( t1 - t0 ) / ITER_NB, allocs, ( t2 - t1 ) / ITER_NB, ( t1 - t0 ) / ( t2 - t1 ) );
+    }
+
+    return ( sink == 42 ) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,359 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+  (C)2019 Semtech
+
+Description:
+    Host fuzz test of the txpk decoder, checked against parson
+
+    Every corpus seed, its truncations and random mutations of it are decoded
+    from an exactly sized heap buffer, so that AddressSanitizer reports any read
+    past the datagram. When parson accepts the same JSON, the fields both
+    decoders consider valid must agree.
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+*/
+
+/* -------------------------------------------------------------------------- */
+/* --- DEPENDENCIES --------------------------------------------------------- */
+
+#include <stdint.h>  /* C99 types */
+#include <stdbool.h> /* bool type */
+#include <stdio.h>   /* printf, fopen */
+#include <stdlib.h>  /* malloc, atol */
+#include <string.h>  /* memcpy, strlen */
+#include <dirent.h>  /* opendir */
+#include <assert.h>  /* assert */
+
+#include "base64.h"
+#include "parson.h"
+#include "txpk.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define SEED_NB_MAX 128
+#define SEED_LEN_MAX 2048
+#define JSON_LEN_MAX 4096
+#define RANDOM_ITER_NB 200000
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static char seeds[SEED_NB_MAX][SEED_LEN_MAX];
+static int  seed_nb = 0;
+
+static uint64_t rnd_state = 88172645463325252ull;
+
+static long nb_parsed     = 0; /* inputs decoded, any outcome */
+static long nb_compared   = 0; /* inputs both decoders accepted */
+static long nb_mismatches = 0;
+
+static const char* tokens[] = { "\"", "{", "}", "[", "]", ",", ":", "true", "false", "null", "-", ".", "e",
+                                "0", "9", "\\", " ", "\"tmst\":", "\"data\":\"", "\"size\":", "\"freq\":",
+                                "\"imme\":true,", "\"rfch\":1,", "=", "A", "/" };
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint32_t rnd( void )
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 7;
+    rnd_state ^= rnd_state << 17;
+    return ( uint32_t ) rnd_state;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void mismatch( const char* field, const char* json )
+{
+    nb_mismatches++;
+    if( nb_mismatches <= 20 )
+    {
+        printf( "MISMATCH %s: %.300s\n", field, json );
+    }
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* true when parson holds a number for the field that converts to an integer type of [min, max] */
+static bool ref_number( JSON_Object* obj, const char* name, double min, double max, double* out )
+{
+    JSON_Value* val = json_object_get_value( obj, name );
+
+    if( ( val == NULL ) || ( json_value_get_type( val ) != JSONNumber ) )
+    {
+        return false;
+    }
+    *out = json_value_get_number( val );
+    return ( *out >= min ) && ( *out < max );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static bool ref_boolean( JSON_Object* obj, const char* name, bool* out )
+{
+    int b = json_object_get_boolean( obj, name );
+
+    *out = ( b == 1 );
+    return ( b != -1 );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* compare the decoded fields with what the former parson based code read from the same JSON */
+static void compare_parson( const char* json, const struct lgw_pkt_tx_s* pkt, const struct txpk_s* txpk,
+                            bool check_data )
+{
+    JSON_Value*  root_val;
+    JSON_Object* obj;
+    uint32_t     valid = txpk->fields & ~txpk->invalid;
+    double       d;
+    bool         b;
+    const char*  str;
+    char         b64[400];
+    int          len;
+
+    root_val = json_parse_string_with_comments( json );
+    obj      = json_object_get_object( json_value_get_object( root_val ), "txpk" );
+    if( obj == NULL )
+    {
+        json_value_free( root_val );
+        return;
+    }
+    nb_compared++;
+
+    if( ( valid & TXPK_FIELD_TMST ) && ref_number( obj, "tmst", 0, 4294967296.0, &d ) &&
+        ( pkt->count_us != ( uint32_t ) d ) )
+    {
+        mismatch( "tmst", json );
+    }
+    /* parson truncates freq * 1e6 where the decoder is exact to the Hz */
+    if( ( valid & TXPK_FIELD_FREQ ) && ref_number( obj, "freq", 0, 4294.0, &d ) &&
+        ( ( pkt->freq_hz - ( uint32_t ) ( 1.0e6 * d ) ) > 1 ) )
+    {
+        mismatch( "freq", json );
+    }
+    if( ( valid & TXPK_FIELD_RFCH ) && ref_number( obj, "rfch", 0, 256, &d ) && ( pkt->rf_chain != ( uint8_t ) d ) )
+    {
+        mismatch( "rfch", json );
+    }
+    if( ( valid & TXPK_FIELD_POWE ) && ref_number( obj, "powe", -128, 128, &d ) && ( pkt->rf_power != ( int8_t ) d ) )
+    {
+        mismatch( "powe", json );
+    }
+    if( ( valid & TXPK_FIELD_SIZE ) && ref_number( obj, "size", 0, 65536, &d ) && ( pkt->size != ( uint16_t ) d ) )
+    {
+        mismatch( "size", json );
+    }
+    if( ( valid & TXPK_FIELD_PREA ) && ref_number( obj, "prea", 0, 65536, &d ) && ( pkt->preamble != ( uint16_t ) d ) )
+    {
+        mismatch( "prea", json );
+    }
+    if( ( valid & TXPK_FIELD_IMME ) && ref_boolean( obj, "imme", &b ) && ( txpk->imme != b ) )
+    {
+        mismatch( "imme", json );
+    }
+    if( ( valid & TXPK_FIELD_NCRC ) && ref_boolean( obj, "ncrc", &b ) && ( pkt->no_crc != b ) )
+    {
+        mismatch( "ncrc", json );
+    }
+    if( ( valid & TXPK_FIELD_IPOL ) && ref_boolean( obj, "ipol", &b ) && ( pkt->invert_pol != b ) )
+    {
+        mismatch( "ipol", json );
+    }
+
+    /* base64.c exits on bad input, so the payload is checked by encoding it back, on canonical seeds only */
+    str = json_object_get_string( obj, "data" );
+    if( check_data && ( valid & TXPK_FIELD_DATA ) && ( str != NULL ) )
+    {
+        /* padding is optional */
+        len = bin_to_b64( pkt->payload, txpk->data_size, b64, sizeof b64 );
+        assert( len >= 0 ); /* b64 holds the largest payload */
+        while( ( len > 0 ) && ( b64[len - 1] == '=' ) )
+        {
+            len--;
+        }
+        if( ( strncmp( b64, str, ( size_t )len ) != 0 ) || ( strspn( str + len, "=" ) != strlen( str + len ) ) )
+        {
+            mismatch( "data", json );
+        }
+    }
+
+    json_value_free( root_val );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* decode len bytes of json from a buffer of exactly that size, not null terminated */
+static int decode( const char* json, int len, bool check_data )
+{
+    struct lgw_pkt_tx_s pkt;
+    struct txpk_s       txpk;
+    char*               buff;
+    char                str[JSON_LEN_MAX + 1];
+    int                 ret;
+
+    buff = malloc( ( len > 0 ) ? len : 1 );
+    memcpy( buff, json, len );
+    ret = txpk_parse( buff, len, &pkt, &txpk );
+    free( buff );
+    nb_parsed++;
+
+    if( ( txpk.data_size > ( int ) sizeof pkt.payload ) || ( ( txpk.invalid & ~txpk.fields ) != 0 ) )
+    {
+        mismatch( "txpk_s", json );
+    }
+
+    if( ret == TXPK_PARSE_OK )
+    {
+        if( ( txpk.data_size < 0 ) && ( ( txpk.fields & ~txpk.invalid & TXPK_FIELD_DATA ) != 0 ) )
+        {
+            mismatch( "data_size", json );
+        }
+        memcpy( str, json, len );
+        str[len] = '\0';
+        compare_parson( str, &pkt, &txpk, check_data );
+    }
+    return ret;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void mutate( const char* src, char* dst )
+{
+    int         len = strlen( src );
+    int         m   = 1 + rnd( ) % 4;
+    const char* tok;
+    int         pos;
+    int         n;
+
+    memcpy( dst, src, len + 1 );
+    while( m-- )
+    {
+        len = strlen( dst );
+        pos = ( len > 0 ) ? rnd( ) % len : 0;
+        switch( rnd( ) % 4 )
+        {
+        case 0:
+            dst[pos] = 32 + rnd( ) % 95;
+            break;
+        case 1:
+            if( len > 0 )
+            {
+                memmove( dst + pos, dst + pos + 1, len - pos );
+            }
+            break;
+        case 2:
+            tok = tokens[rnd( ) % ( sizeof tokens / sizeof tokens[0] )];
+            n   = strlen( tok );
+            if( len + n < JSON_LEN_MAX )
+            {
+                memmove( dst + pos + n, dst + pos, len - pos + 1 );
+                memcpy( dst + pos, tok, n );
+            }
+            break;
+        default:
+            n = rnd( ) % 12;
+            if( pos + n <= len )
+            {
+                memmove( dst + pos, dst + pos + n, len - pos - n + 1 );
+            }
+            break;
+        }
+    }
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static int load_corpus( const char* dir_name )
+{
+    DIR*           dir = opendir( dir_name );
+    struct dirent* entry;
+    char           path[512];
+    FILE*          f;
+    size_t         n;
+
+    if( dir == NULL )
+    {
+        return -1;
+    }
+    while( ( ( entry = readdir( dir ) ) != NULL ) && ( seed_nb < SEED_NB_MAX ) )
+    {
+        if( entry->d_name[0] == '.' )
+        {
+            continue;
+        }
+        snprintf( path, sizeof path, "%s/%s", dir_name, entry->d_name );
+        f = fopen( path, "r" );
+        if( f == NULL )
+        {
+            continue;
+        }
+        n = fread( seeds[seed_nb], 1, SEED_LEN_MAX - 1, f );
+        seeds[seed_nb][n] = '\0';
+        fclose( f );
+        seed_nb++;
+    }
+    closedir( dir );
+    return seed_nb;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main( int argc, char** argv )
+{
+    static char buff[JSON_LEN_MAX + 16];
+    long        iter_nb = ( argc > 2 ) ? atol( argv[2] ) : RANDOM_ITER_NB;
+    int         seed_ok = 0;
+    int         i;
+    int         len;
+    long        k;
+
+    if( load_corpus( ( argc > 1 ) ? argv[1] : "corpus" ) <= 0 )
+    {
+        printf( "ERROR: no corpus found\n" );
+        return EXIT_FAILURE;
+    }
+
+    /* seeds and every truncation of them */
+    for( i = 0; i < seed_nb; i++ )
+    {
+        len = strlen( seeds[i] );
+        seed_ok += ( decode( seeds[i], len, true ) == TXPK_PARSE_OK );
+        while( len-- > 0 )
+        {
+            decode( seeds[i], len, false );
+        }
+    }
+    printf( "corpus: %d seeds, %d decoded\n", seed_nb, seed_ok );
+
+    /* mutations of the seeds, then raw bytes behind a txpk prefix */
+    for( k = 0; k < iter_nb; k++ )
+    {
+        mutate( seeds[rnd( ) % seed_nb], buff );
+        decode( buff, strlen( buff ), false );
+
+        len = rnd( ) % 64;
+        for( i = 0; i < len; i++ )
+        {
+            buff[i] = ( char ) rnd( );
+        }
+        if( ( len > 9 ) && ( k & 1 ) )
+        {
+            memcpy( buff, "{\"txpk\":{", 9 );
+        }
+        decode( buff, len, false );
+    }
+
+    printf( "fuzz: %ld inputs, %ld also accepted by parson, %ld mismatches\n", nb_parsed, nb_compared,
+            nb_mismatches );
+    return ( nb_mismatches == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* --- EOF ------------------------------------------------------------------ */